@@ -19,6 +19,7 @@
 #define _DBCORE_H_
 
 #include <string>
+#include <vector>
 
 #include "node.h"
 #include "gestalt.h"
@@ -32,8 +33,123 @@ namespace UTIL { namespace Database {
 enum dbEngineType
 {
     dbSqlite,
-    dbMySQL
+    dbMySQL,
+    dbEventLog
 };
+
+// Type of a value bound to a prepared statement
+enum dbValueType
+{
+    dbNull,
+    dbInteger,
+    dbReal,
+    dbText
+};
+
+// One column value of a row inserted through insertRows
+struct DatabaseValue {
+    dbValueType type;
+    Int64 intValue;
+    double realValue;
+    std::string textValue;
+
+    DatabaseValue()
+    : type(dbNull), intValue(0), realValue(0.0) {}
+
+    DatabaseValue(Int32 value)
+    : type(dbInteger), intValue(value), realValue(0.0) {}
+
+    DatabaseValue(UInt32 value)
+    : type(dbInteger), intValue(value), realValue(0.0) {}
+
+    DatabaseValue(Int64 value)
+    : type(dbInteger), intValue(value), realValue(0.0) {}
+
+    DatabaseValue(double value)
+    : type(dbReal), intValue(0), realValue(value) {}
+
+    DatabaseValue(const std::string& value)
+    : type(dbText), intValue(0), realValue(0.0), textValue(value) {}
+
+    DatabaseValue(const char* value)
+    : type(dbText), intValue(0), realValue(0.0), textValue(value) {}
+
+    // Value as an SQL literal, for drivers without prepared statements
+    std::string toSql() const {
+        char buf[64];
+
+        switch (type) {
+            case dbInteger:
+                sprintf(buf, "%" TYPES_64BITFMT "d", intValue);
+                return buf;
+            case dbReal:
+                sprintf(buf, "%.15g", realValue);
+                return buf;
+            case dbText:
+            {
+                std::string literal = "'";
+                for (size_t i = 0; i < textValue.size(); i++) {
+                    if (textValue[i] == '\'') {
+                        literal += '\'';
+                    }
+                    literal += textValue[i];
+                }
+                literal += "'";
+                return literal;
+            }
+            default:
+                return "NULL";
+        }
+    }
+} ;
+
+typedef std::vector<DatabaseValue> DatabaseRow;
+
+// Rows of one table that set the same columns.  The driver prepares
+// the INSERT statement of a batch once and binds each row to it.
+struct DatabaseRowBatch {
+    std::string table;
+    std::vector<std::string> columns;
+    std::vector<DatabaseRow> rows;
+
+    // Key of the prepared statement of the rows of a table that set
+    // the given columns
+    static std::string makeKey(const std::string& table,
+                               const std::vector<std::string>& columns) {
+        std::string k = table;
+        for (size_t i = 0; i < columns.size(); i++) {
+            k += ",";
+            k += columns[i];
+        }
+        return k;
+    }
+
+    std::string key() const {
+        return makeKey(table, columns);
+    }
+
+    std::string insertSql() const {
+        std::string query = "INSERT INTO " + table + "(";
+        std::string values = "VALUES(";
+
+        for (size_t i = 0; i < columns.size(); i++) {
+            if (i > 0) {
+                query += ",";
+                values += ",";
+            }
+            query += columns[i];
+            values += "?";
+        }
+        return query + ") " + values + ");";
+    }
+
+    void swap(DatabaseRowBatch& other) {
+        table.swap(other.table);
+        columns.swap(other.columns);
+        rows.swap(other.rows);
+    }
+} ;
+
 struct DatabaseDriver : public QualNet::DynamicAPI::SimpleMarshaller {
     virtual void open(bool dropDatabase) = 0;
     virtual void close() = 0;
@@ -43,6 +159,34 @@ struct DatabaseDriver : public QualNet::DynamicAPI::SimpleMarshaller {
     virtual void exec(std::string query) = 0;
     virtual void exec(std::string in, std::string& out) = 0;
 
+    // Insert the rows of a batch.  Drivers that support prepared
+    // statements override this; the default executes one INSERT per row.
+    virtual void insertRows(const DatabaseRowBatch& batch) {
+        std::string prefix = "INSERT INTO " + batch.table + "(";
+
+        for (size_t i = 0; i < batch.columns.size(); i++) {
+            if (i > 0) {
+                prefix += ",";
+            }
+            prefix += batch.columns[i];
+        }
+        prefix += ") VALUES(";
+
+        for (size_t r = 0; r < batch.rows.size(); r++) {
+            std::string query = prefix;
+            const DatabaseRow& row = batch.rows[r];
+
+            for (size_t i = 0; i < row.size(); i++) {
+                if (i > 0) {
+                    query += ",";
+                }
+                query += row[i].toSql();
+            }
+            query += ");";
+            exec(query);
+        }
+    }
+
     dbEngineType engineType;
     unsigned sleepCounter;
 } ;
@@ -0,0 +1,158 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#ifndef _DB_EVENTLOG_DRIVER_H_
+#define _DB_EVENTLOG_DRIVER_H_
+
+#include <string>
+#include <map>
+
+#include "node.h"
+
+#include "db-core.h"
+#include "db-eventlog.h"
+
+namespace UTIL { namespace Database {
+
+// Driver that writes the rows of the event tables to columnar event log
+// files, one per table, instead of a SQL database.  It only supports
+// insertRows; the tables are read back with EventLogReader or the
+// event log tool.
+struct EventLogDriver : public DatabaseDriver {
+    std::string prefix;
+    int partitionId;
+    int segmentRows;
+    std::string lastError;
+
+    // Writer of each table, created at the first row of the table
+    std::map<std::string, EventLogWriter*> writers;
+
+    EventLogDriver(std::string p_prefix,
+                   int p_partitionId,
+                   int p_segmentRows)
+    : prefix(p_prefix), partitionId(p_partitionId),
+      segmentRows(p_segmentRows)
+    {
+        engineType = dbEventLog;
+        sleepCounter = 0;
+    }
+
+    // The copy writes the same files, but opens its own writers
+    EventLogDriver(EventLogDriver& db) {
+        prefix = db.prefix;
+        partitionId = db.partitionId;
+        segmentRows = db.segmentRows;
+        engineType = dbEventLog;
+        sleepCounter = 0;
+    }
+
+    ~EventLogDriver() {
+        close();
+    }
+
+    const char* error() {
+        return lastError.c_str();
+    }
+
+    // The files are created when the first row of their table is
+    // inserted, replacing the files of an earlier run
+    void open(bool dropDatabase) {
+    }
+
+    void close() {
+        std::map<std::string, EventLogWriter*>::iterator it;
+
+        for (it = writers.begin(); it != writers.end(); it++) {
+            if (!it->second->close()) {
+                lastError = it->second->error();
+                ERROR_ReportWarning(lastError.c_str());
+            }
+            delete it->second;
+        }
+        writers.clear();
+    }
+
+    void exec(std::string query) {
+        ERROR_ReportError("The statistics database event log cannot "
+                          "execute SQL statements");
+    }
+
+    void exec(std::string in, std::string& out) {
+        ERROR_ReportError("The statistics database event log cannot "
+                          "execute SQL statements");
+    }
+
+    EventLogWriter* writer(const std::string& table) {
+        std::map<std::string, EventLogWriter*>::iterator it =
+            writers.find(table);
+
+        if (it != writers.end()) {
+            return it->second;
+        }
+
+        EventLogWriter* w = new EventLogWriter(
+            EventLogFileName(prefix, table, partitionId),
+            table,
+            segmentRows);
+
+        if (!w->open()) {
+            lastError = w->error();
+            delete w;
+            ERROR_ReportError(lastError.c_str());
+        }
+
+        writers[table] = w;
+        return w;
+    }
+
+    void insertRows(const DatabaseRowBatch& batch) {
+        EventLogWriter* w = writer(batch.table);
+        std::vector<EventLogColumn>& buffer = w->rowBuffer(batch.columns);
+
+        for (size_t r = 0; r < batch.rows.size(); r++) {
+            const DatabaseRow& row = batch.rows[r];
+
+            for (size_t i = 0; i < row.size(); i++) {
+                const DatabaseValue& value = row[i];
+
+                switch (value.type) {
+                    case dbInteger:
+                        buffer[i].appendInteger(value.intValue);
+                        break;
+                    case dbReal:
+                        buffer[i].appendReal(value.realValue);
+                        break;
+                    case dbText:
+                        buffer[i].appendText(value.textValue);
+                        break;
+                    default:
+                        buffer[i].appendNull();
+                        break;
+                }
+            }
+
+            if (!w->endRow(buffer)) {
+                lastError = w->error();
+                ERROR_ReportError(lastError.c_str());
+            }
+        }
+    }
+} ;
+
+}}
+
+#endif
@@ -0,0 +1,883 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "db-eventlog.h"
+
+namespace UTIL { namespace Database {
+
+static const char EVENTLOG_FILE_MAGIC[] = "QNEVTLOG";
+static const UInt32 EVENTLOG_SEGMENT_MAGIC = 0x53455645;     // "EVES"
+
+// Size of the fixed part of a segment: magic, length, rows, columns
+#define EVENTLOG_SEGMENT_HEADER_SIZE 16
+
+//--------------------------------------------------------------------//
+// Encoding helpers
+//--------------------------------------------------------------------//
+
+static void EventLogPutUInt8(std::string& out, UInt32 value)
+{
+    out += (char) (value & 0xFF);
+}
+
+static void EventLogPutUInt16(std::string& out, UInt32 value)
+{
+    EventLogPutUInt8(out, value);
+    EventLogPutUInt8(out, value >> 8);
+}
+
+static void EventLogPutUInt32(std::string& out, UInt32 value)
+{
+    EventLogPutUInt16(out, value);
+    EventLogPutUInt16(out, value >> 16);
+}
+
+static void EventLogPutVarint(std::string& out, UInt64 value)
+{
+    while (value >= 0x80)
+    {
+        EventLogPutUInt8(out, (UInt32) (value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    EventLogPutUInt8(out, (UInt32) value);
+}
+
+static UInt32 EventLogGetUInt16(const unsigned char* p)
+{
+    return (UInt32) p[0] | ((UInt32) p[1] << 8);
+}
+
+static UInt32 EventLogGetUInt32(const unsigned char* p)
+{
+    return EventLogGetUInt16(p) | (EventLogGetUInt16(p + 2) << 16);
+}
+
+// Read a varint, advancing p.  Returns false if the data ends first.
+static bool EventLogGetVarint(
+    const unsigned char*& p,
+    const unsigned char* end,
+    UInt64& value)
+{
+    int shift = 0;
+
+    value = 0;
+    while (p < end && shift < 64)
+    {
+        unsigned char byte = *p++;
+
+        value |= (UInt64) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+// Seek and tell with 64 bit offsets, since event logs of long runs can
+// be larger than 2 GB
+static int EventLogSeek(FILE* fp, Int64 offset, int whence)
+{
+#ifdef _WIN32
+    return _fseeki64(fp, offset, whence);
+#else
+    return fseeko(fp, (off_t) offset, whence);
+#endif
+}
+
+static Int64 EventLogTell(FILE* fp)
+{
+#ifdef _WIN32
+    return _ftelli64(fp);
+#else
+    return (Int64) ftello(fp);
+#endif
+}
+
+static std::string EventLogIntToString(Int64 value)
+{
+    char buf[32];
+
+    sprintf(buf, "%" TYPES_64BITFMT "d", value);
+    return buf;
+}
+
+static std::string EventLogRealToString(double value)
+{
+    char buf[32];
+
+    sprintf(buf, "%.15g", value);
+    return buf;
+}
+
+//--------------------------------------------------------------------//
+// EventLogColumn
+//--------------------------------------------------------------------//
+
+void EventLogColumn::clear()
+{
+    type = EVENTLOG_NULL;
+    isNull.clear();
+    intValues.clear();
+    realValues.clear();
+    textValues.clear();
+}
+
+void EventLogColumn::promote(EventLogType newType)
+{
+    size_t i;
+
+    if (newType == EVENTLOG_REAL && type == EVENTLOG_INTEGER)
+    {
+        realValues.resize(intValues.size());
+        for (i = 0; i < intValues.size(); i++)
+        {
+            realValues[i] = (double) intValues[i];
+        }
+        intValues.clear();
+    }
+    else if (newType == EVENTLOG_TEXT && type != EVENTLOG_NULL)
+    {
+        textValues.resize(isNull.size());
+        for (i = 0; i < isNull.size(); i++)
+        {
+            if (!isNull[i])
+            {
+                textValues[i] = toString((int) i);
+            }
+        }
+        intValues.clear();
+        realValues.clear();
+    }
+    else if (type == EVENTLOG_NULL)
+    {
+        // Only null rows so far; give them unused values of the new type
+        intValues.clear();
+        realValues.clear();
+        textValues.clear();
+        if (newType == EVENTLOG_INTEGER)
+        {
+            intValues.resize(isNull.size(), 0);
+        }
+        else if (newType == EVENTLOG_REAL)
+        {
+            realValues.resize(isNull.size(), 0.0);
+        }
+        else
+        {
+            textValues.resize(isNull.size());
+        }
+    }
+    type = newType;
+}
+
+void EventLogColumn::appendNull()
+{
+    isNull.push_back(true);
+    switch (type)
+    {
+        case EVENTLOG_INTEGER:
+            intValues.push_back(0);
+            break;
+        case EVENTLOG_REAL:
+            realValues.push_back(0.0);
+            break;
+        case EVENTLOG_TEXT:
+            textValues.push_back(std::string());
+            break;
+        default:
+            break;
+    }
+}
+
+void EventLogColumn::appendInteger(Int64 value)
+{
+    if (type == EVENTLOG_NULL)
+    {
+        promote(EVENTLOG_INTEGER);
+    }
+
+    isNull.push_back(false);
+    if (type == EVENTLOG_INTEGER)
+    {
+        intValues.push_back(value);
+    }
+    else if (type == EVENTLOG_REAL)
+    {
+        realValues.push_back((double) value);
+    }
+    else
+    {
+        textValues.push_back(EventLogIntToString(value));
+    }
+}
+
+void EventLogColumn::appendReal(double value)
+{
+    if (type == EVENTLOG_NULL || type == EVENTLOG_INTEGER)
+    {
+        promote(EVENTLOG_REAL);
+    }
+
+    isNull.push_back(false);
+    if (type == EVENTLOG_REAL)
+    {
+        realValues.push_back(value);
+    }
+    else
+    {
+        textValues.push_back(EventLogRealToString(value));
+    }
+}
+
+void EventLogColumn::appendText(const std::string& value)
+{
+    if (type != EVENTLOG_TEXT)
+    {
+        promote(EVENTLOG_TEXT);
+    }
+
+    isNull.push_back(false);
+    textValues.push_back(value);
+}
+
+std::string EventLogColumn::toString(int row) const
+{
+    if (isNull[row])
+    {
+        return "";
+    }
+
+    switch (type)
+    {
+        case EVENTLOG_INTEGER:
+            return EventLogIntToString(intValues[row]);
+        case EVENTLOG_REAL:
+            return EventLogRealToString(realValues[row]);
+        case EVENTLOG_TEXT:
+            return textValues[row];
+        default:
+            return "";
+    }
+}
+
+//--------------------------------------------------------------------//
+// Column encoding
+//--------------------------------------------------------------------//
+
+static void EventLogEncodeColumn(
+    const EventLogColumn& column,
+    std::string& out)
+{
+    int numRows = column.numRows();
+    bool hasNulls = false;
+    int row;
+
+    for (row = 0; row < numRows; row++)
+    {
+        if (column.isNull[row])
+        {
+            hasNulls = true;
+            break;
+        }
+    }
+
+    EventLogPutUInt8(out, hasNulls ? 1 : 0);
+    if (hasNulls)
+    {
+        for (row = 0; row < numRows; row += 8)
+        {
+            UInt32 bits = 0;
+
+            for (int b = 0; b < 8 && row + b < numRows; b++)
+            {
+                if (column.isNull[row + b])
+                {
+                    bits |= 1 << b;
+                }
+            }
+            EventLogPutUInt8(out, bits);
+        }
+    }
+
+    if (column.type == EVENTLOG_INTEGER)
+    {
+        Int64 previous = 0;
+
+        for (row = 0; row < numRows; row++)
+        {
+            if (column.isNull[row])
+            {
+                continue;
+            }
+
+            Int64 delta = (Int64) ((UInt64) column.intValues[row]
+                                   - (UInt64) previous);
+            UInt64 zigzag = ((UInt64) delta << 1) ^ (UInt64) (delta >> 63);
+
+            EventLogPutVarint(out, zigzag);
+            previous = column.intValues[row];
+        }
+    }
+    else if (column.type == EVENTLOG_REAL)
+    {
+        UInt64 previous = 0;
+
+        for (row = 0; row < numRows; row++)
+        {
+            if (column.isNull[row])
+            {
+                continue;
+            }
+
+            UInt64 bits;
+            memcpy(&bits, &column.realValues[row], sizeof(bits));
+
+            UInt64 x = bits ^ previous;
+            int lead = 0;
+            int trail = 0;
+
+            while (lead < 8 && ((x >> (8 * (7 - lead))) & 0xFF) == 0)
+            {
+                lead++;
+            }
+            while (lead + trail < 8 && ((x >> (8 * trail)) & 0xFF) == 0)
+            {
+                trail++;
+            }
+
+            EventLogPutUInt8(out, (lead << 4) | trail);
+            for (int b = 7 - lead; b >= trail; b--)
+            {
+                EventLogPutUInt8(out, (UInt32) (x >> (8 * b)));
+            }
+            previous = bits;
+        }
+    }
+    else if (column.type == EVENTLOG_TEXT)
+    {
+        std::map<std::string, UInt32> dictionary;
+        std::vector<const std::string*> words;
+        std::vector<UInt32> indices;
+
+        for (row = 0; row < numRows; row++)
+        {
+            if (column.isNull[row])
+            {
+                continue;
+            }
+
+            std::map<std::string, UInt32>::iterator it =
+                dictionary.find(column.textValues[row]);
+
+            if (it == dictionary.end())
+            {
+                it = dictionary.insert(
+                    std::make_pair(column.textValues[row],
+                                   (UInt32) words.size())).first;
+                words.push_back(&it->first);
+            }
+            indices.push_back(it->second);
+        }
+
+        EventLogPutVarint(out, words.size());
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            EventLogPutVarint(out, words[i]->size());
+            out += *words[i];
+        }
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            EventLogPutVarint(out, indices[i]);
+        }
+    }
+}
+
+// Decode the data of a column.  Returns false if the data is damaged.
+static bool EventLogDecodeColumn(
+    const unsigned char* p,
+    const unsigned char* end,
+    int numRows,
+    EventLogColumn& column)
+{
+    int row;
+
+    column.isNull.assign(numRows, false);
+    column.intValues.clear();
+    column.realValues.clear();
+    column.textValues.clear();
+
+    if (p >= end)
+    {
+        return false;
+    }
+    if (*p++)
+    {
+        if (end - p < (numRows + 7) / 8)
+        {
+            return false;
+        }
+        for (row = 0; row < numRows; row++)
+        {
+            column.isNull[row] = (p[row / 8] >> (row % 8)) & 1;
+        }
+        p += (numRows + 7) / 8;
+    }
+
+    if (column.type == EVENTLOG_INTEGER)
+    {
+        Int64 previous = 0;
+
+        column.intValues.resize(numRows, 0);
+        for (row = 0; row < numRows; row++)
+        {
+            UInt64 zigzag;
+
+            if (column.isNull[row])
+            {
+                continue;
+            }
+            if (!EventLogGetVarint(p, end, zigzag))
+            {
+                return false;
+            }
+
+            Int64 delta = (Int64) (zigzag >> 1) ^ -(Int64) (zigzag & 1);
+            previous = (Int64) ((UInt64) previous + (UInt64) delta);
+            column.intValues[row] = previous;
+        }
+    }
+    else if (column.type == EVENTLOG_REAL)
+    {
+        UInt64 previous = 0;
+
+        column.realValues.resize(numRows, 0.0);
+        for (row = 0; row < numRows; row++)
+        {
+            if (column.isNull[row])
+            {
+                continue;
+            }
+            if (p >= end)
+            {
+                return false;
+            }
+
+            int lead = *p >> 4;
+            int trail = *p & 0x0F;
+            UInt64 x = 0;
+
+            p++;
+            if (lead + trail > 8 || end - p < 8 - lead - trail)
+            {
+                return false;
+            }
+            for (int b = 7 - lead; b >= trail; b--)
+            {
+                x |= (UInt64) *p++ << (8 * b);
+            }
+
+            previous ^= x;
+            memcpy(&column.realValues[row], &previous, sizeof(previous));
+        }
+    }
+    else if (column.type == EVENTLOG_TEXT)
+    {
+        UInt64 numWords;
+        std::vector<std::string> words;
+
+        if (!EventLogGetVarint(p, end, numWords))
+        {
+            return false;
+        }
+        for (UInt64 i = 0; i < numWords; i++)
+        {
+            UInt64 length;
+
+            if (!EventLogGetVarint(p, end, length)
+                || (UInt64) (end - p) < length)
+            {
+                return false;
+            }
+            words.push_back(std::string((const char*) p, (size_t) length));
+            p += length;
+        }
+
+        column.textValues.resize(numRows);
+        for (row = 0; row < numRows; row++)
+        {
+            UInt64 index;
+
+            if (column.isNull[row])
+            {
+                continue;
+            }
+            if (!EventLogGetVarint(p, end, index) || index >= numWords)
+            {
+                return false;
+            }
+            column.textValues[row] = words[(size_t) index];
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------//
+// EventLogWriter
+//--------------------------------------------------------------------//
+
+std::string EventLogFileName(
+    const std::string& prefix,
+    const std::string& table,
+    int partition)
+{
+    char buf[32];
+
+    sprintf(buf, ".p%d", partition);
+    return prefix + "." + table + buf + EVENTLOG_FILE_EXTENSION;
+}
+
+EventLogWriter::EventLogWriter(
+    const std::string& fileName,
+    const std::string& table,
+    int segmentRows)
+: fileName_(fileName), table_(table), segmentRows_(segmentRows), fp_(NULL)
+{
+}
+
+EventLogWriter::~EventLogWriter()
+{
+    if (fp_ != NULL)
+    {
+        fclose(fp_);
+    }
+}
+
+bool EventLogWriter::open()
+{
+    std::string header(EVENTLOG_FILE_MAGIC, 8);
+
+    fp_ = fopen(fileName_.c_str(), "wb");
+    if (fp_ == NULL)
+    {
+        error_ = "Cannot create event log " + fileName_;
+        return false;
+    }
+
+    EventLogPutUInt32(header, EVENTLOG_VERSION);
+    EventLogPutUInt16(header, (UInt32) table_.size());
+    header += table_;
+
+    if (fwrite(header.data(), 1, header.size(), fp_) != header.size())
+    {
+        error_ = "Cannot write event log " + fileName_;
+        return false;
+    }
+    return true;
+}
+
+std::vector<EventLogColumn>& EventLogWriter::rowBuffer(
+    const std::vector<std::string>& columns)
+{
+    std::string key;
+
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        key += columns[i];
+        key += '\n';
+    }
+
+    std::map<std::string, std::vector<EventLogColumn> >::iterator it =
+        buffers_.find(key);
+
+    if (it == buffers_.end())
+    {
+        it = buffers_.insert(
+            std::make_pair(key, std::vector<EventLogColumn>())).first;
+        it->second.resize(columns.size());
+        for (size_t i = 0; i < columns.size(); i++)
+        {
+            it->second[i].name = columns[i];
+        }
+    }
+    return it->second;
+}
+
+bool EventLogWriter::endRow(std::vector<EventLogColumn>& buffer)
+{
+    if (!buffer.empty() && buffer[0].numRows() >= segmentRows_)
+    {
+        return writeSegment(buffer);
+    }
+    return true;
+}
+
+bool EventLogWriter::flush()
+{
+    bool ok = true;
+    std::map<std::string, std::vector<EventLogColumn> >::iterator it;
+
+    for (it = buffers_.begin(); it != buffers_.end(); it++)
+    {
+        if (!it->second.empty() && it->second[0].numRows() > 0)
+        {
+            ok = writeSegment(it->second) && ok;
+        }
+    }
+    return ok;
+}
+
+bool EventLogWriter::close()
+{
+    bool ok = true;
+
+    if (fp_ != NULL)
+    {
+        ok = flush();
+        if (fclose(fp_) != 0)
+        {
+            error_ = "Cannot write event log " + fileName_;
+            ok = false;
+        }
+        fp_ = NULL;
+    }
+    return ok;
+}
+
+bool EventLogWriter::writeSegment(std::vector<EventLogColumn>& columns)
+{
+    std::string directory;
+    std::string data;
+    size_t i;
+
+    for (i = 0; i < columns.size(); i++)
+    {
+        size_t offset = data.size();
+
+        EventLogEncodeColumn(columns[i], data);
+
+        EventLogPutUInt16(directory, (UInt32) columns[i].name.size());
+        directory += columns[i].name;
+        EventLogPutUInt8(directory, columns[i].type);
+        EventLogPutUInt32(directory, (UInt32) offset);
+        EventLogPutUInt32(directory, (UInt32) (data.size() - offset));
+    }
+
+    std::string header;
+    EventLogPutUInt32(header, EVENTLOG_SEGMENT_MAGIC);
+    EventLogPutUInt32(header,
+                      (UInt32) (EVENTLOG_SEGMENT_HEADER_SIZE - 8
+                                + directory.size() + data.size()));
+    EventLogPutUInt32(header, (UInt32) columns[0].numRows());
+    EventLogPutUInt32(header, (UInt32) columns.size());
+
+    for (i = 0; i < columns.size(); i++)
+    {
+        columns[i].clear();
+    }
+
+    if (fwrite(header.data(), 1, header.size(), fp_) != header.size()
+        || fwrite(directory.data(), 1, directory.size(), fp_)
+            != directory.size()
+        || fwrite(data.data(), 1, data.size(), fp_) != data.size())
+    {
+        error_ = "Cannot write event log " + fileName_;
+        return false;
+    }
+
+    // Keep the file readable up to the last segment if the run stops
+    fflush(fp_);
+    return true;
+}
+
+//--------------------------------------------------------------------//
+// EventLogReader
+//--------------------------------------------------------------------//
+
+EventLogReader::EventLogReader()
+: fp_(NULL), fileSize_(0), nextSegmentOffset_(0), dataOffset_(0),
+  numRows_(0)
+{
+}
+
+EventLogReader::~EventLogReader()
+{
+    close();
+}
+
+bool EventLogReader::open(const std::string& fileName)
+{
+    unsigned char header[14];
+
+    close();
+
+    fp_ = fopen(fileName.c_str(), "rb");
+    if (fp_ == NULL)
+    {
+        error_ = "Cannot open event log " + fileName;
+        return false;
+    }
+
+    if (fread(header, 1, sizeof(header), fp_) != sizeof(header)
+        || memcmp(header, EVENTLOG_FILE_MAGIC, 8) != 0)
+    {
+        error_ = fileName + " is not an event log";
+        close();
+        return false;
+    }
+    if (EventLogGetUInt32(header + 8) > EVENTLOG_VERSION)
+    {
+        error_ = fileName + " has an unknown event log version";
+        close();
+        return false;
+    }
+
+    std::vector<char> table(EventLogGetUInt16(header + 12));
+    if (!table.empty()
+        && fread(&table[0], 1, table.size(), fp_) != table.size())
+    {
+        error_ = fileName + " is not an event log";
+        close();
+        return false;
+    }
+    table_.assign(table.begin(), table.end());
+
+    nextSegmentOffset_ = EventLogTell(fp_);
+    EventLogSeek(fp_, 0, SEEK_END);
+    fileSize_ = EventLogTell(fp_);
+    numRows_ = 0;
+    columns_.clear();
+    return true;
+}
+
+void EventLogReader::close()
+{
+    if (fp_ != NULL)
+    {
+        fclose(fp_);
+        fp_ = NULL;
+    }
+}
+
+bool EventLogReader::nextSegment()
+{
+    unsigned char header[EVENTLOG_SEGMENT_HEADER_SIZE];
+
+    numRows_ = 0;
+    columns_.clear();
+
+    if (fp_ == NULL || nextSegmentOffset_ >= fileSize_)
+    {
+        return false;
+    }
+
+    if (EventLogSeek(fp_, nextSegmentOffset_, SEEK_SET) != 0
+        || fread(header, 1, sizeof(header), fp_) != sizeof(header)
+        || EventLogGetUInt32(header) != EVENTLOG_SEGMENT_MAGIC)
+    {
+        error_ = "Ignoring damaged segment at the end of the event log";
+        return false;
+    }
+
+    Int64 segmentEnd = nextSegmentOffset_ + 8 + EventLogGetUInt32(header + 4);
+    if (segmentEnd > fileSize_)
+    {
+        error_ = "Ignoring incomplete segment at the end of the event log";
+        return false;
+    }
+
+    int numColumns = (int) EventLogGetUInt32(header + 12);
+    for (int i = 0; i < numColumns; i++)
+    {
+        unsigned char entry[9];
+        unsigned char length[2];
+        EventLogColumnInfo info;
+
+        if (fread(length, 1, 2, fp_) != 2)
+        {
+            error_ = "Damaged segment directory in the event log";
+            return false;
+        }
+
+        std::vector<char> name(EventLogGetUInt16(length));
+        if ((!name.empty()
+             && fread(&name[0], 1, name.size(), fp_) != name.size())
+            || fread(entry, 1, sizeof(entry), fp_) != sizeof(entry))
+        {
+            error_ = "Damaged segment directory in the event log";
+            return false;
+        }
+
+        info.name.assign(name.begin(), name.end());
+        info.type = (EventLogType) entry[0];
+        info.offset = EventLogGetUInt32(entry + 1);
+        info.length = EventLogGetUInt32(entry + 5);
+        columns_.push_back(info);
+    }
+
+    numRows_ = (int) EventLogGetUInt32(header + 8);
+    dataOffset_ = EventLogTell(fp_);
+    nextSegmentOffset_ = segmentEnd;
+    return true;
+}
+
+int EventLogReader::findColumn(const std::string& name) const
+{
+    for (size_t i = 0; i < columns_.size(); i++)
+    {
+        if (columns_[i].name == name)
+        {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+bool EventLogReader::readColumn(int index, EventLogColumn& column)
+{
+    const EventLogColumnInfo& info = columns_[index];
+    std::vector<unsigned char> data(info.length);
+
+    column.name = info.name;
+    column.type = info.type;
+
+    if (EventLogSeek(fp_, dataOffset_ + info.offset, SEEK_SET) != 0
+        || (!data.empty()
+            && fread(&data[0], 1, data.size(), fp_) != data.size()))
+    {
+        error_ = "Cannot read column " + info.name + " of the event log";
+        return false;
+    }
+
+    if (data.empty()
+        || !EventLogDecodeColumn(&data[0],
+                                 &data[0] + data.size(),
+                                 numRows_,
+                                 column))
+    {
+        error_ = "Damaged column " + info.name + " in the event log";
+        return false;
+    }
+    return true;
+}
+
+}}
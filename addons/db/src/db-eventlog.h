@@ -0,0 +1,252 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Columnar binary event log of the statistics database.
+ *
+ * An event log file holds the rows of one event table of one partition.
+ * The file starts with a header naming the table and is followed by
+ * segments, which are only ever appended.  A segment holds a number of
+ * rows that set the same columns, stored column by column:
+ *
+ *   header  : "QNEVTLOG", UInt32 version, UInt16 length, table name
+ *   segment : UInt32 magic, UInt32 length of the rest of the segment,
+ *             UInt32 rows, UInt32 columns,
+ *             per column: UInt16 length, name, UInt8 type,
+ *                         UInt32 data offset, UInt32 data length,
+ *             column data
+ *
+ * All numbers are little endian.  The data of a column is a null flag
+ * (followed by a bitmap of the null rows if set) and the values of the
+ * rows that are not null:
+ *
+ *   integer : zigzag encoded difference to the previous value, varint
+ *   real    : bits XOR the bits of the previous value, stored as one
+ *             byte of leading and trailing zero byte counts followed by
+ *             the remaining bytes
+ *   text    : dictionary of the distinct strings of the segment, then
+ *             the dictionary index of each value, varint
+ *
+ * A reader can skip the columns it does not need without decoding them.
+ * A segment cut short by the end of the file, as left by a crash, is
+ * ignored.
+ *
+ * This file does not depend on the simulator, so that offline tools can
+ * read event logs.
+ */
+
+#ifndef _DB_EVENTLOG_H_
+#define _DB_EVENTLOG_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "types.h"
+
+namespace UTIL { namespace Database {
+
+// /**
+// CONSTANT    :: EVENTLOG_VERSION : 1
+// DESCRIPTION :: Version of the event log file format
+// **/
+#define EVENTLOG_VERSION 1
+
+// /**
+// CONSTANT    :: EVENTLOG_DEFAULT_SEGMENT_ROWS : 8192
+// DESCRIPTION :: Default number of rows buffered before a segment is
+//                written
+// **/
+#define EVENTLOG_DEFAULT_SEGMENT_ROWS 8192
+
+// /**
+// CONSTANT    :: EVENTLOG_FILE_EXTENSION : ".qel"
+// DESCRIPTION :: Extension of event log files
+// **/
+#define EVENTLOG_FILE_EXTENSION ".qel"
+
+// /**
+// ENUM        :: EventLogType
+// DESCRIPTION :: Type of the values of a column.  A column of type
+//                EVENTLOG_NULL only has null values.
+// **/
+enum EventLogType
+{
+    EVENTLOG_NULL = 0,
+    EVENTLOG_INTEGER = 1,
+    EVENTLOG_REAL = 2,
+    EVENTLOG_TEXT = 3
+};
+
+// /**
+// STRUCT      :: EventLogColumn
+// DESCRIPTION :: Values of one column of a segment.  Only the vector of
+//                the type of the column is used; it holds one value per
+//                row, which is unused if the row is null.
+// **/
+struct EventLogColumn
+{
+    std::string name;
+    EventLogType type;
+    std::vector<bool> isNull;
+    std::vector<Int64> intValues;
+    std::vector<double> realValues;
+    std::vector<std::string> textValues;
+
+    EventLogColumn() : type(EVENTLOG_NULL) {}
+
+    int numRows() const { return (int) isNull.size(); }
+
+    void clear();
+
+    void appendNull();
+    void appendInteger(Int64 value);
+    void appendReal(double value);
+    void appendText(const std::string& value);
+
+    // Value of a row as text, "" if null
+    std::string toString(int row) const;
+
+private:
+    // Change the type of the column so that it can hold values of type
+    void promote(EventLogType newType);
+};
+
+// /**
+// API        :: EventLogFileName
+// PURPOSE    :: Name of the event log file of a table of a partition
+// PARAMETERS ::
+// + prefix    : const std::string& : name of the statistics database
+// + table     : const std::string& : table name
+// + partition : int                : partition id
+// RETURN     :: std::string : file name
+// **/
+std::string EventLogFileName(
+    const std::string& prefix,
+    const std::string& table,
+    int partition);
+
+// /**
+// CLASS       :: EventLogWriter
+// DESCRIPTION :: Appends rows of one table to an event log file.  Rows
+//                are buffered by column set and written as one segment
+//                once segmentRows rows are buffered or the writer is
+//                flushed.
+// **/
+class EventLogWriter
+{
+public:
+    EventLogWriter(const std::string& fileName,
+                   const std::string& table,
+                   int segmentRows);
+    ~EventLogWriter();
+
+    // Create the file, replacing an existing one
+    bool open();
+
+    // Buffer of the rows that set the given columns, to which the
+    // caller appends one value per column and then calls endRow
+    std::vector<EventLogColumn>& rowBuffer(
+        const std::vector<std::string>& columns);
+
+    // Account for a row appended to a buffer, writing the buffer once
+    // it is full
+    bool endRow(std::vector<EventLogColumn>& buffer);
+
+    // Write all buffered rows
+    bool flush();
+
+    bool close();
+
+    const std::string& error() const { return error_; }
+
+private:
+    std::string fileName_;
+    std::string table_;
+    int segmentRows_;
+    FILE* fp_;
+    std::string error_;
+
+    // Buffered rows, by column set
+    std::map<std::string, std::vector<EventLogColumn> > buffers_;
+
+    bool writeSegment(std::vector<EventLogColumn>& columns);
+};
+
+// /**
+// STRUCT      :: EventLogColumnInfo
+// DESCRIPTION :: Directory entry of a column of a segment
+// **/
+struct EventLogColumnInfo
+{
+    std::string name;
+    EventLogType type;
+    UInt32 offset;
+    UInt32 length;
+};
+
+// /**
+// CLASS       :: EventLogReader
+// DESCRIPTION :: Reads the segments of an event log file.  Only the
+//                directory of a segment is read by nextSegment; the
+//                data of a column is read when the column is asked for.
+// **/
+class EventLogReader
+{
+public:
+    EventLogReader();
+    ~EventLogReader();
+
+    bool open(const std::string& fileName);
+    void close();
+
+    const std::string& table() const { return table_; }
+    const std::string& error() const { return error_; }
+
+    // Move to the next segment.  Returns false at the end of the file,
+    // or if the rest of the file is not a complete segment.
+    bool nextSegment();
+
+    int numRows() const { return numRows_; }
+    const std::vector<EventLogColumnInfo>& columns() const
+    {
+        return columns_;
+    }
+
+    // Index of a column of the segment, -1 if the segment does not have
+    // the column
+    int findColumn(const std::string& name) const;
+
+    // Read and decode a column of the segment
+    bool readColumn(int index, EventLogColumn& column);
+
+private:
+    FILE* fp_;
+    std::string table_;
+    std::string error_;
+
+    Int64 fileSize_;
+    Int64 nextSegmentOffset_;
+    Int64 dataOffset_;
+    int numRows_;
+    std::vector<EventLogColumnInfo> columns_;
+};
+
+}}
+
+#endif
@@ -22,6 +22,7 @@
 #include <vector>
 #include <iostream>
 #include <list>
+#include <map>
 
 #include "fileio.h"
 #include "node.h"
@@ -33,39 +34,78 @@
 #include "db-core.h"
 #include "db-sqlite3.h"
 #include "db-mysql-native.h"
+#include "db-eventlog-driver.h"
 
 #include "dbapi.h"
 
-class DatabaseInterlock : public UTIL::Interlock<std::string>,
-public UTIL::Worker<std::string>
+// Unit of work of the database worker: an SQL query, or a batch of rows
+// to insert through the prepared statements of the driver when the query
+// is empty
+struct DatabaseWork
+{
+    std::string query;
+    UTIL::Database::DatabaseRowBatch batch;
+    bool toEventLog;            // batch goes to the event log
+    int partitionId;            // whose event log
+
+    DatabaseWork() : toEventLog(false), partitionId(0) {}
+
+    // The interlock merges its lists, which needs an order.  All work is
+    // equal so that the merge keeps the order of insertion.
+    bool operator<(const DatabaseWork& other) const
+    {
+        return false;
+    }
+} ;
+
+class DatabaseInterlock : public UTIL::Interlock<DatabaseWork>,
+public UTIL::Worker<DatabaseWork>
 {
     UTIL::Database::DatabaseDriver* driver_;
+
+    // Each partition writes its own event log files, so the worker keeps
+    // a driver per partition
+    std::map<int, UTIL::Database::EventLogDriver*> eventLogs_;
     int minQueryBuffer_;
     bool isOpen_;
     
-    std::string listToQuery(std::list<std::string>& list)
+    void createDriver(StatsDb* db)
     {
-        // std::string query = "BEGIN EXCLUSIVE;\n";
-        std::string query;
-        std::list<std::string>::iterator pos = list.begin();
-        
-        for (; pos != list.end(); pos++)
+        if (db->eventLog != NULL)
         {
-            query += *pos + "\n";
+            UTIL::Database::EventLogDriver* eventLog =
+                (UTIL::Database::EventLogDriver*)db->eventLog;
+
+            if (eventLogs_.find(eventLog->partitionId) == eventLogs_.end())
+            {
+                eventLogs_[eventLog->partitionId] =
+                    new UTIL::Database::EventLogDriver(*eventLog);
+            }
+        }
+        if (driver_ == NULL) {
+            if (db->engineType == UTIL::Database::dbMySQL)
+            {
+                driver_ = (UTIL::Database::DatabaseDriver*)
+                    new UTIL::Database::MysqlNativeDriver(
+                    *(UTIL::Database::MysqlNativeDriver*)db->driver);
+            }
+            else if (db->engineType == UTIL::Database::dbSqlite)
+            {
+                driver_ = (UTIL::Database::DatabaseDriver*)
+                    new UTIL::Database::Sqlite3Driver(
+                    *(UTIL::Database::Sqlite3Driver*)db->driver);
+            }
+            minQueryBuffer_ = db->minQueryBuffer;
         }
-        
-        // query += "COMMIT;\n";
-        
-        return query;             
     }
     
 public:
     
     DatabaseInterlock()
-    : UTIL::Interlock<std::string>("Database Interlock",
-                                   false), driver_(NULL),
-                                   minQueryBuffer_(-1), 
-                                   isOpen_(false)
+    : UTIL::Interlock<DatabaseWork>("Database Interlock",
+                                    false), driver_(NULL),
+                                    minQueryBuffer_(-1), 
+                                    isOpen_(false)
     {
 
     }
@@ -75,7 +115,7 @@ public:
         setWorker(this);
     }
     
-    void run(std::list<std::string>& list)
+    void run(std::list<DatabaseWork>& list)
     {
         if (driver_ != NULL)
         {
@@ -84,9 +124,7 @@ public:
                 isOpen_ = true;
             }
 
-            // std::string query = listToQuery(list);
-
-            std::list<std::string>::iterator pos = list.begin();
+            std::list<DatabaseWork>::iterator pos = list.begin();
 
             if (driver_->engineType == UTIL::Database::dbSqlite)
             {
@@ -94,8 +132,18 @@ public:
             }
             for (; pos != list.end(); pos++)
             {
-                std::string query = *pos;
-                driver_->exec(query);
+                if (pos->toEventLog)
+                {
+                    eventLogs_[pos->partitionId]->insertRows(pos->batch);
+                }
+                else if (pos->query.empty())
+                {
+                    driver_->insertRows(pos->batch);
+                }
+                else
+                {
+                    driver_->exec(pos->query);
+                }
             }
             if (driver_->engineType == UTIL::Database::dbSqlite)
             {
@@ -115,29 +163,25 @@ public:
             driver_ = NULL;
             isOpen_ = false;
         }
+        std::map<int, UTIL::Database::EventLogDriver*>::iterator it;
+
+        for (it = eventLogs_.begin(); it != eventLogs_.end(); it++)
+        {
+            // Closes the files
+            delete it->second;
+        }
+        eventLogs_.clear();
     }
 
     int push_back(StatsDb* db, const std::string &query)
     {
         take();
 
-        if (driver_ == NULL) {
-            if (db->engineType == UTIL::Database::dbMySQL)
-            {
-                driver_ = (UTIL::Database::DatabaseDriver*)
-                    new UTIL::Database::MysqlNativeDriver(
-                    *(UTIL::Database::MysqlNativeDriver*)db->driver);
-            }
-            else if (db->engineType == UTIL::Database::dbSqlite)
-            {
-                driver_ = (UTIL::Database::DatabaseDriver*)
-                    new UTIL::Database::Sqlite3Driver(
-                    *(UTIL::Database::Sqlite3Driver*)db->driver);
-            }
-            minQueryBuffer_ = db->minQueryBuffer;
-        }
-        
-        int size = UTIL::Interlock<std::string>::push_back_xxx(query);
+        createDriver(db);
+
+        DatabaseWork work;
+        work.query = query;
+        int size = UTIL::Interlock<DatabaseWork>::push_back_xxx(work);
         
         give();
 
@@ -148,6 +192,35 @@ public:
 
         return size;
     }
+
+    // Hand a batch of rows to the worker.  The rows are moved out of
+    // batch.  The worker is not woken; the caller wakes it once it has
+    // handed all its batches.
+    int push_back(StatsDb* db,
+                  UTIL::Database::DatabaseRowBatch& batch,
+                  bool toEventLog)
+    {
+        DatabaseWork work;
+        work.batch.swap(batch);
+        work.toEventLog = toEventLog;
+        if (toEventLog)
+        {
+            work.partitionId =
+                ((UTIL::Database::EventLogDriver*)db->eventLog)->partitionId;
+        }
+        batch.table = work.batch.table;
+        batch.columns = work.batch.columns;
+
+        take();
+
+        createDriver(db);
+
+        int size = UTIL::Interlock<DatabaseWork>::push_back_xxx(work);
+        
+        give();
+
+        return size;
+    }
 } ;
 
 #endif
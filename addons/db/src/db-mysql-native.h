@@ -22,6 +22,7 @@
 #include <vector>
 #include <iostream>
 #include <list>
+#include <map>
 #include <stdio.h> 
 #include <stdlib.h>
 
@@ -74,6 +75,13 @@ typedef unsigned int (CALLBACK* mysql_num_fields_cb)(MYSQL_RES*);
 typedef my_ulonglong (CALLBACK* mysql_affected_rows_cb)(MYSQL*);
 typedef char* (CALLBACK* mysql_error_cb)(MYSQL*);
 typedef unsigned int (CALLBACK* mysql_errno_cb)(MYSQL*);
+typedef MYSQL_STMT* (CALLBACK* mysql_stmt_init_cb)(MYSQL*);
+typedef int (CALLBACK* mysql_stmt_prepare_cb)(MYSQL_STMT*, const char*, unsigned long);
+typedef my_bool (CALLBACK* mysql_stmt_bind_param_cb)(MYSQL_STMT*, MYSQL_BIND*);
+typedef int (CALLBACK* mysql_stmt_execute_cb)(MYSQL_STMT*);
+typedef my_bool (CALLBACK* mysql_stmt_close_cb)(MYSQL_STMT*);
+typedef const char* (CALLBACK* mysql_stmt_error_cb)(MYSQL_STMT*);
+typedef unsigned int (CALLBACK* mysql_stmt_errno_cb)(MYSQL_STMT*);
 #else
 typedef MYSQL* (*mysql_init_cb)(MYSQL*);
 typedef void (*mysql_close_cb)(MYSQL*);
@@ -89,6 +97,13 @@ typedef unsigned int (*mysql_num_fields_cb)(MYSQL_RES*);
 typedef my_ulonglong (*mysql_affected_rows_cb)(MYSQL*);
 typedef char* (*mysql_error_cb)(MYSQL*);
 typedef unsigned int (*mysql_errno_cb)(MYSQL*);
+typedef MYSQL_STMT* (*mysql_stmt_init_cb)(MYSQL*);
+typedef int (*mysql_stmt_prepare_cb)(MYSQL_STMT*, const char*, unsigned long);
+typedef my_bool (*mysql_stmt_bind_param_cb)(MYSQL_STMT*, MYSQL_BIND*);
+typedef int (*mysql_stmt_execute_cb)(MYSQL_STMT*);
+typedef my_bool (*mysql_stmt_close_cb)(MYSQL_STMT*);
+typedef const char* (*mysql_stmt_error_cb)(MYSQL_STMT*);
+typedef unsigned int (*mysql_stmt_errno_cb)(MYSQL_STMT*);
 #endif
 
 struct MysqlNativeDriver : public DatabaseDriver
@@ -119,6 +134,16 @@ struct MysqlNativeDriver : public DatabaseDriver
     mysql_affected_rows_cb mysql_affected_rows_ptr;
     mysql_error_cb mysql_error_ptr;
     mysql_errno_cb mysql_errno_ptr;
+    mysql_stmt_init_cb mysql_stmt_init_ptr;
+    mysql_stmt_prepare_cb mysql_stmt_prepare_ptr;
+    mysql_stmt_bind_param_cb mysql_stmt_bind_param_ptr;
+    mysql_stmt_execute_cb mysql_stmt_execute_ptr;
+    mysql_stmt_close_cb mysql_stmt_close_ptr;
+    mysql_stmt_error_cb mysql_stmt_error_ptr;
+    mysql_stmt_errno_cb mysql_stmt_errno_ptr;
+
+    // Prepared INSERT statements of insertRows, by batch key
+    std::map<std::string, MYSQL_STMT*> statements;
     
     void init() {
         if (mysql_init_ptr(&conn) == NULL) {
@@ -140,6 +165,13 @@ struct MysqlNativeDriver : public DatabaseDriver
         mysql_affected_rows_ptr = NULL;
         mysql_error_ptr = NULL;
         mysql_errno_ptr = NULL;
+        mysql_stmt_init_ptr = NULL;
+        mysql_stmt_prepare_ptr = NULL;
+        mysql_stmt_bind_param_ptr = NULL;
+        mysql_stmt_execute_ptr = NULL;
+        mysql_stmt_close_ptr = NULL;
+        mysql_stmt_error_ptr = NULL;
+        mysql_stmt_errno_ptr = NULL;
 
         std::string productHomePath;
         BOOL success = Product::GetProductHome(productHomePath);
@@ -236,6 +268,41 @@ struct MysqlNativeDriver : public DatabaseDriver
             {
                 ERROR_ReportError("Cannot functions address to mysql_errno\n");
             }
+            mysql_stmt_init_ptr = (mysql_stmt_init_cb)GetProcAddress(dllHandle, "mysql_stmt_init");
+            if (!mysql_stmt_init_ptr)
+            {
+                ERROR_ReportError("Cannot functions address to mysql_stmt_init\n");
+            }
+            mysql_stmt_prepare_ptr = (mysql_stmt_prepare_cb)GetProcAddress(dllHandle, "mysql_stmt_prepare");
+            if (!mysql_stmt_prepare_ptr)
+            {
+                ERROR_ReportError("Cannot functions address to mysql_stmt_prepare\n");
+            }
+            mysql_stmt_bind_param_ptr = (mysql_stmt_bind_param_cb)GetProcAddress(dllHandle, "mysql_stmt_bind_param");
+            if (!mysql_stmt_bind_param_ptr)
+            {
+                ERROR_ReportError("Cannot functions address to mysql_stmt_bind_param\n");
+            }
+            mysql_stmt_execute_ptr = (mysql_stmt_execute_cb)GetProcAddress(dllHandle, "mysql_stmt_execute");
+            if (!mysql_stmt_execute_ptr)
+            {
+                ERROR_ReportError("Cannot functions address to mysql_stmt_execute\n");
+            }
+            mysql_stmt_close_ptr = (mysql_stmt_close_cb)GetProcAddress(dllHandle, "mysql_stmt_close");
+            if (!mysql_stmt_close_ptr)
+            {
+                ERROR_ReportError("Cannot functions address to mysql_stmt_close\n");
+            }
+            mysql_stmt_error_ptr = (mysql_stmt_error_cb)GetProcAddress(dllHandle, "mysql_stmt_error");
+            if (!mysql_stmt_error_ptr)
+            {
+                ERROR_ReportError("Cannot functions address to mysql_stmt_error\n");
+            }
+            mysql_stmt_errno_ptr = (mysql_stmt_errno_cb)GetProcAddress(dllHandle, "mysql_stmt_errno");
+            if (!mysql_stmt_errno_ptr)
+            {
+                ERROR_ReportError("Cannot functions address to mysql_stmt_errno\n");
+            }
         }
 #else
 
@@ -334,6 +401,48 @@ struct MysqlNativeDriver : public DatabaseDriver
             {                
                 ERROR_ReportError(error);
             }
+            mysql_stmt_init_ptr =
+                (mysql_stmt_init_cb) dlsym(handle, "mysql_stmt_init");
+            if ((error = dlerror()) != NULL)
+            {                
+                ERROR_ReportError(error);
+            }
+            mysql_stmt_prepare_ptr =
+                (mysql_stmt_prepare_cb) dlsym(handle, "mysql_stmt_prepare");
+            if ((error = dlerror()) != NULL)
+            {                
+                ERROR_ReportError(error);
+            }
+            mysql_stmt_bind_param_ptr =
+                (mysql_stmt_bind_param_cb) dlsym(handle, "mysql_stmt_bind_param");
+            if ((error = dlerror()) != NULL)
+            {                
+                ERROR_ReportError(error);
+            }
+            mysql_stmt_execute_ptr =
+                (mysql_stmt_execute_cb) dlsym(handle, "mysql_stmt_execute");
+            if ((error = dlerror()) != NULL)
+            {                
+                ERROR_ReportError(error);
+            }
+            mysql_stmt_close_ptr =
+                (mysql_stmt_close_cb) dlsym(handle, "mysql_stmt_close");
+            if ((error = dlerror()) != NULL)
+            {                
+                ERROR_ReportError(error);
+            }
+            mysql_stmt_error_ptr =
+                (mysql_stmt_error_cb) dlsym(handle, "mysql_stmt_error");
+            if ((error = dlerror()) != NULL)
+            {                
+                ERROR_ReportError(error);
+            }
+            mysql_stmt_errno_ptr =
+                (mysql_stmt_errno_cb) dlsym(handle, "mysql_stmt_errno");
+            if ((error = dlerror()) != NULL)
+            {                
+                ERROR_ReportError(error);
+            }
         }
 #endif
 
@@ -341,7 +450,11 @@ struct MysqlNativeDriver : public DatabaseDriver
 
 
 
-    MysqlNativeDriver(MysqlNativeDriver& db) {
+    // The copy opens its own connection, so it starts without prepared
+    // statements
+    MysqlNativeDriver(MysqlNativeDriver& db)
+    : statements()
+    {
         server = db.server;
         username = db.username;
         password = db.password;
@@ -349,6 +462,7 @@ struct MysqlNativeDriver : public DatabaseDriver
 
         setup();
         engineType = dbMySQL;
+        sleepCounter = 0;
     }
 
 
@@ -606,10 +720,156 @@ struct MysqlNativeDriver : public DatabaseDriver
 #endif /* DB_PERFORMANCE_MONITOR */
     }
 
+    MYSQL_STMT* prepare(const DatabaseRowBatch& batch)
+    {
+        std::string key = batch.key();
+        std::map<std::string, MYSQL_STMT*>::iterator it =
+            statements.find(key);
+
+        if (it != statements.end())
+        {
+            return it->second;
+        }
+
+        char errBuf[BUFSIZ];
+        std::string query = batch.insertSql();
+        MYSQL_STMT* stmt = mysql_stmt_init_ptr(&conn);
+
+        if (stmt == NULL)
+        {
+            sprintf(errBuf, "Cannot prepare MYSQL statement: %s.", error());
+            close();
+            ERROR_ReportError(errBuf);
+        }
+
+        if (mysql_stmt_prepare_ptr(stmt, query.c_str(), query.size()))
+        {
+            sprintf(errBuf, "Cannot prepare MYSQL statement: %s.",
+                    mysql_stmt_error_ptr(stmt));
+            mysql_stmt_close_ptr(stmt);
+            close();
+            ERROR_ReportError(errBuf);
+        }
+
+        statements[key] = stmt;
+        return stmt;
+    }
+
+    void insertRows(const DatabaseRowBatch& batch)
+    {
+        char errBuf[BUFSIZ];
+        MYSQL_STMT* stmt = prepare(batch);
+        size_t numColumns = batch.columns.size();
+        std::vector<MYSQL_BIND> bind(numColumns);
+        std::vector<unsigned long> length(numColumns);
+
+#ifdef DB_PERFORMANCE_MONITOR
+        clocktype start = WallClock::getTrueRealTime();
+#endif /* DB_PERFORMANCE_MONITOR */
+
+        for (size_t r = 0; r < batch.rows.size(); r++)
+        {
+            const DatabaseRow& row = batch.rows[r];
+
+            memset(&bind[0], 0, numColumns * sizeof(MYSQL_BIND));
+            for (size_t i = 0; i < row.size(); i++)
+            {
+                const DatabaseValue& value = row[i];
+
+                switch (value.type)
+                {
+                    case dbInteger:
+                        bind[i].buffer_type = MYSQL_TYPE_LONGLONG;
+                        bind[i].buffer = (void*) &value.intValue;
+                        break;
+                    case dbReal:
+                        bind[i].buffer_type = MYSQL_TYPE_DOUBLE;
+                        bind[i].buffer = (void*) &value.realValue;
+                        break;
+                    case dbText:
+                        length[i] = value.textValue.size();
+                        bind[i].buffer_type = MYSQL_TYPE_STRING;
+                        bind[i].buffer = (void*) value.textValue.data();
+                        bind[i].buffer_length = length[i];
+                        bind[i].length = &length[i];
+                        break;
+                    default:
+                        bind[i].buffer_type = MYSQL_TYPE_NULL;
+                        break;
+                }
+            }
+
+            if (mysql_stmt_bind_param_ptr(stmt, &bind[0]))
+            {
+                sprintf(errBuf, "Cannot bind MYSQL statement: %s.",
+                        mysql_stmt_error_ptr(stmt));
+                close();
+                ERROR_ReportError(errBuf);
+            }
+
+            sleepCounter = 0;
+            int err = mysql_stmt_execute_ptr(stmt);
+
+            while (err != 0 &&
+                   (mysql_stmt_errno_ptr(stmt) == ER_TABLE_NOT_LOCKED_FOR_WRITE ||
+                    mysql_stmt_errno_ptr(stmt) == ER_LOCK_OR_ACTIVE_TRANSACTION ||
+                    mysql_stmt_errno_ptr(stmt) == ER_CANT_UPDATE_WITH_READLOCK))
+            {
+                sleepCounter++;
+
+                if (sleepCounter > MAX_DB_SLEEP_COUNTER)
+                {
+                    sprintf(errBuf, "Sleep Timeout: Cannot execute MYSQL statement: %s.",
+                            mysql_stmt_error_ptr(stmt));
+                    close();
+                    ERROR_ReportError(errBuf);
+                }
+                else if (STATS_DEBUG_LOCK)
+                {
+                    sprintf(errBuf, "Error in SQL Read: %s, count %d\n",
+                            mysql_stmt_error_ptr(stmt), sleepCounter);
+                    ERROR_ReportWarning(errBuf);
+                }
+
+                EXTERNAL_Sleep(1 * SECOND);
+
+                err = mysql_stmt_execute_ptr(stmt);
+            }
+
+            if (err != 0)
+            {
+                sprintf(errBuf, "Cannot execute MYSQL statement: %s.",
+                        mysql_stmt_error_ptr(stmt));
+                close();
+                ERROR_ReportError(errBuf);
+            }
+        }
+
+#ifdef DB_PERFORMANCE_MONITOR
+        clocktype end = WallClock::getTrueRealTime();
+        clocktype diff = end - start;
+
+        char temp[MAX_STRING_LENGTH];
+        TIME_PrintClockInSecond(diff, temp);
+        
+        printf ("@B %s\n", temp);
+#endif /* DB_PERFORMANCE_MONITOR */
+    }
+
     void close()  {
+        std::map<std::string, MYSQL_STMT*>::iterator it;
+        for (it = statements.begin(); it != statements.end(); it++)
+        {
+            mysql_stmt_close_ptr(it->second);
+        }
+        statements.clear();
+
         mysql_close_ptr(&conn);
     }
-    
+
+private:
+    // Not assignable, the prepared statements belong to one connection
+    MysqlNativeDriver& operator=(const MysqlNativeDriver&);
 } ;
 
 }}
@@ -22,6 +22,7 @@
 #include <vector>
 #include <iostream>
 #include <list>
+#include <map>
 
 #include "fileio.h"
 #include "node.h"
@@ -41,15 +42,22 @@ struct Sqlite3Driver : public DatabaseDriver {
     sqlite3* dbFile;
     std::string dbFileName;
 
+    // Prepared INSERT statements of insertRows, by batch key
+    std::map<std::string, sqlite3_stmt*> statements;
+
     Sqlite3Driver(std::string p_dbFileName)
     : dbFileName(p_dbFileName)
     {
         engineType = dbSqlite;
     }
 
-    Sqlite3Driver(Sqlite3Driver& db) {
-        dbFileName = db.dbFileName;
+    // The copy opens its own connection, so it starts without prepared
+    // statements
+    Sqlite3Driver(Sqlite3Driver& db)
+    : dbFile(NULL), dbFileName(db.dbFileName), statements()
+    {
         engineType = dbSqlite;
+        sleepCounter = 0;
     }
 
     const char* error() {
@@ -62,6 +70,12 @@ struct Sqlite3Driver : public DatabaseDriver {
             printf("SQLITE3:closing\n");
         }
 
+        std::map<std::string, sqlite3_stmt*>::iterator it;
+        for (it = statements.begin(); it != statements.end(); it++) {
+            sqlite3_finalize(it->second);
+        }
+        statements.clear();
+
         sqlite3_close(dbFile);
 
         if (STATS_DEBUG) 
@@ -170,6 +184,102 @@ struct Sqlite3Driver : public DatabaseDriver {
         }
     }
     
+    sqlite3_stmt* prepare(const DatabaseRowBatch& batch) {
+        std::string key = batch.key();
+        std::map<std::string, sqlite3_stmt*>::iterator it =
+            statements.find(key);
+
+        if (it != statements.end()) {
+            return it->second;
+        }
+
+        char errBuf[BUFSIZ];
+        std::string query = batch.insertSql();
+        sqlite3_stmt* stmt = NULL;
+        int err = sqlite3_prepare_v2(dbFile,
+                                     query.c_str(),
+                                     -1,
+                                     &stmt,
+                                     NULL);
+
+        if (err != SQLITE_OK) {
+            sprintf(errBuf, "SQL error: %s\n", error());
+            printf ("Query is %s\n", query.c_str());
+            close();
+            ERROR_ReportError(errBuf);
+        }
+
+        statements[key] = stmt;
+        return stmt;
+    }
+
+    void insertRows(const DatabaseRowBatch& batch) {
+        char errBuf[BUFSIZ];
+        sqlite3_stmt* stmt = prepare(batch);
+
+        for (size_t r = 0; r < batch.rows.size(); r++) {
+            const DatabaseRow& row = batch.rows[r];
+
+            for (size_t i = 0; i < row.size(); i++) {
+                const DatabaseValue& value = row[i];
+                int col = (int) i + 1;
+
+                switch (value.type) {
+                    case dbInteger:
+                        sqlite3_bind_int64(stmt, col, value.intValue);
+                        break;
+                    case dbReal:
+                        sqlite3_bind_double(stmt, col, value.realValue);
+                        break;
+                    case dbText:
+                        sqlite3_bind_text(stmt,
+                                          col,
+                                          value.textValue.data(),
+                                          (int) value.textValue.size(),
+                                          SQLITE_STATIC);
+                        break;
+                    default:
+                        sqlite3_bind_null(stmt, col);
+                        break;
+                }
+            }
+
+            sleepCounter = 0;
+            int err = sqlite3_step(stmt);
+
+            while (err == SQLITE_LOCKED || err == SQLITE_BUSY) {
+                sleepCounter++;
+
+                if (sleepCounter > MAX_DB_SLEEP_COUNTER)
+                {
+                    sprintf(errBuf, "Sleep Timeout: Cannot execute SQLite statement: %s.", error());
+                    close();
+                    ERROR_ReportError(errBuf);
+                }
+                else if (STATS_DEBUG_LOCK)
+                {
+                    sprintf(errBuf, "Error in SQL Read: %s, count %d\n", error(), sleepCounter);
+                    ERROR_ReportWarning(errBuf);
+                }
+
+                EXTERNAL_Sleep(1 * SECOND);
+
+                sqlite3_reset(stmt);
+                err = sqlite3_step(stmt);
+            }
+
+            if (err != SQLITE_DONE) {
+                sprintf(errBuf, "SQL error: %s\n", error());
+                printf ("Query is %s\n", batch.insertSql().c_str());
+                close();
+                ERROR_ReportError(errBuf);
+            }
+
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+    }
+
     void exec(char* query) {
         std::string strQuery = query;
         exec(strQuery);
@@ -258,6 +368,10 @@ struct Sqlite3Driver : public DatabaseDriver {
                out.c_str()); 
 #endif /* DEBUG_MARSHALL */ 
     }
+
+private:
+    // Not assignable, the prepared statements belong to one connection
+    Sqlite3Driver& operator=(const Sqlite3Driver&);
 } ;
 
 }}
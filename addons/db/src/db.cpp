@@ -40,6 +40,7 @@
 #include "dbapi.h"
 #include "db-core.h"
 #include "db-sqlite3.h"
+#include "db-eventlog-driver.h"
 #include "application.h"
 #include "network_ip.h"
 #include "network_dualip.h"
@@ -349,6 +350,42 @@ void STATSDB_Initialize(PartitionData* partition,
             db->minQueryBuffer = intBuf;
         }
 
+        // Check if the event tables go to event log files
+        IO_ReadBool(
+            ANY_NODEID,
+            ANY_ADDRESS,
+            nodeInput,
+            "STATS-DB-EVENTS-LOG",
+            &wasFound,
+            &value);
+        if (wasFound && value)
+        {
+            Int32 segmentRows = EVENTLOG_DEFAULT_SEGMENT_ROWS;
+
+            IO_ReadInt(
+                ANY_NODEID,
+                ANY_ADDRESS,
+                nodeInput,
+                "STATS-DB-EVENTS-LOG-SEGMENT-ROWS",
+                &wasFound,
+                &intBuf);
+            if (wasFound)
+            {
+                if (intBuf <= 0)
+                {
+                    ERROR_ReportError(
+                        "STATS-DB-EVENTS-LOG-SEGMENT-ROWS must be positive\n");
+                }
+                segmentRows = intBuf;
+            }
+
+            db->eventLog = (UTIL::Database::DatabaseDriver*)
+                new UTIL::Database::EventLogDriver(db->statsDatabase,
+                                                   partition->partitionId,
+                                                   segmentRows);
+            db->eventLog->open(partition->partitionId == 0);
+        }
+
         /*/ Check for the existence of a separate meta data file
         IO_ReadString(
             ANY_NODEID,
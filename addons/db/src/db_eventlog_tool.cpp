@@ -0,0 +1,491 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+// Offline tool for the event log files of the statistics database.
+//
+//   eventlog info <file>...
+//       Print the table, segments, rows and columns of event logs.
+//   eventlog csv <file> [<output>] [-columns <name>,<name>...]
+//       Export an event log as CSV, to the standard output if no output
+//       file is given.  Only the given columns are read.
+//   eventlog sqlite <database> <file>...
+//       Load event logs into their tables of a SQLite database, creating
+//       the tables and columns that do not exist.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "db-eventlog.h"
+#include "sqlite3.h"
+
+using namespace UTIL::Database;
+
+static void Usage()
+{
+    fprintf(stderr,
+            "Usage: eventlog info <file>...\n"
+            "       eventlog csv <file> [<output>] "
+            "[-columns <name>,<name>...]\n"
+            "       eventlog sqlite <database> <file>...\n");
+    exit(1);
+}
+
+static void Fail(const std::string& message)
+{
+    fprintf(stderr, "eventlog: %s\n", message.c_str());
+    exit(1);
+}
+
+static const char* TypeName(EventLogType type)
+{
+    switch (type)
+    {
+        case EVENTLOG_INTEGER:
+            return "integer";
+        case EVENTLOG_REAL:
+            return "real";
+        case EVENTLOG_TEXT:
+            return "text";
+        default:
+            return "null";
+    }
+}
+
+// Columns of all segments of an event log, in order of appearance, with
+// the type of their first segment that has values
+static void ScanColumns(
+    const std::string& fileName,
+    std::vector<std::string>& names,
+    std::map<std::string, EventLogType>& types)
+{
+    EventLogReader reader;
+
+    if (!reader.open(fileName))
+    {
+        Fail(reader.error());
+    }
+
+    while (reader.nextSegment())
+    {
+        const std::vector<EventLogColumnInfo>& columns = reader.columns();
+
+        for (size_t i = 0; i < columns.size(); i++)
+        {
+            std::map<std::string, EventLogType>::iterator it =
+                types.find(columns[i].name);
+
+            if (it == types.end())
+            {
+                names.push_back(columns[i].name);
+                types[columns[i].name] = columns[i].type;
+            }
+            else if (it->second == EVENTLOG_NULL)
+            {
+                it->second = columns[i].type;
+            }
+        }
+    }
+}
+
+static void Info(int argc, char* argv[])
+{
+    for (int f = 0; f < argc; f++)
+    {
+        EventLogReader reader;
+        int numSegments = 0;
+        long long numRows = 0;
+        std::vector<std::string> names;
+        std::map<std::string, EventLogType> types;
+
+        if (!reader.open(argv[f]))
+        {
+            Fail(reader.error());
+        }
+        while (reader.nextSegment())
+        {
+            numSegments++;
+            numRows += reader.numRows();
+        }
+
+        ScanColumns(argv[f], names, types);
+
+        printf("%s: table %s, %d segments, %lld rows\n",
+               argv[f], reader.table().c_str(), numSegments, numRows);
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            printf("    %s %s\n", names[i].c_str(), TypeName(types[names[i]]));
+        }
+        if (!reader.error().empty())
+        {
+            printf("    %s\n", reader.error().c_str());
+        }
+    }
+}
+
+static void WriteCsvField(FILE* out, const std::string& value)
+{
+    if (value.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        fputs(value.c_str(), out);
+        return;
+    }
+
+    fputc('"', out);
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        if (value[i] == '"')
+        {
+            fputc('"', out);
+        }
+        fputc(value[i], out);
+    }
+    fputc('"', out);
+}
+
+static void Csv(int argc, char* argv[])
+{
+    std::string fileName;
+    std::string outputName;
+    std::vector<std::string> names;
+    std::map<std::string, EventLogType> types;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-columns") == 0 && i + 1 < argc)
+        {
+            std::string list = argv[++i];
+            size_t start = 0;
+
+            while (start <= list.size())
+            {
+                size_t comma = list.find(',', start);
+
+                if (comma == std::string::npos)
+                {
+                    comma = list.size();
+                }
+                if (comma > start)
+                {
+                    names.push_back(list.substr(start, comma - start));
+                }
+                start = comma + 1;
+            }
+        }
+        else if (fileName.empty())
+        {
+            fileName = argv[i];
+        }
+        else if (outputName.empty())
+        {
+            outputName = argv[i];
+        }
+        else
+        {
+            Usage();
+        }
+    }
+    if (fileName.empty())
+    {
+        Usage();
+    }
+    if (names.empty())
+    {
+        ScanColumns(fileName, names, types);
+    }
+
+    FILE* out = stdout;
+    if (!outputName.empty())
+    {
+        out = fopen(outputName.c_str(), "w");
+        if (out == NULL)
+        {
+            Fail("Cannot create " + outputName);
+        }
+    }
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (i > 0)
+        {
+            fputc(',', out);
+        }
+        WriteCsvField(out, names[i]);
+    }
+    fputc('\n', out);
+
+    EventLogReader reader;
+    std::vector<EventLogColumn> columns(names.size());
+    std::vector<bool> present(names.size());
+
+    if (!reader.open(fileName))
+    {
+        Fail(reader.error());
+    }
+    while (reader.nextSegment())
+    {
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            int index = reader.findColumn(names[i]);
+
+            present[i] = index >= 0;
+            if (present[i] && !reader.readColumn(index, columns[i]))
+            {
+                Fail(reader.error());
+            }
+        }
+
+        for (int row = 0; row < reader.numRows(); row++)
+        {
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                if (i > 0)
+                {
+                    fputc(',', out);
+                }
+                if (present[i])
+                {
+                    WriteCsvField(out, columns[i].toString(row));
+                }
+            }
+            fputc('\n', out);
+        }
+    }
+    if (!reader.error().empty())
+    {
+        fprintf(stderr, "eventlog: %s\n", reader.error().c_str());
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+}
+
+static void SqliteExec(sqlite3* db, const std::string& query)
+{
+    char* errMsg = NULL;
+
+    if (sqlite3_exec(db, query.c_str(), 0, 0, &errMsg) != SQLITE_OK)
+    {
+        std::string message = "SQL error: ";
+        message += errMsg;
+        sqlite3_free(errMsg);
+        Fail(message);
+    }
+}
+
+// Create the table of an event log in the database, or add the columns
+// it does not have yet
+static void SqliteCreateTable(
+    sqlite3* db,
+    const std::string& table,
+    const std::vector<std::string>& names,
+    std::map<std::string, EventLogType>& types)
+{
+    std::string query = "PRAGMA table_info(" + table + ");";
+    sqlite3_stmt* stmt = NULL;
+    std::map<std::string, bool> existing;
+
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL) != SQLITE_OK)
+    {
+        Fail(std::string("SQL error: ") + sqlite3_errmsg(db));
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        existing[(const char*) sqlite3_column_text(stmt, 1)] = true;
+    }
+    sqlite3_finalize(stmt);
+
+    if (existing.empty())
+    {
+        query = "CREATE TABLE " + table + " (";
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if (i > 0)
+            {
+                query += ", ";
+            }
+            query += names[i] + " " + TypeName(types[names[i]]);
+        }
+        query += ");";
+        SqliteExec(db, query);
+        return;
+    }
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (existing.find(names[i]) == existing.end())
+        {
+            SqliteExec(db,
+                       "ALTER TABLE " + table + " ADD COLUMN " + names[i]
+                       + " " + TypeName(types[names[i]]) + ";");
+        }
+    }
+}
+
+static void SqliteLoad(sqlite3* db, const std::string& fileName)
+{
+    EventLogReader reader;
+    std::vector<std::string> names;
+    std::map<std::string, EventLogType> types;
+    long long numRows = 0;
+
+    ScanColumns(fileName, names, types);
+    if (!reader.open(fileName))
+    {
+        Fail(reader.error());
+    }
+    SqliteCreateTable(db, reader.table(), names, types);
+
+    SqliteExec(db, "BEGIN EXCLUSIVE;");
+    while (reader.nextSegment())
+    {
+        const std::vector<EventLogColumnInfo>& info = reader.columns();
+        std::vector<EventLogColumn> columns(info.size());
+        std::string query = "INSERT INTO " + reader.table() + "(";
+        std::string values = "VALUES(";
+        sqlite3_stmt* stmt = NULL;
+
+        for (size_t i = 0; i < info.size(); i++)
+        {
+            if (!reader.readColumn((int) i, columns[i]))
+            {
+                Fail(reader.error());
+            }
+            if (i > 0)
+            {
+                query += ",";
+                values += ",";
+            }
+            query += info[i].name;
+            values += "?";
+        }
+        query += ") " + values + ");";
+
+        if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULL)
+            != SQLITE_OK)
+        {
+            Fail(std::string("SQL error: ") + sqlite3_errmsg(db));
+        }
+
+        for (int row = 0; row < reader.numRows(); row++)
+        {
+            for (size_t i = 0; i < columns.size(); i++)
+            {
+                const EventLogColumn& column = columns[i];
+                int col = (int) i + 1;
+
+                if (column.isNull[row])
+                {
+                    sqlite3_bind_null(stmt, col);
+                    continue;
+                }
+                switch (column.type)
+                {
+                    case EVENTLOG_INTEGER:
+                        sqlite3_bind_int64(stmt, col, column.intValues[row]);
+                        break;
+                    case EVENTLOG_REAL:
+                        sqlite3_bind_double(stmt, col, column.realValues[row]);
+                        break;
+                    case EVENTLOG_TEXT:
+                        sqlite3_bind_text(stmt,
+                                          col,
+                                          column.textValues[row].data(),
+                                          (int) column.textValues[row].size(),
+                                          SQLITE_STATIC);
+                        break;
+                    default:
+                        sqlite3_bind_null(stmt, col);
+                        break;
+                }
+            }
+
+            if (sqlite3_step(stmt) != SQLITE_DONE)
+            {
+                Fail(std::string("SQL error: ") + sqlite3_errmsg(db));
+            }
+            sqlite3_reset(stmt);
+        }
+        sqlite3_finalize(stmt);
+        numRows += reader.numRows();
+    }
+    SqliteExec(db, "COMMIT;");
+
+    printf("%s: %lld rows loaded into %s\n",
+           fileName.c_str(), numRows, reader.table().c_str());
+    if (!reader.error().empty())
+    {
+        fprintf(stderr, "eventlog: %s: %s\n",
+                fileName.c_str(), reader.error().c_str());
+    }
+}
+
+static void Sqlite(int argc, char* argv[])
+{
+    sqlite3* db = NULL;
+
+    if (argc < 2)
+    {
+        Usage();
+    }
+
+    if (sqlite3_open(argv[0], &db) != SQLITE_OK)
+    {
+        Fail(std::string("Cannot open database: ") + sqlite3_errmsg(db));
+    }
+    SqliteExec(db, "PRAGMA synchronous=OFF;");
+
+    for (int f = 1; f < argc; f++)
+    {
+        SqliteLoad(db, argv[f]);
+    }
+
+    sqlite3_close(db);
+}
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        Usage();
+    }
+
+    if (strcmp(argv[1], "info") == 0)
+    {
+        Info(argc - 2, argv + 2);
+    }
+    else if (strcmp(argv[1], "csv") == 0)
+    {
+        Csv(argc - 2, argv + 2);
+    }
+    else if (strcmp(argv[1], "sqlite") == 0)
+    {
+        Sqlite(argc - 2, argv + 2);
+    }
+    else
+    {
+        Usage();
+    }
+
+    return 0;
+}
@@ -65,8 +65,65 @@ const char StatsDBNetworkEventContent::formatString[] =
     "('%f', '%d', '%s', '%s', '%s', '%d', '%s'"
     "%s%s%s%s%s%s%s%s)";
 
+// Check if the rows of a batch go to the event log instead of the
+// database.  Only the event tables are written to the event log.
+static bool IsEventLogBatchStatsDb(
+    StatsDb* db,
+    const UTIL::Database::DatabaseRowBatch& batch)
+{
+    const std::string suffix = "_Events";
+
+    return db->eventLog != NULL
+           && batch.table.size() > suffix.size()
+           && batch.table.compare(batch.table.size() - suffix.size(),
+                                  suffix.size(),
+                                  suffix) == 0;
+}
+
+// Check if InsertRow has buffered rows for the database.  A query must
+// not be executed before them, since it may depend on them.
+static bool HasDatabaseRowsStatsDb(StatsDb* db)
+{
+    std::map<std::string, UTIL::Database::DatabaseRowBatch>::iterator it;
+
+    for (it = db->rowBatches.begin(); it != db->rowBatches.end(); it++)
+    {
+        if (!it->second.rows.empty()
+            && !IsEventLogBatchStatsDb(db, it->second))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Hand the buffered rows of InsertRow to the worker thread
+static void HandOverRowBatchesStatsDb_WT(StatsDb* db)
+{
+    bool handedOver = false;
+    std::map<std::string, UTIL::Database::DatabaseRowBatch>::iterator it;
+
+    for (it = db->rowBatches.begin(); it != db->rowBatches.end(); it++)
+    {
+        if (!it->second.rows.empty())
+        {
+            dbInterlock.push_back(db,
+                                  it->second,
+                                  IsEventLogBatchStatsDb(db, it->second));
+            handedOver = true;
+        }
+    }
+    db->numQueryBuffer = 0;
+
+    if (handedOver)
+    {
+        dbInterlock.force_wake();
+    }
+}
+
 static void FlushQueryBufferStatsDb_WT(StatsDb* db)
 {
+    HandOverRowBatchesStatsDb_WT(db);
     dbInterlock.sync();
 }
 
@@ -77,9 +134,26 @@ static void AddInsertQueryToBufferStatsDb__WT(StatsDb* db, const std::string &qu
         printf("Inserting query %s\n", queryStr.c_str());
     }
 
+    // Keep the order of submission: rows inserted before the query go
+    // to the worker before it
+    if (HasDatabaseRowsStatsDb(db))
+    {
+        HandOverRowBatchesStatsDb_WT(db);
+    }
+
     dbInterlock.push_back(db, queryStr);
 }
 
+static void AddInsertRowToBufferStatsDb__WT(StatsDb* db)
+{
+    db->numQueryBuffer++;
+
+    if (db->numQueryBuffer >= db->minQueryBuffer)
+    {
+        HandOverRowBatchesStatsDb_WT(db);
+    }
+}
+
 
 static void StatsDbFinalize__WT(PartitionData* partition)
 {
@@ -285,24 +359,53 @@ static void StatsDbFinalize__WT(PartitionData* partition)
         }
     }
 #endif 
+
+    HandOverRowBatchesStatsDb_WT(db);
 }
 
 static void StatsDbFinalize__WT(void)
 {
     dbInterlock.finalize();
 }
+// Insert the buffered rows of InsertRow through the prepared statements
+// of the driver
+static void InsertRowBatchesStatsDb_ST(StatsDb* db)
+{
+    std::map<std::string, UTIL::Database::DatabaseRowBatch>::iterator it;
+
+    for (it = db->rowBatches.begin(); it != db->rowBatches.end(); it++)
+    {
+        if (it->second.rows.empty())
+        {
+            continue;
+        }
+
+        if (IsEventLogBatchStatsDb(db, it->second))
+        {
+            db->eventLog->insertRows(it->second);
+        }
+        else
+        {
+            db->driver->insertRows(it->second);
+        }
+        it->second.rows.clear();
+    }
+}
+
 static void FlushQueryBufferStatsDb_ST(StatsDb* db)
 {
     if (db->engineType == UTIL::Database::dbSqlite)
     {
-        if (!db->queryBuffer.empty())
+        if (!db->queryBuffer.empty() || db->numQueryBuffer > 0)
         {
             std::string tempStr = "BEGIN EXCLUSIVE;";
             tempStr += db->queryBuffer;
-            tempStr += "COMMIT;";
 
             db->driver->exec(tempStr);
             db->queryBuffer.clear();
+
+            InsertRowBatchesStatsDb_ST(db);
+            db->driver->exec("COMMIT;");
         }
 
     }
@@ -314,6 +417,8 @@ static void FlushQueryBufferStatsDb_ST(StatsDb* db)
         }
         
         db->buffer.clear();
+
+        InsertRowBatchesStatsDb_ST(db);
     }
     db->numQueryBuffer = 0;
 }
@@ -323,6 +428,13 @@ static void AddInsertQueryToBufferStatsDb__ST(StatsDb* db,
     clocktype start = 0;
     clocktype end = 0;
 
+    // The buffered queries are executed before the buffered rows, so
+    // rows inserted before this query are written first
+    if (HasDatabaseRowsStatsDb(db))
+    {
+        FlushQueryBufferStatsDb_ST(db);
+    }
+
     db->numQueryBuffer++;
        
     if (db->engineType == UTIL::Database::dbSqlite)
@@ -358,6 +470,19 @@ static void AddInsertQueryToBufferStatsDb__ST(StatsDb* db,
     }
 }
 
+static void AddInsertRowToBufferStatsDb__ST(StatsDb* db)
+{
+    db->numQueryBuffer++;
+
+    if (db->numQueryBuffer < db->minQueryBuffer)
+    {
+        // Do not insert. Wait
+        return;
+    }
+
+    FlushQueryBufferStatsDb(db);
+}
+
 static void StatsDbFinalize__ST(PartitionData* partition)
 {
     StatsDb* db = partition->statsDb;
@@ -523,6 +648,10 @@ void StatsDbDriverClose(PartitionData* partition)
     {
         db->driver->close();
     }
+    if (db && db->eventLog)
+    {
+        db->eventLog->close();
+    }
 
 }
 void StatsDbFinalize(void)
@@ -585,6 +714,36 @@ void AddInsertQueryToBufferStatsDb(StatsDb* db,
     }
 }
 
+void InsertRow(
+    StatsDb* db,
+    const std::string& table,
+    const std::vector<std::string>& columns,
+    const UTIL::Database::DatabaseRow& row)
+{
+    ERROR_Assert(columns.size() == row.size(),
+                 "Row does not have a value for each column");
+
+    UTIL::Database::DatabaseRowBatch& batch =
+        db->rowBatches[UTIL::Database::DatabaseRowBatch::makeKey(table,
+                                                                 columns)];
+
+    if (batch.table.empty())
+    {
+        batch.table = table;
+        batch.columns = columns;
+    }
+    batch.rows.push_back(row);
+
+    if (UTIL::Database::useWorkerThread())
+    {
+        AddInsertRowToBufferStatsDb__WT(db);
+    }
+    else
+    {
+        AddInsertRowToBufferStatsDb__ST(db);
+    }
+}
+
 void FlushQueryBufferStatsDb(StatsDb* db)
 {
     bool useWorkerThreads = UTIL::Database::useWorkerThread();
@@ -633,6 +792,7 @@ void InitializePartitionStatsDb(StatsDb* statsDb)
 
     statsDb->createDbFile = FALSE;
     statsDb->driver = NULL;
+    statsDb->eventLog = NULL;
 
     statsDb->numQueryBuffer = 0;
     statsDb->maxQueryBuffer = STATSDB_MAX_BUFFER_QUERY;
@@ -5688,7 +5848,7 @@ void STATSDB_HandleAppEventsTableUpdate(Node* node,
     db = node->partitionData->statsDb;
     StatsDBAppEventContent *appEvent = db->statsAppEvents;
 
-    if (appEvent->multipleValues)
+    if (appEvent->multipleValues && db->eventLog == NULL)
     {
         if (db->engineType == UTIL::Database::dbMySQL)
         {
@@ -5886,66 +6046,65 @@ void STATSDB_HandleAppEventsTableUpdate(Node* node,
     // Following code is executed in the following cases:
     // 1) With NATIVE MYSQL and appEvent->multipleValues is FALSE.
     // 2) With SQLlite.
-    std::vector<std::string> newValues;
+    UTIL::Database::DatabaseRow newValues;
     newValues.reserve(18);
     std::vector<std::string> columns;
     columns.reserve(18);
 
     columns.push_back("Timestamp");
-    newValues.push_back(
-        STATSDB_DoubleToString((double) getSimTime(node) / SECOND));
+    newValues.push_back((double) getSimTime(node) / SECOND);
     columns.push_back("NodeId");
-    newValues.push_back(STATSDB_IntToString(node->nodeId));
+    newValues.push_back(node->nodeId);
     columns.push_back("SessionInitiator");
-    newValues.push_back(STATSDB_IntToString(appParam.m_SessionInitiator));
+    newValues.push_back(appParam.m_SessionInitiator);
     columns.push_back("ReceiverId");
     if (appParam.m_ReceiverId == 0 || appParam.m_ReceiverId == -1)
     {
-        newValues.push_back("0");
+        newValues.push_back(0);
     }
     else
     {
-        newValues.push_back(STATSDB_IntToString(appParam.m_ReceiverId));
+        newValues.push_back(appParam.m_ReceiverId);
     }
     columns.push_back("ReceiverAddress");
     if (appParam.m_TargetAddrSpecified == FALSE)
     {
-        newValues.push_back("NULL");
+        newValues.push_back(UTIL::Database::DatabaseValue());
     }
     else
     {
         IO_ConvertIpAddressToString(
             const_cast<Address *>(&appParam.m_TargetAddr), addrBuf);
-        newValues.push_back(std::string(addrBuf));
+        newValues.push_back(addrBuf);
     }
     columns.push_back("MessageId");
     newValues.push_back(appParam.m_MessageId);
     columns.push_back("Size");
-    newValues.push_back(STATSDB_IntToString(appParam.m_MsgSize));
+    newValues.push_back(appParam.m_MsgSize);
     columns.push_back("EventType");
     newValues.push_back(appParam.m_EventType);
 
     if (appParam.m_MsgSeqNumSpecified && appEvent->isMsgSeqNum)
     {
         columns.push_back("MessageSeqNum");
-        newValues.push_back(STATSDB_IntToString(appParam.m_MsgSeqNum));
+        newValues.push_back(appParam.m_MsgSeqNum);
     }
     if (appParam.m_SessionIdSpecified && appEvent->isSession)
     {
         columns.push_back("SessionId");
-        newValues.push_back(STATSDB_IntToString(appParam.m_SessionId));
+        newValues.push_back(appParam.m_SessionId);
     }
 
     columns.push_back("ApplicationType");
-    newValues.push_back(std::string(appParam.m_ApplicationType));
+    newValues.push_back(appParam.m_ApplicationType);
 
     columns.push_back("ApplicationName");
-    newValues.push_back(std::string(appParam.m_ApplicationName));
+    newValues.push_back(appParam.m_ApplicationName);
 
     if (appParam.m_PrioritySpecified && appEvent->isPriority)
     {
         columns.push_back("Priority");
-        newValues.push_back(STATSDB_IntToString(appParam.m_Priority));
+        newValues.push_back(appParam.m_Priority);
     }
     if (appParam.m_MsgFailureTypeSpecified && appEvent->isMsgFailureType)
     {
@@ -5955,14 +6114,12 @@ void STATSDB_HandleAppEventsTableUpdate(Node* node,
     if (appParam.m_DelaySpecified && appEvent->isDelay)
     {
         columns.push_back("Delay");
-        newValues.push_back(
-            STATSDB_DoubleToString((double) appParam.m_Delay / SECOND));
+        newValues.push_back((double) appParam.m_Delay / SECOND);
     }
     if (appParam.m_JitterSpecified && appEvent->isJitter)
     {
         columns.push_back("Jitter");
-        newValues.push_back(
-            STATSDB_DoubleToString((double) appParam.m_Jitter / SECOND));
+        newValues.push_back((double) appParam.m_Jitter / SECOND);
     }
     if (appParam.m_SocketInterfaceMsgIdSpecified && appEvent->isSocketInterfaceMsgIds)
     {
@@ -5974,7 +6131,7 @@ void STATSDB_HandleAppEventsTableUpdate(Node* node,
             STATSDB_UInt64ToString(appParam.m_SocketInterfaceMsgId2));
     }
 
-    InsertValues(db, "APPLICATION_Events", columns, newValues);
+    InsertRow(db, "APPLICATION_Events", columns, newValues);
 }
 
 
@@ -6074,7 +6231,7 @@ void STATSDB_HandleNetworkEventsTableUpdate(Node* node,
         sprintf(buf9, ", '%f'", networkParam.m_HopCount);
     }
 
-    if (db->statsNetEvents->multipleValues)
+    if (db->statsNetEvents->multipleValues && db->eventLog == NULL)
     {
         if (db->engineType == UTIL::Database::dbMySQL)
         {
@@ -6177,23 +6334,138 @@ void STATSDB_HandleNetworkEventsTableUpdate(Node* node,
             return;
         }
     }
-     sprintf(buf,
-         "%s('%f', '%d', '%s', '%s', '%s', '%d', '%s'"
-            "%s%s%s%s%s%s%s%s);",
-            db->statsNetEvents->networkEventsTbColsName,
-            timeVal,
-            node->nodeId,
-            mapParamInfo->msgId,
-            senderAddr,
-            receiverAddr,
-            networkParam.m_MsgSize,
-            eventType,
-            buf2, buf3, buf4,
-            buf5, buf6,
-            buf7, buf8, buf9);
+    // The columns are those of networkEventsTbColsName
+    UTIL::Database::DatabaseRow newValues;
+    newValues.reserve(15);
+    std::vector<std::string> columns;
+    columns.reserve(15);
+
+    columns.push_back("Timestamp");
+    newValues.push_back(timeVal);
+    columns.push_back("NodeId");
+    newValues.push_back(node->nodeId);
+    columns.push_back("MessageId");
+    newValues.push_back(mapParamInfo->msgId);
+    columns.push_back("SenderAddress");
+    newValues.push_back(senderAddr);
+    columns.push_back("ReceiverAddress");
+    newValues.push_back(receiverAddr);
+    columns.push_back("PacketSize");
+    newValues.push_back(networkParam.m_MsgSize);
+    columns.push_back("EventType");
+    newValues.push_back(eventType);
 
+    columns.push_back("InterfaceIndex");
+    if (!networkParam.m_InterfaceIndexSpecified)
+    {
+        newValues.push_back(UTIL::Database::DatabaseValue());
+    }
+    else if (networkParam.m_InterfaceIndex >= 0)
+    {
+        newValues.push_back(
+            STATSDB_IntToString(networkParam.m_InterfaceIndex));
+    }
+    else if (networkParam.m_InterfaceIndex == CPU_INTERFACE)
+    {
+        newValues.push_back("CPU");
+    }
+    else
+    {
+        newValues.push_back("BACKPLANE");
+    }
+    if (ipEvent->isMsgSeqNum)
+    {
+        columns.push_back("MessageSeqNum");
+        if (networkParam.m_MsgSeqNumSpecified)
+        {
+            newValues.push_back(networkParam.m_MsgSeqNum);
+        }
+        else
+        {
+            newValues.push_back(UTIL::Database::DatabaseValue());
+        }
+    }
+    if (ipEvent->isControlSize)
+    {
+        columns.push_back("OverheadSize");
+        if (networkParam.m_HdrSizeSpecified)
+        {
+            newValues.push_back(networkParam.m_HeaderSize);
+        }
+        else
+        {
+            newValues.push_back(UTIL::Database::DatabaseValue());
+        }
+    }
+    if (ipEvent->isPktType)
+    {
+        columns.push_back("PacketType");
+        if (!networkParam.m_PktTypeSpecified)
+        {
+            newValues.push_back(UTIL::Database::DatabaseValue());
+        }
+        else if (networkParam.m_PktType == StatsDBNetworkEventParam::DATA)
+        {
+            newValues.push_back("Data");
+        }
+        else
+        {
+            newValues.push_back("Control");
+        }
+    }
+    if (ipEvent->isProtocolType)
+    {
+        columns.push_back("ProtocolType");
+        if (networkParam.m_ProtocolTypeSpecified)
+        {
+            std::string protocolType;
+            NetworkIpConvertIpProtocolNumToString(
+                networkParam.m_ProtocolType, &protocolType);
+            newValues.push_back(protocolType);
+        }
+        else
+        {
+            newValues.push_back(UTIL::Database::DatabaseValue());
+        }
+    }
+    if (ipEvent->isPriority)
+    {
+        columns.push_back("Priority");
+        if (networkParam.m_PrioritySpecified)
+        {
+            newValues.push_back(networkParam.m_Priority);
+        }
+        else
+        {
+            newValues.push_back(UTIL::Database::DatabaseValue());
+        }
+    }
+    if (ipEvent->isPktFailureType)
+    {
+        columns.push_back("PacketFailureType");
+        if (failureSpecified)
+        {
+            newValues.push_back(failure);
+        }
+        else
+        {
+            newValues.push_back(UTIL::Database::DatabaseValue());
+        }
+    }
+    if (ipEvent->isHopCount)
+    {
+        columns.push_back("HopCount");
+        if (networkParam.m_HopCountSpecified)
+        {
+            newValues.push_back(networkParam.m_HopCount);
+        }
+        else
+        {
+            newValues.push_back(UTIL::Database::DatabaseValue());
+        }
+    }
 
-     AddInsertQueryToBuffer(db, std::string(buf));
+    InsertRow(db, "NETWORK_Events", columns, newValues);
 }
 
 //--------------------------------------------------------------------//
@@ -6220,19 +6492,19 @@ void STATSDB_HandlePhyEventsTableInsert(Node* node,
     }
     std::vector<std::string> columns;
     columns.reserve(12);
-    std::vector<std::string> newValues;
+    UTIL::Database::DatabaseRow newValues;
     newValues.reserve(12);
 
     columns.push_back("Timestamp");
-    newValues.push_back(STATSDB_DoubleToString((double) getSimTime(node) / SECOND));
+    newValues.push_back((double) getSimTime(node) / SECOND);
     columns.push_back("NodeId");
-    newValues.push_back(STATSDB_IntToString(node->nodeId));
+    newValues.push_back(node->nodeId);
     columns.push_back("MessageId");
     newValues.push_back(phyParam.m_MessageId);
     columns.push_back("PhyIndex");
-    newValues.push_back(STATSDB_IntToString(phyParam.m_PhyIndex));    
+    newValues.push_back(phyParam.m_PhyIndex);    
     columns.push_back("Size");
-    newValues.push_back(STATSDB_IntToString(phyParam.m_MsgSize));
+    newValues.push_back(phyParam.m_MsgSize);
     columns.push_back("EventType");
     newValues.push_back(phyParam.m_EventType);
 
@@ -6241,17 +6513,17 @@ void STATSDB_HandlePhyEventsTableInsert(Node* node,
     if (phyParam.m_ChannelIndexSpecified && phyEvent->isChannelIndex)
     {
         columns.push_back("ChannelIndex");
-        newValues.push_back(STATSDB_IntToString(phyParam.m_ChannelIndex));
+        newValues.push_back(phyParam.m_ChannelIndex);
     }
     if (phyParam.m_ControlSizeSpecified && phyEvent->isControlSize)
     {
         columns.push_back("OverheadSize");
-        newValues.push_back(STATSDB_IntToString(phyParam.m_ControlSize));
+        newValues.push_back(phyParam.m_ControlSize);
     }
     if (phyParam.m_InterferenceSpecified && phyEvent->isInterference)
     {
         columns.push_back("Interference");
-        newValues.push_back(STATSDB_DoubleToString(phyParam.m_Interference));
+        newValues.push_back(phyParam.m_Interference);
     }
     if (phyParam.m_MessageFailureTypeSpecified && phyEvent->isMessageFailureType)
     {
@@ -6261,15 +6533,15 @@ void STATSDB_HandlePhyEventsTableInsert(Node* node,
     if (phyParam.m_PathLossSpecified && phyEvent->isPathLoss)
     {
         columns.push_back("PathLoss");
-        newValues.push_back(STATSDB_DoubleToString(phyParam.m_PathLoss));
+        newValues.push_back(phyParam.m_PathLoss);
     }
     if (phyParam.m_SignalPowerSpecified && phyEvent->isSignalPower)
     {
         columns.push_back("SignalPower");
-        newValues.push_back(STATSDB_DoubleToString(phyParam.m_SignalPower));
+        newValues.push_back(phyParam.m_SignalPower);
     }
 
-    InsertValues(db, "PHY_Events", columns, newValues);
+    InsertRow(db, "PHY_Events", columns, newValues);
 }
 
 void STATSDB_HandleMacEventsTableInsert(Node* node,
@@ -6280,33 +6552,33 @@ void STATSDB_HandleMacEventsTableInsert(Node* node,
     StatsDb* db = NULL;
     db = node->partitionData->statsDb;
 
-    std::vector<std::string> newValues;
+    UTIL::Database::DatabaseRow newValues;
     newValues.reserve(17);
     std::vector<std::string> columns;
     columns.reserve(17);
 
     columns.push_back("Timestamp");
-    newValues.push_back(STATSDB_DoubleToString((double) getSimTime(node) / SECOND));
+    newValues.push_back((double) getSimTime(node) / SECOND);
     columns.push_back("NodeId");
-    newValues.push_back(STATSDB_IntToString(node->nodeId));
+    newValues.push_back(node->nodeId);
     columns.push_back("MessageId");
     newValues.push_back(macParam.m_MessageId);
     columns.push_back("InterfaceIndex");
-    newValues.push_back(STATSDB_IntToString(macParam.m_InterfaceIndex));
+    newValues.push_back(macParam.m_InterfaceIndex);
     columns.push_back("MessageSize");
-    newValues.push_back(STATSDB_IntToString(macParam.m_MsgSize));
+    newValues.push_back(macParam.m_MsgSize);
     columns.push_back("EventType");
     newValues.push_back(macParam.m_EventType);
 
     if (macParam.m_MsgSeqNumSpecified)
     {
         columns.push_back("SequenceNumber");
-        newValues.push_back(STATSDB_IntToString(macParam.m_MsgSeqNum));
+        newValues.push_back(macParam.m_MsgSeqNum);
     }
     if (macParam.m_ChannelIndexSpecified)
     {
         columns.push_back("ChannelIndex");
-        newValues.push_back(STATSDB_IntToString(macParam.m_ChannelIndex));
+        newValues.push_back(macParam.m_ChannelIndex);
     }
     if (macParam.m_FailureTypeSpecified)
     {
@@ -6316,7 +6588,7 @@ void STATSDB_HandleMacEventsTableInsert(Node* node,
     if (macParam.m_HdrSizeSpecified)
     {
         columns.push_back("OverheadSize");
-        newValues.push_back(STATSDB_IntToString(macParam.m_HeaderSize));
+        newValues.push_back(macParam.m_HeaderSize);
     }
     if (macParam.m_FrameTypeSpecified)
     {
@@ -6356,7 +6628,7 @@ void STATSDB_HandleMacEventsTableInsert(Node* node,
     //    newValues.push_back(STATSDB_IntToString(macParam.m_NetworkFragNumber));
     //}
 
-    InsertValues(db, "MAC_Events", columns, newValues);
+    InsertRow(db, "MAC_Events", columns, newValues);
 }
 
 void HandleStatsDBMessageIdMappingInsert(Node *node,
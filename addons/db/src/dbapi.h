@@ -22,6 +22,7 @@
 #include <vector>
 #include <iostream>
 #include <list>
+#include <map>
 
 #include "fileio.h"
 #include "node.h"
@@ -230,6 +231,9 @@ struct StatsDb
 {
     BOOL createDbFile;
     UTIL::Database::DatabaseDriver* driver;
+    // Driver of the event tables if they are written to event log
+    // files instead of the database, NULL otherwise
+    UTIL::Database::DatabaseDriver* eventLog;
     UTIL::Database::dbEngineType engineType;
     char statsDatabase[MAX_STRING_LENGTH];
     StatsDBLevelSetting levelSetting;
@@ -277,6 +281,9 @@ struct StatsDb
     Int32 minQueryBuffer;
     std::string queryBuffer; //Buffer for sqlite queries - can be executed all at once
     std::list<std::string> buffer;  //Buffer for mysql queries - need to be executed individually
+    //Buffer for rows of InsertRow, by table and columns. The rows are
+    //bound to prepared statements when the buffers are flushed.
+    std::map<std::string, UTIL::Database::DatabaseRowBatch> rowBatches;
 
     /*---------------------------------*/
     StatsDb(): queueDbPtr(0), networkEventsBytesUsed(0), appEventsBytesUsed(0), engineType(UTIL::Database::dbSqlite)
@@ -1702,6 +1709,24 @@ struct StatsDBMulticastStatus
 void AddInsertQueryToBufferStatsDb(StatsDb* db, const std::string &queryStr);
 void FlushQueryBufferStatsDb(StatsDb* db);
 
+//--------------------------------------------------------------------------
+// FUNCTION:  InsertRow
+// PURPOSE : buffers a row for insertion through a prepared statement.
+//      Rows of a table that set the same columns are inserted as one
+//      batch, without building SQL text for each row.
+// PARAMETERS
+// + db : StatsDb* : Pointer to the database
+// + table : std::string : name of the table
+// + columns : std::vector<std::string> : column names of the row
+// + row : UTIL::Database::DatabaseRow : typed values, one per column
+// RETURN void.
+//--------------------------------------------------------------------------
+void InsertRow(
+    StatsDb* db,
+    const std::string& table,
+    const std::vector<std::string>& columns,
+    const UTIL::Database::DatabaseRow& row);
+
 void InitializePartitionStatsDb(StatsDb* statsDb);
 
 void STATSDB_CreateNodeMetaDataColumns(PartitionData* partition,
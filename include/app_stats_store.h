@@ -0,0 +1,92 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#ifndef APP_STATS_STORE_H
+#define APP_STATS_STORE_H
+
+#include <string>
+#include <fstream>
+
+#include "application.h"
+
+// /**
+// CLASS       :: APPStatsStore
+// DESCRIPTION :: Application metric records used by the handover
+//                decision.  A record is written to the output file and
+//                handed to the listener when it is added.  No record is
+//                kept in memory, so the listener must fold in each record
+//                as it arrives.
+// **/
+class APPStatsStore
+{
+public:
+    typedef void (*Listener)(const APPStatsNew& stats);
+
+    APPStatsStore(const char* fileName);
+    ~APPStatsStore();
+
+    // /**
+    // API        :: APPStatsStore.Add
+    // PURPOSE    :: Add a record, hand it to the listener and write it to
+    //               the output file
+    // PARAMETERS ::
+    // + stats     : const APPStatsNew& : record
+    // RETURN     :: void : NULL
+    // **/
+    void Add(const APPStatsNew& stats);
+
+    // /**
+    // API        :: APPStatsStore.SetListener
+    // PURPOSE    :: Set the function called with every record added.
+    //               NULL removes the listener.
+    // PARAMETERS ::
+    // + listener  : Listener : listener
+    // RETURN     :: void : NULL
+    // **/
+    void SetListener(Listener listener)
+    {
+        m_listener = listener;
+    }
+
+    // /**
+    // API        :: APPStatsStore.Close
+    // PURPOSE    :: Flush and close the output file.  The file is created
+    //               even if no record was added.
+    // PARAMETERS ::
+    // RETURN     :: void : NULL
+    // **/
+    void Close();
+
+private:
+    void OpenFile();
+    void WriteRecord(const APPStatsNew& stats);
+
+    Listener m_listener;
+
+    std::string m_fileName;
+    std::ofstream m_file;
+    bool m_isOpen;
+    bool m_isClosed;
+
+    APPStatsStore(const APPStatsStore&);
+    APPStatsStore& operator=(const APPStatsStore&);
+};
+
+// Records of the HLA interface, written to AppData.txt
+extern APPStatsStore g_APPStatsStore;
+
+#endif /* APP_STATS_STORE_H */
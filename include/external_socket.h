@@ -122,9 +122,40 @@ struct EXTERNAL_Socket
     pthread_mutex_t* sendMutex;
     pthread_cond_t* sendNotFull;
     pthread_cond_t* sendNotEmpty;
+
+    // Descriptor the receiver thread writes to after it received data or
+    // the connection failed, -1 if none.  Used to wake up a thread
+    // waiting in EXTERNAL_SocketPollerWait.
+    volatile int notifyFd;
 #endif /* NO_SOCKET_THREADING*/
 };
 
+#ifdef __linux__
+// /**
+// STRUCT      :: EXTERNAL_SocketPoller
+// DESCRIPTION :: A set of sockets waited on with epoll.  wakeFd is an
+//                eventfd that other threads write to in order to wake up
+//                the thread waiting on the set.
+// **/
+struct EXTERNAL_SocketPoller
+{
+    int epollFd;
+    int wakeFd;
+};
+
+// /**
+// STRUCT      :: EXTERNAL_SocketEvent
+// DESCRIPTION :: A readiness event returned by EXTERNAL_SocketPollerWait
+// **/
+struct EXTERNAL_SocketEvent
+{
+    bool wakeup;    // TRUE if the poller was woken up, id is not used
+    int id;         // The id given to EXTERNAL_SocketPollerAdd
+    bool readable;  // Data (or a connection) is waiting
+    bool closed;    // The peer closed the connection or an error occurred
+};
+#endif /* __linux__ */
+
 //---------------------------------------------------------------------------
 // Functions
 //---------------------------------------------------------------------------
@@ -435,6 +466,27 @@ EXTERNAL_SocketErrorType EXTERNAL_SocketRecv(
     unsigned int *receiveSize,
     bool block = TRUE);
 
+// /**
+// API       :: EXTERNAL_SocketRecvAvailable
+// PURPOSE   :: Receive all data that is waiting on a connected socket
+//              without blocking, and append it to a VarArray.  The VarArray
+//              grows as needed and is meant to be reused between calls so
+//              that a burst of messages costs one copy and no allocation.
+//              The socket must be threaded or non-blocking.
+// PARAMETERS ::
+// + socket : EXTERNAL_Socket* : Pointer to the socket
+// + data : EXTERNAL_VarArray* : The VarArray the data is appended to
+// + receiveSize : unsigned int* : The number of bytes received
+// RETURN    :: EXTERNAL_SocketErrorType : EXTERNAL_NoSocketError if
+//              successful, EXTERNAL_SocketError if the connection was
+//              closed or failed.  Data received before the connection was
+//              closed is still appended.
+// **/
+EXTERNAL_SocketErrorType EXTERNAL_SocketRecvAvailable(
+    EXTERNAL_Socket *s,
+    EXTERNAL_VarArray *data,
+    unsigned int *receiveSize);
+
 // /**
 // API       :: EXTERNAL_SocketRecv
 // PURPOSE   :: Receive data on a UDP socket.  Since the socket is
@@ -494,4 +546,79 @@ EXTERNAL_SocketErrorType EXTERNAL_SocketRecvLine(
 // **/
 EXTERNAL_SocketErrorType EXTERNAL_SocketClose(EXTERNAL_Socket *s);
 
+#ifdef __linux__
+// /**
+// API       :: EXTERNAL_SocketPollerInit
+// PURPOSE   :: Create the epoll set and the wakeup eventfd of a poller
+// PARAMETERS ::
+// + poller : EXTERNAL_SocketPoller* : Pointer to the poller
+// RETURN    :: EXTERNAL_SocketErrorType : EXTERNAL_NoSocketError if
+//              successful, EXTERNAL_SocketError if not
+// **/
+EXTERNAL_SocketErrorType EXTERNAL_SocketPollerInit(
+    EXTERNAL_SocketPoller *poller);
+
+// /**
+// API       :: EXTERNAL_SocketPollerAdd
+// PURPOSE   :: Add a socket to a poller.  An edge triggered socket is only
+//              reported when new data arrives, so all waiting data must be
+//              read before waiting again.  A threaded socket is not added
+//              to the epoll set since its receiver thread reads the
+//              descriptor; it wakes up the poller instead when data was
+//              received.
+// PARAMETERS ::
+// + poller : EXTERNAL_SocketPoller* : Pointer to the poller
+// + socket : EXTERNAL_Socket* : Pointer to the socket
+// + id : int : The id reported in the events of the socket
+// + edgeTriggered : bool : TRUE for edge triggered, FALSE for level
+//                          triggered
+// RETURN    :: EXTERNAL_SocketErrorType : EXTERNAL_NoSocketError if
+//              successful, EXTERNAL_SocketError if not
+// **/
+EXTERNAL_SocketErrorType EXTERNAL_SocketPollerAdd(
+    EXTERNAL_SocketPoller *poller,
+    EXTERNAL_Socket *s,
+    int id,
+    bool edgeTriggered);
+
+// /**
+// API       :: EXTERNAL_SocketPollerWait
+// PURPOSE   :: Wait until a socket of a poller is ready or the poller is
+//              woken up
+// PARAMETERS ::
+// + poller : EXTERNAL_SocketPoller* : Pointer to the poller
+// + events : EXTERNAL_SocketEvent* : Array receiving the events
+// + maxEvents : int : Size of the events array
+// + timeout : int : Timeout in milliseconds, -1 to wait forever and 0 to
+//                   return immediately
+// RETURN    :: int : The number of events, 0 on timeout or interrupt and
+//              -1 on error
+// **/
+int EXTERNAL_SocketPollerWait(
+    EXTERNAL_SocketPoller *poller,
+    EXTERNAL_SocketEvent *events,
+    int maxEvents,
+    int timeout);
+
+// /**
+// API       :: EXTERNAL_SocketPollerWake
+// PURPOSE   :: Wake up the thread waiting on a poller.  May be called from
+//              any thread.
+// PARAMETERS ::
+// + poller : EXTERNAL_SocketPoller* : Pointer to the poller
+// RETURN    :: void : None
+// **/
+void EXTERNAL_SocketPollerWake(EXTERNAL_SocketPoller *poller);
+
+// /**
+// API       :: EXTERNAL_SocketPollerClose
+// PURPOSE   :: Close the descriptors of a poller.  The sockets are not
+//              closed.
+// PARAMETERS ::
+// + poller : EXTERNAL_SocketPoller* : Pointer to the poller
+// RETURN    :: void : None
+// **/
+void EXTERNAL_SocketPollerClose(EXTERNAL_SocketPoller *poller);
+#endif /* __linux__ */
+
 #endif /* _EXTERNAL_SOCKET_H_ */
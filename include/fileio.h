@@ -3666,4 +3666,8 @@ IO_ReadString(
     char *parameterValue,
     int &matchType);
 
+#ifdef __cplusplus
+#include "fileio_index.h"
+#endif
+
 #endif // _FILEIO_H_
@@ -0,0 +1,231 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+// /**
+// PACKAGE :: FILEIO_INDEX
+// DESCRIPTION ::
+//     This file describes the parameter index of the scenario
+//     configuration.  The IO_Read...() APIs search every line of a
+//     NodeInput for each parameter they read, so initializing the nodes
+//     of a large scenario costs nodes x parameters x lines.  Once the
+//     configuration is indexed, every IO_Read...() call made from a
+//     source file including fileio.h is given a view of the
+//     configuration holding only the lines of the parameter being read,
+//     in configuration order.  The qualifier, instance and time
+//     qualifier precedence is still decided by the IO_Read...() APIs,
+//     so the values read do not change.
+// **/
+
+#ifndef FILEIO_INDEX_H
+#define FILEIO_INDEX_H
+
+#include "fileio.h"
+
+// /**
+// CONSTANT :: IO_INDEX_VIEW_INLINE_LINES : 8
+// DESCRIPTION :: Number of lines a NodeInputView holds without
+//                allocating memory
+// **/
+#define IO_INDEX_VIEW_INLINE_LINES 8
+
+// /**
+// CONSTANT :: IO_INDEX_NUM_REPORTED_PARAMETERS : 20
+// DESCRIPTION :: Number of parameters listed by
+//                IO_PrintNodeInputIndexStatistics
+// **/
+#define IO_INDEX_NUM_REPORTED_PARAMETERS 20
+
+// /**
+// CLASS :: NodeInputView
+// DESCRIPTION :: Lines of the indexed configuration for one parameter.
+//                Constructed as a temporary around an IO_Read...() call,
+//                so the view is valid during the call and sees the
+//                current values of the configuration.  If the
+//                configuration is not indexed, or lines were added to it
+//                since it was indexed, the view is the configuration
+//                itself.
+// **/
+class NodeInputView
+{
+public:
+    NodeInputView(const NodeInput* nodeInput, const char* parameterName);
+    ~NodeInputView();
+
+    const NodeInput* get() const { return m_nodeInput; }
+
+private:
+    const NodeInput* m_nodeInput;
+    NodeInput        m_view;
+
+    // Parameter read and start of the read, when statistics are kept
+    const char*      m_parameterName;
+    clocktype        m_start;
+
+    char* m_inputStrings[IO_INDEX_VIEW_INLINE_LINES];
+    char* m_timeQualifiers[IO_INDEX_VIEW_INLINE_LINES];
+    char* m_qualifiers[IO_INDEX_VIEW_INLINE_LINES];
+    char* m_variableNames[IO_INDEX_VIEW_INLINE_LINES];
+    int   m_instanceIds[IO_INDEX_VIEW_INLINE_LINES];
+    char* m_values[IO_INDEX_VIEW_INLINE_LINES];
+
+    void allocateLines(int numLines);
+
+    // Not copyable
+    NodeInputView(const NodeInputView&);
+    NodeInputView& operator=(const NodeInputView&);
+};
+
+// /**
+// API :: IO_BuildNodeInputIndex
+// PURPOSE :: Indexes the lines of the scenario configuration by
+//            parameter name.  Must be called before the partitions
+//            start reading the configuration.  If
+//            PARAMETER-READ-STATISTICS is YES, the number of reads and
+//            the time spent reading each parameter are also counted.
+// PARAMETERS ::
+// + nodeInput  : NodeInput*    : Scenario configuration.
+// RETURN :: void :
+// **/
+void
+IO_BuildNodeInputIndex(NodeInput* nodeInput);
+
+// /**
+// API :: IO_PrintNodeInputIndexStatistics
+// PURPOSE :: Prints the parameters that took the longest to read, if
+//            PARAMETER-READ-STATISTICS is YES.
+// PARAMETERS :: None
+// RETURN :: void :
+// **/
+void
+IO_PrintNodeInputIndexStatistics();
+
+// Helpers of IO_INDEX_ARG.  IO_IndexInput and IO_IndexName pick the
+// configuration and the parameter name out of the arguments of an
+// IO_Read...() call, IO_IndexSelect passes the view in place of the
+// configuration and every other argument through unchanged.
+inline const NodeInput* IO_IndexInput(const NodeInput* nodeInput)
+{
+    return nodeInput;
+}
+
+inline const NodeInput* IO_IndexInput(NodeInput* nodeInput)
+{
+    return nodeInput;
+}
+
+template <typename T>
+inline const NodeInput* IO_IndexInput(const T&)
+{
+    return NULL;
+}
+
+inline const char* IO_IndexName(const char* parameterName)
+{
+    return parameterName;
+}
+
+inline const char* IO_IndexName(char* parameterName)
+{
+    return parameterName;
+}
+
+template <typename T>
+inline const char* IO_IndexName(const T&)
+{
+    return NULL;
+}
+
+inline const NodeInput* IO_IndexSelect(const NodeInput*,
+                                       const NodeInput* view)
+{
+    return view;
+}
+
+inline const NodeInput* IO_IndexSelect(NodeInput*, const NodeInput* view)
+{
+    return view;
+}
+
+template <typename T>
+inline const T& IO_IndexSelect(const T& arg, const NodeInput*)
+{
+    return arg;
+}
+
+// Argument of an IO_Read...() call, replaced by the view of the parameter
+// named by the next argument if it is the configuration.  The
+// configuration is the third argument of most overloads and the fourth of
+// the ones taking a Node* and an interface index, so both are passed
+// through this.  Overloads with the configuration further back read
+// without the index.  The arguments are evaluated more than once.
+#define IO_INDEX_ARG(arg, next) \
+    IO_IndexSelect(arg, \
+                   NodeInputView(IO_IndexInput(arg), \
+                                 IO_IndexName(next)).get())
+
+// Read through the view of the parameter.  The cached file readers are
+// left out since they keep files in the NodeInput they are given.
+#define IO_ReadLine(a1, a2, a3, a4, a5, ...) \
+    IO_ReadLine(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                a5, __VA_ARGS__)
+#define IO_ReadString(a1, a2, a3, a4, a5, ...) \
+    IO_ReadString(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                  a5, __VA_ARGS__)
+#define IO_ReadBool(a1, a2, a3, a4, a5, ...) \
+    IO_ReadBool(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                a5, __VA_ARGS__)
+#define IO_ReadInt(a1, a2, a3, a4, a5, ...) \
+    IO_ReadInt(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+               a5, __VA_ARGS__)
+#define IO_ReadandCheckInt(a1, a2, a3, a4, a5, ...) \
+    IO_ReadandCheckInt(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                       a5, __VA_ARGS__)
+#define IO_ReadDouble(a1, a2, a3, a4, a5, ...) \
+    IO_ReadDouble(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                  a5, __VA_ARGS__)
+#define IO_ReadInt64(a1, a2, a3, a4, a5, ...) \
+    IO_ReadInt64(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                 a5, __VA_ARGS__)
+#define IO_ReadFloat(a1, a2, a3, a4, a5, ...) \
+    IO_ReadFloat(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                 a5, __VA_ARGS__)
+#define IO_ReadTime(a1, a2, a3, a4, a5, ...) \
+    IO_ReadTime(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                a5, __VA_ARGS__)
+#define IO_ReadandCheckTime(a1, a2, a3, a4, a5, ...) \
+    IO_ReadandCheckTime(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                        a5, __VA_ARGS__)
+#define IO_ReadStringInstance(a1, a2, a3, a4, a5, ...) \
+    IO_ReadStringInstance(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                          a5, __VA_ARGS__)
+#define IO_ReadBoolInstance(a1, a2, a3, a4, a5, ...) \
+    IO_ReadBoolInstance(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                        a5, __VA_ARGS__)
+#define IO_ReadIntInstance(a1, a2, a3, a4, a5, ...) \
+    IO_ReadIntInstance(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                       a5, __VA_ARGS__)
+#define IO_ReadDoubleInstance(a1, a2, a3, a4, a5, ...) \
+    IO_ReadDoubleInstance(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                          a5, __VA_ARGS__)
+#define IO_ReadFloatInstance(a1, a2, a3, a4, a5, ...) \
+    IO_ReadFloatInstance(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                         a5, __VA_ARGS__)
+#define IO_ReadTimeInstance(a1, a2, a3, a4, a5, ...) \
+    IO_ReadTimeInstance(a1, a2, IO_INDEX_ARG(a3, a4), IO_INDEX_ARG(a4, a5), \
+                        a5, __VA_ARGS__)
+
+#endif // FILEIO_INDEX_H
@@ -1189,6 +1189,7 @@ enum GuiReplies {
     GUI_DYNAMIC_COMMAND         = 10, // DYNAMIC_API
     GUI_STATS_MANAGER_REPLY     = 11, // Stats Manager
     GUI_FINALIZATION_COMMAND    = 12, // Finalization Command
+    GUI_ANIMATION_FRAME         = 13, // Binary frame of node updates
     GUI_FINISHED                = 1000
 };
 
@@ -0,0 +1,149 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+// /**
+// PACKAGE :: GUI_STREAM
+// DESCRIPTION ::
+//     This file describes the stream that sends replies to the GUI
+//     from a background thread.  Node moves and orientation changes are
+//     coalesced per node within a simulation time window, and packet
+//     animations are dropped while the GUI does not keep up.
+// **/
+
+#ifndef GUI_STREAM_H
+#define GUI_STREAM_H
+
+#include <string>
+#include <map>
+
+#ifdef _WIN32
+#include "pthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "main.h"
+#include "coordinates.h"
+#include "gui.h"
+
+// /**
+// CONSTANT :: GUI_STREAM_DEFAULT_QUEUE_LIMIT : 4194304
+// DESCRIPTION :: Default number of queued bytes above which packet
+//                animations are dropped
+// **/
+#define GUI_STREAM_DEFAULT_QUEUE_LIMIT 4194304
+
+// /**
+// FUNCTION POINTER :: GuiStreamSendFn
+// DESCRIPTION :: Writes bytes to the GUI socket.  Returns FALSE if the
+//                connection failed.
+// **/
+typedef BOOL (*GuiStreamSendFn)(SOCKET_HANDLE socket,
+                                const char* data,
+                                size_t size);
+
+// /**
+// CLASS :: GuiAnimationStream
+// DESCRIPTION :: Queue of replies sent to the GUI by a sender thread.
+//                All functions may be called from any partition thread.
+//
+//                Node moves and orientation changes are held, keeping
+//                only the last one of each node, until a later update
+//                falls after the coalescing window or another kind of
+//                reply is sent.  They are then queued as text replies,
+//                or as one GUI_ANIMATION_FRAME reply if binary frames
+//                are enabled.
+// **/
+class GuiAnimationStream
+{
+public:
+    GuiAnimationStream();
+    ~GuiAnimationStream();
+
+    void start(SOCKET_HANDLE socket,
+               GuiStreamSendFn sendFn,
+               clocktype window,
+               size_t queueLimit,
+               BOOL binaryFrames);
+
+    BOOL isStarted() const { return started_; }
+
+    void moveNode(NodeId nodeID,
+                  const Coordinates& position,
+                  clocktype time);
+    void setNodeOrientation(NodeId nodeID,
+                            const Orientation& orientation,
+                            clocktype time);
+
+    // Queue an encoded reply.  A droppable reply is dropped if more than
+    // the queue limit is waiting to be sent.  Held node updates are
+    // queued first.
+    void send(const std::string& data,
+              BOOL droppable);
+
+    // Queue the held node updates
+    void flushUpdates();
+
+    // Send everything that is queued and stop the sender thread
+    void stop();
+
+    // TRUE once writing to the socket failed
+    BOOL failed();
+
+    UInt64 numDropped() const { return numDropped_; }
+
+private:
+    struct NodeUpdate
+    {
+        BOOL hasPosition;
+        Coordinates position;
+        clocktype positionTime;
+
+        BOOL hasOrientation;
+        Orientation orientation;
+        clocktype orientationTime;
+    };
+
+    BOOL started_;
+    SOCKET_HANDLE socket_;
+    GuiStreamSendFn sendFn_;
+    clocktype window_;
+    size_t queueLimit_;
+    BOOL binaryFrames_;
+
+    std::map<NodeId, NodeUpdate> updates_;
+    clocktype windowEnd_;
+
+    // Bytes waiting for the sender thread
+    std::string queue_;
+    BOOL sending_;
+    BOOL stop_;
+    BOOL failed_;
+    UInt64 numDropped_;
+
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+    pthread_t thread_;
+
+    NodeUpdate& update(NodeId nodeID, clocktype time);
+    void flushUpdatesLocked();
+    void wake();
+
+    static void* run(void* data);
+};
+
+#endif // GUI_STREAM_H
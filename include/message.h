@@ -26,6 +26,7 @@
 #ifndef MESSAGE_H
 #define MESSAGE_H
 
+#include <string.h>
 #include <vector>
 #include <string>
 
@@ -35,6 +36,7 @@
 #include "qualnet_error.h"
 
 class TimerManager;
+struct MessageSharedRef;
 
 // Size constants should be multiples of 8/sizeof(double).
 
@@ -52,9 +54,17 @@ class TimerManager;
 // **/
 #define SMALL_INFO_SPACE_SIZE                      112
 
+// /**
+// CONSTANT    :: MSG_LIST_MAX                 :   10000
+// DESCRIPTION :: Initial high-water mark of the message free list.  The
+//                mark adapts at run time between MSG_LIST_MIN and
+//                MSG_LIST_CEILING.
+// **/
+#define MSG_LIST_MAX                               10000
+
 // /**
 // CONSTANT    :: MSG_PAYLOAD_LIST_MAX         :   1000
-// DESCRIPTION :: Maximum message payload list
+// DESCRIPTION :: Initial high-water mark of the message payload free list
 // **/
 #define MSG_PAYLOAD_LIST_MAX                       1000
 
@@ -66,10 +76,31 @@ class TimerManager;
 
 // /**
 // CONSTANT    :: MSG_INFO_LIST_MAX            :   1000
-// DESCRIPTION :: Maximum message info list
+// DESCRIPTION :: Initial high-water mark of the message info free list
 // **/
 #define MSG_INFO_LIST_MAX                          1000
 
+// /**
+// CONSTANT    :: MSG_LIST_MIN                 :   256
+// DESCRIPTION :: Smallest value an adaptive free list high-water mark
+//                shrinks to
+// **/
+#define MSG_LIST_MIN                               256
+
+// /**
+// CONSTANT    :: MSG_LIST_CEILING             :   1000000
+// DESCRIPTION :: Largest value an adaptive free list high-water mark
+//                grows to
+// **/
+#define MSG_LIST_CEILING                           1000000
+
+// /**
+// CONSTANT    :: MSG_RECYCLE_BATCH_SIZE       :   64
+// DESCRIPTION :: Number of cells of each kind handed between a worker
+//                thread cache and its partition at once
+// **/
+#define MSG_RECYCLE_BATCH_SIZE                     64
+
 // /**
 // CONSTANT    :: MAX_INFO_FIELDS              :   12
 // DESCRIPTION :: Maximum number of info fields
@@ -341,19 +372,90 @@ enum MessageInfoType
 };
 
 
+// /**
+// CLASS       :: MessageTraceArray
+// DESCRIPTION :: Per-header array used by the packet trace facility.
+//                Storage for MAX_HEADERS values is only allocated the first
+//                time an element is set, so timers and other messages
+//                that never carry headers pay for a single pointer instead
+//                of the whole array.  Reading never allocates: elements of
+//                an array without storage read as 0.  Once allocated the
+//                storage stays with the Message across recycling.
+// **/
+class MessageTraceArray
+{
+public:
+    MessageTraceArray() : m_values(NULL) {}
+    ~MessageTraceArray() { delete [] m_values; }
+
+    int operator[](int index) const
+    {
+        return (m_values == NULL) ? 0 : m_values[index];
+    }
+
+    void set(int index, int value)
+    {
+        if (m_values == NULL)
+        {
+            attach();
+        }
+        m_values[index] = value;
+    }
+
+    bool isAttached() const { return m_values != NULL; }
+
+    // Reset all values to 0 without releasing the storage.
+    void clear()
+    {
+        if (m_values != NULL)
+        {
+            memset(m_values, 0, sizeof(int) * MAX_HEADERS);
+        }
+    }
+
+    void copy(const MessageTraceArray& p)
+    {
+        if (p.m_values != NULL)
+        {
+            if (m_values == NULL)
+            {
+                attach();
+            }
+            memcpy(m_values, p.m_values, sizeof(int) * MAX_HEADERS);
+        }
+        else
+        {
+            clear();
+        }
+    }
+
+private:
+    void attach()
+    {
+        m_values = new int[MAX_HEADERS];
+        memset(m_values, 0, sizeof(int) * MAX_HEADERS);
+    }
+
+    // Not copyable, the owning Message copies the values explicitly
+    MessageTraceArray(const MessageTraceArray&);
+    void operator = (const MessageTraceArray&);
+
+    int* m_values;
+};
+
 // /**
 // STRUCT      :: Message
 // DESCRIPTION :: This is the main data strucure that represents a discrete
 //                event in qualnet. This is used to represent timer as well
 //                as to simulate actual sending of packets across the network.
+//                Fields read by the scheduler and the event dispatcher are
+//                grouped at the start of the object so that they share the
+//                first cache line; packet and trace fields follow.  Only
+//                the packet trace header arrays are kept out of line, see
+//                the note at the start of the cold fields.
 // **/
 class Message
 {
-private:
-    static const UInt8 SENT = 0x01; // Message is being sent
-    static const UInt8 FREED = 0x02; // MESSAGE_Free has been called
-    static const UInt8 DELETED = 0x04; // Deleted using "delete"
-    UInt8 m_flags;
 public:
     // The default constructor should not be used unless under specific
     // circumstances.  The message is not initialized here.
@@ -365,28 +467,39 @@ public:
             int  protocol,
             int  eventType,
             bool isMT = false);
-    virtual ~Message();
+    ~Message();
     void operator = (const Message &p);
 
+    // Copy every field except the payload and the info fields.  Used by
+    // operator= and by the copy-on-write duplicate path.
+    void copyFields(const Message &p);
+
     // Initialize the message with default values
     void initialize(PartitionData* partition);
 
+    // ---- Hot fields: touched for every scheduled event ----
+
+    clocktype eventTime;    // used only by the parallel code
     Message*  next; // For kernel use only.
-    PartitionData* m_partitionData; // For kernel use only.
 
-    // The following fields are simulation related information.
+    unsigned int naturalOrder;  /// used to maintain natural ordering
+                                /// for events at same time & node
 
     short layerType;    /// Layer which will receive the message
     short protocolType; /// Protocol which will receive the message in the layer.
+    short eventType;    /// Message's Event type.
     short instanceId;   /// Which instance to give message to (for multiple
                         /// copies of a protocol or application).
     short m_radioId;    /// which radio this belongs to (if any)
-    short eventType;    /// Message's Event type.
-
-    unsigned int naturalOrder;  /// used to maintain natural ordering
-                                /// for events at same time & node
 
+private:
+    static const UInt8 SENT = 0x01; // Message is being sent
+    static const UInt8 FREED = 0x02; // MESSAGE_Free has been called
+    static const UInt8 DELETED = 0x04; // Deleted using "delete"
+    UInt8 m_flags;
+public:
     char error;         /// Does the packet contain errors?
+    bool cancelled;
 
     bool    mtWasMT;            // Messages handed to the worker thread
                                 // can't participate in the message recycling.
@@ -401,8 +514,25 @@ public:
     void setDeleted(bool v);
 
     bool      allowLoose;   // used only by the parallel code
+    bool isScheduledOnMainHeap;
     NodeId    nodeId;       // used only by the parallel code
-    clocktype eventTime;    // used only by the parallel code
+
+    TimerManager* timerManager;
+    clocktype timerExpiresAt;
+
+    PartitionData* m_partitionData; // For kernel use only.
+
+    // ---- Cold fields: packets, info fields and tracing ----
+    //
+    // The parallel fields (eot, sourcePartitionId) and the scalar packet
+    // trace fields (originatingNodeId, sequenceNumber, originatingProtocol,
+    // numberOfHeaders) stay inline.  Each is a single word, so a side
+    // block would cost as much as it saves plus an allocation per packet,
+    // and MESSAGE_Serialize sends the Message object as is, so anything
+    // out of line has to be written separately like headerProtocols and
+    // headerSizes.  The trace fields are also set by name throughout the
+    // libraries.
+
     clocktype eot;          // used only by the parallel code
     int sourcePartitionId;  // used only by the parallel code
 
@@ -454,16 +584,14 @@ public:
     clocktype packetCreationTime;
     clocktype pktNetworkSendTime;
 
-    bool cancelled;
-
     // Extra fields to support packet trace facility.
     // Will slow things down.
     NodeAddress originatingNodeId;
     int sequenceNumber;
     int originatingProtocol;
     int numberOfHeaders;
-    int headerProtocols[MAX_HEADERS];
-    int headerSizes[MAX_HEADERS];
+    MessageTraceArray headerProtocols;
+    MessageTraceArray headerSizes;
     // Added field for SatCom parallel mode
     // holds the hw address of relay ground
     // node to prevent message repeat
@@ -481,14 +609,20 @@ public:
 
     bool isEmulationPacket;
 
-    TimerManager* timerManager;
-
-    bool isScheduledOnMainHeap;
-    clocktype timerExpiresAt;
-
     // This is needed for SRW Base Packet code. Not used in Qualnet code.
     int hdrLength;
 
+    // Position in the TimerManager heap, -1 when not held there or
+    // TIMER_MANAGER_CANCELLED_ON_MAIN_HEAP.  For TimerManager use only.
+    int timerHeapIndex;
+
+    // Copy-on-write bookkeeping.  When non-NULL the payload (or the
+    // non-small info fields) are shared with other duplicates of this
+    // message and must not be written until MESSAGE_MakeWritable has
+    // been called.  For kernel use only.
+    mutable MessageSharedRef* sharedPayload;
+    mutable MessageSharedRef* sharedInfo;
+
     // Users should not modify anything above this line.
     // or below this one.
     // inline methods
@@ -1483,6 +1617,107 @@ Message* MESSAGE_Duplicate(Node *node, const Message *msg, bool isMT = false);
 Message* MESSAGE_Duplicate (PartitionData *partition, const Message *msg,
     bool isMT = false);
 
+// /**
+// API       :: MESSAGE_InitializeRecycling
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Set up the partition's message free list limits and the
+//              batch hand-off used by worker thread caches.
+//              For kernel use only.
+// PARAMETERS ::
+// + partition:  PartitionData* : partition to initialize
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_InitializeRecycling(PartitionData *partition);
+
+// /**
+// API       :: MESSAGE_ExchangeRecycleBatches
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Merge the batches of messages, payloads and info cells
+//              handed back by worker thread caches into the partition free
+//              lists, and donate batches to workers that ran dry.  Must be
+//              called from the partition thread.  For kernel use only.
+// PARAMETERS ::
+// + partition:  PartitionData* : partition exchanging batches
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_ExchangeRecycleBatches(PartitionData *partition);
+
+// /**
+// API       :: MESSAGE_MakeWritable
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Give the message a private copy of its payload and info
+//              fields if they are currently shared with other duplicates.
+//              MESSAGE_AddHeader, MESSAGE_ExpandPacket and the info field
+//              functions do this automatically.  Code that writes into
+//              the packet or an info field in place should get the
+//              pointer from MESSAGE_ReturnWritablePacket() or
+//              MESSAGE_ReturnWritableInfo() instead, or call this first.
+// PARAMETERS ::
+// + node    :  Node*    : node which is going to modify the message
+// + msg     :  Message* : message to make writable
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_MakeWritable(Node *node, Message *msg);
+
+// /**
+// API       :: MESSAGE_MakeWritable
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Give the message a private copy of its payload and info
+//              fields if they are currently shared with other duplicates.
+// PARAMETERS ::
+// + partition:  PartitionData* : partition which is going to modify the message
+// + msg     :  Message* : message to make writable
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_MakeWritable(PartitionData *partition, Message *msg);
+
+// /**
+// API       :: MESSAGE_ReturnWritablePacket
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Returns a pointer to the packet of the message after giving
+//              the message a private copy of its payload if it is shared
+//              with other duplicates.  Use instead of
+//              MESSAGE_ReturnPacket() when the packet is modified in place.
+//              Pointers into the packet obtained before are stale.
+// PARAMETERS ::
+// + node    :  Node*    : node which is going to modify the packet
+// + msg     :  Message* : message whose packet is returned
+// RETURN    :: char* : Pointer to the writable packet
+// **/
+char* MESSAGE_ReturnWritablePacket(Node *node, Message *msg);
+
+// /**
+// API       :: MESSAGE_ReturnWritableInfo
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Returns a pointer to the "info" field with given info type
+//              after giving the message private copies of its info fields
+//              if they are shared with other duplicates.  Use instead of
+//              MESSAGE_ReturnInfo() when the info field is modified in
+//              place.
+// PARAMETERS ::
+// + node    :  Node*    : node which is going to modify the info field
+// + msg     :  Message* : message for which "info" field
+//                         has to be returned
+// + infoType:  unsigned short : type of the "info" field to be returned.
+// RETURN    :: char* : Pointer to the writable "info" field with given
+//                      type.  NULL if not found.
+// **/
+char* MESSAGE_ReturnWritableInfo(Node *node,
+                                 Message *msg,
+                                 unsigned short infoType = INFO_TYPE_DEFAULT);
+
+// /**
+// API       :: MESSAGE_PrintCopyOnWriteStats
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Print to the statistics file how many payload and info
+//              copies the copy-on-write duplicate path avoided and made
+//              on the partition of the node.
+// PARAMETERS ::
+// + node    :  Node*    : node printing the partition statistics
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_PrintCopyOnWriteStats(Node *node);
+
 // /**
 // API       :: MESSAGE_DuplicateMT
 // LAYER     :: ANY LAYER
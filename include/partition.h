@@ -98,6 +98,42 @@ union MessageInfoListCell {
     union MessageInfoListCell* next;
 };
 
+// /**
+// STRUCT      :: MessageFreeListLimit
+// DESCRIPTION :: Adaptive high-water mark of one of the partition's
+//                message free lists.  Cells freed while the list is at
+//                the mark are released to the heap.  The mark grows when
+//                cells were released and later missed within the same
+//                interval, and shrinks when part of the list stayed
+//                unused for a whole interval.
+// **/
+struct MessageFreeListLimit
+{
+    int highWater;   // current cap on the list length
+    int lowWater;    // shortest list length seen this interval
+    int numAllocs;   // allocations this interval
+    int numMisses;   // allocations that found the list empty
+    int numDiscards; // frees released to the heap because of the cap
+};
+
+// /**
+// STRUCT      :: MessageRecycleBatch
+// DESCRIPTION :: A batch of recycled messages, payload cells and info
+//                cells.  Used both as the per-thread cache of a worker
+//                thread and to hand cells between that cache and the
+//                partition free lists.
+// **/
+struct MessageRecycleBatch
+{
+    Message*                msgList;
+    int                     msgNum;
+    MessagePayloadListCell* payloadList;
+    int                     payloadNum;
+    MessageInfoListCell*    infoList;
+    int                     infoNum;
+    MessageRecycleBatch*    next;
+};
+
 // /**
 // UNION       ::
 // DESCRIPTION ::
@@ -130,6 +166,8 @@ class QNThreadMutex;
 extern clocktype PrintSimTimeInterval;
 
 struct StatsDb;
+struct LadderQueue;
+struct PathlossMatrixTable;
 // Forward declarations for the template PTQueue
 // parallel.h actually defines this type (by including portablethread/lockfree).
 namespace PortableThreads {
@@ -194,6 +232,7 @@ struct PartitionPathLossSample
 // Forward declaration
 class STAT_StatisticsList;
 class PHY_CONN_NodePositionData;
+class TraceBinaryWriter;
 class RecordReplayInterface;
 
 // /**
@@ -236,8 +275,9 @@ struct PartitionData {
 
     // Pathloss Matrix value
     // moved from PropProfile to here as PropProfile is shared by all partitions
-    // This is an array with length equal to numChannels;
-    map <pair<NodeId, NodeId>, double>** pathLossMatrix;
+    // Dense matrices of the channels in the pathloss matrix file.
+    // plCurrentIndex is the number of matrix snapshots applied so far.
+    PathlossMatrixTable* pathLossMatrix;
     int plCurrentIndex;
     clocktype plNextLoadTime;
 
@@ -267,6 +307,26 @@ struct PartitionData {
     int                     splayNodeFreeListNum;
     SplayNodeListCell      *splayNodeFreeList;
 
+    MessageFreeListLimit    msgFreeListLimit;
+    MessageFreeListLimit    msgPayloadFreeListLimit;
+    MessageFreeListLimit    msgInfoFreeListLimit;
+
+    // Batches exchanged with the per-thread caches used by MT allocations.
+    // The mutex is only taken to hand over a whole batch.
+    QNThreadMutex*          msgRecycleMutex;
+    MessageRecycleBatch*    msgReturnedBatches; // worker -> partition
+    MessageRecycleBatch*    msgDonatedBatches;  // partition -> worker
+    int                     msgDonatedBatchesNum;
+    int                     msgDonationRequests;
+
+    // Copy-on-write sharing of payloads and info fields between
+    // MESSAGE_Duplicate copies (MESSAGE-COPY-ON-WRITE).
+    BOOL                    msgCopyOnWrite;
+    Int64                   msgPayloadCopiesAvoided;
+    Int64                   msgPayloadCopiesMade;
+    Int64                   msgInfoCopiesAvoided;
+    Int64                   msgInfoCopiesMade;
+
     // This number is used to break times when ordering events.
     // This sequence number will wrap, but that is ok as we
     // don't anticipate ever having 2^32-1 events scheduled on the same
@@ -284,6 +344,10 @@ struct PartitionData {
      * When SCHEDULER is STDLIB
      */
     StlHeap *    heapStdlib;
+    /*
+     * When SCHEDULER-LADDER-QUEUE is YES
+     */
+    LadderQueue * ladderQueue;
 
     MobilityHeap mobilityHeap;
     StlHeap *       looseEvsHeap;
@@ -310,6 +374,7 @@ struct PartitionData {
 
     BOOL    traceEnabled;
     FILE    *traceFd;      /* file descriptor used for packet tracing */
+    TraceBinaryWriter* traceBinary; /* writer of TRACE_BINARY traces */
 
     Node    *activeNode;
 
@@ -174,6 +174,8 @@ struct PhyBerTable {
     PhyBerEntry* entries;
 };
 
+struct PhyErrorTable;
+
 void
 PHY_BerTablesPrepare (PhyBerTable * berTables, const int tableCount);
 
@@ -379,6 +381,9 @@ struct PhyData {
 #ifdef CYBER_LIB
     BOOL isSigintInterface;
 #endif
+
+    // Packet error tables of snrBerTables, see phy_error_table.h
+    const PhyErrorTable** snrErrorTables;
 };
 
 
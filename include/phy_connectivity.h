@@ -61,6 +61,9 @@ public:
     BOOL subnetInformationSent;
     BOOL ethernetInformationSent;
 
+    // Threads used for the pathloss and rx power of a connectivity sample
+    int numThreads;
+
     PHY_CONN_NodePositionData () {
         phyConnEnabled = FALSE;
         listenableChannelSent = FALSE;
@@ -68,6 +71,8 @@ public:
         subnetInformationSent = FALSE;
         ethernetInformationSent = FALSE;
         endSimulation = TRUE;
+        adjacencyIndexValid = FALSE;
+        numThreads = 1;
     }
     struct SatComNodeInfo
     {
@@ -374,7 +379,29 @@ public:
     };
 
     ConnectivityMap connectivity;
-    
+
+    // Read only copy of connectivity in compressed row form, rebuilt after
+    // each connectivity sample and used by the PHY_CONN_Return APIs.
+    // Row i holds the adjacencies of sender adjacencyTxIds[i], which are
+    // adjacencyEntries[adjacencyRowStart[i]] up to
+    // adjacencyEntries[adjacencyRowStart[i + 1]], sorted by receiver.
+    // connectivity stays the format exchanged between partitions.
+    BOOL adjacencyIndexValid;
+    vector<NodeId> adjacencyTxIds;
+    vector<int> adjacencyRowStart;
+    vector<pair<AdjacencyNodeKey, AdjacencyNodeValue> > adjacencyEntries;
+
+    void BuildAdjacencyIndex();
+    BOOL FindAdjacencyRow(
+        NodeId txNodeId,
+        int* first,
+        int* last) const;
+    BOOL FindAdjacencyRange(
+        NodeId txNodeId,
+        NodeId rxNodeId,
+        int* first,
+        int* last) const;
+
 
     void HandleChannelPhyConnInsertion(
         Node* node,
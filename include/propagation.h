@@ -270,6 +270,8 @@ struct PathlossArea {
     Coordinates northeastOrUpperRight;
 };
 
+struct PathlossMatrixSource;
+
 struct pathLossMatrixValue{
     clocktype simTime;
     string values;
@@ -319,6 +321,7 @@ struct PropProfile {
     int*      channelIndexArray;
     int       numNodesInMatrix;
     vector<pathLossMatrixValue>      matrixList;
+    PathlossMatrixSource*            matrixSource;
 
     void *propGlobalVar;
 
@@ -886,6 +889,17 @@ double PathlossMatrix(
     int channelIndex,
     clocktype currentTime);
 
+// Brings the partition's pathloss matrix up to currentTime, after which
+// PathlossMatrix lookups up to that time do not modify it and may be made
+// from several threads.
+void PathlossMatrixAdvance(
+    PartitionData* partitionData,
+    clocktype currentTime);
+
+// Stops the loader thread of the partition's pathloss matrix and frees
+// the matrix.
+void PathlossMatrixPartitionFinalize(PartitionData* partitionData);
+
 
 // API              :: PROP_ChangeSamplingRate
 //
@@ -38,12 +38,15 @@ struct ValueProbabilityPair {
 
 // /**
 // STRUCT       :: ArbitraryDistribution
-// DESCRIPTION  :: Stores a user defined distribution.
+// DESCRIPTION  :: Stores a user defined distribution.  The cumulative
+//                 probabilities are computed when the distribution is
+//                 loaded so that a value is drawn by binary search.
 // **/
 struct ArbitraryDistribution {
     char* distributionName;
     Int32 numDistPoints;
     ValueProbabilityPair* values;
+    double* cumulativeProbabilities;
 };
 
 // /**
@@ -164,6 +167,7 @@ public:
         randomSeed[1] = 0;
         randomSeed[2] = 0;
         type = DNULL;
+        userDistribution = NULL;
     }
 
     // /**
@@ -309,6 +313,19 @@ public:
     T getRandomNumber();
     T getRandomNumber(RandomSeed seed);
 
+    // /**
+    // API        :: RandomDistribution.getRandomNumbers
+    // PURPOSE    :: Fills an array with the next random numbers from the
+    //               defined distribution.  Returns the same numbers as
+    //               calling getRandomNumber count times, but looks up a
+    //               user defined distribution only once.
+    // PARAMETERS ::
+    // + values : T*  : the array receiving the random values
+    // + count  : int : the number of values to generate
+    // RETURN :: void :
+    // **/
+    void getRandomNumbers(T* values, int count);
+
     // /**
     // API        :: RandomDistribution.setSeed
     // PURPOSE    :: Calls RANDOM_SetSeed on the member seed.
@@ -346,6 +363,9 @@ private:
     RandomSeed             randomSeed;
     RandomDistributionType type;
 
+    // User defined distribution, looked up by name on the first draw
+    ArbitraryDistribution* userDistribution;
+
     T uniform(RandomSeed seed);
     T exponential(RandomSeed seed);
 
@@ -356,6 +376,7 @@ private:
     T gaussian(RandomSeed seed);
     T gaussianInt(RandomSeed seed);
 
+    ArbitraryDistribution* findUserDistribution();
     double processUserDistribution(RandomSeed seed);
     double getNextNumber(ArbitraryDistribution* data,
                          double      randNum);
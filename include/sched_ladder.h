@@ -0,0 +1,311 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Event (message) queue using a ladder queue
+ *
+ * All events of the partition are kept in a single ladder queue:
+ *   Top    - unsorted list of far future events
+ *   Rungs  - arrays of unsorted buckets, each rung refining one bucket
+ *            of the rung above it
+ *   Bottom - short sorted list of the events that are dequeued next
+ * Insert and extract are amortized O(1).  Events are ordered by time,
+ * then by naturalOrder, which is the FIFO order of MESSAGE_Send.
+ */
+
+#ifndef SCHED_LADDER_H
+#define SCHED_LADDER_H
+
+#include <set>
+#include <map>
+#include <vector>
+
+#include "scheduler_types.h"
+#include "scheduler.h"
+
+// /**
+// CONSTANT    :: LADDER_MAX_RUNGS : 8
+// DESCRIPTION :: Maximum number of rungs in the ladder
+// **/
+#define LADDER_MAX_RUNGS          8
+
+// /**
+// CONSTANT    :: LADDER_THRESHOLD : 50
+// DESCRIPTION :: Bucket size above which a bucket is spread over a new
+//                rung instead of being sorted into Bottom.  Also the
+//                Bottom size above which Bottom is spread over a new rung.
+// **/
+#define LADDER_THRESHOLD          50
+
+// /**
+// CONSTANT    :: LADDER_MAX_BUCKETS : 65536
+// DESCRIPTION :: Maximum number of buckets in one rung
+// **/
+#define LADDER_MAX_BUCKETS        65536
+
+// /**
+// CONSTANT    :: LADDER_MAX_FREE_CELLS : 50000
+// DESCRIPTION :: Maximum number of cells kept on the free list
+// **/
+#define LADDER_MAX_FREE_CELLS     50000
+
+
+//------------ Declaration of Scheduler Queue Structure -------------
+
+struct LadderCell {
+    clocktype       time;
+    unsigned int    naturalOrder;
+    Message*        msg;
+    Node*           node;
+    LadderCell*     next;
+};
+
+struct LadderRung {
+    clocktype       start;          // time of bucket 0
+    clocktype       width;          // time span of one bucket
+    int             numBuckets;
+    int             capacity;       // allocated size of the bucket arrays
+    int             current;        // first bucket not yet dequeued
+    LadderCell**    buckets;
+    int*            bucketCount;
+    int             numEvents;
+};
+
+typedef std::pair<Message*, unsigned int> LadderDeletedKey;
+
+struct LadderQueue {
+    // Top
+    LadderCell*     top;
+    int             topCount;
+    clocktype       topMin;
+    clocktype       topMax;
+    clocktype       topStart;       // events at or after this go in Top
+
+    // Rungs, rungs[0] is the coarsest
+    LadderRung      rungs[LADDER_MAX_RUNGS];
+    int             numRungs;
+
+    // Bottom, sorted
+    LadderCell*     bottom;
+    int             bottomCount;
+
+    int             numEvents;
+
+    // Messages removed with SCHED_DeleteMessage, skipped when dequeued
+    std::set<LadderDeletedKey>                  deleted;
+
+    // Nodes in the partition's node queue, and the events of nodes that
+    // have been removed from it
+    std::vector<Node*>                          nodes; // by nodeIndex
+    int                                         numNodes;
+    std::map<Node*, std::vector<LadderCell*> >  parked;
+
+    int             cellFreeListNum;
+    LadderCell*     cellFreeList;
+
+    // Statistics
+    BOOL            isCollectingStats;
+    int             hiWatermark;
+    Int64           numSpawns;
+    Int64           numSlowSearches;
+};
+
+
+//------------------------------------------------------------------
+
+// /**
+// API       :: SCHED_LADDER_InsertMessage
+// PURPOSE   :: Insert a message into the node's message queue
+// PARAMETERS ::
+// + node        : Node*       : Pointer to the node to insert into
+// + msg         : Message*    : Pointer to the message to insert
+// + time        : clocktype   : time to delay
+// RETURN    :: void :
+// **/
+void SCHED_LADDER_InsertMessage(
+    Node *node,
+    Message *msg,
+    clocktype delay);
+
+
+// /**
+// API       :: SCHED_LADDER_ExtractFirstMessage
+// PURPOSE   :: Remove the first message from the node's message queue
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the partition data
+// + node           : Node*     : Pointer to the node
+//                            to be extracted
+// RETURN    ::  Message* : First message from queue
+// **/
+Message* SCHED_LADDER_ExtractFirstMessage(
+    PartitionData *partitionData,
+    Node *node);
+
+
+// /**
+// API       :: SCHED_LADDER_PeekFirstMessage
+// PURPOSE   :: Peek at the first message from the node's message queue
+//              NOT REMOVED FROM QUEUE
+// PARAMETERS ::
+// + node       : Node*     : Pointer to the node
+// RETURN    :: Message*    : Pointer to message
+// **/
+Message* SCHED_LADDER_PeekFirstMessage(
+    Node *node);
+
+
+// /**
+// API       :: SCHED_LADDER_DeleteMessage
+// PURPOSE   :: Delete a message from the nodes's message queue
+// PARAMETERS ::
+// + node       : Node*     : Pointer to the node
+//                            to delete message from
+// RETURN    :: void :
+// **/
+void SCHED_LADDER_DeleteMessage(
+    Node *node,
+    Message *msg);
+
+
+// /**
+// API       :: SCHED_LADDER_InsertNode
+// PURPOSE   :: Insert a node into the partition's scheduler queue
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the partition
+//                                       to be inserted
+// + node           : Node *           : Pointer to the node
+// RETURN    :: void :
+// **/
+void SCHED_LADDER_InsertNode(
+    PartitionData *partitionData,
+    Node *node);
+
+
+// /**
+// API       :: SCHED_LADDER_PeekNextNode
+// PURPOSE   :: Peek at next node to process in the partition's scheduler queue
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the node
+//                                       to be inserted
+// RETURN    :: Node*   :next node to process
+// **/
+Node* SCHED_LADDER_PeekNextNode(
+    PartitionData *partitionData);
+
+
+// /**
+// API       :: SCHED_LADDER_DeleteNode
+// PURPOSE   :: Delete a node from the partition's scheduler queue
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the node
+//                                       to be inserted
+// + node           : Node*     : Pointer to the node
+// RETURN    :: void :
+// **/
+void SCHED_LADDER_DeleteNode(
+    PartitionData *partitionData,
+    Node *node);
+
+
+// /**
+// API       :: SCHED_LADDER_CurrentNode
+// PURPOSE   :: Current node from the partition's scheduler queue
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the node
+//                                       to be inserted
+// RETURN    :: void :
+// **/
+Node* SCHED_LADDER_CurrentNode(
+    const PartitionData *partitionData);
+
+
+// /**
+// API       :: SCHED_LADDER_HasNodes
+// PURPOSE   :: Check for nodes in the scheduler's node queue.
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the partition data
+//
+// RETURN    :: BOOL    : scheduler has nodes in it's queue
+// **/
+BOOL SCHED_LADDER_HasNodes(
+    const PartitionData *partitionData);
+
+
+// /**
+// API       :: SCHED_LADDER_NextEvent
+// PURPOSE   :: Get the next event for this partition
+//              NOT REMOVED FROM QUEUE
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the partition data
+// + node           : Node*     : Pointer to the node, or NULL for the
+//                                earliest event of any node
+// RETURN    :: Message*   : next event
+// **/
+Message* SCHED_LADDER_NextEvent(
+    PartitionData *partitionData,
+    Node* node);
+
+
+// /**
+// API       :: SCHED_LADDER_NextEventTime
+// PURPOSE   :: Get the next event time for this partition
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the partition data
+// RETURN    :: clocktype   : time of next event
+// **/
+clocktype SCHED_LADDER_NextEventTime(
+    const PartitionData *partitionData);
+
+
+// /**
+// API       :: SCHED_LADDER_Initialize
+// PURPOSE   :: Initalize Scheduler
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the partition data
+// RETURN    :: void :
+// **/
+void SCHED_LADDER_Initialize(
+    PartitionData *partitionData);
+
+
+// /**
+// API       :: SCHED_LADDER_Finalize
+// PURPOSE   :: Finalize Scheduler
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the partition data
+// RETURN    :: void :
+// **/
+void SCHED_LADDER_Finalize(
+    PartitionData *partitionData);
+
+
+// /**
+// API       :: SCHED_LADDER_Install
+// PURPOSE   :: Select the ladder queue for this partition by pointing
+//              the partition's SchedulerInfo at the SCHED_LADDER_
+//              functions.  Must be called after SCHED_Initalize and
+//              before any node or message is inserted.
+// PARAMETERS ::
+// + partitionData  : PartitionData*   : Pointer to the partition data
+// RETURN    :: void :
+// **/
+void SCHED_LADDER_Install(
+    PartitionData *partitionData);
+
+//----------------------------------------------------------------------
+
+#endif /* SCHED_LADDER_H */
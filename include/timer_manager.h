@@ -2,9 +2,12 @@
 #define TIMER_MANAGER_H
 
 #include <vector>
-#include <queue>
 #include <stack>
 
+// Value of Message::timerHeapIndex for a timer on the main heap that was
+// cancelled through TimerManager::cancel() and is counted as dead
+#define TIMER_MANAGER_CANCELLED_ON_MAIN_HEAP -2
+
 
 struct MessageCompare : std::binary_function<Message*, Message*, bool>
 {
@@ -14,21 +17,60 @@ struct MessageCompare : std::binary_function<Message*, Message*, bool>
     }
 };
 
-class TimerManager 
+class TimerManager
 {
 public:
     TimerManager(Node *node);
     ~TimerManager();
     void schedule(Message *msg, clocktype delay);
+
+    // Cancel a timer.  As with MESSAGE_CancelSelfMsg, msg stays valid
+    // until the time it would have expired and is freed after that.  A
+    // timer that is still held by the manager is taken out of the pending
+    // timers right away; one already on the main heap is only marked
+    // cancelled.
     void cancel(Message *msg);
+
+    // Move a pending timer to a new expiry time.  Returns the message that
+    // now carries the timer; this is a copy of msg when msg was already on
+    // the main heap, in which case msg itself is cancelled.
+    Message* reschedule(Message *msg, clocktype delay);
+
     void scheduleNextTimer();
 
+    // Called by the kernel when a timer of this manager expires
+    void timerExpired(Message *msg);
+
+    // Timers that will still fire, and cancelled timers that have not
+    // reached their expiry time yet
+    int getNumLiveTimers() const;
+    int getNumDeadTimers() const;
+
 protected:
+    void heapPush(Message *msg);
+    void heapRemove(int index);
+    void heapSiftUp(int index);
+    void heapSiftDown(int index);
+    void heapSet(int index, Message *msg);
+    void sendTimer(Message *msg);
+    void holdCancelled(Message *msg);
+    void freeCancelled();
+
     Node *node;
     Message *currentMessageScheduled;
-    std::priority_queue<Message*, std::vector<Message *>, MessageCompare> *localTimerHeap;
+
+    // Binary heap of the timers not yet on the main heap.  Each message
+    // stores its position in timerHeapIndex so that it can be removed or
+    // re-keyed without a search.
+    std::vector<Message*> *localTimerHeap;
     std::stack<Message*> *scheduledTimerStack;
 
+    // Cancelled timers taken out of localTimerHeap, kept as a heap on
+    // timerExpiresAt until they are due to be freed
+    std::vector<Message*> *cancelledTimerHeap;
+
+    int numOnMainHeap;
+    int numCancelledOnMainHeap;
 };
 
 
@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 
+struct PartitionData;
 
 // /**
 //  CONSTANT    :  MAX_TRACE_LENGTH  : (4090)
@@ -54,6 +55,17 @@ enum TraceDirectionType
 };
 
 
+// /**
+// ENUM        :: TraceFormatType
+// DESCRIPTION :: Format of the packet trace file
+// **/
+enum TraceFormatType
+{
+    TRACE_XML,
+    TRACE_BINARY
+};
+
+
 // /**
 // ENUM        :: PacketActionType
 // DESCRIPTION :: Different types of action on packet
@@ -456,6 +468,7 @@ struct TraceData
     TraceIncludedHeadersType traceIncludedHeaders;
 
     char xmlBuf[MAX_TRACE_LENGTH];
+    int xmlBufLength;
     TracePrintXMLFn xmlPrintFn[TRACE_ANY_PROTOCOL];
     TracePrintXMLFun xmlPrintFun[TRACE_ANY_PROTOCOL];
 };
@@ -621,6 +634,44 @@ void TRACE_WriteToBufferXML(Node* node, char* buf);
 void TRACE_WriteXMLTraceHeader(NodeInput* nodeInput, FILE* fp);
 
 
+// /**
+// API          :: TRACE_OpenTraceFile
+// PURPOSE      :: Create the partition's trace file in the format given
+//                 by TRACE-FORMAT.  With TRACE_BINARY, records are
+//                 written by a background thread.
+// PARAMETERS   ::
+// + partitionData : PartitionData* : the partition
+// + nodeInput     : NodeInput*     : access to configuration file
+// RETURN       :: void  : NULL
+// **/
+void TRACE_OpenTraceFile(PartitionData* partitionData, NodeInput* nodeInput);
+
+
+// /**
+// API          :: TRACE_WriteTraceHeader
+// PURPOSE      :: Write trace header information to the partition's
+//                 trace file in its format
+// PARAMETERS   ::
+// + partitionData : PartitionData* : the partition
+// + nodeInput     : NodeInput*     : access to configuration file
+// RETURN       :: void  : NULL
+// **/
+void TRACE_WriteTraceHeader(PartitionData* partitionData,
+                            NodeInput* nodeInput);
+
+
+// /**
+// API          :: TRACE_CloseTraceFile
+// PURPOSE      :: Write the remaining records and the trace tail, if
+//                 this is the last partition, and close the partition's
+//                 trace file
+// PARAMETERS   ::
+// + partitionData : PartitionData* : the partition
+// RETURN       :: void  : NULL
+// **/
+void TRACE_CloseTraceFile(PartitionData* partitionData);
+
+
 // /**
 // API          :: TRACE_WriteXMLTraceTail
 // PURPOSE      :: Write trace tail information to the partition's
@@ -0,0 +1,169 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+// /**
+// PACKAGE     :: TRACE_BINARY
+// DESCRIPTION :: This file describes the binary packet trace format and
+//                the writer that produces it.
+//
+// A binary trace file is a sequence of records, all numbers little
+// endian.  Every record starts with a UInt8 record type and a UInt32
+// length of the rest of the record, so that files of several partitions
+// can be concatenated like XML trace files:
+//
+//   header  : UInt32 magic, UInt32 version, then the product version,
+//             scenario and comments, each as UInt16 length and text
+//   map     : Int32 protocol, protocol name
+//   record  : UInt32 originating node, Int32 sequence number,
+//             Int64 simulation time, Int32 originating protocol,
+//             UInt32 processing node, Int32 tracing protocol,
+//             UInt16 action, UInt8 has queue, UInt16 comment or
+//             interface, UInt8 queue priority, record body
+//   tail    : nothing
+//
+// The record body is the text produced by the trace functions of the
+// protocols, exactly as it appears in the <recbody> element of the XML
+// trace, so that the converter can rebuild the XML trace.
+// **/
+
+#ifndef TRACE_BINARY_H
+#define TRACE_BINARY_H
+
+#include <stdio.h>
+#include <vector>
+
+#ifdef _WIN32
+#include "pthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "types.h"
+
+// /**
+// CONSTANT    :: TRACE_BINARY_MAGIC : 0x52544e51
+// DESCRIPTION :: Magic number of the header record ("QNTR")
+// **/
+#define TRACE_BINARY_MAGIC 0x52544e51
+
+// /**
+// CONSTANT    :: TRACE_BINARY_VERSION : 1
+// DESCRIPTION :: Version of the binary trace format
+// **/
+#define TRACE_BINARY_VERSION 1
+
+// /**
+// CONSTANT    :: TRACE_BINARY_DEFAULT_BUFFER_SIZE : 1048576
+// DESCRIPTION :: Default size in bytes of each of the two buffers of a
+//                binary trace writer
+// **/
+#define TRACE_BINARY_DEFAULT_BUFFER_SIZE 1048576
+
+// /**
+// ENUM        :: TraceBinaryRecordType
+// DESCRIPTION :: Types of the records of a binary trace file
+// **/
+enum TraceBinaryRecordType
+{
+    TRACE_BINARY_HEADER = 1,
+    TRACE_BINARY_PROTOCOL_MAP,
+    TRACE_BINARY_RECORD,
+    TRACE_BINARY_TAIL
+};
+
+// /**
+// STRUCT      :: TraceBinaryRecordHeader
+// DESCRIPTION :: Fixed part of a packet trace record
+// **/
+struct TraceBinaryRecordHeader
+{
+    UInt32 originatingNodeId;
+    Int32 sequenceNumber;
+    Int64 simTime;
+    Int32 originatingProtocol;
+    UInt32 nodeId;
+    Int32 traceProtocol;
+    UInt16 actionType;
+    BOOL hasQueue;
+    UInt16 actionComment;
+    UInt16 interfaceId;
+    UInt8 queuePriority;
+};
+
+// /**
+// CLASS       :: TraceBinaryWriter
+// DESCRIPTION :: Writes the binary trace of a partition.  Records are
+//                appended to one of two buffers; a full buffer is
+//                handed to a background thread that writes it to the
+//                file while the other buffer is filled.  The simulation
+//                only waits for the thread if it fills a buffer before
+//                the thread has written the previous one.
+// **/
+class TraceBinaryWriter
+{
+public:
+    TraceBinaryWriter(FILE* fp, int bufferSize);
+    ~TraceBinaryWriter();
+
+    void writeHeader(const char* version,
+                     const char* scenario,
+                     const char* comments);
+    void writeProtocolMap(int protocol, const char* protocolName);
+
+    // A packet trace record is written by beginRecord, any number of
+    // appendBody and endRecord
+    void beginRecord(const TraceBinaryRecordHeader& header);
+    void appendBody(const char* text, int length);
+    void endRecord();
+
+    void writeTail();
+
+    // Write all buffered records and stop the thread.  The file is not
+    // closed.
+    void close();
+
+private:
+    FILE* fp_;
+    int bufferSize_;
+
+    char* buffer_[2];
+    int active_;
+    int used_;
+
+    // Buffer being written by the thread, NULL if none
+    char* pending_;
+    int pendingLength_;
+    BOOL stop_;
+    BOOL started_;
+
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+    pthread_t thread_;
+
+    // Record being built
+    std::vector<char> record_;
+
+    void beginRecordType(TraceBinaryRecordType type);
+    void endRecordType();
+
+    void put(const char* data, int length);
+    void handOver();
+
+    static void* run(void* data);
+};
+
+#endif // TRACE_BINARY_H
@@ -471,7 +471,7 @@ private: int spin_busy()
             return NULL;
         }
 
-        int push_back_xxx(T msg)
+        int push_back_xxx(const T& msg)
         {
             m_list.push_back(msg);
             m_inserts++;
@@ -479,7 +479,7 @@ private: int spin_busy()
             return m_list.size();
         }
         
-        int push_back(T msg, 
+        int push_back(const T& msg, 
                       bool wakeAfterInsert)
         {
             int size(0);
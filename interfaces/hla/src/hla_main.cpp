@@ -48,6 +48,7 @@
 #include "app_gen_ftp.h" //gss xd
 //#include "partition.h" //gss xd
 #include "application.h" //gss xd
+#include "app_stats_store.h" //gss xd
 
 //gss xd
 #include <deque>
@@ -60,8 +61,6 @@ using namespace std;
 //     signal() handler only takes a single integer argument.
 // (2) To support HlaGetIfaceDataFromNodeId().
 
-deque<APPStatsNew> g_APPStatsNew_deque;   //gss xd
-
 HlaInterfaceData* g_ifaceData = 0;
 
 void
@@ -3293,7 +3292,7 @@ HlaSendCommentIxn(HlaInterfaceData * ifaceData,
 									statsNew.simTime = simTime / 1000000000;
 									statsNew.dataSent = dataSent;
 									if (statsNew.MessageSent > 0) {
-										g_APPStatsNew_deque.push_back(statsNew);
+										g_APPStatsStore.Add(statsNew);
 									}
 									//ifaceData->m_hla->partitionData->sysAPPStats[ifaceData->m_hla->partitionData->numoflist-1].
 
@@ -3398,7 +3397,7 @@ HlaSendCommentIxn(HlaInterfaceData * ifaceData,
 									statsNew.MessageSent = MessageSent;
 									statsNew.simTime = simTime / 1000000000;
 									statsNew.dataSent = dataSent;
-									g_APPStatsNew_deque.push_back(statsNew);
+									g_APPStatsStore.Add(statsNew);
 									break;
 								}
 							}
@@ -3498,7 +3497,7 @@ HlaSendCommentIxn(HlaInterfaceData * ifaceData,
 									statsNew.MessageSent = MessageSent;
 									statsNew.simTime = simTime / 1000000000;
 									statsNew.dataSent = dataSent;
-									g_APPStatsNew_deque.push_back(statsNew);
+									g_APPStatsStore.Add(statsNew);
 
 									break;
 								}
@@ -3601,7 +3600,7 @@ HlaSendCommentIxn(HlaInterfaceData * ifaceData,
 									statsNew.simTime = simTime / 1000000000;
 									statsNew.dataSent = dataSent;
 
-									g_APPStatsNew_deque.push_back(statsNew);
+									g_APPStatsStore.Add(statsNew);
 
 
 									break;
@@ -3705,7 +3704,7 @@ HlaSendCommentIxn(HlaInterfaceData * ifaceData,
 									statsNew.simTime = simTime / 1000000000;
 									statsNew.dataSent = dataSent;
 
-									g_APPStatsNew_deque.push_back(statsNew);
+									g_APPStatsStore.Add(statsNew);
 
 
 									break;
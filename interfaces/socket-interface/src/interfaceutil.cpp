@@ -328,9 +328,20 @@ void CreateNewConnection(
 
     pthread_mutex_lock(&sockets->socketMutex);
 
-    // Initialize blocking and threaded
     s = new EXTERNAL_Socket;
-    EXTERNAL_SocketInit(s, TRUE, TRUE);
+#ifdef __linux__
+    if (sockets->poller.epollFd >= 0)
+    {
+        // Initialize non-blocking and not threaded, the connection is read
+        // by the epoll loop of the receiver thread
+        EXTERNAL_SocketInit(s, FALSE, FALSE);
+    }
+    else
+#endif /* __linux__ */
+    {
+        // Initialize blocking and threaded
+        EXTERNAL_SocketInit(s, TRUE, TRUE);
+    }
 
     // Add to arrays, currently socket is inactive
     i = sockets->connections.size();
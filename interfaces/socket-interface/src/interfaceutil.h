@@ -38,6 +38,12 @@ struct SocketInterface_Sockets
     pthread_cond_t senderNotFull;
     pthread_cond_t senderNotEmpty;
 
+#ifdef __linux__
+    // The epoll set of the listening sockets and connections the receiver
+    // thread waits on.  epollFd is -1 if the receiver thread uses select.
+    EXTERNAL_SocketPoller poller;
+#endif /* __linux__ */
+
     SocketInterface_Sockets();
 };
 
@@ -89,6 +89,11 @@ SocketInterface_Sockets::SocketInterface_Sockets()
     pthread_mutex_init(&senderMutex, NULL);
     pthread_cond_init(&senderNotFull, NULL);
     pthread_cond_init(&senderNotEmpty, NULL);
+
+#ifdef __linux__
+    poller.epollFd = -1;
+    poller.wakeFd = -1;
+#endif /* __linux__ */
 }
 
 // Returns the simulation time from the MTS perspective
@@ -701,6 +706,275 @@ void SocketInterface_HandleException(
     delete error;
 }
 
+#ifdef __linux__
+// Maximum number of events handled per wait of the receiver thread
+#define SOCKET_INTERFACE_MAX_POLL_EVENTS 64
+
+// Handle the complete messages at the start of the receive buffer of a
+// connection.  A partial message is moved to the start of the buffer and
+// completed by later reads.
+static void SocketInterface_HandleReceiveBuffer(
+    EXTERNAL_Interface* iface,
+    EXTERNAL_VarArray* buffer,
+    int socketId)
+{
+    SocketInterface_SerializedMessage data;
+    SocketInterface_Header header;
+    UInt32 messageLength;
+    unsigned int offset = 0;
+
+    while (buffer->size - offset >= SOCKET_INTERFACE_HEADER_SIZE)
+    {
+        memcpy(&header, buffer->data + offset, SOCKET_INTERFACE_HEADER_SIZE);
+        messageLength = header.messageSize;
+        EXTERNAL_ntoh(&messageLength, sizeof(UInt32));
+
+        if (messageLength < sizeof(SocketInterface_Header))
+        {
+            // The stream can not be resynchronized after a bad header, so
+            // drop everything that was received
+            SocketInterface_Exception e(
+                SocketInterface_ErrorType_InvalidMessage,
+                "Received a QualNet header packet with too small of size.");
+            data.Resize(SOCKET_INTERFACE_HEADER_SIZE);
+            data.AddData((UInt8*) &header, SOCKET_INTERFACE_HEADER_SIZE, FALSE);
+            SocketInterface_HandleException(iface, &e, &data, socketId);
+            offset = buffer->size;
+            break;
+        }
+        if (buffer->size - offset < messageLength)
+        {
+            break;
+        }
+
+        // Same layout as SocketInterface_ReceiveSerializedMessage produces
+        data.Resize(messageLength);
+        data.AddData((UInt8*) &header, sizeof(SocketInterface_Header), FALSE);
+        memcpy(&data.m_Data[SOCKET_INTERFACE_HEADER_SIZE],
+               buffer->data + offset + SOCKET_INTERFACE_HEADER_SIZE,
+               messageLength - SOCKET_INTERFACE_HEADER_SIZE);
+        offset += messageLength;
+
+        // Deserialize the message
+        SocketInterface_Message* message = NULL;
+        try
+        {
+            message = data.Deserialize();
+        }
+        catch (SocketInterface_Exception& e)
+        {
+            SocketInterface_HandleException(iface, &e, &data, socketId);
+            continue;
+        }
+
+        // Handle the message
+        try
+        {
+            SocketInterface_HandleReceiverMessage(iface, message, socketId);
+        }
+        catch (SocketInterface_Exception& e)
+        {
+            SocketInterface_HandleException(iface, &e, message, socketId);
+            delete message;
+        }
+    }
+
+    if (offset > 0)
+    {
+        memmove(buffer->data, buffer->data + offset, buffer->size - offset);
+        buffer->size -= offset;
+    }
+}
+
+// Read everything waiting on a connection and handle the complete
+// messages.  Each connection keeps its receive buffer for the whole run.
+static void SocketInterface_PollConnection(
+    EXTERNAL_Interface* iface,
+    std::vector<EXTERNAL_VarArray*>* buffers,
+    int socketId)
+{
+    SocketInterface_InterfaceData* socketData = (SocketInterface_InterfaceData*) iface->data;
+    SocketInterface_Sockets* sockets = &socketData->sockets;
+    EXTERNAL_SocketErrorType err;
+    unsigned int receiveSize;
+    char str[MAX_STRING_LENGTH];
+
+    if (!sockets->activeConnections[socketId])
+    {
+        return;
+    }
+
+    if (buffers->size() <= (unsigned) socketId)
+    {
+        buffers->resize(socketId + 1, NULL);
+    }
+    if ((*buffers)[socketId] == NULL)
+    {
+        (*buffers)[socketId] = new EXTERNAL_VarArray;
+        EXTERNAL_VarArrayInit((*buffers)[socketId]);
+    }
+    EXTERNAL_VarArray* buffer = (*buffers)[socketId];
+
+    err = EXTERNAL_SocketRecvAvailable(
+        sockets->connections[socketId],
+        buffer,
+        &receiveSize);
+
+    SocketInterface_HandleReceiveBuffer(iface, buffer, socketId);
+
+    if (err != EXTERNAL_NoSocketError)
+    {
+        buffer->size = 0;
+        HandleSocketError(
+            iface,
+            sockets,
+            socketId,
+            EXTERNAL_SocketError,
+            str);
+    }
+}
+
+// Read the threaded connections, which only make the poller wake up
+static void SocketInterface_PollThreadedConnections(
+    EXTERNAL_Interface* iface,
+    std::vector<EXTERNAL_VarArray*>* buffers)
+{
+    SocketInterface_InterfaceData* socketData = (SocketInterface_InterfaceData*) iface->data;
+    SocketInterface_Sockets* sockets = &socketData->sockets;
+    unsigned i;
+
+    for (i = 0; i < sockets->connections.size(); i++)
+    {
+        if (sockets->activeConnections[i] && sockets->connections[i]->threaded)
+        {
+            SocketInterface_PollConnection(iface, buffers, i);
+        }
+    }
+}
+
+// Receiver loop waiting on the epoll set of the interface.  Connections
+// are edge triggered and read until they have no more data, so the thread
+// sleeps until a federate sends something and wakes up without the delay
+// of a select timeout.  Listening sockets are level triggered since one
+// connection is accepted per event.  Threaded connections made in
+// bootstrap mode and SocketInterface_Finalize wake up the loop through
+// the eventfd of the poller.
+static void SocketInterface_PollReceiverThread(EXTERNAL_Interface* iface)
+{
+    SocketInterface_InterfaceData* socketData = (SocketInterface_InterfaceData*) iface->data;
+    SocketInterface_Sockets* sockets = &socketData->sockets;
+    EXTERNAL_SocketEvent events[SOCKET_INTERFACE_MAX_POLL_EVENTS];
+    std::vector<EXTERNAL_VarArray*> buffers;
+    int numEvents;
+    int portIndex;
+    int i;
+    unsigned j;
+    char str[MAX_STRING_LENGTH];
+
+    // Listening sockets use negative ids
+    for (i = 0; i < sockets->numPorts; i++)
+    {
+        EXTERNAL_SocketPollerAdd(
+            &sockets->poller,
+            sockets->listeningSockets[i],
+            -1 - i,
+            FALSE);
+    }
+    for (j = 0; j < sockets->connections.size(); j++)
+    {
+        EXTERNAL_SocketPollerAdd(
+            &sockets->poller,
+            sockets->connections[j],
+            j,
+            TRUE);
+    }
+
+    // Handle what the threaded connections received before they were added
+    SocketInterface_PollThreadedConnections(iface, &buffers);
+
+    while (socketData->simulationState != SocketInterface_StateType_Shutdown)
+    {
+        // If CPU hog poll without sleeping
+        numEvents = EXTERNAL_SocketPollerWait(
+            &sockets->poller,
+            events,
+            SOCKET_INTERFACE_MAX_POLL_EVENTS,
+            socketData->cpuHog ? 0 : -1);
+        if (numEvents == -1)
+        {
+            break;
+        }
+
+        for (i = 0; i < numEvents; i++)
+        {
+            if (events[i].wakeup)
+            {
+                SocketInterface_PollThreadedConnections(iface, &buffers);
+            }
+            else if (events[i].id < 0)
+            {
+                portIndex = -1 - events[i].id;
+                if (!EXTERNAL_SocketValid(sockets->listeningSockets[portIndex]))
+                {
+                    continue;
+                }
+
+                CreateNewConnection(
+                    iface,
+                    sockets,
+                    portIndex,
+                    str);
+                if (str[0] != 0)
+                {
+                    printf(str); fflush(stdout);
+                }
+
+                int socketId = sockets->connections.size() - 1;
+                EXTERNAL_SocketPollerAdd(
+                    &sockets->poller,
+                    sockets->connections[socketId],
+                    socketId,
+                    TRUE);
+
+                // Send state to new connection
+                SocketInterface_SimulationStateMessage* state = new SocketInterface_SimulationStateMessage(
+                    socketData->simulationState,
+                    socketData->simulationState);
+                SocketInterface_SendMessage(iface, state, socketId);
+                delete state;
+
+                // Data sent before the connection was added is not
+                // reported by the edge triggered poller
+                SocketInterface_PollConnection(iface, &buffers, socketId);
+            }
+            else
+            {
+                SocketInterface_PollConnection(iface, &buffers, events[i].id);
+            }
+        }
+    }
+
+    // The threaded connections must not wake up the poller once it is
+    // closed by SocketInterface_Finalize
+    for (j = 0; j < sockets->connections.size(); j++)
+    {
+        if (sockets->connections[j]->threaded)
+        {
+            sockets->connections[j]->notifyFd = -1;
+        }
+    }
+
+    for (j = 0; j < buffers.size(); j++)
+    {
+        if (buffers[j] != NULL)
+        {
+            EXTERNAL_VarArrayFree(buffers[j]);
+            delete buffers[j];
+        }
+    }
+}
+#endif /* __linux__ */
+
 void* SocketInterface_ReceiverThread(void* voidIface)
 {
     EXTERNAL_Interface* iface = (EXTERNAL_Interface*) voidIface;
@@ -714,6 +988,15 @@ void* SocketInterface_ReceiverThread(void* voidIface)
     BOOL gotData;
     char str[MAX_STRING_LENGTH];
 
+#ifdef __linux__
+    if (EXTERNAL_SocketPollerInit(&socketData->sockets.poller)
+        == EXTERNAL_NoSocketError)
+    {
+        SocketInterface_PollReceiverThread(iface);
+        return NULL;
+    }
+#endif /* __linux__ */
+
     // Continue receiving until end of program
     while (socketData->simulationState != SocketInterface_StateType_Shutdown)
     {
@@ -7833,6 +8116,9 @@ void SocketInterface_Finalize(EXTERNAL_Interface *iface)
     // Change the state to shut down. At this point we have cleaned
     // up the sender thread buffer and the outgoing message list.
     data->simulationState = SocketInterface_StateType_Shutdown;
+#ifdef __linux__
+    EXTERNAL_SocketPollerWake(&data->sockets.poller);
+#endif /* __linux__ */
 
     // Close log files the data
     if (data->driverLogFile != NULL)
@@ -7886,6 +8172,9 @@ void SocketInterface_Finalize(EXTERNAL_Interface *iface)
         pthread_cond_signal(&data->sockets.senderNotEmpty);
         pthread_join(data->sockets.senderThread, NULL);
         pthread_join(data->sockets.receiverThread, NULL);
+#ifdef __linux__
+        EXTERNAL_SocketPollerClose(&data->sockets.poller);
+#endif /* __linux__ */
 
         // Create new QualNet process if resetting
         if (data->resetting)
@@ -8497,6 +8786,12 @@ void SocketInterface_PreInitialize(
     EXTERNAL_SocketErrorType socketErr;
     SocketInterface_SerializedMessage data;
     //WSADATA gWsaData;
+#ifdef __linux__
+    EXTERNAL_SocketPoller poller;
+    EXTERNAL_SocketEvent events[SOCKET_INTERFACE_MAX_POLL_EVENTS];
+    bool usePoller;
+    int j;
+#endif /* __linux__ */
 
     connections = new std::vector<EXTERNAL_Socket*>;
     messages = new std::vector<SocketInterface_Message*>;
@@ -8517,8 +8812,59 @@ void SocketInterface_PreInitialize(
         "Socket_Messages",
         (void*) messages);
 
+#ifdef __linux__
+    // Sleep on an epoll set until a federate connects or sends data instead
+    // of selecting every 1 ms.  The listening sockets are level triggered
+    // and the threaded connections wake up the poller through its eventfd.
+    usePoller = EXTERNAL_SocketPollerInit(&poller) == EXTERNAL_NoSocketError;
+    for (i = 0; usePoller && i < sockets->size(); i++)
+    {
+        if (EXTERNAL_SocketPollerAdd(&poller, (*sockets)[i], i, FALSE)
+            != EXTERNAL_NoSocketError)
+        {
+            EXTERNAL_SocketPollerClose(&poller);
+            usePoller = FALSE;
+        }
+    }
+#endif /* __linux__ */
+
     while (!gotScenario)
     {
+#ifdef __linux__
+        if (usePoller)
+        {
+            // Mark the listening sockets with pending connections in
+            // readSet so they are accepted the same way as with select
+            FD_ZERO(&readSet);
+            err = EXTERNAL_SocketPollerWait(
+                &poller,
+                events,
+                SOCKET_INTERFACE_MAX_POLL_EVENTS,
+                -1);
+            if (err == -1)
+            {
+                // Fall back to select for the rest of the bootstrap
+                for (i = 0; i < connections->size(); i++)
+                {
+                    (*connections)[i]->notifyFd = -1;
+                }
+                EXTERNAL_SocketPollerClose(&poller);
+                usePoller = FALSE;
+                continue;
+            }
+            for (j = 0; j < err; j++)
+            {
+                if (!events[j].wakeup)
+                {
+                    FD_SET(
+                        (unsigned int) (*sockets)[events[j].id]->socketFd,
+                        &readSet);
+                }
+            }
+        }
+        else
+#endif /* __linux__ */
+        {
         // Create set of all input sockets
         FD_ZERO(&readSet);
         max = -1;
@@ -8554,6 +8900,7 @@ void SocketInterface_PreInitialize(
             continue;
 #endif
         }
+        }
 
         // Now see which sockets have new connection
         for (i = 0; i < sockets->size(); i++)
@@ -8578,6 +8925,17 @@ void SocketInterface_PreInitialize(
                 }
 
                 connections->push_back(connectSocket);
+#ifdef __linux__
+                if (usePoller)
+                {
+                    // Data received before this is found by the scan below
+                    EXTERNAL_SocketPollerAdd(
+                        &poller,
+                        connectSocket,
+                        connections->size() - 1,
+                        TRUE);
+                }
+#endif /* __linux__ */
 
                 printf("Accepted a new connection in bootstrap mode\n");
 
@@ -8666,6 +9024,18 @@ void SocketInterface_PreInitialize(
             }
         }
     } // end of while
+
+#ifdef __linux__
+    if (usePoller)
+    {
+        // The receiver thread adds the connections to its own poller
+        for (i = 0; i < connections->size(); i++)
+        {
+            (*connections)[i]->notifyFd = -1;
+        }
+        EXTERNAL_SocketPollerClose(&poller);
+    }
+#endif /* __linux__ */
 }
 
 void CreateSocketArray(
@@ -3525,9 +3525,9 @@ int MacDot16HandleLastFragDataPdu(
         reassembleMsg->next = NULL;
         for (int i = 0; i < reassembleMsg->numberOfHeaders; i ++)
         {
-            reassembleMsg->headerProtocols[i] =
-                sFlow->fragMsg->headerProtocols[i];
-            reassembleMsg->headerSizes[i] = sFlow->fragMsg->headerSizes[i];
+            reassembleMsg->headerProtocols.set(i,
+                sFlow->fragMsg->headerProtocols[i]);
+            reassembleMsg->headerSizes.set(i, sFlow->fragMsg->headerSizes[i]);
         }
 
             // reassemble the payload
@@ -250,10 +250,10 @@ ip6_reass(Node* node, Message* msg, Ipv6FragQueue* fp)
         headerCounter < msg->numberOfHeaders;
         headerCounter++)
     {
-        joinedMsg->headerProtocols[headerCounter] =
-            tempFragData->msg->headerProtocols[headerCounter];
-        joinedMsg->headerSizes[headerCounter] =
-            tempFragData->msg->headerSizes[headerCounter];
+        joinedMsg->headerProtocols.set(headerCounter,
+            tempFragData->msg->headerProtocols[headerCounter]);
+        joinedMsg->headerSizes.set(headerCounter,
+            tempFragData->msg->headerSizes[headerCounter]);
 
     }
     MESSAGE_CopyInfo(node, joinedMsg, tempFragData->msg);
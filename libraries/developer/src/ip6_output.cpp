@@ -193,9 +193,9 @@ Ipv6FragmentPacket(
         headerCounter < msg->numberOfHeaders;
         headerCounter++)
     {
-        tmpMsg->headerProtocols[headerCounter] =
-            msg->headerProtocols[headerCounter];
-        tmpMsg->headerSizes[headerCounter] = msg->headerSizes[headerCounter];
+        tmpMsg->headerProtocols.set(headerCounter,
+            msg->headerProtocols[headerCounter]);
+        tmpMsg->headerSizes.set(headerCounter, msg->headerSizes[headerCounter]);
 
     }
     MESSAGE_CopyInfo(node, tmpMsg, msg);
@@ -34,6 +34,7 @@
 #include "ipv6.h"
 #include "ip6_icmp.h"
 #include "ip6_output.h"
+#include "network_ip_trie.h"
 #include "network_ip.h"
 #include "network_dualip.h"
 #include "network_icmp.h"
@@ -3610,6 +3611,10 @@ NetworkIpFinalize(Node *node)
 
     }
 #endif
+
+    // Free the prefix trie of the forwarding table, lookups made after
+    // this find no route
+    IpPrefixTrieFree(&ip->forwardTable.prefixTrie);
 }
 
 //-----------------------------------------------------------------------------
@@ -5639,6 +5644,14 @@ void NetworkIpReceivePacket(
 
     } // if (ip->isIcmpEnable)
 
+    // Traceroute hop counts and the record route and timestamp options
+    // are updated in place below
+    if (IpHeaderSize(ipHeader) > sizeof(IpHeaderType)
+        || ipHeader->ip_p == IPPROTO_ICMP)
+    {
+        ipHeader = (IpHeaderType *) MESSAGE_ReturnWritablePacket(node, msg);
+    }
+
     ip_traceroute *ipOption = FindTraceRouteOption(ipHeader);
     if (ipOption)
     {
@@ -10471,6 +10484,271 @@ ReturnPriorityForPHB(
 // Routing table (forwarding table)
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkIpForwardingTableAddPrefix()
+// PURPOSE      Account for a new row in the prefix trie of the table.
+// PARAMETERS   NetworkForwardingTable *forwardTable
+//                  Forwarding table.
+//              NodeAddress destAddress
+//                  Destination of the row.
+//              NodeAddress destAddressMask
+//                  Netmask of the row.
+// RETURN       None.
+//-----------------------------------------------------------------------------
+
+static void
+NetworkIpForwardingTableAddPrefix(
+    NetworkForwardingTable *forwardTable,
+    NodeAddress destAddress,
+    NodeAddress destAddressMask)
+{
+    int length;
+
+    // A row with host bits set in its destination never matches and is
+    // left out
+    if (!IpPrefixTrieIsPrefixMask(destAddressMask, &length))
+    {
+        forwardTable->numIrregularRows++;
+    }
+    else if (MaskIpAddress(destAddress, destAddressMask) == destAddress)
+    {
+        IpPrefixTrieInsert(&forwardTable->prefixTrie, destAddress, length);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkIpForwardingTableRemovePrefix()
+// PURPOSE      Account for a removed row in the prefix trie of the table.
+// PARAMETERS   NetworkForwardingTable *forwardTable
+//                  Forwarding table.
+//              NodeAddress destAddress
+//                  Destination of the row.
+//              NodeAddress destAddressMask
+//                  Netmask of the row.
+// RETURN       None.
+//-----------------------------------------------------------------------------
+
+static void
+NetworkIpForwardingTableRemovePrefix(
+    NetworkForwardingTable *forwardTable,
+    NodeAddress destAddress,
+    NodeAddress destAddressMask)
+{
+    int length;
+
+    // A row with host bits set in its destination never matches and is
+    // left out
+    if (!IpPrefixTrieIsPrefixMask(destAddressMask, &length))
+    {
+        forwardTable->numIrregularRows--;
+    }
+    else if (MaskIpAddress(destAddress, destAddressMask) == destAddress)
+    {
+        IpPrefixTrieRemove(&forwardTable->prefixTrie, destAddress, length);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkIpForwardingTableRowMatches()
+// PURPOSE      Check if a row that matches the destination can be used
+//              as a route.
+// PARAMETERS   const NetworkForwardingTableRow *row
+//                  Row.
+//              const NetworkForwardingTableFilter *filter
+//                  Filter, NULL for any row.
+// RETURN       TRUE if the row can be used.
+//-----------------------------------------------------------------------------
+
+static BOOL
+NetworkIpForwardingTableRowMatches(
+    const NetworkForwardingTableRow *row,
+    const NetworkForwardingTableFilter *filter)
+{
+    if (row->nextHopAddress == (unsigned) NETWORK_UNREACHABLE
+        || row->interfaceIsEnabled == FALSE)
+    {
+        return FALSE;
+    }
+    if (filter == NULL)
+    {
+        return TRUE;
+    }
+    if (filter->interfaceIndex != ANY_INTERFACE
+        && row->interfaceIndex != filter->interfaceIndex)
+    {
+        return FALSE;
+    }
+    if ((filter->protocolMatch == FORWARDING_TABLE_SAME_PROTOCOL
+         && row->protocolType != filter->protocolType)
+        || (filter->protocolMatch == FORWARDING_TABLE_OTHER_PROTOCOL
+            && row->protocolType == filter->protocolType))
+    {
+        return FALSE;
+    }
+    return row->adminDistance <= filter->maxAdminDistance;
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkIpLookupForwardingTableRow()
+// PURPOSE      Find the first row of the table that matches the
+//              destination and passes the filter.  The table order puts
+//              longer prefixes first, so this is the longest prefix
+//              match.  The matching prefixes are taken from the trie,
+//              longest first, and the rows of each are found by binary
+//              search.
+// PARAMETERS   const NetworkForwardingTable *forwardTable
+//                  Forwarding table.
+//              NodeAddress destinationAddress
+//                  Destination IP address.
+//              const NetworkForwardingTableFilter *filter
+//                  Filter, NULL for any row.
+// RETURN       Index of the row, -1 if there is none.
+//-----------------------------------------------------------------------------
+
+static int
+NetworkIpLookupForwardingTableRow(
+    const NetworkForwardingTable *forwardTable,
+    NodeAddress destinationAddress,
+    const NetworkForwardingTableFilter *filter)
+{
+    int i;
+
+    if (forwardTable->numIrregularRows > 0)
+    {
+        for (i = 0; i < forwardTable->size; i++)
+        {
+            const NetworkForwardingTableRow *row = &forwardTable->row[i];
+
+            if (row->destAddress ==
+                    MaskIpAddress(destinationAddress, row->destAddressMask)
+                && NetworkIpForwardingTableRowMatches(row, filter))
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    const IpPrefixTrieNode *matches[IP_PREFIX_TRIE_MAX_MATCHES];
+    int numMatches = IpPrefixTrieMatch(forwardTable->prefixTrie,
+                                       destinationAddress,
+                                       matches);
+
+    for (int m = numMatches - 1; m >= 0; m--)
+    {
+        NodeAddress destAddress = matches[m]->prefix;
+        NodeAddress destAddressMask =
+            ConvertNumHostBitsToSubnetMask(32 - matches[m]->length);
+
+        // First row of the prefix
+        int low = 0;
+        int high = forwardTable->size;
+        while (low < high)
+        {
+            int mid = (low + high) / 2;
+            const NetworkForwardingTableRow *row = &forwardTable->row[mid];
+
+            if (row->destAddress > destAddress
+                || (row->destAddress == destAddress
+                    && row->destAddressMask > destAddressMask))
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        for (i = low;
+             i < forwardTable->size
+             && forwardTable->row[i].destAddress == destAddress
+             && forwardTable->row[i].destAddressMask == destAddressMask;
+             i++)
+        {
+            if (NetworkIpForwardingTableRowMatches(&forwardTable->row[i],
+                                                   filter))
+            {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+void NetworkInitForwardingTableFilter(
+    NetworkForwardingTableFilter *filter)
+{
+    filter->interfaceIndex = ANY_INTERFACE;
+    filter->protocolMatch = FORWARDING_TABLE_ANY_PROTOCOL;
+    filter->protocolType = ROUTING_PROTOCOL_NONE;
+    filter->maxAdminDistance = ROUTING_ADMIN_DISTANCE_DEFAULT;
+}
+
+const NetworkForwardingTableRow*
+NetworkLookupForwardingTable(
+    Node *node,
+    NodeAddress destinationAddress,
+    const NetworkForwardingTableFilter *filter)
+{
+    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
+    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
+    int i = NetworkIpLookupForwardingTableRow(forwardTable,
+                                              destinationAddress,
+                                              filter);
+
+    return i < 0 ? NULL : &forwardTable->row[i];
+}
+
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkIpLookupForwardingTableRoute()
+// PURPOSE      Look up a route and fill in the outputs of the
+//              NetworkGetInterfaceAndNextHopFromForwardingTable variants.
+// PARAMETERS   Node *node
+//                  Pointer to node.
+//              NodeAddress destinationAddress
+//                  Destination IP address.
+//              const NetworkForwardingTableFilter *filter
+//                  Filter, NULL for any row.
+//              int *interfaceIndex
+//                  Storage for index of outgoing interface.
+//              NodeAddress *nextHopAddress
+//                  Storage for next hop IP address.
+//              BOOL *routeType
+//                  Storage for TRUE if the route is a host route, may be
+//                  NULL.  Left unchanged if there is no route.
+// RETURN       None.
+//-----------------------------------------------------------------------------
+
+static void
+NetworkIpLookupForwardingTableRoute(
+    Node *node,
+    NodeAddress destinationAddress,
+    const NetworkForwardingTableFilter *filter,
+    int *interfaceIndex,
+    NodeAddress *nextHopAddress,
+    BOOL *routeType)
+{
+    const NetworkForwardingTableRow *row =
+        NetworkLookupForwardingTable(node, destinationAddress, filter);
+
+    if (row == NULL)
+    {
+        *interfaceIndex = NETWORK_UNREACHABLE;
+        *nextHopAddress = (unsigned) NETWORK_UNREACHABLE;
+        return;
+    }
+
+    if (routeType != NULL)
+    {
+        *routeType =
+            MaskIpAddress(destinationAddress, row->destAddressMask)
+                == destinationAddress;
+    }
+    *interfaceIndex = row->interfaceIndex;
+    *nextHopAddress = row->nextHopAddress;
+}
+
 //-----------------------------------------------------------------------------
 // FUNCTION     NetworkGetInterfaceAndNextHopFromForwardingTable()
 // PURPOSE      Do a lookup on the routing table with a destination IP
@@ -10495,30 +10773,12 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable(
     int *interfaceIndex,
     NodeAddress *nextHopAddress)
 {
-    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
-    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
-    int i;
-
-    *interfaceIndex = NETWORK_UNREACHABLE;
-    *nextHopAddress = (unsigned) NETWORK_UNREACHABLE;
-
-    //NetworkPrintForwardingTable(node);
-
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress, forwardTable->row[i].destAddressMask);
-
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
-        {
-            *interfaceIndex = forwardTable->row[i].interfaceIndex;
-            *nextHopAddress = forwardTable->row[i].nextHopAddress;
-            break;
-        }
-    }
+    NetworkIpLookupForwardingTableRoute(node,
+                                        destinationAddress,
+                                        NULL,
+                                        interfaceIndex,
+                                        nextHopAddress,
+                                        NULL);
 }
 
 //-----------------------------------------------------------------------------
@@ -10549,31 +10809,17 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable(
     int *interfaceIndex,
     NodeAddress *nextHopAddress)
 {
-    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
-    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
-    int i;
+    NetworkForwardingTableFilter filter;
 
-    *interfaceIndex = NETWORK_UNREACHABLE;
-    *nextHopAddress = (unsigned) NETWORK_UNREACHABLE;
+    NetworkInitForwardingTableFilter(&filter);
+    filter.interfaceIndex = currentInterface;
 
-    //NetworkPrintForwardingTable(node);
-
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress, forwardTable->row[i].destAddressMask);
-
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE
-            && forwardTable->row[i].interfaceIndex == currentInterface)
-        {
-            *interfaceIndex = forwardTable->row[i].interfaceIndex;
-            *nextHopAddress = forwardTable->row[i].nextHopAddress;
-            break;
-        }
-    }
+    NetworkIpLookupForwardingTableRoute(node,
+                                        destinationAddress,
+                                        &filter,
+                                        interfaceIndex,
+                                        nextHopAddress,
+                                        NULL);
 }
 //-----------------------------------------------------------------------------
 // FUNCTION     NetworkGetInterfaceAndNextHopFromForwardingTable()
@@ -10602,43 +10848,12 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable(
     NodeAddress *nextHopAddress,
     BOOL *routeType)
 {
-    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
-    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
-    int i;
-
-    *interfaceIndex = NETWORK_UNREACHABLE;
-    *nextHopAddress = (unsigned) NETWORK_UNREACHABLE;
-
- //   NetworkPrintForwardingTable(node);
-
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress, forwardTable->row[i].destAddressMask);
-
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress != (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
-        {
-            if (maskedDestinationAddress == destinationAddress)
-            {
-                *routeType = TRUE;
-            }
-            else
-            {
-                *routeType = FALSE;
-            }
-			/*if (node->nodeId == 2) {
-				*interfaceIndex = 0;
-				*nextHopAddress = 3187672066;
-			}
-			else {*/
-			*interfaceIndex = forwardTable->row[i].interfaceIndex;
-			*nextHopAddress = forwardTable->row[i].nextHopAddress;
-			//}
-            break;
-        }
-    }
+    NetworkIpLookupForwardingTableRoute(node,
+                                        destinationAddress,
+                                        NULL,
+                                        interfaceIndex,
+                                        nextHopAddress,
+                                        routeType);
 }
 
 //-----------------------------------------------------------------------------
@@ -10672,42 +10887,19 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
     BOOL testType,
     NetworkRoutingProtocolType type)
 {
-    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
-    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
-    int i;
-
-    *interfaceIndex = NETWORK_UNREACHABLE;
-    *nextHopAddress = (unsigned) NETWORK_UNREACHABLE;
-
-    // NetworkPrintForwardingTable(node);
+    NetworkForwardingTableFilter filter;
 
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress,
-                forwardTable->row[i].destAddressMask);
+    NetworkInitForwardingTableFilter(&filter);
+    filter.protocolMatch = testType ? FORWARDING_TABLE_SAME_PROTOCOL
+                                    : FORWARDING_TABLE_OTHER_PROTOCOL;
+    filter.protocolType = type;
 
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
-        {
-            if (testType == TRUE &&
-                forwardTable->row[i].protocolType == type)
-            {
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-            else if (testType == FALSE && forwardTable->row[i].protocolType
-                != type)
-            {
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-        }
-    }
+    NetworkIpLookupForwardingTableRoute(node,
+                                        destinationAddress,
+                                        &filter,
+                                        interfaceIndex,
+                                        nextHopAddress,
+                                        NULL);
 }
 
 //-----------------------------------------------------------------------------
@@ -10747,43 +10939,20 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
     BOOL testType,
     NetworkRoutingProtocolType type)
 {
-    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
-    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
-    int i;
-
-    *interfaceIndex = NETWORK_UNREACHABLE;
-    *nextHopAddress = (unsigned) NETWORK_UNREACHABLE;
+    NetworkForwardingTableFilter filter;
 
-    // NetworkPrintForwardingTable(node);
-
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress,
-                forwardTable->row[i].destAddressMask);
+    NetworkInitForwardingTableFilter(&filter);
+    filter.interfaceIndex = operatingInterface;
+    filter.protocolMatch = testType ? FORWARDING_TABLE_SAME_PROTOCOL
+                                    : FORWARDING_TABLE_OTHER_PROTOCOL;
+    filter.protocolType = type;
 
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress !=
-            (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE
-            && forwardTable->row[i].interfaceIndex == operatingInterface)
-        {
-            if (testType == TRUE &&
-                forwardTable->row[i].protocolType == type)
-            {
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-            else if (testType == FALSE && forwardTable->row[i].protocolType
-                != type)
-            {
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-        }
-    }
+    NetworkIpLookupForwardingTableRoute(node,
+                                        destinationAddress,
+                                        &filter,
+                                        interfaceIndex,
+                                        nextHopAddress,
+                                        NULL);
 }
 
 
@@ -10825,60 +10994,19 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
     NetworkRoutingProtocolType type,
     BOOL* routeType)
 {
-    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
-    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
-    int i;
-
-    *interfaceIndex = NETWORK_UNREACHABLE;
-    *nextHopAddress = (unsigned) NETWORK_UNREACHABLE;
-
-    // NetworkPrintForwardingTable(node);
-
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress,
-                forwardTable->row[i].destAddressMask);
-
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress != (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
-        {
-            if (testType == TRUE &&
-                forwardTable->row[i].protocolType == type)
-            {
-
-                if (maskedDestinationAddress == destinationAddress)
-                {
-                    *routeType = TRUE;
-                }
-                else
-                {
-                    *routeType = FALSE;
-                }
-
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-            else if (testType == FALSE && forwardTable->row[i].protocolType != type)
-            {
+    NetworkForwardingTableFilter filter;
 
-                if (maskedDestinationAddress == destinationAddress)
-                {
-                    *routeType = TRUE;
-                }
-                else
-                {
-                    *routeType = FALSE;
-                }
+    NetworkInitForwardingTableFilter(&filter);
+    filter.protocolMatch = testType ? FORWARDING_TABLE_SAME_PROTOCOL
+                                    : FORWARDING_TABLE_OTHER_PROTOCOL;
+    filter.protocolType = type;
 
-                *interfaceIndex = forwardTable->row[i].interfaceIndex;
-                *nextHopAddress = forwardTable->row[i].nextHopAddress;
-                break;
-            }
-        }
-    }
+    NetworkIpLookupForwardingTableRoute(node,
+                                        destinationAddress,
+                                        &filter,
+                                        interfaceIndex,
+                                        nextHopAddress,
+                                        routeType);
 }
 
 #ifdef ADDON_BOEINGFCS
@@ -10888,29 +11016,16 @@ void NetworkGetInterfaceAndSubnetAddressFromForwardingTable(
     int *interfaceIndex,
     NodeAddress *subnetMask)
 {
-    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
-    NetworkForwardingTable *forwardTable = &(ip->forwardTable);
-    int i;
+    const NetworkForwardingTableRow *row =
+        NetworkLookupForwardingTable(node, destinationAddress, NULL);
 
     *interfaceIndex = NETWORK_UNREACHABLE;
     *subnetMask = (unsigned) NETWORK_UNREACHABLE;
 
-    //NetworkPrintForwardingTable(node);
-
-    for (i=0; i < forwardTable->size; i++) {
-        NodeAddress maskedDestinationAddress =
-            MaskIpAddress(
-                destinationAddress, forwardTable->row[i].destAddressMask);
-
-        if (forwardTable->row[i].destAddress == maskedDestinationAddress
-            && forwardTable->row[i].nextHopAddress
-            != (unsigned) NETWORK_UNREACHABLE
-            && forwardTable->row[i].interfaceIsEnabled != FALSE)
-        {
-            *interfaceIndex = forwardTable->row[i].interfaceIndex;
-            *subnetMask = maskedDestinationAddress;
-            break;
-        }
+    if (row != NULL)
+    {
+        *interfaceIndex = row->interfaceIndex;
+        *subnetMask = row->destAddress;
     }
 }
 #endif
@@ -11318,6 +11433,8 @@ NetworkInitForwardingTable(Node *node)
     ip->forwardTable.size = 0;
     ip->forwardTable.allocatedSize = 0;
     ip->forwardTable.row = NULL;
+    ip->forwardTable.prefixTrie = NULL;
+    ip->forwardTable.numIrregularRows = 0;
 #ifdef ADDON_STATS_MANAGER
 #ifdef D_LISTENING_ENABLED
 
@@ -11577,6 +11694,10 @@ NetworkUpdateForwardingTable(
             forwardTable->row[i] = forwardTable->row[i - 1];
             i--;
         }//while//
+
+        NetworkIpForwardingTableAddPrefix(forwardTable,
+                                          destAddress,
+                                          destAddressMask);
     }//if//
 
     forwardTable->row[i].destAddress = destAddress;
@@ -11606,6 +11727,41 @@ NetworkUpdateForwardingTable(
     }
 }
 
+//-----------------------------------------------------------------------------
+// FUNCTION     NetworkDeleteForwardingTableRow()
+// PURPOSE      Remove a row of the routing table, keeping the order of
+//              the other rows and the prefix trie.
+// PARAMETERS   Node *node
+//                  Pointer to node.
+//              int rowIndex
+//                  Index of the row.
+// RETURN       None.
+//-----------------------------------------------------------------------------
+
+void
+NetworkDeleteForwardingTableRow(
+    Node *node,
+    int rowIndex)
+{
+    NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
+    NetworkForwardingTable *rt = &ip->forwardTable;
+
+    ERROR_Assert(rowIndex >= 0 && rowIndex < rt->size,
+                 "Forwarding table row out of range");
+
+    NetworkIpForwardingTableRemovePrefix(rt,
+                                         rt->row[rowIndex].destAddress,
+                                         rt->row[rowIndex].destAddressMask);
+
+    // Move all other entries down
+    memmove(&rt->row[rowIndex],
+            &rt->row[rowIndex + 1],
+            (rt->size - rowIndex - 1) * sizeof(NetworkForwardingTableRow));
+
+    // Update forwarding table size.
+    rt->size--;
+}
+
 // /---------------------------------------------------------------------------
 // API        :: NetworkRemoveForwardingTableEntry
 // LAYER      :: Network
@@ -11641,17 +11797,7 @@ NetworkRemoveForwardingTableEntry(
             (rt->row[i].nextHopAddress == nextHopAddress) &&
             (rt->row[i].interfaceIndex == outgoingInterfaceIndex) )
         {
-            int j = i + 1;
-
-            // Move all other entries down
-            while (j < rt->size)
-            {
-                rt->row[j - 1] = rt->row[j];
-                j++;
-            }
-
-            // Update forwarding table size.
-            rt->size--;
+            NetworkDeleteForwardingTableRow(node, i);
         }
         else
         {
@@ -11689,17 +11835,7 @@ NetworkEmptyForwardingTable(
         // Delete entries that corresponds to the routing protocol used
         if (rt->row[i].protocolType == type)
         {
-            int j = i + 1;
-
-            // Move all other entries down
-            while (j < rt->size)
-            {
-                rt->row[j - 1] = rt->row[j];
-                j++;
-            }
-
-            // Update forwarding table size.
-            rt->size--;
+            NetworkDeleteForwardingTableRow(node, i);
         }
         else
         {
@@ -17695,7 +17831,8 @@ static BOOL //inline//
 SourceRouteThePacket(Node *node, Message *msg, int incomingInterface)
 {
     NetworkDataIp *ip = (NetworkDataIp *) node->networkData.networkVar;
-    IpHeaderType *ipHeader = (IpHeaderType *) msg->packet;
+    IpHeaderType *ipHeader =
+        (IpHeaderType *) MESSAGE_ReturnWritablePacket(node, msg);
     NetworkDataIcmp *icmp = (NetworkDataIcmp*) ip->icmpStruct;
     IpOptionsHeaderType *ipOptions =
                                    IpHeaderSourceRouteOptionField(ipHeader);
@@ -19922,9 +20059,9 @@ IpFragmentPacket(
         headerCounter < msg->numberOfHeaders;
         headerCounter++)
     {
-        tmpMsg->headerProtocols[headerCounter] =
-            msg->headerProtocols[headerCounter];
-        tmpMsg->headerSizes[headerCounter] = msg->headerSizes[headerCounter];
+        tmpMsg->headerProtocols.set(headerCounter,
+            msg->headerProtocols[headerCounter]);
+        tmpMsg->headerSizes.set(headerCounter, msg->headerSizes[headerCounter]);
     }
     MESSAGE_CopyInfo(node, tmpMsg, msg);
     //------------------------------------------------------------------------//
@@ -20881,10 +21018,10 @@ IpFragementReassamble(Node* node, Message* msg, IpFragQueue* fp, int interfaceId
         headerCounter < tempFragData->msg->numberOfHeaders;
         headerCounter++)
     {
-        joinedMsg->headerProtocols[headerCounter] =
-            tempFragData->msg->headerProtocols[headerCounter];
-        joinedMsg->headerSizes[headerCounter] =
-            tempFragData->msg->headerSizes[headerCounter];
+        joinedMsg->headerProtocols.set(headerCounter,
+            tempFragData->msg->headerProtocols[headerCounter]);
+        joinedMsg->headerSizes.set(headerCounter,
+            tempFragData->msg->headerSizes[headerCounter]);
 
     }
     MESSAGE_CopyInfo(node, joinedMsg, tempFragData->msg);
@@ -24146,6 +24283,7 @@ NetworkIpDecreaseTTL(Node *node, Message *msg, int incomingInterface)
     {
         //according to rfc 791, the TTL should be decreased at the
         //time of forwarding the packet.
+        ipHeader = (IpHeaderType *) MESSAGE_ReturnWritablePacket(node, msg);
         ipHeader->ip_ttl = (unsigned char) (ipHeader->ip_ttl - IP_TTL_DEC);
         return TRUE;
     }
@@ -2164,9 +2164,14 @@ struct
 }
 NetworkForwardingTableRow;
 
+struct IpPrefixTrieNode;
+
 // /**
 // STRUCT      :: NetworkForwardingTable
-// DESCRIPTION :: Structure of forwarding table.
+// DESCRIPTION :: Structure of forwarding table.  Rows are sorted by
+//                destination address and netmask, both descending, so
+//                that the rows of a prefix are adjacent and come before
+//                those of any shorter prefix that contains it.
 // **/
 typedef
 struct
@@ -2177,9 +2182,42 @@ struct
     D_String *tableStr;
 #endif
     NetworkForwardingTableRow *row;  // allocation in Init function in Ip
+
+    // Prefixes of the rows, for longest prefix match lookups.  Rows
+    // with a non-contiguous netmask are not in the trie; while there
+    // are any, lookups scan the table.
+    IpPrefixTrieNode *prefixTrie;
+    int numIrregularRows;
 }
 NetworkForwardingTable;
 
+// /**
+// ENUM        :: NetworkForwardingTableProtocolMatch
+// DESCRIPTION :: How a forwarding table lookup filters on the routing
+//                protocol of a row
+// **/
+enum NetworkForwardingTableProtocolMatch
+{
+    FORWARDING_TABLE_ANY_PROTOCOL = 0,
+    FORWARDING_TABLE_SAME_PROTOCOL,      // rows of protocolType only
+    FORWARDING_TABLE_OTHER_PROTOCOL      // rows not of protocolType only
+};
+
+// /**
+// STRUCT      :: NetworkForwardingTableFilter
+// DESCRIPTION :: Rows a forwarding table lookup may return.  Set up with
+//                NetworkInitForwardingTableFilter to accept any row.
+// **/
+typedef
+struct
+{
+    int interfaceIndex;              // ANY_INTERFACE for any interface
+    NetworkForwardingTableProtocolMatch protocolMatch;
+    NetworkRoutingProtocolType protocolType;
+    NetworkRoutingAdminDistanceType maxAdminDistance;
+}
+NetworkForwardingTableFilter;
+
 //-----------------------------------------------------------
 // Interface info
 //-----------------------------------------------------------
@@ -4769,6 +4807,38 @@ void NetworkGetInterfaceAndNextHopFromForwardingTable
     NetworkRoutingProtocolType type,
     BOOL* routeType);
 
+// /**
+// API        :: NetworkInitForwardingTableFilter
+// LAYER      :: Network
+// PURPOSE    :: Set up a forwarding table filter that accepts any row
+// PARAMETERS ::
+// + filter    : NetworkForwardingTableFilter* : filter
+// RETURN     :: void :
+// **/
+void NetworkInitForwardingTableFilter(
+    NetworkForwardingTableFilter *filter);
+
+// /**
+// API        :: NetworkLookupForwardingTable
+// LAYER      :: Network
+// PURPOSE    :: Longest prefix match of a destination in the forwarding
+//               table.  Only rows with a reachable next hop on an
+//               enabled interface that pass the filter are considered.
+//               Among the rows of the longest matching prefix the one
+//               with the lowest administrative distance is returned.
+// PARAMETERS ::
+// + node               : Node*       : Pointer to node.
+// + destinationAddress : NodeAddress : Destination IP address.
+// + filter             : const NetworkForwardingTableFilter* : rows to
+//                                      consider, NULL for any row
+// RETURN     :: const NetworkForwardingTableRow* : the route, NULL if
+//                                                  there is none
+// **/
+const NetworkForwardingTableRow*
+NetworkLookupForwardingTable(
+    Node *node,
+    NodeAddress destinationAddress,
+    const NetworkForwardingTableFilter *filter);
 
 // /**
 // API        :: NetworkIpGetInterfaceIndexForNextHop
@@ -4889,6 +4959,23 @@ NetworkRemoveForwardingTableEntry(
     NodeAddress nextHopAddress,
     int outgoingInterfaceIndex);
 
+// /**
+// API        :: NetworkDeleteForwardingTableRow
+// LAYER      :: Network
+// PURPOSE    :: Remove one row of the routing table.  Rows must only be
+//               removed through this function or the other
+//               NetworkRemove/NetworkEmpty functions, which keep the
+//               prefix trie of the table up to date.
+// PARAMETERS ::
+// + node      : Node* : Pointer to node.
+// + rowIndex  : int   : index of the row
+// RETURN     :: void :
+// **/
+void
+NetworkDeleteForwardingTableRow(
+    Node *node,
+    int rowIndex);
+
 // /**
 // API        :: NetworkEmptyForwardingTable
 // LAYER      :: Network
@@ -0,0 +1,226 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api.h"
+#include "network_ip_trie.h"
+
+// Netmask of a prefix length
+static NodeAddress IpPrefixTrieMask(int length)
+{
+    return length == 0 ? 0 : (NodeAddress) (0xFFFFFFFFU << (32 - length));
+}
+
+// Bit of an address at a position, 0 is the most significant bit
+static int IpPrefixTrieBit(NodeAddress address, int position)
+{
+    return (int) ((address >> (31 - position)) & 1);
+}
+
+// Number of leading bits two addresses have in common
+static int IpPrefixTrieCommonLength(NodeAddress a, NodeAddress b)
+{
+    NodeAddress diff = a ^ b;
+    int length = 0;
+
+    while (length < 32 && (diff & 0x80000000U) == 0)
+    {
+        diff <<= 1;
+        length++;
+    }
+    return length;
+}
+
+static IpPrefixTrieNode* IpPrefixTrieNewNode(
+    NodeAddress prefix,
+    int length,
+    int refCount)
+{
+    IpPrefixTrieNode* node =
+        (IpPrefixTrieNode*) MEM_malloc(sizeof(IpPrefixTrieNode));
+
+    node->prefix = prefix;
+    node->length = length;
+    node->refCount = refCount;
+    node->child[0] = NULL;
+    node->child[1] = NULL;
+    return node;
+}
+
+BOOL IpPrefixTrieIsPrefixMask(NodeAddress mask, int* length)
+{
+    NodeAddress hostBits = ~mask;
+
+    // The host bits must be a run of ones at the low end
+    if ((hostBits & (hostBits + 1)) != 0)
+    {
+        return FALSE;
+    }
+
+    *length = IpPrefixTrieCommonLength(mask, 0xFFFFFFFFU);
+    return TRUE;
+}
+
+void IpPrefixTrieInsert(
+    IpPrefixTrieNode** root,
+    NodeAddress prefix,
+    int length)
+{
+    IpPrefixTrieNode** link = root;
+
+    while (*link != NULL)
+    {
+        IpPrefixTrieNode* node = *link;
+        int common = IpPrefixTrieCommonLength(node->prefix, prefix);
+
+        common = MIN(common, MIN(node->length, length));
+
+        if (common == node->length && node->length == length)
+        {
+            node->refCount++;
+            return;
+        }
+
+        if (common == node->length)
+        {
+            // node is a shorter prefix of the new one
+            link = &node->child[IpPrefixTrieBit(prefix, node->length)];
+            continue;
+        }
+
+        if (common == length)
+        {
+            // The new prefix is a shorter prefix of node
+            IpPrefixTrieNode* newNode =
+                IpPrefixTrieNewNode(prefix, length, 1);
+            newNode->child[IpPrefixTrieBit(node->prefix, length)] = node;
+            *link = newNode;
+            return;
+        }
+
+        // The prefixes differ after common bits
+        IpPrefixTrieNode* join = IpPrefixTrieNewNode(
+            prefix & IpPrefixTrieMask(common), common, 0);
+        IpPrefixTrieNode* leaf = IpPrefixTrieNewNode(prefix, length, 1);
+        join->child[IpPrefixTrieBit(prefix, common)] = leaf;
+        join->child[IpPrefixTrieBit(node->prefix, common)] = node;
+        *link = join;
+        return;
+    }
+
+    *link = IpPrefixTrieNewNode(prefix, length, 1);
+}
+
+void IpPrefixTrieRemove(
+    IpPrefixTrieNode** root,
+    NodeAddress prefix,
+    int length)
+{
+    IpPrefixTrieNode** parentLink = NULL;
+    IpPrefixTrieNode** link = root;
+
+    while (*link != NULL)
+    {
+        IpPrefixTrieNode* node = *link;
+
+        if (node->length > length
+            || ((prefix ^ node->prefix) & IpPrefixTrieMask(node->length))
+                != 0)
+        {
+            // Not in the trie
+            return;
+        }
+
+        if (node->length < length)
+        {
+            parentLink = link;
+            link = &node->child[IpPrefixTrieBit(prefix, node->length)];
+            continue;
+        }
+
+        if (node->refCount == 0)
+        {
+            return;
+        }
+        node->refCount--;
+        if (node->refCount > 0 || (node->child[0] && node->child[1]))
+        {
+            return;
+        }
+
+        // Splice the node out
+        *link = node->child[0] ? node->child[0] : node->child[1];
+        MEM_free(node);
+
+        // A joining parent left with one child is not needed anymore
+        if (parentLink != NULL)
+        {
+            IpPrefixTrieNode* parent = *parentLink;
+            if (parent->refCount == 0
+                && (parent->child[0] == NULL || parent->child[1] == NULL))
+            {
+                *parentLink = parent->child[0]
+                              ? parent->child[0] : parent->child[1];
+                MEM_free(parent);
+            }
+        }
+        return;
+    }
+}
+
+int IpPrefixTrieMatch(
+    const IpPrefixTrieNode* root,
+    NodeAddress address,
+    const IpPrefixTrieNode** matches)
+{
+    const IpPrefixTrieNode* node = root;
+    int numMatches = 0;
+
+    while (node != NULL)
+    {
+        if (((address ^ node->prefix) & IpPrefixTrieMask(node->length))
+            != 0)
+        {
+            break;
+        }
+        if (node->refCount > 0)
+        {
+            matches[numMatches++] = node;
+        }
+        if (node->length == 32)
+        {
+            break;
+        }
+        node = node->child[IpPrefixTrieBit(address, node->length)];
+    }
+    return numMatches;
+}
+
+void IpPrefixTrieFree(IpPrefixTrieNode** root)
+{
+    if (*root == NULL)
+    {
+        return;
+    }
+    IpPrefixTrieFree(&(*root)->child[0]);
+    IpPrefixTrieFree(&(*root)->child[1]);
+    MEM_free(*root);
+    *root = NULL;
+}
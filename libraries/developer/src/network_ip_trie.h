@@ -0,0 +1,121 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Path compressed binary trie (Patricia trie) of IPv4 prefixes,
+ *          used to find the prefixes of the forwarding table that match
+ *          a destination without scanning the table.
+ *
+ * The trie only holds the prefixes and the number of forwarding table
+ * rows with each prefix; the rows themselves stay in the table.  A node
+ * either is a prefix of the table (refCount > 0) or joins two subtries
+ * (refCount == 0, two children).
+ */
+
+#ifndef NETWORK_IP_TRIE_H
+#define NETWORK_IP_TRIE_H
+
+// /**
+// CONSTANT    :: IP_PREFIX_TRIE_MAX_MATCHES : 33
+// DESCRIPTION :: Maximum number of prefixes that match one address,
+//                one per prefix length 0 to 32
+// **/
+#define IP_PREFIX_TRIE_MAX_MATCHES  33
+
+// /**
+// STRUCT      :: IpPrefixTrieNode
+// DESCRIPTION :: Node of the prefix trie
+// **/
+struct IpPrefixTrieNode
+{
+    NodeAddress prefix;              // masked to length bits
+    int length;                      // prefix length, 0 to 32
+    int refCount;                    // rows with this prefix
+    IpPrefixTrieNode* child[2];      // by the bit after the prefix
+};
+
+// /**
+// API        :: IpPrefixTrieIsPrefixMask
+// LAYER      :: Network
+// PURPOSE    :: Check that a netmask is contiguous and get its length
+// PARAMETERS ::
+// + mask      : NodeAddress : netmask
+// + length    : int*        : prefix length, if contiguous
+// RETURN     :: BOOL : TRUE if the mask is contiguous
+// **/
+BOOL IpPrefixTrieIsPrefixMask(NodeAddress mask, int* length);
+
+// /**
+// API        :: IpPrefixTrieInsert
+// LAYER      :: Network
+// PURPOSE    :: Add a reference to a prefix, adding the prefix if it is
+//               not in the trie
+// PARAMETERS ::
+// + root      : IpPrefixTrieNode** : root of the trie
+// + prefix    : NodeAddress        : prefix, masked to length bits
+// + length    : int                : prefix length
+// RETURN     :: void :
+// **/
+void IpPrefixTrieInsert(
+    IpPrefixTrieNode** root,
+    NodeAddress prefix,
+    int length);
+
+// /**
+// API        :: IpPrefixTrieRemove
+// LAYER      :: Network
+// PURPOSE    :: Drop a reference to a prefix, removing the prefix when
+//               it has none left
+// PARAMETERS ::
+// + root      : IpPrefixTrieNode** : root of the trie
+// + prefix    : NodeAddress        : prefix, masked to length bits
+// + length    : int                : prefix length
+// RETURN     :: void :
+// **/
+void IpPrefixTrieRemove(
+    IpPrefixTrieNode** root,
+    NodeAddress prefix,
+    int length);
+
+// /**
+// API        :: IpPrefixTrieMatch
+// LAYER      :: Network
+// PURPOSE    :: Find the prefixes that match an address
+// PARAMETERS ::
+// + root      : const IpPrefixTrieNode* : root of the trie
+// + address   : NodeAddress             : address
+// + matches   : const IpPrefixTrieNode** : filled with the matching
+//                                   prefixes, shortest first.  Must hold
+//                                   IP_PREFIX_TRIE_MAX_MATCHES entries.
+// RETURN     :: int : number of matching prefixes
+// **/
+int IpPrefixTrieMatch(
+    const IpPrefixTrieNode* root,
+    NodeAddress address,
+    const IpPrefixTrieNode** matches);
+
+// /**
+// API        :: IpPrefixTrieFree
+// LAYER      :: Network
+// PURPOSE    :: Free all nodes of a trie
+// PARAMETERS ::
+// + root      : IpPrefixTrieNode** : root of the trie, set to NULL
+// RETURN     :: void :
+// **/
+void IpPrefixTrieFree(IpPrefixTrieNode** root);
+
+#endif /* NETWORK_IP_TRIE_H */
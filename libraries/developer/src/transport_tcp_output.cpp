@@ -1018,7 +1018,9 @@ send0:
             (ti + 1), optlen);
 
         // Hack solution for TCP trace.
-        msg->headerSizes[msg->numberOfHeaders] -= sizeof(struct ipovly);
+        msg->headerSizes.set(msg->numberOfHeaders,
+                             msg->headerSizes[msg->numberOfHeaders]
+                             - (int) sizeof(struct ipovly));
         msg->numberOfHeaders++;
 
         // Trace sending packet. We don't trace the IP pseudo header
@@ -1022,17 +1022,7 @@ FxDeleteRouteFromForwardingTable(
 			&& rt->row[i].destAddress == destAddr
 			&& rt->row[i].destAddressMask == destMask)
 		{
-			int j = i + 1;
-
-			// Move all other entries down
-			while (j < rt->size)
-			{
-				rt->row[j - 1] = rt->row[j];
-				j++;
-			}
-
-			// Update forwarding table size.
-			rt->size--;
+			NetworkDeleteForwardingTableRow(node, i);
 		}
 		else
 		{
@@ -1504,6 +1504,60 @@ void SlcFxDeliverPduToSmac(Node * node, int interfaceIndex, const fxRnti& dstRnt
 
 }
 
+// Called by SMAC to find out if a TTI is needed for dstRnti
+BOOL SlcFxHasPduToSend(Node* node, int interfaceIndex, const fxRnti& dstRnti)
+{
+	FxSlcEntity* entity = SlcFxGetSlcEntity(node, interfaceIndex, dstRnti, FX_DEFAULT_BEARER_ID);
+
+	if (entity == NULL || entity->entityType != FX_SLC_ENTITY_AM)
+	{
+		return FALSE;
+	}
+
+	FxSlcAmEntity* amEntity = (FxSlcAmEntity*)entity->entityData;
+	return amEntity->txBuffer.size() > 0
+		|| amEntity->retxBuffer.size() > 0
+		|| amEntity->statusBuffer.size() > 0;
+}
+
+#ifdef FX_SLC_IDLE_TTI_SELF_TEST
+// Self test of MAC-FX-IDLE-TTI-SKIPPING: an idle AM entity whose only
+// pending PDU is a STATUS PDU must still get a TTI.  Called by the SMAC
+// when it is about to go idle.  The STATUS PDU created here is sent like
+// any other status report.
+void SlcFxIdleTtiSelfTest(Node* node, int iface, const fxRnti& dstRnti)
+{
+	FxSmacData* smacData = FxLayer2GetFxSmacData(node, iface);
+	FxSlcEntity* entity = SlcFxGetSlcEntity(node, iface, dstRnti, FX_DEFAULT_BEARER_ID);
+
+	if (entity == NULL || entity->entityType != FX_SLC_ENTITY_AM)
+	{
+		return;
+	}
+
+	FxSlcAmEntity* amEntity = (FxSlcAmEntity*)entity->entityData;
+	if (amEntity->statusProhibitTimerMsg != NULL
+		|| smacData->ttiTimer != NULL
+		|| SlcFxHasPduToSend(node, iface, dstRnti))
+	{
+		return;
+	}
+
+	SlcFxAmCreateStatusPdu(node, iface, amEntity);
+
+	ERROR_Assert(amEntity->txBuffer.empty()
+		&& amEntity->retxBuffer.empty()
+		&& amEntity->statusBuffer.size() == 1,
+		"SlcFxIdleTtiSelfTest: expected only a STATUS PDU");
+	ERROR_Assert(SlcFxHasPduToSend(node, iface, dstRnti),
+		"SlcFxIdleTtiSelfTest: pending STATUS PDU not reported to SMAC");
+	ERROR_Assert(smacData->ttiTimer != NULL
+		&& smacData->ttiTimerTime
+			<= getSimTime(node) + 2 * SMAC_FX_DEFAULT_SLOT_DURATION,
+		"SlcFxIdleTtiSelfTest: no TTI set for a pending STATUS PDU");
+}
+#endif
+
 void SlcFxDeliverPduToSmac(
 	Node* node,
 	int iface,
@@ -1730,6 +1784,8 @@ void FxSlcAmEntity::store(Node* node, int iface, Message* msg)
 
 	txBuffer.push_back(txMsg);
 
+	SmacFxNotifyTtiActivity(node, iface);
+
 
 
 
@@ -2538,6 +2594,7 @@ BOOL FxSlcAmEntity::getTxBuffer(Node* node,
 		retx.store(node, iface, slcHeader, dupMsg);
 		retxBuffer.push_back(retx);
 		retxBufSize += MESSAGE_ReturnPacketSize(dupMsg);
+		SmacFxNotifyTtiActivity(node, iface);
 
 		if (latestPdu.message != NULL)
 		{
@@ -2894,8 +2951,8 @@ BOOL FxSlcAmEntity::divisionMessage(Node* node,
 
 		for (i = 0; i < msg->numberOfHeaders; i++)
 		{
-			fragMsg[0]->headerProtocols[i] = msg->headerProtocols[i];
-			fragMsg[0]->headerSizes[i] = msg->headerSizes[i];
+			fragMsg[0]->headerProtocols.set(i, msg->headerProtocols[i]);
+			fragMsg[0]->headerSizes.set(i, msg->headerSizes[i]);
 		}
 		if (msgFreeFlag)
 		{
@@ -4838,6 +4895,7 @@ void SlcFxAmCreateStatusPdu(
 		amEntity->statusBuffer.push_back(statusPdu);
 		amEntity->statusBufSize +=
 			SlcFxGetExpectedAmStatusPduSize(statusPdu);
+		SmacFxNotifyTtiActivity(node, iface);
 
 
 		// StatusProhibit timer re-start.
@@ -1170,6 +1170,20 @@ void SlcFxDeliverPduToSmac(
 	const fxRnti& dstRnti,
 	std::list<Message*>* sduList,
 	int tbSize);
+BOOL SlcFxHasPduToSend(
+	Node* node,
+	int interfaceIndex,
+	const fxRnti& dstRnti);
+
+// Self test of idle TTI skipping with a pending STATUS PDU, run once by
+// the SMAC of each YH
+//#define FX_SLC_IDLE_TTI_SELF_TEST
+#ifdef FX_SLC_IDLE_TTI_SELF_TEST
+void SlcFxIdleTtiSelfTest(
+	Node* node,
+	int interfaceIndex,
+	const fxRnti& dstRnti);
+#endif
 void SlcFxDeliverPduToSmac(
 	Node* node,
 	int interfaceIndex,
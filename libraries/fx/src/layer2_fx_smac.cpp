@@ -112,11 +112,219 @@ void SmacFxNotifyReceivedRaPreambleAtXG(Node * node, Int32 interfaceIndex, const
 
 
 
+// Index of the first slot starting at or after time, counting the slots
+// of all frames since the start of the simulation.  Slot 0 of frame 0
+// starts after the first inter frame gap.
+static Int64 SmacFxGetNextSlotIndex(clocktype time)
+{
+	if (time <= SMAC_FX_DEFAULT_INTER_FRAME_DURATION)
+	{
+		return 0;
+	}
+
+	clocktype offset = time - SMAC_FX_DEFAULT_INTER_FRAME_DURATION;
+	Int64 frame = offset / SMAC_FX_DEFAULT_FRAME_DURATION;
+	clocktype inFrame = offset % SMAC_FX_DEFAULT_FRAME_DURATION;
+	Int64 slot =
+		(inFrame + SMAC_FX_DEFAULT_SLOT_DURATION - 1) / SMAC_FX_DEFAULT_SLOT_DURATION;
+
+	if (slot >= SMAC_FX_NUM_SLOTS_PER_FRAME)
+	{
+		frame++;
+		slot = 0;
+	}
+
+	return frame * SMAC_FX_NUM_SLOTS_PER_FRAME + slot;
+}
+
+static clocktype SmacFxGetSlotStartTime(Int64 slotIndex)
+{
+	return SMAC_FX_DEFAULT_INTER_FRAME_DURATION
+		+ (slotIndex / SMAC_FX_NUM_SLOTS_PER_FRAME) * SMAC_FX_DEFAULT_FRAME_DURATION
+		+ (slotIndex % SMAC_FX_NUM_SLOTS_PER_FRAME) * SMAC_FX_DEFAULT_SLOT_DURATION;
+}
+
+// A YH transmits earlier by the propagation delay so that its signal
+// reaches the XG at the start of the slot
+static clocktype SmacFxGetTxAdvance(Node* node, Int32 interfaceIndex)
+{
+	if (FxLayer2GetStationType(node, interfaceIndex) == FX_STATION_TYPE_YH)
+	{
+		int phyIndex =
+			FxGetPhyIndexFromMacInterfaceIndex(node, interfaceIndex);
+		return PhyFxGetPropagationDelay(node, phyIndex);
+	}
+	return 0;
+}
+
+static Int64 SmacFxGetNextTtiSlot(Node* node, Int32 interfaceIndex)
+{
+	FxSmacData* smacData = FxLayer2GetFxSmacData(node, interfaceIndex);
+	Int64 slotIndex = SmacFxGetNextSlotIndex(
+		getSimTime(node) + SmacFxGetTxAdvance(node, interfaceIndex) + 1);
+
+	if (slotIndex <= smacData->lastTtiSlot)
+	{
+		slotIndex = smacData->lastTtiSlot + 1;
+	}
+	return slotIndex;
+}
+
+static void SmacFxSetSlotCounters(FxSmacData* smacData, Int64 slotIndex)
+{
+	Int64 frameIndex = slotIndex / SMAC_FX_NUM_SLOTS_PER_FRAME;
+
+	smacData->currentSlotNum =
+		(UInt8)(slotIndex % SMAC_FX_NUM_SLOTS_PER_FRAME);
+	smacData->currentFrameNum =
+		(UInt8)(frameIndex % SMAC_FX_NUM_FRAMES_PER_SUPERFRAME);
+	smacData->currentSuperFrameNum =
+		(UInt16)(frameIndex / SMAC_FX_NUM_FRAMES_PER_SUPERFRAME);
+}
+
+// Set the TTI timer for slotIndex unless a timer for the same or an
+// earlier time is pending
+static void SmacFxScheduleTti(Node* node, Int32 interfaceIndex, Int64 slotIndex)
+{
+	FxSmacData* smacData = FxLayer2GetFxSmacData(node, interfaceIndex);
+	clocktype txTime = SmacFxGetSlotStartTime(slotIndex)
+		- SmacFxGetTxAdvance(node, interfaceIndex);
+
+	if (txTime <= getSimTime(node))
+	{
+		txTime = getSimTime(node) + 1;
+	}
+
+	if (smacData->ttiTimer != NULL)
+	{
+		if (smacData->ttiTimerTime <= txTime)
+		{
+			return;
+		}
+		MESSAGE_CancelSelfMsg(node, smacData->ttiTimer);
+	}
+
+	Message* timerMsg =
+		MESSAGE_Alloc(
+			node, MAC_LAYER, MAC_PROTOCOL_FX, MSG_MAC_FX_TtiTimerExpired);
+	MESSAGE_SetInstanceId(timerMsg, interfaceIndex);
+	MESSAGE_Send(node, timerMsg, txTime - getSimTime(node));
+
+	smacData->ttiTimer = timerMsg;
+	smacData->ttiTimerTime = txTime;
+	smacData->ttiTimerSlot = slotIndex;
+}
+
+// Control information waiting in the PHY or data waiting in the SLC of
+// any schedulable destination
+static BOOL SmacFxHasPendingWork(Node* node, Int32 interfaceIndex)
+{
+	int phyIndex =
+		FxGetPhyIndexFromMacInterfaceIndex(node, interfaceIndex);
+
+	if (PhyFxHasPendingControlInfo(node, phyIndex))
+	{
+		return TRUE;
+	}
+
+	vector<int> beams;
+	Layer3FxGetMultiBeamIndexVec(node, interfaceIndex, beams);
+
+	for (vector<int>::iterator beam = beams.begin(); beam != beams.end(); beam++)
+	{
+		vecFxRnti destList;
+		Layer3FxGetSchedulableListSortedByConnectedTime(node, interfaceIndex,
+			&destList, *beam);
+
+		for (vecFxRnti::iterator dest = destList.begin(); dest != destList.end(); dest++)
+		{
+			if (SlcFxHasPduToSend(node, interfaceIndex, *dest))
+			{
+				return TRUE;
+			}
+		}
+	}
+
+	return FALSE;
+}
+
+// MAC-FX-IDLE-TTI-SKIPPING: set the timer for the next slot with work.
+// An idle XG still wakes up in the slots carrying MIB, an idle YH sleeps
+// until SmacFxNotifyTtiActivity is called.
+static void SmacFxSetNextTtiTimerSkippingIdle(Node* node, Int32 interfaceIndex)
+{
+	FxSmacData* smacData = FxLayer2GetFxSmacData(node, interfaceIndex);
+	FxStationType stationType = FxLayer2GetStationType(node, interfaceIndex);
+	Int64 slotIndex = SmacFxGetNextTtiSlot(node, interfaceIndex);
+
+	smacData->ttiStarted = TRUE;
+
+	if (!SmacFxHasPendingWork(node, interfaceIndex))
+	{
+		if (stationType != FX_STATION_TYPE_XG)
+		{
+#ifdef FX_SLC_IDLE_TTI_SELF_TEST
+			static BOOL selfTestDone = FALSE;
+			if (!selfTestDone)
+			{
+				vector<int> beams;
+				Layer3FxGetMultiBeamIndexVec(node, interfaceIndex, beams);
+				for (vector<int>::iterator beam = beams.begin();
+					beam != beams.end() && !selfTestDone; beam++)
+				{
+					vecFxRnti destList;
+					Layer3FxGetSchedulableListSortedByConnectedTime(
+						node, interfaceIndex, &destList, *beam);
+					if (!destList.empty())
+					{
+						SlcFxIdleTtiSelfTest(
+							node, interfaceIndex, destList.front());
+						selfTestDone = TRUE;
+					}
+				}
+			}
+#endif
+			return;
+		}
+
+		Int64 lastSlot = slotIndex + 2 * SMAC_FX_NUM_SLOTS_PER_FRAME;
+		while (slotIndex < lastSlot &&
+			!PhyFxIsMibSlot(
+				(UInt8)(slotIndex / SMAC_FX_NUM_SLOTS_PER_FRAME % SMAC_FX_NUM_FRAMES_PER_SUPERFRAME),
+				(UInt8)(slotIndex % SMAC_FX_NUM_SLOTS_PER_FRAME)))
+		{
+			slotIndex++;
+		}
+	}
+
+	SmacFxScheduleTti(node, interfaceIndex, slotIndex);
+}
+
+void SmacFxNotifyTtiActivity(Node* node, Int32 interfaceIndex)
+{
+	FxSmacData* smacData = FxLayer2GetFxSmacData(node, interfaceIndex);
+
+	if (!smacData->idleTtiSkipping || !smacData->ttiStarted)
+	{
+		return;
+	}
+
+	SmacFxScheduleTti(
+		node, interfaceIndex, SmacFxGetNextTtiSlot(node, interfaceIndex));
+}
+
+
 void SmacFxSetNextTtiTimer(Node* node, Int32 interfaceIndex)
 {
 
 	FxSmacData* smacData = FxLayer2GetFxSmacData(node, interfaceIndex);
 
+	if (smacData->idleTtiSkipping)
+	{
+		SmacFxSetNextTtiTimerSkippingIdle(node, interfaceIndex);
+		return;
+	}
+
 
 	FxStationType stationType = FxLayer2GetStationType(node, interfaceIndex);
 	clocktype ttiLength = 0;
@@ -174,13 +382,13 @@ void SmacFxSetNextTtiTimer(Node* node, Int32 interfaceIndex)
 
 	// ά֡źʱ϶
 	smacData->currentSlotNum++;
-	if (smacData->currentSlotNum == 32)
+	if (smacData->currentSlotNum == SMAC_FX_NUM_SLOTS_PER_FRAME)
 	{
 		smacData->currentSlotNum = 0;
 		smacData->currentFrameNum++;
 		ttiLength += SMAC_FX_DEFAULT_INTER_FRAME_DURATION;
 
-		if (smacData->currentFrameNum == 10)
+		if (smacData->currentFrameNum == SMAC_FX_NUM_FRAMES_PER_SUPERFRAME)
 		{
 			smacData->currentFrameNum = 0;
 			smacData->currentSuperFrameNum++;
@@ -292,10 +500,48 @@ void SmacFxInit(Node* node,
 
 	smacData->RA_N = 0;
 
+	smacData->idleTtiSkipping = FALSE;
+	smacData->ttiStarted = FALSE;
+	smacData->ttiTimer = NULL;
+	smacData->ttiTimerTime = 0;
+	smacData->ttiTimerSlot = -1;
+	smacData->lastTtiSlot = -1;
+
+	char retChar[MAX_STRING_LENGTH] = { 0 };
+	BOOL wasFound = FALSE;
+
+	NodeAddress interfaceAddress =
+		MAPPING_GetInterfaceAddrForNodeIdAndIntfId(
+			node, node->nodeId, interfaceIndex);
+	IO_ReadString(node->nodeId,
+		interfaceAddress,
+		nodeInput,
+		"MAC-FX-IDLE-TTI-SKIPPING",
+		&wasFound,
+		retChar);
+
+	if (wasFound)
+	{
+		if (strcmp(retChar, "YES") == 0)
+		{
+			smacData->idleTtiSkipping = TRUE;
+		}
+		else if (strcmp(retChar, "NO") != 0)
+		{
+			ERROR_ReportError(
+				"MAC-FX-IDLE-TTI-SKIPPING should be YES or NO.\n");
+		}
+	}
+
 	FxStationType stationType = FxLayer2GetStationType(node, interfaceIndex);
 
 	// ʼʱֻŹվset timer
-	if (stationType == FX_STATION_TYPE_XG)
+	if (stationType == FX_STATION_TYPE_XG && smacData->idleTtiSkipping)
+	{
+		smacData->ttiStarted = TRUE;
+		SmacFxScheduleTti(node, interfaceIndex, 0);
+	}
+	else if (stationType == FX_STATION_TYPE_XG)
 	{
 		Message* timerMsg =
 			MESSAGE_Alloc(
@@ -578,7 +824,15 @@ void SmacFxProcessEvent(Node* node, UInt32 interfaceIndex, Message* msg)
 	case MSG_MAC_FX_TtiTimerExpired:
 	{
 		FxStationType stationType = FxLayer2GetStationType(node, interfaceIndex);
-		
+
+		if (smacData->idleTtiSkipping)
+		{
+			// Cancelled timers are freed by the kernel, so this is the
+			// pending one
+			smacData->ttiTimer = NULL;
+			smacData->lastTtiSlot = smacData->ttiTimerSlot;
+			SmacFxSetSlotCounters(smacData, smacData->lastTtiSlot);
+		}
 
 		switch (stationType)
 		{
@@ -603,6 +857,7 @@ void SmacFxProcessEvent(Node* node, UInt32 interfaceIndex, Message* msg)
 			break;
 		}
 		}
+		MESSAGE_Free(node, msg);
 		break;
 	}
 	case MSG_MAC_FX_RaResponseWaitingTimerExpired:
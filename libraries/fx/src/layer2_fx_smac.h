@@ -12,6 +12,9 @@
 #define SMAC_FX_DEFAULT_RA_BACKOFF_TIME (50*MILLI_SECOND)
 #define SMAC_FX_DEFAULT_RA_PREAMBLE_INITIAL_RECEIVED_TARGET_POWER (-90.0)
 
+#define SMAC_FX_NUM_SLOTS_PER_FRAME (32)
+#define SMAC_FX_NUM_FRAMES_PER_SUPERFRAME (10)
+
 //Gss
 #define SMAC_FX_RRELCIDFL_WITH_15BIT_SUBHEADER_SIZE (3)
 #define SMAC_FX_DEFAULT_F_FIELD (1)
@@ -78,6 +81,16 @@ typedef struct {
 	// Last propagation delay
 	clocktype lastPropDelay;
 
+	// Idle TTI skipping (MAC-FX-IDLE-TTI-SKIPPING)
+	// The slot, frame and superframe numbers are derived from the
+	// simulation time and TTI timers are only set for slots with work
+	BOOL idleTtiSkipping;
+	BOOL ttiStarted;
+	Message* ttiTimer; // pending TTI timer, NULL if none
+	clocktype ttiTimerTime;
+	Int64 ttiTimerSlot;
+	Int64 lastTtiSlot; // index of the last slot handled, -1 if none
+
 	// ˱йز
 	UInt8 RA_B;
 	UInt8 RA_D;
@@ -146,4 +159,8 @@ void SmacFxReceiveTransportBlockFromPhy(
 
 void SmacFxSetNextTtiTimer(Node* node, Int32 interfaceIndex);
 
+// Called when data or control information is waiting to be sent, so
+// that a station skipping idle TTIs handles the next slot
+void SmacFxNotifyTtiActivity(Node* node, Int32 interfaceIndex);
+
 #endif
\ No newline at end of file
@@ -12,6 +12,7 @@
 
 #include "phy_fx.h"
 #include "layer2_fx.h"
+#include "xd_handover_decision.h"
 //gss xd
 #include <fstream>
 #include<iostream>
@@ -125,6 +126,32 @@ BOOL PhySphySetMIBInfoAtXG(Node* node, int phyIndex, Message* msg)
 	return anyMIB;
 }
 
+// Must match the slots used by PhySphySetMIBInfoAtXG
+BOOL PhyFxIsMibSlot(UInt8 frame, UInt8 slot)
+{
+	return (frame % 2 == 0 && (slot == 10 || slot == 11))
+		|| slot == 0 || slot == 16 || slot == 24;
+}
+
+// Whether any control information waits for the next TTI
+BOOL PhyFxHasPendingControlInfo(Node* node, int phyIndex)
+{
+	PhyDataFx* phyFx = (PhyDataFx*)node->phyData[phyIndex]->phyVar;
+
+	if (phyFx->stationType == FX_STATION_TYPE_XG)
+	{
+		return phyFx->raGrants->size() > 0
+			|| phyFx->RRCsetups->size() > 0
+			|| phyFx->rrcReconfs->size() > 0;
+	}
+
+	return phyFx->RAREQcount != -1
+		|| phyFx->randomAccessCompleteFlag
+		|| phyFx->rrcSetupCompleteflag
+		|| phyFx->rrcReconfCompleteFlag
+		|| phyFx->nextBeam->size() > 0;
+}
+
 
 
 
@@ -477,6 +504,7 @@ void PhySphyHandleMessageControlInfo(Node* node,
 
 				// 用户站收到RARSP后开始RRC连接建立
 				phyfx->randomAccessCompleteFlag = TRUE;
+				SmacFxNotifyTtiActivity(node, node->phyData[phyIndex]->macInterfaceIndex);
 
 				// 根据分配的反向信道号设置反向信道TB
 				int BLchannelIndx = raResponse->sub_chl_num;
@@ -535,6 +563,7 @@ void PhySphyHandleMessageControlInfo(Node* node,
 		if (rrcRequest)
 		{
 			phyfx->RRCsetups->insert(fxRnti(rrcRequest->MacAddr, 0));
+			SmacFxNotifyTtiActivity(node, interfaceIndex);
 		}
 
 		// 收到RRCConnectionSetupComplete
@@ -871,9 +900,6 @@ void PhySphyTransmissionEnd(Node *node, int phyIndex)
 	// 暂无处理
 }
 
-//gss 
-Int64  Temp_fx_rxpower::temp_time[10][2];
-double Temp_fx_rxpower::FXRSS[10][2];
 void PhySphySignalArrivalFromChannel(
 	Node* node,
 	int phyIndex,
@@ -992,16 +1018,9 @@ void PhySphySignalArrivalFromChannel(
 	//	= (double)IN_DB(rxPowerInOmnimW *pow(10.0,12));  //转换成dbm
 
 	//gss xd 记录FX的接收机功率 即RSS，该值跟YH与卫星的位置有关
-	if (phy_sphy->stationType == FX_STATION_TYPE_YH && node->nodeId == 2) {
-		if ((getSimTime(node) - Temp_fx_rxpower::temp_time[node->nodeId - 1][1]) >= SECOND)
-		{
-			Temp_fx_rxpower::FXRSS[node->nodeId - 1][1] = rxPowerInOmnidBm;
-			Temp_fx_rxpower::temp_time[node->nodeId - 1][1] = getSimTime(node);
-			double time = getSimTime(node) / SECOND;
-			/*ofstream outfile("FX_RSS.txt", ofstream::app);
-			outfile  << rxPowerInOmnidBm << endl;
-			outfile.close();*/
-		}
+	if (phy_sphy->stationType == FX_STATION_TYPE_YH
+		&& XdHandoverIsDualModeUe(node->nodeId)) {
+		XdHandoverReportRss(node->nodeId, XD_NETWORK_FX, rxPowerInOmnidBm);
 	}
 		
 	
@@ -1230,6 +1249,7 @@ void PhyFxSetRAREQcount(Node* node, const int phyIndex, UInt8 V)
 	PhyDataFx* phyFx = (PhyDataFx*)node->phyData[phyIndex]->phyVar;
 
 	phyFx->RAREQcount = V;
+	SmacFxNotifyTtiActivity(node, node->phyData[phyIndex]->macInterfaceIndex);
 }
 
 
@@ -1240,6 +1260,7 @@ void PhyFxRaGrantTransmissionIndicationAtXG(Node * node, int phyIndex, fxRnti ue
 	PhyDataFx* phyFx = (PhyDataFx*)thisPhy->phyVar;
 
 	phyFx->raGrants->insert(ueRnti);
+	SmacFxNotifyTtiActivity(node, node->phyData[phyIndex]->macInterfaceIndex);
 
 }
 
@@ -1249,6 +1270,7 @@ void PhyFxRrcConnectedNotification(Node * node, int phyIndex)
 	PhyDataFx* phyFx = (PhyDataFx*)thisPhy->phyVar;
 
 	phyFx->rrcSetupCompleteflag = TRUE;
+	SmacFxNotifyTtiActivity(node, node->phyData[phyIndex]->macInterfaceIndex);
 }
 
 void PhyFxRrcHandoverRequestNotificationAtYH(Node * node, int phyIndex, UInt8 nextBeamIndex)
@@ -1257,6 +1279,7 @@ void PhyFxRrcHandoverRequestNotificationAtYH(Node * node, int phyIndex, UInt8 ne
 	PhyDataFx* phyFx = (PhyDataFx*)thisPhy->phyVar;
 
 	phyFx->nextBeam->insert(nextBeamIndex);
+	SmacFxNotifyTtiActivity(node, node->phyData[phyIndex]->macInterfaceIndex);
 }
 
 void PhyFxRrcReconfCompleteNotificationAtYH(Node * node, int phyIndex)
@@ -1265,6 +1288,7 @@ void PhyFxRrcReconfCompleteNotificationAtYH(Node * node, int phyIndex)
 	PhyDataFx* phyFx = (PhyDataFx*)thisPhy->phyVar;
 
 	phyFx->rrcReconfCompleteFlag = TRUE;
+	SmacFxNotifyTtiActivity(node, node->phyData[phyIndex]->macInterfaceIndex);
 }
 
 
@@ -1274,6 +1298,7 @@ void PhyFxRrcConnectionReconfIndicationAtXG(Node * node, int phyIndex, UInt8 yhN
 	PhyDataFx* phyFx = (PhyDataFx*)thisPhy->phyVar;
 
 	phyFx->rrcReconfs->insert(make_pair(yhNodeId, beam));
+	SmacFxNotifyTtiActivity(node, node->phyData[phyIndex]->macInterfaceIndex);
 }
 
 
@@ -12,15 +12,6 @@
 #define SPHY_FX_TRANSBLOCK_SIZE_5MHZ_BYTE (1792)
 #define SPHY_FX_TRANSBLOCK_SIZE_2500KHZ_BYTE (896)
 
-//gss
-class Temp_fx_rxpower
-{
-public:
-	static double FXRSS[10][2];
-	static Int64  temp_time[10][2];
-protected:
-private:
-};
 
 typedef enum {
 	PHY_FX_POWER_OFF,
@@ -250,6 +241,10 @@ void PhyFxRrcConnectionReconfIndicationAtXG(Node * node, int phyIndex, UInt8 yhN
 
 void PhyFxRrcReconfCompleteNotificationAtYH(Node * node, int phyIndex);
 
+BOOL PhyFxIsMibSlot(UInt8 frame, UInt8 slot);
+
+BOOL PhyFxHasPendingControlInfo(Node* node, int phyIndex);
+
 // /**
 // STRUCT     :: PhyFxSrsInfo
 // DESCRIPTION:: SRS Information
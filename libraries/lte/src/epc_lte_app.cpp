@@ -9,6 +9,7 @@
 //gss xd
 #include "epc_fx_app.h"
 #include "network_ip.h"
+#include "xd_handover_decision.h"
 
 // /**
 // FUNCTION   :: EpcLteAppProcessEvent
@@ -951,6 +952,7 @@ void XdUpadateUeRoute(Node* node, int interfaceIndex) {
 		nextHop = 3187672066;
 		outgoingInterfaceIndex = 0;
 		NodeLinkStation::NodeLinkdirection[node->nodeId - 1] = 1;
+		XdHandoverSetUeNetwork(node->nodeId, XD_NETWORK_FX);
 	}
 	//(stationType == LTE_STATION_TYPE_UE) &&
 	//else if ((node->nodeId == 2) &&
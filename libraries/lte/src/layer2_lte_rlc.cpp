@@ -19,6 +19,7 @@
 
 #include "layer2_lte.h"
 #include "layer2_lte_rlc.h"
+#include "timer_manager.h"
 
 #ifdef LTE_LIB_LOG
 #include "log_lte.h"
@@ -1809,6 +1810,47 @@ Message* LteRlcInitTimer(Node* node,
     return timerMsg;
 }
 
+// /**
+// FUNCTION   :: LteRlcStartTimer
+// LAYER      :: LTE LAYER2 RLC
+// PURPOSE    :: Start a timer allocated by LteRlcInitTimer.
+//               The RLC timers of an interface go through one
+//               TimerManager, so only the earliest of them sits on the
+//               main event heap.
+// PARAMETERS ::
+//  + node     : Node*     : Pointer to node
+//  + iface    : int       : the interface index
+//  + timerMsg : Message*  : the timer message
+//  + delay    : clocktype : delay until the timer expires
+// RETURN     :: void : NULL
+// **/
+static
+void LteRlcStartTimer(Node* node,
+                      int iface,
+                      Message* timerMsg,
+                      clocktype delay)
+{
+    LteRlcGetSubLayerData(node, iface)->timerManager->schedule(timerMsg,
+                                                               delay);
+}
+
+// /**
+// FUNCTION   :: LteRlcCancelTimer
+// LAYER      :: LTE LAYER2 RLC
+// PURPOSE    :: Cancel a timer started by LteRlcStartTimer.
+//               The message stays valid until its expiry time.
+// PARAMETERS ::
+//  + node     : Node*    : Pointer to node
+//  + timerMsg : Message* : the timer message
+// RETURN     :: void : NULL
+// **/
+static
+void LteRlcCancelTimer(Node* node, Message* timerMsg)
+{
+    LteRlcGetSubLayerData(node, MESSAGE_GetInstanceId(timerMsg))
+        ->timerManager->cancel(timerMsg);
+}
+
 // /**
 // FUNCTION::           LteRlcAmInitPollRetrunsmitTimer
 // LAYER::              LTE LAYER2 RLC
@@ -1827,7 +1869,7 @@ void LteRlcAmInitPollRetrunsmitTimer(Node* node,
     LteRlcEntity* rlcEntity = (LteRlcEntity*)(amEntity->entityVar);
     if (amEntity->pollRetransmitTimerMsg)
     {
-        MESSAGE_CancelSelfMsg(node, amEntity->pollRetransmitTimerMsg);
+        LteRlcCancelTimer(node, amEntity->pollRetransmitTimerMsg);
         amEntity->pollRetransmitTimerMsg = NULL;
     }
     amEntity->pollRetransmitTimerMsg =
@@ -1838,10 +1880,11 @@ void LteRlcAmInitPollRetrunsmitTimer(Node* node,
                         rlcEntity->bearerId,
                         LTE_RLC_ENTITY_TX);
     amEntity->exprioryTPollRetransmitFlg = FALSE;
-    MESSAGE_Send(node,
-                 amEntity->pollRetransmitTimerMsg,
-                 GetLteRlcConfig(node, iface)->tPollRetransmit *
-                    MILLI_SECOND);
+    LteRlcStartTimer(node,
+                     iface,
+                     amEntity->pollRetransmitTimerMsg,
+                     GetLteRlcConfig(node, iface)->tPollRetransmit *
+                        MILLI_SECOND);
 #ifdef LTE_LIB_LOG
     {
         std::stringstream log;
@@ -1878,7 +1921,7 @@ void LteRlcAmInitReoderingTimer(Node* node,
     LteRlcEntity* rlcEntity = (LteRlcEntity*)(amEntity->entityVar);
     if (amEntity->reoderingTimerMsg)
     {
-        MESSAGE_CancelSelfMsg(node, amEntity->reoderingTimerMsg);
+        LteRlcCancelTimer(node, amEntity->reoderingTimerMsg);
         amEntity->reoderingTimerMsg = NULL;
     }
     amEntity->reoderingTimerMsg =
@@ -1888,9 +1931,11 @@ void LteRlcAmInitReoderingTimer(Node* node,
                         rlcEntity->oppositeRnti,
                         rlcEntity->bearerId,
                         LTE_RLC_ENTITY_RX);
-    MESSAGE_Send(node,
-                 amEntity->reoderingTimerMsg,
-                 GetLteRlcConfig(node, iface)->tReordering * MILLI_SECOND);
+    LteRlcStartTimer(node,
+                     iface,
+                     amEntity->reoderingTimerMsg,
+                     GetLteRlcConfig(node, iface)->tReordering *
+                        MILLI_SECOND);
 #ifdef LTE_LIB_LOG
     {
         std::stringstream log;
@@ -1927,7 +1972,7 @@ void LteRlcAmInitStatusProhibitTimer(Node* node,
     LteRlcEntity* rlcEntity = (LteRlcEntity*)(amEntity->entityVar);
     if (amEntity->statusProhibitTimerMsg)
     {
-        MESSAGE_CancelSelfMsg(node, amEntity->statusProhibitTimerMsg);
+        LteRlcCancelTimer(node, amEntity->statusProhibitTimerMsg);
         amEntity->statusProhibitTimerMsg = NULL;
     }
     amEntity->statusProhibitTimerMsg =
@@ -1938,10 +1983,11 @@ void LteRlcAmInitStatusProhibitTimer(Node* node,
                         rlcEntity->bearerId,
                         LTE_RLC_ENTITY_RX);
     amEntity->waitExprioryTStatusProhibitFlg = FALSE;
-    MESSAGE_Send(node,
-                 amEntity->statusProhibitTimerMsg,
-                 GetLteRlcConfig(node, iface)->tStatusProhibit *
-                    MILLI_SECOND);
+    LteRlcStartTimer(node,
+                     iface,
+                     amEntity->statusProhibitTimerMsg,
+                     GetLteRlcConfig(node, iface)->tStatusProhibit *
+                        MILLI_SECOND);
 #ifdef LTE_LIB_LOG
     {
         std::stringstream log;
@@ -1983,7 +2029,7 @@ void LteRlcAmInitResetTimer(Node* node,
     LteRlcEntity* rlcEntity = (LteRlcEntity*)(amEntity->entityVar);
     if (amEntity->resetTimerMsg)
     {
-        MESSAGE_CancelSelfMsg(node, amEntity->resetTimerMsg);
+        LteRlcCancelTimer(node, amEntity->resetTimerMsg);
         amEntity->resetTimerMsg = NULL;
     }
     amEntity->resetTimerMsg =
@@ -1997,9 +2043,10 @@ void LteRlcAmInitResetTimer(Node* node,
         ? LTE_RLC_RESET_TIMER_DELAY_MSEC * MILLI_SECOND
         : (LTE_RLC_RESET_TIMER_DELAY_MSEC - 1) * MILLI_SECOND;
 
-    MESSAGE_Send(node,
-                 amEntity->resetTimerMsg,
-                 delay);
+    LteRlcStartTimer(node,
+                     iface,
+                     amEntity->resetTimerMsg,
+                     delay);
 #ifdef LTE_LIB_LOG
     {
         std::stringstream log;
@@ -3511,7 +3558,7 @@ void LteRlcAmEntity::polling(Node* node,
         resetExpriory_t_PollRetransmit();
         if (pollRetransmitTimerMsg != NULL)
         {
-            MESSAGE_CancelSelfMsg(node, pollRetransmitTimerMsg);
+            LteRlcCancelTimer(node, pollRetransmitTimerMsg);
             pollRetransmitTimerMsg = NULL;
         }
 
@@ -3603,7 +3650,7 @@ void LteRlcAmEntity::polling(Node* node,
             resetExpriory_t_PollRetransmit();
             if (pollRetransmitTimerMsg != NULL)
             {
-                MESSAGE_CancelSelfMsg(node, pollRetransmitTimerMsg);
+                LteRlcCancelTimer(node, pollRetransmitTimerMsg);
                 pollRetransmitTimerMsg = NULL;
             }
             LteRlcAmInitPollRetrunsmitTimer(node,
@@ -3834,8 +3881,8 @@ BOOL LteRlcAmEntity::divisionMessage(Node* node,
 
         for (i = 0; i < msg->numberOfHeaders; i ++)
         {
-            fragMsg[0]->headerProtocols[i] = msg->headerProtocols[i];
-            fragMsg[0]->headerSizes[i] = msg->headerSizes[i];
+            fragMsg[0]->headerProtocols.set(i, msg->headerProtocols[i]);
+            fragMsg[0]->headerSizes.set(i, msg->headerSizes[i]);
         }
         if (msgFreeFlag)
         {
@@ -5089,7 +5136,7 @@ void LteRlcAmHandleAck(Node* node,
         && ((rxStatusPDU.fixed.ackSn == (Int32)amEntity->pollSn)
             || (nackSnEqPollSn == TRUE)))
     {
-        MESSAGE_CancelSelfMsg(node, amEntity->pollRetransmitTimerMsg);
+        LteRlcCancelTimer(node, amEntity->pollRetransmitTimerMsg);
         amEntity->pollRetransmitTimerMsg = NULL;
     }
 
@@ -5801,7 +5848,7 @@ void LteRlcExtractSduSegmentFromPdu(
                         == FALSE)
                     && (amEntity->tReorderingSn != (Int32)amEntity->rcvWnd)))
             {
-                MESSAGE_CancelSelfMsg(node, amEntity->reoderingTimerMsg);
+                LteRlcCancelTimer(node, amEntity->reoderingTimerMsg);
                 amEntity->reoderingTimerMsg = NULL;
                 amEntity->tReorderingSn = LTE_RLC_INVALID_SEQ_NUM;
             }
@@ -7987,6 +8034,7 @@ void LteRlcInit(Node* node,
     ERROR_Assert(lteRlcData != NULL, "RLC LTE: Out of memory!");
     memset(lteRlcData, 0, sizeof(LteRlcData));
     layer2DataLte->lteRlcVar = lteRlcData;
+    lteRlcData->timerManager = new TimerManager(node);
 
     // init configureble parameters
     LteRlcInitConfigurableParameters(node, iface, nodeInput);
@@ -8013,6 +8061,7 @@ void LteRlcFinalize(Node* node, unsigned int iface)
 
     LteRlcPrintStat(node, (int)iface, lteRlcData);
 
+    delete lteRlcData->timerManager;
     MEM_free(layer2DataLte->lteRlcVar);
     layer2DataLte->lteRlcVar = NULL;
 }
@@ -8765,20 +8814,20 @@ void LteRlcAmEntity::resetAll(BOOL withoutResetProcess)
 
     // reset timer
     if (pollRetransmitTimerMsg != NULL){
-        MESSAGE_CancelSelfMsg(entityVar->node,
-                              pollRetransmitTimerMsg);
+        LteRlcCancelTimer(entityVar->node,
+                          pollRetransmitTimerMsg);
         pollRetransmitTimerMsg = NULL;
     }
 
     if (reoderingTimerMsg != NULL){
-        MESSAGE_CancelSelfMsg(entityVar->node,
-                              reoderingTimerMsg);
+        LteRlcCancelTimer(entityVar->node,
+                          reoderingTimerMsg);
         reoderingTimerMsg = NULL;
     }
 
     if (statusProhibitTimerMsg != NULL){
-        MESSAGE_CancelSelfMsg(entityVar->node,
-                              statusProhibitTimerMsg);
+        LteRlcCancelTimer(entityVar->node,
+                          statusProhibitTimerMsg);
         statusProhibitTimerMsg = NULL;
     }
 
@@ -8809,8 +8858,8 @@ void LteRlcAmEntity::resetAll(BOOL withoutResetProcess)
     if (withoutResetProcess == FALSE)
     {
         if (resetTimerMsg != NULL){
-            MESSAGE_CancelSelfMsg(entityVar->node,
-                                  resetTimerMsg);
+            LteRlcCancelTimer(entityVar->node,
+                              resetTimerMsg);
             resetTimerMsg = NULL;
             resetFlg = FALSE;
             sendResetFlg = FALSE;
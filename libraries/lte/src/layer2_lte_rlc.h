@@ -1080,6 +1080,7 @@ typedef struct
 typedef struct{
     LteRlcStatus status;
     LteRlcStats stats;
+    TimerManager* timerManager; // t-PollRetransmit, t-Reordering, ...
 } LteRlcData;
 
 // /**
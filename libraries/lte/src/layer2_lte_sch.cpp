@@ -17,6 +17,7 @@
 
 #include "layer2_lte_sch.h"
 #include "layer3_lte_filtering.h"
+#include "phy_error_table.h"
 
 #define ENABLE_SCH_IF_CHECKING_LOG 0
 #define LTE_UMTS_RLC_DEF_PDUSIZE 3
@@ -1271,33 +1272,32 @@ int LteSchedulerENB::dlSelectMcs(
     double estimatedSinr_dB,
     double targetBler)
 {
-     // Select the maximum mcs which estimated BLER is
+    // Select the maximum mcs which estimated BLER is
     // greater than or equal to target BLER.
     int mcsIndex;
 
+    // Sinr for determining MCS
+    double estimatedSinrForMcsSelection =
+            NON_DB(estimatedSinr_dB
+                   - MAC_LTE_SNR_OFFSET_FOR_DL_MCS_SELECTION);
+
     for (mcsIndex = PHY_LTE_REGULAR_MCS_INDEX_LEN-1;
         mcsIndex >= 0;
         --mcsIndex){
 
-        // Sinr for determining MCS
-        double estimatedSinrForMcsSelection_dB =
-                estimatedSinr_dB - MAC_LTE_SNR_OFFSET_FOR_DL_MCS_SELECTION;
-
-        // Calculate bit error ratio
-        double ber = PHY_BER(
-            _node->phyData[_phyIndex],
-            mcsIndex,
-            NON_DB(estimatedSinrForMcsSelection_dB));
-
         int transportBlockSize = PhyLteGetDlTxBlockSize(
             _node,
             _phyIndex,
             mcsIndex,
             numResourceBlocks);
 
-
         // Calculate estimated block error rate
-        double bler = 1.0 - pow(1.0 - ber, (double)transportBlockSize);
+        double bler = PHY_ErrorTablePer(
+            PHY_GetErrorTable(
+                _node->phyData[_phyIndex],
+                mcsIndex),
+            estimatedSinrForMcsSelection,
+            (double)transportBlockSize);
 
         if (bler <= targetBler)
         {
@@ -1324,35 +1324,32 @@ int LteSchedulerENB::ulSelectMcs(
     double estimatedSinr_dB,
     double targetBler)
 {
-
     // Select the maximum mcs which estimated BLER is
     // greater than or equal to target BLER.
     int mcsIndex;
 
+    // Sinr for determining MCS
+    double estimatedSinrForMcsSelection =
+            NON_DB(estimatedSinr_dB
+                   - MAC_LTE_SNR_OFFSET_FOR_UL_MCS_SELECTION);
+
     for (mcsIndex = PHY_LTE_REGULAR_MCS_INDEX_LEN-1;
         mcsIndex >= 0;
         --mcsIndex){
 
-        // Sinr for determining MCS
-        double estimatedSinrForMcsSelection_dB =
-                estimatedSinr_dB - MAC_LTE_SNR_OFFSET_FOR_UL_MCS_SELECTION;
-
-        // Calculate bit error ratio
-        double ber = PHY_BER(
-            _node->phyData[_phyIndex],
-            mcsIndex + PHY_LTE_MCS_INDEX_LEN,
-            NON_DB(estimatedSinrForMcsSelection_dB));
-
-        int transportBlockSize;
-
-        transportBlockSize = PhyLteGetUlTxBlockSize(
+        int transportBlockSize = PhyLteGetUlTxBlockSize(
             _node,
             _phyIndex,
             mcsIndex,
             numResourceBlocks);
 
         // Calculate estimated block error rate
-        double bler = 1.0 - pow(1.0 - ber, (double)transportBlockSize);
+        double bler = PHY_ErrorTablePer(
+            PHY_GetErrorTable(
+                _node->phyData[_phyIndex],
+                mcsIndex + PHY_LTE_MCS_INDEX_LEN),
+            estimatedSinrForMcsSelection,
+            (double)transportBlockSize);
 
         if (bler <= targetBler)
         {
@@ -16,6 +16,8 @@
 // software, hardware, product or service.
 
 
+#include <algorithm>
+
 #include "matrix_calc.h"
 
 // /**
@@ -160,3 +162,167 @@ Cmat GetDiagMatrix(double e1, double e2)
     ret[m22] = e2;
     return ret;
 }
+
+// /**
+// FUNCTION   :: GetInvertMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Get inverted matrix, by Gauss-Jordan elimination with
+//               partial pivoting
+// PARAMETERS ::
+// + org : const Cmat4x4& : Matrix to invert
+// RETURN     :: Cmat4x4 : Inverted matrix
+// **/
+Cmat4x4 GetInvertMatrix(const Cmat4x4& org)
+{
+    const int n = 4;
+    Cmat4x4 work = org;
+    Cmat4x4 ret;
+
+    GetDiagMatrix(Dcomp(1.0, 0.0), ret);
+
+    for (int c = 0; c < n; ++c)
+    {
+        int pivot = c;
+        for (int r = c + 1; r < n; ++r)
+        {
+            if (norm(work[r * n + c]) > norm(work[pivot * n + c]))
+            {
+                pivot = r;
+            }
+        }
+
+        assert(work[pivot * n + c] != LTE_DEFAULT_DCOMP);
+
+        if (pivot != c)
+        {
+            for (int k = 0; k < n; ++k)
+            {
+                std::swap(work[c * n + k], work[pivot * n + k]);
+                std::swap(ret[c * n + k], ret[pivot * n + k]);
+            }
+        }
+
+        Dcomp scale = Dcomp(1.0, 0.0) / work[c * n + c];
+        for (int k = 0; k < n; ++k)
+        {
+            work[c * n + k] *= scale;
+            ret[c * n + k] *= scale;
+        }
+
+        for (int r = 0; r < n; ++r)
+        {
+            if (r == c)
+            {
+                continue;
+            }
+            Dcomp factor = work[r * n + c];
+            for (int k = 0; k < n; ++k)
+            {
+                work[r * n + k] -= factor * work[c * n + k];
+                ret[r * n + k] -= factor * ret[c * n + k];
+            }
+        }
+    }
+    return ret;
+}
+
+// /**
+// FUNCTION   :: GetMmseSinrBatch2x2
+// LAYER      :: PHY
+// PURPOSE    :: Get the SINR of the 2 layers of a 2x2 MIMO channel
+//               received with the MMSE weight
+//               W = inv(H~*H~ + rI) H~*, for a batch of noise levels.
+//               The SINR of layer t is
+//               |(WH~)tt|^2 / (|(WH~)t(1-t)|^2 + r (|Wt0|^2 + |Wt1|^2))
+// PARAMETERS ::
+// + matHtilde : const Cmat2x2& : Effective channel matrix H~
+// + r         : const double*  : Noise and interference power divided by
+//                                the tx power, for each element
+// + count     : int            : Number of elements
+// + sinr0     : double*        : SINR of layer 0 of each element
+// + sinr1     : double*        : SINR of layer 1 of each element
+// RETURN     :: void : NULL
+// **/
+void GetMmseSinrBatch2x2(
+    const Cmat2x2& matHtilde,
+    const double* r,
+    int count,
+    double* sinr0,
+    double* sinr1)
+{
+    // H~* and H~*H~ do not depend on r
+    Cmat2x2 matHtildeConjT = GetConjugateTransposeMatrix(matHtilde);
+    Cmat2x2 matHH = MulMatrix(matHtildeConjT, matHtilde);
+
+    const double h11r = matHtilde[m11].real(), h11i = matHtilde[m11].imag();
+    const double h12r = matHtilde[m12].real(), h12i = matHtilde[m12].imag();
+    const double h21r = matHtilde[m21].real(), h21i = matHtilde[m21].imag();
+    const double h22r = matHtilde[m22].real(), h22i = matHtilde[m22].imag();
+
+    const double g11r = matHH[m11].real(), g11i = matHH[m11].imag();
+    const double g12r = matHH[m12].real(), g12i = matHH[m12].imag();
+    const double g21r = matHH[m21].real(), g21i = matHH[m21].imag();
+    const double g22r = matHH[m22].real(), g22i = matHH[m22].imag();
+
+    // H~*
+    const double c11r = h11r, c11i = -h11i;
+    const double c12r = h21r, c12i = -h21i;
+    const double c21r = h12r, c21i = -h12i;
+    const double c22r = h22r, c22i = -h22i;
+
+    for (int i = 0; i < count; ++i)
+    {
+        // M = H~*H~ + rI
+        double a11r = g11r + r[i];
+        double a22r = g22r + r[i];
+
+        // 1 / det(M)
+        double detr = (a11r * a22r - g11i * g22i)
+                      - (g12r * g21r - g12i * g21i);
+        double deti = (a11r * g22i + g11i * a22r)
+                      - (g12r * g21i + g12i * g21r);
+        double detNorm = detr * detr + deti * deti;
+        double idr = detr / detNorm;
+        double idi = -deti / detNorm;
+
+        // inv(M) = [m22 -m12; -m21 m11] / det(M)
+        double v11r = a22r * idr - g22i * idi;
+        double v11i = a22r * idi + g22i * idr;
+        double v12r = -(g12r * idr - g12i * idi);
+        double v12i = -(g12r * idi + g12i * idr);
+        double v21r = -(g21r * idr - g21i * idi);
+        double v21i = -(g21r * idi + g21i * idr);
+        double v22r = a11r * idr - g11i * idi;
+        double v22i = a11r * idi + g11i * idr;
+
+        // W = inv(M) H~*
+        double w11r = (v11r * c11r - v11i * c11i) + (v12r * c21r - v12i * c21i);
+        double w11i = (v11r * c11i + v11i * c11r) + (v12r * c21i + v12i * c21r);
+        double w12r = (v11r * c12r - v11i * c12i) + (v12r * c22r - v12i * c22i);
+        double w12i = (v11r * c12i + v11i * c12r) + (v12r * c22i + v12i * c22r);
+        double w21r = (v21r * c11r - v21i * c11i) + (v22r * c21r - v22i * c21i);
+        double w21i = (v21r * c11i + v21i * c11r) + (v22r * c21i + v22i * c21r);
+        double w22r = (v21r * c12r - v21i * c12i) + (v22r * c22r - v22i * c22i);
+        double w22i = (v21r * c12i + v21i * c12r) + (v22r * c22i + v22i * c22r);
+
+        // WH~
+        double e11r = (w11r * h11r - w11i * h11i) + (w12r * h21r - w12i * h21i);
+        double e11i = (w11r * h11i + w11i * h11r) + (w12r * h21i + w12i * h21r);
+        double e12r = (w11r * h12r - w11i * h12i) + (w12r * h22r - w12i * h22i);
+        double e12i = (w11r * h12i + w11i * h12r) + (w12r * h22i + w12i * h22r);
+        double e21r = (w21r * h11r - w21i * h11i) + (w22r * h21r - w22i * h21i);
+        double e21i = (w21r * h11i + w21i * h11r) + (w22r * h21i + w22i * h21r);
+        double e22r = (w21r * h12r - w21i * h12i) + (w22r * h22r - w22i * h22i);
+        double e22i = (w21r * h12i + w21i * h12r) + (w22r * h22i + w22i * h22r);
+
+        double wNorm0 = (w11r * w11r + w11i * w11i)
+                        + (w12r * w12r + w12i * w12i);
+        double wNorm1 = (w21r * w21r + w21i * w21i)
+                        + (w22r * w22r + w22i * w22i);
+
+        sinr0[i] = (e11r * e11r + e11i * e11i)
+                   / ((e12r * e12r + e12i * e12i) + r[i] * wNorm0);
+        sinr1[i] = (e22r * e22r + e22i * e22i)
+                   / ((e21r * e21r + e21i * e21i) + r[i] * wNorm1);
+    }
+}
@@ -133,5 +133,252 @@ Cmat GetDiagMatrix(const Dcomp& e1, const Dcomp& e2);
 // **/
 Cmat GetDiagMatrix(double e1, double e2);
 
+//--------------------------------------------------------------------------
+//  Fixed size complex matrices
+//
+//  A Cmat allocates its elements on the heap, which dominates the cost of
+//  the 2x2 calculations done for every RB.  FixedCmat keeps the elements
+//  of a NxN matrix on the stack, in the same row major order as Cmat
+//  (see MATRIX_INDEX), and the functions below are the FixedCmat
+//  versions of the Cmat functions above.
+//--------------------------------------------------------------------------
+
+// /**
+// STRUCT      :: FixedCmat
+// DESCRIPTION :: NxN complex matrix of fixed size, in row major order
+// **/
+template <int N>
+struct FixedCmat
+{
+    Dcomp e[N * N];
+
+    Dcomp& operator[](int i) { return e[i]; }
+    const Dcomp& operator[](int i) const { return e[i]; }
+};
+
+typedef FixedCmat < 2 > Cmat2x2;
+typedef FixedCmat < 4 > Cmat4x4;
+
+// /**
+// FUNCTION   :: GetFixedMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Copy a Cmat to a fixed size matrix
+// PARAMETERS ::
+// + org : const Cmat&   : NxN matrix to copy
+// + ret : FixedCmat<N>& : Copied matrix
+// RETURN     :: void : NULL
+// **/
+template <int N>
+inline void GetFixedMatrix(const Cmat& org, FixedCmat < N > & ret)
+{
+    assert(org.size() == N * N);
+
+    for (int i = 0; i < N * N; ++i)
+    {
+        ret.e[i] = org[i];
+    }
+}
+
+// /**
+// FUNCTION   :: GetCmat
+// LAYER      :: PHY
+// PURPOSE    :: Copy a fixed size matrix to a Cmat
+// PARAMETERS ::
+// + org : const FixedCmat<N>& : Matrix to copy
+// RETURN     :: Cmat : Copied matrix
+// **/
+template <int N>
+inline Cmat GetCmat(const FixedCmat < N > & org)
+{
+    return Cmat(org.e, N * N);
+}
+
+// /**
+// FUNCTION   :: GetTransposeMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Get transposed matrix
+// PARAMETERS ::
+// + org : const FixedCmat<N>& : Matrix to transpose
+// RETURN     :: FixedCmat<N> : Transposed matrix
+// **/
+template <int N>
+inline FixedCmat < N > GetTransposeMatrix(const FixedCmat < N > & org)
+{
+    FixedCmat < N > ret;
+    for (int r = 0; r < N; ++r)
+    {
+        for (int c = 0; c < N; ++c)
+        {
+            ret.e[r * N + c] = org.e[c * N + r];
+        }
+    }
+    return ret;
+}
+
+// /**
+// FUNCTION   :: GetConjugateTransposeMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Get Conjugate transposed matrix
+// PARAMETERS ::
+// + org : const FixedCmat<N>& : Matrix to transpose
+// RETURN     :: FixedCmat<N> : Conjugate transposed matrix
+// **/
+template <int N>
+inline FixedCmat < N > GetConjugateTransposeMatrix(
+    const FixedCmat < N > & org)
+{
+    FixedCmat < N > ret;
+    for (int r = 0; r < N; ++r)
+    {
+        for (int c = 0; c < N; ++c)
+        {
+            ret.e[r * N + c] = conj(org.e[c * N + r]);
+        }
+    }
+    return ret;
+}
+
+// /**
+// FUNCTION   :: MulMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Multiply 2 matrices
+// PARAMETERS ::
+// + m1 : const FixedCmat<N>& : Left term matrix
+// + m2 : const FixedCmat<N>& : Right term matrix
+// RETURN     :: FixedCmat<N> : Multiplied matrix
+// **/
+template <int N>
+inline FixedCmat < N > MulMatrix(
+    const FixedCmat < N > & m1,
+    const FixedCmat < N > & m2)
+{
+    FixedCmat < N > ret;
+    for (int r = 0; r < N; ++r)
+    {
+        for (int c = 0; c < N; ++c)
+        {
+            Dcomp sum = m1.e[r * N] * m2.e[c];
+            for (int k = 1; k < N; ++k)
+            {
+                sum += m1.e[r * N + k] * m2.e[k * N + c];
+            }
+            ret.e[r * N + c] = sum;
+        }
+    }
+    return ret;
+}
+
+// /**
+// FUNCTION   :: SumMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Sum 2 matrices
+// PARAMETERS ::
+// + m1 : const FixedCmat<N>& : Left term matrix
+// + m2 : const FixedCmat<N>& : Right term matrix
+// RETURN     :: FixedCmat<N> : Summed matrix
+// **/
+template <int N>
+inline FixedCmat < N > SumMatrix(
+    const FixedCmat < N > & m1,
+    const FixedCmat < N > & m2)
+{
+    FixedCmat < N > ret;
+    for (int i = 0; i < N * N; ++i)
+    {
+        ret.e[i] = m1.e[i] + m2.e[i];
+    }
+    return ret;
+}
+
+// /**
+// FUNCTION   :: GetDiagMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Get diagonal matrix with the same diagonal elements
+// PARAMETERS ::
+// + e   : const Dcomp&  : Diagonal element
+// + ret : FixedCmat<N>& : Diagonal matrix
+// RETURN     :: void : NULL
+// **/
+template <int N>
+inline void GetDiagMatrix(const Dcomp& e, FixedCmat < N > & ret)
+{
+    for (int i = 0; i < N * N; ++i)
+    {
+        ret.e[i] = LTE_DEFAULT_DCOMP;
+    }
+    for (int i = 0; i < N; ++i)
+    {
+        ret.e[i * N + i] = e;
+    }
+}
+
+// /**
+// FUNCTION   :: GetInvertMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Get inverted matrix
+// PARAMETERS ::
+// + org : const Cmat2x2& : Matrix to invert
+// RETURN     :: Cmat2x2 : Inverted matrix
+// **/
+inline Cmat2x2 GetInvertMatrix(const Cmat2x2& org)
+{
+    Dcomp det_err(0.0, 0.0);
+    Dcomp det_org = org[m11] * org[m22] - org[m12] * org[m21];
+
+    assert(det_org != det_err);
+
+    Cmat2x2 ret;
+    ret[m11] = org[m22] / det_org;
+    ret[m12] = (-1.0) * org[m12] / det_org;
+    ret[m21] = (-1.0) * org[m21] / det_org;
+    ret[m22] = org[m11] / det_org;
+    return ret;
+}
+
+// /**
+// FUNCTION   :: GetInvertMatrix
+// LAYER      :: PHY
+// PURPOSE    :: Get inverted matrix, by Gauss-Jordan elimination with
+//               partial pivoting
+// PARAMETERS ::
+// + org : const Cmat4x4& : Matrix to invert
+// RETURN     :: Cmat4x4 : Inverted matrix
+// **/
+Cmat4x4 GetInvertMatrix(const Cmat4x4& org);
+
+//--------------------------------------------------------------------------
+//  Batch kernels
+//
+//  The kernels below compute the same 2x2 calculation for every element
+//  of an array, typically one element per RB.  Operands are passed as
+//  separate arrays of doubles (struct of arrays), so the loops have no
+//  complex arithmetic library calls and no branches and the compiler
+//  vectorizes them.
+//--------------------------------------------------------------------------
+
+// /**
+// FUNCTION   :: GetMmseSinrBatch2x2
+// LAYER      :: PHY
+// PURPOSE    :: Get the SINR of the 2 layers of a 2x2 MIMO channel
+//               received with the MMSE weight
+//               W = inv(H~*H~ + rI) H~*, for a batch of noise levels.
+//               The SINR of layer t is
+//               |(WH~)tt|^2 / (|(WH~)t(1-t)|^2 + r (|Wt0|^2 + |Wt1|^2))
+// PARAMETERS ::
+// + matHtilde : const Cmat2x2& : Effective channel matrix H~
+// + r         : const double*  : Noise and interference power divided by
+//                                the tx power, for each element
+// + count     : int            : Number of elements
+// + sinr0     : double*        : SINR of layer 0 of each element
+// + sinr1     : double*        : SINR of layer 1 of each element
+// RETURN     :: void : NULL
+// **/
+void GetMmseSinrBatch2x2(
+    const Cmat2x2& matHtilde,
+    const double* r,
+    int count,
+    double* sinr0,
+    double* sinr1);
+
 
 #endif /* _MATRIX_CALC_H_ */
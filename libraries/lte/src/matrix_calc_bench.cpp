@@ -0,0 +1,213 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+//
+// Micro-benchmark of the 2x2 MMSE SINR calculation done for every RB of
+// an open loop spatial multiplexing transmission, with
+//   - the Cmat (valarray) functions,
+//   - the Cmat2x2 functions, one RB at a time,
+//   - the GetMmseSinrBatch2x2 kernel, all the RBs at once.
+//
+// Usage: matrix_calc_bench [number of RBs [number of iterations]]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "matrix_calc.h"
+
+#define BENCH_DEFAULT_NUM_RBS       100
+#define BENCH_DEFAULT_NUM_ITERATION 20000
+
+static double BenchRandom()
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+static void MmseSinrCmat(const Cmat& matHtilde,
+                         double r,
+                         double* sinr0,
+                         double* sinr1)
+{
+    Cmat matHtildeConjT = GetConjugateTransposeMatrix(matHtilde);
+    Cmat matR = GetDiagMatrix(r, r);
+    Cmat matW_HHR =
+        SumMatrix(MulMatrix(matHtildeConjT, matHtilde), matR);
+    Cmat matW = MulMatrix(GetInvertMatrix(matW_HHR), matHtildeConjT);
+    Cmat matWHtilde = MulMatrix(matW, matHtilde);
+
+    *sinr0 = norm(matWHtilde[m11])
+             / (norm(matWHtilde[m12])
+                + (norm(matW[m11]) + norm(matW[m12])) * r);
+    *sinr1 = norm(matWHtilde[m22])
+             / (norm(matWHtilde[m21])
+                + (norm(matW[m21]) + norm(matW[m22])) * r);
+}
+
+static void MmseSinrFixed(const Cmat2x2& matHtilde,
+                          double r,
+                          double* sinr0,
+                          double* sinr1)
+{
+    Cmat2x2 matHtildeConjT = GetConjugateTransposeMatrix(matHtilde);
+    Cmat2x2 matR;
+    GetDiagMatrix(Dcomp(r, 0.0), matR);
+    Cmat2x2 matW_HHR =
+        SumMatrix(MulMatrix(matHtildeConjT, matHtilde), matR);
+    Cmat2x2 matW = MulMatrix(GetInvertMatrix(matW_HHR), matHtildeConjT);
+    Cmat2x2 matWHtilde = MulMatrix(matW, matHtilde);
+
+    *sinr0 = norm(matWHtilde[m11])
+             / (norm(matWHtilde[m12])
+                + (norm(matW[m11]) + norm(matW[m12])) * r);
+    *sinr1 = norm(matWHtilde[m22])
+             / (norm(matWHtilde[m21])
+                + (norm(matW[m21]) + norm(matW[m22])) * r);
+}
+
+static double BenchElapsed(clock_t start)
+{
+    return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double BenchMaxRelativeError(double* const ref[2],
+                                    double* const val[2],
+                                    int count)
+{
+    double maxError = 0.0;
+    for (int layer = 0; layer < 2; ++layer)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            double error =
+                fabs(val[layer][i] - ref[layer][i]) / fabs(ref[layer][i]);
+            if (error > maxError)
+            {
+                maxError = error;
+            }
+        }
+    }
+    return maxError;
+}
+
+int main(int argc, char** argv)
+{
+    int numRbs = BENCH_DEFAULT_NUM_RBS;
+    int numIterations = BENCH_DEFAULT_NUM_ITERATION;
+
+    if (argc > 1)
+    {
+        numRbs = atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        numIterations = atoi(argv[2]);
+    }
+    if (numRbs <= 0 || numIterations <= 0)
+    {
+        fprintf(stderr,
+                "Usage: %s [number of RBs [number of iterations]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    srand(1);
+
+    Cmat matHtilde(LTE_DEFAULT_DCOMP, 4);
+    for (int i = 0; i < 4; ++i)
+    {
+        matHtilde[i] = Dcomp(BenchRandom(), BenchRandom()) * 1.0e-4;
+    }
+    Cmat2x2 fixedHtilde;
+    GetFixedMatrix(matHtilde, fixedHtilde);
+
+    double* r = new double[numRbs];
+    double* sinr[3][2];
+    for (int i = 0; i < numRbs; ++i)
+    {
+        // noise and interference 10 to 30 dB below the rx power
+        r[i] = 1.0e-8 * pow(10.0, -1.0 - 2.0 * rand() / RAND_MAX);
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        sinr[k][0] = new double[numRbs];
+        sinr[k][1] = new double[numRbs];
+    }
+
+    double checksum = 0.0;
+    clock_t start = clock();
+    for (int n = 0; n < numIterations; ++n)
+    {
+        for (int i = 0; i < numRbs; ++i)
+        {
+            MmseSinrCmat(matHtilde, r[i], &sinr[0][0][i], &sinr[0][1][i]);
+        }
+        checksum += sinr[0][0][n % numRbs];
+    }
+    double cmatTime = BenchElapsed(start);
+
+    start = clock();
+    for (int n = 0; n < numIterations; ++n)
+    {
+        for (int i = 0; i < numRbs; ++i)
+        {
+            MmseSinrFixed(fixedHtilde, r[i],
+                          &sinr[1][0][i], &sinr[1][1][i]);
+        }
+        checksum += sinr[1][0][n % numRbs];
+    }
+    double fixedTime = BenchElapsed(start);
+
+    start = clock();
+    for (int n = 0; n < numIterations; ++n)
+    {
+        GetMmseSinrBatch2x2(fixedHtilde, r, numRbs,
+                            sinr[2][0], sinr[2][1]);
+        checksum += sinr[2][0][n % numRbs];
+    }
+    double batchTime = BenchElapsed(start);
+
+    double numCalculations = (double) numRbs * numIterations;
+
+    printf("%d RBs x %d iterations (checksum %g)\n",
+           numRbs, numIterations, checksum);
+    printf("%-20s %12s %10s %14s\n",
+           "Kernel", "ns per RB", "Speedup", "Max rel error");
+    printf("%-20s %12.1f %10.2f %14s\n",
+           "Cmat", cmatTime * 1.0e9 / numCalculations, 1.0, "-");
+    printf("%-20s %12.1f %10.2f %14.3g\n",
+           "Cmat2x2",
+           fixedTime * 1.0e9 / numCalculations,
+           cmatTime / fixedTime,
+           BenchMaxRelativeError(sinr[0], sinr[1], numRbs));
+    printf("%-20s %12.1f %10.2f %14.3g\n",
+           "GetMmseSinrBatch2x2",
+           batchTime * 1.0e9 / numCalculations,
+           cmatTime / batchTime,
+           BenchMaxRelativeError(sinr[0], sinr[2], numRbs));
+
+    for (int k = 0; k < 3; ++k)
+    {
+        delete [] sinr[k][0];
+        delete [] sinr[k][1];
+    }
+    delete [] r;
+
+    return 0;
+}
@@ -36,6 +36,7 @@
 #include "phy.h"
 
 #include "phy_lte.h"
+#include "phy_error_table.h"
 #include "phy_lte_establishment.h"
 #include "lte_common.h"
 #include "layer3_lte_filtering.h"
@@ -43,6 +44,7 @@
 #include "epc_lte.h"    //gss xd
 #include "epc_fx_app.h"//gss xd
 #include "network_ip.h" //gss xd
+#include "xd_handover_decision.h" //gss xd
 #include "layer2_fx.h"  //gss
 #include<iostream>
 #include <queue>
@@ -578,17 +580,7 @@ void PhyLteDebugOutputRxMsgInfoList(Node* node,
 #endif
 //gss xd
 static void XdUpadateUeRoute(Node* node, int interfaceIndex, const LteRnti& oppositeRnti);
-static double * XdRssDecision(Node* node);
-static BOOL XdSAWDecision(double simtime);
-//static double * GrayModel(double arr[], int size);  //GM(1,1)
-static double *GrayModel(queue<double> Q, int size);
-static BOOL XdRealTimeSAWDecision();
-static double** multiply(double A[][3], double B[][4], int M, int N, int K);
-static double** multiply(double A[][2], double B[][4], int M, int N, int K);
-static double** Matrix_tran(double **A);
-static double multiply1(double A[1][4], double B[][1], int L);
 												  
-extern deque<APPStatsNew> g_APPStatsNew_deque;   //gss xd
 
 // /**
 // FUNCTION   :: PhyLteCreateRxMsgInfo
@@ -1157,7 +1149,7 @@ BOOL PhyLteCheckRxPacketError(Node* node,
 {
     ERROR_Assert(tbsInfo->isError == FALSE, "TB already has an error.");
 
-    double BER = 0.0;
+    double logNoError = 0.0;
     double PPER = 0.0;
     double partOfPacketSize = 0.0;
     int interfaceIndex =
@@ -1178,7 +1170,9 @@ BOOL PhyLteCheckRxPacketError(Node* node,
         berTableIndex = mcsIndex;
     }
 
-    BER = PHY_BER(phyLte->thisPhy, berTableIndex, sinr);
+    logNoError = PHY_ErrorTableLogNoError(
+                     PHY_GetErrorTable(phyLte->thisPhy, berTableIndex),
+                     sinr);
 
     int txBlockSize = 0;
     // DownLink
@@ -1208,7 +1202,7 @@ BOOL PhyLteCheckRxPacketError(Node* node,
         * ((double)(*(node->currentTime) - tbsInfo->rxTimeEvaluated) /
         (ttiLength - PHY_LTE_SIGNAL_DURATION_REDUCTION));
 
-    PPER = 1.0 - pow((1.0 - BER), partOfPacketSize);
+    PPER = PHY_PacketErrorProbability(logNoError, partOfPacketSize);
 
 #ifdef LTE_LIB_LOG
     LteRnti txRnti(propTxInfo->txNodeId, propTxInfo->phyIndex);
@@ -1252,7 +1246,7 @@ BOOL PhyLteCheckRxPacketError(Node* node,
                             propTxInfo->txNodeId, propTxInfo->phyIndex,
                             IN_DB(sinr),
                             (int)mcsIndex,
-                            BER,
+                            1.0 - exp(logNoError),
                             timeStr,
                             partOfPacketSize,
                             PPER,
@@ -6604,38 +6598,6 @@ BOOL PhyLteCheckRxDisconnected(Node* node,
     }
 }
 
-//gss 
-Int64  Temp_metrics::store_time = 0;
-BOOL Temp_metrics::flag_xd = FALSE;
-BOOL GetXdHandoverDecision(Node* node,double time) {	
-	double curtime = getSimTime(node) / SECOND;
-	double lte_rss = Temp_rxpower::RSS[1][1];
-	double fx_rss = Temp_fx_rxpower::FXRSS[1][1];
-	//BOOL F = Temp_metrics::flag_xd;
-	/**************** RSS algorithm *******************/
-	/*if ((curtime - Temp_metrics::store_time) >= 3 && curtime > 9) {
-		if (lte_rss < fx_rss) {
-			Temp_metrics::flag_xd = TRUE;
-		}
-		else {
-			Temp_metrics::flag_xd = FALSE;
-		}
-		Temp_metrics::store_time = curtime;
-	}*/
-	/**************** SAW algorithm *******************/
-	/*if ((curtime - Temp_metrics::store_time) >= 3 && curtime > 9) {
-		Temp_metrics::flag_xd = XdSAWDecision(curtime);
-		Temp_metrics::store_time = curtime;
-	}*/
-	/**************** Sequential Growth SAW algorithm *******************/
-	if ((curtime - Temp_metrics::store_time) >= 1) {
-		Temp_metrics::flag_xd = XdRealTimeSAWDecision();
-		Temp_metrics::store_time = curtime;
-	}
-	/******************The End ******************/
-	return Temp_metrics::flag_xd;
-}
-
 //hjx
 int NodeLinkStation::NodeLinkdirection[10];
 // /**
@@ -6937,11 +6899,12 @@ BOOL PhyLteGetMessageControlInfo(Node* node,
 			double curtime = getSimTime(node) / SECOND;
 			ofstream ofile;
 			ofile.open("numho.csv", ios::app | ios::out);
-			if (ueNode->nodeId == 2 ) {    //ǵնûŵþߺ
-				BOOL flag = GetXdHandoverDecision(ueNode, curtime);
+			if (XdHandoverIsDualModeUe(ueNode->nodeId)) {    //ǵնûŵþߺ
+				BOOL flag = XdHandoverEvaluate(ueNode->nodeId, getSimTime(node));
+				XdAccessNetwork ueNetwork = XdHandoverGetUeNetwork(ueNode->nodeId);
 				if (flag)
 				{
-					if (NodeLinkStation::NodeLinkdirection[ueRnti.nodeId - 1] == 0)  
+					if (ueNetwork == XD_NETWORK_LTE)  
 					{
 						//ǵлָ  LTEлFX
 						EpcXdAppSend_HandoverRequried(node, interfaceIndex, ueRnti, LteLayer2GetRnti(node, interfaceIndex), ueNode);
@@ -6951,7 +6914,7 @@ BOOL PhyLteGetMessageControlInfo(Node* node,
 
 					}
 				}
-				else if (NodeLinkStation::NodeLinkdirection[ueRnti.nodeId - 1] == 1)
+				else if (ueNetwork == XD_NETWORK_FX)
 				{
 					//ǵлָ  FXлLTE   ʱûд  ֱл
 					//EpcXdAppSend_HandoverRequried(node, interfaceIndex, ueRnti, LteLayer2GetRnti(node, interfaceIndex), ueNode);
@@ -7192,6 +7155,121 @@ void PhyLteGetChannelMatrix(Node* node,
         matHhat);
 }
 
+// /**
+// FUNCTION   :: PhyLteCalculateSinrBatch
+// LAYER      :: PHY
+// PURPOSE    :: Calculate SINR of each transport block for each of
+//               several interference powers, typically one per RB.
+// PARAMETERS ::
+// + node         : Node*         : Pointer to node.
+// + phyIndex     : int           : Index of the PHY
+// + txScheme     : LteTxScheme   : Transmission scheme
+// + phyLte       : PhyDataLte*   : PHY data structure
+// + matHhat      : const Cmat&   : Channel matrix
+// + txPower_mW   : double        : Tx-signal power.
+// + ifPower_mW   : const double* : Interference signal power of each RB
+// + count        : int           : Number of RBs
+// + sinr0        : double*       : SINR of transport block 0 of each RB
+// + sinr1        : double*       : SINR of transport block 1 of each RB,
+//                                  for spatial multiplexing only
+// RETURN     :: void : NULL
+// **/
+static
+void PhyLteCalculateSinrBatch(Node* node,
+                     int phyIndex,
+                     LteTxScheme txScheme,
+                     PhyDataLte* phyLte,
+                     const Cmat& matHhat,
+                     double txPower_mW,
+                     const double* ifPower_mW,
+                     int count,
+                     double* sinr0,
+                     double* sinr1)
+{
+    ERROR_Assert(count <= PHY_LTE_MAX_NUM_RB, "Too many RBs");
+
+    double rbNoisePower_mW = phyLte->rbNoisePower_mW;
+
+    // Single antenna transmission
+    if (txScheme == TX_SCHEME_SINGLE_ANTENNA)
+    {
+        double h0 = norm(matHhat[MATRIX_INDEX(0,0,1)]);
+
+        //SISO
+        for (int i = 0; i < count; ++i)
+        {
+            sinr0[i] = h0
+                * txPower_mW
+                / (rbNoisePower_mW + ifPower_mW[i]);
+        }
+        //ReceveDiversity
+        if (phyLte->numRxAntennas != 1)
+        {
+            double h1 = norm(matHhat[MATRIX_INDEX(1,0,1)]);
+
+            for (int i = 0; i < count; ++i)
+            {
+                sinr0[i] += h1
+                    * txPower_mW
+                    / (rbNoisePower_mW + ifPower_mW[i]);
+            }
+        }
+    }
+    // TxDiversty (SFBC)
+    else if (txScheme == TX_SCHEME_DIVERSITY)
+    {
+        double txPower_mW_per_antenna = txPower_mW / 2.0;
+        double h0 = norm(matHhat[MATRIX_INDEX(0,0,2)])
+                   + norm(matHhat[MATRIX_INDEX(0,1,2)]);
+
+        for (int i = 0; i < count; ++i)
+        {
+            sinr0[i] = h0
+                   * txPower_mW_per_antenna
+                   / (rbNoisePower_mW + ifPower_mW[i]);
+        }
+        if (phyLte->numRxAntennas != 1)
+        {
+            double h1 = norm(matHhat[MATRIX_INDEX(1,0,2)])
+                       + norm(matHhat[MATRIX_INDEX(1,1,2)]);
+
+            for (int i = 0; i < count; ++i)
+            {
+                sinr0[i] += h1
+                       * txPower_mW_per_antenna
+                       / (rbNoisePower_mW + ifPower_mW[i]);
+            }
+        }
+    }
+    // OpenLoopSpatialMultiplexing
+    else //TX_SCHEME_OL_SPATIAL_MULTI
+    {
+        if (phyLte->numRxAntennas == 1)
+        {
+            ERROR_Assert(FALSE, "PHYLTE:numRxAntennas");
+        }
+        else
+        {
+            // P
+            Cmat2x2 matP;
+            GetFixedMatrix(PhyLteGetPrecodingMatrixList(node, phyIndex),
+                           matP);
+            // H~ = H^P
+            Cmat2x2 matH;
+            GetFixedMatrix(matHhat, matH);
+            Cmat2x2 matHtilde = MulMatrix(matH, matP);
+            // R = rI
+            double r[PHY_LTE_MAX_NUM_RB];
+            for (int i = 0; i < count; ++i)
+            {
+                r[i] = (rbNoisePower_mW + ifPower_mW[i]) / txPower_mW;
+            }
+            // W (MMSE weight) = inv(H~*H~ + R) H~*
+            GetMmseSinrBatch2x2(matHtilde, r, count, sinr0, sinr1);
+        }
+    }
+}
+
 // /**
 // FUNCTION   :: PhyLteGetSinr
 // LAYER      :: PHY
@@ -7233,6 +7311,12 @@ std::vector < double > PhyLteCalculateSinr(Node* node,
     int numSinrs = (txScheme == TX_SCHEME_OL_SPATIAL_MULTI ? 2 : 1);
     std::vector < double > sinr(numSinrs, 0.0);
 
+    // Interference power of the used RBs, so that the SINRs of all of
+    // them are calculated at once
+    UInt8 usedRbIndex[PHY_LTE_MAX_NUM_RB];
+    double ifPowers_mW[PHY_LTE_MAX_NUM_RB];
+    double sinrsForRb[2][PHY_LTE_MAX_NUM_RB];
+
     for (UInt8 i = 0; i < phyLte->numResourceBlocks; i++)
     {
         if (usedRB_list[i] != 0)
@@ -7253,57 +7337,63 @@ std::vector < double > PhyLteCalculateSinr(Node* node,
                 ifPower_mW = phyLte->interferencePower_mW[i];
             }
 
-            std::vector < double > sinrForRb = PhyLteCalculateSinr(
-                node, phyIndex,
-                txScheme, phyLte,
-                matHhat, geometry,
-                txPower_mW, ifPower_mW);
-
-#ifdef LTE_LIB_LOG
-            for (int tbIndex = 0; tbIndex < sinrForRb.size(); ++tbIndex){
-                stringstream ss;
-                char buf[MAX_STRING_LENGTH];
-                ss << "isForCqi=," << isForCqi << ","
-                   << "rnti=," << STR_RNTI(buf,txRnti) << ","
-                   << "txScheme=," << LteGetTxSchemeString(txScheme) << ","
-                   << "tbNo=," << (int)(tbIndex) <<","
-                   << "rbNo=," << (int)i << ","
-                   << "Non_dB=," << sinrForRb[tbIndex] << ","
-                   << "dB=," << IN_DB(sinrForRb[tbIndex]) << ","
-                   << "txPower_mW=," << txPower_mW << ","
-                   << "ifPower_mW=," << ifPower_mW << ","
-                   << "rbNoisePower_mW=," << phyLte->rbNoisePower_mW << ","
-                   << "geometry=," << geometry << ","
-                   << "pathloss_dB=," << IN_DB(1.0/geometry) << ","
-                   << "ChRspHat=,";
-
-                for (int mi = 0; mi < matHhat.size(); ++mi)
-                {
-                    char buf[MAX_STRING_LENGTH];
-                    ss << STR_COMPLEX(buf, matHhat[mi]) << ",";
-                }
+            usedRbIndex[numUsedRBs] = i;
+            ifPowers_mW[numUsedRBs] = ifPower_mW;
+            numUsedRBs++;
+        }
+    }
 
-                lte::LteLog::DebugFormat(
-                    node,
-                    node->phyData[phyIndex]->macInterfaceIndex,
-                    LTE_STRING_LAYER_TYPE_PHY,
-                    "%s,%s",
-                    LTE_STRING_CATEGORY_TYPE_RB_SINR,
-                    ss.str().c_str());
-            }
-#endif
+    ERROR_Assert(numUsedRBs > 0,
+                "Number of RBs for SINR calculation is 0.\n");
 
-            for (size_t s = 0; s < sinr.size(); ++s)
+    PhyLteCalculateSinrBatch(
+        node, phyIndex,
+        txScheme, phyLte,
+        matHhat, txPower_mW,
+        ifPowers_mW, numUsedRBs,
+        sinrsForRb[0], sinrsForRb[1]);
+
+    for (int n = 0; n < numUsedRBs; ++n)
+    {
+#ifdef LTE_LIB_LOG
+        for (int tbIndex = 0; tbIndex < numSinrs; ++tbIndex){
+            stringstream ss;
+            char buf[MAX_STRING_LENGTH];
+            ss << "isForCqi=," << isForCqi << ","
+               << "rnti=," << STR_RNTI(buf,txRnti) << ","
+               << "txScheme=," << LteGetTxSchemeString(txScheme) << ","
+               << "tbNo=," << (int)(tbIndex) <<","
+               << "rbNo=," << (int)usedRbIndex[n] << ","
+               << "Non_dB=," << sinrsForRb[tbIndex][n] << ","
+               << "dB=," << IN_DB(sinrsForRb[tbIndex][n]) << ","
+               << "txPower_mW=," << txPower_mW << ","
+               << "ifPower_mW=," << ifPowers_mW[n] << ","
+               << "rbNoisePower_mW=," << phyLte->rbNoisePower_mW << ","
+               << "geometry=," << geometry << ","
+               << "pathloss_dB=," << IN_DB(1.0/geometry) << ","
+               << "ChRspHat=,";
+
+            for (int mi = 0; mi < matHhat.size(); ++mi)
             {
-                sinr[s] += sinrForRb[s];
+                char buf[MAX_STRING_LENGTH];
+                ss << STR_COMPLEX(buf, matHhat[mi]) << ",";
             }
 
-            numUsedRBs++;
+            lte::LteLog::DebugFormat(
+                node,
+                node->phyData[phyIndex]->macInterfaceIndex,
+                LTE_STRING_LAYER_TYPE_PHY,
+                "%s,%s",
+                LTE_STRING_CATEGORY_TYPE_RB_SINR,
+                ss.str().c_str());
         }
-    }
+#endif
 
-    ERROR_Assert(numUsedRBs > 0,
-                "Number of RBs for SINR calculation is 0.\n");
+        for (int s = 0; s < numSinrs; ++s)
+        {
+            sinr[s] += sinrsForRb[s][n];
+        }
+    }
 
     for (size_t s = 0; s < sinr.size(); ++s)
     {
@@ -7338,117 +7428,16 @@ std::vector < double > PhyLteCalculateSinr(Node* node,
                      double ifPower_mW)
 {
     int numSinrs = (txScheme == TX_SCHEME_OL_SPATIAL_MULTI ? 2 : 1);
-    std::vector < double > sinr(numSinrs, 0.0);
+    double sinrs[2] = {0.0, 0.0};
 
-    // Single antenna transmission
-    if (txScheme == TX_SCHEME_SINGLE_ANTENNA)
-    {
-        //SISO
-        if (phyLte->numRxAntennas == 1)
-        {
-            sinr[0] = norm(matHhat[MATRIX_INDEX(0,0,1)])
-                * txPower_mW
-                / (phyLte->rbNoisePower_mW + ifPower_mW);
-        }
-        //ReceveDiversity
-        else
-        {
-            sinr[0]  = norm(matHhat[MATRIX_INDEX(0,0,1)])
-                   * txPower_mW
-                   / (phyLte->rbNoisePower_mW + ifPower_mW);
-            sinr[0] += norm(matHhat[MATRIX_INDEX(1,0,1)])
-                    * txPower_mW
-                    / (phyLte->rbNoisePower_mW + ifPower_mW);
-        }
-    }
-    // TxDiversty (SFBC)
-    else if (txScheme == TX_SCHEME_DIVERSITY)
-    {
-        double txPower_mW_per_antenna = txPower_mW / 2.0;
-
-        if (phyLte->numRxAntennas == 1)
-        {
-            sinr[0] = (norm(matHhat[MATRIX_INDEX(0,0,2)])
-                   + norm(matHhat[MATRIX_INDEX(0,1,2)]))
-                   * txPower_mW_per_antenna
-                   / (phyLte->rbNoisePower_mW + ifPower_mW);
-        }
-        else
-        {
-            sinr[0] = (norm(matHhat[MATRIX_INDEX(0,0,2)])
-                   + norm(matHhat[MATRIX_INDEX(0,1,2)]))
-                   * txPower_mW_per_antenna
-                   / (phyLte->rbNoisePower_mW + ifPower_mW);
-            sinr[0] += (norm(matHhat[MATRIX_INDEX(1,0,2)])
-                   + norm(matHhat[MATRIX_INDEX(1,1,2)]))
-                   * txPower_mW_per_antenna
-                   / (phyLte->rbNoisePower_mW + ifPower_mW);
-        }
-    }
-    // OpenLoopSpatialMultiplexing
-    else //TX_SCHEME_OL_SPATIAL_MULTI
-    {
-        if (phyLte->numRxAntennas == 1)
-        {
-            ERROR_Assert(FALSE, "PHYLTE:numRxAntennas");
-        }
-        else
-        {
-            // P
-            Cmat matP(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matP = PhyLteGetPrecodingMatrixList(node, phyIndex);
-            // H~ = H^P
-            Cmat matHtilde(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matHtilde = MulMatrix(matHhat, matP);
-            // H~*
-            Cmat matHtildeConjT(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matHtildeConjT = GetConjugateTransposeMatrix(matHtilde);
-            // R
-            double r_real =
-                (phyLte->rbNoisePower_mW + ifPower_mW) / txPower_mW;
-            Dcomp r_elm(r_real, 0);
-            Cmat matR(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matR = GetDiagMatrix(r_elm, r_elm);
-            // W (MMSE weight) = inv(H~*H~ + R) H~*
-            Cmat matW_HH(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matW_HH = MulMatrix(matHtildeConjT, matHtilde);
-            Cmat matW_HHR(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matW_HHR = SumMatrix(matW_HH, matR);
-            Cmat matW_HHRinv(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matW_HHRinv = GetInvertMatrix(matW_HHR);
-            Cmat matW(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matW = MulMatrix(matW_HHRinv, matHtildeConjT);
-            // WH~
-            Cmat matWHtilde(LTE_DEFAULT_DCOMP,4); // as 2x2 matrix
-            matWHtilde = MulMatrix(matW, matHtilde);
-
-            double Psignal = 0.0;
-            double Pself = 0.0;
-            double Pnoise = 0.0;
-
-            for (int tbIndex = 0; tbIndex < 2; ++tbIndex)
-            {
-                // Psignal
-                Psignal = norm(matWHtilde[MATRIX_INDEX(tbIndex,tbIndex,2)])
-                    * txPower_mW;
-
-                // Pself
-                Pself =
-                    norm(matWHtilde[MATRIX_INDEX(tbIndex, 1 - tbIndex, 2)])
-                    * txPower_mW;
-
-                // Pnoise
-                Pnoise = norm(matW[MATRIX_INDEX(tbIndex,0,2)])
-                    * (phyLte->rbNoisePower_mW + ifPower_mW)
-                    + norm(matW[MATRIX_INDEX(tbIndex,1,2)])
-                    * (phyLte->rbNoisePower_mW + ifPower_mW);
-
-                sinr[tbIndex] = Psignal / (Pself + Pnoise);
-            }
-        }
-    }
+    PhyLteCalculateSinrBatch(
+        node, phyIndex,
+        txScheme, phyLte,
+        matHhat, txPower_mW,
+        &ifPower_mW, 1,
+        &sinrs[0], &sinrs[1]);
 
-    return sinr;
+    return std::vector < double > (sinrs, sinrs + numSinrs);
 }
 
 // /**
@@ -7811,6 +7800,9 @@ void PhyLteInit(Node* node,
     // Initialize the antenna model
     ANTENNA_Init(node, phyIndex, nodeInput);
 
+    //gss xd
+    XdHandoverInit(nodeInput);
+
     // initialize parameters
     PhyLteInitConfigurableParameters(node, phyIndex, nodeInput);
     if (phyLte->stationType == LTE_STATION_TYPE_ENB)
@@ -8595,9 +8587,6 @@ LteTxScheme PhyLteJudgeTxScheme(Node* node,
 // **/
 
 
-//hjx
-Int64  Temp_rxpower::temp_time[10][2];
-double Temp_rxpower::RSS[10][2];
 void PhyLteSignalArrivalFromChannel(Node* node,
                                     int phyIndex,
                                     int channelIndex,
@@ -8699,17 +8688,10 @@ void PhyLteSignalArrivalFromChannel(Node* node,
 	//double lte_rxPower_dBm = (double)IN_DB(lte_rxPower_mW*pow(10.0, 12));  //תdbm
 		                                                       
 	// add hjx	
-	if (phyLte->stationType == LTE_STATION_TYPE_UE && node->nodeId == 2)
+	if (phyLte->stationType == LTE_STATION_TYPE_UE
+		&& XdHandoverIsDualModeUe(node->nodeId))
 	{
-		if ((getSimTime(node) - Temp_rxpower::temp_time[node->nodeId - 1][1]) >= SECOND)
-		{
-			Temp_rxpower::RSS[node->nodeId - 1][1] = lte_rxPower_dBm;
-			Temp_rxpower::temp_time[node->nodeId - 1][1] = getSimTime(node);
-			double time = getSimTime(node) / SECOND;
-			/*ofstream outfile("LTE_RSS.txt", ofstream::app);
-			outfile << lte_rxPower_dBm << endl;
-			outfile.close();*/
-		}
+		XdHandoverReportRss(node->nodeId, XD_NETWORK_LTE, lte_rxPower_dBm);
 	}
 
     // Process control messages
@@ -12415,6 +12397,7 @@ static void XdUpadateUeRoute(Node* node, int interfaceIndex, const LteRnti& oppo
 	    nextHop = 3187672834;  //еFX
 		outgoingInterfaceIndex = 1;
 		NodeLinkStation::NodeLinkdirection[node->nodeId - 1] = 0;
+		XdHandoverSetUeNetwork(node->nodeId, XD_NETWORK_LTE);
 	}
 	NetworkRoutingProtocolType type = ROUTING_PROTOCOL_STATIC;
 	int cost = 0;
@@ -12428,960 +12411,3 @@ static void XdUpadateUeRoute(Node* node, int interfaceIndex, const LteRnti& oppo
 		cost,
 		type);
 }
-
-//gss rss
-static double * XdRssDecision(Node *node) {
-	if (node->nodeId == 2) {
-		double curtime = getSimTime(node) / SECOND;
-		double lte_rss = Temp_rxpower::RSS[1][1];
-		double fx_rss = Temp_fx_rxpower::FXRSS[1][1];
-		double arr[3] = { curtime,lte_rss, fx_rss };
-		return arr;
-	}	
-}
-
-
-//double Temp_metrics::delay_lte[12];
-//double Temp_metrics::delay_fx[12];
-//double Temp_metrics::jet_lte[12];
-//double Temp_metrics::jet_fx[12];
-//int Temp_metrics::index = 0;
-int Temp_metrics::sizeps = 0;
-queue<double> delay_lte;
-queue<double> delay_fx;
-queue<double> jet_lte;
-queue<double> jet_fx;
-queue<double> rss_lte;
-queue<double> rss_fx;
-queue<double> thr_lte;
-queue<double> thr_fx;
-
-static BOOL XdSAWDecision(double simtime) {
-	
-	deque<APPStatsNew>::iterator it = g_APPStatsNew_deque.begin();
-	double M[2][2] = { 0.0 };
-	double maxdelay_lte = 0.0;  double maxjet_lte = 0.0; double th_lte = 0.0;
-	double maxdelay_fx  = 0.0;  double maxjet_fx  = 0.0; double th_fx  = 0.0;  
-	double lte_rss = 0.0;
-	double fx_rss = 0.0;
-	char* servicetype = "";
-	int session = 0;
-	for (int i = Temp_metrics::sizeps; i < g_APPStatsNew_deque.size(); i++) {
-		if (g_APPStatsNew_deque[i].simTime == simtime) {
-			if (g_APPStatsNew_deque[i].DestId == 10 || (g_APPStatsNew_deque[i].DestId == 9 && NodeLinkStation::NodeLinkdirection[1] == 0)
-				|| (g_APPStatsNew_deque[i].DestId == 8 && NodeLinkStation::NodeLinkdirection[1] == 0)) {
-				th_lte = th_lte + g_APPStatsNew_deque[i].AppThroughput; //ȡLTEÿ
-				if (maxdelay_lte < g_APPStatsNew_deque[i].AppDelay) {
-					maxdelay_lte = g_APPStatsNew_deque[i].AppDelay;  //ȡLTEʱӡʱӶֵ
-				}
-				if (maxjet_lte < g_APPStatsNew_deque[i].AppJet) {
-					maxjet_lte = g_APPStatsNew_deque[i].AppJet;
-				}
-			}
-			else if (g_APPStatsNew_deque[i].DestId == 4 || (g_APPStatsNew_deque[i].DestId == 9 && NodeLinkStation::NodeLinkdirection[1] == 1
-				|| (g_APPStatsNew_deque[i].DestId == 8 && NodeLinkStation::NodeLinkdirection[1] == 0))) {
-				th_fx = th_fx + g_APPStatsNew_deque[i].AppThroughput;   //ȡFXÿ
-				if (maxdelay_fx < g_APPStatsNew_deque[i].AppDelay) {   //ȡFXÿʱӡʱӶֵ
-					maxdelay_fx = g_APPStatsNew_deque[i].AppDelay;
-				}
-				if (maxjet_fx < g_APPStatsNew_deque[i].AppJet) {
-					maxjet_fx = g_APPStatsNew_deque[i].AppJet;
-				}
-			}
-
-			if (g_APPStatsNew_deque[i].DestId == 9) {
-				servicetype = g_APPStatsNew_deque[i].Servicetype;
-				session = g_APPStatsNew_deque[i].DestId;
-			}
-			if (g_APPStatsNew_deque[i].DestId == 8) {
-				session = g_APPStatsNew_deque[i].DestId;
-			}
-		}
-	}
-	Temp_metrics::sizeps = g_APPStatsNew_deque.size();
-	lte_rss = IN_DB(NON_DB(Temp_rxpower::RSS[1][1])*pow(10.0, 12));
-	fx_rss = IN_DB(NON_DB(Temp_fx_rxpower::FXRSS[1][1])*pow(10.0, 12));
-	double result[6] = { 0.0 };
-	result[0] = exp(-0.0139*maxdelay_lte);  //lte delay
-	result[1] = exp(-0.0277*maxjet_lte);    //lte jet
-	result[2] = 1.0 -th_lte/50400000;
-	result[3] = exp(-0.0139*maxdelay_fx);   //fx delay
-	result[4] = exp(-0.0277*maxjet_fx);     //fx jet
-	result[5] = 1.0- th_fx/ 165000000;         //fx th
-
-	double A[8] = { 0.0 };
-	/*if (lte_rss > fx_rss) {
-		lte_rss = 1; fx_rss = 0;
-		A[0] = 1; A[4] = 0;
-	}
-	else {
-		lte_rss = 0; fx_rss = 1;
-		A[0] = 0; A[4] = 1;
-	}
-	if (result[0] > result[3]) {
-		result[0] = 0; result[3] = 1;
-		A[1] = 0; A[5] = 1;
-	}
-	else {
-		result[0] = 1; result[3] = 0;
-		A[1] = 1; A[5] = 0;
-	}
-	if (result[1] > result[4]) {
-		result[1] = 0; result[4] = 1;
-		A[2] = 0; A[6] = 1;
-	}
-	else {
-		result[1] = 1; result[4] = 0;
-		A[2] = 1; A[6] = 0;
-	}
-	if (result[2] > result[5]) {
-		result[2] = 1; result[5] = 0;
-		A[3] = 1; A[7] = 0;
-	}
-	else {
-		result[2] = 0; result[5] = 1;
-		A[3] = 0; A[7] = 1;
-	}*/
-
-	//0-1׼
-	//double A[8] = {0.0};
-	/*A[0] = lte_rss / (fabs(lte_rss) + fabs(fx_rss));        A[4] = fx_rss / (fabs(lte_rss) + fabs(fx_rss));
-	A[1] = result[0] / (fabs(result[0]) + fabs(result[3])); A[5] = result[3] / (fabs(result[0]) + fabs(result[3]));
-	A[2] = result[1] / (fabs(result[1]) + fabs(result[4])); A[6] = result[4] / (fabs(result[1]) + fabs(result[4]));
-	A[3] = result[2] / (fabs(result[2]) + fabs(result[5])); A[7] = result[5] / (fabs(result[2]) + fabs(result[5]));*/
-	A[0] = lte_rss / (fabs(lte_rss) + fabs(fx_rss));        A[4] = fx_rss / (fabs(lte_rss) + fabs(fx_rss));
-	A[1] = result[0]; A[5] = result[3];
-	A[2] = result[1]; A[6] = result[4];
-	A[3] = result[2] / (fabs(result[2]) + fabs(result[5])); A[7] = result[5] / (fabs(result[2]) + fabs(result[5]));
-	double Score_lte = 0.0; double Score_fx = 0.0;
-	//double w_A1[1][3] = { 0.0629,0.6716,0.2654 };  //Ự    
-	//double w_A2[1][3] = { 0.1047,0.2583,0.6370 }; //
-	//double w_A3[1][3] = { 0.6942,0.2103,0.0955 }; //
-	//double w_A4[1][3] = { 0.8182,0.0909,0.0909 }; //
-
-	//double w_A1[1][4] = { 0.0665,0.5883,0.2574,0.0878 };  //Ự    
-	//double w_A2[1][4] = { 0.0562,0.1239,0.3559,0.4640 }; //
-	//double w_A3[1][4] = { 0.2698,0.0862,0.0535,0.5905 }; //
-	//double w_A4[1][4] = { 0.3279,0.0467,0.0467,0.5786 }; //
-
-	double w_A1[1][4] = { 0.5,0.3358,0.1327,0.03145 };  //Ự    
-	double w_A2[1][4] = { 0.5,0.05475,0.2908,0.1545 }; //
-	double w_A3[1][4] = { 0.5,0.0744,0.0329,0.3927 }; //
-	double w_A4[1][4] = { 0.5,0.04545,0.04545,0.4091 }; //
-	if (strcmp(servicetype, "VBR") == 0) {
-	
-		/*Score_lte = w_A2[0][0] * (lte_rss / (lte_rss + fx_rss)) + w_A2[0][1] * (result[0]/(result[0]+result[3]))
-			+ w_A2[0][2] *( result[1]/(result[1]+result[4]))  + w_A2[0][3] * (result[2] / (result[2] + result[5]));
-		Score_fx = w_A2[0][0] * (fx_rss / (lte_rss + fx_rss)) + w_A2[0][1] * (result[3] / (result[0] + result[3]))
-			+ w_A2[0][2] * (result[4] / (result[1] + result[4])) + w_A2[0][3] * (result[5] / (result[2] + result[5]));*/
-		Score_lte = w_A2[0][0] * A[0] + w_A2[0][1] * A[1] + w_A2[0][2] * A[2] + w_A2[0][3] * A[3];
-		Score_fx = w_A2[0][0] * A[4] + w_A2[0][1] * A[5] + w_A2[0][2] * A[6] + w_A2[0][3] * A[7];
-	}
-	else if (strcmp(servicetype, "CBR") == 0 && session == 9) {
-		
-		/*Score_lte = w_A3[0][0] * (lte_rss / (lte_rss + fx_rss)) + w_A3[0][1] * (result[0] / (result[0] + result[3]))
-			+ w_A3[0][2] * (result[1] / (result[1] + result[4])) + w_A3[0][3] * (result[2] / (result[2] + result[5]));
-		Score_fx = w_A3[0][0] * (fx_rss / (lte_rss + fx_rss)) + w_A3[0][1] * (result[3] / (result[0] + result[3]))
-			+ w_A3[0][2] * (result[4] / (result[1] + result[4])) + w_A3[0][3] * (result[5] / (result[2] + result[5]));*/
-		Score_lte = w_A3[0][0] * A[0] + w_A3[0][1] * A[1] + w_A3[0][2] * A[2] + w_A3[0][3] * A[3];
-		Score_fx = w_A3[0][0] * A[4] + w_A3[0][1] * A[5] + w_A3[0][2] * A[6] + w_A3[0][3] * A[7];
-	}
-	else if (strcmp(servicetype, "FTP_GEN") == 0) {
-		
-		/*Score_lte = w_A4[0][0] * (lte_rss / (lte_rss + fx_rss)) + w_A4[0][1] * (result[0] / (result[0] + result[3]))
-			+ w_A4[0][2] * (result[1] / (result[1] + result[4])) + w_A4[0][3] * (result[2] / (result[2] + result[5]));
-		Score_fx = w_A4[0][0] * (fx_rss / (lte_rss + fx_rss)) + w_A4[0][1] * (result[3] / (result[0] + result[3]))
-			+ w_A4[0][2] * (result[4] / (result[1] + result[4])) + w_A4[0][3] * (result[5] / (result[2] + result[5]));*/
-		Score_lte = w_A4[0][0] * A[0] + w_A4[0][1] * A[1] + w_A4[0][2] * A[2] + w_A4[0][3] * A[3];
-		Score_fx = w_A4[0][0] * A[4] + w_A4[0][1] * A[5] + w_A4[0][2] * A[6] + w_A4[0][3] * A[7];
-	}
-	else if (session == 8) {
-		Score_lte = w_A1[0][0] * A[0] + w_A1[0][1] * A[1] + w_A1[0][2] * A[2] + w_A1[0][3] * A[3];
-		Score_fx = w_A1[0][0] * A[4] + w_A1[0][1] * A[5] + w_A1[0][2] * A[6] + w_A1[0][3] * A[7];
-	}
-	if (Score_lte < Score_fx) {
-		return TRUE;
-	}
-	return FALSE;
-}
-
-//static double *GrayModel(double arr[], int size) 
-static double *GrayModel(queue<double> Q, int size) {
-	double arr[7] = { 0.0 };
-	if (Q.size() > 0) {
-		for (int i = 0; i < 7; i++) {
-			arr[i] = Q.front();
-			Q.pop();
-		}
-	}
-	// Ԥģͺ   10ԭʼݣԤ
-	int tsize = 7 - 1;
-	double arr1[7] = { 0.0 }; // һۼ
-	double sum = 0;
-	for (int i = 0; i < 7; i++) {
-		sum += arr[i];
-		arr1[i] = sum;
-	}
-	double arr2[6] = { 0.0 };// arr1Ľھֵ
-	for (int i = 0; i < tsize; i++) {
-		arr2[i] = (double)(arr1[i] + arr1[i + 1]) / 2;
-	}
-	/*
-	*
-	* 潨 BYN a,b
-	*/
-	/*
-	* 潨B, B52еľ ൱һά顣
-	*/
-	double B[6][2] = { 0.0 };
-	for (int i = 0; i < tsize; i++) {
-		for (int j = 0; j < 2; j++) {
-			if (j == 1)
-				B[i][j] = 1;
-			else
-				B[i][j] = -arr2[i];
-		}
-	}
-	/*
-	* 潨YN
-	*/
-	double YN[6][1] = { 0.0 };
-	for (int i = 0; i < tsize; i++) {
-		for (int j = 0; j < 1; j++) {
-			YN[i][j] = arr[i + 1];
-		}
-	}
-	/*
-	* BתþBT,25еľ
-	*/
-	double BT[2][6] = { 0.0 };
-	for (int i = 0; i < 2; i++) {
-		for (int j = 0; j < tsize; j++) {
-			BT[i][j] = B[j][i];
-		}
-	}
-	/*
-	* BTBĳ˻õĽΪB2T,B2Tһ2*2ľ
-	*/
-	double B2T[2][2] = { 0.0 };
-	for (int i = 0; i < 2; i++) {// rows of BT
-
-		{
-			for (int j = 0; j < 2; j++)// cloums of B
-			{
-				for (int k = 0; k < tsize; k++)// cloums of BT=rows of B
-				{
-					B2T[i][j] = B2T[i][j] + BT[i][k] * B[k][j];
-				}
-			}
-
-		}
-	}
-	/* B2TΪB_2Tôһľ */
-	double B_2T[2][2] = { 0.0 };
-	B_2T[0][0] = (1 / (B2T[0][0] * B2T[1][1] - B2T[0][1] * B2T[1][0]))
-		* B2T[1][1];
-	B_2T[0][1] = (1 / (B2T[0][0] * B2T[1][1] - B2T[0][1] * B2T[1][0]))
-		* (-B2T[0][1]);
-	B_2T[1][0] = (1 / (B2T[0][0] * B2T[1][1] - B2T[0][1] * B2T[1][0]))
-		* (-B2T[1][0]);
-	B_2T[1][1] = (1 / (B2T[0][0] * B2T[1][1] - B2T[0][1] * B2T[1][0]))
-		* B2T[0][0];
-	/*
-	* ĸ֪δ֪abB_2T*BT*YN
-	* ǷֱЩĳ˻B_2T*BTB_2T*BTĳ˻ΪAAһ2*5ľ
-	*/
-	/*
-	*
-	*
-	*
-	* A
-	*/
-	double A[2][6] = { 0.0 };
-	for (int i = 0; i < 2; i++) {// rows of B_2T
-		{
-			for (int j = 0; j < tsize; j++)// cloums of BT
-			{
-				for (int k = 0; k < 2; k++)// cloums of B_2T=rows of BT
-				{
-					A[i][j] = A[i][j] + B_2T[i][k] * BT[k][j];
-				}
-			}
-
-		}
-	}
-	/*
-	*
-	*
-	* AYNĳ˻˻ΪCCһ2*1ľ
-	*/
-	double C[2][1] = { 0.0 };
-	for (int i = 0; i < 2; i++) {// rows of A
-
-		{
-			for (int j = 0; j < 1; j++)// cloums of YN
-			{
-				for (int k = 0; k < tsize; k++)// cloums of A=rows of YN
-				{
-					C[i][j] = C[i][j] + A[i][k] * YN[k][j];
-				}
-			}
-
-		}
-	}
-	/* a=C[0][0],b=C[1][0]; */
-	double a = C[0][0], b = C[1][0];
-
-	//int i = T;// ȡһֵ
-	//double Y = (arr[0] - b / a)*exp( -a * (i + 1)) - (arr[0] - b / a)*exp( -a * (i));
-	//Ԥ,ԤѵݳΪ10
-	double F[9] = { 0.0 };
-	F[0] = arr[0];
-	for (int i = 1; i < 9; i++) {
-		F[i] = (arr[0] - b / a)*exp(-a * (i)) + b / a;
-	}
-
-	// F ۼԭ,õԤ
-	
-	//double G[12] = { 0.0 };
-	ofstream outfile1, outfile2, outfile3, outfile4, outfile5, outfile6, outfile7, outfile8;
-	outfile1.open("ycltedelay.csv", ios::app | ios::out); //ûļ򴴽ļļļβ׷ 
-	outfile2.open("ycfxdelay.csv", ios::app | ios::out);
-	outfile3.open("ycltejet.csv", ios::app | ios::out);
-	outfile4.open("ycfxjet.csv", ios::app | ios::out);
-	outfile5.open("yclterss.csv", ios::app | ios::out);
-	outfile6.open("ycfxrss.csv", ios::app | ios::out);
-	outfile7.open("ycltethr.csv", ios::app | ios::out);
-	outfile8.open("ycfxthr.csv", ios::app | ios::out);
-	double * G = new double[9];  //ַռ
-	G[0] = arr[0];
-	if (size == 1) {
-		outfile1 << arr[0] << "," << G[0] << endl;
-	}
-	else if (size == 2) {
-		outfile2 << arr[0] << "," << G[0] << endl;
-	}
-	else if (size == 3) {
-		outfile3 << arr[0] << "," << G[0] << endl;
-	}
-	else if (size == 4) {
-		outfile4 << arr[0] << "," << G[0] << endl;
-	}
-	else if (size == 5) {
-		outfile5 << arr[0] << "," << G[0] << endl;
-	}
-	else if (size == 6) {
-		outfile6 << arr[0] << "," << G[0] << endl;
-	}
-	else if (size == 7) {
-		outfile7 << arr[0] << "," << G[0] << endl;
-	}
-	else if (size == 8) {
-		outfile8 << arr[0] << "," << G[0] << endl;
-	}
-	for (int i = 1; i < 9; i++) {
-		G[i] = F[i] - F[i - 1];
-		if (size == 1) {
-			outfile1 << arr[i] << "," << G[i] << endl;
-		}
-		else if (size == 2) {
-			outfile2 << arr[i] << "," << G[i] << endl;
-		}
-		else if (size == 3) {
-			outfile3 << arr[i] << "," << G[i] << endl;
-		}
-		else if (size == 4) {
-			outfile4 << arr[i] << "," << G[i] << endl;
-		}
-		else if (size == 5) {
-			outfile5 << arr[i] << "," << G[i] << endl;
-		}
-		else if (size == 6) {
-			outfile6 << arr[i] << "," << G[i] << endl;
-		}
-		else if (size == 7) {
-			outfile7 << arr[i] << "," << G[i] << endl;
-		}
-		else if (size == 8) {
-			outfile8 << arr[i] << "," << G[i] << endl;
-		}
-	}
-	outfile1.close();
-	outfile2.close(); outfile3.close(); outfile4.close(); outfile5.close(); outfile6.close(); outfile7.close(); outfile8.close();
-	return G;
-}
-
-//gss real-time MADM
-Int64  Temp_metrics::interval= 0;
-BOOL Temp_metrics::flag_rsaw = FALSE;
-static BOOL XdRealTimeSAWDecision(){
-	
-	deque<APPStatsNew>::iterator it = g_APPStatsNew_deque.begin();
-	double maxdelay_lte = 0.0;  double maxjet_lte = 0.0; double th_lte = 0.0;
-	double maxdelay_fx = 0.0;  double maxjet_fx = 0.0; double th_fx = 0.0;
-	double cur_time = 0.0;
-	double lte_rss = 0.0;
-	double fx_rss = 0.0;
-	char* servicetype = ""; 
-	int session = 0;
-	for (int i = Temp_metrics::sizeps; i < g_APPStatsNew_deque.size(); i++) {
-		if (g_APPStatsNew_deque[i].DestId == 10 || (g_APPStatsNew_deque[i].DestId == 9 && NodeLinkStation::NodeLinkdirection[1] == 0)
-			|| (g_APPStatsNew_deque[i].DestId == 8 && NodeLinkStation::NodeLinkdirection[1] == 0)) {
-			th_lte =  th_lte + g_APPStatsNew_deque[i].AppThroughput; //ȡLTEÿ
-			if (maxdelay_lte < g_APPStatsNew_deque[i].AppDelay) {
-				maxdelay_lte = g_APPStatsNew_deque[i].AppDelay;  //ȡLTEʱӡʱӶֵ
-			}
-			if (maxjet_lte < g_APPStatsNew_deque[i].AppJet) {
-				maxjet_lte = g_APPStatsNew_deque[i].AppJet;
-			}
-		}
-		else if (g_APPStatsNew_deque[i].DestId == 4 || (g_APPStatsNew_deque[i].DestId == 9 && NodeLinkStation::NodeLinkdirection[1] == 1)
-			|| (g_APPStatsNew_deque[i].DestId == 8 && NodeLinkStation::NodeLinkdirection[1] == 0)) {
-			th_fx = th_fx + g_APPStatsNew_deque[i].AppThroughput;   //ȡFXÿ
-			if (maxdelay_fx < g_APPStatsNew_deque[i].AppDelay) {   //ȡFXÿʱӡʱӶֵ
-				maxdelay_fx = g_APPStatsNew_deque[i].AppDelay;
-			}
-			if (maxjet_fx < g_APPStatsNew_deque[i].AppJet) {
-				maxjet_fx = g_APPStatsNew_deque[i].AppJet;
-			}
-		}
-		
-		if (g_APPStatsNew_deque[i].DestId == 9) {
-			servicetype = g_APPStatsNew_deque[i].Servicetype;
-			session = g_APPStatsNew_deque[i].DestId;
-		}
-		if (g_APPStatsNew_deque[i].DestId == 8) {
-			session = g_APPStatsNew_deque[i].DestId;
-		}
-		cur_time = g_APPStatsNew_deque[i].simTime;
-	}
-	Temp_metrics::sizeps = g_APPStatsNew_deque.size();
-	lte_rss = Temp_rxpower::RSS[1][1];
-	fx_rss = Temp_fx_rxpower::FXRSS[1][1];
-	if (maxdelay_lte > 0) {
-		delay_lte.push(maxdelay_lte);   //ȡ10ֵԤʱ̵ֵ
-		if (delay_lte.size() > 7) {
-			delay_lte.pop();
-		}
-		delay_fx.push(maxdelay_fx);
-		if (delay_fx.size() > 7) {
-			delay_fx.pop();
-		}
-		jet_lte.push(maxjet_lte);
-		if (jet_lte.size() > 7) {
-			jet_lte.pop();
-		}
-		jet_fx.push(maxjet_fx);
-		if (jet_fx.size() > 7) {
-			jet_fx.pop();
-		}
-		rss_lte.push(lte_rss);
-		if (rss_lte.size() > 7) {
-			rss_lte.pop();
-		}
-		rss_fx.push(fx_rss);
-		if (rss_fx.size() > 7) {
-			rss_fx.pop();
-		}
-		thr_lte.push(th_lte);
-		if (thr_lte.size() > 7) {
-			thr_lte.pop();
-		}
-		thr_fx.push(th_fx);
-		if (thr_fx.size() > 7) {
-			thr_fx.pop();
-		}
-	}
-	double *arr_delay_lte;
-	double *arr_delay_fx;
-	double *arr_jet_lte;
-	double *arr_jet_fx;
-	double *arr_rss_lte;
-	double *arr_rss_fx;
-	double *arr_thr_lte;
-	double *arr_thr_fx;
-	/*if (delay_lte.size() == 10) {
-		arr_delay_lte = GrayModel(delay_lte, 1);
-	}
-	if (delay_fx.size() == 10) {
-		arr_delay_fx = GrayModel(delay_fx, 2);
-	}
-	if (jet_lte.size() == 10) {
-		arr_jet_lte = GrayModel(jet_lte, 3);
-	}
-	if (jet_fx.size() == 10) {
-	    arr_jet_fx = GrayModel(jet_fx, 4);
-	}
-	if (rss_lte.size() == 10) {
-		arr_rss_lte = GrayModel(rss_lte, 5);
-	}
-	if (rss_fx.size() == 10) {
-		arr_rss_fx = GrayModel(rss_fx, 6);
-	}
-	if (thr_lte.size() == 10) {
-		arr_thr_lte = GrayModel(thr_lte, 7);
-	}
-	if (thr_fx.size() == 10) {
-		arr_thr_fx = GrayModel(thr_fx, 8);
-	}*/
-	double Score_lte = 0.0; double Score_fx = 0.0;
-	
-	if (delay_lte.size() == 7 && (cur_time - Temp_metrics::interval) >= 3) {
-		if (delay_lte.size() == 7) {
-		arr_delay_lte = GrayModel(delay_lte, 1);
-		}
-		if (delay_fx.size() == 7) {
-		arr_delay_fx = GrayModel(delay_fx, 2);
-		}
-		if (jet_lte.size() == 7) {
-		arr_jet_lte = GrayModel(jet_lte, 3);
-		}
-		if (jet_fx.size() == 7) {
-		arr_jet_fx = GrayModel(jet_fx, 4);
-		}
-		if (rss_lte.size() == 7) {
-		arr_rss_lte = GrayModel(rss_lte, 5);
-		}
-		if (rss_fx.size() == 7) {
-		arr_rss_fx = GrayModel(rss_fx, 6);
-		}
-		if (thr_lte.size() == 7) {
-		arr_thr_lte = GrayModel(thr_lte, 7);
-		}
-		if (thr_fx.size() == 7) {
-		arr_thr_fx = GrayModel(thr_fx, 8);
-		}
-		Temp_metrics::interval = cur_time;
-		//ʼ߾A
-		//double A[6][3] = { 0.0 };
-		double A[6][4] = { 0.0 };
-		A[0][0] = IN_DB(NON_DB(lte_rss)*pow(10.0, 12));  A[0][1] = maxdelay_lte; A[0][2] = maxjet_lte; A[0][3] = 1 - th_lte/50400000;
-		A[1][0] = IN_DB(NON_DB(fx_rss)*pow(10.0, 12));   A[1][1] = maxdelay_fx;  A[1][2] = maxjet_fx;  A[1][3] =1-th_fx / 165000000.00;
-		A[2][0] = IN_DB(NON_DB(*(arr_rss_lte + 10))*pow(10.0, 12)); A[2][1] = *(arr_delay_lte + 10); A[2][2] = *(arr_jet_lte + 10); A[2][3] =1  - (*(arr_thr_lte + 10))/ 50400000.00;
-		A[3][0] = IN_DB(NON_DB(*(arr_rss_fx + 10))*pow(10.0, 12));  A[3][1] = *(arr_delay_fx + 10);  A[3][2] = *(arr_jet_fx + 10);  A[3][3] = 1 -(*(arr_thr_fx + 10))/ 165000000.00;
-		A[4][0] = IN_DB(NON_DB(*(arr_rss_lte + 11))*pow(10.0, 12)); A[4][1] = *(arr_delay_lte + 11); A[4][2] = *(arr_jet_lte + 11); A[4][3] = 1  - (*(arr_thr_lte + 11))/50400000.00;
-		A[5][0] = IN_DB(NON_DB(*(arr_rss_fx + 11))*pow(10.0, 12));  A[5][1] = *(arr_delay_fx + 11);  A[5][2] = *(arr_jet_fx + 11);  A[5][3] = 1 -(*(arr_thr_fx + 11))/ 165000000.00;
-
-		//ʼB
-		//double B[4][3] = { 0.0 };
-		double B[4][4] = { 0.0 };
-		if (A[0][0] == 0) {
-			B[0][0] = A[2][0] - A[0][0];
-			//B[0][0] = 0;
-		}
-		else {
-			B[0][0] = (A[2][0] - A[0][0]) / fabs(A[0][0]);
-		}
-		if (A[0][1] == 0) {
-			B[0][1] = A[2][1] - A[0][1];
-			//B[0][1] = 0;
-		}
-		else {
-			B[0][1] = (A[2][1] - A[0][1]) / fabs(A[0][1]);
-		}
-		if (A[0][2] == 0) {
-			B[0][2] = A[2][2] - A[0][2];
-			//B[0][2] = 0;
-		}
-		else {
-			B[0][2] = (A[2][2] - A[0][2]) / fabs(A[0][2]);
-		}
-		if (A[0][3] == 0) {
-			B[0][3] = A[2][3] - A[0][3];
-			//B[0][3] = 0;
-		}
-		else {
-			B[0][3] = (A[2][3] - A[0][3]) / fabs(A[0][3]);
-		}
-
-		if (A[1][0] == 0) {
-			B[1][0] = A[3][0] - A[1][0];
-			//B[1][0] = 0;
-		}
-		else {
-			B[1][0] = (A[3][0] - A[1][0]) / fabs(A[1][0]);
-		}
-		if (A[1][1] == 0) {
-			B[1][1] = A[3][1] - A[1][1];
-			//B[1][1] = 0;
-		}
-		else {
-			B[1][1] = (A[3][1] - A[1][1]) / fabs(A[1][1]);
-		}
-		if (A[1][2] == 0) {
-			B[1][2] = A[3][2] - A[1][2];
-			//B[1][2] = 0;
-		}
-		else {
-			B[1][2] = (A[3][2] - A[1][2]) / fabs(A[1][2]);
-		}
-		if (A[1][3] == 0) {
-			B[1][3] = A[3][3] - A[1][3];
-			//B[1][3] = 0;
-		}
-		else {
-			B[1][3] = (A[3][3] - A[1][3]) / fabs(A[1][3]);
-		}
-
-		if (A[2][0] == 0) {
-			B[2][0] = A[4][0] - A[2][0];
-			//B[2][0] = 0;
-		}
-		else {
-			B[2][0] = (A[4][0] - A[2][0]) / fabs(A[2][0]);
-		}
-		if (A[2][1] == 0) {
-			B[2][1] = A[4][1] - A[2][1];
-			//B[2][1] = 0;
-		}
-		else {
-			B[2][1] = (A[4][1] - A[2][1]) / fabs(A[2][1]);
-		}
-		if (A[2][2] == 0) {
-			B[2][2] = A[4][2] - A[2][2];
-			//B[2][2] = 0;
-		}
-		else {
-			B[2][2] = (A[4][2] - A[2][2]) / fabs(A[2][2]);
-		}
-		if (A[2][3] == 0) {
-			B[2][3] = A[4][3] - A[2][3];
-			//B[2][3] = 0;
-		}
-		else {
-			B[2][3] = (A[4][3] - A[2][3]) / fabs(A[2][3]);
-		}
-
-		if (A[3][0] == 0) {
-			B[3][0] = A[5][0] - A[3][0];
-			//B[3][0] = 0;
-		}
-		else {
-			B[3][0] = (A[5][0] - A[3][0]) / fabs(A[3][0]);
-		}
-		if (A[3][1] == 0) {
-			B[3][1] = A[5][1] - A[3][1];
-			//B[3][1] = 0;
-		}
-		else {
-			B[3][1] = (A[5][1] - A[3][1]) / fabs(A[3][1]);
-		}
-		if (A[3][2] == 0) {
-			B[3][2] = A[5][2] - A[3][2];
-			//B[3][2] = 0;
-		}
-		else {
-			B[3][2] = (A[5][2] - A[3][2]) / fabs(A[3][2]);
-		}
-		if (A[3][3] == 0) {
-			//B[3][3] = A[5][3] - A[3][3];
-			//B[3][3] = 0;
-		}
-		else {
-			B[3][3] = (A[5][3] - A[3][3]) / fabs(A[3][3]);
-		}
-		/*B[0][0] = (A[2][0] - A[0][0]) / fabs(A[0][0]); B[0][1] = (A[2][1] - A[0][1]) / fabs(A[0][1]); B[0][2] = (A[2][2] - A[0][2]) / fabs(A[0][2]); B[0][3] = (A[2][3] - A[0][3]) / fabs(A[0][3]);
-		B[1][0] = (A[3][0] - A[1][0]) / fabs(A[1][0]); B[1][1] = (A[3][1] - A[1][1]) / fabs(A[1][1]); B[1][2] = (A[3][2] - A[1][2]) / fabs(A[1][2]); B[1][3] = (A[3][3] - A[1][3]) / fabs(A[1][3]);
-		B[2][0] = (A[4][0] - A[2][0]) / fabs(A[2][0]); B[2][1] = (A[4][1] - A[2][1]) / fabs(A[2][1]); B[2][2] = (A[4][2] - A[2][2]) / fabs(A[2][2]); B[2][3] = (A[4][3] - A[2][3]) / fabs(A[2][3]);
-		B[3][0] = (A[5][0] - A[3][0]) / fabs(A[3][0]); B[3][1] = (A[5][1] - A[3][1]) / fabs(A[3][1]); B[3][2] = (A[5][2] - A[3][2]) / fabs(A[3][2]); B[3][3] = (A[5][3] - A[3][3]) / fabs(A[3][3]);*/
-		/*B[0][0] = (A[2][0] - A[0][0]) ; B[0][1] = (A[2][1] - A[0][1]); B[0][2] = (A[2][2] - A[0][2]) ; B[0][3] = (A[2][3] - A[0][3]) ;
-		B[1][0] = (A[3][0] - A[1][0]) ; B[1][1] = (A[3][1] - A[1][1]); B[1][2] = (A[3][2] - A[1][2]) ; B[1][3] = (A[3][3] - A[1][3]) ;
-		B[2][0] = (A[4][0] - A[2][0]) ; B[2][1] = (A[4][1] - A[2][1]); B[2][2] = (A[4][2] - A[2][2]) ; B[2][3] = (A[4][3] - A[2][3]) ;
-		B[3][0] = (A[5][0] - A[3][0]) ; B[3][1] = (A[5][1] - A[3][1]); B[3][2] = (A[5][2] - A[3][2]) ; B[3][3] = (A[5][3] - A[3][3]) ;*/
-
-		//0-1 A
-		//double A1[6][3] = { 0.0 };
-		double A1[6][4] = { 0.0 };
-		//if (A[0][0] > A[1][0]) { 
-		//	A1[0][0] = 1; A1[1][0] = 0;
-		//}
-		//else {
-		//	A1[0][0] = 0; A1[1][0] = 1;
-		//}
-		//if (A[0][1] > A[1][1]) {
-		//	A1[0][1] = 0; A1[1][1] = 1;
-		//}
-		//else {
-		//	A1[0][1] = 1; A1[1][1] = 0; 
-		//}
-		//if (A[0][2] > A[1][2]) {
-		//	A1[0][2] = 0; A1[1][2] = 1;
-		//}
-		//else {
-		//	A1[0][2] = 1; A1[1][2] = 0;
-		//}
-		////add thr
-		//if (A[0][3] > A[1][3]) {
-		//	A1[0][3] = 1; A1[1][3] = 0;
-		//}
-		//else {
-		//	A1[0][3] = 0; A1[1][3] = 1;
-		//}
-
-		//if (A[2][0] > A[3][0]) {
-		//	A1[2][0] = 1; A1[3][0] = 0;
-		//}
-		//else { 
-		//	A1[2][0] = 0; A1[3][0] = 1;
-		//}
-		//if (A[2][1] > A[3][1]) {
-		//	A1[2][1] = 0; A1[3][1] = 1;
-		//}
-		//else {
-		//	A1[2][1] = 1; A1[3][1] = 0;
-		//}
-		//if (A[2][2] > A[3][2]) {
-		//	A1[2][2] = 0; A1[3][2] = 1;
-		//}
-		//else {
-		//	A1[2][2] = 1; A1[3][2] = 0;
-		//}
-		////add thr
-		//if (A[2][3] > A[3][3]) {
-		//	A1[2][3] = 1; A1[3][3] = 0;
-		//}   
-		//else {
-		//	A1[2][3] = 0; A1[3][3] = 1;
-		//}
-
-
-		//if (A[4][0] > A[5][0]) {
-		//	A1[4][0] = 1; A1[5][0] = 0;
-		//}
-		//else { A1[4][0] = 0; A1[5][0] = 1; }
-		//if (A[4][1] > A[5][1]) {
-		//	A1[4][1] = 0; A1[5][1] = 1;
-		//}
-		//else {
-		//	A1[4][1] = 1; A1[5][1] = 0;
-		//}
-		//if (A[4][2] > A[5][2]) {
-		//	A1[4][2] = 0; A1[5][2] = 1;
-		//}
-		//else {
-		//	A1[4][2] = 1; A1[5][2] = 0;
-		//}
-		////add thr
-		//if (A[4][3] > A[5][3]) {
-		//	A1[4][3] = 1; A1[5][3] = 0;
-		//}
-		//else {
-		//	A1[4][3] = 0; A1[5][3] = 1;
-		//}
-		//A1[0][0] = A[0][0] / (fabs(A[0][0]) + fabs(A[1][0]));  A1[0][1] = A[0][1] / (fabs(A[0][1]) + fabs(A[1][1])); A1[0][2] = A[0][2] / (fabs(A[0][2]) + fabs(A[1][2])); A1[0][3] = A[0][3] / (fabs(A[0][3]) + fabs(A[1][3]));
-		//A1[1][0] = A[1][0] / (fabs(A[0][0]) + fabs(A[1][0]));  A1[1][1] = A[1][1] / (fabs(A[1][1]) + fabs(A[1][1])); A1[1][2] = A[1][2] / (fabs(A[0][2]) + fabs(A[1][2])); A1[1][3] = A[1][3] / (fabs(A[0][3]) + fabs(A[1][3]));
-		//A1[2][0] = A[2][0] / (fabs(A[2][0]) + fabs(A[3][0]));  A1[2][1] = A[2][1] / (fabs(A[2][1]) + fabs(A[3][1])); A1[2][2] = A[2][2] / (fabs(A[2][2]) + fabs(A[3][2])); A1[2][3] = A[2][3] / (fabs(A[2][3]) + fabs(A[3][3]));
-		//A1[3][0] = A[3][0] / (fabs(A[2][0]) + fabs(A[3][0]));  A1[3][1] = A[3][1] / (fabs(A[2][1]) + fabs(A[3][1])); A1[3][2] = A[3][2] / (fabs(A[2][2]) + fabs(A[3][2])); A1[3][3] = A[3][3] / (fabs(A[2][3]) + fabs(A[3][3]));
-		//A1[4][0] = A[4][0] / (fabs(A[4][0]) + fabs(A[5][0]));  A1[4][1] = A[4][1] / (fabs(A[4][1]) + fabs(A[5][1])); A1[4][2] = A[4][2] / (fabs(A[4][2]) + fabs(A[5][2])); A1[4][3] = A[4][3] / (fabs(A[4][3]) + fabs(A[5][3]));
-		//A1[5][0] = A[5][0] / (fabs(A[4][0]) + fabs(A[5][0]));  A1[5][1] = A[5][1] / (fabs(A[4][1]) + fabs(A[5][1])); A1[5][2] = A[5][2] / (fabs(A[4][2]) + fabs(A[5][2])); A1[5][3] = A[5][3] / (fabs(A[4][3]) + fabs(A[5][3]));
-
-		A1[0][0] = A[0][0] / (fabs(A[0][0]) + fabs(A[1][0]));  A1[0][1] = exp(-0.0139*A[0][1]); A1[0][2] = exp(-0.0277*A[0][2]); A1[0][3] = A[0][3] / (fabs(A[0][3]) + fabs(A[1][3]));
-		A1[1][0] = A[1][0] / (fabs(A[0][0]) + fabs(A[1][0]));  A1[1][1] = exp(-0.0139*A[1][1]); A1[1][2] = exp(-0.0277*A[1][2]); A1[1][3] = A[1][3] / (fabs(A[0][3]) + fabs(A[1][3]));
-		A1[2][0] = A[2][0] / (fabs(A[2][0]) + fabs(A[3][0]));  A1[2][1] = exp(-0.0139*A[2][1]); A1[2][2] = exp(-0.0277*A[2][2]); A1[2][3] = A[2][3] / (fabs(A[2][3]) + fabs(A[3][3]));
-		A1[3][0] = A[3][0] / (fabs(A[2][0]) + fabs(A[3][0]));  A1[3][1] = exp(-0.0139*A[3][1]); A1[3][2] = exp(-0.0277*A[3][2]); A1[3][3] = A[3][3] / (fabs(A[2][3]) + fabs(A[3][3]));
-		A1[4][0] = A[4][0] / (fabs(A[4][0]) + fabs(A[5][0]));  A1[4][1] = exp(-0.0139*A[4][1]); A1[4][2] = exp(-0.0277*A[4][2]); A1[4][3] = A[4][3] / (fabs(A[4][3]) + fabs(A[5][3]));
-		A1[5][0] = A[5][0] / (fabs(A[4][0]) + fabs(A[5][0]));  A1[5][1] = exp(-0.0139*A[5][1]); A1[5][2] = exp(-0.0277*A[5][2]); A1[5][3] = A[5][3] / (fabs(A[4][3]) + fabs(A[5][3]));
-
-		//0-1 B
-		//double B1[4][3] = { 0.0 };
-		double B1[4][4] = { 0.0 };
-		//if (B[0][0] > B[1][0]) {
-		//	B1[0][0] = 1; B1[1][0] = 0;
-		//}
-		//else {
-		//	B1[0][0] = 0; B1[1][0] = 1;
-		//}
-		//if (B[0][1] > B[1][1]) {
-		//	B1[0][1] = 0; B1[1][1] = 1;
-		//}
-		//else {
-		//	B1[0][1] = 1; B1[1][1] = 0;
-		//}
-		//if (B[0][2] > B[1][2]) {
-		//	B1[0][2] = 0; B1[1][2] = 1;
-		//}
-		//else {
-		//	B1[0][2] = 1; B1[1][2] = 0;
-		//}
-		////add thr
-		//if (B[0][3] > B[1][3]) {
-		//	B1[0][3] = 1; B1[1][3] = 0;
-		//}
-		//else {
-		//	B1[0][3] = 0; B1[1][3] = 1;
-		//}
-
-		//if (B[2][0] > B[3][0]) {
-		//	B1[2][0] = 1; B1[3][0] = 0;
-		//}
-		//else {
-		//	B1[2][0] = 0; B1[3][0] = 1;
-		//}
-		//if (B[2][1] > B[3][1]) {
-		//	B1[2][1] = 0; B1[3][1] = 1;
-		//}
-		//else {
-		//	B1[2][1] = 1; B1[3][1] = 0;
-		//}
-		//if (B[2][2] > B[3][2]) {
-		//	B1[2][2] = 0; B1[3][2] = 1;
-		//}
-		//else {
-		//	B1[2][2] = 1; B1[3][2] = 0;
-		//}
-		////add thr
-		//if (B[2][3] > B[3][3]) {
-		//	B1[2][3] = 1; B1[3][3] = 0;
-		//}
-		//else {
-		//	B1[2][3] = 0; B1[3][3] = 1;
-		//}
-		/*B1[0][0] = B[0][0] / (fabs(B[0][0]) + fabs(B[1][0]));  B1[0][1] = B[0][1] / (fabs(B[0][1]) + fabs(B[1][1])); B1[0][2] = B[0][2] / (fabs(B[0][2]) + fabs(B[1][2])); B1[0][3] = B[0][3] / (fabs(B[0][3]) + fabs(B[1][3]));
-		B1[1][0] = B[1][0] / (fabs(B[0][0]) + fabs(B[1][0]));  B1[1][1] = B[1][1] / (fabs(B[1][1]) + fabs(B[1][1])); B1[1][2] = B[1][2] / (fabs(B[0][2]) + fabs(B[1][2])); B1[1][3] = B[1][3] / (fabs(B[0][3]) + fabs(B[1][3]));
-		B1[2][0] = B[2][0] / (fabs(B[2][0]) + fabs(B[3][0]));  B1[2][1] = B[2][1] / (fabs(B[2][1]) + fabs(B[3][1])); B1[2][2] = B[2][2] / (fabs(B[2][2]) + fabs(B[3][2])); B1[2][3] = B[2][3] / (fabs(B[2][3]) + fabs(B[3][3]));
-		B1[3][0] = B[3][0] / (fabs(B[2][0]) + fabs(B[3][0]));  B1[3][1] = B[3][1] / (fabs(B[2][1]) + fabs(B[3][1])); B1[3][2] = B[3][2] / (fabs(B[2][2]) + fabs(B[3][2])); B1[3][3] = B[3][3] / (fabs(B[2][3]) + fabs(B[3][3]));*/
-
-		B1[0][0] = B[0][0] / (fabs(B[0][0]) + fabs(B[1][0]));  B1[0][1] = exp(-0.0139*B[0][1]); B1[0][2] = exp(-0.0277*B[0][2]); B1[0][3] = B[0][3] / (fabs(B[0][3]) + fabs(B[1][3]));
-		B1[1][0] = B[1][0] / (fabs(B[0][0]) + fabs(B[1][0]));  B1[1][1] = exp(-0.0139*B[1][1]); B1[1][2] = exp(-0.0277*B[1][2]); B1[1][3] = B[1][3] / (fabs(B[0][3]) + fabs(B[1][3]));
-		B1[2][0] = B[2][0] / (fabs(B[2][0]) + fabs(B[3][0]));  B1[2][1] = exp(-0.0139*B[2][1]); B1[2][2] = exp(-0.0277*B[2][2]); B1[2][3] = B[2][3] / (fabs(B[2][3]) + fabs(B[3][3]));
-		B1[3][0] = B[3][0] / (fabs(B[2][0]) + fabs(B[3][0]));  B1[3][1] = exp(-0.0139*B[3][1]); B1[3][2] = exp(-0.0277*B[3][2]); B1[3][3] = B[3][3] / (fabs(B[2][3]) + fabs(B[3][3]));
-
-		//淶ľ߾
-		/*double A_lte[3][3] = { { A1[0][0],A1[0][1],A1[0][2] },{ A1[2][0],A1[2][1],A1[2][2] } ,{ A1[4][0],A1[4][1],A1[4][2] } };
-		double A_fx[3][3] = { { A1[1][0],A1[1][1],A1[1][2] },{ A1[3][0],A1[3][1],A1[3][2] } ,{ A1[5][0],A1[5][1],A1[5][2] } };
-		double B_lte[2][3] = { { B1[0][0],B1[0][1],B1[0][2] },{ B1[2][0],B1[2][1],B1[2][2] } };
-		double B_fx[2][3] = { { B1[1][0],B1[1][1],B1[1][2] },{ B1[3][0],B1[3][1],B1[3][2] } };*/
-		double A_lte[3][4] = { { A1[0][0],A1[0][1],A1[0][2],A1[0][3] },{ A1[2][0],A1[2][1],A1[2][2],A1[2][3] } ,{ A1[4][0],A1[4][1],A1[4][2],A1[4][3] } };
-		double A_fx[3][4] = { { A1[1][0],A1[1][1],A1[1][2],A1[1][3] },{ A1[3][0],A1[3][1],A1[3][2],A1[3][3] } ,{ A1[5][0],A1[5][1],A1[5][2],A1[5][3] } };
-		double B_lte[2][4] = { { B1[0][0],B1[0][1],B1[0][2],B1[0][3] },{ B1[2][0],B1[2][1],B1[2][2],B1[2][3] } };
-		double B_fx[2][4] = { { B1[1][0],B1[1][1],B1[1][2],B1[1][3] },{ B1[3][0],B1[3][1],B1[3][2],B1[3][3] } };
-		//ȡʱȨءȨء߾Ȩ
-		double v_A[1][3] = { 0.5000 ,0.3333,0.1667 };  double v_B[1][2] = { 0.6667,0.3333};
-
-		//double w_A1[1][3]  = { 0.0629,0.6716,0.2654 };  //Ự    
-		//double w_A2[1][3] = { 0.1047,0.2583,0.6370 }; //
-		//double w_A3[1][3] = { 0.6942,0.2103,0.0955 }; //
-		//double w_A4[1][3] = { 0.8182,0.0909,0.0909 }; //
-		//double w_A1[1][4] = { 0.0665,0.5883,0.2574,0.0878 };  //Ự    
-		//double w_A2[1][4] = { 0.0562,0.1239,0.3559,0.4640 }; //
-		//double w_A3[1][4] = { 0.2698,0.0862,0.0535,0.5905 }; //
-		//double w_A4[1][4] = { 0.3279,0.0467,0.0467,0.5786 }; //
-
-		double w_A1[1][4] = { 0.5,0.3358,0.1327,0.03145 };  //Ự    
-		double w_A2[1][4] = { 0.5,0.05475,0.2908,0.1545 }; //
-		double w_A3[1][4] = { 0.5,0.0744,0.0329,0.3927 }; //
-		double w_A4[1][4] = { 0.5,0.04545,0.04545,0.4091 }; //
-		
-		double **M_lte; double **D_lte;
-		double **M_fx;  double **D_fx;
-		/*double m_lte[3][1] = { 0.0 }; double d_lte[3][1] = { 0.0 };
-		double m_fx[3][1]  = { 0.0 }; double d_fx[3][1] = { 0.0 };
-		M_lte = Matrix_tran(multiply(v_A, A_lte, 1, 3, 3));
-		D_lte = Matrix_tran(multiply(v_B, B_lte, 1, 3, 2));
-		M_fx = Matrix_tran(multiply(v_A, A_fx, 1, 3, 3));
-		D_fx = Matrix_tran(multiply(v_B, B_fx, 1, 3, 2));
-		for (int i = 0; i < 3; i++) {
-			m_lte[i][0] = M_lte[i][0];
-			d_lte[i][0] = D_lte[i][0];
-			m_fx[i][0] = M_fx[i][0];
-			d_fx[i][0] = D_fx[i][0];*/
-		double m_lte[4][1] = { 0.0 }; double d_lte[4][1] = { 0.0 };
-		double m_fx[4][1] = { 0.0 }; double d_fx[4][1] = { 0.0 };
-
-		M_lte = Matrix_tran(multiply(v_A, A_lte, 1, 4, 3));
-		D_lte = Matrix_tran(multiply(v_B, B_lte, 1, 4, 2));
-		M_fx = Matrix_tran(multiply(v_A, A_fx, 1, 4, 3));
-		D_fx = Matrix_tran(multiply(v_B, B_fx, 1, 4, 2));
-		for (int i = 0; i < 4; i++) {
-			m_lte[i][0] = M_lte[i][0];
-			d_lte[i][0] = D_lte[i][0];
-			m_fx[i][0] = M_fx[i][0];
-			d_fx[i][0] = D_fx[i][0];
-		}
-		if (strcmp(servicetype, "VBR") == 0) {
-			Score_lte = 0.67*multiply1(w_A2, m_lte, 3) + 0.33*multiply1(w_A2, d_lte, 3);
-			Score_fx = 0.67*multiply1(w_A2, m_fx, 3) + 0.33*multiply1(w_A2, d_fx, 3);
-		}
-		else if (strcmp(servicetype,"CBR")==0 && session == 9) {	
-			double t1 = multiply1(w_A3, m_lte, 3);
-			double t2 = multiply1(w_A3, d_lte, 3);
-			double t3 = multiply1(w_A3, m_fx, 3);
-			double t4 = multiply1(w_A3, d_fx, 3);
-
-			Score_lte = 0.67*multiply1(w_A3, m_lte, 3) + 0.33*multiply1(w_A3,d_lte,3);
-			Score_fx  = 0.67*multiply1(w_A3, m_fx, 3) + 0.33*multiply1(w_A3, d_fx, 3);
-		}
-		else if (strcmp(servicetype, "TRAFFIC_GEN") == 0) {
-			Score_lte = 0.67*multiply1(w_A4, m_lte, 3) + 0.33*multiply1(w_A4, d_lte, 3);
-			Score_fx = 0.67*multiply1(w_A4, m_fx, 3) + 0.33*multiply1(w_A4, d_fx, 3);
-		}
-		else if (session == 8) {
-			Score_lte = 0.67*multiply1(w_A1, m_lte, 3) + 0.33*multiply1(w_A1, d_lte, 3);
-			Score_fx = 0.67*multiply1(w_A1, m_fx, 3) + 0.33*multiply1(w_A1, d_fx, 3);
-		}
-	}
-	else {
-		return Temp_metrics::flag_rsaw;
-	}
-	
-	if (Score_fx > Score_lte  ) {
-		Temp_metrics::flag_rsaw = TRUE;
-		return Temp_metrics::flag_rsaw;
-	}
-	else {
-		Temp_metrics::flag_rsaw = FALSE;
-		return Temp_metrics::flag_rsaw;
-	}
-}
-//M:
-//N:
-//K:һҲһ1*3 3*2   M= 1 N= 2 K=3
-static double** multiply(double A[][3], double B[][4],int M,int N,int K) {  
-	double **C = new double*[M];
-	for (int i = 0; i < M; i++)
-		C[i] = new double[N];
-	for (int m = 0; m < M; m++)
-		for (int n = 0; n < N; n++) {
-			C[m][n] = 0;
-			for (int k = 0; k < K; k++)
-				C[m][n] += A[m][k] * B[k][n];
-		}
-	return C;
-};
-
-//M:
-//N:
-//K:һҲһ1*3 3*2   M= 1 N= 2 K=3
-static double** multiply(double A[][2], double B[][4], int M, int N, int K) {
-	double **C = new double*[M];
-	for (int i = 0; i < M; i++)
-		C[i] = new double[N];
-	for (int m = 0; m < M; m++) {
-		for (int n = 0; n < N; n++) {
-			C[m][n] = 0;
-			for (int k = 0; k < K; k++) {
-				C[m][n] += A[m][k] * B[k][n];
-			}
-		}
-	}
-	return C;
-};
-
-static double multiply1(double A[1][4], double B[][1], int L) {
-	double C = 0.0;
-	for (int i = 0; i < L; i++){
-		C += A[0][i] * B[i][0];
-	}
-	return C;
-};
-static double** Matrix_tran(double **A) {
-	double **B = new double*[4];
-	for (int i = 0; i < 4; i++)
-		B[i] = new double[1];
-	for (int i = 0; i < 1; i++)
-	{
-		for (int j = 0; j < 4; j++)
-			B[j][i]= A[i][j] ;
-	}
-	return B;
-}
\ No newline at end of file
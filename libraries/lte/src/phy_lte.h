@@ -162,31 +162,6 @@ class LteExponentialMean;
 #define PHY_LTE_DEFAULT_FILTER_COEF_RSRP                    4
 #define PHY_LTE_DEFAULT_FILTER_COEF_RSRQ                    4
 
-// add by hjxstorage nodeid rxpower
-class Temp_rxpower
-{
-public:
-	static double RSS[10][2];
-	static Int64  temp_time[10][2];
-protected:
-private:
-};
-class Temp_metrics
-{
-public:
-	static double delay_lte[12];
-	static double delay_fx[12];
-	static double jet_lte[12];
-	static double jet_fx[12];
-	static int index;
-	static Int64  store_time;
-	static Int64  interval;
-	static BOOL flag_rsaw;
-	static BOOL flag_xd;
-	static int sizeps;   //ÿappdataг
-protected:
-private:
-};
 class Temp_MeasReport
 {
 public:
@@ -0,0 +1,1111 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <map>
+#include <set>
+
+#include "api.h"
+#include "app_stats_store.h"
+#include "xd_handover_decision.h"
+
+// Attenuation of the delay and jitter utilities, per millisecond
+#define XD_DELAY_DECAY              0.0139
+#define XD_JITTER_DECAY             0.0277
+
+// Offset from dBm to dB above 1 pW, so that RSS values are positive
+#define XD_RSS_OFFSET_dB            120.0
+
+// Attributes measured per session and summed up per network
+#define XD_NUM_NETWORK_ATTRIBUTES   3 // delay, jitter, throughput
+
+struct XdHandoverConfig
+{
+    XdDecisionAlgorithm algorithm;
+    clocktype decisionInterval;
+    clocktype predictionInterval;
+
+    double attributeWeights[XD_NUM_SERVICE_CLASSES][XD_NUM_ATTRIBUTES];
+    double timeWeights[XD_GREY_HORIZON + 1];
+    double incrementWeights[XD_GREY_HORIZON];
+    double stateWeight;
+    double capacity[XD_NUM_NETWORKS];
+
+    std::set<NodeId> ueNodes;
+    std::map<NodeId, XdAccessNetwork> destinationNetwork;
+};
+
+// Sums of the records of a session, or of a network, in one interval
+struct XdIntervalSums
+{
+    double throughput;
+    double maxDelay;
+    double maxJitter;
+    int numRecords;
+};
+
+struct XdSessionState
+{
+    NodeId ueId;                // 0 if the session has no dual mode UE
+    int network;                // network if ueId is 0, -1 if not counted
+    XdServiceClass serviceClass;
+
+    XdIntervalSums sums;        // current interval
+    Int64 lastInterval;         // last closed interval with records
+
+    // Ring of the last XD_GREY_WINDOW intervals with records and the
+    // grey model predictions from that ring
+    double history[XD_NUM_NETWORK_ATTRIBUTES][XD_GREY_WINDOW];
+    int numHistory;
+    int nextHistory;
+    double predicted[XD_NUM_NETWORK_ATTRIBUTES][XD_GREY_HORIZON];
+};
+
+struct XdUeState
+{
+    XdAccessNetwork network;
+    double currentRss[XD_NUM_NETWORKS];
+
+    double rss[XD_NUM_NETWORKS][XD_GREY_WINDOW]; // ring, per interval
+    int numRssSamples;
+    int nextRssSample;
+    Int64 lastSampledInterval;
+
+    XdServiceClass serviceClass;
+    clocktype lastDecisionTime;
+    clocktype lastPredictionTime;
+    BOOL preferFx;
+};
+
+typedef std::map<std::pair<int, int>, XdSessionState> XdSessionMap;
+typedef std::map<NodeId, XdUeState> XdUeMap;
+
+struct XdHandoverEngine
+{
+    BOOL isInitialized;
+    XdHandoverConfig config;
+
+    clocktype intervalStart;
+
+    // Closed intervals with records: their number, and the sessions of
+    // the last one summed up per network, as measured and as predicted
+    Int64 numIntervals;
+    XdIntervalSums last[XD_NUM_NETWORKS];
+    double predicted[XD_NUM_NETWORKS][XD_NUM_NETWORK_ATTRIBUTES]
+                    [XD_GREY_HORIZON];
+
+    XdSessionMap sessions;
+    XdUeMap ues;
+};
+
+static XdHandoverEngine xdEngine;
+
+static void XdHandoverAddRecord(const APPStatsNew& record);
+
+// /**
+// FUNCTION   :: XdHandoverReadWeights
+// LAYER      :: PHY
+// PURPOSE    :: Read a list of non-negative weights
+// PARAMETERS ::
+// + nodeInput     : const NodeInput* : Pointer to node input
+// + parameterName : const char*      : parameter
+// + weights       : double*          : weights, unchanged if not found
+// + numWeights    : int              : number of weights
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverReadWeights(
+    const NodeInput* nodeInput,
+    const char* parameterName,
+    double* weights,
+    int numWeights)
+{
+    BOOL wasFound = FALSE;
+    char buf[MAX_STRING_LENGTH];
+
+    IO_ReadString(ANY_NODEID,
+                  ANY_ADDRESS,
+                  nodeInput,
+                  parameterName,
+                  &wasFound,
+                  buf);
+    if (!wasFound)
+    {
+        return;
+    }
+
+    char* p = buf;
+    for (int i = 0; i < numWeights; i++)
+    {
+        char* end = NULL;
+        double weight = strtod(p, &end);
+        if (end == p || weight < 0.0)
+        {
+            ERROR_ReportErrorArgs(
+                "%s must be a list of %d non-negative weights",
+                parameterName, numWeights);
+        }
+        weights[i] = weight;
+        p = end;
+    }
+}
+
+// /**
+// FUNCTION   :: XdHandoverReadNodeList
+// LAYER      :: PHY
+// PURPOSE    :: Read a list of node IDs
+// PARAMETERS ::
+// + nodeInput     : const NodeInput* : Pointer to node input
+// + parameterName : const char*      : parameter
+// + defaultList   : const char*      : list used if not found
+// + nodes         : std::set<NodeId>& : filled with the nodes
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverReadNodeList(
+    const NodeInput* nodeInput,
+    const char* parameterName,
+    const char* defaultList,
+    std::set<NodeId>& nodes)
+{
+    BOOL wasFound = FALSE;
+    char buf[MAX_STRING_LENGTH];
+
+    IO_ReadString(ANY_NODEID,
+                  ANY_ADDRESS,
+                  nodeInput,
+                  parameterName,
+                  &wasFound,
+                  buf);
+    if (!wasFound)
+    {
+        strcpy(buf, defaultList);
+    }
+
+    char* p = buf;
+    while (TRUE)
+    {
+        char* end = NULL;
+        unsigned long nodeId = strtoul(p, &end, 10);
+        if (end == p)
+        {
+            break;
+        }
+        nodes.insert((NodeId)nodeId);
+        p = end;
+    }
+    if (*p != '\0' && strspn(p, " \t\r\n") != strlen(p))
+    {
+        ERROR_ReportErrorArgs("%s must be a list of node IDs",
+                              parameterName);
+    }
+}
+
+void XdHandoverInit(const NodeInput* nodeInput)
+{
+    static const double defaultWeights
+        [XD_NUM_SERVICE_CLASSES][XD_NUM_ATTRIBUTES] =
+    {
+        { 0.5, 0.3358,  0.1327,  0.03145 }, // conversational
+        { 0.5, 0.05475, 0.2908,  0.1545  }, // streaming
+        { 0.5, 0.0744,  0.0329,  0.3927  }, // interactive
+        { 0.5, 0.04545, 0.04545, 0.4091  }  // background
+    };
+    static const char* weightParameters[XD_NUM_SERVICE_CLASSES] =
+    {
+        "XD-HANDOVER-WEIGHTS-CONVERSATIONAL",
+        "XD-HANDOVER-WEIGHTS-STREAMING",
+        "XD-HANDOVER-WEIGHTS-INTERACTIVE",
+        "XD-HANDOVER-WEIGHTS-BACKGROUND"
+    };
+
+    if (xdEngine.isInitialized)
+    {
+        return;
+    }
+    xdEngine.isInitialized = TRUE;
+
+    XdHandoverConfig& config = xdEngine.config;
+    BOOL wasFound = FALSE;
+    char buf[MAX_STRING_LENGTH];
+
+    config.algorithm = XD_ALGORITHM_GREY_SAW;
+    IO_ReadString(ANY_NODEID,
+                  ANY_ADDRESS,
+                  nodeInput,
+                  "XD-HANDOVER-ALGORITHM",
+                  &wasFound,
+                  buf);
+    if (wasFound)
+    {
+        if (strcmp(buf, "RSS") == 0)
+        {
+            config.algorithm = XD_ALGORITHM_RSS;
+        }
+        else if (strcmp(buf, "SAW") == 0)
+        {
+            config.algorithm = XD_ALGORITHM_SAW;
+        }
+        else if (strcmp(buf, "GREY-SAW") == 0)
+        {
+            config.algorithm = XD_ALGORITHM_GREY_SAW;
+        }
+        else
+        {
+            ERROR_ReportErrorArgs(
+                "Unknown XD-HANDOVER-ALGORITHM %s, "
+                "must be RSS, SAW or GREY-SAW", buf);
+        }
+    }
+
+    config.decisionInterval = SECOND;
+    IO_ReadTime(ANY_NODEID,
+                ANY_ADDRESS,
+                nodeInput,
+                "XD-HANDOVER-DECISION-INTERVAL",
+                &wasFound,
+                &config.decisionInterval);
+    if (config.decisionInterval <= 0)
+    {
+        ERROR_ReportError("XD-HANDOVER-DECISION-INTERVAL must be positive");
+    }
+
+    config.predictionInterval = 3 * SECOND;
+    IO_ReadTime(ANY_NODEID,
+                ANY_ADDRESS,
+                nodeInput,
+                "XD-HANDOVER-PREDICTION-INTERVAL",
+                &wasFound,
+                &config.predictionInterval);
+
+    for (int c = 0; c < XD_NUM_SERVICE_CLASSES; c++)
+    {
+        memcpy(config.attributeWeights[c],
+               defaultWeights[c],
+               sizeof(config.attributeWeights[c]));
+        XdHandoverReadWeights(nodeInput,
+                              weightParameters[c],
+                              config.attributeWeights[c],
+                              XD_NUM_ATTRIBUTES);
+    }
+
+    config.timeWeights[0] = 0.5;
+    config.timeWeights[1] = 0.3333;
+    config.timeWeights[2] = 0.1667;
+    XdHandoverReadWeights(nodeInput,
+                          "XD-HANDOVER-TIME-WEIGHTS",
+                          config.timeWeights,
+                          XD_GREY_HORIZON + 1);
+
+    config.incrementWeights[0] = 0.6667;
+    config.incrementWeights[1] = 0.3333;
+    XdHandoverReadWeights(nodeInput,
+                          "XD-HANDOVER-INCREMENT-WEIGHTS",
+                          config.incrementWeights,
+                          XD_GREY_HORIZON);
+
+    config.stateWeight = 0.67;
+    IO_ReadDouble(ANY_NODEID,
+                  ANY_ADDRESS,
+                  nodeInput,
+                  "XD-HANDOVER-STATE-WEIGHT",
+                  &wasFound,
+                  &config.stateWeight);
+    if (config.stateWeight < 0.0 || config.stateWeight > 1.0)
+    {
+        ERROR_ReportError("XD-HANDOVER-STATE-WEIGHT must be in [0, 1]");
+    }
+
+    config.capacity[XD_NETWORK_LTE] = 50400000.0;
+    IO_ReadDouble(ANY_NODEID,
+                  ANY_ADDRESS,
+                  nodeInput,
+                  "XD-HANDOVER-LTE-CAPACITY",
+                  &wasFound,
+                  &config.capacity[XD_NETWORK_LTE]);
+    config.capacity[XD_NETWORK_FX] = 165000000.0;
+    IO_ReadDouble(ANY_NODEID,
+                  ANY_ADDRESS,
+                  nodeInput,
+                  "XD-HANDOVER-FX-CAPACITY",
+                  &wasFound,
+                  &config.capacity[XD_NETWORK_FX]);
+    if (config.capacity[XD_NETWORK_LTE] <= 0.0
+        || config.capacity[XD_NETWORK_FX] <= 0.0)
+    {
+        ERROR_ReportError("XD-HANDOVER capacities must be positive");
+    }
+
+    XdHandoverReadNodeList(nodeInput,
+                           "XD-HANDOVER-UE-NODES",
+                           "2",
+                           config.ueNodes);
+
+    // Sessions without a dual mode UE are counted on the network of
+    // their destination
+    std::set<NodeId> destinations;
+    std::set<NodeId>::const_iterator it;
+    XdHandoverReadNodeList(nodeInput,
+                           "XD-HANDOVER-LTE-DESTINATIONS",
+                           "10",
+                           destinations);
+    for (it = destinations.begin(); it != destinations.end(); it++)
+    {
+        config.destinationNetwork[*it] = XD_NETWORK_LTE;
+    }
+    destinations.clear();
+    XdHandoverReadNodeList(nodeInput,
+                           "XD-HANDOVER-FX-DESTINATIONS",
+                           "4",
+                           destinations);
+    for (it = destinations.begin(); it != destinations.end(); it++)
+    {
+        config.destinationNetwork[*it] = XD_NETWORK_FX;
+    }
+
+    xdEngine.intervalStart = 0;
+    xdEngine.numIntervals = 0;
+    memset(xdEngine.last, 0, sizeof(xdEngine.last));
+    memset(xdEngine.predicted, 0, sizeof(xdEngine.predicted));
+
+    g_APPStatsStore.SetListener(XdHandoverAddRecord);
+}
+
+BOOL XdHandoverIsDualModeUe(NodeId nodeId)
+{
+    return xdEngine.config.ueNodes.count(nodeId) > 0;
+}
+
+// /**
+// FUNCTION   :: XdHandoverServiceClass
+// LAYER      :: PHY
+// PURPOSE    :: Traffic class of an application
+// PARAMETERS ::
+// + serviceType : const char* : application name
+// RETURN     :: XdServiceClass : class
+// **/
+static XdServiceClass XdHandoverServiceClass(const char* serviceType)
+{
+    if (serviceType == NULL)
+    {
+        return XD_SERVICE_NONE;
+    }
+    if (strcmp(serviceType, "VOIP") == 0)
+    {
+        return XD_SERVICE_CONVERSATIONAL;
+    }
+    if (strcmp(serviceType, "VBR") == 0)
+    {
+        return XD_SERVICE_STREAMING;
+    }
+    if (strcmp(serviceType, "CBR") == 0)
+    {
+        return XD_SERVICE_INTERACTIVE;
+    }
+    if (strcmp(serviceType, "TRAFFIC_GEN") == 0
+        || strcmp(serviceType, "FTP_GEN") == 0)
+    {
+        return XD_SERVICE_BACKGROUND;
+    }
+    return XD_SERVICE_NONE;
+}
+
+// /**
+// FUNCTION   :: XdHandoverGetUe
+// LAYER      :: PHY
+// PURPOSE    :: State of a UE, created on first use
+// PARAMETERS ::
+// + ueId      : NodeId : UE
+// RETURN     :: XdUeState& : state
+// **/
+static XdUeState& XdHandoverGetUe(NodeId ueId)
+{
+    XdUeMap::iterator it = xdEngine.ues.find(ueId);
+
+    if (it == xdEngine.ues.end())
+    {
+        XdUeState ue;
+        memset(&ue, 0, sizeof(ue));
+        ue.network = XD_NETWORK_LTE;
+        ue.lastSampledInterval = -1;
+        ue.serviceClass = XD_SERVICE_NONE;
+        ue.preferFx = FALSE;
+        it = xdEngine.ues.insert(std::make_pair(ueId, ue)).first;
+    }
+    return it->second;
+}
+
+void XdHandoverReportRss(
+    NodeId ueId,
+    XdAccessNetwork network,
+    double rss_dBm)
+{
+    XdHandoverGetUe(ueId).currentRss[network] = rss_dBm;
+}
+
+void XdHandoverSetUeNetwork(NodeId ueId, XdAccessNetwork network)
+{
+    XdHandoverGetUe(ueId).network = network;
+}
+
+XdAccessNetwork XdHandoverGetUeNetwork(NodeId ueId)
+{
+    XdUeMap::const_iterator it = xdEngine.ues.find(ueId);
+
+    if (it == xdEngine.ues.end())
+    {
+        return XD_NETWORK_LTE;
+    }
+    return it->second.network;
+}
+
+// /**
+// FUNCTION   :: XdHandoverGetSession
+// LAYER      :: PHY
+// PURPOSE    :: State of the session of a record, classified on first use
+// PARAMETERS ::
+// + record    : const APPStatsNew& : record
+// RETURN     :: XdSessionState& : state
+// **/
+static XdSessionState& XdHandoverGetSession(const APPStatsNew& record)
+{
+    std::pair<int, int> key(record.SrcId, record.DestId);
+    XdSessionMap::iterator it = xdEngine.sessions.find(key);
+
+    if (it == xdEngine.sessions.end())
+    {
+        const XdHandoverConfig& config = xdEngine.config;
+        XdSessionState session;
+
+        memset(&session, 0, sizeof(session));
+        session.lastInterval = -1;
+        session.ueId = 0;
+        session.network = -1;
+        session.serviceClass = XdHandoverServiceClass(record.Servicetype);
+
+        if (XdHandoverIsDualModeUe((NodeId)record.SrcId))
+        {
+            session.ueId = (NodeId)record.SrcId;
+        }
+        else if (XdHandoverIsDualModeUe((NodeId)record.DestId))
+        {
+            session.ueId = (NodeId)record.DestId;
+        }
+        else
+        {
+            std::map<NodeId, XdAccessNetwork>::const_iterator dest =
+                config.destinationNetwork.find((NodeId)record.DestId);
+            if (dest != config.destinationNetwork.end())
+            {
+                session.network = dest->second;
+            }
+        }
+        it = xdEngine.sessions.insert(std::make_pair(key, session)).first;
+    }
+    return it->second;
+}
+
+// /**
+// FUNCTION   :: XdHandoverAddRecord
+// LAYER      :: PHY
+// PURPOSE    :: Fold an application record into the current interval.
+//               Called by g_APPStatsStore as each record is added.
+// PARAMETERS ::
+// + record    : const APPStatsNew& : record
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverAddRecord(const APPStatsNew& record)
+{
+    XdSessionState& session = XdHandoverGetSession(record);
+
+    if (session.ueId != 0)
+    {
+        if (session.serviceClass != XD_SERVICE_NONE)
+        {
+            XdHandoverGetUe(session.ueId).serviceClass =
+                session.serviceClass;
+        }
+    }
+    else if (session.network < 0)
+    {
+        return;
+    }
+
+    XdIntervalSums& sums = session.sums;
+    sums.throughput += record.AppThroughput;
+    sums.maxDelay = MAX(sums.maxDelay, record.AppDelay);
+    sums.maxJitter = MAX(sums.maxJitter, record.AppJet);
+    sums.numRecords++;
+}
+
+// /**
+// FUNCTION   :: XdHandoverGreyPredict
+// LAYER      :: PHY
+// PURPOSE    :: Fit a GM(1,1) grey model to a series and predict the
+//               values that follow it.  A series the model can't be
+//               fitted to is predicted to stay at its last value.
+// PARAMETERS ::
+// + x         : const double* : series, oldest first
+// + n         : int           : length of the series
+// + forecast  : double*       : filled with the predictions
+// + horizon   : int           : number of predictions
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverGreyPredict(
+    const double* x,
+    int n,
+    double* forecast,
+    int horizon)
+{
+    // Least squares fit of x[k] = -a * z[k] + b, where z[k] is the mean
+    // of the accumulated series at k - 1 and k
+    double sumZ = 0.0;
+    double sumZZ = 0.0;
+    double sumX = 0.0;
+    double sumZX = 0.0;
+    double accumulated = x[0];
+    int m = n - 1;
+
+    for (int k = 1; k < n; k++)
+    {
+        double z = accumulated + 0.5 * x[k];
+        accumulated += x[k];
+        sumZ += z;
+        sumZZ += z * z;
+        sumX += x[k];
+        sumZX += z * x[k];
+    }
+
+    double det = m * sumZZ - sumZ * sumZ;
+    double a = 0.0;
+    double b = 0.0;
+    if (det != 0.0)
+    {
+        a = (sumZ * sumX - m * sumZX) / det;
+        b = (sumZZ * sumX - sumZ * sumZX) / det;
+    }
+    if (det == 0.0 || fabs(a) < 1.0e-12)
+    {
+        for (int h = 0; h < horizon; h++)
+        {
+            forecast[h] = x[n - 1];
+        }
+        return;
+    }
+
+    // Accumulated series x1(k) = (x[0] - b / a) * exp(-a * k) + b / a,
+    // restored by differencing
+    double c = x[0] - b / a;
+    for (int h = 0; h < horizon; h++)
+    {
+        int k = n + h;
+        forecast[h] = c * (exp(-a * k) - exp(-a * (k - 1)));
+    }
+}
+
+// /**
+// FUNCTION   :: XdHandoverSessionNetwork
+// LAYER      :: PHY
+// PURPOSE    :: Network a session is counted on
+// PARAMETERS ::
+// + session   : const XdSessionState& : session
+// RETURN     :: int : XdAccessNetwork, -1 if not counted
+// **/
+static int XdHandoverSessionNetwork(const XdSessionState& session)
+{
+    if (session.ueId != 0)
+    {
+        return XdHandoverGetUeNetwork(session.ueId);
+    }
+    return session.network;
+}
+
+// /**
+// FUNCTION   :: XdHandoverCloseSession
+// LAYER      :: PHY
+// PURPOSE    :: Add the current interval of a session to its history and
+//               predict the intervals that follow
+// PARAMETERS ::
+// + session   : XdSessionState& : session with records in the interval
+// + interval  : Int64           : index of the interval
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverCloseSession(XdSessionState& session, Int64 interval)
+{
+    int slot = session.nextHistory;
+    int a;
+
+    session.history[0][slot] = session.sums.maxDelay;
+    session.history[1][slot] = session.sums.maxJitter;
+    session.history[2][slot] = session.sums.throughput;
+    session.nextHistory = (slot + 1) % XD_GREY_WINDOW;
+    session.numHistory = MIN(session.numHistory + 1, XD_GREY_WINDOW);
+    session.lastInterval = interval;
+
+    if (xdEngine.config.algorithm != XD_ALGORITHM_GREY_SAW)
+    {
+        return;
+    }
+
+    for (a = 0; a < XD_NUM_NETWORK_ATTRIBUTES; a++)
+    {
+        if (session.numHistory < XD_GREY_WINDOW)
+        {
+            // Too short to fit, expected to stay as it is
+            for (int h = 0; h < XD_GREY_HORIZON; h++)
+            {
+                session.predicted[a][h] = session.history[a][slot];
+            }
+            continue;
+        }
+
+        double series[XD_GREY_WINDOW];
+        for (int k = 0; k < XD_GREY_WINDOW; k++)
+        {
+            series[k] = session.history[a]
+                [(session.nextHistory + k) % XD_GREY_WINDOW];
+        }
+        XdHandoverGreyPredict(series,
+                              XD_GREY_WINDOW,
+                              session.predicted[a],
+                              XD_GREY_HORIZON);
+    }
+}
+
+// /**
+// FUNCTION   :: XdHandoverCloseInterval
+// LAYER      :: PHY
+// PURPOSE    :: End the current interval, add it to the history of the
+//               sessions and sum the sessions up per network
+// PARAMETERS ::
+// + now       : clocktype : current simulation time
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverCloseInterval(clocktype now)
+{
+    XdSessionMap::iterator it;
+    BOOL hasRecords = FALSE;
+
+    xdEngine.intervalStart = now;
+    for (it = xdEngine.sessions.begin();
+         it != xdEngine.sessions.end() && !hasRecords;
+         it++)
+    {
+        hasRecords = it->second.sums.numRecords > 0;
+    }
+    if (!hasRecords)
+    {
+        // No traffic, the history is left as it is
+        return;
+    }
+
+    Int64 interval = xdEngine.numIntervals++;
+    memset(xdEngine.last, 0, sizeof(xdEngine.last));
+    memset(xdEngine.predicted, 0, sizeof(xdEngine.predicted));
+
+    for (it = xdEngine.sessions.begin();
+         it != xdEngine.sessions.end();
+         it++)
+    {
+        XdSessionState& session = it->second;
+
+        if (session.sums.numRecords == 0)
+        {
+            continue;
+        }
+        XdHandoverCloseSession(session, interval);
+
+        // Counted on the network it is on at the end of the interval
+        int network = XdHandoverSessionNetwork(session);
+        if (network >= 0)
+        {
+            XdIntervalSums& sums = xdEngine.last[network];
+            sums.throughput += session.sums.throughput;
+            sums.maxDelay = MAX(sums.maxDelay, session.sums.maxDelay);
+            sums.maxJitter = MAX(sums.maxJitter, session.sums.maxJitter);
+            sums.numRecords += session.sums.numRecords;
+
+            double (*predicted)[XD_GREY_HORIZON] =
+                xdEngine.predicted[network];
+            for (int h = 0; h < XD_GREY_HORIZON; h++)
+            {
+                predicted[0][h] = MAX(predicted[0][h],
+                                      session.predicted[0][h]);
+                predicted[1][h] = MAX(predicted[1][h],
+                                      session.predicted[1][h]);
+                predicted[2][h] += session.predicted[2][h];
+            }
+        }
+        memset(&session.sums, 0, sizeof(session.sums));
+    }
+}
+
+// /**
+// FUNCTION   :: XdHandoverIngest
+// LAYER      :: PHY
+// PURPOSE    :: End the current interval if it is over.  The records
+//               were already folded into it by XdHandoverAddRecord.
+// PARAMETERS ::
+// + now       : clocktype : current simulation time
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverIngest(clocktype now)
+{
+    if (now - xdEngine.intervalStart >= xdEngine.config.decisionInterval)
+    {
+        XdHandoverCloseInterval(now);
+    }
+}
+
+// /**
+// FUNCTION   :: XdHandoverNormalize
+// LAYER      :: PHY
+// PURPOSE    :: Turn the attribute values of both networks into
+//               utilities, larger is better
+// PARAMETERS ::
+// + attribute : int     : XdAttribute
+// + values    : const double* : value per network
+// + utilities : double* : utility per network
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverNormalize(
+    int attribute,
+    const double* values,
+    double* utilities)
+{
+    int n;
+
+    switch (attribute)
+    {
+        case XD_ATTRIBUTE_DELAY:
+        {
+            for (n = 0; n < XD_NUM_NETWORKS; n++)
+            {
+                utilities[n] = exp(-XD_DELAY_DECAY * values[n]);
+            }
+            break;
+        }
+        case XD_ATTRIBUTE_JITTER:
+        {
+            for (n = 0; n < XD_NUM_NETWORKS; n++)
+            {
+                utilities[n] = exp(-XD_JITTER_DECAY * values[n]);
+            }
+            break;
+        }
+        default:
+        {
+            // Share of the sum over both networks
+            double total = 0.0;
+            for (n = 0; n < XD_NUM_NETWORKS; n++)
+            {
+                total += fabs(values[n]);
+            }
+            for (n = 0; n < XD_NUM_NETWORKS; n++)
+            {
+                utilities[n] = total > 0.0 ? values[n] / total : 0.0;
+            }
+            break;
+        }
+    }
+}
+
+// /**
+// FUNCTION   :: XdHandoverFillRow
+// LAYER      :: PHY
+// PURPOSE    :: Attribute values of both networks at one time
+// PARAMETERS ::
+// + delay      : const double* : delay per network
+// + jitter     : const double* : jitter per network
+// + throughput : const double* : throughput per network
+// + rss_dBm    : const double* : RSS per network
+// + row        : double[][XD_NUM_ATTRIBUTES] : filled per network
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverFillRow(
+    const double* delay,
+    const double* jitter,
+    const double* throughput,
+    const double* rss_dBm,
+    double row[XD_NUM_NETWORKS][XD_NUM_ATTRIBUTES])
+{
+    for (int n = 0; n < XD_NUM_NETWORKS; n++)
+    {
+        row[n][XD_ATTRIBUTE_RSS] = rss_dBm[n] + XD_RSS_OFFSET_dB;
+        row[n][XD_ATTRIBUTE_DELAY] = delay[n];
+        row[n][XD_ATTRIBUTE_JITTER] = jitter[n];
+        row[n][XD_ATTRIBUTE_THROUGHPUT] =
+            1.0 - throughput[n] / xdEngine.config.capacity[n];
+    }
+}
+
+// /**
+// FUNCTION   :: XdHandoverNormalizeRow
+// LAYER      :: PHY
+// PURPOSE    :: Normalize all attributes of a row
+// PARAMETERS ::
+// + row       : double[][XD_NUM_ATTRIBUTES] : values, per network
+// + utilities : double[][XD_NUM_ATTRIBUTES] : utilities, per network
+// RETURN     :: void : NULL
+// **/
+static void XdHandoverNormalizeRow(
+    double row[XD_NUM_NETWORKS][XD_NUM_ATTRIBUTES],
+    double utilities[XD_NUM_NETWORKS][XD_NUM_ATTRIBUTES])
+{
+    for (int a = 0; a < XD_NUM_ATTRIBUTES; a++)
+    {
+        double values[XD_NUM_NETWORKS];
+        double normalized[XD_NUM_NETWORKS];
+        int n;
+
+        for (n = 0; n < XD_NUM_NETWORKS; n++)
+        {
+            values[n] = row[n][a];
+        }
+        XdHandoverNormalize(a, values, normalized);
+        for (n = 0; n < XD_NUM_NETWORKS; n++)
+        {
+            utilities[n][a] = normalized[n];
+        }
+    }
+}
+
+// /**
+// FUNCTION   :: XdHandoverSawDecision
+// LAYER      :: PHY
+// PURPOSE    :: SAW over the attributes of the last interval
+// PARAMETERS ::
+// + ue        : const XdUeState& : UE
+// + rss_dBm   : const double*    : current RSS per network
+// RETURN     :: BOOL : TRUE if FX is preferred
+// **/
+static BOOL XdHandoverSawDecision(
+    const XdUeState& ue,
+    const double* rss_dBm)
+{
+    const double* weights = xdEngine.config.attributeWeights[ue.serviceClass];
+    double delay[XD_NUM_NETWORKS];
+    double jitter[XD_NUM_NETWORKS];
+    double throughput[XD_NUM_NETWORKS];
+    double row[XD_NUM_NETWORKS][XD_NUM_ATTRIBUTES];
+    double utilities[XD_NUM_NETWORKS][XD_NUM_ATTRIBUTES];
+    double score[XD_NUM_NETWORKS];
+    int n;
+
+    for (n = 0; n < XD_NUM_NETWORKS; n++)
+    {
+        delay[n] = xdEngine.last[n].maxDelay;
+        jitter[n] = xdEngine.last[n].maxJitter;
+        throughput[n] = xdEngine.last[n].throughput;
+    }
+    XdHandoverFillRow(delay, jitter, throughput, rss_dBm, row);
+    XdHandoverNormalizeRow(row, utilities);
+
+    for (n = 0; n < XD_NUM_NETWORKS; n++)
+    {
+        score[n] = 0.0;
+        for (int a = 0; a < XD_NUM_ATTRIBUTES; a++)
+        {
+            score[n] += weights[a] * utilities[n][a];
+        }
+    }
+    return score[XD_NETWORK_FX] > score[XD_NETWORK_LTE];
+}
+
+// /**
+// FUNCTION   :: XdHandoverGreySawDecision
+// LAYER      :: PHY
+// PURPOSE    :: SAW over the current and predicted attributes and their
+//               relative increments
+// PARAMETERS ::
+// + ue        : const XdUeState& : UE
+// + rss_dBm   : const double*    : current RSS per network
+// RETURN     :: BOOL : TRUE if FX is preferred
+// **/
+static BOOL XdHandoverGreySawDecision(
+    const XdUeState& ue,
+    const double* rss_dBm)
+{
+    const XdHandoverConfig& config = xdEngine.config;
+    const double* weights = config.attributeWeights[ue.serviceClass];
+
+    // Decision matrix, t = 0 is the last interval, t > 0 predicted
+    double values[XD_GREY_HORIZON + 1][XD_NUM_NETWORKS][XD_NUM_ATTRIBUTES];
+    double utilities[XD_GREY_HORIZON + 1][XD_NUM_NETWORKS]
+                    [XD_NUM_ATTRIBUTES];
+    double increments[XD_GREY_HORIZON][XD_NUM_NETWORKS][XD_NUM_ATTRIBUTES];
+    double incrementUtilities[XD_GREY_HORIZON][XD_NUM_NETWORKS]
+                             [XD_NUM_ATTRIBUTES];
+    double rssPredicted[XD_NUM_NETWORKS][XD_GREY_HORIZON];
+    int t;
+    int n;
+    int a;
+
+    for (n = 0; n < XD_NUM_NETWORKS; n++)
+    {
+        double series[XD_GREY_WINDOW];
+        for (int k = 0; k < XD_GREY_WINDOW; k++)
+        {
+            series[k] = ue.rss[n][(ue.nextRssSample + k) % XD_GREY_WINDOW];
+        }
+        XdHandoverGreyPredict(series,
+                              XD_GREY_WINDOW,
+                              rssPredicted[n],
+                              XD_GREY_HORIZON);
+    }
+
+    for (t = 0; t <= XD_GREY_HORIZON; t++)
+    {
+        double delay[XD_NUM_NETWORKS];
+        double jitter[XD_NUM_NETWORKS];
+        double throughput[XD_NUM_NETWORKS];
+        double rss[XD_NUM_NETWORKS];
+
+        for (n = 0; n < XD_NUM_NETWORKS; n++)
+        {
+            if (t == 0)
+            {
+                delay[n] = xdEngine.last[n].maxDelay;
+                jitter[n] = xdEngine.last[n].maxJitter;
+                throughput[n] = xdEngine.last[n].throughput;
+                rss[n] = rss_dBm[n];
+            }
+            else
+            {
+                delay[n] = xdEngine.predicted[n][0][t - 1];
+                jitter[n] = xdEngine.predicted[n][1][t - 1];
+                throughput[n] = xdEngine.predicted[n][2][t - 1];
+                rss[n] = rssPredicted[n][t - 1];
+            }
+        }
+        XdHandoverFillRow(delay, jitter, throughput, rss, values[t]);
+        XdHandoverNormalizeRow(values[t], utilities[t]);
+    }
+
+    for (t = 0; t < XD_GREY_HORIZON; t++)
+    {
+        for (n = 0; n < XD_NUM_NETWORKS; n++)
+        {
+            for (a = 0; a < XD_NUM_ATTRIBUTES; a++)
+            {
+                double from = values[t][n][a];
+                double delta = values[t + 1][n][a] - from;
+                increments[t][n][a] =
+                    from == 0.0 ? delta : delta / fabs(from);
+            }
+        }
+        XdHandoverNormalizeRow(increments[t], incrementUtilities[t]);
+    }
+
+    double score[XD_NUM_NETWORKS];
+    for (n = 0; n < XD_NUM_NETWORKS; n++)
+    {
+        double state = 0.0;
+        double trend = 0.0;
+
+        for (a = 0; a < XD_NUM_ATTRIBUTES; a++)
+        {
+            double m = 0.0;
+            double d = 0.0;
+            for (t = 0; t <= XD_GREY_HORIZON; t++)
+            {
+                m += config.timeWeights[t] * utilities[t][n][a];
+            }
+            for (t = 0; t < XD_GREY_HORIZON; t++)
+            {
+                d += config.incrementWeights[t]
+                     * incrementUtilities[t][n][a];
+            }
+            state += weights[a] * m;
+            trend += weights[a] * d;
+        }
+        score[n] = config.stateWeight * state
+                   + (1.0 - config.stateWeight) * trend;
+    }
+    return score[XD_NETWORK_FX] > score[XD_NETWORK_LTE];
+}
+
+BOOL XdHandoverEvaluate(NodeId ueId, clocktype now)
+{
+    ERROR_Assert(xdEngine.isInitialized,
+                 "XdHandoverInit has not been called");
+
+    XdHandoverIngest(now);
+
+    XdUeState& ue = XdHandoverGetUe(ueId);
+    if (now - ue.lastDecisionTime < xdEngine.config.decisionInterval)
+    {
+        return ue.preferFx;
+    }
+    ue.lastDecisionTime = now;
+
+    const double* rss_dBm = ue.currentRss;
+
+    // One RSS sample per closed interval, next to the network history
+    if (xdEngine.numIntervals > ue.lastSampledInterval)
+    {
+        for (int n = 0; n < XD_NUM_NETWORKS; n++)
+        {
+            ue.rss[n][ue.nextRssSample] = rss_dBm[n];
+        }
+        ue.nextRssSample = (ue.nextRssSample + 1) % XD_GREY_WINDOW;
+        ue.numRssSamples = MIN(ue.numRssSamples + 1, XD_GREY_WINDOW);
+        ue.lastSampledInterval = xdEngine.numIntervals;
+    }
+
+    switch (xdEngine.config.algorithm)
+    {
+        case XD_ALGORITHM_RSS:
+        {
+            ue.preferFx =
+                rss_dBm[XD_NETWORK_LTE] < rss_dBm[XD_NETWORK_FX];
+            break;
+        }
+        case XD_ALGORITHM_SAW:
+        {
+            if (ue.serviceClass == XD_SERVICE_NONE
+                || xdEngine.numIntervals == 0)
+            {
+                ue.preferFx = FALSE;
+                break;
+            }
+            ue.preferFx = XdHandoverSawDecision(ue, rss_dBm);
+            break;
+        }
+        case XD_ALGORITHM_GREY_SAW:
+        {
+            if (xdEngine.numIntervals < XD_GREY_WINDOW
+                || ue.numRssSamples < XD_GREY_WINDOW
+                || now - ue.lastPredictionTime
+                       < xdEngine.config.predictionInterval)
+            {
+                // Keep the last decision until there is enough history
+                break;
+            }
+            ue.lastPredictionTime = now;
+            if (ue.serviceClass == XD_SERVICE_NONE)
+            {
+                ue.preferFx = FALSE;
+                break;
+            }
+            ue.preferFx = XdHandoverGreySawDecision(ue, rss_dBm);
+            break;
+        }
+    }
+    return ue.preferFx;
+}
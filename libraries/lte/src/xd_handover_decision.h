@@ -0,0 +1,180 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Handover decision between the LTE and FX access networks of
+ *          dual mode UEs.
+ *
+ * The application records of g_APPStatsStore are folded, as they
+ * arrive, into per session sums for the current decision interval.
+ * When an interval ends its delay, jitter and throughput are added to a
+ * short history of each session, from which a GM(1,1) grey model
+ * predicts the next intervals of the session.  The sessions are then
+ * summed up per access network, a session counting on the network its
+ * UE is attached to or on the network configured for its destination.
+ * This is done once for all UEs.  Each UE only adds its own RSS, so that
+ * a decision is a fixed number of operations on small stack matrices.
+ *
+ * The PHYs report the RSS of a dual mode UE and the network it is
+ * attached to with XdHandoverReportRss and XdHandoverSetUeNetwork.
+ *
+ * Decision algorithms (XD-HANDOVER-ALGORITHM):
+ *   RSS      - prefer the network with the stronger signal
+ *   SAW      - simple additive weighting of the current attributes
+ *   GREY-SAW - SAW over the current and predicted attributes and their
+ *              increments
+ */
+
+#ifndef XD_HANDOVER_DECISION_H
+#define XD_HANDOVER_DECISION_H
+
+// /**
+// CONSTANT    :: XD_GREY_WINDOW : 7
+// DESCRIPTION :: Number of intervals the grey model is fitted to
+// **/
+#define XD_GREY_WINDOW              7
+
+// /**
+// CONSTANT    :: XD_GREY_HORIZON : 2
+// DESCRIPTION :: Number of intervals predicted by the grey model
+// **/
+#define XD_GREY_HORIZON             2
+
+// /**
+// ENUM        :: XdAccessNetwork
+// DESCRIPTION :: Access networks of a dual mode UE
+// **/
+enum XdAccessNetwork
+{
+    XD_NETWORK_LTE = 0,
+    XD_NETWORK_FX,
+    XD_NUM_NETWORKS // must be last
+};
+
+// /**
+// ENUM        :: XdAttribute
+// DESCRIPTION :: Attributes of an access network in the decision matrix
+// **/
+enum XdAttribute
+{
+    XD_ATTRIBUTE_RSS = 0,
+    XD_ATTRIBUTE_DELAY,
+    XD_ATTRIBUTE_JITTER,
+    XD_ATTRIBUTE_THROUGHPUT,
+    XD_NUM_ATTRIBUTES // must be last
+};
+
+// /**
+// ENUM        :: XdServiceClass
+// DESCRIPTION :: Traffic class of a session, selects the attribute
+//                weights
+// **/
+enum XdServiceClass
+{
+    XD_SERVICE_CONVERSATIONAL = 0,
+    XD_SERVICE_STREAMING,
+    XD_SERVICE_INTERACTIVE,
+    XD_SERVICE_BACKGROUND,
+    XD_NUM_SERVICE_CLASSES, // must be last real class
+    XD_SERVICE_NONE = XD_NUM_SERVICE_CLASSES
+};
+
+// /**
+// ENUM        :: XdDecisionAlgorithm
+// DESCRIPTION :: Handover decision algorithm
+// **/
+enum XdDecisionAlgorithm
+{
+    XD_ALGORITHM_RSS = 0,
+    XD_ALGORITHM_SAW,
+    XD_ALGORITHM_GREY_SAW
+};
+
+// /**
+// FUNCTION   :: XdHandoverInit
+// LAYER      :: PHY
+// PURPOSE    :: Read the handover decision parameters.  Only the first
+//               call has an effect.
+// PARAMETERS ::
+// + nodeInput : const NodeInput* : Pointer to node input
+// RETURN     :: void : NULL
+// **/
+void XdHandoverInit(const NodeInput* nodeInput);
+
+// /**
+// FUNCTION   :: XdHandoverIsDualModeUe
+// LAYER      :: PHY
+// PURPOSE    :: Check if the handover decision is made for a node
+// PARAMETERS ::
+// + nodeId    : NodeId : node
+// RETURN     :: BOOL : TRUE if the node is a dual mode UE
+// **/
+BOOL XdHandoverIsDualModeUe(NodeId nodeId);
+
+// /**
+// FUNCTION   :: XdHandoverReportRss
+// LAYER      :: PHY
+// PURPOSE    :: Record the latest received signal strength of a dual
+//               mode UE on one network
+// PARAMETERS ::
+// + ueId      : NodeId          : dual mode UE
+// + network   : XdAccessNetwork : network the signal was received on
+// + rss_dBm   : double          : received signal strength
+// RETURN     :: void : NULL
+// **/
+void XdHandoverReportRss(
+    NodeId ueId,
+    XdAccessNetwork network,
+    double rss_dBm);
+
+// /**
+// FUNCTION   :: XdHandoverSetUeNetwork
+// LAYER      :: PHY
+// PURPOSE    :: Record the network a dual mode UE is attached to
+// PARAMETERS ::
+// + ueId      : NodeId          : dual mode UE
+// + network   : XdAccessNetwork : network
+// RETURN     :: void : NULL
+// **/
+void XdHandoverSetUeNetwork(NodeId ueId, XdAccessNetwork network);
+
+// /**
+// FUNCTION   :: XdHandoverGetUeNetwork
+// LAYER      :: PHY
+// PURPOSE    :: Network a dual mode UE is attached to, LTE until
+//               XdHandoverSetUeNetwork is called for it
+// PARAMETERS ::
+// + ueId      : NodeId : dual mode UE
+// RETURN     :: XdAccessNetwork : network
+// **/
+XdAccessNetwork XdHandoverGetUeNetwork(NodeId ueId);
+
+// /**
+// FUNCTION   :: XdHandoverEvaluate
+// LAYER      :: PHY
+// PURPOSE    :: Fold in the new application records and return the
+//               network preferred for a UE.  The decision is only
+//               recomputed once per decision interval of the UE, in
+//               between the previous decision is returned.
+// PARAMETERS ::
+// + ueId      : NodeId    : dual mode UE
+// + now       : clocktype : current simulation time
+// RETURN     :: BOOL : TRUE if FX is preferred over LTE
+// **/
+BOOL XdHandoverEvaluate(NodeId ueId, clocktype now);
+
+#endif /* XD_HANDOVER_DECISION_H */
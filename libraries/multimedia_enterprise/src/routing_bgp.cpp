@@ -376,6 +376,420 @@ BOOL BgpIsSamePrefix(BgpRouteInfo rtf1,BgpRouteInfo rtf2)
         return FALSE;
     }
 }
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpPrefixIndexBucket
+//
+// PURPOSE:  To find the bucket of a destination in the prefix index
+//
+// PARAMETERS:bgp,   bgp internal structure
+//            route, the destination
+//
+// RETURN:      bucket of the destination
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+int BgpPrefixIndexBucket(BgpData* bgp, BgpRouteInfo* route)
+{
+    UInt32 hash = 2166136261U;
+    unsigned char* bytes = NULL;
+    int numBytes = 0;
+    int i = 0;
+
+    if (route->prefix.networkType == NETWORK_IPV4)
+    {
+        bytes = (unsigned char*) &route->prefix.interfaceAddr.ipv4;
+        numBytes = sizeof(NodeAddress);
+    }
+    else if (route->prefix.networkType == NETWORK_IPV6)
+    {
+        bytes = (unsigned char*) &route->prefix.interfaceAddr.ipv6;
+        numBytes = sizeof(in6_addr);
+    }
+
+    hash = (hash ^ route->prefixLen) * 16777619U;
+    for (i = 0; i < numBytes; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619U;
+    }
+    hash ^= hash >> 15;
+
+    // numPrefixBuckets is a power of 2
+    return (int) (hash & (UInt32) (bgp->numPrefixBuckets - 1));
+}
+
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpInitPrefixIndex
+//
+// PURPOSE:  To initialize the prefix index of the RIBs and the list of
+//           changed destinations
+//
+// PARAMETERS:bgp, bgp internal structure
+//
+// RETURN:      None
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+void BgpInitPrefixIndex(BgpData* bgp)
+{
+    bgp->numPrefixBuckets = BGP_MIN_PREFIX_INDEX_SIZE;
+    bgp->numPrefixes = 0;
+    bgp->prefixIndex = (BgpPrefixIndexEntry**)
+        MEM_malloc(sizeof(BgpPrefixIndexEntry*) * bgp->numPrefixBuckets);
+    memset(bgp->prefixIndex,
+           0,
+           sizeof(BgpPrefixIndexEntry*) * bgp->numPrefixBuckets);
+
+    BUFFER_InitializeDataBuffer(&bgp->changedPrefixes,
+                sizeof(BgpPrefixIndexEntry*) * BGP_MIN_RT_BLOCK_SIZE);
+
+    // The initial routes have not been through the decision process yet
+    bgp->allPrefixesChanged = TRUE;
+}
+
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpGrowPrefixIndex
+//
+// PURPOSE:  To double the number of buckets of the prefix index
+//
+// PARAMETERS:bgp, bgp internal structure
+//
+// RETURN:      None
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+void BgpGrowPrefixIndex(BgpData* bgp)
+{
+    BgpPrefixIndexEntry** oldIndex = bgp->prefixIndex;
+    int oldNumBuckets = bgp->numPrefixBuckets;
+    int i = 0;
+
+    bgp->numPrefixBuckets = oldNumBuckets * 2;
+    bgp->prefixIndex = (BgpPrefixIndexEntry**)
+        MEM_malloc(sizeof(BgpPrefixIndexEntry*) * bgp->numPrefixBuckets);
+    memset(bgp->prefixIndex,
+           0,
+           sizeof(BgpPrefixIndexEntry*) * bgp->numPrefixBuckets);
+
+    for (i = 0; i < oldNumBuckets; i++)
+    {
+        BgpPrefixIndexEntry* entry = oldIndex[i];
+
+        while (entry != NULL)
+        {
+            BgpPrefixIndexEntry* next = entry->next;
+            int bucket = BgpPrefixIndexBucket(bgp, &entry->destAddress);
+
+            entry->next = bgp->prefixIndex[bucket];
+            bgp->prefixIndex[bucket] = entry;
+            entry = next;
+        }
+    }
+    MEM_free(oldIndex);
+}
+
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpGetPrefixEntry
+//
+// PURPOSE:  To find a destination in the prefix index
+//
+// PARAMETERS:bgp,    bgp internal structure
+//            route,  the destination
+//            create, whether to add the destination if it is not there
+//
+// RETURN:      The entry of the destination, NULL if it is not there and
+//              create is FALSE
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+BgpPrefixIndexEntry* BgpGetPrefixEntry(
+    BgpData* bgp,
+    BgpRouteInfo route,
+    BOOL create)
+{
+    int bucket = BgpPrefixIndexBucket(bgp, &route);
+    BgpPrefixIndexEntry* entry = bgp->prefixIndex[bucket];
+
+    for (; entry != NULL; entry = entry->next)
+    {
+        if (BgpIsSamePrefix(entry->destAddress, route))
+        {
+            return entry;
+        }
+    }
+
+    if (!create)
+    {
+        return NULL;
+    }
+
+    if (bgp->numPrefixes >= 2 * bgp->numPrefixBuckets)
+    {
+        BgpGrowPrefixIndex(bgp);
+        bucket = BgpPrefixIndexBucket(bgp, &route);
+    }
+
+    entry = (BgpPrefixIndexEntry*) MEM_malloc(sizeof(BgpPrefixIndexEntry));
+    memcpy(&entry->destAddress, &route, sizeof(BgpRouteInfo));
+    entry->firstRibIn = -1;
+    entry->lastRibIn = -1;
+    entry->firstRibLoc = -1;
+    entry->lastRibLoc = -1;
+    entry->isChanged = FALSE;
+    entry->next = bgp->prefixIndex[bucket];
+    bgp->prefixIndex[bucket] = entry;
+    bgp->numPrefixes++;
+
+    return entry;
+}
+
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpMarkPrefixChanged
+//
+// PURPOSE:  To queue a destination for the next run of the decision
+//           process phases 2 and 3
+//
+// PARAMETERS:bgp,   bgp internal structure
+//            entry, entry of the destination
+//
+// RETURN:      None
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+void BgpMarkPrefixChanged(BgpData* bgp, BgpPrefixIndexEntry* entry)
+{
+    if (!entry->isChanged)
+    {
+        entry->isChanged = TRUE;
+        BUFFER_AddDataToDataBuffer(&bgp->changedPrefixes,
+                                   (char*) &entry,
+                                   sizeof(BgpPrefixIndexEntry*));
+    }
+}
+
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpClearChangedPrefixes
+//
+// PURPOSE:  To empty the list of changed destinations once the decision
+//           process has gone through them
+//
+// PARAMETERS:bgp, bgp internal structure
+//
+// RETURN:      None
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+void BgpClearChangedPrefixes(BgpData* bgp)
+{
+    BgpPrefixIndexEntry** changed = (BgpPrefixIndexEntry**)
+        BUFFER_GetData(&bgp->changedPrefixes);
+    int numChanged = BUFFER_GetCurrentSize(&bgp->changedPrefixes)
+        / sizeof(BgpPrefixIndexEntry*);
+    int i = 0;
+
+    for (i = 0; i < numChanged; i++)
+    {
+        changed[i]->isChanged = FALSE;
+    }
+    if (numChanged > 0)
+    {
+        BUFFER_ClearDataFromDataBuffer(
+            &bgp->changedPrefixes,
+            (char*) changed,
+            numChanged * sizeof(BgpPrefixIndexEntry*),
+            FALSE);
+    }
+    bgp->allPrefixesChanged = FALSE;
+}
+
+
+static
+int BgpComparePositions(const void* a, const void* b)
+{
+    return *((const int*) a) - *((const int*) b);
+}
+
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpGetChangedPositions
+//
+// PURPOSE:  To list the entries of adjRibIn or ribLocal the decision
+//           process has to go through: those of the changed destinations,
+//           or all of them if allPrefixesChanged is set
+//
+// PARAMETERS:bgp,          bgp internal structure
+//            inRibLocal,   TRUE for positions in ribLocal, FALSE for
+//                          positions in adjRibIn
+//            numPositions, set to the number of positions
+//
+// RETURN:      Positions in increasing order, so that the entries are
+//              visited in the order of the buffer. Freed by the caller.
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+int* BgpGetChangedPositions(
+    BgpData* bgp,
+    BOOL inRibLocal,
+    int* numPositions)
+{
+    int numEntries = 0;
+    int* positions = NULL;
+    int i = 0;
+
+    if (inRibLocal)
+    {
+        numEntries = BUFFER_GetCurrentSize(&bgp->ribLocal)
+            / sizeof(BgpAdjRibLocStruct);
+    }
+    else
+    {
+        numEntries = BUFFER_GetCurrentSize(&bgp->adjRibIn)
+            / sizeof(BgpRoutingInformationBase);
+    }
+
+    positions = (int*) MEM_malloc(sizeof(int) * MAX(numEntries, 1));
+    *numPositions = 0;
+
+    if (bgp->allPrefixesChanged)
+    {
+        for (i = 0; i < numEntries; i++)
+        {
+            positions[i] = i;
+        }
+        *numPositions = numEntries;
+        return positions;
+    }
+
+    BgpPrefixIndexEntry** changed = (BgpPrefixIndexEntry**)
+        BUFFER_GetData(&bgp->changedPrefixes);
+    int numChanged = BUFFER_GetCurrentSize(&bgp->changedPrefixes)
+        / sizeof(BgpPrefixIndexEntry*);
+
+    BgpRoutingInformationBase* adjRibIn = (BgpRoutingInformationBase*)
+        BUFFER_GetData(&bgp->adjRibIn);
+    BgpAdjRibLocStruct* ribLoc = (BgpAdjRibLocStruct*)
+        BUFFER_GetData(&bgp->ribLocal);
+
+    for (i = 0; i < numChanged; i++)
+    {
+        int j = 0;
+
+        if (inRibLocal)
+        {
+            for (j = changed[i]->firstRibLoc; j != -1;
+                 j = ribLoc[j].nextSamePrefix)
+            {
+                positions[(*numPositions)++] = j;
+            }
+        }
+        else
+        {
+            for (j = changed[i]->firstRibIn; j != -1;
+                 j = adjRibIn[j].nextSamePrefix)
+            {
+                positions[(*numPositions)++] = j;
+            }
+        }
+    }
+
+    qsort(positions, *numPositions, sizeof(int), BgpComparePositions);
+    return positions;
+}
+
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpAddToAdjRibIn
+//
+// PURPOSE:  To add a route at the end of adjRibIn and in the prefix index
+//
+// PARAMETERS:bgp, bgp internal structure
+//            row, the route
+//
+// RETURN:      None
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+void BgpAddToAdjRibIn(BgpData* bgp, BgpRoutingInformationBase* row)
+{
+    BgpPrefixIndexEntry* entry =
+        BgpGetPrefixEntry(bgp, row->destAddress, TRUE);
+    int position = BUFFER_GetCurrentSize(&bgp->adjRibIn)
+        / sizeof(BgpRoutingInformationBase);
+
+    row->nextSamePrefix = -1;
+    BUFFER_AddDataToDataBuffer(&bgp->adjRibIn,
+                               (char*) row,
+                               sizeof(BgpRoutingInformationBase));
+
+    if (entry->lastRibIn == -1)
+    {
+        entry->firstRibIn = position;
+    }
+    else
+    {
+        BgpRoutingInformationBase* adjRibIn = (BgpRoutingInformationBase*)
+            BUFFER_GetData(&bgp->adjRibIn);
+
+        adjRibIn[entry->lastRibIn].nextSamePrefix = position;
+    }
+    entry->lastRibIn = position;
+
+    BgpMarkPrefixChanged(bgp, entry);
+}
+
+
+//--------------------------------------------------------------------------
+// FUNCTION      BgpAddToRibLocal
+//
+// PURPOSE:  To add an entry at the end of ribLocal and in the prefix index
+//
+// PARAMETERS:bgp,    bgp internal structure
+//            ribLoc, the entry
+//
+// RETURN:      None
+//
+// ASSUMPTION:  None
+//--------------------------------------------------------------------------
+static
+void BgpAddToRibLocal(BgpData* bgp, BgpAdjRibLocStruct* ribLoc)
+{
+    BgpPrefixIndexEntry* entry =
+        BgpGetPrefixEntry(bgp, ribLoc->ptrAdjRibIn->destAddress, TRUE);
+    int position = BUFFER_GetCurrentSize(&bgp->ribLocal)
+        / sizeof(BgpAdjRibLocStruct);
+
+    ribLoc->nextSamePrefix = -1;
+    BUFFER_AddDataToDataBuffer(&bgp->ribLocal,
+                               (char*) ribLoc,
+                               sizeof(BgpAdjRibLocStruct));
+
+    if (entry->lastRibLoc == -1)
+    {
+        entry->firstRibLoc = position;
+    }
+    else
+    {
+        BgpAdjRibLocStruct* ribLocPtr = (BgpAdjRibLocStruct*)
+            BUFFER_GetData(&bgp->ribLocal);
+
+        ribLocPtr[entry->lastRibLoc].nextSamePrefix = position;
+    }
+    entry->lastRibLoc = position;
+}
+
 /**
 // API       :: BgpFindAttr
 // PURPOSE   :: find the header in the UPDATE message
@@ -2568,9 +2982,6 @@ void BgpUpdateRibFromIpv4ForwardingTable(
     NetworkForwardingTable* rt2 = &(ip->forwardTable);
 
 
-    int numEntriesAdjRibIn = BUFFER_GetCurrentSize(&(bgp->adjRibIn))
-        / sizeof(BgpRoutingInformationBase);
-
     BgpRoutingInformationBase* adjRibIn = (BgpRoutingInformationBase*)
                                  BUFFER_GetData(&(bgp->adjRibIn));
 
@@ -2635,33 +3046,34 @@ void BgpUpdateRibFromIpv4ForwardingTable(
                     continue;
                 }
             }
-            for (j = 0; j < numEntriesAdjRibIn; j++ ) // search AdjRibin
-            {
+            // search AdjRibin through the routes to the same destination
+            BgpRouteInfo rtDest;
+            BgpPrefixIndexEntry* prefixEntry = NULL;
 
-                BOOL cond2 = ( (rt->row[i].destAddress ==
-                     GetIPv4Address(adjRibIn[j].destAddress.prefix))
-                     && (ConvertSubnetMaskToNumHostBits(rt->row[i].
-                                  destAddressMask) ==
-                                  (32 - adjRibIn[j].destAddress.prefixLen)));
+            SetIPv4AddressInfo(&rtDest.prefix, rt->row[i].destAddress);
+            rtDest.prefixLen = (unsigned char) (32 -
+                ConvertSubnetMaskToNumHostBits(rt->row[i].destAddressMask));
+            prefixEntry = BgpGetPrefixEntry(bgp, rtDest, FALSE);
 
-                if (cond2)
+            for (j = (prefixEntry ? prefixEntry->firstRibIn : -1);
+                 j != -1;
+                 j = adjRibIn[j].nextSamePrefix)
+            {
+                if (adjRibIn[j].origin == BGP_ORIGIN_IGP)
                 {
-                    if (adjRibIn[j].origin == BGP_ORIGIN_IGP)
-                    {
-                        // Already a route exists from Igp with this
-                        // destination so we need to compare the routes and
-                        // don't need to add entry for this route
-                        isFound = TRUE;
-                        SetIPv4AddressInfo(&adjRibIn[j].nextHop,
-                                           rt->row[i].nextHopAddress);
-
-                        adjRibIn[j].isValid = TRUE;
-                        adjRibIn[j].pathAttrBest = BGP_PATH_ATTR_BEST_TRUE;
-                    }
-                    else
-                    {
-                        adjRibIn[j].pathAttrBest = BGP_PATH_ATTR_BEST_FALSE;
-                    }
+                    // Already a route exists from Igp with this
+                    // destination so we need to compare the routes and
+                    // don't need to add entry for this route
+                    isFound = TRUE;
+                    SetIPv4AddressInfo(&adjRibIn[j].nextHop,
+                                       rt->row[i].nextHopAddress);
+
+                    adjRibIn[j].isValid = TRUE;
+                    adjRibIn[j].pathAttrBest = BGP_PATH_ATTR_BEST_TRUE;
+                }
+                else
+                {
+                    adjRibIn[j].pathAttrBest = BGP_PATH_ATTR_BEST_FALSE;
                 }
             } // end of search in adjRibIn
 
@@ -2722,14 +3134,10 @@ void BgpUpdateRibFromIpv4ForwardingTable(
                     BGP_DEFAULT_INTERNAL_WEIGHT,
                     0);
 
-                BUFFER_AddDataToDataBuffer(
-                    &(bgp->adjRibIn),
-                    (char*) &bgpRoutingInformationBase,
-                    sizeof(BgpRoutingInformationBase));
+                BgpAddToAdjRibIn(bgp, &bgpRoutingInformationBase);
 
                 adjRibIn = (BgpRoutingInformationBase*)
                     BUFFER_GetData(&(bgp->adjRibIn));
-                numEntriesAdjRibIn++;
             }
         }
     } // end for (i = 0; i < rt->size; i++)
@@ -2918,10 +3326,7 @@ void  BgpUpdateRibWithIpv6RouteEntry(rn_leaf* rleaf,
                 BGP_DEFAULT_INTERNAL_WEIGHT,
                 0);
 
-            BUFFER_AddDataToDataBuffer(
-                &(bgp->adjRibIn),
-                (char*) &bgpRoutingInformationBase,
-                sizeof(BgpRoutingInformationBase));
+            BgpAddToAdjRibIn(bgp, &bgpRoutingInformationBase);
 
             adjRibIn = (BgpRoutingInformationBase*)
             BUFFER_GetData(&(bgp->adjRibIn));
@@ -3596,9 +4001,7 @@ void BgpReadConfigurationFile(
                 }
             }
 
-            BUFFER_AddDataToDataBuffer(&(bgp->adjRibIn),
-                           (char*) &bgpRoutingInformationBase,
-                           sizeof(BgpRoutingInformationBase));
+            BgpAddToAdjRibIn(bgp, &bgpRoutingInformationBase);
 
         }
         // read NEIGHBOR <ip address> REMOTE-AS <as id of peer> .. OR
@@ -7821,9 +8224,6 @@ void BgpModifyAdjRibInForNewUpdate(
     BOOL isRtChange = FALSE, found;
     NetworkType pType = NETWORK_IPV4;
 
-    int numEntriesInAdjRibIn = BUFFER_GetCurrentSize(&(bgp->adjRibIn))
-    / sizeof(BgpRoutingInformationBase);
-
     BgpRoutingInformationBase* adjRibIn = (BgpRoutingInformationBase*)
     BUFFER_GetData(&(bgp->adjRibIn));
 
@@ -8041,7 +8441,11 @@ void BgpModifyAdjRibInForNewUpdate(
             }
         }
     }
-    for (i = 0; i < numEntriesInAdjRibIn; i++)
+    BgpPrefixIndexEntry* prefixEntry = BgpGetPrefixEntry(bgp, nlri, TRUE);
+    BgpMarkPrefixChanged(bgp, prefixEntry);
+
+    for (i = prefixEntry->firstRibIn; i != -1;
+         i = adjRibIn[i].nextSamePrefix)
     {
         if (BgpIsSamePrefix(adjRibIn[i].destAddress,nlri) )
         {
@@ -8160,10 +8564,7 @@ void BgpModifyAdjRibInForNewUpdate(
             connectionPtr->weight,
             originatorId);
 
-        BUFFER_AddDataToDataBuffer(
-            &(bgp->adjRibIn),
-            (char*) &routingTableRow,
-            sizeof(BgpRoutingInformationBase));
+        BgpAddToAdjRibIn(bgp, &routingTableRow);
     }
 
 }
@@ -8192,8 +8593,6 @@ void BgpFindAlternativeRoute(
     BgpRoutingInformationBase** bestRoutePtr)
 {
     int  i = 0;
-    int numEntriesAdjRibIn = BUFFER_GetCurrentSize(&bgp->adjRibIn)
-    / sizeof(BgpRoutingInformationBase);
 
     BgpRoutingInformationBase* adjRibIn = (BgpRoutingInformationBase*)
     BUFFER_GetData(&bgp->adjRibIn);
@@ -8202,7 +8601,11 @@ void BgpFindAlternativeRoute(
 
     BOOL wantAnAssumedBest = TRUE;
 
-    for (i = 0; i < numEntriesAdjRibIn; i++)
+    BgpPrefixIndexEntry* prefixEntry =
+        BgpGetPrefixEntry(bgp, rtDeleted->destAddress, FALSE);
+
+    for (i = (prefixEntry ? prefixEntry->firstRibIn : -1); i != -1;
+         i = adjRibIn[i].nextSamePrefix)
     {
         if (BgpIsSamePrefix(adjRibIn[i].destAddress,
             rtDeleted->destAddress)&& (&adjRibIn[i] != rtDeleted) &&
@@ -8288,9 +8691,6 @@ void BgpModifyAdjRibInForWithdrawnRoutes(
     BgpRouteInfo withdrawnRt,
     BgpConnectionInformationBase* connectionPtr)
 {
-    int numEntriesInAdjRibIn = BUFFER_GetCurrentSize(&(bgp->adjRibIn))
-    / sizeof(BgpRoutingInformationBase);
-
     BgpRoutingInformationBase* adjRibIn = (BgpRoutingInformationBase*)
         BUFFER_GetData(&(bgp->adjRibIn));
 
@@ -8300,7 +8700,21 @@ void BgpModifyAdjRibInForWithdrawnRoutes(
     BgpRoutingInformationBase* bestRtPtr = NULL;
     BOOL bestRtDeleted = FALSE;
 
-    for (i = 0; i < numEntriesInAdjRibIn; i++)
+    BgpPrefixIndexEntry* prefixEntry =
+        BgpGetPrefixEntry(bgp, withdrawnRt, FALSE);
+
+    if (prefixEntry == NULL)
+    {
+        if (DEBUG)
+        {
+            printf("No routes to be delted so return\n");
+        }
+        return;
+    }
+    BgpMarkPrefixChanged(bgp, prefixEntry);
+
+    for (i = prefixEntry->firstRibIn; i != -1;
+         i = adjRibIn[i].nextSamePrefix)
     {
         if (BgpIsSamePrefix(adjRibIn[i].destAddress,withdrawnRt) &&
          Address_IsSameAddress(&adjRibIn[i].peerAddress,
@@ -8424,6 +8838,8 @@ void BgpDecisionProcessPhase3(Node* node, BgpData* bgp)
 {
     int i = 0;
     int j = 0;
+    int n = 0;
+    int numEntriesToCheck = 0;
 
     BgpConnectionInformationBase* bgpConnInfo =
         (BgpConnectionInformationBase*) BUFFER_GetData(&(bgp->connInfoBase));
@@ -8434,8 +8850,10 @@ void BgpDecisionProcessPhase3(Node* node, BgpData* bgp)
     BgpAdjRibLocStruct* adjRibLoc = (BgpAdjRibLocStruct*)
          BUFFER_GetData(&(bgp->ribLocal));
 
-    int numEntriesRibLoc = BUFFER_GetCurrentSize(&(bgp->ribLocal))
-    / sizeof(BgpAdjRibLocStruct);
+    // The Rib Local entries of the destinations that have not changed
+    // since the last run are already in the Rib Out where they belong
+    int* entriesToCheck =
+        BgpGetChangedPositions(bgp, TRUE, &numEntriesToCheck);
 
     if (DEBUG_CONNECTION)
     {
@@ -8460,11 +8878,13 @@ void BgpDecisionProcessPhase3(Node* node, BgpData* bgp)
         }
     }
 
-    // Loop through all the entries of Rib Local and update the Adjuscent
-    // Rib Out of all the connections if the connections are in Established
-    // state
-    for (i = 0; i < numEntriesRibLoc; i++)
+    // Loop through the changed entries of Rib Local and update the
+    // Adjuscent Rib Out of all the connections if the connections are in
+    // Established state
+    for (n = 0; n < numEntriesToCheck; n++)
     {
+        i = entriesToCheck[n];
+
         for (j = 0; j < numEntriesConn; j++)
         {
             BgpAdjRibLocStruct* adjRibLocPtr = NULL;
@@ -8700,6 +9120,8 @@ void BgpDecisionProcessPhase3(Node* node, BgpData* bgp)
             adjRibLoc[i].movedToAdjRibOut = FALSE;
         }
     }
+    MEM_free(entriesToCheck);
+    BgpClearChangedPrefixes(bgp);
 
     if (DEBUG_TABLE)
     {
@@ -8753,8 +9175,13 @@ static
 void BgpDecisionProcessPhase2(Node* node, BgpData* bgp)
 {
     int i = 0;
-    int numEntriesInAdjRibIn = BUFFER_GetCurrentSize(&(bgp->adjRibIn))
-    / sizeof(BgpRoutingInformationBase);
+    int n = 0;
+    int numEntriesToCheck = 0;
+
+    // Only the routes to the destinations changed since the last run
+    // need to be checked
+    int* entriesToCheck =
+        BgpGetChangedPositions(bgp, FALSE, &numEntriesToCheck);
 
     BgpRoutingInformationBase* adjRibInPtr = (BgpRoutingInformationBase*)
     BUFFER_GetData(&(bgp->adjRibIn));
@@ -8769,27 +9196,31 @@ void BgpDecisionProcessPhase2(Node* node, BgpData* bgp)
         BgpPrintAdjRibLoc(node, bgp);
     }
 
-    for (i = 0; i < numEntriesInAdjRibIn; i++)
+    for (n = 0; n < numEntriesToCheck; n++)
     {
         // Go through all the entries of the and modify the Rib Local
         // accordingly
         int j;
 
-        int numEntriesInRibLoc = BUFFER_GetCurrentSize(&(bgp->ribLocal))
-            / sizeof(BgpAdjRibLocStruct);
-
         BgpAdjRibLocStruct* ribLocPtr = (BgpAdjRibLocStruct*)
         BUFFER_GetData(&bgp->ribLocal);
 
         BOOL isExistsInLoc = FALSE;
 
+        i = entriesToCheck[n];
+
+        // The Rib Local entries for the destination of this route
+        BgpPrefixIndexEntry* prefixEntry =
+            BgpGetPrefixEntry(bgp, adjRibInPtr[i].destAddress, TRUE);
+
         if (adjRibInPtr[i].isValid == FALSE)
         {
             // The current entry in Routing Information Base is invalid
             // If any entry in Rib Local is pointing to this entry then
             // make that entry as invalid and update the Network Forwarding
             // table that the corresponding destination is invalid
-            for (j = 0; j < numEntriesInRibLoc; j++)
+            for (j = prefixEntry->firstRibLoc; j != -1;
+                 j = ribLocPtr[j].nextSamePrefix)
             {
                 if (ribLocPtr[j].ptrAdjRibIn == &adjRibInPtr[i] &&
                     ribLocPtr[j].isValid)
@@ -8915,7 +9346,8 @@ void BgpDecisionProcessPhase2(Node* node, BgpData* bgp)
             // there is no entry for the best route in Rib Local then add
             // the entry for the destination in Rib Local
 
-            for (j = 0; j < numEntriesInRibLoc; j++)
+            for (j = prefixEntry->firstRibLoc; j != -1;
+                 j = ribLocPtr[j].nextSamePrefix)
             {
                 if (BgpIsSamePrefix(ribLocPtr[j].ptrAdjRibIn->destAddress,
                      adjRibInPtr[i].destAddress))
@@ -9400,9 +9832,7 @@ void BgpDecisionProcessPhase2(Node* node, BgpData* bgp)
                 ribLocStruct.movedToWithdrawnRt = FALSE;
                 ribLocStruct.ptrAdjRibIn = &adjRibInPtr[i];
 
-                BUFFER_AddDataToDataBuffer(&bgp->ribLocal,
-                                           (char*) &ribLocStruct,
-                                           sizeof(BgpAdjRibLocStruct));
+                BgpAddToRibLocal(bgp, &ribLocStruct);
 
                 ribLocPtr = (BgpAdjRibLocStruct*)
                                           BUFFER_GetData(&bgp->ribLocal);
@@ -9579,6 +10009,7 @@ void BgpDecisionProcessPhase2(Node* node, BgpData* bgp)
             }
         }// else if (adjRibInPtr[i].pathAttrBest == BGP_PATH_ATTR_BEST_TRUE)
     }
+    MEM_free(entriesToCheck);
 
     nextStartPtr = BUFFER_GetData(&bgp->ribLocal);
     numByteShift = nextStartPtr - prevStartPtr;
@@ -13920,6 +14351,9 @@ BgpLayer(Node* node, Message* msg)
                 BgpPrintRoutingInformationBase(node, bgp);
             }
 
+            // The IGP routes have been updated in place, so all the
+            // destinations go through the decision process
+            bgp->allPrefixesChanged = TRUE;
             BgpDecisionProcessPhase2(node, bgp);
             BgpDecisionProcessPhase3(node, bgp);
             break;
@@ -14053,6 +14487,8 @@ void BgpInit(Node* node, const NodeInput* nodeInput)
         BUFFER_InitializeDataBuffer(&bgp->ribLocal,
                     sizeof(BgpAdjRibLocStruct) * BGP_MIN_RT_BLOCK_SIZE);
 
+        BgpInitPrefixIndex(bgp);
+
         BUFFER_InitializeDataBuffer(&bgp->connInfoBase,
                     sizeof(BgpConnectionInformationBase) *
                     BGP_MIN_CONN_BLOCK_SIZE);
@@ -14302,9 +14738,7 @@ void BgpInit(Node* node, const NodeInput* nodeInput)
                 ribLoc.movedToWithdrawnRt = FALSE;
                 ribLoc.isValid          = TRUE;
 
-                BUFFER_AddDataToDataBuffer(&(bgp->ribLocal),
-                       (char*) &ribLoc,
-                       sizeof(BgpAdjRibLocStruct));
+                BgpAddToRibLocal(bgp, &ribLoc);
             }
         }
 
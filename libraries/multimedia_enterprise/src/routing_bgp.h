@@ -99,6 +99,7 @@
 #define BGP_INVALID_ADDRESS                       0
 #define BGP_MIN_RT_BLOCK_SIZE                    10
 #define BGP_MIN_CONN_BLOCK_SIZE                   5
+#define BGP_MIN_PREFIX_INDEX_SIZE                16
 #define BGP_MIN_HDR_LEN                          19
 #define BGP_MAX_HDR_LEN                          4096
 #define BGP_SIZE_OF_OPEN_MSG_EXCL_OPT            BGP_MIN_HDR_LEN + 10
@@ -429,6 +430,9 @@ typedef struct{
     unsigned char* pathAttrUnknown;  // NOT USED IN THE IMPLEMENTATION
 
     BOOL isValid;
+
+    int nextSamePrefix;        // Position in adjRibIn of the next route to
+                               // the same destination, -1 if none
 } BgpRoutingInformationBase;
 
 typedef struct{
@@ -436,8 +440,24 @@ typedef struct{
     BOOL movedToAdjRibOut;
     BOOL movedToWithdrawnRt;
     BOOL isValid;
+    int nextSamePrefix;        // Position in ribLocal of the next entry for
+                               // the same destination, -1 if none
 } BgpAdjRibLocStruct;
 
+// Destination known to the RIBs. adjRibIn and ribLocal only grow, so the
+// entries for one destination are found through positions in the buffers,
+// which stay valid when the buffers are reallocated. The entries are
+// chained in the order of the buffers.
+typedef struct struct_bgp_prefix_index_entry {
+    BgpRouteInfo destAddress;
+    int          firstRibIn;      // -1 if none
+    int          lastRibIn;
+    int          firstRibLoc;     // -1 if none
+    int          lastRibLoc;
+    BOOL         isChanged;       // Queued in changedPrefixes
+    struct struct_bgp_prefix_index_entry* next;
+} BgpPrefixIndexEntry;
+
 
 // The neighbors information of Bgp.. Reference rfc 1657
 typedef struct struct_connection_info {
@@ -525,6 +545,16 @@ typedef struct{
                                        // as a pointer to the adjRibIn
     DataBuffer     forwardingInfoBase; // Routing table for BGP
 
+    BgpPrefixIndexEntry** prefixIndex; // Hash table of the destinations of
+                                       // adjRibIn and ribLocal
+    int            numPrefixBuckets;
+    int            numPrefixes;
+    DataBuffer     changedPrefixes;    // BgpPrefixIndexEntry* of the
+                                       // destinations whose routes changed
+                                       // since the last decision process
+    BOOL           allPrefixesChanged; // Run the decision process over all
+                                       // the destinations
+
     BOOL           isRtReflector;      // If the bgp speaker is working as a
                                        // route reflector
     int            clusterId;          // If the bgp speaker is a route
@@ -0,0 +1,354 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api.h"
+#include "routing_ospf_lsdb_index.h"
+
+// Bucket of a key.  Only the list and Link State ID are hashed, so that
+// lookups by Link State ID only find all candidates in one chain.
+static int OspfLsdbIndexBucket(
+    const OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId)
+{
+    UInt32 hash = 2166136261U;
+    UInt32 scopeBits = (UInt32) (size_t) scope;
+
+    hash = (hash ^ scopeBits) * 16777619U;
+    hash = (hash ^ (UInt32) linkStateId) * 16777619U;
+    hash ^= hash >> 15;
+
+    // numBuckets is a power of 2
+    return (int) (hash & (UInt32) (index->numBuckets - 1));
+}
+
+static OspfLsdbIndexEntry** OspfLsdbIndexNewBuckets(int numBuckets)
+{
+    OspfLsdbIndexEntry** bucket = (OspfLsdbIndexEntry**)
+        MEM_malloc(numBuckets * sizeof(OspfLsdbIndexEntry*));
+
+    memset(bucket, 0, numBuckets * sizeof(OspfLsdbIndexEntry*));
+    return bucket;
+}
+
+// Double the number of buckets.  Each chain is moved in order, so the
+// entries of a key keep the order of the list.
+static void OspfLsdbIndexGrow(OspfLsdbIndex* index)
+{
+    OspfLsdbIndexEntry** oldBucket = index->bucket;
+    int oldNumBuckets = index->numBuckets;
+    OspfLsdbIndexEntry** tail = NULL;
+    int i;
+
+    index->numBuckets = oldNumBuckets * 2;
+    index->bucket = OspfLsdbIndexNewBuckets(index->numBuckets);
+    tail = OspfLsdbIndexNewBuckets(index->numBuckets);
+
+    for (i = 0; i < oldNumBuckets; i++)
+    {
+        OspfLsdbIndexEntry* entry = oldBucket[i];
+
+        while (entry != NULL)
+        {
+            OspfLsdbIndexEntry* next = entry->next;
+            int b = OspfLsdbIndexBucket(index,
+                                        entry->scope,
+                                        entry->linkStateId);
+
+            entry->next = NULL;
+            if (tail[b] == NULL)
+            {
+                index->bucket[b] = entry;
+            }
+            else
+            {
+                tail[b]->next = entry;
+            }
+            tail[b] = entry;
+            entry = next;
+        }
+    }
+
+    MEM_free(tail);
+    MEM_free(oldBucket);
+}
+
+// Link to the entry of an item in its hash chain, NULL if not indexed
+static OspfLsdbIndexEntry** OspfLsdbIndexFindLink(
+    OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter,
+    void* item)
+{
+    OspfLsdbIndexEntry** link =
+        &index->bucket[OspfLsdbIndexBucket(index, scope, linkStateId)];
+
+    while (*link != NULL)
+    {
+        OspfLsdbIndexEntry* entry = *link;
+
+        if (entry->item == item)
+        {
+            ERROR_Assert(entry->scope == scope
+                         && entry->linkStateId == linkStateId
+                         && entry->advertisingRouter == advertisingRouter,
+                         "LSA changed its key in the LSDB");
+            return link;
+        }
+        link = &entry->next;
+    }
+    return NULL;
+}
+
+// Take an entry off the age wheel, if it is on it
+static void OspfLsdbIndexUnlinkAge(OspfLsdbIndexEntry* entry)
+{
+    if (entry->agePrevNext == NULL)
+    {
+        return;
+    }
+
+    *entry->agePrevNext = entry->ageNext;
+    if (entry->ageNext != NULL)
+    {
+        entry->ageNext->agePrevNext = entry->agePrevNext;
+    }
+    entry->ageNext = NULL;
+    entry->agePrevNext = NULL;
+}
+
+OspfLsdbIndex* OspfLsdbIndexCreate()
+{
+    OspfLsdbIndex* index =
+        (OspfLsdbIndex*) MEM_malloc(sizeof(OspfLsdbIndex));
+
+    index->numBuckets = OSPF_LSDB_INDEX_INITIAL_SIZE;
+    index->numEntries = 0;
+    index->bucket = OspfLsdbIndexNewBuckets(index->numBuckets);
+    memset(index->ageBucket, 0, sizeof(index->ageBucket));
+    index->ageClock = 0;
+    index->ageScan = 0;
+    return index;
+}
+
+void OspfLsdbIndexClear(OspfLsdbIndex* index)
+{
+    int i;
+
+    for (i = 0; i < index->numBuckets; i++)
+    {
+        OspfLsdbIndexEntry* entry = index->bucket[i];
+
+        while (entry != NULL)
+        {
+            OspfLsdbIndexEntry* next = entry->next;
+            MEM_free(entry);
+            entry = next;
+        }
+        index->bucket[i] = NULL;
+    }
+    index->numEntries = 0;
+    memset(index->ageBucket, 0, sizeof(index->ageBucket));
+}
+
+void OspfLsdbIndexFree(OspfLsdbIndex* index)
+{
+    OspfLsdbIndexClear(index);
+    MEM_free(index->bucket);
+    MEM_free(index);
+}
+
+void OspfLsdbIndexInsert(
+    OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter,
+    void* item)
+{
+    OspfLsdbIndexEntry* entry =
+        (OspfLsdbIndexEntry*) MEM_malloc(sizeof(OspfLsdbIndexEntry));
+    OspfLsdbIndexEntry** link = NULL;
+
+    if (index->numEntries >= 2 * index->numBuckets)
+    {
+        OspfLsdbIndexGrow(index);
+    }
+
+    entry->scope = scope;
+    entry->linkStateId = linkStateId;
+    entry->advertisingRouter = advertisingRouter;
+    entry->item = item;
+    entry->next = NULL;
+    entry->ageDue = 0;
+    entry->ageNext = NULL;
+    entry->agePrevNext = NULL;
+
+    // The item is at the end of its list, so it goes at the end of the
+    // chain
+    link = &index->bucket[OspfLsdbIndexBucket(index, scope, linkStateId)];
+    while (*link != NULL)
+    {
+        link = &(*link)->next;
+    }
+    *link = entry;
+    index->numEntries++;
+}
+
+void OspfLsdbIndexRemove(
+    OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter,
+    void* item)
+{
+    OspfLsdbIndexEntry** link = OspfLsdbIndexFindLink(index,
+                                                      scope,
+                                                      linkStateId,
+                                                      advertisingRouter,
+                                                      item);
+
+    if (link != NULL)
+    {
+        OspfLsdbIndexEntry* entry = *link;
+
+        OspfLsdbIndexUnlinkAge(entry);
+        *link = entry->next;
+        MEM_free(entry);
+        index->numEntries--;
+    }
+}
+
+void* OspfLsdbIndexLookup(
+    const OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter)
+{
+    const OspfLsdbIndexEntry* entry =
+        index->bucket[OspfLsdbIndexBucket(index, scope, linkStateId)];
+
+    for (; entry != NULL; entry = entry->next)
+    {
+        if (entry->scope == scope
+            && entry->linkStateId == linkStateId
+            && entry->advertisingRouter == advertisingRouter)
+        {
+            return entry->item;
+        }
+    }
+    return NULL;
+}
+
+void* OspfLsdbIndexLookupById(
+    const OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId)
+{
+    const OspfLsdbIndexEntry* entry =
+        index->bucket[OspfLsdbIndexBucket(index, scope, linkStateId)];
+
+    for (; entry != NULL; entry = entry->next)
+    {
+        if (entry->scope == scope && entry->linkStateId == linkStateId)
+        {
+            return entry->item;
+        }
+    }
+    return NULL;
+}
+
+void OspfLsdbIndexScheduleAge(
+    OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter,
+    void* item,
+    int seconds)
+{
+    OspfLsdbIndexEntry** link = OspfLsdbIndexFindLink(index,
+                                                      scope,
+                                                      linkStateId,
+                                                      advertisingRouter,
+                                                      item);
+    OspfLsdbIndexEntry* entry = NULL;
+    OspfLsdbIndexEntry** bucket = NULL;
+
+    ERROR_Assert(link != NULL, "LSA is not in the LSDB index");
+    entry = *link;
+
+    OspfLsdbIndexUnlinkAge(entry);
+    if (seconds < 0)
+    {
+        return;
+    }
+
+    // Due at the earliest after the next advance of the clock, so that a
+    // scan never finds an entry it has just put back
+    entry->ageDue = index->ageClock + MAX(seconds, 1);
+
+    bucket = &index->ageBucket[
+        (int) (entry->ageDue & (OSPF_LSDB_INDEX_AGE_BUCKETS - 1))];
+    entry->ageNext = *bucket;
+    if (*bucket != NULL)
+    {
+        (*bucket)->agePrevNext = &entry->ageNext;
+    }
+    *bucket = entry;
+    entry->agePrevNext = bucket;
+}
+
+void OspfLsdbIndexAdvanceAge(OspfLsdbIndex* index, int seconds)
+{
+    index->ageClock += seconds;
+
+    // Each bucket is scanned for all of its due entries, so one turn of
+    // the wheel is enough however far the clock went
+    if (index->ageClock - index->ageScan >= OSPF_LSDB_INDEX_AGE_BUCKETS)
+    {
+        index->ageScan = index->ageClock - OSPF_LSDB_INDEX_AGE_BUCKETS + 1;
+    }
+}
+
+void* OspfLsdbIndexNextDue(OspfLsdbIndex* index, const void** scope)
+{
+    while (index->ageScan <= index->ageClock)
+    {
+        OspfLsdbIndexEntry* entry = index->ageBucket[
+            (int) (index->ageScan & (OSPF_LSDB_INDEX_AGE_BUCKETS - 1))];
+
+        // Entries of later turns of the wheel stay
+        for (; entry != NULL; entry = entry->ageNext)
+        {
+            if (entry->ageDue <= index->ageClock)
+            {
+                OspfLsdbIndexUnlinkAge(entry);
+                if (scope != NULL)
+                {
+                    *scope = entry->scope;
+                }
+                return entry->item;
+            }
+        }
+        index->ageScan++;
+    }
+    return NULL;
+}
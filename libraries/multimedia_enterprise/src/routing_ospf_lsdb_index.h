@@ -0,0 +1,239 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Hash index of the link state databases of OSPFv2 and OSPFv3.
+ *
+ * The LSAs stay in the LSDB lists of the protocols; the index maps
+ * (list, Link State ID, Advertising Router) to the list item that holds
+ * the LSA, so that an LSA is found without walking the list.  The list
+ * identifies the LS type and flooding scope, since each LSDB list only
+ * holds one LS type of one area, interface or AS.
+ *
+ * All entries with the same list and Link State ID are in one hash
+ * chain, in the order they were added, which is the order of the list.
+ * A lookup therefore finds the same item a walk of the list would.
+ *
+ * The index also keeps the entries in an age wheel for MaxAge and LS
+ * refresh processing.  An entry is put in the bucket of the age clock at
+ * which the LS age of its LSA reaches the next threshold, so an age tick
+ * only visits the LSAs that are due instead of the whole LSDB.  The
+ * protocols advance the clock as they age the LSAs and schedule an LSA
+ * whenever it is installed or replaced.  An LSA whose age is lowered in
+ * place is found due early and is simply scheduled again.
+ */
+
+#ifndef ROUTING_OSPF_LSDB_INDEX_H
+#define ROUTING_OSPF_LSDB_INDEX_H
+
+// /**
+// CONSTANT    :: OSPF_LSDB_INDEX_INITIAL_SIZE : 16
+// DESCRIPTION :: Initial number of hash buckets of an index
+// **/
+#define OSPF_LSDB_INDEX_INITIAL_SIZE    16
+
+// /**
+// CONSTANT    :: OSPF_LSDB_INDEX_AGE_BUCKETS : 64
+// DESCRIPTION :: Number of buckets of the age wheel of an index, a power
+//                of 2
+// **/
+#define OSPF_LSDB_INDEX_AGE_BUCKETS     64
+
+// /**
+// STRUCT      :: OspfLsdbIndexEntry
+// DESCRIPTION :: Entry of the LSDB index
+// **/
+struct OspfLsdbIndexEntry
+{
+    const void* scope;                  // LSDB list of the LSA
+    unsigned int linkStateId;
+    unsigned int advertisingRouter;
+    void* item;                         // list item holding the LSA
+    OspfLsdbIndexEntry* next;           // in the hash chain
+
+    Int64 ageDue;                       // age clock the LSA is due at
+    OspfLsdbIndexEntry* ageNext;        // in the age wheel bucket
+    OspfLsdbIndexEntry** agePrevNext;   // link to the entry, NULL if not
+                                        // on the age wheel
+};
+
+// /**
+// STRUCT      :: OspfLsdbIndex
+// DESCRIPTION :: Hash index of one or more LSDB lists
+// **/
+struct OspfLsdbIndex
+{
+    OspfLsdbIndexEntry** bucket;
+    int numBuckets;
+    int numEntries;
+
+    OspfLsdbIndexEntry* ageBucket[OSPF_LSDB_INDEX_AGE_BUCKETS];
+    Int64 ageClock;                     // seconds of LS age counted
+    Int64 ageScan;                      // first clock not yet scanned
+};
+
+// /**
+// API        :: OspfLsdbIndexCreate
+// LAYER      :: Network
+// PURPOSE    :: Create an empty LSDB index
+// PARAMETERS :: None
+// RETURN     :: OspfLsdbIndex* : new index
+// **/
+OspfLsdbIndex* OspfLsdbIndexCreate();
+
+// /**
+// API        :: OspfLsdbIndexClear
+// LAYER      :: Network
+// PURPOSE    :: Remove all entries of an index
+// PARAMETERS ::
+// + index     : OspfLsdbIndex* : index
+// RETURN     :: void :
+// **/
+void OspfLsdbIndexClear(OspfLsdbIndex* index);
+
+// /**
+// API        :: OspfLsdbIndexFree
+// LAYER      :: Network
+// PURPOSE    :: Free an index and its entries.  The list items are not
+//               touched.
+// PARAMETERS ::
+// + index     : OspfLsdbIndex* : index
+// RETURN     :: void :
+// **/
+void OspfLsdbIndexFree(OspfLsdbIndex* index);
+
+// /**
+// API        :: OspfLsdbIndexInsert
+// LAYER      :: Network
+// PURPOSE    :: Add the item of an LSA that was added at the end of an
+//               LSDB list
+// PARAMETERS ::
+// + index             : OspfLsdbIndex* : index
+// + scope             : const void*    : LSDB list
+// + linkStateId       : unsigned int   : Link State ID of the LSA
+// + advertisingRouter : unsigned int   : Advertising Router of the LSA
+// + item              : void*          : list item holding the LSA
+// RETURN     :: void :
+// **/
+void OspfLsdbIndexInsert(
+    OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter,
+    void* item);
+
+// /**
+// API        :: OspfLsdbIndexRemove
+// LAYER      :: Network
+// PURPOSE    :: Remove the item of an LSA that is removed from an LSDB
+//               list.  The LSA is also taken off the age wheel.
+// PARAMETERS ::
+// + index             : OspfLsdbIndex* : index
+// + scope             : const void*    : LSDB list
+// + linkStateId       : unsigned int   : Link State ID of the LSA
+// + advertisingRouter : unsigned int   : Advertising Router of the LSA
+// + item              : void*          : list item holding the LSA
+// RETURN     :: void :
+// **/
+void OspfLsdbIndexRemove(
+    OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter,
+    void* item);
+
+// /**
+// API        :: OspfLsdbIndexLookup
+// LAYER      :: Network
+// PURPOSE    :: Find the item of an LSA
+// PARAMETERS ::
+// + index             : const OspfLsdbIndex* : index
+// + scope             : const void*          : LSDB list
+// + linkStateId       : unsigned int         : Link State ID
+// + advertisingRouter : unsigned int         : Advertising Router
+// RETURN     :: void* : first list item with the key, NULL if none
+// **/
+void* OspfLsdbIndexLookup(
+    const OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter);
+
+// /**
+// API        :: OspfLsdbIndexLookupById
+// LAYER      :: Network
+// PURPOSE    :: Find the item of an LSA by Link State ID only
+// PARAMETERS ::
+// + index       : const OspfLsdbIndex* : index
+// + scope       : const void*          : LSDB list
+// + linkStateId : unsigned int         : Link State ID
+// RETURN     :: void* : first list item with the Link State ID, NULL if
+//                       none
+// **/
+void* OspfLsdbIndexLookupById(
+    const OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId);
+
+// /**
+// API        :: OspfLsdbIndexScheduleAge
+// LAYER      :: Network
+// PURPOSE    :: Put the item of an LSA on the age wheel, due when the age
+//               clock has advanced by the given number of seconds, at
+//               least one.  An item already on the wheel is moved.
+// PARAMETERS ::
+// + index             : OspfLsdbIndex* : index
+// + scope             : const void*    : LSDB list
+// + linkStateId       : unsigned int   : Link State ID of the LSA
+// + advertisingRouter : unsigned int   : Advertising Router of the LSA
+// + item              : void*          : list item holding the LSA
+// + seconds           : int            : seconds until the LSA is due,
+//                                        negative to take it off the wheel
+// RETURN     :: void :
+// **/
+void OspfLsdbIndexScheduleAge(
+    OspfLsdbIndex* index,
+    const void* scope,
+    unsigned int linkStateId,
+    unsigned int advertisingRouter,
+    void* item,
+    int seconds);
+
+// /**
+// API        :: OspfLsdbIndexAdvanceAge
+// LAYER      :: Network
+// PURPOSE    :: Advance the age clock after the LSAs were aged
+// PARAMETERS ::
+// + index     : OspfLsdbIndex* : index
+// + seconds   : int            : seconds the LSAs were aged by
+// RETURN     :: void :
+// **/
+void OspfLsdbIndexAdvanceAge(OspfLsdbIndex* index, int seconds);
+
+// /**
+// API        :: OspfLsdbIndexNextDue
+// LAYER      :: Network
+// PURPOSE    :: Take the next due item off the age wheel
+// PARAMETERS ::
+// + index     : OspfLsdbIndex* : index
+// + scope     : const void**   : set to the LSDB list of the item, if not
+//                                NULL
+// RETURN     :: void* : list item, NULL if none is due
+// **/
+void* OspfLsdbIndexNextDue(OspfLsdbIndex* index, const void** scope);
+
+#endif /* ROUTING_OSPF_LSDB_INDEX_H */
@@ -139,6 +139,9 @@ typedef std::pair<int, NodeAddress> nbrAdvanceParams;
 
 #define OSPFv2_DEBUG 0
 #define OSPFv2_DEBUG_SPT 0
+// With OSPFv2-INCREMENTAL-SPF, also run every SPF calculation in full
+// and check that it gives the same routes
+#define OSPFv2_DEBUG_INCREMENTAL_SPF 0
 #define OSPFv2_DEBUG_LSDB 0 
 #define OSPFv2_DEBUG_ISM 0
 #define OSPFv2_DEBUG_SYNC 0
@@ -1398,80 +1401,73 @@ void Ospfv2PrintProtocolPacket(Ospfv2CommonHeader* ospfHeader)
 
 
 //-------------------------------------------------------------------------//
-// NAME: Ospfv2PrintVertexList
-// PURPOSE: Print each vertex item from the given list. This function is
-//          called from Ospfv2PrintCandidateList() and
-//          Ospfv2PrintShortestPathList()
+// NAME: Ospfv2PrintVertex
+// PURPOSE: Print a vertex of the candidate list or shortest path list.
 // RETURN: None.
 //-------------------------------------------------------------------------//
 
 static
-void Ospfv2PrintVertexList(Ospfv2List* list)
+void Ospfv2PrintVertex(Ospfv2Vertex* entry)
 {
-    Ospfv2ListItem* listItem = list->first;
-
-    while (listItem)
-    {
-        int i = 1;
-        Ospfv2Vertex* entry;
-        Ospfv2ListItem* nextHopItem;
-        char vertexIdStr[20];
-        char vertexTypeStr[25];
+    int i = 1;
+    Ospfv2ListItem* nextHopItem;
+    char vertexIdStr[20];
+    char vertexTypeStr[25];
 
-        entry = (Ospfv2Vertex*) listItem->data;
-        IO_ConvertIpAddressToString(entry->vertexId, vertexIdStr);
-
-        if (entry->vertexType == OSPFv2_VERTEX_ROUTER) {
-            strcpy(vertexTypeStr, "OSPFv2_VERTEX_ROUTER");
-        }
-        else if (entry->vertexType == OSPFv2_VERTEX_NETWORK) {
-            strcpy(vertexTypeStr, "OSPFv2_VERTEX_NETWORK");
-        }
-        else {
-            strcpy(vertexTypeStr, "Unknown Vertex Type");
-            ERROR_Assert(FALSE, "Unknown Vertex Type\n");
-        }
+    IO_ConvertIpAddressToString(entry->vertexId, vertexIdStr);
 
-        printf("    Vertex ID = %15s\n", vertexIdStr);
-        printf("    Vertex Type = %s\n", vertexTypeStr);
-        printf("    metric = %d\n", entry->distance);
+    if (entry->vertexType == OSPFv2_VERTEX_ROUTER) {
+        strcpy(vertexTypeStr, "OSPFv2_VERTEX_ROUTER");
+    }
+    else if (entry->vertexType == OSPFv2_VERTEX_NETWORK) {
+        strcpy(vertexTypeStr, "OSPFv2_VERTEX_NETWORK");
+    }
+    else {
+        strcpy(vertexTypeStr, "Unknown Vertex Type");
+        ERROR_Assert(FALSE, "Unknown Vertex Type\n");
+    }
 
-        nextHopItem = entry->nextHopList->first;
+    printf("    Vertex ID = %15s\n", vertexIdStr);
+    printf("    Vertex Type = %s\n", vertexTypeStr);
+    printf("    metric = %d\n", entry->distance);
 
-        while (nextHopItem)
-        {
-            Ospfv2NextHopListItem* nextHopInfo = NULL;
-            char nextHopStr[MAX_ADDRESS_STRING_LENGTH];
+    nextHopItem = entry->nextHopList->first;
 
-            nextHopInfo = (Ospfv2NextHopListItem*) nextHopItem->data;
-            IO_ConvertIpAddressToString(nextHopInfo->nextHop, nextHopStr);
+    while (nextHopItem)
+    {
+        Ospfv2NextHopListItem* nextHopInfo = NULL;
+        char nextHopStr[MAX_ADDRESS_STRING_LENGTH];
 
-            printf("    NextHop[%d] = %s\n", i, nextHopStr);
-            nextHopItem = nextHopItem->next;
-            i += 1;
-        }
+        nextHopInfo = (Ospfv2NextHopListItem*) nextHopItem->data;
+        IO_ConvertIpAddressToString(nextHopInfo->nextHop, nextHopStr);
 
-        listItem = listItem->next;
+        printf("    NextHop[%d] = %s\n", i, nextHopStr);
+        nextHopItem = nextHopItem->next;
+        i += 1;
     }
 }
 
 
 //-------------------------------------------------------------------------//
 // NAME: Ospfv2PrintCandidateList
-// PURPOSE: Print the content of the candidate list.
+// PURPOSE: Print the content of the candidate list, in heap order.
 // RETURN: None.
 //-------------------------------------------------------------------------//
 
 static
 void Ospfv2PrintCandidateList(
     Node* node,
-    Ospfv2List* candidateList)
+    Ospfv2SpfIndex* index)
 {
+    int i;
 
     printf("Candidate list for node %u\n", node->nodeId);
-    printf("    size = %d\n", candidateList->size);
+    printf("    size = %d\n", index->heapSize);
 
-    Ospfv2PrintVertexList(candidateList);
+    for (i = 0; i < index->heapSize; i++)
+    {
+        Ospfv2PrintVertex(index->heap[i]);
+    }
 }
 
 
@@ -1487,10 +1483,16 @@ void Ospfv2PrintShortestPathList(
     Ospfv2List* shortestPathList)
 {
 
+    Ospfv2ListItem* listItem = shortestPathList->first;
+
     printf("Shortest path list for node %u\n", node->nodeId);
     printf("    size = %d\n", shortestPathList->size);
 
-    Ospfv2PrintVertexList(shortestPathList);
+    while (listItem)
+    {
+        Ospfv2PrintVertex((Ospfv2Vertex*) listItem->data);
+        listItem = listItem->next;
+    }
 }
 
 
@@ -2423,9 +2425,24 @@ void Ospfv2InitList(Ospfv2List** list)
 
     tmpList->size = 0;
     tmpList->first = tmpList->last = NULL;
+    tmpList->lsaIndex = NULL;
     *list = tmpList;
 }
 
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2InitLSDBList
+// PURPOSE: Initialize a list of the LSDB.  The LSAs of the list are
+//          indexed by Link State ID and Advertising Router, so the list
+//          must only hold LSAs.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+void Ospfv2InitLSDBList(Ospfv2List** list)
+{
+    Ospfv2InitList(list);
+    (*list)->lsaIndex = OspfLsdbIndexCreate();
+}
+
 //-------------------------------------------------------------------------//
 // NAME: Ospfv2InitNonBroadcastNeighborList
 // PURPOSE: Initialize Non Broadacast  list structure.
@@ -2444,6 +2461,39 @@ void Ospfv2InitNonBroadcastNeighborList(
     *list = tmpList;
 }
 
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2ScheduleLSAAge
+// PURPOSE: Put the LSA of an LSDB list item on the age wheel of the list,
+//          due when its LS age reaches LSRefreshTime or else MaxAge.  An
+//          LSA at MaxAge is taken off, as it is flushed through the
+//          MaxAge list.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2ScheduleLSAAge(Ospfv2List* list, Ospfv2ListItem* item)
+{
+    Ospfv2LinkStateHeader* LSHeader = (Ospfv2LinkStateHeader*) item->data;
+    int age = LSHeader->linkStateAge & ~OSPFv2_DO_NOT_AGE;
+    int seconds = -1;
+
+    if (age < OSPFv2_LS_REFRESH_TIME / SECOND)
+    {
+        seconds = (int) (OSPFv2_LS_REFRESH_TIME / SECOND) - age;
+    }
+    else if (age < OSPFv2_LSA_MAX_AGE / SECOND)
+    {
+        seconds = (int) (OSPFv2_LSA_MAX_AGE / SECOND) - age;
+    }
+
+    OspfLsdbIndexScheduleAge(list->lsaIndex,
+                             list,
+                             LSHeader->linkStateID,
+                             LSHeader->advertisingRouter,
+                             item,
+                             seconds);
+}
+
 //-------------------------------------------------------------------------//
 // NAME: Ospfv2InsertToList
 // PURPOSE: Inserts an item to a list
@@ -2484,6 +2534,18 @@ void Ospfv2InsertToList(
     }
 
     list->size++;
+
+    if (list->lsaIndex != NULL)
+    {
+        Ospfv2LinkStateHeader* LSHeader = (Ospfv2LinkStateHeader*) data;
+
+        OspfLsdbIndexInsert(list->lsaIndex,
+                            list,
+                            LSHeader->linkStateID,
+                            LSHeader->advertisingRouter,
+                            listItem);
+        Ospfv2ScheduleLSAAge(list, listItem);
+    }
 }
 
 //-------------------------------------------------------------------------//
@@ -2613,6 +2675,18 @@ void Ospfv2RemoveFromList(
 
     nextListItem = listItem->next;
 
+    if (list->lsaIndex != NULL)
+    {
+        Ospfv2LinkStateHeader* LSHeader =
+            (Ospfv2LinkStateHeader*) listItem->data;
+
+        OspfLsdbIndexRemove(list->lsaIndex,
+                            list,
+                            LSHeader->linkStateID,
+                            LSHeader->advertisingRouter,
+                            listItem);
+    }
+
     if (list->size == 1)
     {
         list->first = list->last = NULL;
@@ -2756,6 +2830,11 @@ void Ospfv2FreeList(Node* node, Ospfv2List* list, BOOL type)
         MEM_free(tempItem);
     }
 
+    if (list->lsaIndex != NULL)
+    {
+        OspfLsdbIndexFree(list->lsaIndex);
+    }
+
     MEM_free(list);
 }
 
@@ -2838,8 +2917,18 @@ void Ospfv2DeleteList(Node* node, Ospfv2List* list, BOOL type)
 
     ERROR_Assert(list->size == 0,
         "List is being deleted!! Size must be 0\n");
+
+    OspfLsdbIndex* lsaIndex = list->lsaIndex;
+
     memset(list, 0, sizeof(Ospfv2List));
 
+    // The list stays an LSDB list
+    if (lsaIndex != NULL)
+    {
+        OspfLsdbIndexClear(lsaIndex);
+        list->lsaIndex = lsaIndex;
+    }
+
 }
 
 
@@ -4608,7 +4697,19 @@ Ospfv2LinkStateHeader* Ospfv2LookupLSAList(
 {
     Ospfv2LinkStateHeader* listLSHeader = NULL;
 
-    Ospfv2ListItem* item = list->first;
+    Ospfv2ListItem* item = NULL;
+
+    if (list->lsaIndex != NULL)
+    {
+        item = (Ospfv2ListItem*) OspfLsdbIndexLookup(list->lsaIndex,
+                                                     list,
+                                                     linkStateID,
+                                                     advertisingRouter);
+
+        return item ? (Ospfv2LinkStateHeader*) item->data : NULL;
+    }
+
+    item = list->first;
 
     while (item)
     {
@@ -4675,7 +4776,17 @@ Ospfv2ListItem* Ospfv2GetLSAListItem(
 {
     Ospfv2LinkStateHeader* listLSHeader = NULL;
 
-    Ospfv2ListItem* item = list->first;
+    Ospfv2ListItem* item = NULL;
+
+    if (list->lsaIndex != NULL)
+    {
+        return (Ospfv2ListItem*) OspfLsdbIndexLookup(list->lsaIndex,
+                                                     list,
+                                                     linkStateID,
+                                                     advertisingRouter);
+    }
+
+    item = list->first;
 
     while (item)
     {
@@ -4715,7 +4826,18 @@ Ospfv2LinkStateHeader* Ospfv2LookupLSAListByID(
 
     Ospfv2LinkStateHeader* listLSHeader = NULL;
 
-    Ospfv2ListItem* item = list->first;
+    Ospfv2ListItem* item = NULL;
+
+    if (list->lsaIndex != NULL)
+    {
+        item = (Ospfv2ListItem*) OspfLsdbIndexLookupById(list->lsaIndex,
+                                                         list,
+                                                         linkStateID);
+
+        return item ? (Ospfv2LinkStateHeader*) item->data : NULL;
+    }
+
+    item = list->first;
 
     while (item)
     {
@@ -5979,6 +6101,244 @@ void Ospfv2ScheduleLSA(
 }
 
 
+//-------------------------------------------------------------------------//
+// NAME         :Ospfv2SpfHashVertex()
+// PURPOSE      :Hash of a vertex for the vertex table of the SPF index
+// ASSUMPTION   :None
+// RETURN VALUE :Hash value
+//-------------------------------------------------------------------------//
+
+static
+unsigned int Ospfv2SpfHashVertex(
+    Ospfv2VertexType vertexType,
+    NodeAddress vertexId)
+{
+    return ((unsigned int) vertexId * 2654435761U) ^ (unsigned) vertexType;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME         :Ospfv2SpfGetIndex()
+// PURPOSE      :Get the SPF index of an area, creating it if needed
+// ASSUMPTION   :None
+// RETURN VALUE :Ospfv2SpfIndex*
+//-------------------------------------------------------------------------//
+
+static
+Ospfv2SpfIndex* Ospfv2SpfGetIndex(Ospfv2Area* thisArea)
+{
+    if (thisArea->spfIndex == NULL)
+    {
+        Ospfv2SpfIndex* index =
+            (Ospfv2SpfIndex*) MEM_malloc(sizeof(Ospfv2SpfIndex));
+
+        memset(index, 0, sizeof(Ospfv2SpfIndex));
+        index->tableSize = 64;
+        index->table = (Ospfv2Vertex**)
+            MEM_malloc(index->tableSize * sizeof(Ospfv2Vertex*));
+        memset(index->table, 0, index->tableSize * sizeof(Ospfv2Vertex*));
+
+        thisArea->spfIndex = index;
+    }
+    return thisArea->spfIndex;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME         :Ospfv2SpfLookupVertex()
+// PURPOSE      :Find a vertex in the SPF index
+// ASSUMPTION   :None
+// RETURN VALUE :Pointer to vertex, NULL if not found
+//-------------------------------------------------------------------------//
+
+static
+Ospfv2Vertex* Ospfv2SpfLookupVertex(
+    Ospfv2SpfIndex* index,
+    Ospfv2VertexType vertexType,
+    NodeAddress vertexId)
+{
+    unsigned int mask = index->tableSize - 1;
+    unsigned int slot = Ospfv2SpfHashVertex(vertexType, vertexId) & mask;
+
+    while (index->table[slot] != NULL)
+    {
+        Ospfv2Vertex* v = index->table[slot];
+
+        if (v->vertexId == vertexId && v->vertexType == vertexType)
+        {
+            return v;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME         :Ospfv2SpfInsertIntoTable()
+// PURPOSE      :Put a vertex into the vertex table of the SPF index
+// ASSUMPTION   :Vertex not in the table, and table has a free slot
+// RETURN VALUE :None
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfInsertIntoTable(
+    Ospfv2Vertex** table,
+    int tableSize,
+    Ospfv2Vertex* v)
+{
+    unsigned int mask = tableSize - 1;
+    unsigned int slot =
+        Ospfv2SpfHashVertex(v->vertexType, v->vertexId) & mask;
+
+    while (table[slot] != NULL)
+    {
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = v;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME         :Ospfv2SpfGetVertex()
+// PURPOSE      :Find a vertex in the SPF index, adding it if not found.
+//               A new vertex is neither a candidate nor in the shortest
+//               path list.
+// ASSUMPTION   :None
+// RETURN VALUE :Pointer to vertex
+//-------------------------------------------------------------------------//
+
+static
+Ospfv2Vertex* Ospfv2SpfGetVertex(
+    Ospfv2SpfIndex* index,
+    Ospfv2VertexType vertexType,
+    NodeAddress vertexId)
+{
+    Ospfv2Vertex* v = Ospfv2SpfLookupVertex(index, vertexType, vertexId);
+
+    if (v != NULL)
+    {
+        return v;
+    }
+
+    // Keep the table at most half full
+    if (2 * (index->numVertices + 1) > index->tableSize)
+    {
+        int newSize = index->tableSize * 2;
+        Ospfv2Vertex** newTable = (Ospfv2Vertex**)
+            MEM_malloc(newSize * sizeof(Ospfv2Vertex*));
+        int i;
+
+        memset(newTable, 0, newSize * sizeof(Ospfv2Vertex*));
+
+        for (i = 0; i < index->tableSize; i++)
+        {
+            if (index->table[i] != NULL)
+            {
+                Ospfv2SpfInsertIntoTable(newTable, newSize, index->table[i]);
+            }
+        }
+
+        MEM_free(index->table);
+        index->table = newTable;
+        index->tableSize = newSize;
+    }
+
+    v = (Ospfv2Vertex*) MEM_malloc(sizeof(Ospfv2Vertex));
+    memset(v, 0, sizeof(Ospfv2Vertex));
+
+    v->vertexId = vertexId;
+    v->vertexType = vertexType;
+    v->LSA = NULL;
+    v->distance = OSPFv2_LS_INFINITY;
+    v->heapIndex = -1;
+    v->inShortestPath = FALSE;
+    v->lsaChanged = FALSE;
+    v->affected = FALSE;
+    v->parent = NULL;
+    v->numParents = 0;
+    v->maxParents = 0;
+    Ospfv2InitList(&v->nextHopList);
+
+    Ospfv2SpfInsertIntoTable(index->table, index->tableSize, v);
+    index->numVertices++;
+
+    return v;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME         :Ospfv2SpfNoteLSAChange()
+// PURPOSE      :Remember that the router or network LSA of a vertex has
+//               been added, changed, aged out or removed, so that the
+//               next incremental SPF calculation recalculates the vertex.
+// ASSUMPTION   :None
+// RETURN VALUE :None
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfNoteLSAChange(
+    Node* node,
+    char* LSA,
+    unsigned int areaId)
+{
+    Ospfv2LinkStateHeader* LSHeader = (Ospfv2LinkStateHeader*) LSA;
+    Ospfv2VertexType vertexType;
+    Ospfv2Area* thisArea = NULL;
+    Ospfv2SpfIndex* index = NULL;
+    Ospfv2Vertex* v = NULL;
+
+    if (LSHeader->linkStateType == OSPFv2_ROUTER)
+    {
+        vertexType = OSPFv2_VERTEX_ROUTER;
+    }
+    else if (LSHeader->linkStateType == OSPFv2_NETWORK)
+    {
+        vertexType = OSPFv2_VERTEX_NETWORK;
+    }
+    else
+    {
+        // Only router and network LSAs are vertices of the tree
+        return;
+    }
+
+    thisArea = Ospfv2GetArea(node, areaId);
+
+    if (thisArea == NULL)
+    {
+        return;
+    }
+
+    index = Ospfv2SpfGetIndex(thisArea);
+    v = Ospfv2SpfGetVertex(index, vertexType, LSHeader->linkStateID);
+
+    if (v->lsaChanged)
+    {
+        return;
+    }
+
+    if (index->numChanged == index->maxChanged)
+    {
+        int newSize = MAX(16, index->maxChanged * 2);
+        Ospfv2Vertex** newChanged = (Ospfv2Vertex**)
+            MEM_malloc(newSize * sizeof(Ospfv2Vertex*));
+
+        if (index->changed != NULL)
+        {
+            memcpy(newChanged,
+                   index->changed,
+                   index->numChanged * sizeof(Ospfv2Vertex*));
+            MEM_free(index->changed);
+        }
+        index->changed = newChanged;
+        index->maxChanged = newSize;
+    }
+
+    v->lsaChanged = TRUE;
+    index->changed[index->numChanged++] = v;
+}
+
+
 //-------------------------------------------------------------------------//
 // NAME         :Ospfv2RemoveLSAFromList()
 // PURPOSE      :Remove LSA from list
@@ -5997,10 +6357,19 @@ void Ospfv2RemoveLSAFromList(
         return;
     }
 
-    Ospfv2ListItem* listItem = list->first;
+    Ospfv2ListItem* listItem = NULL;
     Ospfv2LinkStateHeader* LSHeader = (Ospfv2LinkStateHeader*) LSA;
     Ospfv2LinkStateHeader* listLSHeader = NULL;
 
+#ifdef ADDON_MA
+    listItem = list->first;
+#else
+    // Start at the LSA in the list, if there is one
+    listItem = Ospfv2GetLSAListItem(list,
+                                    LSHeader->advertisingRouter,
+                                    LSHeader->linkStateID);
+#endif
+
     while (listItem)
     {
         listLSHeader = (Ospfv2LinkStateHeader*) listItem->data;
@@ -6239,12 +6608,14 @@ void Ospfv2RemoveLSAFromLSDB(
     {
         case OSPFv2_ROUTER:
         {
+            Ospfv2SpfNoteLSAChange(node, LSA, areaId);
             Ospfv2RemoveLSAFromList(node, thisArea->routerLSAList, LSA);
             break;
         }
 
         case OSPFv2_NETWORK:
         {
+            Ospfv2SpfNoteLSAChange(node, LSA, areaId);
             Ospfv2RemoveLSAFromList(node, thisArea->networkLSAList, LSA);
             break;
         }
@@ -11548,7 +11919,14 @@ int Ospfv2UpdateLSAList(
 
     LSHeader = (Ospfv2LinkStateHeader*) LSA;
 
+#ifdef ADDON_MA
     listItem = list->first;
+#else
+    // Start at the LSA in the list, if there is one
+    listItem = Ospfv2GetLSAListItem(list,
+                                    LSHeader->advertisingRouter,
+                                    LSHeader->linkStateID);
+#endif
 
     if (Ospfv2DebugFlood(node))
     {
@@ -13064,12 +13442,14 @@ void Ospfv2InitArea(
     newArea->areaID = areaID;
     Ospfv2InitList(&newArea->areaAddrRange);
     Ospfv2InitList(&newArea->connectedInterface);
-    Ospfv2InitList(&newArea->routerLSAList);
-    Ospfv2InitList(&newArea->networkLSAList);
-    Ospfv2InitList(&newArea->routerSummaryLSAList);
-    Ospfv2InitList(&newArea->networkSummaryLSAList);
-    Ospfv2InitList(&newArea->groupMembershipLSAList);
+    Ospfv2InitLSDBList(&newArea->routerLSAList);
+    Ospfv2InitLSDBList(&newArea->networkLSAList);
+    Ospfv2InitLSDBList(&newArea->routerSummaryLSAList);
+    Ospfv2InitLSDBList(&newArea->networkSummaryLSAList);
+    Ospfv2InitLSDBList(&newArea->groupMembershipLSAList);
     Ospfv2InitList(&newArea->maxAgeLSAList);
+    Ospfv2InitList(&newArea->shortestPathList);
+    newArea->spfIndex = NULL;
 
     newArea->routerLSTimer = FALSE;
     newArea->routerLSAOriginateTime = (clocktype) 0;
@@ -17269,10 +17649,19 @@ BOOL Ospfv2InstallLSAInLSDB(
         NetworkIpGetRoutingProtocol(node, ROUTING_PROTOCOL_OSPFv2);
     Ospfv2LinkStateHeader* listLSHeader = NULL;
     Ospfv2LinkStateHeader* LSHeader = (Ospfv2LinkStateHeader*) LSA;
-    Ospfv2ListItem* item = list->first;
+    Ospfv2ListItem* item = NULL;
     char* newLSA = NULL;
     BOOL retVal = FALSE;
 
+#ifdef ADDON_MA
+    item = list->first;
+#else
+    // Start at the LSA in the list, if there is one
+    item = Ospfv2GetLSAListItem(list,
+                                LSHeader->advertisingRouter,
+                                LSHeader->linkStateID);
+#endif
+
     while (item)
     {
         // Get LS Header
@@ -17349,6 +17738,9 @@ BOOL Ospfv2InstallLSAInLSDB(
         {
             memcpy(listLSHeader, LSHeader, LSHeader->length);
         }
+
+        // The new instance has its own LS age
+        Ospfv2ScheduleLSAAge(list, item);
     }
     // LSA not found in list
     else
@@ -17358,6 +17750,11 @@ BOOL Ospfv2InstallLSAInLSDB(
         retVal = TRUE;
     }
 
+    if (retVal)
+    {
+        Ospfv2SpfNoteLSAChange(node, LSA, areaId);
+    }
+
 #ifdef ADDON_MA
     if (node->mAEnabled == TRUE)
     {
@@ -17817,7 +18214,8 @@ BOOL Ospfv2DemandCircuitEnabledForThisArea(Node* node,
 // NAME         :Ospfv2IncrementLSAgeInLSAList
 // PURPOSE      :Increment the link state age field of LSAs stored in the
 //               LSDB and handle appropriately if this age field passes
-//               a maximum age limit.
+//               a maximum age limit.  Only the LSAs due on the age wheel
+//               of the list are checked for LSRefreshTime and MaxAge.
 // ASSUMPTION   :None.
 //-------------------------------------------------------------------------//
 
@@ -17870,9 +18268,11 @@ void Ospfv2IncrementLSAgeInLSAList(
             tempAge = OSPFv2_LSA_MAX_AGE / SECOND;
         }
 
+        // An LSA already at MaxAge is flushed through the MaxAge list
         if (Ospfv2MaskDoNotAge(ospf, LSHeader->linkStateAge) ==
                                             (OSPFv2_LSA_MAX_AGE / SECOND))
         {
+            Ospfv2ScheduleLSAAge(list, item);
             item = item->next;
             continue;
         }
@@ -17894,17 +18294,27 @@ void Ospfv2IncrementLSAgeInLSAList(
                     LSHeader->linkStateType);
         }
 
+        item = item->next;
+    }
+
+    OspfLsdbIndexAdvanceAge(list->lsaIndex,
+                            (int) (ospf->incrementTime / SECOND));
+
+    while ((item = (Ospfv2ListItem*)
+                OspfLsdbIndexNextDue(list->lsaIndex, NULL)) != NULL)
+    {
+        Ospfv2LinkStateHeader* LSHeader =
+            (Ospfv2LinkStateHeader*) item->data;
+        unsigned short int age =
+            Ospfv2MaskDoNotAge(ospf, (short int) LSHeader->linkStateAge);
+
+        // Schedule the next threshold first, as the LSA may be removed
+        Ospfv2ScheduleLSAAge(list, item);
 
         // LS Age field of Self originated LSA reaches LSRefreshTime
         if ((LSHeader->advertisingRouter == ospf->routerID)
-            && ((Ospfv2MaskDoNotAge(ospf, tempAge) ==
-            (OSPFv2_LS_REFRESH_TIME / SECOND))))
+            && (age == (OSPFv2_LS_REFRESH_TIME / SECOND)))
         {
-            Ospfv2ListItem* tempItem;
-
-            tempItem = item;
-            item = item->next;
-
             if ((LSHeader->linkStateType >= OSPFv2_ROUTER
                 && LSHeader->linkStateType <= OSPFv2_ROUTER_AS_EXTERNAL)
                 || (LSHeader->linkStateType == OSPFv2_ROUTER_NSSA_EXTERNAL)
@@ -17912,7 +18322,7 @@ void Ospfv2IncrementLSAgeInLSAList(
                 || (LSHeader->linkStateType == OSPFv2_AS_SCOPE_OPAQUE))
                 /***** End: OPAQUE-LSA *****/
             {
-                Ospfv2RefreshLSA(node, tempItem, areaId);
+                Ospfv2RefreshLSA(node, item, areaId);
             }
 
             // M-OSPF Patch Start
@@ -17930,11 +18340,8 @@ void Ospfv2IncrementLSAgeInLSAList(
             // M-OSPF Patch End
         }
         // Expired, so remove from LSDB and flood.
-        else if (Ospfv2MaskDoNotAge(ospf, tempAge) ==
-                (OSPFv2_LSA_MAX_AGE / SECOND))
+        else if (age == (OSPFv2_LSA_MAX_AGE / SECOND))
         {
-            item = item->next;
-
             if (Ospfv2DebugFlood(node) || OSPFv2_DEBUG_LSDBErr)
             {
                 printf("    LSA for node %u deleted from LSDB\n",
@@ -17955,7 +18362,7 @@ void Ospfv2IncrementLSAgeInLSAList(
 
                 while (listItem)
                 {
-                    Ospfv2Area* thisArea = (Ospfv2Area*) item->data;
+                    Ospfv2Area* thisArea = (Ospfv2Area*) listItem->data;
 #ifdef JNE_LIB
                     if (!thisArea)
                     {
@@ -17971,6 +18378,7 @@ void Ospfv2IncrementLSAgeInLSAList(
                                                 (char*) LSHeader,
                                                 thisArea->areaID);
                     }
+                    listItem = listItem->next;
                 }
             }
             else if (LSHeader->linkStateType == OSPFv2_ROUTER_NSSA_EXTERNAL)
@@ -17984,7 +18392,7 @@ void Ospfv2IncrementLSAgeInLSAList(
 
                 while (listItem)
                 {
-                    Ospfv2Area* thisArea = (Ospfv2Area*) item->data;
+                    Ospfv2Area* thisArea = (Ospfv2Area*) listItem->data;
 #ifdef JNE_LIB
                     if (!thisArea)
                     {
@@ -18001,6 +18409,7 @@ void Ospfv2IncrementLSAgeInLSAList(
                                                 (char*) LSHeader,
                                                 thisArea->areaID);
                     }
+                    listItem = listItem->next;
                 }
             }
             else
@@ -18014,10 +18423,6 @@ void Ospfv2IncrementLSAgeInLSAList(
             }
             Ospfv2ScheduleSPFCalculation(node);
         }
-        else
-        {
-            item = item->next;
-        }
     }
 }
 
@@ -20477,18 +20882,340 @@ BOOL Ospfv2LSAHasMaxAge(Ospfv2Data* ospf, char* LSA)
     return FALSE;
 }
 
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfVertexPrecedes
+// PURPOSE: Order of the candidate heap.  Network vertex get preference
+//          over router vertex at the same distance.
+// RETURN: TRUE if vertex a is taken before vertex b.
+//-------------------------------------------------------------------------//
+
+static
+BOOL Ospfv2SpfVertexPrecedes(Ospfv2Vertex* a, Ospfv2Vertex* b)
+{
+    if (a->distance != b->distance)
+    {
+        return a->distance < b->distance;
+    }
+    return (a->vertexType == OSPFv2_VERTEX_NETWORK)
+           && (b->vertexType == OSPFv2_VERTEX_ROUTER);
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfHeapSiftUp
+// PURPOSE: Move a candidate up the heap after its distance decreased.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfHeapSiftUp(Ospfv2SpfIndex* index, Ospfv2Vertex* v)
+{
+    int pos = v->heapIndex;
+
+    while (pos > 0)
+    {
+        int parentPos = (pos - 1) / 2;
+        Ospfv2Vertex* parent = index->heap[parentPos];
+
+        if (!Ospfv2SpfVertexPrecedes(v, parent))
+        {
+            break;
+        }
+        index->heap[pos] = parent;
+        parent->heapIndex = pos;
+        pos = parentPos;
+    }
+    index->heap[pos] = v;
+    v->heapIndex = pos;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfHeapSiftDown
+// PURPOSE: Move the candidate at a position down the heap.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfHeapSiftDown(Ospfv2SpfIndex* index, int pos)
+{
+    Ospfv2Vertex* v = index->heap[pos];
+
+    while (TRUE)
+    {
+        int child = 2 * pos + 1;
+
+        if (child >= index->heapSize)
+        {
+            break;
+        }
+        if (child + 1 < index->heapSize
+            && Ospfv2SpfVertexPrecedes(index->heap[child + 1],
+                                       index->heap[child]))
+        {
+            child++;
+        }
+        if (!Ospfv2SpfVertexPrecedes(index->heap[child], v))
+        {
+            break;
+        }
+        index->heap[pos] = index->heap[child];
+        index->heap[pos]->heapIndex = pos;
+        pos = child;
+    }
+    index->heap[pos] = v;
+    v->heapIndex = pos;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfHeapInsert
+// PURPOSE: Add a vertex to the candidate heap.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfHeapInsert(Ospfv2SpfIndex* index, Ospfv2Vertex* v)
+{
+    if (index->heapSize == index->maxHeapSize)
+    {
+        int newSize = MAX(64, index->maxHeapSize * 2);
+        Ospfv2Vertex** newHeap = (Ospfv2Vertex**)
+            MEM_malloc(newSize * sizeof(Ospfv2Vertex*));
+
+        if (index->heap != NULL)
+        {
+            memcpy(newHeap,
+                   index->heap,
+                   index->heapSize * sizeof(Ospfv2Vertex*));
+            MEM_free(index->heap);
+        }
+        index->heap = newHeap;
+        index->maxHeapSize = newSize;
+    }
+
+    v->heapIndex = index->heapSize++;
+    Ospfv2SpfHeapSiftUp(index, v);
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfHeapRemoveFirst
+// PURPOSE: Remove the closest candidate from the candidate heap.
+// RETURN: The closest candidate.
+//-------------------------------------------------------------------------//
+
+static
+Ospfv2Vertex* Ospfv2SpfHeapRemoveFirst(Ospfv2SpfIndex* index)
+{
+    Ospfv2Vertex* first = index->heap[0];
+
+    index->heapSize--;
+    if (index->heapSize > 0)
+    {
+        index->heap[0] = index->heap[index->heapSize];
+        Ospfv2SpfHeapSiftDown(index, 0);
+    }
+    first->heapIndex = -1;
+    return first;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfAddParent
+// PURPOSE: Record a parent of a vertex in the shortest path tree.  If
+//          onlyParent is TRUE, the previous parents are dropped.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfAddParent(
+    Ospfv2Vertex* v,
+    Ospfv2Vertex* parent,
+    BOOL onlyParent)
+{
+    int i;
+
+    if (onlyParent)
+    {
+        v->numParents = 0;
+    }
+
+    for (i = 0; i < v->numParents; i++)
+    {
+        if (v->parent[i] == parent)
+        {
+            return;
+        }
+    }
+
+    if (v->numParents == v->maxParents)
+    {
+        int newSize = MAX(2, v->maxParents * 2);
+        Ospfv2Vertex** newParent = (Ospfv2Vertex**)
+            MEM_malloc(newSize * sizeof(Ospfv2Vertex*));
+
+        if (v->parent != NULL)
+        {
+            memcpy(newParent,
+                   v->parent,
+                   v->numParents * sizeof(Ospfv2Vertex*));
+            MEM_free(v->parent);
+        }
+        v->parent = newParent;
+        v->maxParents = newSize;
+    }
+
+    v->parent[v->numParents++] = parent;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfResetVertex
+// PURPOSE: Take a vertex out of the candidate list and shortest path
+//          tree of the SPF calculation.  Does not unlink the vertex
+//          from the shortest path list.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfResetVertex(Node* node, Ospfv2Vertex* v)
+{
+    Ospfv2DeleteList(node, v->nextHopList, FALSE);
+    v->distance = OSPFv2_LS_INFINITY;
+    v->heapIndex = -1;
+    v->inShortestPath = FALSE;
+    v->affected = FALSE;
+    v->seeded = FALSE;
+    v->numParents = 0;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfAppendToShortestPath
+// PURPOSE: Add a vertex at the end of the shortest path list.  The list
+//          item is part of the vertex, so that no memory is allocated.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfAppendToShortestPath(Ospfv2Area* thisArea, Ospfv2Vertex* v)
+{
+    Ospfv2List* list = thisArea->shortestPathList;
+    Ospfv2ListItem* listItem = &v->shortestPathItem;
+
+    memset(listItem, 0, sizeof(Ospfv2ListItem));
+    listItem->data = (void*) v;
+    listItem->prev = list->last;
+
+    if (list->last == NULL)
+    {
+        list->first = listItem;
+    }
+    else
+    {
+        list->last->next = listItem;
+    }
+    list->last = listItem;
+    list->size++;
+
+    v->inShortestPath = TRUE;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfResetTree
+// PURPOSE: Empty the shortest path list and candidate list of an area.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfResetTree(Node* node, Ospfv2Area* thisArea)
+{
+    Ospfv2SpfIndex* index = Ospfv2SpfGetIndex(thisArea);
+    int i;
+
+    for (i = 0; i < index->tableSize; i++)
+    {
+        if (index->table[i] != NULL)
+        {
+            Ospfv2SpfResetVertex(node, index->table[i]);
+        }
+    }
+
+    index->heapSize = 0;
+    thisArea->shortestPathList->first = NULL;
+    thisArea->shortestPathList->last = NULL;
+    thisArea->shortestPathList->size = 0;
+    index->treeValid = FALSE;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfFreeIndex
+// PURPOSE: Free the SPF index of an area and all its vertices.  The
+//          shortest path list is left empty.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfFreeIndex(Node* node, Ospfv2Area* thisArea)
+{
+    Ospfv2SpfIndex* index = thisArea->spfIndex;
+    int i;
+
+    if (index == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < index->tableSize; i++)
+    {
+        Ospfv2Vertex* v = index->table[i];
+
+        if (v != NULL)
+        {
+            Ospfv2FreeList(node, v->nextHopList, FALSE);
+            if (v->parent != NULL)
+            {
+                MEM_free(v->parent);
+            }
+            MEM_free(v);
+        }
+    }
+
+    MEM_free(index->table);
+    if (index->heap != NULL)
+    {
+        MEM_free(index->heap);
+    }
+    if (index->changed != NULL)
+    {
+        MEM_free(index->changed);
+    }
+    MEM_free(index);
+
+    thisArea->spfIndex = NULL;
+    thisArea->shortestPathList->first = NULL;
+    thisArea->shortestPathList->last = NULL;
+    thisArea->shortestPathList->size = 0;
+}
+
+
 //-------------------------------------------------------------------------//
 // NAME: Ospfv2RemoveLSAFromShortestPathList
-// PURPOSE:
-// RETURN:
+// PURPOSE: Remove the vertex of an LSA from the shortest path list.  The
+//          next SPF calculation of the area is then done in full.
+// RETURN: TRUE if the vertex was in the list, FALSE otherwise.
 //-------------------------------------------------------------------------//
 
 static
 BOOL Ospfv2RemoveLSAFromShortestPathList(
     Node* node,
-    Ospfv2List* shortestPathList,
+    Ospfv2Area* thisArea,
     char* LSA)
 {
+    Ospfv2List* shortestPathList = thisArea->shortestPathList;
     Ospfv2ListItem* listItem  = shortestPathList->first;
     Ospfv2Vertex* listVertex = NULL;
 
@@ -20498,7 +21225,28 @@ BOOL Ospfv2RemoveLSAFromShortestPathList(
         listVertex = (Ospfv2Vertex*) listItem->data;
         if (LSA == listVertex->LSA)
         {
-            Ospfv2RemoveFromList(node, shortestPathList, listItem, FALSE);
+            // Unlink the item, leaving its next pointer so that a loop
+            // over the list can go on.
+            if (listItem->prev == NULL)
+            {
+                shortestPathList->first = listItem->next;
+            }
+            else
+            {
+                listItem->prev->next = listItem->next;
+            }
+            if (listItem->next == NULL)
+            {
+                shortestPathList->last = listItem->prev;
+            }
+            else
+            {
+                listItem->next->prev = listItem->prev;
+            }
+            shortestPathList->size--;
+
+            listVertex->inShortestPath = FALSE;
+            thisArea->spfIndex->treeValid = FALSE;
             return TRUE;
         }
         listItem = listItem->next;
@@ -20509,61 +21257,45 @@ BOOL Ospfv2RemoveLSAFromShortestPathList(
 //-------------------------------------------------------------------------//
 // NAME: Ospfv2InShortestPathList
 // PURPOSE: Determine if a node is already in the shortest path list.
+//          While the tree is checked during an incremental calculation,
+//          a path of the given distance that is not longer than the
+//          vertex's own means the unchanged part of the tree is no
+//          longer correct, and the calculation is restarted in full.
 // RETURN: TRUE if node is in the shortest path list, FALSE otherwise.
 //-------------------------------------------------------------------------//
 
 static
 BOOL Ospfv2InShortestPathList(
     Node* node,
-    Ospfv2List* shortestPathList,
+    Ospfv2Area* thisArea,
     Ospfv2VertexType vertexType,
-    NodeAddress vertexId)
+    NodeAddress vertexId,
+    unsigned int distance)
 {
-    Ospfv2ListItem* listItem  = shortestPathList->first;
-    Ospfv2Vertex* listVertex = NULL;
-
-#ifdef nADDON_BOEINGFCS
-    // keep disabled for now (notice nADDON_BOEINGFCS)
-    int vNodeId = MAPPING_GetNodeIdFromInterfaceAddress(node, vertexId);
-#endif
+    Ospfv2SpfIndex* index = thisArea->spfIndex;
+    Ospfv2Vertex* v = Ospfv2SpfLookupVertex(index, vertexType, vertexId);
 
-    // Search through the shortest path list for the node.
-    while (listItem)
+    if (v == NULL || !v->inShortestPath)
     {
-        listVertex = (Ospfv2Vertex*) listItem->data;
-
-        // Found it.
-        if ((listVertex->vertexType == vertexType)
-            && (listVertex->vertexId == vertexId))
-        {
-            if (Ospfv2DebugSPT(node) || OSPFv2_DEBUG_ERRORS)
-            {
-                printf("    already in shortest path list\n");
-            }
-
-            return TRUE;
-        }
+        return FALSE;
+    }
 
-#ifdef nADDON_BOEINGFCS
-    // keep disabled for now (notice nADDON_BOEINGFCS)
-        if ((listVertex->vertexType == vertexType &&
-             RoutingCesRospfHaveLink(node, vNodeId, listVertex->vertexId)))
+    if (Ospfv2DebugSPT(node) || OSPFv2_DEBUG_ERRORS)
     {
-            return TRUE;
-    }
-#endif
-        listItem = listItem->next;
+        printf("    already in shortest path list\n");
     }
 
-    if (Ospfv2DebugSPT(node))
+    if (index->checkTree && distance <= v->distance)
     {
-        char vertexStr[MAX_ADDRESS_STRING_LENGTH];
-        IO_ConvertIpAddressToString(vertexId,vertexStr);
-        printf("    Vertex = %s of type %d not in shortest path list\n",
-                    vertexStr, vertexType);
+        if (Ospfv2DebugSPT(node))
+        {
+            printf("    path not longer than tree path, "
+                   "restarting SPF in full\n");
+        }
+        index->restart = TRUE;
     }
 
-    return FALSE;
+    return TRUE;
 }
 
 
@@ -21267,16 +21999,11 @@ BOOL Ospfv2LSAHasLink(Node* node, char*  wLSA, char*  vLSA)
 static
 Ospfv2Vertex*  Ospfv2FindCandidate(
     Node* node,
-    Ospfv2List* candidateList,
+    Ospfv2SpfIndex* index,
     Ospfv2VertexType vertexType,
     NodeAddress vertexId)
 {
-    Ospfv2ListItem* tempItem = candidateList->first;
-
-#ifdef nADDON_BOEINGFCS
-    // keep disabled for now (notice nADDON_BOEINGFCS)
-    int vNodeId = MAPPING_GetNodeIdFromInterfaceAddress(node, vertexId);
-#endif
+    Ospfv2Vertex* v = Ospfv2SpfLookupVertex(index, vertexType, vertexId);
 
     if (Ospfv2DebugSPT(node))
     {
@@ -21287,39 +22014,10 @@ Ospfv2Vertex*  Ospfv2FindCandidate(
         printf("        Vertex Type = %d\n", vertexType);
     }
 
-    // Search entire candidate list
-    while (tempItem)
-    {
-        Ospfv2Vertex* tempEntry = (Ospfv2Vertex*) tempItem->data;
-
-        if (Ospfv2DebugSPT(node))
-        {
-            char vertexStr[MAX_ADDRESS_STRING_LENGTH];
-            IO_ConvertIpAddressToString(tempEntry->vertexId,vertexStr);
-            printf("        tempEntry->vertexId = %s\n",
-                    vertexStr);
-            printf("        tempEntry->vertexType = %d\n",
-                    tempEntry->vertexType);
-            printf("        tempEntry->distance = %d\n",
-                    tempEntry->distance);
-        }
-
-        // Candidate found.
-        if ((tempEntry->vertexType == vertexType)
-            && (tempEntry->vertexId == vertexId))
-        {
-            return tempEntry;
-        }
-#ifdef nADDON_BOEINGFCS
-    // keep disabled for now (notice nADDON_BOEINGFCS)
-        if (tempEntry->vertexType == vertexType &&
-            RoutingCesRospfHaveLink(node, vNodeId, tempEntry->vertexId))
+    // Candidate found.
+    if (v != NULL && v->heapIndex >= 0)
     {
-            return tempEntry;
-    }
-#endif
-
-        tempItem = tempItem->next;
+        return v;
     }
 
     if (Ospfv2DebugSPT(node))
@@ -21340,11 +22038,11 @@ static
 void Ospfv2UpdateCandidateListUsingNetworkLSA(
     Node* node,
     Ospfv2Area* thisArea,
-    Ospfv2List* candidateList,
     Ospfv2Vertex* v)
 {
     Ospfv2Data* ospf = (Ospfv2Data*)
             NetworkIpGetRoutingProtocol(node, ROUTING_PROTOCOL_OSPFv2);
+    Ospfv2SpfIndex* index = thisArea->spfIndex;
 
     Ospfv2NetworkLSA* vLSA = NULL;
     NodeAddress* attachedRouter = NULL;
@@ -21388,9 +22086,10 @@ void Ospfv2UpdateCandidateListUsingNetworkLSA(
         if ((wLSA == NULL) || (Ospfv2LSAHasMaxAge(ospf, wLSA))
             || (!Ospfv2LSAHasLink(node, wLSA, v->LSA))
             || (Ospfv2InShortestPathList(node,
-                                         thisArea->shortestPathList,
+                                         thisArea,
                                          OSPFv2_VERTEX_ROUTER,
-                                         attachedRouter[i])))
+                                         attachedRouter[i],
+                                         v->distance)))
         {
             if (Ospfv2DebugSPT(node))
             {
@@ -21463,23 +22162,20 @@ void Ospfv2UpdateCandidateListUsingNetworkLSA(
         newVertexDistance = v->distance;
 
         candidateListItem = Ospfv2FindCandidate(node,
-                                                candidateList,
+                                                index,
                                                 newVertexType,
                                                 newVertexId);
 
         if (candidateListItem == NULL)
         {
             // Insert new candidate
-            candidateListItem = (Ospfv2Vertex*)
-                     MEM_malloc(sizeof(Ospfv2Vertex));
+            candidateListItem = Ospfv2SpfGetVertex(index,
+                                                   newVertexType,
+                                                   newVertexId);
 
-            candidateListItem->vertexId = newVertexId;
-            candidateListItem->vertexType = newVertexType;
             candidateListItem->LSA = wLSA;
             candidateListItem->distance = newVertexDistance;
 
-            Ospfv2InitList(&candidateListItem->nextHopList);
-
             if (Ospfv2SetNextHopForThisVertex(node, candidateListItem, v))
             {
                 if (Ospfv2DebugSPT(node))
@@ -21489,16 +22185,12 @@ void Ospfv2UpdateCandidateListUsingNetworkLSA(
                     printf("    Inserting new vertex %s\n", newVertexStr);
                 }
 
-                Ospfv2InsertToList(candidateList,
-                                   0,
-                                   (void*) candidateListItem);
+                Ospfv2SpfAddParent(candidateListItem, v, TRUE);
+                Ospfv2SpfHeapInsert(index, candidateListItem);
             }
             else
             {
-                Ospfv2FreeList(node,
-                               candidateListItem->nextHopList,
-                               FALSE);
-                MEM_free(candidateListItem);
+                Ospfv2SpfResetVertex(node, candidateListItem);
             }
         }
         else if (candidateListItem->distance > newVertexDistance)
@@ -21518,6 +22210,8 @@ void Ospfv2UpdateCandidateListUsingNetworkLSA(
                              candidateListItem->nextHopList,
                              FALSE);
             Ospfv2SetNextHopForThisVertex(node, candidateListItem, v);
+            Ospfv2SpfAddParent(candidateListItem, v, TRUE);
+            Ospfv2SpfHeapSiftUp(index, candidateListItem);
         }
         else if (candidateListItem->distance == newVertexDistance)
         {
@@ -21531,6 +22225,7 @@ void Ospfv2UpdateCandidateListUsingNetworkLSA(
 
             // Add new set of next hop values
             Ospfv2SetNextHopForThisVertex(node, candidateListItem, v);
+            Ospfv2SpfAddParent(candidateListItem, v, FALSE);
         }
         else
         {
@@ -21551,11 +22246,11 @@ static
 void Ospfv2UpdateCandidateListUsingRouterLSA(
     Node* node,
     Ospfv2Area* thisArea,
-    Ospfv2List* candidateList,
     Ospfv2Vertex* v)
 {
     Ospfv2Data* ospf = (Ospfv2Data*)
            NetworkIpGetRoutingProtocol(node, ROUTING_PROTOCOL_OSPFv2);
+    Ospfv2SpfIndex* index = thisArea->spfIndex;
 
     Ospfv2RouterLSA* vLSA = (Ospfv2RouterLSA*) v->LSA;
     char* wLSA = NULL;
@@ -21622,13 +22317,18 @@ void Ospfv2UpdateCandidateListUsingRouterLSA(
             continue;
         }
 
+        // linkList->metric is a SIGNED short, while newVertexDistance and
+        // v->distance are UNSIGNED.
+        newVertexDistance = v->distance + (unsigned short)linkList->metric;
+
         // RFC2328, Sec-16.1 (2.b & 2.c)
         if ((wLSA == NULL) || (Ospfv2LSAHasMaxAge(ospf, wLSA))
             || (!Ospfv2LSAHasLink(node, wLSA, v->LSA))
             || (Ospfv2InShortestPathList(node,
-                                         thisArea->shortestPathList,
+                                         thisArea,
                                          newVertexType,
-                                         linkList->linkID)))
+                                         linkList->linkID,
+                                         newVertexDistance)))
         {
             if (Ospfv2DebugSPT(node))
             {
@@ -21651,28 +22351,22 @@ void Ospfv2UpdateCandidateListUsingRouterLSA(
         wLSHeader = (Ospfv2LinkStateHeader*) wLSA;
 
         newVertexId = wLSHeader->linkStateID;
-        // linkList->metric is a SIGNED short, while newVertexDistance and
-        // v->distance are UNSIGNED.
-        newVertexDistance = v->distance + (unsigned short)linkList->metric;
 
         candidateListItem = Ospfv2FindCandidate(node,
-                                                candidateList,
+                                                index,
                                                 newVertexType,
                                                 newVertexId);
 
         if (candidateListItem == NULL)
         {
             // Insert new candidate
-            candidateListItem = (Ospfv2Vertex*)
-                     MEM_malloc(sizeof(Ospfv2Vertex));
+            candidateListItem = Ospfv2SpfGetVertex(index,
+                                                   newVertexType,
+                                                   newVertexId);
 
-            candidateListItem->vertexId = newVertexId;
-            candidateListItem->vertexType = newVertexType;
             candidateListItem->LSA = wLSA;
             candidateListItem->distance = newVertexDistance;
 
-            Ospfv2InitList(&candidateListItem->nextHopList);
-
             if (Ospfv2SetNextHopForThisVertex(node, candidateListItem, v))
             {
                 if (Ospfv2DebugSPT(node))
@@ -21682,14 +22376,12 @@ void Ospfv2UpdateCandidateListUsingRouterLSA(
                     printf("    Inserting new vertex %s\n", newVertexStr);
                 }
 
-                Ospfv2InsertToList(candidateList,
-                                   0,
-                                   (void*) candidateListItem);
+                Ospfv2SpfAddParent(candidateListItem, v, TRUE);
+                Ospfv2SpfHeapInsert(index, candidateListItem);
             }
             else
             {
-                Ospfv2FreeList(node, candidateListItem->nextHopList, FALSE);
-                MEM_free(candidateListItem);
+                Ospfv2SpfResetVertex(node, candidateListItem);
             }
         }
         else if (candidateListItem->distance > newVertexDistance)
@@ -21709,6 +22401,8 @@ void Ospfv2UpdateCandidateListUsingRouterLSA(
 
             Ospfv2DeleteList(node, candidateListItem->nextHopList, FALSE);
             Ospfv2SetNextHopForThisVertex(node, candidateListItem, v);
+            Ospfv2SpfAddParent(candidateListItem, v, TRUE);
+            Ospfv2SpfHeapSiftUp(index, candidateListItem);
         }
         else if (candidateListItem->distance == newVertexDistance)
         {
@@ -21722,6 +22416,7 @@ void Ospfv2UpdateCandidateListUsingRouterLSA(
 
             // Add new set of next hop values
             Ospfv2SetNextHopForThisVertex(node, candidateListItem, v);
+            Ospfv2SpfAddParent(candidateListItem, v, FALSE);
         }
         else
         {
@@ -21742,7 +22437,6 @@ static
 void Ospfv2UpdateCandidateList(
     Node* node,
     Ospfv2Area* thisArea,
-    Ospfv2List* candidateList,
     Ospfv2Vertex* v)
 {
 
@@ -21750,14 +22444,12 @@ void Ospfv2UpdateCandidateList(
     {
         Ospfv2UpdateCandidateListUsingNetworkLSA(node,
                                                  thisArea,
-                                                 candidateList,
                                                  v);
     }
     else
     {
         Ospfv2UpdateCandidateListUsingRouterLSA(node,
                                                 thisArea,
-                                                candidateList,
                                                 v);
     }
 }
@@ -21765,109 +22457,52 @@ void Ospfv2UpdateCandidateList(
 
 //-------------------------------------------------------------------------//
 // NAME: Ospfv2UpdateShortestPathList
-// PURPOSE: Add new entry to the shortest path list.
+// PURPOSE: Move the closest candidate to the shortest path list.
 // RETURN: The just added entry.
 //-------------------------------------------------------------------------//
 
 static
 Ospfv2Vertex* Ospfv2UpdateShortestPathList(
     Node* node,
-    Ospfv2Area* thisArea,
-    Ospfv2List* candidateList)
+    Ospfv2Area* thisArea)
 {
-    Ospfv2ListItem* candidateListItem = NULL;
-    Ospfv2ListItem* listItem = NULL;
-
+    Ospfv2SpfIndex* index = thisArea->spfIndex;
     Ospfv2Vertex* closestCandidate = NULL;
-    Ospfv2Vertex* listEntry = NULL;
-
-    Ospfv2Vertex* shortestPathListItem =
-        (Ospfv2Vertex*) MEM_malloc(sizeof(Ospfv2Vertex));
-
-    int lowestMetric = OSPFv2_LS_INFINITY;
-
-    listItem = candidateList->first;
-
-    // Get the vertex with the smallest metric from the candidate list...
-    while (listItem)
-    {
-        listEntry = (Ospfv2Vertex*) listItem->data;
-
-        if (listEntry->distance < (unsigned int) lowestMetric)
-        {
-            lowestMetric = listEntry->distance;
-
-            // Keep track of closest vertex
-            candidateListItem = listItem;
-            closestCandidate = listEntry;
-        }
-        // Network vertex get preference over router vertex
-        else if ((listEntry->distance == (unsigned int) lowestMetric)
-                && (candidateListItem)
-                && (closestCandidate->vertexType
-                            == OSPFv2_VERTEX_ROUTER)
-                && (listEntry->vertexType == OSPFv2_VERTEX_NETWORK))
-        {
-            // Keep track of closest vertex
-            candidateListItem = listItem;
-            closestCandidate = listEntry;
-        }
-
-        listItem = listItem->next;
-    }
 
 #ifdef JNE_LIB
-    if (!candidateListItem)
+    if (index->heapSize == 0)
     {
         JneWriteToLogFile(node, JNE::M_OSPF,"Error",
             "Candidate list is not exists.", 
             JNE::CRITICAL);
     }
 #endif
-    ERROR_Assert(candidateListItem, "Candidate list is not exists.\n");
+    ERROR_Assert(index->heapSize > 0, "Candidate list is not exists.\n");
 
-    memcpy(shortestPathListItem, closestCandidate, sizeof(Ospfv2Vertex));
+    // Get the vertex with the smallest metric from the candidate list...
+    closestCandidate = Ospfv2SpfHeapRemoveFirst(index);
 
     if (Ospfv2DebugSPT(node))
     {
         char vertexStr[MAX_ADDRESS_STRING_LENGTH];
-        IO_ConvertIpAddressToString(shortestPathListItem->vertexId,
-                                    vertexStr);
+        IO_ConvertIpAddressToString(closestCandidate->vertexId, vertexStr);
 
         printf("    added Vertex %s of type %d to shortest path list\n",
                     vertexStr,
-                    shortestPathListItem->vertexType);
-        printf("    metric is %d\n", shortestPathListItem->distance);
+                    closestCandidate->vertexType);
+        printf("    metric is %d\n", closestCandidate->distance);
+        printf("    C_List size now %d\n", index->heapSize);
     }
 
-    // Now insert it into the shortest path list...
-    Ospfv2InsertToList(thisArea->shortestPathList,
-                       0,
-                       (void*) shortestPathListItem);
-
-    if (Ospfv2DebugSPT(node))
-    {
-        char vertexStr[MAX_ADDRESS_STRING_LENGTH];
-        IO_ConvertIpAddressToString(closestCandidate->vertexId,vertexStr);
-        printf("    removing Vertex %s from candidate list\n",
-                    vertexStr);
-
-        printf("    size was %d\n", candidateList->size);
-    }
-
-    // And remove it from the candidate list since no longer available.
-    Ospfv2RemoveFromList(node, candidateList, candidateListItem, FALSE);
+    // ... and insert it into the shortest path list.
+    Ospfv2SpfAppendToShortestPath(thisArea, closestCandidate);
 
     if (Ospfv2DebugSPT(node))
     {
-        printf("    C_List size now %d\n", candidateList->size);
         Ospfv2PrintShortestPathList(node, thisArea->shortestPathList);
     }
 
-    // Update my routing table to reflect the new shortest path list.
-    Ospfv2UpdateIntraAreaRoute(node, thisArea, shortestPathListItem);
-
-    return shortestPathListItem;
+    return closestCandidate;
 }
 
 
@@ -22028,92 +22663,373 @@ void Ospfv2AddStubRouteToShortestPath(Node* node, Ospfv2Area* thisArea)
                                     linkList->linkID);
                     }
 
-                    if (intfId == -1)
-                    {
-                        Ospfv2LinkStateHeader* LSHeader = NULL;
-                        LSHeader = (Ospfv2LinkStateHeader*)
-                            Ospfv2LookupLSAList(thisArea->routerLSAList,
-                                                linkList->linkID,
-                                                     linkList->linkID);
-                        if (LSHeader != NULL)
-                        {
-                            Ospfv2RemoveLSAFromLSDB(node,
-                                                    (char*)LSHeader,
-                                                    thisArea->areaID);
-                            Ospfv2RemoveLSAFromShortestPathList(node,
-                                thisArea->shortestPathList,
-                                (char*)LSHeader);
-                            if (OSPFv2_DEBUG_TABLEErr)
-                            {
-                                Ospfv2PrintLSDB(node);
-                            }
-                        }
-                        continue;
-                    }
+                    if (intfId == -1)
+                    {
+                        Ospfv2LinkStateHeader* LSHeader = NULL;
+                        LSHeader = (Ospfv2LinkStateHeader*)
+                            Ospfv2LookupLSAList(thisArea->routerLSAList,
+                                                linkList->linkID,
+                                                     linkList->linkID);
+                        if (LSHeader != NULL)
+                        {
+                            Ospfv2RemoveLSAFromLSDB(node,
+                                                    (char*)LSHeader,
+                                                    thisArea->areaID);
+                            Ospfv2RemoveLSAFromShortestPathList(node,
+                                thisArea,
+                                (char*)LSHeader);
+                            if (OSPFv2_DEBUG_TABLEErr)
+                            {
+                                Ospfv2PrintLSDB(node);
+                            }
+                        }
+                        continue;
+                    }
+
+                    newRow.outIntf = intfId;
+                    newRow.nextHop = 0;
+                }
+                else
+                {
+                    if (tempV->nextHopList == NULL)
+                    {
+                        continue;
+                    }
+                    if (tempV->nextHopList->first == NULL)
+                    {
+                        continue;
+                    }
+                    if (tempV->nextHopList->first->data == NULL)
+                    {
+                        continue;
+                    }
+
+                    Ospfv2NextHopListItem* nextHopItem =
+                                        (Ospfv2NextHopListItem*)
+                                        tempV->nextHopList->first->data;
+
+                    newRow.nextHop = nextHopItem->nextHop;
+                    newRow.outIntf = nextHopItem->outIntf;
+
+                }
+
+                Ospfv2AddRoute(node, &newRow);
+            }
+        }
+
+        listItem = listItem->next;
+    }
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfHashLocalState()
+// PURPOSE: Hash the interface states and neighbors the SPF calculation
+//          depends on besides the LSDB.  An incremental calculation is
+//          only done if they did not change.
+// RETURN: Hash value.
+//-------------------------------------------------------------------------//
+
+static
+UInt32 Ospfv2SpfHashLocalState(Node* node)
+{
+    Ospfv2Data* ospf = (Ospfv2Data*)
+        NetworkIpGetRoutingProtocol(node, ROUTING_PROTOCOL_OSPFv2);
+    UInt32 hash = 2166136261U;
+    int i;
+
+    for (i = 0; i < node->numberInterfaces; i++)
+    {
+        Ospfv2ListItem* listItem = NULL;
+
+        hash = (hash ^ (UInt32) ospf->iface[i].state) * 16777619U;
+
+        if (ospf->iface[i].neighborList == NULL)
+        {
+            continue;
+        }
+
+        for (listItem = ospf->iface[i].neighborList->first;
+             listItem;
+             listItem = listItem->next)
+        {
+            Ospfv2Neighbor* nbrInfo = (Ospfv2Neighbor*) listItem->data;
+
+            hash = (hash ^ (UInt32) nbrInfo->neighborID) * 16777619U;
+            hash = (hash ^ (UInt32) nbrInfo->neighborIPAddress) * 16777619U;
+        }
+    }
+    return hash;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfAddSeed()
+// PURPOSE: Add a vertex of the unchanged tree to the seeds of an
+//          incremental SPF calculation, once.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfAddSeed(
+    Ospfv2Vertex* u,
+    Ospfv2Vertex*** seed,
+    int* numSeeds,
+    int* maxSeeds)
+{
+    if (u == NULL || !u->inShortestPath || u->seeded)
+    {
+        return;
+    }
+
+    if (*numSeeds == *maxSeeds)
+    {
+        int newSize = MAX(16, *maxSeeds * 2);
+        Ospfv2Vertex** newSeed = (Ospfv2Vertex**)
+            MEM_malloc(newSize * sizeof(Ospfv2Vertex*));
+
+        if (*seed != NULL)
+        {
+            memcpy(newSeed, *seed, *numSeeds * sizeof(Ospfv2Vertex*));
+            MEM_free(*seed);
+        }
+        *seed = newSeed;
+        *maxSeeds = newSize;
+    }
+    u->seeded = TRUE;
+    (*seed)[(*numSeeds)++] = u;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME: Ospfv2SpfSeedFromNeighbors()
+// PURPOSE: Collect the vertices of the unchanged tree that have a link to
+//          a vertex to be recalculated.  A link in the LSDB needs both
+//          ends, so they are found from the LSA of that vertex.
+// RETURN: None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfSeedFromNeighbors(
+    Node* node,
+    Ospfv2Area* thisArea,
+    Ospfv2Vertex* w,
+    Ospfv2Vertex*** seed,
+    int* numSeeds,
+    int* maxSeeds)
+{
+    Ospfv2Data* ospf = (Ospfv2Data*)
+        NetworkIpGetRoutingProtocol(node, ROUTING_PROTOCOL_OSPFv2);
+    Ospfv2SpfIndex* index = thisArea->spfIndex;
+    char* wLSA = NULL;
+    int numLinks = 0;
+    int i;
+
+    if (w->vertexType == OSPFv2_VERTEX_ROUTER)
+    {
+        wLSA = (char*) Ospfv2LookupLSAList(thisArea->routerLSAList,
+                                           w->vertexId,
+                                           w->vertexId);
+    }
+    else
+    {
+        wLSA = (char*) Ospfv2LookupLSAListByID(thisArea->networkLSAList,
+                                               w->vertexId);
+    }
 
-                    newRow.outIntf = intfId;
-                    newRow.nextHop = 0;
-                }
-                else
-                {
-                    if (tempV->nextHopList == NULL)
-                    {
-                        continue;
-                    }
-                    if (tempV->nextHopList->first == NULL)
-                    {
-                        continue;
-                    }
-                    if (tempV->nextHopList->first->data == NULL)
-                    {
-                        continue;
-                    }
+    if ((wLSA == NULL) || (Ospfv2LSAHasMaxAge(ospf, wLSA)))
+    {
+        return;
+    }
 
-                    Ospfv2NextHopListItem* nextHopItem =
-                                        (Ospfv2NextHopListItem*)
-                                        tempV->nextHopList->first->data;
+    if (w->vertexType == OSPFv2_VERTEX_ROUTER)
+    {
+        Ospfv2RouterLSA* routerLSA = (Ospfv2RouterLSA*) wLSA;
+        Ospfv2LinkInfo* nextLink = (Ospfv2LinkInfo*) (routerLSA + 1);
 
-                    newRow.nextHop = nextHopItem->nextHop;
-                    newRow.outIntf = nextHopItem->outIntf;
+        numLinks = routerLSA->numLinks;
 
-                }
+        for (i = 0; i < numLinks; i++)
+        {
+            Ospfv2LinkInfo* linkList = nextLink;
+            Ospfv2Vertex* u = NULL;
 
-                Ospfv2AddRoute(node, &newRow);
+            nextLink = (Ospfv2LinkInfo*)
+                ((QospfPerLinkQoSMetricInfo*)(nextLink + 1)
+                      + linkList->numTOS);
+
+            if (linkList->type == OSPFv2_POINT_TO_POINT)
+            {
+                u = Ospfv2SpfLookupVertex(index,
+                                          OSPFv2_VERTEX_ROUTER,
+                                          linkList->linkID);
+            }
+            else if (linkList->type == OSPFv2_TRANSIT)
+            {
+                u = Ospfv2SpfLookupVertex(index,
+                                          OSPFv2_VERTEX_NETWORK,
+                                          linkList->linkID);
             }
+
+            Ospfv2SpfAddSeed(u, seed, numSeeds, maxSeeds);
         }
+    }
+    else
+    {
+        Ospfv2NetworkLSA* networkLSA = (Ospfv2NetworkLSA*) wLSA;
+        NodeAddress* attachedRouter = ((NodeAddress*) (networkLSA + 1)) + 1;
 
-        listItem = listItem->next;
+        numLinks = (networkLSA->LSHeader.length
+                    - sizeof(Ospfv2NetworkLSA) - 4)
+                        / (sizeof(NodeAddress));
+
+        for (i = 0; i < numLinks; i++)
+        {
+            Ospfv2Vertex* u = Ospfv2SpfLookupVertex(index,
+                                                    OSPFv2_VERTEX_ROUTER,
+                                                    attachedRouter[i]);
+
+            Ospfv2SpfAddSeed(u, seed, numSeeds, maxSeeds);
+        }
     }
 }
 
 
 //-------------------------------------------------------------------------//
-// NAME: Ospfv2FreeVertexList()
-// PURPOSE: Free vertex list.
+// NAME: Ospfv2SpfPrepareIncremental()
+// PURPOSE: Start an incremental SPF calculation.  The vertices whose LSA
+//          has changed, and every vertex below them in the tree of the
+//          last calculation, are taken out of the tree.  The vertices of
+//          the remaining tree that link to them then give the first
+//          candidates.
 // RETURN: None.
 //-------------------------------------------------------------------------//
 
 static
-void Ospfv2FreeVertexList(Node* node, Ospfv2List* vertexList)
+void Ospfv2SpfPrepareIncremental(Node* node, Ospfv2Area* thisArea)
 {
+    Ospfv2SpfIndex* index = thisArea->spfIndex;
+    Ospfv2List* shortestPathList = thisArea->shortestPathList;
+    Ospfv2ListItem* listItem = NULL;
+    Ospfv2ListItem* nextItem = NULL;
+    Ospfv2Vertex** recalc = NULL;
+    int numRecalc = 0;
+    Ospfv2Vertex** seed = NULL;
+    int numSeeds = 0;
+    int maxSeeds = 0;
+    int i;
+    int j;
+
+    // Vertices are in the list in the order they were added to the
+    // tree, so parents come before their children.
+    for (listItem = shortestPathList->first;
+         listItem;
+         listItem = listItem->next)
+    {
+        Ospfv2Vertex* v = (Ospfv2Vertex*) listItem->data;
+
+        v->affected = v->lsaChanged;
+
+        for (j = 0; j < v->numParents && !v->affected; j++)
+        {
+            v->affected = v->parent[j]->affected;
+        }
+        if (v->affected)
+        {
+            numRecalc++;
+        }
+    }
+
+    // Changed vertices out of the tree may now be reached
+    for (i = 0; i < index->numChanged; i++)
+    {
+        if (!index->changed[i]->inShortestPath)
+        {
+            numRecalc++;
+        }
+    }
+
+    if (numRecalc == 0)
+    {
+        return;
+    }
+
+    recalc = (Ospfv2Vertex**)
+        MEM_malloc(numRecalc * sizeof(Ospfv2Vertex*));
+    numRecalc = 0;
+
+    for (i = 0; i < index->numChanged; i++)
+    {
+        if (!index->changed[i]->inShortestPath)
+        {
+            recalc[numRecalc++] = index->changed[i];
+        }
+    }
 
-    Ospfv2ListItem* listItem = vertexList->first;
+    // Keep the unaffected part of the tree in its order
+    listItem = shortestPathList->first;
+    shortestPathList->first = NULL;
+    shortestPathList->last = NULL;
+    shortestPathList->size = 0;
 
     while (listItem)
     {
-        Ospfv2Vertex* vertex = (Ospfv2Vertex*) listItem->data;
+        Ospfv2Vertex* v = (Ospfv2Vertex*) listItem->data;
 
-        Ospfv2FreeList(node, vertex->nextHopList, FALSE);
-        listItem = listItem->next;
+        nextItem = listItem->next;
+
+        if (v->affected)
+        {
+            Ospfv2SpfResetVertex(node, v);
+            recalc[numRecalc++] = v;
+        }
+        else
+        {
+            Ospfv2SpfAppendToShortestPath(thisArea, v);
+        }
+        listItem = nextItem;
     }
 
-    Ospfv2FreeList(node, vertexList, FALSE);
+    if (Ospfv2DebugSPT(node))
+    {
+        printf("    Node %u incremental SPF recalculates %d vertices, "
+               "keeps %d\n",
+               node->nodeId, numRecalc, shortestPathList->size);
+    }
+
+    for (i = 0; i < numRecalc; i++)
+    {
+        Ospfv2SpfSeedFromNeighbors(node,
+                                   thisArea,
+                                   recalc[i],
+                                   &seed,
+                                   &numSeeds,
+                                   &maxSeeds);
+    }
+
+    // The seeds are in the tree, so links between them are skipped and
+    // only the vertices to be recalculated become candidates.
+    for (i = 0; i < numSeeds; i++)
+    {
+        seed[i]->seeded = FALSE;
+        Ospfv2UpdateCandidateList(node, thisArea, seed[i]);
+    }
+
+    MEM_free(recalc);
+
+    if (seed != NULL)
+    {
+        MEM_free(seed);
+    }
 }
 
 
 //-------------------------------------------------------------------------//
 // NAME         :Ospfv2FindShortestPathForThisArea
-// PURPOSE      :Calculate the shortest path to all node in an area
+// PURPOSE      :Calculate the shortest path to all node in an area.
+//               If OSPFv2-INCREMENTAL-SPF is enabled, the tree of the last
+//               calculation is reused, and only the part of it below
+//               vertices whose LSA has changed is calculated again.
 // ASSUMPTION   :None.
 // RETURN VALUE :None.
 //-------------------------------------------------------------------------//
@@ -22126,8 +23042,13 @@ void Ospfv2FindShortestPathForThisArea(
     Ospfv2Data* ospf = (Ospfv2Data*)
         NetworkIpGetRoutingProtocol(node, ROUTING_PROTOCOL_OSPFv2);
 
-    Ospfv2List* candidateList = NULL;
     Ospfv2Vertex* tempV = NULL;
+    Ospfv2SpfIndex* index = NULL;
+    Ospfv2ListItem* listItem = NULL;
+    char* rootLSA = NULL;
+    UInt32 localStateHash;
+    BOOL incremental;
+    int i;
 
     Ospfv2Area* thisArea = Ospfv2GetArea(node, areaId);
 
@@ -22141,10 +23062,8 @@ void Ospfv2FindShortestPathForThisArea(
 #endif
     ERROR_Assert(thisArea, "Specified Area is not found");
 
-    Ospfv2InitList(&thisArea->shortestPathList);
-    Ospfv2InitList(&candidateList);
-
-    tempV = (Ospfv2Vertex*) MEM_malloc(sizeof(Ospfv2Vertex));
+    index = Ospfv2SpfGetIndex(thisArea);
+    localStateHash = Ospfv2SpfHashLocalState(node);
 
     if (Ospfv2DebugSPT(node))
     {
@@ -22154,62 +23073,115 @@ void Ospfv2FindShortestPathForThisArea(
     }
 
     // The shortest path starts with myself as the root.
-    tempV->vertexId = ospf->routerID;
-    tempV->vertexType = OSPFv2_VERTEX_ROUTER;
-    tempV->LSA = (char*) Ospfv2LookupLSAList(thisArea->routerLSAList,
-                                             ospf->routerID,
-                                             ospf->routerID);
+    rootLSA = (char*) Ospfv2LookupLSAList(thisArea->routerLSAList,
+                                          ospf->routerID,
+                                          ospf->routerID);
 
-    if ((tempV->LSA == NULL) || (Ospfv2LSAHasMaxAge(ospf, tempV->LSA)))
+    if ((rootLSA == NULL) || (Ospfv2LSAHasMaxAge(ospf, rootLSA)))
     {
-        MEM_free(tempV);
-        Ospfv2FreeList(node, thisArea->shortestPathList, FALSE);
-        Ospfv2FreeList(node, candidateList, FALSE);
+        Ospfv2SpfResetTree(node, thisArea);
         return;
     }
 
-    Ospfv2InitList(&tempV->nextHopList);
-    tempV->distance = 0;
-
-    // Insert myself (root) to the shortest path list.
-    Ospfv2InsertToList(thisArea->shortestPathList, 0, (void*) tempV);
+    tempV = Ospfv2SpfGetVertex(index, OSPFv2_VERTEX_ROUTER, ospf->routerID);
 
-    // Find candidates to be considered for the shortest path list.
-    Ospfv2UpdateCandidateList(node, thisArea, candidateList, tempV);
+    incremental = ospf->incrementalSPF
+                  && index->treeValid
+                  && !tempV->lsaChanged
+                  && index->localStateHash == localStateHash;
 
-    if (Ospfv2DebugSPT(node))
+    if (incremental)
     {
-        Ospfv2PrintCandidateList(node, candidateList);
+        index->restart = FALSE;
+        index->checkTree = FALSE;
+
+        Ospfv2SpfPrepareIncremental(node, thisArea);
+
+        // Vertices added from now on must not give a path into the
+        // unchanged tree.
+        index->checkTree = TRUE;
+
+        while (index->heapSize > 0 && !index->restart)
+        {
+            tempV = Ospfv2UpdateShortestPathList(node, thisArea);
+            Ospfv2UpdateCandidateList(node, thisArea, tempV);
+        }
+
+        index->checkTree = FALSE;
+
+        if (index->restart)
+        {
+            incremental = FALSE;
+        }
+        else
+        {
+            ospf->stats.numIncrementalSPFCalc++;
+        }
     }
 
-    // Keep calculating shortest path until the candidate list is empty.
-    while (candidateList->size > 0)
+    if (!incremental)
     {
-        // Select the next best node in the candidate list into
-        // the shortest path list.  That node is tempV.
-        tempV = Ospfv2UpdateShortestPathList(node,
-                                             thisArea,
-                                             candidateList);
+        Ospfv2SpfResetTree(node, thisArea);
+
+        tempV = Ospfv2SpfGetVertex(index,
+                                   OSPFv2_VERTEX_ROUTER,
+                                   ospf->routerID);
+        tempV->LSA = rootLSA;
+        tempV->distance = 0;
+
+        // Insert myself (root) to the shortest path list.
+        Ospfv2SpfAppendToShortestPath(thisArea, tempV);
+
+        // Find candidates to be considered for the shortest path list.
+        Ospfv2UpdateCandidateList(node, thisArea, tempV);
 
         if (Ospfv2DebugSPT(node))
         {
-            Ospfv2PrintShortestPathList(node, thisArea->shortestPathList);
+            Ospfv2PrintCandidateList(node, index);
         }
 
-        // Find more candidates to be considered for the shortest path list.
-        Ospfv2UpdateCandidateList(node, thisArea, candidateList, tempV);
-
-        if (Ospfv2DebugSPT(node))
+        // Keep calculating shortest path until the candidate list is
+        // empty.
+        while (index->heapSize > 0)
         {
-            Ospfv2PrintCandidateList(node, candidateList);
+            // Select the next best node in the candidate list into
+            // the shortest path list.  That node is tempV.
+            tempV = Ospfv2UpdateShortestPathList(node, thisArea);
+
+            // Find more candidates to be considered for the shortest
+            // path list.
+            Ospfv2UpdateCandidateList(node, thisArea, tempV);
+
+            if (Ospfv2DebugSPT(node))
+            {
+                Ospfv2PrintCandidateList(node, index);
+            }
         }
     }
 
+    ospf->stats.numSPFCalc++;
+
+    for (i = 0; i < index->numChanged; i++)
+    {
+        index->changed[i]->lsaChanged = FALSE;
+    }
+    index->numChanged = 0;
+    index->treeValid = TRUE;
+    index->localStateHash = localStateHash;
+
+    // Update my routing table to reflect the new shortest path list.
+    // The root comes first and has no route.
+    for (listItem = thisArea->shortestPathList->first->next;
+         listItem;
+         listItem = listItem->next)
+    {
+        Ospfv2UpdateIntraAreaRoute(node,
+                                   thisArea,
+                                   (Ospfv2Vertex*) listItem->data);
+    }
+
     // Add stub routes to the shortest path list.
     Ospfv2AddStubRouteToShortestPath(node, thisArea);
-
-    Ospfv2FreeVertexList(node, thisArea->shortestPathList);
-    Ospfv2FreeVertexList(node, candidateList);
 }
 
 //-------------------------------------------------------------------------//
@@ -23206,6 +24178,120 @@ void Ospfv2FindNSSAExternalPath(Node* node)
     }
 }
 
+//-------------------------------------------------------------------------//
+// NAME         :Ospfv2SpfSameRoute
+// PURPOSE      :Check if two rows of the routing table are equal
+// ASSUMPTION   :None.
+// RETURN VALUE :TRUE if the rows are equal, FALSE otherwise.
+//-------------------------------------------------------------------------//
+
+static
+BOOL Ospfv2SpfSameRoute(
+    const Ospfv2RoutingTableRow* row1,
+    const Ospfv2RoutingTableRow* row2)
+{
+    return row1->destType == row2->destType
+           && row1->destAddr == row2->destAddr
+           && row1->addrMask == row2->addrMask
+           && row1->areaId == row2->areaId
+           && row1->pathType == row2->pathType
+           && row1->metric == row2->metric
+           && row1->type2Metric == row2->type2Metric
+           && row1->LSOrigin == row2->LSOrigin
+           && row1->nextHop == row2->nextHop
+           && row1->outIntf == row2->outIntf
+           && row1->advertisingRouter == row2->advertisingRouter
+           && row1->flag == row2->flag;
+}
+
+
+//-------------------------------------------------------------------------//
+// NAME         :Ospfv2SpfCheckIncremental
+// PURPOSE      :Check the routes of an incremental SPF calculation against
+//               those of a full calculation.  The routing table is set
+//               back to its state before the calculation, and the
+//               calculation is done again in full for all areas.  The
+//               routes of the full calculation are kept.
+// ASSUMPTION   :The intra area routes of all areas have just been
+//               calculated.
+// RETURN VALUE :None.
+//-------------------------------------------------------------------------//
+
+static
+void Ospfv2SpfCheckIncremental(
+    Node* node,
+    const Ospfv2RoutingTableRow* oldRows,
+    int numOldRows)
+{
+    Ospfv2Data* ospf = (Ospfv2Data*)
+        NetworkIpGetRoutingProtocol(node, ROUTING_PROTOCOL_OSPFv2);
+    Ospfv2RoutingTable* rtTable = &ospf->routingTable;
+    Ospfv2RoutingTableRow* incrementalRows = NULL;
+    Ospfv2RoutingTableRow* rowPtr = NULL;
+    Ospfv2ListItem* listItem = NULL;
+    int numIncrementalRows = rtTable->numRows;
+    int numSPFCalc = ospf->stats.numSPFCalc;
+    int i;
+    int j;
+
+    incrementalRows = (Ospfv2RoutingTableRow*)
+        MEM_malloc(sizeof(Ospfv2RoutingTableRow)
+                   * (numIncrementalRows + 1));
+    memcpy(incrementalRows,
+           BUFFER_GetData(&rtTable->buffer),
+           sizeof(Ospfv2RoutingTableRow) * numIncrementalRows);
+
+    BUFFER_SetCurrentSize(&rtTable->buffer, 0);
+    BUFFER_AddDataToDataBuffer(&rtTable->buffer,
+                               (char*) oldRows,
+                               sizeof(Ospfv2RoutingTableRow) * numOldRows);
+    rtTable->numRows = numOldRows;
+
+    for (listItem = ospf->area->first; listItem; listItem = listItem->next)
+    {
+        Ospfv2Area* thisArea = (Ospfv2Area*) listItem->data;
+
+        Ospfv2SpfResetTree(node, thisArea);
+        Ospfv2FindShortestPathForThisArea(node, thisArea->areaID);
+    }
+    ospf->stats.numSPFCalc = numSPFCalc;
+
+    // The rows are in the order in which the vertices were added to the
+    // tree, which differs between the two calculations
+    ERROR_Assert(rtTable->numRows == numIncrementalRows,
+                 "Incremental SPF gave a different number of routes");
+
+    rowPtr = (Ospfv2RoutingTableRow*) BUFFER_GetData(&rtTable->buffer);
+
+    for (i = 0; i < numIncrementalRows; i++)
+    {
+        for (j = 0; j < rtTable->numRows; j++)
+        {
+            if (Ospfv2SpfSameRoute(&incrementalRows[i], &rowPtr[j]))
+            {
+                break;
+            }
+        }
+
+        if (j == rtTable->numRows)
+        {
+            char destStr[MAX_ADDRESS_STRING_LENGTH];
+            char errStr[MAX_STRING_LENGTH];
+
+            IO_ConvertIpAddressToString(incrementalRows[i].destAddr,
+                                        destStr);
+            sprintf(errStr,
+                    "Node %u: incremental SPF route to %s differs from "
+                    "the full calculation\n",
+                    node->nodeId, destStr);
+            ERROR_Assert(FALSE, errStr);
+        }
+    }
+
+    MEM_free(incrementalRows);
+}
+
+
 //-------------------------------------------------------------------------//
 // NAME         :Ospfv2FindShortestPath
 // PURPOSE      :Calculate shortest path to all other nodes from this node.
@@ -23221,6 +24307,8 @@ void Ospfv2FindShortestPath(Node* node)
         NetworkIpGetRoutingProtocol(node, ROUTING_PROTOCOL_OSPFv2);
     Ospfv2ListItem* listItem = NULL;
     Ospfv2Area* thisArea = NULL;
+    Ospfv2RoutingTableRow* oldRows = NULL;
+    int numOldRows = 0;
 
     // Invalidate present routing table and save it so that
     // changes in routing table entries can be identified.
@@ -23231,6 +24319,16 @@ void Ospfv2FindShortestPath(Node* node)
         Ospfv2PrintLSDB(node);
     }
 
+    if (OSPFv2_DEBUG_INCREMENTAL_SPF && ospf->incrementalSPF)
+    {
+        numOldRows = ospf->routingTable.numRows;
+        oldRows = (Ospfv2RoutingTableRow*)
+            MEM_malloc(sizeof(Ospfv2RoutingTableRow) * (numOldRows + 1));
+        memcpy(oldRows,
+               BUFFER_GetData(&ospf->routingTable.buffer),
+               sizeof(Ospfv2RoutingTableRow) * numOldRows);
+    }
+
     // Find Intra Area route for each attached area
     for (listItem = ospf->area->first; listItem; listItem = listItem->next)
     {
@@ -23239,6 +24337,12 @@ void Ospfv2FindShortestPath(Node* node)
         Ospfv2FindShortestPathForThisArea(node, thisArea->areaID);
     }
 
+    if (oldRows != NULL)
+    {
+        Ospfv2SpfCheckIncremental(node, oldRows, numOldRows);
+        MEM_free(oldRows);
+    }
+
     // Calculate Inter Area routes
     if (ospf->partitionedIntoArea == TRUE)
     {
@@ -24350,6 +25454,31 @@ void Ospfv2Init(
                           "must be greater than or equal to 1 second.\n");
     }
 
+    // Format is: OSPFv2-INCREMENTAL-SPF <YES/NO>
+    // If YES, the SPF calculation reuses the tree of the last one and
+    // only recalculates the part of it below changed LSAs.
+    IO_ReadString(
+        node->nodeId,
+        NetworkIpGetInterfaceAddress(node, interfaceIndex),
+        nodeInput,
+        "OSPFv2-INCREMENTAL-SPF",
+        &retVal,
+        buf);
+
+    if (!retVal || !strcmp (buf, "NO"))
+    {
+        ospf->incrementalSPF = FALSE;
+    }
+    else if (!strcmp (buf, "YES"))
+    {
+        ospf->incrementalSPF = TRUE;
+    }
+    else
+    {
+        ERROR_ReportError(
+            "OSPFv2-INCREMENTAL-SPF: Unknown value in configuration file.\n");
+    }
+
     // end of runtime optimizations
 
 #ifdef ADDON_BOEINGFCS
@@ -24411,11 +25540,11 @@ void Ospfv2Init(
             "AS-BOUNDARY-ROUTER: Unknown value in configuration file.\n");
     }
 
-    Ospfv2InitList(&ospf->asExternalLSAList);
+    Ospfv2InitLSDBList(&ospf->asExternalLSAList);
     // BGP-OSPF Patch End
 
     /***** Start: OPAQUE-LSA *****/
-    Ospfv2InitList(&(ospf->ASOpaqueLSAList));
+    Ospfv2InitLSDBList(&(ospf->ASOpaqueLSAList));
     ospf->ASOpaqueLSTimer = FALSE;
     ospf->ASOpaqueLSAOriginateTime = (clocktype)0;
 
@@ -24437,7 +25566,7 @@ void Ospfv2Init(
 
     /***** End: OPAQUE-LSA *****/
 
-    Ospfv2InitList(&ospf->nssaExternalLSAList);
+    Ospfv2InitLSDBList(&ospf->nssaExternalLSAList);
 
     ospf->maxAgeLSARemovalTimerSet = FALSE;
 
@@ -26689,6 +27818,29 @@ void Ospfv2Finalize(Node* node)
             -1,// instance Id,
             buf);
 
+        if (ospf->incrementalSPF)
+        {
+            sprintf(buf, "Number of SPF Calculations = %d",
+                     ospf->stats.numSPFCalc);
+            IO_PrintStat(
+                node,
+                "Network",
+                "OSPFv2",
+                ANY_DEST,
+                -1,// instance Id,
+                buf);
+
+            sprintf(buf, "Number of Incremental SPF Calculations = %d",
+                     ospf->stats.numIncrementalSPFCalc);
+            IO_PrintStat(
+                node,
+                "Network",
+                "OSPFv2",
+                ANY_DEST,
+                -1,// instance Id,
+                buf);
+        }
+
         if (ospf->supportDC == TRUE)
         {
             sprintf(buf, "Number of DoNotAge LSA Sent = %d",
@@ -26768,6 +27920,13 @@ void Ospfv2Finalize(Node* node)
                        ospf->iface[i].neighborList,
                        FALSE);
     }
+
+    for (tempListItem = ospf->area->first;
+         tempListItem;
+         tempListItem = tempListItem->next)
+    {
+        Ospfv2SpfFreeIndex(node, (Ospfv2Area*) tempListItem->data);
+    }
 }
 
 //
@@ -29481,6 +30640,9 @@ void Ospfv2AddLsaToMaxAgeLsaList(
     ERROR_Assert(thisArea, "Area doesn't exist\n");
     ERROR_Assert(LSHeader, "LSHeader doesn't exist\n");
 
+    // The LSA no longer counts in the shortest path tree
+    Ospfv2SpfNoteLSAChange(node, LSA, areaId);
+
     if (!Ospfv2IsPresentInMaxAgeLSAList(
                     node, thisArea->maxAgeLSAList, LSHeader))
     {
@@ -20,6 +20,7 @@
 
 #include "route_map.h"
 #include "buffer.h"
+#include "routing_ospf_lsdb_index.h"
 #include <vector>
 
 #define OSPFv2_CURRENT_VERSION                  0x2
@@ -143,6 +144,7 @@ typedef struct struct_Ospfv2_List
     int size;
     struct struct_Ospfv2_ListItem* first;       // First item in list.
     struct struct_Ospfv2_ListItem* last;        // Last item in list.
+    OspfLsdbIndex* lsaIndex;   // Index of the LSAs, NULL if not an LSDB
 } Ospfv2List;
 
 typedef struct struct_Ospfv2_NonBroadcastNeighborListItem
@@ -179,15 +181,63 @@ typedef struct
     NodeAddress nextHop;
 } Ospfv2NextHopListItem;
 
-typedef struct
+typedef struct struct_Ospfv2_Vertex
 {
     NodeAddress             vertexId;
     Ospfv2VertexType vertexType;
     char*                   LSA;
     Ospfv2List*             nextHopList;
     unsigned int            distance;
+
+    // State of the vertex in the SPF calculation (see Ospfv2SpfIndex)
+    int                     heapIndex;      // -1 if not a candidate
+    BOOL                    inShortestPath;
+    BOOL                    lsaChanged;     // since the last calculation
+    BOOL                    affected;       // below a changed vertex
+    BOOL                    seeded;         // candidates taken from it
+
+    // Parents in the shortest path tree, more than one for equal cost
+    struct struct_Ospfv2_Vertex** parent;
+    int                     numParents;
+    int                     maxParents;
+
+    // Item of the vertex in the shortest path list
+    Ospfv2ListItem          shortestPathItem;
 } Ospfv2Vertex;
 
+// Vertices of the SPF calculation of an area.  The vertices are kept
+// from one calculation to the next, so that an incremental calculation
+// only has to redo the part of the tree below vertices whose LSA has
+// changed.  Vertices are found by type and ID in an open addressing
+// table, and the candidate list is a binary heap ordered by distance.
+typedef struct
+{
+    Ospfv2Vertex**          table;
+    int                     tableSize;      // power of 2
+    int                     numVertices;
+
+    Ospfv2Vertex**          heap;
+    int                     heapSize;
+    int                     maxHeapSize;
+
+    // Vertices whose LSA has changed since the last calculation
+    Ospfv2Vertex**          changed;
+    int                     numChanged;
+    int                     maxChanged;
+
+    // Shortest path list holds the tree of the last calculation
+    BOOL                    treeValid;
+
+    // Interfaces and neighbors used by the last calculation
+    UInt32                  localStateHash;
+
+    // During an incremental calculation, paths found to vertices in the
+    // tree are checked.  A shorter or equal path means the calculation
+    // has to be redone in full.
+    BOOL                    checkTree;
+    BOOL                    restart;
+} Ospfv2SpfIndex;
+
 typedef struct
 {
     char linkStateType;
@@ -1429,6 +1479,9 @@ typedef struct
 
     int numDoNotAgeLSASent;
     int numDoNotAgeLSARecv;
+
+    int numSPFCalc;
+    int numIncrementalSPFCalc;
 }
 Ospfv2Stats;
 
@@ -1825,6 +1878,7 @@ typedef struct
 
     // Shortest path tree of this area
     Ospfv2List*         shortestPathList;
+    Ospfv2SpfIndex*     spfIndex;
 
     Int32               stubDefaultCost;
 
@@ -1942,6 +1996,7 @@ typedef struct
 
     clocktype incrementTime;
     clocktype spfCalcDelay;
+    BOOL incrementalSPF;
     clocktype floodTimer;
 
     // random seed for use with broadcast jitter, flood timers, etc.
@@ -2366,6 +2421,8 @@ Ospfv2Neighbor* Ospfv2GetNeighborInfoByIPAddress(
 
 void Ospfv2InitList(Ospfv2List** list);
 
+void Ospfv2InitLSDBList(Ospfv2List** list);
+
 void Ospfv2InitNonBroadcastNeighborList(
                                     Ospfv2NonBroadcastNeighborList** list);
 
@@ -208,6 +208,7 @@
 //#define OSPFv3_DEBUG_ERRORS
 //#define OSPFv3_DEBUG_SPTErr
 //#define OSPFv3_DEBUG_LSDBErr
+//#define OSPFv3_DEBUG_LSDB_INDEX
 //#define OSPFv3_DEBUG_SYNCErr
 //#define OSPFv3_DEBUG_FLOODErr
 //#define OSPFv3_DEBUG_HELLOErr
@@ -4148,6 +4149,8 @@ void Ospfv3Init(
 
     memset(ospf, 0, sizeof (Ospfv3Data));
 
+    ospf->lsdbIndex = OspfLsdbIndexCreate();
+
     RANDOM_SetSeed(ospf->seed,
                    node->globalSeed,
                    node->nodeId,
@@ -4960,6 +4963,155 @@ void Ospfv3CreateCommonHeader(
     commonHdr->reserved = 0;
 }
 
+// /**
+// FUNCTION   :: Ospfv3GetLSAListItem
+// LAYER      :: NETWORK
+// PURPOSE    :: Search for the LSA in an LSDB list and get the item.
+// PARAMETERS ::
+//  +node:  Node* : Pointer to node.
+//  +list:  LinkedList* : Pointer to LSDB list.
+//  +advertisingRouter: unsigned int : Advertising Router.
+//  +linkStateId: unsigned int : Link State Id.
+// RETURN     :: ListItem* : item of the LSA, NULL if not found.
+// **/
+static
+ListItem* Ospfv3GetLSAListItem(
+    Node* node,
+    LinkedList* list,
+    unsigned int advertisingRouter,
+    unsigned int linkStateId)
+{
+    Ospfv3Data* ospf = (Ospfv3Data* ) NetworkIpGetRoutingProtocol(
+                                        node,
+                                        ROUTING_PROTOCOL_OSPFv3,
+                                        NETWORK_IPV6);
+    ListItem* item = (ListItem* ) OspfLsdbIndexLookup(ospf->lsdbIndex,
+                                                      list,
+                                                      linkStateId,
+                                                      advertisingRouter);
+
+#ifdef OSPFv3_DEBUG_LSDB_INDEX
+    {
+        // Cross-check the index against a walk of the list
+        ListItem* walkItem = list->first;
+
+        while (walkItem)
+        {
+            Ospfv3LinkStateHeader* listLSHeader =
+                (Ospfv3LinkStateHeader* ) walkItem->data;
+
+            if (listLSHeader->advertisingRouter == advertisingRouter
+                && listLSHeader->linkStateId == linkStateId)
+            {
+                break;
+            }
+            walkItem = walkItem->next;
+        }
+
+        ERROR_Assert(item == walkItem,
+                     "OSPFv3 LSDB index out of step with the LSDB list");
+    }
+#endif
+
+    return item;
+}
+
+// /**
+// FUNCTION   :: Ospfv3ScheduleLSAAge
+// LAYER      :: NETWORK
+// PURPOSE    :: Put the LSA of an LSDB list item on the age wheel, due
+//               when its LS age reaches LSRefreshTime or else MaxAge.
+// PARAMETERS ::
+//  +node:  Node* : Pointer to node.
+//  +list:  LinkedList* : Pointer to LSDB list.
+//  +item:  ListItem* : Item of the LSA.
+// RETURN     :: void : NULL.
+// **/
+static
+void Ospfv3ScheduleLSAAge(Node* node, LinkedList* list, ListItem* item)
+{
+    Ospfv3Data* ospf = (Ospfv3Data* ) NetworkIpGetRoutingProtocol(
+                                        node,
+                                        ROUTING_PROTOCOL_OSPFv3,
+                                        NETWORK_IPV6);
+    Ospfv3LinkStateHeader* LSHeader = (Ospfv3LinkStateHeader* ) item->data;
+    int age = LSHeader->linkStateAge;
+    int seconds = 1;
+
+    if (age < OSPFv3_LS_REFRESH_TIME / SECOND)
+    {
+        seconds = (int) (OSPFv3_LS_REFRESH_TIME / SECOND) - age;
+    }
+    else if (age < OSPFv3_LSA_MAX_AGE / SECOND)
+    {
+        seconds = (int) (OSPFv3_LSA_MAX_AGE / SECOND) - age;
+    }
+
+    OspfLsdbIndexScheduleAge(ospf->lsdbIndex,
+                             list,
+                             LSHeader->linkStateId,
+                             LSHeader->advertisingRouter,
+                             item,
+                             seconds);
+}
+
+// /**
+// FUNCTION   :: Ospfv3InsertToLSAList
+// LAYER      :: NETWORK
+// PURPOSE    :: Add an LSA at the end of an LSDB list.
+// PARAMETERS ::
+//  +node:  Node* : Pointer to node.
+//  +list:  LinkedList* : Pointer to LSDB list.
+//  +LSA:  char* : Pointer to LSA, owned by the list.
+// RETURN     :: void : NULL.
+// **/
+static
+void Ospfv3InsertToLSAList(Node* node, LinkedList* list, char* LSA)
+{
+    Ospfv3Data* ospf = (Ospfv3Data* ) NetworkIpGetRoutingProtocol(
+                                        node,
+                                        ROUTING_PROTOCOL_OSPFv3,
+                                        NETWORK_IPV6);
+    Ospfv3LinkStateHeader* LSHeader = (Ospfv3LinkStateHeader* ) LSA;
+
+    ListInsert(node, list, getSimTime(node), (void* ) LSA);
+
+    OspfLsdbIndexInsert(ospf->lsdbIndex,
+                        list,
+                        LSHeader->linkStateId,
+                        LSHeader->advertisingRouter,
+                        list->last);
+    Ospfv3ScheduleLSAAge(node, list, list->last);
+}
+
+// /**
+// FUNCTION   :: Ospfv3RemoveFromLSAList
+// LAYER      :: NETWORK
+// PURPOSE    :: Remove an item from an LSDB list and free its LSA.
+// PARAMETERS ::
+//  +node:  Node* : Pointer to node.
+//  +list:  LinkedList* : Pointer to LSDB list.
+//  +item:  ListItem* : Item of the LSA.
+// RETURN     :: void : NULL.
+// **/
+static
+void Ospfv3RemoveFromLSAList(Node* node, LinkedList* list, ListItem* item)
+{
+    Ospfv3Data* ospf = (Ospfv3Data* ) NetworkIpGetRoutingProtocol(
+                                        node,
+                                        ROUTING_PROTOCOL_OSPFv3,
+                                        NETWORK_IPV6);
+    Ospfv3LinkStateHeader* LSHeader = (Ospfv3LinkStateHeader* ) item->data;
+
+    OspfLsdbIndexRemove(ospf->lsdbIndex,
+                        list,
+                        LSHeader->linkStateId,
+                        LSHeader->advertisingRouter,
+                        item);
+
+    ListGet(node, list, item, TRUE, FALSE);
+}
+
 // /**
 // FUNCTION   :: Ospfv3GetTopLSAFromList
 // LAYER      :: NETWORK
@@ -8754,27 +8906,18 @@ void Ospfv3RefreshLSA(Node* node, ListItem* LSAItem, unsigned int areaId)
 // FUNCTION   :: Ospfv3IncrementLSAgeInLSAList
 // LAYER      :: NETWORK
 // PURPOSE    :: Increment the link state age field of LSAs stored in the
-//               LSDB and handle appropriately if this age field passes
-//               a maximum age limit.
+//               LSDB.  The LSAs that reach LSRefreshTime or MaxAge are
+//               then handled as they come due on the age wheel.
 // PARAMETERS ::
 // +node:  Node* : Pointer to node.
 // +list:  LinkedList* : LSA list.
-// +areaId:  unsigned int : Area Id.
 // RETURN     :: void : NULL.
 // **/
 static
-void Ospfv3IncrementLSAgeInLSAList(
-    Node* node,
-    LinkedList* list,
-    unsigned int areaId)
+void Ospfv3IncrementLSAgeInLSAList(Node* node, LinkedList* list)
 {
     ListItem* item = list->first;
 
-    Ospfv3Data* ospf = (Ospfv3Data* ) NetworkIpGetRoutingProtocol(
-                                            node,
-                                            ROUTING_PROTOCOL_OSPFv3,
-                                            NETWORK_IPV6);
-
     while (item)
     {
         short tempAge;
@@ -8811,85 +8954,163 @@ void Ospfv3IncrementLSAgeInLSAList(
         }
 #endif
 
-        // LS Age field of Self originated LSA reaches LSRefreshTime
-        if ((LSHeader->advertisingRouter == ospf->routerId)
-            && (tempAge == (OSPFv3_LS_REFRESH_TIME / SECOND)))
-        {
-            ListItem* tempItem;
+        item = item->next;
+    }
+}
 
-            tempItem = item;
-            item = item->next;
+// /**
+// FUNCTION   :: Ospfv3GetLSAListAreaId
+// LAYER      :: NETWORK
+// PURPOSE    :: Find the area, or for link LSAs the interface, of an LSDB
+//               list that is aged.
+// PARAMETERS ::
+// +node:  Node* : Pointer to node.
+// +list:  const void* : LSA list.
+// +areaId:  unsigned int* : Set to the area Id, the interface Id or
+//                           OSPFv3_INVALID_AREA_ID.
+// RETURN     :: BOOL : TRUE if the list is aged, FALSE otherwise.
+// **/
+static
+BOOL Ospfv3GetLSAListAreaId(
+    Node* node,
+    const void* list,
+    unsigned int* areaId)
+{
+    Ospfv3Data* ospf = (Ospfv3Data* ) NetworkIpGetRoutingProtocol(
+                                            node,
+                                            ROUTING_PROTOCOL_OSPFv3,
+                                            NETWORK_IPV6);
+    ListItem* listItem;
+    int i;
 
-            switch(LSHeader->linkStateType)
-            {
-                case OSPFv3_ROUTER:
-                case OSPFv3_NETWORK:
-                case OSPFv3_INTER_AREA_PREFIX:
-                case OSPFv3_INTER_AREA_ROUTER:
-                case OSPFv3_AS_EXTERNAL:
-                case OSPFv3_LINK:
-                case OSPFv3_INTRA_AREA_PREFIX:
-                {
-                    Ospfv3RefreshLSA(node, tempItem, areaId);
+    if (list == ospf->asExternalLSAList)
+    {
+        *areaId = OSPFv3_INVALID_AREA_ID;
+        return TRUE;
+    }
 
-                    break;
-                }
-                default :
-                {
-                    ERROR_Assert(FALSE, "\n Unknown LSA\n");
-                }
-            }
+    for (i = 0; i < node->numberInterfaces; i++)
+    {
+        if (ospf->pInterface[i].type != OSPFv3_NON_OSPF_INTERFACE
+            && list == ospf->pInterface[i].linkLSAList)
+        {
+            *areaId = i;
+            return TRUE;
         }
+    }
+
+    for (listItem = ospf->area->first; listItem; listItem = listItem->next)
+    {
+        Ospfv3Area* thisArea = (Ospfv3Area* ) listItem->data;
 
-        // Expired, so remove from LSDB and flood.
-        else if (tempAge == (OSPFv3_LSA_MAX_AGE / SECOND))
+        if (list == thisArea->networkLSAList
+            || list == thisArea->routerLSAList
+            || list == thisArea->interAreaRouterLSAList
+            || list == thisArea->interAreaPrefixLSAList
+            || list == thisArea->intraAreaPrefixLSAList)
         {
-            ListItem* deleteItem = item;
-            item = item->next;
+            *areaId = thisArea->areaId;
+            return TRUE;
+        }
+    }
 
-#ifdef OSPFv3_DEBUG_LSDBErr
-            {
-                printf("    LSA for node %u deleted from LSDB\n",
-                    LSHeader->advertisingRouter);
-            }
-#endif
+    return FALSE;
+}
+
+// /**
+// FUNCTION   :: Ospfv3HandleDueLSA
+// LAYER      :: NETWORK
+// PURPOSE    :: Refresh a self originated LSA that reached LSRefreshTime,
+//               or flood and remove an LSA that reached MaxAge.
+// PARAMETERS ::
+// +node:  Node* : Pointer to node.
+// +list:  LinkedList* : LSA list.
+// +item:  ListItem* : Item of the LSA.
+// +areaId:  unsigned int : Area Id.
+// RETURN     :: void : NULL.
+// **/
+static
+void Ospfv3HandleDueLSA(
+    Node* node,
+    LinkedList* list,
+    ListItem* item,
+    unsigned int areaId)
+{
+    Ospfv3Data* ospf = (Ospfv3Data* ) NetworkIpGetRoutingProtocol(
+                                            node,
+                                            ROUTING_PROTOCOL_OSPFv3,
+                                            NETWORK_IPV6);
+    Ospfv3LinkStateHeader* LSHeader = (Ospfv3LinkStateHeader* ) item->data;
 
-            ospf->stats.numExpiredLSAge++;
+    // Schedule the next threshold first, as the LSA may be removed
+    Ospfv3ScheduleLSAAge(node, list, item);
 
-            if (LSHeader->linkStateType == OSPFv3_AS_EXTERNAL)
+    // LS Age field of Self originated LSA reaches LSRefreshTime
+    if ((LSHeader->advertisingRouter == ospf->routerId)
+        && (LSHeader->linkStateAge == (OSPFv3_LS_REFRESH_TIME / SECOND)))
+    {
+        switch(LSHeader->linkStateType)
+        {
+            case OSPFv3_ROUTER:
+            case OSPFv3_NETWORK:
+            case OSPFv3_INTER_AREA_PREFIX:
+            case OSPFv3_INTER_AREA_ROUTER:
+            case OSPFv3_AS_EXTERNAL:
+            case OSPFv3_LINK:
+            case OSPFv3_INTRA_AREA_PREFIX:
             {
-                Ospfv3FloodThroughAS(node, (char* ) LSHeader, ANY_DEST);
+                Ospfv3RefreshLSA(node, item, areaId);
+
+                break;
             }
-            else if (LSHeader->linkStateType == OSPFv3_LINK)
+            default :
             {
+                ERROR_Assert(FALSE, "\n Unknown LSA\n");
+            }
+        }
+    }
 
-                unsigned int interfaceId = areaId;
+    // Expired, so remove from LSDB and flood.
+    else if (LSHeader->linkStateAge == (OSPFv3_LSA_MAX_AGE / SECOND))
+    {
+#ifdef OSPFv3_DEBUG_LSDBErr
+        {
+            printf("    LSA for node %u deleted from LSDB\n",
+                LSHeader->advertisingRouter);
+        }
+#endif
 
-                Ospfv3FloodLSAOnInterface(
-                    node,
-                    (char* ) LSHeader,
-                    ANY_DEST,
-                    interfaceId);
-            }
-            else
-            {
+        ospf->stats.numExpiredLSAge++;
 
-                Ospfv3FloodLSAThroughArea(
-                    node,
-                    (char* ) LSHeader,
-                    ANY_DEST,
-                    areaId);
-            }
+        if (LSHeader->linkStateType == OSPFv3_AS_EXTERNAL)
+        {
+            Ospfv3FloodThroughAS(node, (char* ) LSHeader, ANY_DEST);
+        }
+        else if (LSHeader->linkStateType == OSPFv3_LINK)
+        {
 
-            ListGet(node, list, deleteItem, TRUE, FALSE);
+            unsigned int interfaceId = areaId;
 
-            // Need to recalculate shortest path since topology changed.
-            Ospfv3ScheduleSPFCalculation(node);
+            Ospfv3FloodLSAOnInterface(
+                node,
+                (char* ) LSHeader,
+                ANY_DEST,
+                interfaceId);
         }
         else
         {
-            item = item->next;
+
+            Ospfv3FloodLSAThroughArea(
+                node,
+                (char* ) LSHeader,
+                ANY_DEST,
+                areaId);
         }
+
+        Ospfv3RemoveFromLSAList(node, list, item);
+
+        // Need to recalculate shortest path since topology changed.
+        Ospfv3ScheduleSPFCalculation(node);
     }
 }
 
@@ -8910,6 +9131,9 @@ void Ospfv3IncrementLSAge(Node* node)
                                             NETWORK_IPV6);
 
     ListItem* listItem;
+    ListItem* item;
+    const void* scope;
+    unsigned int areaId;
     int i;
 
     // Increment Age of link local LSA
@@ -8919,10 +9143,7 @@ void Ospfv3IncrementLSAge(Node* node)
         {
             continue;
         }
-        Ospfv3IncrementLSAgeInLSAList(
-            node,
-            ospf->pInterface[i].linkLSAList,
-            i);
+        Ospfv3IncrementLSAgeInLSAList(node, ospf->pInterface[i].linkLSAList);
     }
 
     // Increment Age of LSA having Area flooding scope
@@ -8930,39 +9151,35 @@ void Ospfv3IncrementLSAge(Node* node)
     {
         Ospfv3Area* thisArea = (Ospfv3Area* ) listItem->data;
 
-        Ospfv3IncrementLSAgeInLSAList(
-            node,
-            thisArea->networkLSAList,
-            thisArea->areaId);
+        Ospfv3IncrementLSAgeInLSAList(node, thisArea->networkLSAList);
 
-        Ospfv3IncrementLSAgeInLSAList(
-            node,
-            thisArea->routerLSAList,
-            thisArea->areaId);
+        Ospfv3IncrementLSAgeInLSAList(node, thisArea->routerLSAList);
 
-        Ospfv3IncrementLSAgeInLSAList(
-            node,
-            thisArea->interAreaRouterLSAList,
-            thisArea->areaId);
+        Ospfv3IncrementLSAgeInLSAList(node, thisArea->interAreaRouterLSAList);
 
-        Ospfv3IncrementLSAgeInLSAList(
-            node,
-            thisArea->interAreaPrefixLSAList,
-            thisArea->areaId);
+        Ospfv3IncrementLSAgeInLSAList(node, thisArea->interAreaPrefixLSAList);
 
-        Ospfv3IncrementLSAgeInLSAList(
-            node,
-            thisArea->intraAreaPrefixLSAList,
-            thisArea->areaId);
+        Ospfv3IncrementLSAgeInLSAList(node, thisArea->intraAreaPrefixLSAList);
 
     }
 
     // BGP-OSPF Patch Start
-    Ospfv3IncrementLSAgeInLSAList(
-        node,
-        ospf->asExternalLSAList,
-        OSPFv3_INVALID_AREA_ID);
+    Ospfv3IncrementLSAgeInLSAList(node, ospf->asExternalLSAList);
     // BGP-OSPF Patch End
+
+    // Only the LSAs that reached LSRefreshTime or MaxAge are visited
+    OspfLsdbIndexAdvanceAge(ospf->lsdbIndex,
+                            OSPFv3_LSA_INCREMENT_AGE_INTERVAL / SECOND);
+
+    while ((item = (ListItem* ) OspfLsdbIndexNextDue(ospf->lsdbIndex,
+                                                     &scope)) != NULL)
+    {
+        // LSAs of lists that are not aged are left off the wheel
+        if (Ospfv3GetLSAListAreaId(node, scope, &areaId))
+        {
+            Ospfv3HandleDueLSA(node, (LinkedList* ) scope, item, areaId);
+        }
+    }
 }
 
 // /**
@@ -14554,23 +14771,16 @@ BOOL Ospfv3CreateLSHeader(
 static
 void Ospfv3RemoveLSAFromList(Node* node, LinkedList* list, char* LSA)
 {
-    ListItem* listItem = list->first;
     Ospfv3LinkStateHeader* LSHeader = (Ospfv3LinkStateHeader* ) LSA;
-    Ospfv3LinkStateHeader* listLSHeader = NULL;
+    ListItem* listItem = Ospfv3GetLSAListItem(node,
+                                              list,
+                                              LSHeader->advertisingRouter,
+                                              LSHeader->linkStateId);
 
-    while (listItem)
+    if (listItem)
     {
-        listLSHeader = (Ospfv3LinkStateHeader* ) listItem->data;
-
-        if (listLSHeader->advertisingRouter == LSHeader->advertisingRouter
-            && listLSHeader->linkStateId == LSHeader->linkStateId)
-        {
-            // Remove item
-            ListGet(node, list, listItem, TRUE, FALSE);
-
-            break;
-        }
-        listItem = listItem->next;
+        // Remove item
+        Ospfv3RemoveFromLSAList(node, list, listItem);
     }
 }
 
@@ -15558,23 +15768,16 @@ BOOL Ospfv3InstallLSAInLSDB(Node* node, LinkedList* list, char* LSA)
 {
     Ospfv3LinkStateHeader* listLSHeader = NULL;
     Ospfv3LinkStateHeader* LSHeader = (Ospfv3LinkStateHeader* ) LSA;
-    ListItem* item = list->first;
+    ListItem* item = Ospfv3GetLSAListItem(node,
+                                          list,
+                                          LSHeader->advertisingRouter,
+                                          LSHeader->linkStateId);
     char* newLSA = NULL;
     BOOL retVal = FALSE;
 
-    while (item)
+    if (item)
     {
-        // Get LS Header
         listLSHeader = (Ospfv3LinkStateHeader* ) item->data;
-
-        if ((listLSHeader->advertisingRouter
-            == LSHeader->advertisingRouter)
-            && (listLSHeader->linkStateId
-            == LSHeader->linkStateId))
-        {
-            break;
-        }
-        item = item->next;
     }
 #ifdef OSPFv3_DEBUG_LSDB
     {
@@ -15588,7 +15791,7 @@ BOOL Ospfv3InstallLSAInLSDB(Node* node, LinkedList* list, char* LSA)
     {
         if (item)
         {
-            ListGet(node, list, item, TRUE, FALSE);
+            Ospfv3RemoveFromLSAList(node, list, item);
 
             retVal = TRUE;
         }
@@ -15636,6 +15839,9 @@ BOOL Ospfv3InstallLSAInLSDB(Node* node, LinkedList* list, char* LSA)
                     LSHeader,
                     LSHeader->length);
             }
+
+            // The new instance has its own LS age
+            Ospfv3ScheduleLSAAge(node, list, item);
         }
 
         // LSA not found in list
@@ -15643,11 +15849,7 @@ BOOL Ospfv3InstallLSAInLSDB(Node* node, LinkedList* list, char* LSA)
         {
             newLSA = Ospfv3CopyLSA(node, LSA);
 
-            ListInsert(
-                node,
-                list,
-                getSimTime(node),
-                (void* ) newLSA);
+            Ospfv3InsertToLSAList(node, list, newLSA);
 
             retVal = TRUE;
         }
@@ -16293,23 +16495,12 @@ Ospfv3LinkStateHeader* Ospfv3LookupLSAList(
     unsigned int advertisingRouter,
     unsigned int linkStateId)
 {
-    Ospfv3LinkStateHeader* listLSHeader = NULL;
-    ListItem* item = list->first;
+    ListItem* item = Ospfv3GetLSAListItem(node,
+                                          list,
+                                          advertisingRouter,
+                                          linkStateId);
 
-    while (item)
-    {
-        // Get LS Header
-        listLSHeader = (Ospfv3LinkStateHeader* ) item->data;
-
-        if (listLSHeader->advertisingRouter == advertisingRouter
-            && listLSHeader->linkStateId == linkStateId)
-        {
-            return listLSHeader;
-        }
-
-        item = item->next;
-    }
-    return NULL;
+    return item ? (Ospfv3LinkStateHeader* ) item->data : NULL;
 }
 
 // /**
@@ -17273,7 +17464,11 @@ BOOL Ospfv3UpdateLSAList(
 
     LSHeader = (Ospfv3LinkStateHeader* ) LSA;
 
-    listItem = list->first;
+    // Start at the LSA in the list, if there is one
+    listItem = Ospfv3GetLSAListItem(node,
+                                    list,
+                                    LSHeader->advertisingRouter,
+                                    LSHeader->linkStateId);
 
 #ifdef OSPFv3_DEBUG_FLOODErr
     {
@@ -17378,7 +17573,10 @@ BOOL Ospfv3UpdateLSAList(
 #endif
 
         // If greater than or equal to max age, remove from LSDB.
-        ListGet(node, list, listItem, TRUE, FALSE);
+        if (listItem)
+        {
+            Ospfv3RemoveFromLSAList(node, list, listItem);
+        }
 
         retVal = TRUE;
     }
@@ -1309,6 +1309,10 @@ typedef struct
     BOOL asBoundaryRouter;
 // BGP-OSPF Patch End
 
+    // Index of the LSAs in all LSDB lists, keyed by list, Link State ID
+    // and Advertising Router
+    OspfLsdbIndex* lsdbIndex;
+
     BOOL collectStat;
     Ospfv3Stats stats;
     Ospfv3RoutingTable routingTable;
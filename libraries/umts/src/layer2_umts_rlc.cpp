@@ -467,8 +467,8 @@ void UmtsRlcCopyMessageTraceInfo(
 
     for (int i = 0; i < srcMessage->numberOfHeaders; i ++)
     {
-        destMessage->headerProtocols[i] = srcMessage->headerProtocols[i];
-        destMessage->headerSizes[i] = srcMessage->headerSizes[i];
+        destMessage->headerProtocols.set(i, srcMessage->headerProtocols[i]);
+        destMessage->headerSizes.set(i, srcMessage->headerSizes[i]);
     }
 }
 
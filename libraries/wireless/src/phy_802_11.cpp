@@ -28,6 +28,7 @@
 #include "antenna_patterned.h"
 #include "phy_802_11.h"
 #include "phy_802_11n.h"
+#include "phy_error_table.h"
 
 #include "mac_csma.h"
 #include "mac_dot11.h"
@@ -252,7 +253,9 @@ BOOL Phy802_11CheckRxPacketError(
     double *sinrPtr)
 {
     double sinr;
-    double BER;
+    double BER = 0.0;
+    double logNoError = 0.0;
+    BOOL useErrorTable = FALSE;
     double noise =
         phy802_11->thisPhy->noise_mW_hz * phy802_11->channelBandwidth;
     double dataRate;
@@ -294,13 +297,20 @@ BOOL Phy802_11CheckRxPacketError(
         assert(phy802_11->rxDataRateType >= 0 &&
            phy802_11->rxDataRateType < phy802_11->numDataRates);
 
-        BER = PHY_BER(phy802_11->thisPhy,
-                  phy802_11->rxDataRateType,
-                  sinr);
+        const PhyErrorTable* errorTable =
+            PHY_GetErrorTable(phy802_11->thisPhy,
+                              phy802_11->rxDataRateType);
+
+        // As with PHY_BER, no random number is drawn where the BER is 0
+        if (!PHY_ErrorTableIsErrorFree(errorTable, sinr))
+        {
+            logNoError = PHY_ErrorTableLogNoError(errorTable, sinr);
+            useErrorTable = TRUE;
+        }
         dataRate = (double)phy802_11->dataRate[phy802_11->rxDataRateType];
     }
 
-    if (BER != 0.0) {
+    if (BER != 0.0 || useErrorTable) {
         double numBits = 0;
         if (!containAMPDU)
         {
@@ -311,7 +321,17 @@ BOOL Phy802_11CheckRxPacketError(
             numBits = sizeof(Phy802_11PlcpHeader) * 8;
         }
 
-        double errorProbability = 1.0 - pow((1.0 - BER), numBits);
+        double errorProbability;
+
+        if (useErrorTable)
+        {
+            errorProbability =
+                PHY_PacketErrorProbability(logNoError, numBits);
+        }
+        else
+        {
+            errorProbability = 1.0 - pow((1.0 - BER), numBits);
+        }
         double rand = RANDOM_erand(phy802_11->thisPhy->seed);
 
         assert((errorProbability >= 0.0) && (errorProbability <= 1.0));
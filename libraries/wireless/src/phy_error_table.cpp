@@ -0,0 +1,197 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <math.h>
+#include <string.h>
+#include <map>
+
+#ifdef _WIN32
+#include "pthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "api.h"
+#include "phy_error_table.h"
+
+// Tables shared by the radios of all partitions, by BER table entries
+static std::map<const PhyBerEntry*, PhyErrorTable*> s_errorTables;
+static pthread_mutex_t s_errorTablesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static double PhyErrorTableLogNoError(double ber)
+{
+    double logNoError;
+
+    if (ber <= 0.0)
+    {
+        return 0.0;
+    }
+    if (ber >= 1.0)
+    {
+        return PHY_ERROR_TABLE_MIN_LOG;
+    }
+
+    // log(1 - ber) rounds to 0 for a BER below 1e-16, but a BER that is
+    // not 0 must stay so, see PHY_ErrorTableLogNoError
+    if (ber < 1.0e-8)
+    {
+        return -ber - ber * ber / 2.0;
+    }
+
+    logNoError = log(1.0 - ber);
+    return logNoError > PHY_ERROR_TABLE_MIN_LOG
+           ? logNoError : PHY_ERROR_TABLE_MIN_LOG;
+}
+
+static PhyErrorTable* PhyErrorTableBuild(PhyData* phyData, int berTableIndex)
+{
+    const PhyBerTable* berTable = &(phyData->snrBerTables[berTableIndex]);
+    const PhyBerEntry* entries = berTable->entries;
+    int numEntries = berTable->numEntries;
+    double minInterval = 0.0;
+    double range;
+    double step;
+    int numSteps;
+    int i;
+
+    ERROR_Assert(numEntries > 0 && entries != NULL,
+                 "BER table has no entries");
+
+    for (i = 1; i < numEntries; i++)
+    {
+        double interval = entries[i].snr - entries[i - 1].snr;
+
+        if (interval > 0.0 && (minInterval == 0.0 || interval < minInterval))
+        {
+            minInterval = interval;
+        }
+    }
+
+    range = entries[numEntries - 1].snr - entries[0].snr;
+    if (minInterval == 0.0)
+    {
+        // A single SNR
+        step = 1.0;
+        numSteps = 0;
+    }
+    else
+    {
+        step = minInterval / PHY_ERROR_TABLE_STEPS_PER_ENTRY;
+        numSteps = (int) ceil(range / step);
+        if (numSteps > PHY_ERROR_TABLE_MAX_POINTS
+                       - 1 - 2 * PHY_ERROR_TABLE_MARGIN_POINTS)
+        {
+            numSteps = PHY_ERROR_TABLE_MAX_POINTS
+                       - 1 - 2 * PHY_ERROR_TABLE_MARGIN_POINTS;
+        }
+        step = range / numSteps;
+    }
+
+    PhyErrorTable* table = (PhyErrorTable*) MEM_malloc(sizeof(PhyErrorTable));
+
+    table->berEntries = entries;
+    table->numPoints = numSteps + 1 + 2 * PHY_ERROR_TABLE_MARGIN_POINTS;
+    table->snrStart_dB =
+        entries[0].snr - PHY_ERROR_TABLE_MARGIN_POINTS * step;
+    table->stepsPer_dB = 1.0 / step;
+    table->logNoError =
+        (double*) MEM_malloc((table->numPoints + 1) * sizeof(double));
+
+    for (i = 0; i < table->numPoints; i++)
+    {
+        double snr_dB = table->snrStart_dB + i * step;
+
+        table->logNoError[i] = PhyErrorTableLogNoError(
+            PHY_BER(phyData, berTableIndex, NON_DB(snr_dB)));
+    }
+    table->logNoError[table->numPoints] =
+        table->logNoError[table->numPoints - 1];
+
+    // The BER is 0 from the entry after the last one that is not 0 on
+    table->zeroBerSnr_dB = -HUGE_VAL;
+    for (i = numEntries - 1; i >= 0; i--)
+    {
+        if (entries[i].ber != 0.0)
+        {
+            table->zeroBerSnr_dB =
+                i == numEntries - 1 ? HUGE_VAL : entries[i + 1].snr;
+            break;
+        }
+    }
+
+    return table;
+}
+
+const PhyErrorTable* PHY_GetErrorTable(PhyData* phyData, int berTableIndex)
+{
+    const PhyErrorTable* table;
+    const PhyBerEntry* entries;
+
+    ERROR_Assert(berTableIndex >= 0
+                 && berTableIndex < phyData->numBerTables,
+                 "Invalid BER table index");
+
+    if (phyData->snrErrorTables == NULL)
+    {
+        phyData->snrErrorTables = (const PhyErrorTable**)
+            MEM_malloc(phyData->numBerTables * sizeof(PhyErrorTable*));
+        memset(phyData->snrErrorTables,
+               0,
+               phyData->numBerTables * sizeof(PhyErrorTable*));
+    }
+
+    // The BER tables of a PHY may be replaced after the first lookup
+    entries = phyData->snrBerTables[berTableIndex].entries;
+    table = phyData->snrErrorTables[berTableIndex];
+    if (table != NULL && table->berEntries == entries)
+    {
+        return table;
+    }
+
+    pthread_mutex_lock(&s_errorTablesMutex);
+    std::map<const PhyBerEntry*, PhyErrorTable*>::iterator it =
+        s_errorTables.find(entries);
+
+    if (it == s_errorTables.end())
+    {
+        table = PhyErrorTableBuild(phyData, berTableIndex);
+        s_errorTables[entries] = (PhyErrorTable*) table;
+    }
+    else
+    {
+        table = it->second;
+    }
+    pthread_mutex_unlock(&s_errorTablesMutex);
+
+    phyData->snrErrorTables[berTableIndex] = table;
+    return table;
+}
+
+void PHY_ErrorTablePerBatch(
+    const PhyErrorTable* const* tables,
+    const double* sinr,
+    const double* numBits,
+    int count,
+    double* per)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        per[i] = PHY_ErrorTablePer(tables[i], sinr[i], numBits[i]);
+    }
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+// /**
+// PACKAGE :: PHY_ERROR_TABLE
+// DESCRIPTION ::
+//     This file describes the packet error tables of the PHY models.
+//     A packet error table holds log(1 - BER) of a BER table, sampled
+//     from PHY_BER on a uniform SNR grid in dB.  A packet of n bits is
+//     then received without error with probability
+//     exp(n * log(1 - BER)), which replaces the PHY_BER and pow calls
+//     of every reception check with an interpolation and one exp.
+//
+//     The table of a BER file is built the first time a radio using
+//     that file needs it and is shared by all the radios.
+// **/
+
+#ifndef PHY_ERROR_TABLE_H
+#define PHY_ERROR_TABLE_H
+
+#include <math.h>
+
+#include "api.h"
+
+// /**
+// CONSTANT :: PHY_ERROR_TABLE_STEPS_PER_ENTRY : 32
+// DESCRIPTION :: Grid points per smallest SNR interval of the BER table
+// **/
+#define PHY_ERROR_TABLE_STEPS_PER_ENTRY 32
+
+// /**
+// CONSTANT :: PHY_ERROR_TABLE_MAX_POINTS : 65536
+// DESCRIPTION :: Maximum number of grid points of a table
+// **/
+#define PHY_ERROR_TABLE_MAX_POINTS 65536
+
+// /**
+// CONSTANT :: PHY_ERROR_TABLE_MARGIN_POINTS : 2
+// DESCRIPTION :: Grid points sampled beyond each end of the BER table,
+//                so that SNRs outside the table get the values PHY_BER
+//                returns there
+// **/
+#define PHY_ERROR_TABLE_MARGIN_POINTS 2
+
+// /**
+// CONSTANT :: PHY_ERROR_TABLE_MIN_LOG : -700.0
+// DESCRIPTION :: Smallest log(1 - BER) stored, used for a BER of 1
+// **/
+#define PHY_ERROR_TABLE_MIN_LOG -700.0
+
+// /**
+// STRUCT      :: PhyErrorTable
+// DESCRIPTION :: log(1 - BER) of a BER table on a uniform SNR grid
+// **/
+struct PhyErrorTable {
+    const PhyBerEntry* berEntries;  // entries of the BER table sampled
+    double             snrStart_dB;
+    double             stepsPer_dB;
+    int                numPoints;
+    double*            logNoError;  // numPoints + 1, last one repeated
+
+    // PHY_BER is exactly 0 at and above this SNR, which the grid does
+    // not resolve.  -HUGE_VAL if the table is all 0, HUGE_VAL if its
+    // last BER is not 0.
+    double             zeroBerSnr_dB;
+};
+
+// /**
+// API        :: PHY_GetErrorTable
+// LAYER      :: Physical
+// PURPOSE    :: Get the packet error table of a BER table of a PHY.
+// PARAMETERS ::
+// + phyData       : PhyData* : PHY layer data
+// + berTableIndex : int      : index of the BER table
+// RETURN     :: const PhyErrorTable* : Packet error table
+// **/
+const PhyErrorTable* PHY_GetErrorTable(PhyData* phyData, int berTableIndex);
+
+// /**
+// API        :: PHY_ErrorTableIsErrorFree
+// LAYER      :: Physical
+// PURPOSE    :: Check if PHY_BER is exactly 0 at a SINR, that is if the
+//               SINR is at or above the first entry of the BER table from
+//               which on all BERs are 0.
+// PARAMETERS ::
+// + table : const PhyErrorTable* : Packet error table
+// + sinr  : double               : Signal to Interference and Noise Ratio
+// RETURN     :: BOOL : TRUE if the BER is 0
+// **/
+static inline
+BOOL PHY_ErrorTableIsErrorFree(const PhyErrorTable* table, double sinr)
+{
+    return IN_DB(sinr) >= table->zeroBerSnr_dB;
+}
+
+// /**
+// API        :: PHY_ErrorTableLogNoError
+// LAYER      :: Physical
+// PURPOSE    :: Get log(1 - BER) at a SINR.  0 if the BER is 0.
+// PARAMETERS ::
+// + table : const PhyErrorTable* : Packet error table
+// + sinr  : double               : Signal to Interference and Noise Ratio
+// RETURN     :: double : log(1 - BER)
+// **/
+static inline
+double PHY_ErrorTableLogNoError(const PhyErrorTable* table, double sinr)
+{
+    double sinr_dB = IN_DB(sinr);
+    double position = (sinr_dB - table->snrStart_dB) * table->stepsPer_dB;
+    double last = (double) (table->numPoints - 1);
+    double logNoError;
+    int index;
+
+    // Written without branches so that batches vectorize.  A SINR of 0
+    // or NaN ends up on the first point.
+    position = position > 0.0 ? position : 0.0;
+    position = position < last ? position : last;
+    index = (int) position;
+
+    logNoError = table->logNoError[index]
+                 + (position - index)
+                   * (table->logNoError[index + 1]
+                      - table->logNoError[index]);
+
+    // Between the grid points around the first BER of 0 the
+    // interpolation is not 0
+    return sinr_dB >= table->zeroBerSnr_dB ? 0.0 : logNoError;
+}
+
+// /**
+// API        :: PHY_PacketErrorProbability
+// LAYER      :: Physical
+// PURPOSE    :: Get the probability that a packet has an error.
+// PARAMETERS ::
+// + logNoError : double : log(1 - BER) returned by
+//                         PHY_ErrorTableLogNoError
+// + numBits    : double : Number of bits of the packet
+// RETURN     :: double : Packet error probability
+// **/
+static inline
+double PHY_PacketErrorProbability(double logNoError, double numBits)
+{
+    return 1.0 - exp(numBits * logNoError);
+}
+
+// /**
+// API        :: PHY_ErrorTablePer
+// LAYER      :: Physical
+// PURPOSE    :: Get the probability that a packet received at a SINR
+//               has an error.
+// PARAMETERS ::
+// + table   : const PhyErrorTable* : Packet error table
+// + sinr    : double               : Signal to Interference and Noise
+//                                    Ratio
+// + numBits : double               : Number of bits of the packet
+// RETURN     :: double : Packet error probability
+// **/
+static inline
+double PHY_ErrorTablePer(
+    const PhyErrorTable* table,
+    double sinr,
+    double numBits)
+{
+    return PHY_PacketErrorProbability(
+               PHY_ErrorTableLogNoError(table, sinr), numBits);
+}
+
+// /**
+// API        :: PHY_ErrorTablePerBatch
+// LAYER      :: Physical
+// PURPOSE    :: Get the packet error probabilities of several packets,
+//               for example of all the transport blocks or MCSs
+//               evaluated in a subframe.
+// PARAMETERS ::
+// + tables  : const PhyErrorTable* const* : Packet error table of each
+//                                           packet
+// + sinr    : const double*               : SINR of each packet
+// + numBits : const double*               : Number of bits of each
+//                                           packet
+// + count   : int                         : Number of packets
+// + per     : double*                     : Storage for the packet error
+//                                           probabilities
+// RETURN     :: void :
+// **/
+void PHY_ErrorTablePerBatch(
+    const PhyErrorTable* const* tables,
+    const double* sinr,
+    const double* numBits,
+    int count,
+    double* per);
+
+#endif // PHY_ERROR_TABLE_H
@@ -19,6 +19,17 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <limits>
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "api.h"
 #include "partition.h"
@@ -27,12 +38,11 @@
 #define ROUNDING_ERROR_ALLOWANCE 1.0e-5
 #define HIGH_PATHLOSS       1000
 
-#ifndef USE_MPI
-#include <pthread.h>
+// NodeId -> row is a direct array unless the ids are this much sparser
+// than the nodes
+#define PL_MATRIX_MAX_ROW_INDEX_RATIO  16
 
-// Mutex used to protect matrix when updating in shared memory mode
-pthread_mutex_t updateMutex;
-#endif
+#define PL_MATRIX_PAGE_SIZE  4096
 
 
 BOOL sortPathLoss(pathLossMatrixValue p1, pathLossMatrixValue p2)
@@ -41,120 +51,394 @@ BOOL sortPathLoss(pathLossMatrixValue p1, pathLossMatrixValue p2)
         return p1.simTime < p2.simTime;
 }
 
+static
+float PathlossMatrixMissingValue()
+{
+    return std::numeric_limits<float>::quiet_NaN();
+}
+
+static
+size_t PathlossMatrixAlign8(size_t offset)
+{
+    return (offset + 7) & ~((size_t)7);
+}
+
+// Multiplies two sizes, FALSE if the product does not fit in size_t
+static
+BOOL PathlossMatrixMultiply(size_t a, size_t b, size_t* product)
+{
+    if (a != 0 && b > std::numeric_limits<size_t>::max() / a)
+    {
+        return FALSE;
+    }
+    *product = a * b;
+    return TRUE;
+}
+
 // /**
-// FUNCTION :: PathlossMatrixUpdate
+// FUNCTION :: PathlossMatrixRow
 // LAYER :: Propagation Layer
-// PURPOSE :: Reads the PathLoss Matrix from a file
+// PURPOSE :: Returns the matrix row of a node
 // PARAMETERS ::
-// + partitionData : PartitionData* : PartitionData where matrix value is stored
-// + propChannel : PropChannel* : Proapagation channel
-// + totalNumChannels : int : total number of channels
-// RETURN :: void : NULL
+// + source : const PathlossMatrixSource* : Matrix input
+// + nodeId : NodeId : Node
+// RETURN :: int : row, or -1 if the node is not in the matrix
 // **/
 
-static void PathlossMatrixUpdate(
-    PartitionData* partitionData,
-    PropChannel* propChannel,
-    int totalNumChannels,
-    clocktype currentTime)
+static
+int PathlossMatrixRow(const PathlossMatrixSource* source, NodeId nodeId)
 {
+    if (source->rowOfNode != NULL)
+    {
+        if (nodeId > source->maxNodeId)
+        {
+            return -1;
+        }
+        return source->rowOfNode[nodeId];
+    }
 
-#ifndef USE_MPI
-    // Protect the matrix since it is global in shared memory
-    if (partitionData->isRunningInParallel())
+    const NodeId* begin = source->nodeIds;
+    const NodeId* end = begin + source->numNodes;
+    const NodeId* it = std::lower_bound(begin, end, nodeId);
+    if (it == end || *it != nodeId)
     {
-        pthread_mutex_lock(&updateMutex);
+        return -1;
     }
-#endif
+    return (int)(it - begin);
+}
 
-    PropProfile* propProfile0 = propChannel[0].profile;
-    char buffer[MAX_STRING_LENGTH];
-    char* StrPtr;
+// /**
+// FUNCTION :: PathlossMatrixBuildRowIndex
+// LAYER :: Propagation Layer
+// PURPOSE :: Builds the NodeId -> row index from the sorted node ids
+// PARAMETERS ::
+// + source : PathlossMatrixSource* : Matrix input with nodeIds set
+// RETURN :: void : NULL
+// **/
 
-    int j = 0;
-    int srcNode;
-    int dstNode;
+static
+void PathlossMatrixBuildRowIndex(PathlossMatrixSource* source)
+{
+    source->rowOfNode = NULL;
+    source->maxNodeId = 0;
 
-    pair <NodeId, NodeId> srcdstPair;
-    map < pair <NodeId, NodeId>, double> ::iterator it;
+    if (source->numNodes == 0)
+    {
+        return;
+    }
 
-    while (TRUE)
+    source->maxNodeId = source->nodeIds[source->numNodes - 1];
+    if ((double)source->maxNodeId >
+        (double)source->numNodes * PL_MATRIX_MAX_ROW_INDEX_RATIO + 1024)
     {
-        if (partitionData->plCurrentIndex >= (int)propProfile0->matrixList.size())
-        {
-            break;
-        }
+        // Sparse ids, PathlossMatrixRow uses binary search
+        return;
+    }
 
-        pathLossMatrixValue pathLossData =
-                    propProfile0->matrixList.at(partitionData->plCurrentIndex);
+    source->rowOfNode =
+        (int*)MEM_malloc(sizeof(int) * ((size_t)source->maxNodeId + 1));
+    for (NodeId id = 0; id <= source->maxNodeId; id++)
+    {
+        source->rowOfNode[id] = -1;
+    }
+    for (int i = 0; i < source->numNodes; i++)
+    {
+        source->rowOfNode[source->nodeIds[i]] = i;
+    }
+}
 
-        if (pathLossData.simTime > currentTime)
+// /**
+// FUNCTION :: PathlossMatrixChannelOfFrequency
+// LAYER :: Propagation Layer
+// PURPOSE :: Finds the channel configured at a frequency
+// PARAMETERS ::
+// + propChannel : PropChannel* : Proapagation channel
+// + totalNumChannels : int : total number of channels
+// + frequency : double : frequency in Hz
+// RETURN :: int : channel index
+// **/
+
+static
+int PathlossMatrixChannelOfFrequency(
+    PropChannel* propChannel,
+    int totalNumChannels,
+    double frequency)
+{
+    int j;
+
+    for (j = 0; j < totalNumChannels; j++) {
+        if (fabs(frequency - propChannel[j].profile->frequency) /
+            frequency < ROUNDING_ERROR_ALLOWANCE)
         {
             break;
         }
+    }
+    if (j == totalNumChannels) {
+        char errorMessage[MAX_STRING_LENGTH];
 
-        partitionData->plCurrentIndex++;
+        sprintf(errorMessage,
+                "could not find a channel at %f Hz",
+                frequency);
+        ERROR_ReportError(errorMessage);
+    }
+
+    return j;
+}
+
+// /**
+// FUNCTION :: PathlossMatrixApplyLines
+// LAYER :: Propagation Layer
+// PURPOSE :: Applies the text lines of one snapshot to a matrix
+// PARAMETERS ::
+// + propProfile0 : PropProfile* : Profile of channel 0
+// + values : float* : [slot][row][column] matrix holding the previous
+//                     snapshot
+// + snapshot : int : snapshot to apply
+// RETURN :: void : NULL
+// **/
+
+static
+void PathlossMatrixApplyLines(
+    PropProfile* propProfile0,
+    float* values,
+    int snapshot)
+{
+    PathlossMatrixSource* source = propProfile0->matrixSource;
+    size_t matrixSize = (size_t)source->numNodes * source->numNodes;
+    char buffer[MAX_STRING_LENGTH];
+    char* StrPtr;
+
+    for (int i = source->snapshotFirstLine[snapshot];
+         i < source->snapshotFirstLine[snapshot + 1];
+         i++)
+    {
+        const pathLossMatrixValue& pathLossData = propProfile0->matrixList[i];
 
         IO_GetToken(buffer,
                     pathLossData.values.c_str(),
                     &StrPtr);
-
-        srcNode = atoi(buffer);
+        int srcRow = PathlossMatrixRow(source, (NodeId)atoi(buffer));
 
         IO_GetToken(buffer, StrPtr, &StrPtr);
-        dstNode = atoi(buffer);
+        int dstRow = PathlossMatrixRow(source, (NodeId)atoi(buffer));
 
-        srcdstPair = make_pair(srcNode, dstNode);
+        if (srcRow == -1 || dstRow == -1)
+        {
+            char errorMessage[MAX_STRING_LENGTH];
+            sprintf(errorMessage,
+                    "Pathloss matrix line \"%.200s\" is for a node that "
+                    "is not in the matrix",
+                    pathLossData.values.c_str());
+            ERROR_ReportError(errorMessage);
+        }
 
-        j = 0;
+        float* cell = values + (size_t)srcRow * source->numNodes + dstRow;
 
+        int j = 0;
         while (StrPtr != NULL && j < propProfile0->numChannelsInMatrix)
         {
             IO_GetToken(buffer, StrPtr, &StrPtr);
 
             if (strcmp(buffer, ""))
             {
-                int channelIndex = propProfile0->channelIndexArray[j];
-                it = partitionData->pathLossMatrix[channelIndex]->find(srcdstPair);
+                cell[j * matrixSize] = (float)atof(buffer);
+            }
+            j++;
+        }
+    }
+}
 
-                if (it == partitionData->pathLossMatrix[channelIndex]->end())
-                {
+// /**
+// FUNCTION :: PathlossMatrixPrepareSnapshot
+// LAYER :: Propagation Layer
+// PURPOSE :: Makes snapshot ready for use.  For text input, next is
+//            filled with previous plus the lines of the snapshot.  For
+//            binary input the pages of the snapshot are read ahead.
+// PARAMETERS ::
+// + propProfile0 : PropProfile* : Profile of channel 0
+// + table : PathlossMatrixTable* : Partition matrix
+// + previous : const float* : text: matrix of snapshot - 1, or NULL
+// + next : float* : text: matrix to fill
+// + snapshot : int : snapshot to prepare
+// RETURN :: void : NULL
+// **/
 
-                    partitionData->pathLossMatrix[channelIndex]->insert(
-                            map< pair<NodeId ,NodeId>, double>::value_type(
-                                             srcdstPair,
-                                             atof(buffer)));
-                }
-                else
-                {
-                    it->second = atof(buffer);
-                }
+static
+void PathlossMatrixPrepareSnapshot(
+    PropProfile* propProfile0,
+    PathlossMatrixTable* table,
+    const float* previous,
+    float* next,
+    int snapshot)
+{
+    PathlossMatrixSource* source = table->source;
+    size_t numValues = table->matrixSize * table->numChannels;
+
+    if (!source->isBinary)
+    {
+        if (previous == NULL)
+        {
+            std::fill(next, next + numValues, PathlossMatrixMissingValue());
+        }
+        else if (previous != next)
+        {
+            memcpy(next, previous, numValues * sizeof(float));
+        }
+        PathlossMatrixApplyLines(propProfile0, next, snapshot);
+        return;
+    }
+
+#ifndef _WIN32
+    if (source->isMapped)
+    {
+        const char* start =
+            (const char*)(source->snapshotValues + numValues * snapshot);
+        size_t length = numValues * sizeof(float);
+        size_t pageOffset = (size_t)(start - (const char*)source->fileBase)
+                            % PL_MATRIX_PAGE_SIZE;
+
+        madvise((void*)(start - pageOffset), length + pageOffset,
+                MADV_WILLNEED);
+
+        // Fault the pages in now rather than on the first lookups
+        volatile char sink = 0;
+        for (size_t i = 0; i < length; i += PL_MATRIX_PAGE_SIZE)
+        {
+            sink += start[i];
+        }
+    }
+#endif
+}
+
+static
+void* PathlossMatrixLoaderThread(void* arg)
+{
+    PartitionData* partitionData = (PartitionData*)arg;
+    PropProfile* propProfile0 = partitionData->propChannel[0].profile;
+    PathlossMatrixTable* table = partitionData->pathLossMatrix;
+
+    pthread_mutex_lock(&table->loaderMutex);
+    while (TRUE)
+    {
+        while (table->requestedSnapshot == table->preparedSnapshot &&
+               !table->stopLoader)
+        {
+            pthread_cond_wait(&table->loaderCond, &table->loaderMutex);
+        }
+        if (table->stopLoader)
+        {
+            break;
+        }
+
+        int snapshot = table->requestedSnapshot;
+        const float* previous = table->values;
+        float* next = table->nextValues;
+        pthread_mutex_unlock(&table->loaderMutex);
+
+        PathlossMatrixPrepareSnapshot(
+            propProfile0, table, previous, next, snapshot);
+
+        pthread_mutex_lock(&table->loaderMutex);
+        table->preparedSnapshot = snapshot;
+        pthread_cond_broadcast(&table->loaderCond);
+    }
+    pthread_mutex_unlock(&table->loaderMutex);
+
+    return NULL;
+}
+
+// /**
+// FUNCTION :: PathlossMatrixUpdate
+// LAYER :: Propagation Layer
+// PURPOSE :: Moves the partition matrix to the last snapshot at or
+//            before currentTime, and starts preparing the one after it
+// PARAMETERS ::
+// + partitionData : PartitionData* : PartitionData where matrix value is stored
+// + propChannel : PropChannel* : Proapagation channel
+// + totalNumChannels : int : total number of channels
+// + currentTime : clocktype : current simulation time
+// RETURN :: void : NULL
+// **/
+
+static void PathlossMatrixUpdate(
+    PartitionData* partitionData,
+    PropChannel* propChannel,
+    int totalNumChannels,
+    clocktype currentTime)
+{
+    PropProfile* propProfile0 = propChannel[0].profile;
+    PathlossMatrixTable* table = partitionData->pathLossMatrix;
+    PathlossMatrixSource* source = table->source;
+    size_t numValues = table->matrixSize * table->numChannels;
+
+    while (partitionData->plCurrentIndex < source->numSnapshots &&
+           source->snapshotTimes[partitionData->plCurrentIndex] <=
+               currentTime)
+    {
+        int snapshot = partitionData->plCurrentIndex;
+
+        if (table->hasLoader)
+        {
+            pthread_mutex_lock(&table->loaderMutex);
+            if (table->requestedSnapshot != snapshot)
+            {
+                table->requestedSnapshot = snapshot;
+                pthread_cond_broadcast(&table->loaderCond);
             }
-            j++;
+            while (table->preparedSnapshot != snapshot)
+            {
+                pthread_cond_wait(&table->loaderCond, &table->loaderMutex);
+            }
+        }
+
+        if (source->isBinary)
+        {
+            table->current = source->snapshotValues + numValues * snapshot;
+        }
+        else if (table->hasLoader)
+        {
+            float* swap = table->values;
+            table->values = table->nextValues;
+            table->nextValues = swap;
+            table->current = table->values;
+        }
+        else
+        {
+            PathlossMatrixPrepareSnapshot(
+                propProfile0, table, table->values, table->values, snapshot);
+            table->current = table->values;
+        }
+
+        partitionData->plCurrentIndex++;
+
+        if (table->hasLoader)
+        {
+            pthread_mutex_unlock(&table->loaderMutex);
         }
     }
 
-    if (partitionData->plCurrentIndex >= (int)propProfile0->matrixList.size()) {
+    if (partitionData->plCurrentIndex >= source->numSnapshots) {
         partitionData->plNextLoadTime = CLOCKTYPE_MAX;
     }
     else {
-        pathLossMatrixValue pathLossData =
-                    propProfile0->matrixList.at(partitionData->plCurrentIndex);
-        partitionData->plNextLoadTime = pathLossData.simTime;
-    }
+        partitionData->plNextLoadTime =
+            source->snapshotTimes[partitionData->plCurrentIndex];
 
-#ifndef USE_MPI
-    if (partitionData->isRunningInParallel())
-    {
-        pthread_mutex_unlock(&updateMutex);
+        if (table->hasLoader)
+        {
+            pthread_mutex_lock(&table->loaderMutex);
+            table->requestedSnapshot = partitionData->plCurrentIndex;
+            pthread_cond_broadcast(&table->loaderCond);
+            pthread_mutex_unlock(&table->loaderMutex);
+        }
     }
-#endif
 }
 
 // /**
-// FUNCTION :: PathlossMatrixInitialize
+// FUNCTION :: PathlossMatrixReadText
 // LAYER :: Propagation Layer
-// PURPOSE :: Initializes the pathloss matrix
+// PURPOSE :: Reads PROPAGATION-PATHLOSS-MATRIX-FILE into matrixList and
+//            indexes its nodes and snapshot times
 // PARAMETERS ::
 // + propChannel : PropChannel* : Proapagation channel
 // + totalNumChannels : int : total number of channels
@@ -162,27 +446,23 @@ static void PathlossMatrixUpdate(
 // RETURN :: void : NULL
 // **/
 
-void PathlossMatrixInitialize(
-    PartitionData* partitionData,
+static
+void PathlossMatrixReadText(
     PropChannel* propChannel,
     int totalNumChannels,
     const NodeInput *nodeInput)
 {
     PropProfile* propProfile0 = propChannel[0].profile;
+    PathlossMatrixSource* source = propProfile0->matrixSource;
     char* buffer;
     BOOL wasFound;
-    int i, j;
+    int i;
     char* StrStartPtr;
     char* StrEndPtr;
     NodeInput matrixInput;
-    clocktype time = 0;
 
     char* StrPtr;
 
-#ifndef USE_MPI
-    pthread_mutex_init(&updateMutex, NULL);
-#endif
-
     IO_ReadCachedFile(
         ANY_NODEID,
         ANY_ADDRESS,
@@ -214,8 +494,6 @@ void PathlossMatrixInitialize(
         (int*)MEM_malloc(propProfile0->numChannelsInMatrix * sizeof(int));
 
     for (i = 0; i < propProfile0->numChannelsInMatrix; i++) {
-        double frequency;
-
         StrStartPtr = StrEndPtr;
 
         if (i != propProfile0->numChannelsInMatrix - 1) {
@@ -224,25 +502,11 @@ void PathlossMatrixInitialize(
             StrEndPtr++;
         }
 
-        frequency = atof(StrStartPtr) * 1.0e9;
-
-        for (j = 0; j < totalNumChannels; j++) {
-            if (fabs(frequency - propChannel[j].profile->frequency) /
-                frequency < ROUNDING_ERROR_ALLOWANCE)
-            {
-                break;
-            }
-        }
-        if (j == totalNumChannels) {
-            char errorMessage[MAX_STRING_LENGTH];
-
-            sprintf(errorMessage,
-                    "could not find a channel at %f Hz",
-                    frequency);
-            ERROR_ReportError(errorMessage);
-        }
-
-        propProfile0->channelIndexArray[i] = j;
+        propProfile0->channelIndexArray[i] =
+            PathlossMatrixChannelOfFrequency(
+                propChannel,
+                totalNumChannels,
+                atof(StrStartPtr) * 1.0e9);
     }
 
     strcpy(buffer, matrixInput.inputStrings[1]);
@@ -253,19 +517,8 @@ void PathlossMatrixInitialize(
 
     propProfile0->numNodesInMatrix = atoi(StrStartPtr);
 
-    //
-    // Create pathlossMatrix
-    //
-    int listSize = sizeof(map <pair<NodeId, NodeId>, double>*) *
-                   propProfile0->numChannelsInMatrix;
-    partitionData->pathLossMatrix = (map <pair<NodeId, NodeId>, double>**) MEM_malloc(listSize);
-    memset(partitionData->pathLossMatrix, 0, listSize);
-
-    for (i = 0; i < propProfile0->numChannelsInMatrix; i++) {
-        partitionData->pathLossMatrix[propProfile0->channelIndexArray[i]] =
-            new map<pair<NodeId, NodeId>, double>();
-    }
-
+    vector<NodeId> nodeIds;
+    nodeIds.reserve(propProfile0->numNodesInMatrix);
 
     for (i = 2; i < matrixInput.numLines; i++)
     {
@@ -277,35 +530,471 @@ void PathlossMatrixInitialize(
         pathLossData.simTime = (clocktype)(atof(buffer) * SECOND);
         pathLossData.values.assign(StrPtr);
 
+        IO_GetToken(buffer, StrPtr, &StrPtr);
+        nodeIds.push_back((NodeId)atoi(buffer));
+        IO_GetToken(buffer, StrPtr, &StrPtr);
+        nodeIds.push_back((NodeId)atoi(buffer));
+
         propProfile0->matrixList.push_back(pathLossData);
     }
 
+    // Lines of the same time are applied in file order
+    stable_sort(propProfile0->matrixList.begin(),
+                propProfile0->matrixList.end(),
+                sortPathLoss);
+
+    sort(nodeIds.begin(), nodeIds.end());
+    nodeIds.erase(unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
 
-    if (propProfile0->matrixList.empty())
+    source->numNodes = (int)nodeIds.size();
+    source->nodeIds =
+        (NodeId*)MEM_malloc(sizeof(NodeId) * MAX(source->numNodes, 1));
+    if (source->numNodes > 0)
     {
-        partitionData->plNextLoadTime = CLOCKTYPE_MAX;
+        memcpy(source->nodeIds, &nodeIds[0],
+               sizeof(NodeId) * source->numNodes);
+    }
+    PathlossMatrixBuildRowIndex(source);
+
+    // One snapshot per distinct time
+    int numLines = (int)propProfile0->matrixList.size();
+    vector<clocktype> times;
+    vector<int> firstLines;
+    for (i = 0; i < numLines; i++)
+    {
+        if (i == 0 ||
+            propProfile0->matrixList[i].simTime !=
+                propProfile0->matrixList[i - 1].simTime)
+        {
+            times.push_back(propProfile0->matrixList[i].simTime);
+            firstLines.push_back(i);
+        }
+    }
+    firstLines.push_back(numLines);
+
+    source->numSnapshots = (int)times.size();
+    source->snapshotTimes =
+        (clocktype*)MEM_malloc(sizeof(clocktype) * (times.size() + 1));
+    source->snapshotFirstLine =
+        (int*)MEM_malloc(sizeof(int) * firstLines.size());
+    for (i = 0; i < source->numSnapshots; i++)
+    {
+        source->snapshotTimes[i] = times[i];
+    }
+    for (i = 0; i < (int)firstLines.size(); i++)
+    {
+        source->snapshotFirstLine[i] = firstLines[i];
+    }
+
+    MEM_free(buffer);
+}
+
+// /**
+// FUNCTION :: PathlossMatrixSourceStamp
+// LAYER :: Propagation Layer
+// PURPOSE :: Gets the size and modification time of the text matrix
+//            file, which a binary matrix file must match to be used
+// PARAMETERS ::
+// + nodeInput : const NodeInput* : Pointer to node input
+// + sourceSize : Int64* : set to the size, -1 if there is no file
+// + sourceModTime : Int64* : set to the modification time
+// RETURN :: void : NULL
+// **/
+
+static
+void PathlossMatrixSourceStamp(
+    const NodeInput* nodeInput,
+    Int64* sourceSize,
+    Int64* sourceModTime)
+{
+    char fileName[MAX_STRING_LENGTH];
+    BOOL wasFound;
+    struct stat st;
+
+    *sourceSize = -1;
+    *sourceModTime = 0;
+
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-PATHLOSS-MATRIX-FILE",
+        &wasFound,
+        fileName);
+
+    if (wasFound && stat(fileName, &st) == 0)
+    {
+        *sourceSize = (Int64)st.st_size;
+        *sourceModTime = (Int64)st.st_mtime;
+    }
+}
+
+// /**
+// FUNCTION :: PathlossMatrixWriteBinary
+// LAYER :: Propagation Layer
+// PURPOSE :: Writes the text matrix as a binary matrix file, so that
+//            later runs can map it instead of parsing the text
+// PARAMETERS ::
+// + propChannel : PropChannel* : Proapagation channel
+// + fileName : const char* : binary file to write
+// + sourceSize : Int64 : size of the text matrix file
+// + sourceModTime : Int64 : modification time of the text matrix file
+// RETURN :: void : NULL
+// **/
+
+static
+void PathlossMatrixWriteBinary(
+    PropChannel* propChannel,
+    const char* fileName,
+    Int64 sourceSize,
+    Int64 sourceModTime)
+{
+    PropProfile* propProfile0 = propChannel[0].profile;
+    PathlossMatrixSource* source = propProfile0->matrixSource;
+    int numChannels = propProfile0->numChannelsInMatrix;
+    size_t numValues =
+        (size_t)source->numNodes * source->numNodes * numChannels;
+    int i;
+
+    FILE* fp = fopen(fileName, "wb");
+    if (fp == NULL)
+    {
+        char errorMessage[MAX_STRING_LENGTH];
+        sprintf(errorMessage,
+                "Cannot open pathloss matrix file %s for writing",
+                fileName);
+        ERROR_ReportWarning(errorMessage);
+        return;
+    }
+
+    PathlossMatrixFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PL_MATRIX_BINARY_MAGIC, sizeof(header.magic));
+    header.numChannels = numChannels;
+    header.numNodes = source->numNodes;
+    header.numSnapshots = source->numSnapshots;
+    header.sourceSize = sourceSize;
+    header.sourceModTime = sourceModTime;
+    fwrite(&header, sizeof(header), 1, fp);
+
+    for (i = 0; i < numChannels; i++)
+    {
+        double frequency =
+            propChannel[propProfile0->channelIndexArray[i]].profile->frequency;
+        fwrite(&frequency, sizeof(double), 1, fp);
+    }
+    for (i = 0; i < source->numNodes; i++)
+    {
+        Int32 nodeId = (Int32)source->nodeIds[i];
+        fwrite(&nodeId, sizeof(Int32), 1, fp);
+    }
+    size_t offset = sizeof(header) + sizeof(double) * numChannels
+                    + sizeof(Int32) * source->numNodes;
+    while (offset != PathlossMatrixAlign8(offset))
+    {
+        fputc(0, fp);
+        offset++;
+    }
+    for (i = 0; i < source->numSnapshots; i++)
+    {
+        Int64 time = (Int64)source->snapshotTimes[i];
+        fwrite(&time, sizeof(Int64), 1, fp);
+    }
+
+    float* values = (float*)MEM_malloc(sizeof(float) * MAX(numValues, 1));
+    std::fill(values, values + numValues, PathlossMatrixMissingValue());
+    for (i = 0; i < source->numSnapshots; i++)
+    {
+        PathlossMatrixApplyLines(propProfile0, values, i);
+        if (fwrite(values, sizeof(float), numValues, fp) != numValues)
+        {
+            ERROR_ReportWarning("Error writing binary pathloss matrix file");
+            break;
+        }
+    }
+    MEM_free(values);
+    fclose(fp);
+}
+
+// /**
+// FUNCTION :: PathlossMatrixCloseBinary
+// LAYER :: Propagation Layer
+// PURPOSE :: Releases a binary matrix file that is not used after all
+// PARAMETERS ::
+// + source : PathlossMatrixSource* : Matrix input
+// RETURN :: void : NULL
+// **/
+
+static
+void PathlossMatrixCloseBinary(PathlossMatrixSource* source)
+{
+    if (source->isMapped)
+    {
+#ifndef _WIN32
+        munmap(source->fileBase, source->fileSize);
+#endif
     }
     else
     {
-        sort(propProfile0->matrixList.begin(),
-             propProfile0->matrixList.end(),
-             sortPathLoss);
-        pathLossMatrixValue pathLossData = propProfile0->matrixList.front();
-        time = pathLossData.simTime;
-        partitionData->plCurrentIndex = 0;
-        partitionData->plNextLoadTime = pathLossData.simTime;
+        MEM_free(source->fileBase);
     }
+    source->fileBase = NULL;
+    source->fileSize = 0;
+    source->isMapped = FALSE;
+}
 
-    if (time == 0)
+// /**
+// FUNCTION :: PathlossMatrixOpenBinary
+// LAYER :: Propagation Layer
+// PURPOSE :: Maps a binary matrix file written by
+//            PathlossMatrixWriteBinary
+// PARAMETERS ::
+// + propChannel : PropChannel* : Proapagation channel
+// + totalNumChannels : int : total number of channels
+// + fileName : const char* : binary file
+// + sourceSize : Int64 : size of the text matrix file, -1 if unknown
+// + sourceModTime : Int64 : modification time of the text matrix file
+// RETURN :: BOOL : FALSE if the file does not exist, or was written by
+//                  another version or from another text matrix file
+// **/
+
+static
+BOOL PathlossMatrixOpenBinary(
+    PropChannel* propChannel,
+    int totalNumChannels,
+    const char* fileName,
+    Int64 sourceSize,
+    Int64 sourceModTime)
+{
+    PropProfile* propProfile0 = propChannel[0].profile;
+    PathlossMatrixSource* source = propProfile0->matrixSource;
+    char errorMessage[MAX_STRING_LENGTH];
+    char* base = NULL;
+    size_t fileSize = 0;
+    int i;
+
+#ifndef _WIN32
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
     {
-        PathlossMatrixUpdate(
-            partitionData,
-            propChannel,
-            totalNumChannels,
-            0);
+        return FALSE;
     }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        fileSize = (size_t)st.st_size;
+        void* mapped = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            base = (char*)mapped;
+            source->isMapped = TRUE;
+        }
+    }
+    close(fd);
+#endif
 
-    MEM_free(buffer);
+    if (base == NULL)
+    {
+        // No mmap, read the whole file
+        FILE* fp = fopen(fileName, "rb");
+        if (fp == NULL)
+        {
+            return FALSE;
+        }
+        fseek(fp, 0, SEEK_END);
+        fileSize = (size_t)ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        base = (char*)MEM_malloc(MAX(fileSize, 1));
+        if (fread(base, 1, fileSize, fp) != fileSize)
+        {
+            fileSize = 0;
+        }
+        fclose(fp);
+        source->isMapped = FALSE;
+    }
+
+    source->fileBase = base;
+    source->fileSize = fileSize;
+
+    PathlossMatrixFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(&header, base, MIN(fileSize, sizeof(header)));
+
+    // The magic without its version
+    if (fileSize < sizeof(header.magic) ||
+        memcmp(header.magic, PL_MATRIX_BINARY_MAGIC,
+               sizeof(header.magic) - 2))
+    {
+        sprintf(errorMessage, "%s is not a pathloss matrix file", fileName);
+        ERROR_ReportError(errorMessage);
+    }
+    if (fileSize < sizeof(header) ||
+        memcmp(header.magic, PL_MATRIX_BINARY_MAGIC, sizeof(header.magic)) ||
+        (sourceSize >= 0 &&
+         (header.sourceSize != sourceSize ||
+          header.sourceModTime != sourceModTime)))
+    {
+        sprintf(errorMessage,
+                "Pathloss matrix file %s is out of date, it is written "
+                "again from PROPAGATION-PATHLOSS-MATRIX-FILE",
+                fileName);
+        ERROR_ReportWarning(errorMessage);
+        PathlossMatrixCloseBinary(source);
+        return FALSE;
+    }
+    if (header.numChannels != propProfile0->numChannelsInMatrix)
+    {
+        sprintf(errorMessage,
+                "%s has %d channels, %d are configured for the "
+                "pathloss matrix",
+                fileName, header.numChannels,
+                propProfile0->numChannelsInMatrix);
+        ERROR_ReportError(errorMessage);
+    }
+
+    // Each array must fit in the file, and the matrix size in size_t.
+    // Negative counts turn into sizes that don't fit.
+    size_t numValues = 0;
+    size_t valueSize = 0;
+    if ((size_t)header.numChannels > fileSize / sizeof(double) ||
+        (size_t)header.numNodes > fileSize / sizeof(Int32) ||
+        (size_t)header.numSnapshots > fileSize / sizeof(Int64) ||
+        !PathlossMatrixMultiply(header.numNodes, header.numNodes,
+                                &numValues) ||
+        !PathlossMatrixMultiply(numValues, header.numChannels,
+                                &numValues) ||
+        !PathlossMatrixMultiply(numValues, sizeof(float), &valueSize) ||
+        !PathlossMatrixMultiply(valueSize, header.numSnapshots, &valueSize))
+    {
+        sprintf(errorMessage,
+                "Pathloss matrix file %s has invalid dimensions",
+                fileName);
+        ERROR_ReportError(errorMessage);
+    }
+
+    size_t frequencyOffset = sizeof(header);
+    size_t nodeOffset = frequencyOffset + sizeof(double) * header.numChannels;
+    size_t timeOffset = PathlossMatrixAlign8(
+        nodeOffset + sizeof(Int32) * header.numNodes);
+    size_t valueOffset = timeOffset + sizeof(Int64) * header.numSnapshots;
+
+    if (fileSize < valueOffset || fileSize - valueOffset < valueSize)
+    {
+        sprintf(errorMessage, "Pathloss matrix file %s is truncated",
+                fileName);
+        ERROR_ReportError(errorMessage);
+    }
+
+    propProfile0->channelIndexArray =
+        (int*)MEM_malloc(propProfile0->numChannelsInMatrix * sizeof(int));
+    for (i = 0; i < header.numChannels; i++)
+    {
+        double frequency;
+        memcpy(&frequency, base + frequencyOffset + i * sizeof(double),
+               sizeof(double));
+        propProfile0->channelIndexArray[i] =
+            PathlossMatrixChannelOfFrequency(
+                propChannel, totalNumChannels, frequency);
+    }
+
+    source->numNodes = header.numNodes;
+    source->nodeIds =
+        (NodeId*)MEM_malloc(sizeof(NodeId) * MAX(source->numNodes, 1));
+    for (i = 0; i < header.numNodes; i++)
+    {
+        Int32 nodeId;
+        memcpy(&nodeId, base + nodeOffset + i * sizeof(Int32),
+               sizeof(Int32));
+        source->nodeIds[i] = (NodeId)nodeId;
+    }
+    PathlossMatrixBuildRowIndex(source);
+    propProfile0->numNodesInMatrix = header.numNodes;
+
+    source->numSnapshots = header.numSnapshots;
+    source->snapshotTimes =
+        (clocktype*)MEM_malloc(sizeof(clocktype) * (header.numSnapshots + 1));
+    for (i = 0; i < header.numSnapshots; i++)
+    {
+        Int64 time;
+        memcpy(&time, base + timeOffset + i * sizeof(Int64), sizeof(Int64));
+        source->snapshotTimes[i] = (clocktype)time;
+    }
+    source->snapshotFirstLine = NULL;
+    source->snapshotValues = (const float*)(base + valueOffset);
+    source->isBinary = TRUE;
+
+    return TRUE;
+}
+
+// /**
+// FUNCTION :: PathlossMatrixInitialize
+// LAYER :: Propagation Layer
+// PURPOSE :: Initializes the pathloss matrix
+// PARAMETERS ::
+// + propChannel : PropChannel* : Proapagation channel
+// + totalNumChannels : int : total number of channels
+// + nodeInput : NodeInput :Pointer to node input
+// RETURN :: void : NULL
+// **/
+
+void PathlossMatrixInitialize(
+    PartitionData* partitionData,
+    PropChannel* propChannel,
+    int totalNumChannels,
+    const NodeInput *nodeInput)
+{
+    PropProfile* propProfile0 = propChannel[0].profile;
+    char buf[MAX_STRING_LENGTH];
+    char binaryFile[MAX_STRING_LENGTH];
+    BOOL wasFound;
+    BOOL hasBinaryFile;
+    Int64 sourceSize = -1;
+    Int64 sourceModTime = 0;
+
+    PathlossMatrixSource* source =
+        (PathlossMatrixSource*)MEM_malloc(sizeof(PathlossMatrixSource));
+    memset(source, 0, sizeof(PathlossMatrixSource));
+    propProfile0->matrixSource = source;
+
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-PATHLOSS-MATRIX-BACKGROUND-LOAD",
+        &wasFound,
+        buf);
+    source->backgroundLoad = !wasFound || strcmp(buf, "NO") != 0;
+
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PROPAGATION-PATHLOSS-MATRIX-BINARY-FILE",
+        &hasBinaryFile,
+        binaryFile);
+
+    if (hasBinaryFile)
+    {
+        PathlossMatrixSourceStamp(nodeInput, &sourceSize, &sourceModTime);
+        if (PathlossMatrixOpenBinary(propChannel,
+                                     totalNumChannels,
+                                     binaryFile,
+                                     sourceSize,
+                                     sourceModTime))
+        {
+            return;
+        }
+    }
+
+    PathlossMatrixReadText(propChannel, totalNumChannels, nodeInput);
+
+    if (hasBinaryFile && partitionData->partitionId == 0)
+    {
+        PathlossMatrixWriteBinary(propChannel,
+                                  binaryFile,
+                                  sourceSize,
+                                  sourceModTime);
+    }
 }
 
 // /**
@@ -326,37 +1015,85 @@ void PathlossMatrixPartitionInit(PartitionData *partitionData,
 
     if (propProfile0->numChannelsInMatrix > 0)
     {
-        int listSize = sizeof(map <pair<NodeId, NodeId>, double>*) *
-                       partitionData->numChannels;
-
-        partitionData->pathLossMatrix = (map <pair<NodeId, NodeId>, double>**) MEM_malloc(listSize);
-        memset(partitionData->pathLossMatrix, 0, listSize);
-
-        // only allocate for channels configured for pathloss matrix
+        PathlossMatrixSource* source = propProfile0->matrixSource;
+        PathlossMatrixTable* table =
+            (PathlossMatrixTable*)MEM_malloc(sizeof(PathlossMatrixTable));
+        memset(table, 0, sizeof(PathlossMatrixTable));
+
+        table->source = source;
+        table->numChannels = propProfile0->numChannelsInMatrix;
+        table->matrixSize = (size_t)source->numNodes * source->numNodes;
+
+        // only channels configured for pathloss matrix have a slot
+        table->slotOfChannel =
+            (int*)MEM_malloc(sizeof(int) * partitionData->numChannels);
+        for (int i = 0; i < partitionData->numChannels; i++)
+        {
+            table->slotOfChannel[i] = -1;
+        }
         for (int i = 0; i < propProfile0->numChannelsInMatrix; i++) {
-            partitionData->pathLossMatrix[propProfile0->channelIndexArray[i]] =
-                new map<pair<NodeId, NodeId>, double>();
+            table->slotOfChannel[propProfile0->channelIndexArray[i]] = i;
+        }
+
+        if (!source->isBinary)
+        {
+            size_t numValues = table->matrixSize * table->numChannels;
+            table->values =
+                (float*)MEM_malloc(sizeof(float) * MAX(numValues, 1));
+            std::fill(table->values, table->values + numValues,
+                      PathlossMatrixMissingValue());
+            if (source->backgroundLoad && source->numSnapshots > 1)
+            {
+                table->nextValues =
+                    (float*)MEM_malloc(sizeof(float) * MAX(numValues, 1));
+            }
         }
 
-        if (propProfile0->matrixList.empty())
+        partitionData->pathLossMatrix = table;
+        partitionData->plCurrentIndex = 0;
+
+        if (source->numSnapshots == 0)
         {
             partitionData->plNextLoadTime = CLOCKTYPE_MAX;
         }
         else
         {
-            pathLossMatrixValue pathLossData = propProfile0->matrixList.front();
-            partitionData->plCurrentIndex = 0;
-            partitionData->plNextLoadTime = pathLossData.simTime;
+            partitionData->plNextLoadTime = source->snapshotTimes[0];
         }
 
-        if (partitionData->plNextLoadTime == 0)
+        table->requestedSnapshot = -1;
+        table->preparedSnapshot = -1;
+        table->stopLoader = FALSE;
+        if (source->backgroundLoad && source->numSnapshots > 1 &&
+            (!source->isBinary || source->isMapped))
         {
-            PathlossMatrixUpdate(
-                partitionData,
-                propChannel,
-                propProfile0->numChannelsInMatrix,
-                0);
+            pthread_mutex_init(&table->loaderMutex, NULL);
+            pthread_cond_init(&table->loaderCond, NULL);
+            if (pthread_create(&table->loader,
+                               NULL,
+                               PathlossMatrixLoaderThread,
+                               partitionData) == 0)
+            {
+                table->hasLoader = TRUE;
+            }
+            else
+            {
+                // Load in the simulation thread instead
+                pthread_cond_destroy(&table->loaderCond);
+                pthread_mutex_destroy(&table->loaderMutex);
+                if (table->nextValues != NULL)
+                {
+                    MEM_free(table->nextValues);
+                    table->nextValues = NULL;
+                }
+            }
         }
+
+        PathlossMatrixUpdate(
+            partitionData,
+            propChannel,
+            propProfile0->numChannelsInMatrix,
+            0);
     }
 }
 
@@ -383,10 +1120,7 @@ double PathlossMatrix(
     PartitionData* partitionData = node->partitionData;
     PropChannel* propChannel = node->partitionData->propChannel;
     PropProfile* propProfile0 = propChannel[0].profile;
-
-    pair <NodeId, NodeId> srcdstPair (nodeId1, nodeId2);
-    map < pair<NodeId, NodeId>, double> ::iterator it;
-
+    PathlossMatrixTable* table = partitionData->pathLossMatrix;
 
     if (partitionData->plNextLoadTime < currentTime) {
         PathlossMatrixUpdate(
@@ -396,30 +1130,99 @@ double PathlossMatrix(
             getSimTime(node));
     }
 
-    it = partitionData->pathLossMatrix[channelIndex]->
-                            find(srcdstPair);
+    int slot = table->slotOfChannel[channelIndex];
+    int row1 = PathlossMatrixRow(table->source, nodeId1);
+    int row2 = PathlossMatrixRow(table->source, nodeId2);
 
-    if (it == partitionData->pathLossMatrix[channelIndex]->
-                            end())
+    if (table->current == NULL || slot < 0 || row1 < 0 || row2 < 0)
     {
-       srcdstPair = make_pair(nodeId2, nodeId1);
+        return HIGH_PATHLOSS;
+    }
 
-        it = partitionData->pathLossMatrix[channelIndex]->
-                            find(srcdstPair);
+    const float* matrix = table->current + table->matrixSize * slot;
+    int numNodes = table->source->numNodes;
 
-        if (it == partitionData->pathLossMatrix[channelIndex]->
-                            end())
+    float value = matrix[(size_t)row1 * numNodes + row2];
+    if (value != value)
+    {
+        value = matrix[(size_t)row2 * numNodes + row1];
+        if (value != value)
         {
             return HIGH_PATHLOSS;
         }
-        else
-        {
-            return it->second;
-        }
     }
-    else
+
+    return value;
+}
+
+// /**
+// FUNCTION :: PathlossMatrixPartitionFinalize
+// LAYER :: Propagation Layer
+// PURPOSE :: Stops the loader thread and frees the partition matrix
+// PARAMETERS ::
+// + partitionData : PartitionData * : Pointer to the partition
+// RETURN :: void : NULL
+// **/
+
+void PathlossMatrixPartitionFinalize(PartitionData* partitionData)
+{
+    PathlossMatrixTable* table = partitionData->pathLossMatrix;
+
+    if (table == NULL)
     {
-        return it->second;
+        return;
     }
+
+    if (table->hasLoader)
+    {
+        pthread_mutex_lock(&table->loaderMutex);
+        table->stopLoader = TRUE;
+        pthread_cond_broadcast(&table->loaderCond);
+        pthread_mutex_unlock(&table->loaderMutex);
+
+        pthread_join(table->loader, NULL);
+        pthread_cond_destroy(&table->loaderCond);
+        pthread_mutex_destroy(&table->loaderMutex);
+        table->hasLoader = FALSE;
+    }
+
+    if (table->values != NULL)
+    {
+        MEM_free(table->values);
+    }
+    if (table->nextValues != NULL)
+    {
+        MEM_free(table->nextValues);
+    }
+    MEM_free(table->slotOfChannel);
+    MEM_free(table);
+
+    partitionData->pathLossMatrix = NULL;
 }
 
+// /**
+// FUNCTION :: PathlossMatrixAdvance
+// LAYER :: Propagation Layer
+// PURPOSE :: Applies the matrix snapshots up to currentTime
+// PARAMETERS ::
+// + partitionData : PartitionData * : Pointer to the partition
+// + currentTime : clocktype : current simulation time
+// RETURN :: void : NULL
+// **/
+
+void PathlossMatrixAdvance(
+    PartitionData* partitionData,
+    clocktype currentTime)
+{
+    PropChannel* propChannel = partitionData->propChannel;
+
+    if (partitionData->pathLossMatrix != NULL &&
+        partitionData->plNextLoadTime < currentTime)
+    {
+        PathlossMatrixUpdate(
+            partitionData,
+            propChannel,
+            propChannel[0].profile->numChannelsInMatrix,
+            currentTime);
+    }
+}
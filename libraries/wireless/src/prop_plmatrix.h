@@ -18,6 +18,101 @@
 #ifndef PROP_PL_MATRIX_H
 #define PROP_PL_MATRIX_H
 
+#include <pthread.h>
+
+// /**
+// CONSTANT :: PL_MATRIX_BINARY_MAGIC : "QNPLMX02"
+// DESCRIPTION :: First 8 bytes of a binary pathloss matrix file.  The
+//                last two are the format version.
+// **/
+#define PL_MATRIX_BINARY_MAGIC "QNPLMX02"
+
+// /**
+// STRUCT :: PathlossMatrixFileHeader
+// DESCRIPTION :: Header of a binary pathloss matrix file, as written
+//                through PROPAGATION-PATHLOSS-MATRIX-BINARY-FILE.
+//                It is followed by
+//                  double frequencies[numChannels]     (Hz)
+//                  Int32  nodeIds[numNodes]            (ascending, padded
+//                                                       to 8 bytes)
+//                  Int64  snapshotTimes[numSnapshots]  (ascending)
+//                  float  values[numSnapshots][numChannels]
+//                               [numNodes][numNodes]
+//                Each snapshot is the full matrix from its time on, in dB
+//                from row node to column node, NaN where there is no
+//                value.  The file is memory mapped, so all partitions
+//                share one copy.  The size and modification time of the
+//                PROPAGATION-PATHLOSS-MATRIX-FILE it was written from are
+//                kept, so that the file is written again when the text
+//                changes.
+// **/
+struct PathlossMatrixFileHeader
+{
+    char  magic[8];
+    Int32 numChannels;
+    Int32 numNodes;
+    Int32 numSnapshots;
+    Int32 reserved;
+    Int64 sourceSize;           // -1 if unknown
+    Int64 sourceModTime;        // seconds since the epoch
+};
+
+// /**
+// STRUCT :: PathlossMatrixSource
+// DESCRIPTION :: Pathloss matrix input shared by all partitions.  Rows
+//                and columns are the nodes of the matrix in NodeId order.
+//                Text input keeps the lines in PropProfile::matrixList,
+//                binary input is mapped.
+// **/
+struct PathlossMatrixSource
+{
+    int        numNodes;
+    NodeId*    nodeIds;          // row -> NodeId
+    int*       rowOfNode;        // NodeId -> row or -1, NULL if sparse
+    NodeId     maxNodeId;
+
+    int        numSnapshots;
+    clocktype* snapshotTimes;
+    int*       snapshotFirstLine; // text: first matrixList line of each
+                                  // snapshot, numSnapshots + 1 entries
+
+    BOOL       isBinary;
+    void*      fileBase;
+    size_t     fileSize;
+    BOOL       isMapped;
+    const float* snapshotValues;  // binary: values of snapshot 0
+
+    BOOL       backgroundLoad;
+};
+
+// /**
+// STRUCT :: PathlossMatrixTable
+// DESCRIPTION :: Per partition pathloss matrix.  Holds one dense
+//                numNodes x numNodes float matrix per channel of the
+//                matrix file.  The next snapshot is prepared by a loader
+//                thread while the current one is in use.
+// **/
+struct PathlossMatrixTable
+{
+    PathlossMatrixSource* source;
+    int        numChannels;      // channels in the matrix
+    int*       slotOfChannel;    // channelIndex -> matrix slot or -1
+    size_t     matrixSize;       // numNodes * numNodes
+
+    const float* current;        // [slot][row][column] of the current
+                                 // snapshot, NULL before the first
+    float*     values;           // text: current snapshot
+    float*     nextValues;       // text: snapshot being prepared
+
+    BOOL       hasLoader;
+    pthread_t  loader;
+    pthread_mutex_t loaderMutex;
+    pthread_cond_t  loaderCond;
+    int        requestedSnapshot;
+    int        preparedSnapshot;
+    BOOL       stopLoader;       // set at finalization
+};
+
 void PathlossMatrixInitialize(
     PartitionData* partitionData,
     PropChannel* propChannel,
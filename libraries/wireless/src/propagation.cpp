@@ -1863,6 +1863,7 @@ void PROP_GlobalInit(PartitionData *partitionData, NodeInput *nodeInput) {
         propProfile->profileIndex = profileIndex;
         if (channelIndex == 0) {
             propProfile->numChannelsInMatrix = 0;
+            propProfile->matrixSource = NULL;
         }
 
         propChannel[channelIndex].numNodes = 0;
@@ -2071,7 +2071,8 @@ void DsrShrinkHeader(Node* node, Message* msg, Int32 size)
     // As we are shrinking DSR header, the header size saved in array
     // 'msg->headerSizes' needs to be updated
 
-    msg->headerSizes[msg->numberOfHeaders - 1] -= size;
+    msg->headerSizes.set(msg->numberOfHeaders - 1,
+                         msg->headerSizes[msg->numberOfHeaders - 1] - size);
 }
 
 //-------------------------------------------------------------------------
@@ -2090,7 +2091,8 @@ void DsrExpandHeader(Node* node, Message* msg, Int32 size)
     // As we are expanding DSR header, the header size saved in array
     // 'msg->headerSizes' needs to be updated
 
-    msg->headerSizes[msg->numberOfHeaders - 1] += size;
+    msg->headerSizes.set(msg->numberOfHeaders - 1,
+                         msg->headerSizes[msg->numberOfHeaders - 1] + size);
 }
 
 //--------------------------------------------------------------------------
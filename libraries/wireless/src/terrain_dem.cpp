@@ -23,6 +23,7 @@
 #include "api.h"
 #include "partition.h"
 #include "terrain_dem.h"
+#include "terrain_tile_store.h"
 #include "qualnet_error.h"
 #include "main.h"
 
@@ -398,6 +399,15 @@ void ReadTypeCRecord(FILE *fp, DemTypeCRecordData *c) {
 }
 
 
+static
+short DemGetPost(const void* source, int line, int post) {
+    const DemTypeBRecordData* b =
+        &((const DemTypeARecordData*)source)->b[line];
+
+    assert(post < b->numRows);
+    return b->elevationData[post];
+}
+
    DemTerrainData::~DemTerrainData()
    {
        unsigned int i;
@@ -408,6 +418,7 @@ void ReadTypeCRecord(FILE *fp, DemTypeCRecordData *c) {
            MEM_free(a->b);
            MEM_free(a);
    }
+       delete m_tileStore;
 
 }
 
@@ -418,6 +429,8 @@ void DemTerrainData::initialize(NodeInput* nodeInput) {
     FILE *fp;
     int fileIndex = 0;
 
+    m_tileStore = TerrainTileStore::create(m_terrainData, nodeInput, false);
+
     while (TRUE) {
         DemTypeARecordData* a;
 
@@ -435,7 +448,13 @@ void DemTerrainData::initialize(NodeInput* nodeInput) {
             break;
         }
 
-        assert(fileIndex < MAX_NUM_DEM_FILES);
+        if (m_tileStore != NULL &&
+            m_tileStore->addConvertedTile(terrainFilename)) {
+            fileIndex++;
+            continue;
+        }
+
+        assert(m_tileStore != NULL || fileIndex < MAX_NUM_DEM_FILES);
 
         fp = fopen(terrainFilename, "r");
 
@@ -449,8 +468,6 @@ void DemTerrainData::initialize(NodeInput* nodeInput) {
 
         a = (DemTypeARecordData*)MEM_malloc(sizeof(DemTypeARecordData));
 
-        m_records[fileIndex] = a;
-
         //
         // Read Type A Record
         //
@@ -472,6 +489,44 @@ void DemTerrainData::initialize(NodeInput* nodeInput) {
 
         fclose(fp);
 
+        if (m_tileStore != NULL) {
+            double resolution[2] = {a->resolution[0], a->resolution[1]};
+            int numPosts = a->b[0].numRows;
+
+            // A tile is a regular grid.  Padding short profiles would put
+            // made up elevations in the tile range and the interpolation.
+            for (i = 1; i < a->numColumns; i++) {
+                if (a->b[i].numRows != numPosts) {
+                    char errorMessage[MAX_STRING_LENGTH];
+
+                    sprintf(errorMessage,
+                            "DEM-FILENAME %s has profiles of different "
+                            "lengths, which TERRAIN-TILE-CACHE-DIRECTORY "
+                            "does not support",
+                            terrainFilename);
+                    ERROR_ReportError(errorMessage);
+                }
+            }
+
+            m_tileStore->addTile(terrainFilename,
+                                 &a->southWestCorner,
+                                 &a->northEastCorner,
+                                 resolution,
+                                 a->numColumns,
+                                 numPosts,
+                                 DemGetPost,
+                                 a);
+
+            for (i = 0; i < a->numColumns; i++) {
+                MEM_free(a->b[i].elevationData);
+            }
+            MEM_free(a->b);
+            MEM_free(a);
+        }
+        else {
+            m_records[fileIndex] = a;
+        }
+
         fileIndex++;
     }
 
@@ -479,6 +534,16 @@ void DemTerrainData::initialize(NodeInput* nodeInput) {
         ERROR_ReportError("Cannot find DEM-FILENAME in the configuration file");
     }
 
+    if (m_tileStore != NULL) {
+        m_tileStore->buildIndex();
+
+        for (i = 0; i < MAX_NUM_DEM_FILES; i++) {
+            m_records[i] = NULL;
+        }
+        m_numDemFiles = 0;
+        return;
+    }
+
     for (i = fileIndex; i < MAX_NUM_DEM_FILES; i++) {
         m_records[i] = NULL;
     }
@@ -497,8 +562,18 @@ double DemTerrainData::getElevationAt(const Coordinates* point)
 
     CoordinateType elevation;
 
-    // find the file containing this coordinate.
-    int matchingFile = findMatchingFile(point);
+    int matchingFile;
+
+    if (m_tileStore != NULL) {
+        if (m_tileStore->getElevationAt(point, &elevation)) {
+            return elevation;
+        }
+        matchingFile = DEM_NO_MATCH_FOUND;
+    }
+    else {
+        // find the file containing this coordinate.
+        matchingFile = findMatchingFile(point);
+    }
 
     if (matchingFile == DEM_NO_MATCH_FOUND) {
         if (m_terrainData->checkBoundaries()) {
@@ -581,6 +656,11 @@ void DemTerrainData::getHighestAndLowestElevation(
     // but this function is really used for subdividing the terrain into
     // regions and that's mostly for urban terrain.
 
+    if (m_tileStore != NULL) {
+        m_tileStore->getHighestAndLowestElevation(sw, ne, highest, lowest);
+        return;
+    }
+
     int swIndex = findMatchingFile(sw);
     if (swIndex == DEM_NO_MATCH_FOUND) {
         // this is really an error
@@ -20,6 +20,8 @@
 
 #include "terrain.h"
 
+class TerrainTileStore;
+
 #define QUADRANGLE_NAME_LENGTH 144
 #define MAX_NUM_DEM_FILES      100
 #define DEM_NO_MATCH_FOUND     (MAX_NUM_DEM_FILES + 1)
@@ -72,6 +74,9 @@ private:
     UInt32 m_mostRecentFile;
     DemTypeARecordData* m_records[MAX_NUM_DEM_FILES];
 
+    // used instead of m_records if TERRAIN-TILE-CACHE-DIRECTORY is set
+    TerrainTileStore* m_tileStore;
+
     // DEM specific functions
 
     // returns DEM_NO_MATCH_FOUND if there's no match
@@ -81,6 +86,7 @@ public:
     DemTerrainData(TerrainData* td) : ElevationTerrainData(td) {
         m_numDemFiles = 0;
         m_mostRecentFile = 0;
+        m_tileStore = NULL;
         m_modelName = "DEM";
     }
     virtual ~DemTerrainData();
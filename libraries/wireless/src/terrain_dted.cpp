@@ -23,6 +23,7 @@
 #include "api.h"
 #include "partition.h"
 #include "terrain_dted.h"
+#include "terrain_tile_store.h"
 
 #define DEBUG 0
 
@@ -306,20 +307,31 @@ void DtedReadElevationData(FILE *fp, DtedRecordData *a) {
             }
         }
 
+static
+void DtedFreeRecord(DtedRecordData* d) {
+    int r;
+
+    for (r = 0; r < d->numRows; r++) {
+        MEM_free(d->elevationData[r]);
+    }
+    MEM_free(d->elevationData);
+    MEM_free(d);
+}
+
+static
+short DtedGetPost(const void* source, int line, int post) {
+    return ((const DtedRecordData*)source)->elevationData[line][post];
+}
+
 DtedTerrainData::~DtedTerrainData() {
     UInt32 i;
-    int r;
 
     if (DEBUG) printf("DTED destructor called\n");
     // free data
     for (i = 0; i < m_numFiles; i++) {
-        DtedRecordData* d = m_records[i];
-        for (r = 0; r < d->numRows; r++) {
-            MEM_free(d->elevationData[r]);
-        }
-        MEM_free(d->elevationData);
-        MEM_free(d);
+        DtedFreeRecord(m_records[i]);
     }
+    delete m_tileStore;
 }
 
 void DtedTerrainData::initialize(NodeInput* nodeInput) {
@@ -329,6 +341,8 @@ void DtedTerrainData::initialize(NodeInput* nodeInput) {
     FILE *fp;
     int fileIndex = 0;
 
+    m_tileStore = TerrainTileStore::create(m_terrainData, nodeInput, true);
+
     while (TRUE) {
         DtedRecordData* a;
 
@@ -346,7 +360,13 @@ void DtedTerrainData::initialize(NodeInput* nodeInput) {
             break;
         }
 
-        assert(fileIndex < MAX_NUM_DTED_FILES);
+        if (m_tileStore != NULL &&
+            m_tileStore->addConvertedTile(terrainFilename)) {
+            fileIndex++;
+            continue;
+        }
+
+        assert(m_tileStore != NULL || fileIndex < MAX_NUM_DTED_FILES);
 
         fp = fopen(terrainFilename, "rb");
 
@@ -360,8 +380,6 @@ void DtedTerrainData::initialize(NodeInput* nodeInput) {
 
         a = (DtedRecordData*)MEM_malloc(sizeof(DtedRecordData));
 
-        m_records[fileIndex] = a;
-
         //
         // Read UHL
         //
@@ -385,6 +403,21 @@ void DtedTerrainData::initialize(NodeInput* nodeInput) {
 
         fclose(fp);
 
+        if (m_tileStore != NULL) {
+            m_tileStore->addTile(terrainFilename,
+                                 &a->southWestCorner,
+                                 &a->northEastCorner,
+                                 a->resolution,
+                                 a->numRows,
+                                 a->numColumns,
+                                 DtedGetPost,
+                                 a);
+            DtedFreeRecord(a);
+        }
+        else {
+            m_records[fileIndex] = a;
+        }
+
         fileIndex++;
     }
 
@@ -392,6 +425,16 @@ void DtedTerrainData::initialize(NodeInput* nodeInput) {
         ERROR_ReportError("Cannot find DTED-FILENAME in the configuration file");
     }
 
+    if (m_tileStore != NULL) {
+        m_tileStore->buildIndex();
+
+        for (i = 0; i < MAX_NUM_DTED_FILES; i++) {
+            m_records[i] = NULL;
+        }
+        m_numFiles = 0;
+        return;
+    }
+
     // set all remaining entries to NULL.
     for (i = fileIndex; i < MAX_NUM_DTED_FILES; i++) {
         m_records[i] = NULL;
@@ -427,7 +470,17 @@ double DtedTerrainData::getElevationAt(const Coordinates* point) {
 
     CoordinateType elevation;
 
-    int bestFileIndex = findMatchingFile(point);
+    int bestFileIndex;
+
+    if (m_tileStore != NULL) {
+        if (m_tileStore->getElevationAt(point, &elevation)) {
+            return elevation;
+        }
+        bestFileIndex = DTED_NO_MATCH_FOUND;
+    }
+    else {
+        bestFileIndex = findMatchingFile(point);
+    }
 
     if (bestFileIndex == DTED_NO_MATCH_FOUND) {
         if (m_terrainData->checkBoundaries())
@@ -596,6 +649,11 @@ void DtedTerrainData::getHighestAndLowestElevation(
     UInt32 i;
     bool foundOverlap = false;
 
+    if (m_tileStore != NULL) {
+        m_tileStore->getHighestAndLowestElevation(sw, ne, highest, lowest);
+        return;
+    }
+
     *highest = -99999.9;
     *lowest  = 99999.9;
 
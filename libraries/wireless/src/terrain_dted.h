@@ -20,6 +20,8 @@
 
 #include "terrain.h"
 
+class TerrainTileStore;
+
 #define MAX_NUM_DTED_FILES      100
 #define DTED_NO_MATCH_FOUND     (MAX_NUM_DTED_FILES + 1)
 
@@ -39,6 +41,9 @@ private:
     UInt32 m_mostRecentFile;
     DtedRecordData* m_records[MAX_NUM_DTED_FILES];
 
+    // used instead of m_records if TERRAIN-TILE-CACHE-DIRECTORY is set
+    TerrainTileStore* m_tileStore;
+
     // returns DTED_NO_MATCH_FOUND if there's no match
     UInt32 findMatchingFile(const Coordinates* c);
     void   getHighestAndLowestForFile(DtedRecordData* record,
@@ -51,6 +56,7 @@ public:
     DtedTerrainData(TerrainData* td) : ElevationTerrainData(td) {
         m_numFiles = 0;
         m_mostRecentFile = 0;
+        m_tileStore = NULL;
         m_modelName = "DTED";
     }
     virtual ~DtedTerrainData();
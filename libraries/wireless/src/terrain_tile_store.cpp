@@ -0,0 +1,705 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "api.h"
+#include "terrain_tile_store.h"
+
+#define ARC_SECONDS 3600.0
+
+// Cells of the spatial index are at least this fraction of the largest
+// tile, so that a large tile does not fill thousands of cells
+#define TERRAIN_TILE_MAX_CELLS_PER_TILE_SIDE 64
+
+static
+bool TerrainTileGetSourceInfo(const char* fileName,
+                              UInt64* size,
+                              Int64* modified)
+{
+    struct stat info;
+
+    if (stat(fileName, &info) != 0) {
+        return false;
+    }
+    *size = (UInt64)info.st_size;
+    *modified = (Int64)info.st_mtime;
+    return true;
+}
+
+TerrainTileStore::TerrainTileStore(TerrainData* td,
+                                   const char* directory,
+                                   UInt32 cacheSize,
+                                   bool preferFinerResolution)
+{
+    m_terrainData = td;
+    m_directory = directory;
+    m_cacheSize = cacheSize;
+    m_preferFinerResolution = preferFinerResolution;
+    m_cellLatitude = 1.0;
+    m_cellLongitude = 1.0;
+    m_numMapped = 0;
+
+    for (int i = 0; i < TERRAIN_TILE_RECENT_CACHE_SIZE; i++) {
+        m_recentTiles[i] = TERRAIN_TILE_NO_MATCH_FOUND;
+    }
+
+    pthread_mutex_init(&m_mutex, NULL);
+}
+
+TerrainTileStore::~TerrainTileStore()
+{
+    for (UInt32 i = 0; i < m_tiles.size(); i++) {
+        if (m_tiles[i].data != NULL) {
+            unmapTile(&m_tiles[i]);
+        }
+    }
+    pthread_mutex_destroy(&m_mutex);
+}
+
+TerrainTileStore* TerrainTileStore::create(TerrainData* td,
+                                           NodeInput* nodeInput,
+                                           bool preferFinerResolution)
+{
+    char directory[MAX_STRING_LENGTH];
+    BOOL wasFound;
+    int cacheSize;
+
+    IO_ReadString(ANY_NODEID,
+                  ANY_ADDRESS,
+                  nodeInput,
+                  "TERRAIN-TILE-CACHE-DIRECTORY",
+                  &wasFound,
+                  directory);
+
+    if (!wasFound) {
+        return NULL;
+    }
+
+    IO_ReadInt(ANY_NODEID,
+               ANY_ADDRESS,
+               nodeInput,
+               "TERRAIN-TILE-CACHE-SIZE",
+               &wasFound,
+               &cacheSize);
+
+    if (!wasFound) {
+        cacheSize = TERRAIN_TILE_DEFAULT_CACHE_SIZE;
+    }
+    else if (cacheSize < 1) {
+        ERROR_ReportError("TERRAIN-TILE-CACHE-SIZE must be at least 1");
+    }
+
+    return new TerrainTileStore(td,
+                                directory,
+                                (UInt32)cacheSize,
+                                preferFinerResolution);
+}
+
+// <directory>/<source file name>.<hash of the source path>.tile, so that
+// files of the same name in different directories do not collide
+std::string TerrainTileStore::getTileFileName(const char* sourceFileName)
+{
+    const char* baseName = sourceFileName;
+    UInt32 hash = 2166136261U;
+    char suffix[32];
+
+    for (const char* c = sourceFileName; *c != 0; c++) {
+        if (*c == '/' || *c == '\\') {
+            baseName = c + 1;
+        }
+        hash = (hash ^ (unsigned char)*c) * 16777619U;
+    }
+    sprintf(suffix, ".%08x.tile", hash);
+
+    return m_directory + "/" + baseName + suffix;
+}
+
+void TerrainTileStore::addTileFromHeader(const std::string& fileName,
+                                         const TerrainTileHeader& header)
+{
+    Tile tile;
+
+    tile.fileName = fileName;
+    memset(&tile.southWestCorner, 0, sizeof(tile.southWestCorner));
+    memset(&tile.northEastCorner, 0, sizeof(tile.northEastCorner));
+    tile.southWestCorner.latlonalt.latitude = header.southWestLatitude;
+    tile.southWestCorner.latlonalt.longitude = header.southWestLongitude;
+    tile.northEastCorner.latlonalt.latitude = header.northEastLatitude;
+    tile.northEastCorner.latlonalt.longitude = header.northEastLongitude;
+    tile.resolution[0] = header.resolution[0];
+    tile.resolution[1] = header.resolution[1];
+    tile.numLines = header.numLines;
+    tile.numPosts = header.numPosts;
+    tile.lineStride = header.lineStride;
+    tile.minElevation = header.minElevation;
+    tile.maxElevation = header.maxElevation;
+    tile.dataOffset = header.dataOffset;
+    tile.data = NULL;
+    tile.mapping = NULL;
+    tile.mappingSize = 0;
+    tile.pinCount = 0;
+
+    m_tiles.push_back(tile);
+}
+
+bool TerrainTileStore::addConvertedTile(const char* sourceFileName)
+{
+    std::string fileName = getTileFileName(sourceFileName);
+    TerrainTileHeader header;
+    UInt64 sourceSize;
+    Int64 sourceModified;
+    FILE* fp;
+    bool upToDate;
+
+    if (!TerrainTileGetSourceInfo(sourceFileName,
+                                  &sourceSize,
+                                  &sourceModified)) {
+        return false;
+    }
+
+    fp = fopen(fileName.c_str(), "rb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    upToDate = fread(&header, sizeof(header), 1, fp) == 1
+               && header.magic == TERRAIN_TILE_MAGIC
+               && header.version == TERRAIN_TILE_VERSION
+               && header.sourceSize == sourceSize
+               && header.sourceModified == sourceModified;
+    fclose(fp);
+
+    if (upToDate) {
+        addTileFromHeader(fileName, header);
+    }
+    return upToDate;
+}
+
+void TerrainTileStore::addTile(const char* sourceFileName,
+                               const Coordinates* southWestCorner,
+                               const Coordinates* northEastCorner,
+                               const double resolution[2],
+                               int numLines,
+                               int numPosts,
+                               TerrainTilePostFunction getPost,
+                               const void* source)
+{
+    std::string fileName = getTileFileName(sourceFileName);
+    char tempFileName[MAX_STRING_LENGTH];
+    TerrainTileHeader header;
+    int postsPerAlignment = TERRAIN_TILE_LINE_ALIGNMENT / sizeof(short);
+    short* line;
+    FILE* fp;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = TERRAIN_TILE_MAGIC;
+    header.version = TERRAIN_TILE_VERSION;
+    if (!TerrainTileGetSourceInfo(sourceFileName,
+                                  &header.sourceSize,
+                                  &header.sourceModified)) {
+        // never reused
+        header.sourceSize = 0;
+        header.sourceModified = -1;
+    }
+    header.southWestLatitude = southWestCorner->latlonalt.latitude;
+    header.southWestLongitude = southWestCorner->latlonalt.longitude;
+    header.northEastLatitude = northEastCorner->latlonalt.latitude;
+    header.northEastLongitude = northEastCorner->latlonalt.longitude;
+    header.resolution[0] = resolution[0];
+    header.resolution[1] = resolution[1];
+    header.numLines = numLines;
+    header.numPosts = numPosts;
+    header.lineStride =
+        (numPosts + postsPerAlignment - 1)
+        / postsPerAlignment * postsPerAlignment;
+    header.minElevation = 32767;
+    header.maxElevation = -32767;
+    header.dataOffset = TERRAIN_TILE_DATA_ALIGNMENT;
+
+    // Write to a temporary file and rename it, so that other processes
+    // converting the same file never see a partial tile
+#ifdef _WIN32
+    sprintf(tempFileName, "%s.%d", fileName.c_str(), _getpid());
+#else
+    sprintf(tempFileName, "%s.%d", fileName.c_str(), (int)getpid());
+#endif
+
+    fp = fopen(tempFileName, "wb");
+    if (fp == NULL) {
+        char errorMessage[MAX_STRING_LENGTH];
+
+        sprintf(errorMessage,
+                "Cannot create terrain tile %s, "
+                "check TERRAIN-TILE-CACHE-DIRECTORY",
+                tempFileName);
+        ERROR_ReportError(errorMessage);
+    }
+
+    // header is written again once the elevation range is known
+    fseek(fp, header.dataOffset, SEEK_SET);
+
+    line = (short*)MEM_malloc(header.lineStride * sizeof(short));
+    memset(line, 0, header.lineStride * sizeof(short));
+
+    for (int i = 0; i < numLines; i++) {
+        for (int j = 0; j < numPosts; j++) {
+            line[j] = getPost(source, i, j);
+            header.minElevation = MIN(header.minElevation, line[j]);
+            header.maxElevation = MAX(header.maxElevation, line[j]);
+        }
+        if (fwrite(line, sizeof(short), header.lineStride, fp)
+                != (size_t)header.lineStride) {
+            ERROR_ReportError("Cannot write terrain tile");
+        }
+    }
+    MEM_free(line);
+
+    fseek(fp, 0, SEEK_SET);
+    if (fwrite(&header, sizeof(header), 1, fp) != 1) {
+        ERROR_ReportError("Cannot write terrain tile");
+    }
+    fclose(fp);
+
+#ifdef _WIN32
+    remove(fileName.c_str());
+#endif
+    if (rename(tempFileName, fileName.c_str()) != 0) {
+        ERROR_ReportError("Cannot rename terrain tile");
+    }
+
+    addTileFromHeader(fileName, header);
+}
+
+TerrainTileStore::CellKey TerrainTileStore::getCell(double latitude,
+                                                    double longitude)
+{
+    return CellKey((int)floor(latitude / m_cellLatitude),
+                   (int)floor(longitude / m_cellLongitude));
+}
+
+void TerrainTileStore::buildIndex()
+{
+    double minLatitude = 0.0;
+    double minLongitude = 0.0;
+    double maxLatitude = 0.0;
+    double maxLongitude = 0.0;
+    UInt32 i;
+
+    for (i = 0; i < m_tiles.size(); i++) {
+        const Tile& tile = m_tiles[i];
+        double latitude = tile.northEastCorner.latlonalt.latitude
+                          - tile.southWestCorner.latlonalt.latitude;
+        double longitude = tile.northEastCorner.latlonalt.longitude
+                           - tile.southWestCorner.latlonalt.longitude;
+
+        if (longitude < 0.0) {
+            longitude += 360.0;
+        }
+        if (i == 0 || latitude < minLatitude) {
+            minLatitude = latitude;
+        }
+        if (i == 0 || longitude < minLongitude) {
+            minLongitude = longitude;
+        }
+        maxLatitude = MAX(maxLatitude, latitude);
+        maxLongitude = MAX(maxLongitude, longitude);
+    }
+
+    m_cellLatitude = MAX(minLatitude,
+                         maxLatitude / TERRAIN_TILE_MAX_CELLS_PER_TILE_SIDE);
+    m_cellLongitude = MAX(minLongitude,
+                          maxLongitude / TERRAIN_TILE_MAX_CELLS_PER_TILE_SIDE);
+    if (m_cellLatitude <= 0.0) {
+        m_cellLatitude = 1.0;
+    }
+    if (m_cellLongitude <= 0.0) {
+        m_cellLongitude = 1.0;
+    }
+
+    m_cells.clear();
+    for (i = 0; i < m_tiles.size(); i++) {
+        const Tile& tile = m_tiles[i];
+        CellKey sw = getCell(tile.southWestCorner.latlonalt.latitude,
+                             tile.southWestCorner.latlonalt.longitude);
+        CellKey ne = getCell(tile.northEastCorner.latlonalt.latitude,
+                             tile.northEastCorner.latlonalt.longitude);
+        CellKey east = getCell(0.0, 180.0);
+        CellKey west = getCell(0.0, -180.0);
+
+        for (int lat = sw.first; lat <= ne.first; lat++) {
+            if (sw.second <= ne.second) {
+                for (int lon = sw.second; lon <= ne.second; lon++) {
+                    m_cells[CellKey(lat, lon)].push_back(i);
+                }
+            }
+            else {
+                // crosses the dateline
+                for (int lon = sw.second; lon <= east.second; lon++) {
+                    m_cells[CellKey(lat, lon)].push_back(i);
+                }
+                for (int lon = west.second; lon <= ne.second; lon++) {
+                    m_cells[CellKey(lat, lon)].push_back(i);
+                }
+            }
+        }
+    }
+}
+
+UInt32 TerrainTileStore::findTile(const Coordinates* point)
+{
+    // m_recentTiles is shared by all threads; entries are only hints and
+    // are checked before use
+    UInt32 recent[TERRAIN_TILE_RECENT_CACHE_SIZE];
+    UInt32 bestTile = TERRAIN_TILE_NO_MATCH_FOUND;
+    int i;
+
+    memcpy(recent, m_recentTiles, sizeof(recent));
+
+    for (i = 0; i < TERRAIN_TILE_RECENT_CACHE_SIZE; i++) {
+        if (recent[i] < m_tiles.size() &&
+            COORD_PointWithinRange(m_terrainData->getCoordinateSystem(),
+                                   &m_tiles[recent[i]].southWestCorner,
+                                   &m_tiles[recent[i]].northEastCorner,
+                                   point)) {
+            return recent[i];
+        }
+    }
+
+    std::map<CellKey, std::vector<UInt32> >::iterator cell =
+        m_cells.find(getCell(point->latlonalt.latitude,
+                             point->latlonalt.longitude));
+
+    if (cell == m_cells.end()) {
+        return TERRAIN_TILE_NO_MATCH_FOUND;
+    }
+
+    std::vector<UInt32>& candidates = cell->second;
+
+    for (UInt32 j = 0; j < candidates.size(); j++) {
+        const Tile& tile = m_tiles[candidates[j]];
+
+        if (!COORD_PointWithinRange(m_terrainData->getCoordinateSystem(),
+                                    &tile.southWestCorner,
+                                    &tile.northEastCorner,
+                                    point)) {
+            continue;
+        }
+        if (bestTile == TERRAIN_TILE_NO_MATCH_FOUND) {
+            bestTile = candidates[j];
+            if (!m_preferFinerResolution) {
+                break;
+            }
+        }
+        else if (m_tiles[bestTile].resolution[0] > tile.resolution[0] &&
+                 m_tiles[bestTile].resolution[1] > tile.resolution[1]) {
+            bestTile = candidates[j];
+        }
+    }
+
+    if (bestTile != TERRAIN_TILE_NO_MATCH_FOUND) {
+        for (i = TERRAIN_TILE_RECENT_CACHE_SIZE - 1; i > 0; i--) {
+            recent[i] = recent[i - 1];
+        }
+        recent[0] = bestTile;
+        memcpy(m_recentTiles, recent, sizeof(recent));
+    }
+
+    return bestTile;
+}
+
+void TerrainTileStore::mapTile(Tile* tile)
+{
+    size_t size = tile->dataOffset
+                  + (size_t)tile->numLines * tile->lineStride * sizeof(short);
+    char errorMessage[MAX_STRING_LENGTH];
+
+    sprintf(errorMessage, "Cannot map terrain tile %s",
+            tile->fileName.c_str());
+
+#ifdef _WIN32
+    HANDLE file = CreateFile(tile->fileName.c_str(),
+                             GENERIC_READ,
+                             FILE_SHARE_READ,
+                             NULL,
+                             OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL,
+                             NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        ERROR_ReportError(errorMessage);
+    }
+
+    HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        ERROR_ReportError(errorMessage);
+    }
+
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    if (address == NULL) {
+        ERROR_ReportError(errorMessage);
+    }
+#else
+    int fd = open(tile->fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        ERROR_ReportError(errorMessage);
+    }
+
+    void* address = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        ERROR_ReportError(errorMessage);
+    }
+#endif
+
+    tile->mapping = address;
+    tile->mappingSize = size;
+    tile->data = (const short*)((char*)address + tile->dataOffset);
+}
+
+void TerrainTileStore::unmapTile(Tile* tile)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(tile->mapping);
+#else
+    munmap(tile->mapping, tile->mappingSize);
+#endif
+    tile->mapping = NULL;
+    tile->mappingSize = 0;
+    tile->data = NULL;
+}
+
+// Maps the tile if needed and keeps it mapped until unpinTile
+const short* TerrainTileStore::pinTile(UInt32 index)
+{
+    Tile* tile = &m_tiles[index];
+    const short* data;
+
+    pthread_mutex_lock(&m_mutex);
+
+    if (tile->data == NULL) {
+        mapTile(tile);
+        m_numMapped++;
+    }
+    else {
+        m_lru.erase(tile->lruPosition);
+    }
+    m_lru.push_front(index);
+    tile->lruPosition = m_lru.begin();
+    tile->pinCount++;
+    data = tile->data;
+
+    // unmap the least recently used tiles that are not in use
+    std::list<UInt32>::iterator it = m_lru.end();
+    while (m_numMapped > m_cacheSize && it != m_lru.begin()) {
+        --it;
+        Tile* oldTile = &m_tiles[*it];
+
+        if (oldTile->pinCount == 0) {
+            unmapTile(oldTile);
+            it = m_lru.erase(it);
+            m_numMapped--;
+        }
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+
+    return data;
+}
+
+void TerrainTileStore::unpinTile(UInt32 index)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_tiles[index].pinCount--;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool TerrainTileStore::getElevationAt(const Coordinates* point,
+                                      double* elevation)
+{
+    UInt32 index = findTile(point);
+
+    if (index == TERRAIN_TILE_NO_MATCH_FOUND) {
+        return false;
+    }
+
+    const Tile& tile = m_tiles[index];
+    const short* data = pinTile(index);
+
+    // same interpolation as DtedTerrainData::getElevationAt
+    double normalizedLongitude =
+        ARC_SECONDS * (point->latlonalt.longitude -
+         tile.southWestCorner.latlonalt.longitude) / tile.resolution[0];
+    double normalizedLatitude =
+        ARC_SECONDS * (point->latlonalt.latitude -
+         tile.southWestCorner.latlonalt.latitude) / tile.resolution[1];
+
+    int northWestLatitude = (int) ceil(normalizedLatitude);
+    int northWestLongitude = (int) floor(normalizedLongitude);
+
+    double dLatitude = northWestLatitude - normalizedLatitude;
+    double dLongitude = normalizedLongitude - northWestLongitude;
+
+    assert(dLatitude >= 0.0 && dLatitude < 1.0);
+    assert(dLongitude >= 0.0 && dLongitude < 1.0);
+    assert(northWestLongitude >= 0 &&
+           northWestLongitude < tile.numLines);
+    assert(northWestLatitude >= 0 &&
+           northWestLatitude < tile.numPosts);
+
+    const short* line = data + (size_t)northWestLongitude * tile.lineStride;
+    const short* nextLine = line + tile.lineStride;
+    short northWestElevation = line[northWestLatitude];
+    short northEastElevation;
+    short southWestElevation;
+    short southEastElevation;
+
+    if (northWestLongitude < tile.numLines - 1 && northWestLatitude > 0) {
+        southEastElevation = nextLine[northWestLatitude - 1];
+    }
+    else {
+        assert(dLatitude == 0.0 || dLongitude == 0.0);
+        southEastElevation = 0;
+    }
+
+    if (dLatitude > dLongitude) {
+        southWestElevation = line[northWestLatitude - 1];
+
+        *elevation =
+            northWestElevation +
+            (southEastElevation - southWestElevation) * dLongitude +
+            (southWestElevation - northWestElevation) * dLatitude;
+    }
+    else {
+        if (northWestLongitude == tile.numLines - 1) {
+            northEastElevation = line[northWestLatitude];
+        }
+        else {
+            northEastElevation = nextLine[northWestLatitude];
+        }
+
+        *elevation =
+            northWestElevation +
+            (northEastElevation - northWestElevation) * dLongitude +
+            (southEastElevation - northEastElevation) * dLatitude;
+    }
+
+    unpinTile(index);
+
+    return true;
+}
+
+void TerrainTileStore::getHighestAndLowestForTile(UInt32 index,
+                                                  const Coordinates* sw,
+                                                  const Coordinates* ne,
+                                                  double* highest,
+                                                  double* lowest)
+{
+    const Tile& tile = m_tiles[index];
+    CoordinateType north, south, east, west;
+
+    north = MIN(ne->latlonalt.latitude,
+                tile.northEastCorner.latlonalt.latitude);
+    south = MAX(sw->latlonalt.latitude,
+                tile.southWestCorner.latlonalt.latitude);
+    east  = MIN(ne->latlonalt.longitude,
+                tile.northEastCorner.latlonalt.longitude);
+    west  = MAX(sw->latlonalt.longitude,
+                tile.southWestCorner.latlonalt.longitude);
+
+    // the whole tile: use the range computed at conversion
+    if (north == tile.northEastCorner.latlonalt.latitude &&
+        south == tile.southWestCorner.latlonalt.latitude &&
+        east == tile.northEastCorner.latlonalt.longitude &&
+        west == tile.southWestCorner.latlonalt.longitude) {
+        *highest = MAX(*highest, tile.maxElevation);
+        *lowest  = MIN(*lowest, tile.minElevation);
+        return;
+    }
+
+    int southIndex = (int) floor(ARC_SECONDS *
+        (south - tile.southWestCorner.latlonalt.latitude)
+        / tile.resolution[1]);
+    int northIndex = (int) ceil(ARC_SECONDS *
+        (north - tile.southWestCorner.latlonalt.latitude)
+        / tile.resolution[1]);
+    int westIndex = (int) floor(ARC_SECONDS *
+        (west - tile.southWestCorner.latlonalt.longitude)
+        / tile.resolution[0]);
+    int eastIndex = (int) ceil(ARC_SECONDS *
+        (east - tile.southWestCorner.latlonalt.longitude)
+        / tile.resolution[0]);
+
+    southIndex = MAX(southIndex, 0);
+    westIndex  = MAX(westIndex, 0);
+    northIndex = MIN(northIndex, tile.numPosts - 1);
+    eastIndex  = MIN(eastIndex, tile.numLines - 1);
+
+    const short* data = pinTile(index);
+
+    for (int lon = westIndex; lon <= eastIndex; lon++) {
+        const short* line = data + (size_t)lon * tile.lineStride;
+
+        for (int lat = southIndex; lat <= northIndex; lat++) {
+            *highest = MAX(*highest, line[lat]);
+            *lowest  = MIN(*lowest, line[lat]);
+        }
+    }
+
+    unpinTile(index);
+}
+
+void TerrainTileStore::getHighestAndLowestElevation(const Coordinates* sw,
+                                                    const Coordinates* ne,
+                                                    double* highest,
+                                                    double* lowest)
+{
+    bool foundOverlap = false;
+
+    *highest = -99999.9;
+    *lowest  = 99999.9;
+
+    for (UInt32 i = 0; i < m_tiles.size(); i++) {
+        if (COORD_RegionsOverlap(m_terrainData->getCoordinateSystem(),
+                                 sw, ne,
+                                 &m_tiles[i].southWestCorner,
+                                 &m_tiles[i].northEastCorner)) {
+            foundOverlap = true;
+            getHighestAndLowestForTile(i, sw, ne, highest, lowest);
+        }
+    }
+
+    if (!foundOverlap) {
+        *highest = 0.0;
+        *lowest  = 0.0;
+    }
+}
@@ -0,0 +1,184 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#ifndef TERRAIN_TILE_STORE_H
+#define TERRAIN_TILE_STORE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include "pthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "terrain.h"
+
+//
+// Tile store shared by the DTED and DEM elevation models, enabled by
+// TERRAIN-TILE-CACHE-DIRECTORY.
+//
+// Every elevation file is converted once into a tile file in the cache
+// directory: a TerrainTileHeader followed, at a page aligned offset, by
+// the elevation posts as shorts in native byte order.  Posts are stored
+// by longitude line, each line padded to a multiple of 64 bytes.  A tile
+// file is reused as long as the size and modification time of its
+// source file do not change.
+//
+// Only the headers are read at startup.  A tile is memory mapped the
+// first time an elevation in it is needed, and the least recently used
+// tiles are unmapped once more than TERRAIN-TILE-CACHE-SIZE tiles are
+// mapped.
+//
+
+#define TERRAIN_TILE_MAGIC              0x454c4954
+#define TERRAIN_TILE_VERSION            1
+#define TERRAIN_TILE_DATA_ALIGNMENT     4096
+#define TERRAIN_TILE_LINE_ALIGNMENT     64
+#define TERRAIN_TILE_DEFAULT_CACHE_SIZE 64
+#define TERRAIN_TILE_RECENT_CACHE_SIZE  4
+#define TERRAIN_TILE_NO_MATCH_FOUND     0xffffffff
+
+struct TerrainTileHeader {
+    UInt32 magic;
+    UInt32 version;
+    UInt64 sourceSize;
+    Int64  sourceModified;
+    double southWestLatitude;
+    double southWestLongitude;
+    double northEastLatitude;
+    double northEastLongitude;
+    double resolution[2];   // arc seconds, as in the source file
+    Int32  numLines;        // longitude lines
+    Int32  numPosts;        // posts per longitude line
+    Int32  lineStride;      // shorts from one line to the next
+    Int16  minElevation;
+    Int16  maxElevation;
+    UInt32 dataOffset;
+};
+
+// Returns the elevation post of an elevation file being converted
+typedef short (*TerrainTilePostFunction)(const void* source,
+                                         int line,
+                                         int post);
+
+class TerrainTileStore {
+private:
+    struct Tile {
+        std::string fileName;
+        Coordinates southWestCorner;
+        Coordinates northEastCorner;
+        double      resolution[2];
+        int         numLines;
+        int         numPosts;
+        int         lineStride;
+        short       minElevation;
+        short       maxElevation;
+        UInt32      dataOffset;
+
+        // mapped data, NULL while the tile is not mapped
+        const short* data;
+        void*        mapping;
+        size_t       mappingSize;
+        int          pinCount;
+        std::list<UInt32>::iterator lruPosition;
+    };
+
+    typedef std::pair<int, int> CellKey;
+
+    TerrainData*        m_terrainData;
+    std::string         m_directory;
+    UInt32              m_cacheSize;
+    bool                m_preferFinerResolution;
+
+    std::vector<Tile>   m_tiles;
+
+    // spatial index: tiles overlapping each cell of a latitude/longitude
+    // grid, in configuration order
+    double m_cellLatitude;
+    double m_cellLongitude;
+    std::map<CellKey, std::vector<UInt32> > m_cells;
+
+    // tiles of the last lookups, most recent first
+    UInt32 m_recentTiles[TERRAIN_TILE_RECENT_CACHE_SIZE];
+
+    // mapped tiles, most recently used first
+    std::list<UInt32> m_lru;
+    UInt32            m_numMapped;
+    pthread_mutex_t   m_mutex;
+
+    std::string getTileFileName(const char* sourceFileName);
+    CellKey     getCell(double latitude, double longitude);
+    UInt32      findTile(const Coordinates* point);
+
+    const short* pinTile(UInt32 index);
+    void         unpinTile(UInt32 index);
+    void         mapTile(Tile* tile);
+    void         unmapTile(Tile* tile);
+    void         addTileFromHeader(const std::string& fileName,
+                                   const TerrainTileHeader& header);
+
+    void getHighestAndLowestForTile(UInt32 index,
+                                    const Coordinates* sw,
+                                    const Coordinates* ne,
+                                    double* highest,
+                                    double* lowest);
+
+public:
+    TerrainTileStore(TerrainData* td,
+                     const char* directory,
+                     UInt32 cacheSize,
+                     bool preferFinerResolution);
+    ~TerrainTileStore();
+
+    // Returns a store if TERRAIN-TILE-CACHE-DIRECTORY is configured,
+    // NULL otherwise
+    static TerrainTileStore* create(TerrainData* td,
+                                    NodeInput* nodeInput,
+                                    bool preferFinerResolution);
+
+    // Adds the tile converted from sourceFileName.  Returns false if
+    // there is no up to date tile file, in which case the caller reads
+    // the source file and calls addTile.
+    bool addConvertedTile(const char* sourceFileName);
+    void addTile(const char* sourceFileName,
+                 const Coordinates* southWestCorner,
+                 const Coordinates* northEastCorner,
+                 const double resolution[2],
+                 int numLines,
+                 int numPosts,
+                 TerrainTilePostFunction getPost,
+                 const void* source);
+
+    // Called once all the tiles are added
+    void buildIndex();
+
+    UInt32 getNumTiles() { return (UInt32)m_tiles.size(); }
+
+    // Returns false if no tile contains the point
+    bool getElevationAt(const Coordinates* point, double* elevation);
+
+    void getHighestAndLowestElevation(const Coordinates* sw,
+                                      const Coordinates* ne,
+                                      double* highest,
+                                      double* lowest);
+};
+
+#endif
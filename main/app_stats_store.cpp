@@ -0,0 +1,92 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+
+#include "api.h"
+#include "app_stats_store.h"
+
+APPStatsStore g_APPStatsStore("AppData.txt");
+
+APPStatsStore::APPStatsStore(const char* fileName)
+    : m_listener(NULL),
+      m_fileName(fileName),
+      m_isOpen(false),
+      m_isClosed(false)
+{
+}
+
+APPStatsStore::~APPStatsStore()
+{
+    Close();
+}
+
+void APPStatsStore::Add(const APPStatsNew& stats)
+{
+    if (m_listener != NULL)
+    {
+        m_listener(stats);
+    }
+
+    WriteRecord(stats);
+}
+
+void APPStatsStore::OpenFile()
+{
+    if (!m_isOpen && !m_isClosed)
+    {
+        m_file.open(m_fileName.c_str());
+        m_isOpen = true;
+    }
+}
+
+void APPStatsStore::WriteRecord(const APPStatsNew& stats)
+{
+    OpenFile();
+    if (!m_isOpen)
+    {
+        return;
+    }
+
+    char fchar[128] = { 0 };
+
+    sprintf(fchar, "%.4f", stats.AppThroughput);
+
+    m_file << stats.simTime << ','
+        << stats.SrcId << ','
+        << stats.DestId << ','
+        << stats.Servicetype << ','
+        << stats.AppDelay << ','
+        << stats.AppJet << ','
+        << fchar << ','
+        << stats.MessageSent << ','
+        << stats.MessageRcv << ','
+        << stats.AppPacketLoss << ','
+        << stats.dataSent
+        << '\n';
+}
+
+void APPStatsStore::Close()
+{
+    OpenFile();
+    if (m_isOpen)
+    {
+        m_file.close();
+        m_isOpen = false;
+    }
+    m_isClosed = true;
+}
@@ -362,7 +362,7 @@ static void ProcessMobilityEvent(Node* node, Message* msg)
     Message* newMsg = MESSAGE_Duplicate(node, msg);
 
     EXTERNAL_MobilityEvent* newMobilityEvent
-        = (EXTERNAL_MobilityEvent*) MESSAGE_ReturnInfo(newMsg);
+        = (EXTERNAL_MobilityEvent*) MESSAGE_ReturnWritableInfo(node, newMsg);
 
     newMobilityEvent->isTruePosition = FALSE;
     newMobilityEvent->velocityOnly = FALSE;
@@ -33,6 +33,11 @@ typedef int socklen_t;
 #include <unistd.h>
 #endif
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
 #include <assert.h>
 #include <stdio.h>
 #include <fcntl.h>
@@ -132,6 +137,17 @@ void EXTERNAL_Sleep(clocktype c)
 // The default socket option size to get
 #define DEFAULT_OPT_SIZE 512
 
+// The minimum free space made in a VarArray before each recv by
+// EXTERNAL_SocketRecvAvailable
+#define RECV_AVAILABLE_CHUNK_SIZE 65536
+
+// The epoll data of the wakeup eventfd of a poller.  Socket ids are stored
+// as 32 bit values so they never match it.
+#define EXTERNAL_POLLER_WAKEUP_ID ((uint64_t) -1)
+
+// The maximum number of events returned by one EXTERNAL_SocketPollerWait
+#define EXTERNAL_POLLER_MAX_EVENTS 64
+
 // #define DEBUG
 
 // #define DEBUG_THREADED_SOCKET 1
@@ -219,6 +235,27 @@ static EXTERNAL_SocketErrorType SetNonBlocking(SocHandle fd)
     return EXTERNAL_NoSocketError;
 }
 
+#ifndef NO_SOCKET_THREADING
+// /**
+// API       :: EXTERNAL_SocketNotify
+// PURPOSE   :: Wake up the thread polling a threaded socket, if any
+// PARAMETERS::
+// + s : EXTERNAL_Socket* : Pointer to the socket
+// RETURN    :: void : None
+// **/
+static void EXTERNAL_SocketNotify(EXTERNAL_Socket *s)
+{
+#ifdef __linux__
+    int fd = s->notifyFd;
+
+    if (fd >= 0)
+    {
+        eventfd_write(fd, 1);
+    }
+#endif /* __linux__ */
+}
+#endif /* NO_SOCKET_THREADING */
+
 //---------------------------------------------------------------------------
 // Functions
 //---------------------------------------------------------------------------
@@ -384,6 +421,8 @@ void EXTERNAL_SocketInit(
         pthread_cond_init(s->sendNotFull, NULL);
         s->sendNotEmpty = new pthread_cond_t;
         pthread_cond_init(s->sendNotEmpty, NULL);
+
+        s->notifyFd = -1;
 #else
         // Cannot use threading when NO_SOCKET_THREADING is defined
         assert(0);
@@ -399,6 +438,7 @@ void EXTERNAL_SocketInit(
         s->mutex = NULL;
         s->notFull = NULL;
         s->notEmpty = NULL;
+        s->notifyFd = -1;
 #endif /* NO_SOCKET_THREADING */
     }
 }
@@ -665,6 +705,7 @@ void* EXTERNAL_SocketReceiverThread(void *voidSocket)
 #endif
         {
             s->error = true;
+            EXTERNAL_SocketNotify(s);
         }
         else
         {
@@ -719,6 +760,7 @@ void* EXTERNAL_SocketReceiverThread(void *voidSocket)
                 pthread_mutex_unlock(s->mutex);
                 pthread_cond_signal(s->notEmpty);
             }
+            EXTERNAL_SocketNotify(s);
         }
     }
 
@@ -1451,6 +1493,111 @@ EXTERNAL_SocketErrorType EXTERNAL_SocketRecv(
     }
 }
 
+EXTERNAL_SocketErrorType EXTERNAL_SocketRecvAvailable(
+    EXTERNAL_Socket *s,
+    EXTERNAL_VarArray *data,
+    unsigned int *receiveSize)
+{
+    int receivedSize;
+
+    *receiveSize = 0;
+
+    if (s->threaded)
+    {
+#ifndef NO_SOCKET_THREADING
+        unsigned int size;
+        unsigned int first;
+
+        // Move everything in the circular buffer at once
+        pthread_mutex_lock(s->mutex);
+        size = (unsigned int) s->size;
+        if (size > 0)
+        {
+            EXTERNAL_VarArrayAccomodateSize(data, data->size + size);
+
+            first = MIN(size, (unsigned int) (THREADED_BUFFER_SIZE - s->head));
+            memcpy(data->data + data->size, (char*) s->buffer + s->head, first);
+            memcpy(data->data + data->size + first, (char*) s->buffer, size - first);
+            data->size += size;
+
+            s->head = (s->head + size) % THREADED_BUFFER_SIZE;
+            s->size = 0;
+        }
+        pthread_mutex_unlock(s->mutex);
+
+        if (size > 0)
+        {
+            pthread_cond_signal(s->notFull);
+        }
+        *receiveSize = size;
+
+        // Report the error once the data received before it is consumed
+        if (size == 0 && s->error)
+        {
+            return EXTERNAL_SocketError;
+        }
+#endif /* NO_SOCKET_THREADING */
+        return EXTERNAL_NoSocketError;
+    }
+
+    if (!EXTERNAL_SocketValid(s))
+    {
+        return EXTERNAL_InvalidSocket;
+    }
+
+    // Read until the socket has no more data
+    for (;;)
+    {
+        EXTERNAL_VarArrayAccomodateSize(
+            data,
+            data->size + RECV_AVAILABLE_CHUNK_SIZE);
+
+        receivedSize = recv(s->socketFd,
+                            data->data + data->size,
+                            data->maxSize - data->size,
+                            0);
+        if (receivedSize == 0)
+        {
+            // EOF
+            return EXTERNAL_SocketError;
+        }
+#ifdef _WIN32
+        else if (receivedSize == SOCKET_ERROR)
+        {
+            if (WSAGetLastError() == WSAEWOULDBLOCK)
+            {
+                break;
+            }
+            ERROR_ReportWarningArgs("Error receiving data, err = %d",
+                WSAGetLastError());
+            return EXTERNAL_SocketError;
+        }
+#else /* unix/linux */
+        else if (receivedSize == -1)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ERROR_ReportWarningArgs("Error receiving data, err = %s",
+                strerror(errno));
+            return EXTERNAL_SocketError;
+        }
+#endif
+        else
+        {
+            data->size += receivedSize;
+            *receiveSize += receivedSize;
+        }
+    }
+
+    return EXTERNAL_NoSocketError;
+}
+
 EXTERNAL_SocketErrorType EXTERNAL_SocketRecvFrom(
     EXTERNAL_Socket *s,
     char *data,
@@ -1666,3 +1813,156 @@ EXTERNAL_SocketErrorType EXTERNAL_SocketClose(EXTERNAL_Socket *s)
 
     return EXTERNAL_NoSocketError;
 }
+
+#ifdef __linux__
+EXTERNAL_SocketErrorType EXTERNAL_SocketPollerInit(
+    EXTERNAL_SocketPoller *poller)
+{
+    struct epoll_event event;
+
+    poller->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (poller->epollFd == -1)
+    {
+        ERROR_ReportWarningArgs("Error calling epoll_create1, err = %s",
+            strerror(errno));
+        poller->wakeFd = -1;
+        return EXTERNAL_SocketError;
+    }
+
+    poller->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (poller->wakeFd == -1)
+    {
+        ERROR_ReportWarningArgs("Error calling eventfd, err = %s",
+            strerror(errno));
+        EXTERNAL_SocketPollerClose(poller);
+        return EXTERNAL_SocketError;
+    }
+
+    // The wakeup descriptor is level triggered so that a wakeup is never
+    // lost; it is reset in EXTERNAL_SocketPollerWait
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = EXTERNAL_POLLER_WAKEUP_ID;
+    if (epoll_ctl(poller->epollFd, EPOLL_CTL_ADD, poller->wakeFd, &event)
+        == -1)
+    {
+        ERROR_ReportWarningArgs("Error calling epoll_ctl, err = %s",
+            strerror(errno));
+        EXTERNAL_SocketPollerClose(poller);
+        return EXTERNAL_SocketError;
+    }
+
+    return EXTERNAL_NoSocketError;
+}
+
+EXTERNAL_SocketErrorType EXTERNAL_SocketPollerAdd(
+    EXTERNAL_SocketPoller *poller,
+    EXTERNAL_Socket *s,
+    int id,
+    bool edgeTriggered)
+{
+    struct epoll_event event;
+
+    if (!EXTERNAL_SocketValid(s))
+    {
+        return EXTERNAL_InvalidSocket;
+    }
+
+#ifndef NO_SOCKET_THREADING
+    if (s->threaded)
+    {
+        s->notifyFd = poller->wakeFd;
+        return EXTERNAL_NoSocketError;
+    }
+#endif /* NO_SOCKET_THREADING */
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLRDHUP;
+    if (edgeTriggered)
+    {
+        event.events |= EPOLLET;
+    }
+    event.data.u64 = (uint32_t) id;
+    if (epoll_ctl(poller->epollFd, EPOLL_CTL_ADD, s->socketFd, &event) == -1)
+    {
+        ERROR_ReportWarningArgs("Error calling epoll_ctl, err = %s",
+            strerror(errno));
+        return EXTERNAL_SocketError;
+    }
+
+    return EXTERNAL_NoSocketError;
+}
+
+int EXTERNAL_SocketPollerWait(
+    EXTERNAL_SocketPoller *poller,
+    EXTERNAL_SocketEvent *events,
+    int maxEvents,
+    int timeout)
+{
+    struct epoll_event epollEvents[EXTERNAL_POLLER_MAX_EVENTS];
+    int numEvents;
+    int i;
+
+    numEvents = epoll_wait(poller->epollFd,
+                           epollEvents,
+                           MIN(maxEvents, EXTERNAL_POLLER_MAX_EVENTS),
+                           timeout);
+    if (numEvents == -1)
+    {
+        if (errno == EINTR)
+        {
+            return 0;
+        }
+        ERROR_ReportWarningArgs("Error calling epoll_wait, err = %s",
+            strerror(errno));
+        return -1;
+    }
+
+    for (i = 0; i < numEvents; i++)
+    {
+        if (epollEvents[i].data.u64 == EXTERNAL_POLLER_WAKEUP_ID)
+        {
+            eventfd_t count;
+
+            eventfd_read(poller->wakeFd, &count);
+            events[i].wakeup = true;
+            events[i].id = -1;
+            events[i].readable = false;
+            events[i].closed = false;
+        }
+        else
+        {
+            events[i].wakeup = false;
+            events[i].id = (int) (uint32_t) epollEvents[i].data.u64;
+            events[i].readable = (epollEvents[i].events & EPOLLIN) != 0;
+            events[i].closed =
+                (epollEvents[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                != 0;
+        }
+    }
+
+    return numEvents;
+}
+
+void EXTERNAL_SocketPollerWake(EXTERNAL_SocketPoller *poller)
+{
+    if (poller->wakeFd >= 0)
+    {
+        eventfd_write(poller->wakeFd, 1);
+    }
+}
+
+void EXTERNAL_SocketPollerClose(EXTERNAL_SocketPoller *poller)
+{
+    if (poller->wakeFd >= 0)
+    {
+        close(poller->wakeFd);
+        poller->wakeFd = -1;
+    }
+    if (poller->epollFd >= 0)
+    {
+        close(poller->epollFd);
+        poller->epollFd = -1;
+    }
+}
+#endif /* __linux__ */
@@ -0,0 +1,369 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include "pthread.h"
+#else
+#include <pthread.h>
+#endif
+
+#include "api.h"
+#include "WallClock.h"
+#include "fileio_index.h"
+
+// Lines of one parameter name, in configuration order
+struct IoIndexEntry
+{
+    std::string name;
+    int         firstLine;   // in s_indexLines
+    int         numLines;
+};
+
+struct IoIndexStatistics
+{
+    UInt64    numReads;
+    UInt64    numLinesRead;
+    clocktype readTime;
+};
+
+// Lines are indexed by upper case parameter name without any [N]
+// instance suffix, so that a view never misses a line the IO_Read...()
+// APIs could match.
+static const NodeInput*          s_indexedInput = NULL;
+static int                       s_indexedNumLines = 0;
+static std::vector<IoIndexEntry> s_indexEntries;   // sorted by name
+static std::vector<int>          s_indexLines;
+
+// The IO_Read...() APIs look up the ROUTER-MODEL of the node before
+// searching the router models, so its lines are part of every view when
+// router models are configured.
+static std::vector<int>          s_routerModelLines;
+
+static BOOL                      s_keepStatistics = FALSE;
+static pthread_mutex_t           s_statisticsMutex;
+static std::map<std::string, IoIndexStatistics> s_statistics;
+
+// Copies the upper case parameter name without instance suffix to key.
+// Returns FALSE if the name does not fit.
+static BOOL IoIndexGetKey(const char* name, char* key)
+{
+    int i;
+
+    for (i = 0; name[i] != '\0' && name[i] != '['; i++)
+    {
+        if (i == MAX_STRING_LENGTH - 1)
+        {
+            return FALSE;
+        }
+        key[i] = (char) toupper((unsigned char) name[i]);
+    }
+    key[i] = '\0';
+
+    return TRUE;
+}
+
+static bool IoIndexEntryLess(const IoIndexEntry& entry, const char* key)
+{
+    return strcmp(entry.name.c_str(), key) < 0;
+}
+
+static const IoIndexEntry* IoIndexFind(const char* key)
+{
+    std::vector<IoIndexEntry>::const_iterator it =
+        std::lower_bound(s_indexEntries.begin(),
+                         s_indexEntries.end(),
+                         key,
+                         IoIndexEntryLess);
+
+    if (it == s_indexEntries.end() || strcmp(it->name.c_str(), key) != 0)
+    {
+        return NULL;
+    }
+    return &(*it);
+}
+
+static bool IoIndexLineLess(const std::pair<std::string, int>& a,
+                            const std::pair<std::string, int>& b)
+{
+    return a.first < b.first;
+}
+
+void
+IO_BuildNodeInputIndex(NodeInput* nodeInput)
+{
+    std::vector<std::pair<std::string, int> > lines;
+    char key[MAX_STRING_LENGTH];
+    BOOL wasFound;
+    BOOL keepStatistics = FALSE;
+    int i;
+
+    IO_ReadBool(ANY_NODEID,
+                ANY_ADDRESS,
+                nodeInput,
+                "PARAMETER-READ-STATISTICS",
+                &wasFound,
+                &keepStatistics);
+
+    for (i = 0; i < nodeInput->numLines; i++)
+    {
+        if (nodeInput->variableNames[i] == NULL)
+        {
+            continue;
+        }
+        if (!IoIndexGetKey(nodeInput->variableNames[i], key))
+        {
+            // Cannot be indexed, so reads search the whole configuration
+            return;
+        }
+        lines.push_back(std::pair<std::string, int>(key, i));
+    }
+
+    // Stable, so the lines of a name stay in configuration order
+    std::stable_sort(lines.begin(), lines.end(), IoIndexLineLess);
+
+    s_indexEntries.clear();
+    s_indexLines.clear();
+    s_indexLines.reserve(lines.size());
+    for (i = 0; i < (int) lines.size(); i++)
+    {
+        if (i == 0 || lines[i].first != lines[i - 1].first)
+        {
+            IoIndexEntry entry;
+
+            entry.name = lines[i].first;
+            entry.firstLine = i;
+            entry.numLines = 0;
+            s_indexEntries.push_back(entry);
+        }
+        s_indexEntries.back().numLines++;
+        s_indexLines.push_back(lines[i].second);
+    }
+
+    s_routerModelLines.clear();
+    if (nodeInput->routerModelInput != NULL
+        && nodeInput->routerModelInput->numLines > 0)
+    {
+        const IoIndexEntry* entry = IoIndexFind("ROUTER-MODEL");
+
+        if (entry != NULL)
+        {
+            s_routerModelLines.assign(
+                s_indexLines.begin() + entry->firstLine,
+                s_indexLines.begin() + entry->firstLine + entry->numLines);
+        }
+    }
+
+    if (keepStatistics && !s_keepStatistics)
+    {
+        pthread_mutex_init(&s_statisticsMutex, NULL);
+        s_keepStatistics = TRUE;
+    }
+
+    s_indexedInput = nodeInput;
+    s_indexedNumLines = nodeInput->numLines;
+}
+
+void NodeInputView::allocateLines(int numLines)
+{
+    if (numLines <= IO_INDEX_VIEW_INLINE_LINES)
+    {
+        m_view.inputStrings = m_inputStrings;
+        m_view.timeQualifiers = m_timeQualifiers;
+        m_view.qualifiers = m_qualifiers;
+        m_view.variableNames = m_variableNames;
+        m_view.instanceIds = m_instanceIds;
+        m_view.values = m_values;
+        return;
+    }
+
+    m_view.inputStrings = (char**) MEM_malloc(numLines * sizeof(char*));
+    m_view.timeQualifiers = (char**) MEM_malloc(numLines * sizeof(char*));
+    m_view.qualifiers = (char**) MEM_malloc(numLines * sizeof(char*));
+    m_view.variableNames = (char**) MEM_malloc(numLines * sizeof(char*));
+    m_view.instanceIds = (int*) MEM_malloc(numLines * sizeof(int));
+    m_view.values = (char**) MEM_malloc(numLines * sizeof(char*));
+}
+
+NodeInputView::NodeInputView(
+    const NodeInput* nodeInput,
+    const char* parameterName)
+: m_nodeInput(nodeInput), m_parameterName(NULL), m_start(0)
+{
+    char key[MAX_STRING_LENGTH];
+    const IoIndexEntry* entry;
+    const int* lines = NULL;
+    int numLines = 0;
+    int numRouterModelLines = (int) s_routerModelLines.size();
+    int i = 0;
+    int j = 0;
+    int n = 0;
+
+    if (nodeInput == NULL
+        || nodeInput != s_indexedInput
+        || nodeInput->numLines != s_indexedNumLines
+        || parameterName == NULL
+        || !IoIndexGetKey(parameterName, key))
+    {
+        return;
+    }
+
+    entry = IoIndexFind(key);
+    if (entry != NULL)
+    {
+        lines = &s_indexLines[entry->firstLine];
+        numLines = entry->numLines;
+    }
+
+    m_view = *nodeInput;
+    allocateLines(numLines + numRouterModelLines);
+
+    // Merge the lines of the parameter with the ROUTER-MODEL lines
+    while (i < numLines || j < numRouterModelLines)
+    {
+        int line;
+
+        if (j == numRouterModelLines
+            || (i < numLines && lines[i] < s_routerModelLines[j]))
+        {
+            line = lines[i++];
+        }
+        else
+        {
+            line = s_routerModelLines[j++];
+            if (i < numLines && lines[i] == line)
+            {
+                i++;
+            }
+        }
+
+        m_view.inputStrings[n] = nodeInput->inputStrings[line];
+        m_view.timeQualifiers[n] = nodeInput->timeQualifiers[line];
+        m_view.qualifiers[n] = nodeInput->qualifiers[line];
+        m_view.variableNames[n] = nodeInput->variableNames[line];
+        m_view.instanceIds[n] = nodeInput->instanceIds[line];
+        m_view.values[n] = nodeInput->values[line];
+        n++;
+    }
+    m_view.numLines = n;
+    m_view.maxNumLines = n;
+    m_nodeInput = &m_view;
+
+    if (s_keepStatistics)
+    {
+        m_parameterName = parameterName;
+        m_start = WallClock::getTrueRealTime();
+    }
+}
+
+NodeInputView::~NodeInputView()
+{
+    if (m_nodeInput != &m_view)
+    {
+        return;
+    }
+
+    if (m_parameterName != NULL)
+    {
+        clocktype readTime = WallClock::getTrueRealTime() - m_start;
+        char key[MAX_STRING_LENGTH];
+
+        IoIndexGetKey(m_parameterName, key);
+
+        pthread_mutex_lock(&s_statisticsMutex);
+        IoIndexStatistics& statistics = s_statistics[std::string(key)];
+        statistics.numReads++;
+        statistics.numLinesRead += m_view.numLines;
+        statistics.readTime += readTime;
+        pthread_mutex_unlock(&s_statisticsMutex);
+    }
+
+    if (m_view.inputStrings != m_inputStrings)
+    {
+        MEM_free(m_view.inputStrings);
+        MEM_free(m_view.timeQualifiers);
+        MEM_free(m_view.qualifiers);
+        MEM_free(m_view.variableNames);
+        MEM_free(m_view.instanceIds);
+        MEM_free(m_view.values);
+    }
+}
+
+static bool IoIndexSlowerRead(
+    const std::pair<std::string, IoIndexStatistics>& a,
+    const std::pair<std::string, IoIndexStatistics>& b)
+{
+    return a.second.readTime > b.second.readTime;
+}
+
+void
+IO_PrintNodeInputIndexStatistics()
+{
+    std::vector<std::pair<std::string, IoIndexStatistics> > parameters;
+    UInt64 numReads = 0;
+    UInt64 numLinesRead = 0;
+    clocktype readTime = 0;
+    int i;
+
+    if (!s_keepStatistics)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_statisticsMutex);
+    parameters.assign(s_statistics.begin(), s_statistics.end());
+    pthread_mutex_unlock(&s_statisticsMutex);
+
+    for (i = 0; i < (int) parameters.size(); i++)
+    {
+        numReads += parameters[i].second.numReads;
+        numLinesRead += parameters[i].second.numLinesRead;
+        readTime += parameters[i].second.readTime;
+    }
+    std::sort(parameters.begin(), parameters.end(), IoIndexSlowerRead);
+
+    printf("Parameter reads: %" TYPES_64BITFMT "u reads of %u parameters "
+           "in %.3f s, %" TYPES_64BITFMT "u lines searched instead of "
+           "%" TYPES_64BITFMT "u\n",
+           numReads,
+           (unsigned) parameters.size(),
+           (double) readTime / SECOND,
+           numLinesRead,
+           numReads * (UInt64) s_indexedNumLines);
+    printf("%-40s %12s %10s %12s\n",
+           "Parameter", "Reads", "Lines", "Time (ms)");
+
+    for (i = 0;
+         i < (int) parameters.size() && i < IO_INDEX_NUM_REPORTED_PARAMETERS;
+         i++)
+    {
+        const IoIndexStatistics& statistics = parameters[i].second;
+
+        printf("%-40s %12" TYPES_64BITFMT "u %10.1f %12.3f\n",
+               parameters[i].first.c_str(),
+               statistics.numReads,
+               (double) statistics.numLinesRead / statistics.numReads,
+               (double) statistics.readTime / MILLI_SECOND);
+    }
+}
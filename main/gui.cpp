@@ -57,6 +57,7 @@ typedef int ssize_t;
 #include "qualnet_error.h"
 #include "fileio.h"
 #include "gui.h"
+#include "gui_stream.h"
 #include "partition.h"
 #include "phy.h"
 #include "external_util.h"
@@ -156,6 +157,9 @@ clocktype GUI_statInterval;
 unsigned int GUI_guiSocket       = 0;
 BOOL         GUI_guiSocketOpened = FALSE;
 BOOL         GUI_animationTrace = FALSE;
+
+// Sends replies to the GUI once connected, see GUI_StartAnimationStream
+static GuiAnimationStream GUI_animationStream;
 static int   g_statLayerEnabled[MAX_LAYERS];
 //static int   metricsEnabledByLayer[MAX_LAYERS];
 
@@ -305,6 +309,7 @@ static int             g_numberOfMetrics  = 0;
 
 
 static BOOL GUI_isConnected ();
+static void GUI_SendDroppableReply(GuiReply reply);
 
 /*------------------------------------------------------
  * We want to store node information in a simple array, but
@@ -1317,6 +1322,11 @@ void GUI_MoveNode(NodeId      nodeID,
     if (!g_eventEnabled[GUI_MOVE_NODE])
         return;
 
+    if (GUI_isConnected () && GUI_animationStream.isStarted()) {
+        GUI_animationStream.moveNode(nodeID, position, time);
+        return;
+    }
+
     ctoa(time, timeString);
 
     reply.type = GUI_ANIMATION_COMMAND;
@@ -1353,6 +1363,11 @@ void GUI_SetNodeOrientation(NodeId      nodeID,
     if (!g_eventEnabled[GUI_SET_ORIENTATION])
         return;
 
+    if (GUI_isConnected () && GUI_animationStream.isStarted()) {
+        GUI_animationStream.setNodeOrientation(nodeID, orientation, time);
+        return;
+    }
+
     ctoa(time, timeString);
 
     reply.type = GUI_ANIMATION_COMMAND;
@@ -1858,7 +1873,7 @@ void GUI_Multicast(NodeId      nodeID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -1908,7 +1923,7 @@ void GUI_Broadcast(NodeId      nodeID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -1946,7 +1961,7 @@ void GUI_EndBroadcast(NodeId      nodeID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -1988,7 +2003,7 @@ void GUI_Unicast(NodeId      sourceID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -2045,7 +2060,7 @@ void GUI_Receive(NodeId      sourceID,
             receivingInterfaceIndex, timeString);
     reply.args.append(replyBuff);
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -2091,7 +2106,7 @@ void GUI_Drop(NodeId      sourceID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -2126,7 +2141,7 @@ void GUI_Collision(NodeId      nodeID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -2462,7 +2477,7 @@ void GUI_QueueInsertPacket(NodeId       nodeID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -2500,7 +2515,7 @@ void GUI_QueueDropPacket(NodeId       nodeID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -2539,7 +2554,7 @@ void GUI_QueueDequeuePacket(NodeId       nodeID,
     reply.args.append(replyBuff);
 
     if (GUI_isConnected ()) {
-        GUI_SendReply(GUI_guiSocket, reply);
+        GUI_SendDroppableReply(reply);
     }
     else {
         printf("%s\n", reply.args.c_str());
@@ -2831,6 +2846,8 @@ void GUI_DisconnectFromGUI(SOCKET_HANDLE socket, bool sendFinishedReply) {
             fflush(stdout);
         }
 
+        GUI_animationStream.stop();
+
         // Allow one second to elapse until the socket is closed
         EXTERNAL_Sleep(1 * SECOND);
         GUI_guiSocketOpened = FALSE;
@@ -2907,6 +2924,7 @@ void GUI_DisconnectFromGUI(SOCKET_HANDLE socket, bool sendFinishedReply) {
             fflush(stdout);
         }
 
+        GUI_animationStream.stop();
         GUI_guiSocketOpened = FALSE;
         close(socket);
     }
@@ -2998,20 +3016,16 @@ GuiCommand GUI_ReceiveCommand(SOCKET_HANDLE socket) {
 }
 
 /*------------------------------------------------------
- * GUI_SendReply
+ * GUI_SendBytes
+ *
+ * Writes bytes to the GUI socket, returning FALSE if the
+ * connection failed.
  *------------------------------------------------------*/
-void GUI_SendReply(SOCKET_HANDLE   socket,
-                   GuiReply reply) {
-    char buffer[GUI_MAX_COMMAND_LENGTH + 10];
-    std::string outString;
-
-    sprintf(buffer, "%d ", reply.type);
-    outString.append(buffer);
-    outString.append(reply.args);
-    outString.append("\n");
-
-    const char *outPos = outString.c_str();
-    size_t size_left = outString.size();
+static BOOL GUI_SendBytes(SOCKET_HANDLE socket,
+                          const char*   data,
+                          size_t        size) {
+    const char *outPos = data;
+    size_t size_left = size;
     while (size_left > 0)
     {
         ssize_t returnValue =
@@ -3023,9 +3037,7 @@ void GUI_SendReply(SOCKET_HANDLE   socket,
         }
         else if (returnValue < 0)
         {
-            // unknown error, shut down the simulation gracefully
-            PARTITION_RequestEndSimulation();
-            return;
+            return FALSE;
         }
         else
         {
@@ -3033,6 +3045,58 @@ void GUI_SendReply(SOCKET_HANDLE   socket,
             size_left -= returnValue;
         }
     }
+    return TRUE;
+}
+
+/*------------------------------------------------------
+ * GUI_EncodeReply
+ *------------------------------------------------------*/
+static std::string GUI_EncodeReply(const GuiReply& reply) {
+    char buffer[GUI_MAX_COMMAND_LENGTH + 10];
+    std::string outString;
+
+    sprintf(buffer, "%d ", reply.type);
+    outString.append(buffer);
+    outString.append(reply.args);
+    outString.append("\n");
+    return outString;
+}
+
+/*------------------------------------------------------
+ * GUI_QueueReply
+ *
+ * Queues a reply on the animation stream.  If the sender
+ * thread could not write to the GUI, the simulation is
+ * ended as GUI_SendReply would.
+ *------------------------------------------------------*/
+static void GUI_QueueReply(const GuiReply& reply, BOOL droppable) {
+    if (GUI_animationStream.failed())
+    {
+        PARTITION_RequestEndSimulation();
+        return;
+    }
+    GUI_animationStream.send(GUI_EncodeReply(reply), droppable);
+}
+
+/*------------------------------------------------------
+ * GUI_SendReply
+ *------------------------------------------------------*/
+void GUI_SendReply(SOCKET_HANDLE   socket,
+                   GuiReply reply) {
+    if (GUI_animationStream.isStarted() && socket == GUI_guiSocket)
+    {
+        GUI_QueueReply(reply, FALSE);
+        return;
+    }
+
+    std::string outString = GUI_EncodeReply(reply);
+
+    if (!GUI_SendBytes(socket, outString.c_str(), outString.size()))
+    {
+        // unknown error, shut down the simulation gracefully
+        PARTITION_RequestEndSimulation();
+        return;
+    }
     if (DEBUG)
     {
         printf("sent over socket: %s\n", outString.c_str());
@@ -3040,6 +3104,97 @@ void GUI_SendReply(SOCKET_HANDLE   socket,
     }
 }
 
+/*------------------------------------------------------
+ * GUI_SendDroppableReply
+ *
+ * Sends a packet animation, which the animation stream may
+ * drop while the GUI does not keep up.
+ *------------------------------------------------------*/
+static void GUI_SendDroppableReply(GuiReply reply) {
+    if (GUI_animationStream.isStarted())
+    {
+        GUI_QueueReply(reply, TRUE);
+    }
+    else
+    {
+        GUI_SendReply(GUI_guiSocket, reply);
+    }
+}
+
+/*------------------------------------------------------
+ * GUI_StartAnimationStream
+ *
+ * Starts sending replies to the GUI from a sender thread
+ * unless GUI-ANIMATION-STREAM is NO.
+ *------------------------------------------------------*/
+static void GUI_StartAnimationStream(NodeInput* nodeInput) {
+    BOOL      wasFound;
+    char      buf[MAX_STRING_LENGTH];
+    clocktype window = 0;
+    int       queueLimit = GUI_STREAM_DEFAULT_QUEUE_LIMIT;
+    BOOL      binaryFrames = FALSE;
+
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "GUI-ANIMATION-STREAM",
+        &wasFound,
+        buf);
+    if (wasFound && strcmp(buf, "NO") == 0) {
+        return;
+    }
+    else if (wasFound && strcmp(buf, "YES") != 0) {
+        ERROR_ReportError("GUI-ANIMATION-STREAM should be YES or NO\n");
+    }
+
+    IO_ReadTime(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "GUI-ANIMATION-COALESCE-WINDOW",
+        &wasFound,
+        &window);
+    if (wasFound && window < 0) {
+        ERROR_ReportError(
+            "Invalid entry for GUI-ANIMATION-COALESCE-WINDOW\n");
+    }
+
+    IO_ReadInt(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "GUI-ANIMATION-QUEUE-LIMIT",
+        &wasFound,
+        &queueLimit);
+    if (wasFound && queueLimit <= 0) {
+        ERROR_ReportError("Invalid entry for GUI-ANIMATION-QUEUE-LIMIT\n");
+    }
+
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "GUI-ANIMATION-BINARY-FRAMES",
+        &wasFound,
+        buf);
+    if (wasFound) {
+        if (strcmp(buf, "YES") == 0) {
+            binaryFrames = TRUE;
+        }
+        else if (strcmp(buf, "NO") != 0) {
+            ERROR_ReportError(
+                "GUI-ANIMATION-BINARY-FRAMES should be YES or NO\n");
+        }
+    }
+
+    GUI_animationStream.start(GUI_guiSocket,
+                              &GUI_SendBytes,
+                              window,
+                              (size_t) queueLimit,
+                              binaryFrames);
+}
+
 /*------------------------------------------------------
  * GUI_SetLayerFilter
  *------------------------------------------------------*/
@@ -3390,6 +3545,9 @@ bool GUI_EXTERNAL_Bootstrap (int argc, char * argv [], NodeInput * nodeInput,
             portNumber = atoi(argv[thisArg+2]);
 
             GUI_ConnectToGUI(hostname, (unsigned short) portNumber);
+            if (GUI_guiSocketOpened) {
+                GUI_StartAnimationStream(nodeInput);
+            }
 #ifdef PARALLEL //Parallel
             if (GUI_guiSocketOpened) {
                 PARALLEL_SetGreedy(false);
@@ -0,0 +1,342 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "api.h"
+#include "gui_stream.h"
+
+// A GUI_ANIMATION_FRAME reply is the line "13 <length>\n" followed by
+// <length> bytes, all numbers little endian:
+//
+//   UInt32 number of updates, then per update:
+//   UInt8  event, GUI_MOVE_NODE or GUI_SET_ORIENTATION
+//   UInt32 node ID
+//   Int64  simulation time
+//   3 x double coordinates (GUI_MOVE_NODE) or
+//   2 x Int16 azimuth and elevation (GUI_SET_ORIENTATION)
+
+static void GuiStreamPutBytes(std::string& out, UInt64 value, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        out += (char) ((value >> (8 * i)) & 0xff);
+    }
+}
+
+static void GuiStreamPutDouble(std::string& out, double value)
+{
+    UInt64 bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    GuiStreamPutBytes(out, bits, 8);
+}
+
+GuiAnimationStream::GuiAnimationStream()
+: started_(FALSE), socket_(0), sendFn_(NULL), window_(0),
+  queueLimit_(GUI_STREAM_DEFAULT_QUEUE_LIMIT), binaryFrames_(FALSE),
+  windowEnd_(0), sending_(FALSE), stop_(FALSE), failed_(FALSE),
+  numDropped_(0)
+{
+}
+
+GuiAnimationStream::~GuiAnimationStream()
+{
+    stop();
+}
+
+void GuiAnimationStream::start(
+    SOCKET_HANDLE socket,
+    GuiStreamSendFn sendFn,
+    clocktype window,
+    size_t queueLimit,
+    BOOL binaryFrames)
+{
+    socket_ = socket;
+    sendFn_ = sendFn;
+    window_ = window;
+    queueLimit_ = queueLimit;
+    binaryFrames_ = binaryFrames;
+
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_cond_init(&cond_, NULL);
+
+    ERROR_Assert(pthread_create(&thread_, NULL, GuiAnimationStream::run,
+                                (void*) this) == 0,
+                 "Unable to start the GUI sender thread.");
+    started_ = TRUE;
+}
+
+void* GuiAnimationStream::run(void* data)
+{
+    GuiAnimationStream* stream = (GuiAnimationStream*) data;
+    std::string sendBuffer;
+
+    pthread_mutex_lock(&stream->mutex_);
+    for (;;)
+    {
+        while (stream->queue_.empty() && !stream->stop_)
+        {
+            pthread_cond_wait(&stream->cond_, &stream->mutex_);
+        }
+        if (stream->queue_.empty())
+        {
+            break;
+        }
+
+        // Send everything queued so far with as few writes as possible
+        sendBuffer.swap(stream->queue_);
+        stream->sending_ = TRUE;
+        pthread_mutex_unlock(&stream->mutex_);
+
+        BOOL ok = stream->sendFn_(stream->socket_,
+                                  sendBuffer.data(),
+                                  sendBuffer.size());
+        sendBuffer.clear();
+
+        pthread_mutex_lock(&stream->mutex_);
+        stream->sending_ = FALSE;
+        if (!ok)
+        {
+            stream->failed_ = TRUE;
+            stream->queue_.clear();
+        }
+        pthread_cond_broadcast(&stream->cond_);
+    }
+    pthread_mutex_unlock(&stream->mutex_);
+
+    return NULL;
+}
+
+void GuiAnimationStream::wake()
+{
+    pthread_cond_broadcast(&cond_);
+}
+
+GuiAnimationStream::NodeUpdate& GuiAnimationStream::update(
+    NodeId nodeID,
+    clocktype time)
+{
+    if (!updates_.empty() && time > windowEnd_)
+    {
+        flushUpdatesLocked();
+    }
+    if (updates_.empty())
+    {
+        windowEnd_ = time + window_;
+    }
+
+    std::map<NodeId, NodeUpdate>::iterator it = updates_.find(nodeID);
+
+    if (it == updates_.end())
+    {
+        NodeUpdate& nodeUpdate = updates_[nodeID];
+
+        nodeUpdate.hasPosition = FALSE;
+        nodeUpdate.hasOrientation = FALSE;
+        return nodeUpdate;
+    }
+    return it->second;
+}
+
+void GuiAnimationStream::moveNode(
+    NodeId nodeID,
+    const Coordinates& position,
+    clocktype time)
+{
+    pthread_mutex_lock(&mutex_);
+
+    NodeUpdate& nodeUpdate = update(nodeID, time);
+
+    nodeUpdate.hasPosition = TRUE;
+    nodeUpdate.position = position;
+    nodeUpdate.positionTime = time;
+
+    pthread_mutex_unlock(&mutex_);
+}
+
+void GuiAnimationStream::setNodeOrientation(
+    NodeId nodeID,
+    const Orientation& orientation,
+    clocktype time)
+{
+    pthread_mutex_lock(&mutex_);
+
+    NodeUpdate& nodeUpdate = update(nodeID, time);
+
+    nodeUpdate.hasOrientation = TRUE;
+    nodeUpdate.orientation = orientation;
+    nodeUpdate.orientationTime = time;
+
+    pthread_mutex_unlock(&mutex_);
+}
+
+void GuiAnimationStream::flushUpdatesLocked()
+{
+    std::map<NodeId, NodeUpdate>::iterator it;
+
+    if (updates_.empty())
+    {
+        return;
+    }
+
+    if (binaryFrames_)
+    {
+        std::string frame;
+        UInt32 count = 0;
+        char header[64];
+
+        GuiStreamPutBytes(frame, 0, 4);
+        for (it = updates_.begin(); it != updates_.end(); it++)
+        {
+            const NodeUpdate& nodeUpdate = it->second;
+
+            if (nodeUpdate.hasPosition)
+            {
+                GuiStreamPutBytes(frame, GUI_MOVE_NODE, 1);
+                GuiStreamPutBytes(frame, it->first, 4);
+                GuiStreamPutBytes(frame, (UInt64) nodeUpdate.positionTime, 8);
+                GuiStreamPutDouble(frame, nodeUpdate.position.common.c1);
+                GuiStreamPutDouble(frame, nodeUpdate.position.common.c2);
+                GuiStreamPutDouble(frame, nodeUpdate.position.common.c3);
+                count++;
+            }
+            if (nodeUpdate.hasOrientation)
+            {
+                GuiStreamPutBytes(frame, GUI_SET_ORIENTATION, 1);
+                GuiStreamPutBytes(frame, it->first, 4);
+                GuiStreamPutBytes(frame,
+                                  (UInt64) nodeUpdate.orientationTime,
+                                  8);
+                GuiStreamPutBytes(frame,
+                                  (UInt16) nodeUpdate.orientation.azimuth,
+                                  2);
+                GuiStreamPutBytes(frame,
+                                  (UInt16) nodeUpdate.orientation.elevation,
+                                  2);
+                count++;
+            }
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            frame[i] = (char) ((count >> (8 * i)) & 0xff);
+        }
+
+        sprintf(header, "%d %u\n", GUI_ANIMATION_FRAME, (unsigned) frame.size());
+        queue_.append(header);
+        queue_.append(frame);
+    }
+    else
+    {
+        char line[GUI_MAX_COMMAND_LENGTH];
+        char timeString[MAX_CLOCK_STRING_LENGTH];
+
+        for (it = updates_.begin(); it != updates_.end(); it++)
+        {
+            const NodeUpdate& nodeUpdate = it->second;
+
+            if (nodeUpdate.hasPosition)
+            {
+                ctoa(nodeUpdate.positionTime, timeString);
+                sprintf(line, "%d %d %u %.15f %.15f %.15f %s\n",
+                        GUI_ANIMATION_COMMAND,
+                        GUI_MOVE_NODE, it->first,
+                        nodeUpdate.position.common.c1,
+                        nodeUpdate.position.common.c2,
+                        nodeUpdate.position.common.c3,
+                        timeString);
+                queue_.append(line);
+            }
+            if (nodeUpdate.hasOrientation)
+            {
+                ctoa(nodeUpdate.orientationTime, timeString);
+                sprintf(line, "%d %d %u %d %d %s\n",
+                        GUI_ANIMATION_COMMAND,
+                        GUI_SET_ORIENTATION, it->first,
+                        nodeUpdate.orientation.azimuth,
+                        nodeUpdate.orientation.elevation,
+                        timeString);
+                queue_.append(line);
+            }
+        }
+    }
+
+    updates_.clear();
+    wake();
+}
+
+void GuiAnimationStream::flushUpdates()
+{
+    pthread_mutex_lock(&mutex_);
+    flushUpdatesLocked();
+    pthread_mutex_unlock(&mutex_);
+}
+
+void GuiAnimationStream::send(
+    const std::string& data,
+    BOOL droppable)
+{
+    pthread_mutex_lock(&mutex_);
+
+    // Node updates are held only while nothing else is sent, so that no
+    // reply overtakes the moves before it
+    flushUpdatesLocked();
+
+    if (droppable && queue_.size() > queueLimit_)
+    {
+        numDropped_++;
+    }
+    else if (!failed_)
+    {
+        queue_.append(data);
+        wake();
+    }
+
+    pthread_mutex_unlock(&mutex_);
+}
+
+BOOL GuiAnimationStream::failed()
+{
+    BOOL result;
+
+    pthread_mutex_lock(&mutex_);
+    result = failed_;
+    pthread_mutex_unlock(&mutex_);
+
+    return result;
+}
+
+void GuiAnimationStream::stop()
+{
+    if (!started_)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&mutex_);
+    flushUpdatesLocked();
+    stop_ = TRUE;
+    wake();
+    pthread_mutex_unlock(&mutex_);
+
+    pthread_join(thread_, NULL);
+    started_ = FALSE;
+
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&mutex_);
+}
@@ -12502,7 +12502,7 @@ void HandleMacDBSummary(Node* node,
         }
 
         MacSummaryInfo* macSummaryInfo = (MacSummaryInfo*)
-            MESSAGE_ReturnInfo(msg, INFO_TYPE_MacSummaryStats);
+            MESSAGE_ReturnWritableInfo(node, msg, INFO_TYPE_MacSummaryStats);
 
         if (macSummaryInfo == NULL)
         {
@@ -12745,7 +12745,7 @@ void HandleMacDBAggregate(Node* node,
         }
 
         MacSummaryInfo* macAggregateInfo = (MacSummaryInfo*)
-            MESSAGE_ReturnInfo(msg, INFO_TYPE_MacSummaryStats);
+            MESSAGE_ReturnWritableInfo(node, msg, INFO_TYPE_MacSummaryStats);
 
         if (macAggregateInfo == NULL)
         {
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 #include <string>
 
 #include "api.h"
@@ -33,6 +34,7 @@
 #include "qualnet_mutex.h"
 #include "parallel_private.h"
 #include "context.h"
+#include "util_atomic.h"
 
 #ifdef CELLULAR_LIB
 #include "mac_cellular_abstract.h"
@@ -52,9 +54,35 @@ static int deallocs = 0;
 #define DEBUG 0
 #define noMESSAGE_NO_RECYCLE
 //#define MESSAGE_NO_RECYCLE
-/* Maximum amount of messages that can be kept in the free list. */
-#define MSG_LIST_MAX 10000
-//#define MSG_LIST_MAX 0
+
+/* Allocations between adjustments of the free list high-water marks. */
+#define MSG_LIST_ADAPT_INTERVAL 4096
+
+/* Batches a partition keeps ready for worker threads that run dry. */
+#define MSG_RECYCLE_DONATE_MAX 4
+
+// Messages, payloads and info cells allocated or freed from a worker
+// thread (isMT) cannot touch the partition free lists, which are not
+// locked.  Instead each thread keeps its own cache, and whole batches of
+// cells are handed to and from the partition under the partition's
+// msgRecycleMutex.
+#ifdef _WIN32
+#define MESSAGE_THREAD_LOCAL __declspec(thread)
+#else
+#define MESSAGE_THREAD_LOCAL __thread
+#endif
+
+static MESSAGE_THREAD_LOCAL MessageRecycleBatch* tMessageCache = NULL;
+static MESSAGE_THREAD_LOCAL PartitionData* tMessageCachePartition = NULL;
+
+#ifndef _WIN32
+// Key whose destructor hands the cache of an exiting thread back to its
+// partition.  Windows has no such key at the _WIN32_WINNT level of
+// qualnet_mutex.h, so there the cache of a thread that exits early stays
+// with the thread.
+static pthread_key_t  s_messageThreadCacheKey;
+static pthread_once_t s_messageThreadCacheKeyOnce = PTHREAD_ONCE_INIT;
+#endif
 
 // #define DEBUG_EVENT_TRACE TRUE
 
@@ -91,7 +119,485 @@ int gMessageSetPrintCount = 0;
 static Message gGraphMessage;
 #endif
 
-Message::Message() : m_radioId(-1)
+// Reference count shared by all duplicates that point at the same payload
+// (or the same set of info field buffers) when MESSAGE-COPY-ON-WRITE is
+// enabled.  The last holder to release the reference frees the buffers.
+struct MessageSharedRef
+{
+    UTIL_AtomicInteger refCount;
+};
+
+static MessageSharedRef* MessageSharedRefAlloc()
+{
+    MessageSharedRef* ref = new MessageSharedRef;
+    UTIL_AtomicSet(&ref->refCount, 1);
+    return ref;
+}
+
+// Drop one reference.  Returns TRUE if the caller was the last holder, in
+// which case the reference itself has been deleted and the caller owns
+// the buffers again.
+static BOOL MessageSharedRefRelease(MessageSharedRef* ref)
+{
+    if (UTIL_AtomicDecrementAndTest(&ref->refCount))
+    {
+        delete ref;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+// Returns TRUE if the info field does not live in the small info space
+// of the message, i.e. it owns a separately allocated buffer.
+static BOOL MessageInfoHasOwnBuffer(const MessageInfoHeader* hdr)
+{
+    return (hdr->infoType != INFO_TYPE_DEFAULT
+            || hdr->infoSize > SMALL_INFO_SPACE_SIZE);
+}
+
+// Give msg a private copy of its payload if it is shared with another
+// duplicate.  The copy is made before the reference is dropped so the
+// buffer cannot be freed underneath us by another holder.
+static void MessageUnsharePayload(PartitionData* partition, Message* msg)
+{
+    if (msg->sharedPayload == NULL)
+    {
+        return;
+    }
+
+    if (UTIL_AtomicRead(&msg->sharedPayload->refCount) == 1)
+    {
+        // Every other duplicate has already been freed, reuse the buffer.
+        MessageSharedRefRelease(msg->sharedPayload);
+        msg->sharedPayload = NULL;
+        return;
+    }
+
+    char* oldPayload = msg->payload;
+    char* newPayload = MESSAGE_PayloadAlloc(partition,
+                                            msg->payloadSize,
+                                            msg->mtWasMT);
+    ERROR_Assert(newPayload != NULL, "Out of memory");
+    memcpy(newPayload, oldPayload, msg->payloadSize);
+
+    if (msg->packet != NULL)
+    {
+        msg->packet = newPayload + (msg->packet - oldPayload);
+    }
+    msg->payload = newPayload;
+
+    if (MessageSharedRefRelease(msg->sharedPayload))
+    {
+        // The other holders went away while we were copying
+        MESSAGE_PayloadFree(partition, oldPayload, msg->payloadSize,
+                            msg->mtWasMT);
+    }
+    msg->sharedPayload = NULL;
+    partition->msgPayloadCopiesMade++;
+}
+
+// Give msg private copies of its info field buffers if they are shared
+// with another duplicate.  Info fields kept in the small info space are
+// already private to each message.
+static void MessageUnshareInfo(PartitionData* partition, Message* msg)
+{
+    unsigned int i;
+
+    if (msg->sharedInfo == NULL)
+    {
+        return;
+    }
+
+    if (UTIL_AtomicRead(&msg->sharedInfo->refCount) == 1)
+    {
+        MessageSharedRefRelease(msg->sharedInfo);
+        msg->sharedInfo = NULL;
+        return;
+    }
+
+    std::vector<MessageInfoHeader> oldInfo = msg->infoArray;
+    for (i = 0; i < msg->infoArray.size(); i++)
+    {
+        MessageInfoHeader* hdrPtr = &(msg->infoArray[i]);
+        if (hdrPtr->infoSize > 0 && MessageInfoHasOwnBuffer(hdrPtr))
+        {
+            hdrPtr->info = MESSAGE_InfoFieldAlloc(partition,
+                                                  hdrPtr->infoSize,
+                                                  msg->mtWasMT);
+            ERROR_Assert(hdrPtr->info != NULL, "Out of memory");
+            memcpy(hdrPtr->info, oldInfo[i].info, hdrPtr->infoSize);
+            partition->msgInfoCopiesMade++;
+        }
+    }
+
+    if (MessageSharedRefRelease(msg->sharedInfo))
+    {
+        for (i = 0; i < oldInfo.size(); i++)
+        {
+            if (oldInfo[i].infoSize > 0 && MessageInfoHasOwnBuffer(&oldInfo[i]))
+            {
+                MESSAGE_InfoFieldFree(partition, &oldInfo[i], msg->mtWasMT);
+            }
+        }
+    }
+    msg->sharedInfo = NULL;
+}
+
+// Update the adaptive high-water mark of a free list on allocation.
+// listNum is the length of the list before the allocation.
+static void MessageFreeListTrackAlloc(MessageFreeListLimit* limit,
+                                      int listNum)
+{
+    limit->numAllocs++;
+    if (listNum == 0)
+    {
+        limit->numMisses++;
+    }
+    if (listNum < limit->lowWater)
+    {
+        limit->lowWater = listNum;
+    }
+
+    if (limit->numAllocs < MSG_LIST_ADAPT_INTERVAL)
+    {
+        return;
+    }
+
+    if (limit->numMisses > 0 && limit->numDiscards > 0)
+    {
+        // Cells were thrown away and then needed again: the cap is too low
+        limit->highWater = MIN(limit->highWater * 2, MSG_LIST_CEILING);
+    }
+    else if (limit->lowWater > limit->highWater / 2)
+    {
+        // Part of the list was never used during the interval
+        limit->highWater = MAX(limit->highWater - limit->lowWater / 2,
+                               MSG_LIST_MIN);
+    }
+
+    limit->numAllocs = 0;
+    limit->numMisses = 0;
+    limit->numDiscards = 0;
+    limit->lowWater = limit->highWater;
+}
+
+static void MessageFreeListLimitInit(MessageFreeListLimit* limit,
+                                     int highWater)
+{
+    limit->highWater = highWater;
+    limit->lowWater = highWater;
+    limit->numAllocs = 0;
+    limit->numMisses = 0;
+    limit->numDiscards = 0;
+}
+
+// Release every cell in a batch to the heap.
+static void MessageRecycleBatchRelease(MessageRecycleBatch* batch)
+{
+    while (batch->msgList != NULL)
+    {
+        Message* msg = batch->msgList;
+        batch->msgList = msg->next;
+        msg->setFreed(false);
+        delete msg;
+    }
+    while (batch->payloadList != NULL)
+    {
+        MessagePayloadListCell* cell = batch->payloadList;
+        batch->payloadList = cell->next;
+        MEM_free(cell);
+    }
+    while (batch->infoList != NULL)
+    {
+        MessageInfoListCell* cell = batch->infoList;
+        batch->infoList = cell->next;
+        MEM_free(cell);
+    }
+    batch->msgNum = 0;
+    batch->payloadNum = 0;
+    batch->infoNum = 0;
+}
+
+// Move up to maxNum cells of each kind from src to the front of dst.
+static void MessageRecycleBatchMove(MessageRecycleBatch* dst,
+                                    MessageRecycleBatch* src,
+                                    int maxNum)
+{
+    int i;
+
+    for (i = 0; i < maxNum && src->msgList != NULL; i++)
+    {
+        Message* msg = src->msgList;
+        src->msgList = msg->next;
+        msg->next = dst->msgList;
+        dst->msgList = msg;
+        src->msgNum--;
+        dst->msgNum++;
+    }
+    for (i = 0; i < maxNum && src->payloadList != NULL; i++)
+    {
+        MessagePayloadListCell* cell = src->payloadList;
+        src->payloadList = cell->next;
+        cell->next = dst->payloadList;
+        dst->payloadList = cell;
+        src->payloadNum--;
+        dst->payloadNum++;
+    }
+    for (i = 0; i < maxNum && src->infoList != NULL; i++)
+    {
+        MessageInfoListCell* cell = src->infoList;
+        src->infoList = cell->next;
+        cell->next = dst->infoList;
+        dst->infoList = cell;
+        src->infoNum--;
+        dst->infoNum++;
+    }
+}
+
+// Hand one batch of cells from the thread cache back to the partition.
+static void MessageThreadCacheReturnBatch(PartitionData* partition,
+                                          MessageRecycleBatch* cache,
+                                          int maxNum)
+{
+    MessageRecycleBatch* batch = new MessageRecycleBatch;
+    memset(batch, 0, sizeof(MessageRecycleBatch));
+    MessageRecycleBatchMove(batch, cache, maxNum);
+
+    QNThreadLock lock(partition->msgRecycleMutex);
+    batch->next = partition->msgReturnedBatches;
+    partition->msgReturnedBatches = batch;
+}
+
+#ifndef _WIN32
+// Give the cache of an exiting thread back to the partition its cells
+// came from.
+static void MessageThreadCacheExit(void* value)
+{
+    MessageRecycleBatch* cache = (MessageRecycleBatch*) value;
+
+    if (tMessageCachePartition != NULL)
+    {
+        MessageThreadCacheReturnBatch(tMessageCachePartition,
+                                      cache,
+                                      INT_MAX);
+    }
+    MessageRecycleBatchRelease(cache);
+    delete cache;
+
+    tMessageCache = NULL;
+    tMessageCachePartition = NULL;
+}
+
+static void MessageThreadCacheKeyCreate()
+{
+    pthread_key_create(&s_messageThreadCacheKey, MessageThreadCacheExit);
+}
+#endif
+
+// Return the calling thread's cache, bound to the given partition.
+static MessageRecycleBatch* MessageGetThreadCache(PartitionData* partition)
+{
+    if (tMessageCache == NULL)
+    {
+        tMessageCache = new MessageRecycleBatch;
+        memset(tMessageCache, 0, sizeof(MessageRecycleBatch));
+
+#ifndef _WIN32
+        pthread_once(&s_messageThreadCacheKeyOnce,
+                     MessageThreadCacheKeyCreate);
+        pthread_setspecific(s_messageThreadCacheKey, tMessageCache);
+#endif
+    }
+    else if (tMessageCachePartition != partition
+             && tMessageCachePartition != NULL)
+    {
+        // The thread moved on to another partition; give everything back
+        // to the partition the cells came from.
+        MessageThreadCacheReturnBatch(tMessageCachePartition,
+                                      tMessageCache,
+                                      INT_MAX);
+    }
+    tMessageCachePartition = partition;
+    return tMessageCache;
+}
+
+// Take one donated batch from the partition, or ask the partition for
+// more if none is available.  A batch can lack the kind of cell the
+// caller needs, so callers check their list again afterwards.
+static void MessageThreadCacheRefill(PartitionData* partition,
+                                     MessageRecycleBatch* cache)
+{
+    MessageRecycleBatch* batch = NULL;
+    {
+        QNThreadLock lock(partition->msgRecycleMutex);
+        batch = partition->msgDonatedBatches;
+        if (batch == NULL)
+        {
+            partition->msgDonationRequests++;
+            return;
+        }
+        partition->msgDonatedBatches = batch->next;
+        partition->msgDonatedBatchesNum--;
+    }
+
+    MessageRecycleBatchMove(cache, batch, INT_MAX);
+    delete batch;
+}
+
+// Hand cells back to the partition once the thread cache grows past two
+// batches, so a thread that only frees does not hoard them.
+static void MessageThreadCacheTrim(PartitionData* partition,
+                                   MessageRecycleBatch* cache)
+{
+    if (cache->msgNum > 2 * MSG_RECYCLE_BATCH_SIZE
+        || cache->payloadNum > 2 * MSG_RECYCLE_BATCH_SIZE
+        || cache->infoNum > 2 * MSG_RECYCLE_BATCH_SIZE)
+    {
+        MessageThreadCacheReturnBatch(partition,
+                                      cache,
+                                      MSG_RECYCLE_BATCH_SIZE);
+    }
+}
+
+// /**
+// API       :: MESSAGE_InitializeRecycling
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Set up the partition's message free list limits and the
+//              batch hand-off used by worker thread caches.
+// PARAMETERS ::
+// + partition:  PartitionData* : partition to initialize
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_InitializeRecycling(PartitionData *partition)
+{
+    MessageFreeListLimitInit(&partition->msgFreeListLimit, MSG_LIST_MAX);
+    MessageFreeListLimitInit(&partition->msgPayloadFreeListLimit,
+                             MSG_PAYLOAD_LIST_MAX);
+    MessageFreeListLimitInit(&partition->msgInfoFreeListLimit,
+                             MSG_INFO_LIST_MAX);
+
+    partition->msgRecycleMutex = new QNThreadMutex();
+    partition->msgReturnedBatches = NULL;
+    partition->msgDonatedBatches = NULL;
+    partition->msgDonatedBatchesNum = 0;
+    partition->msgDonationRequests = 0;
+}
+
+// /**
+// API       :: MESSAGE_ExchangeRecycleBatches
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Merge the batches handed back by worker thread caches into
+//              the partition free lists, and donate batches to workers
+//              that ran dry.  Must be called from the partition thread.
+// PARAMETERS ::
+// + partition:  PartitionData* : partition exchanging batches
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_ExchangeRecycleBatches(PartitionData *partition)
+{
+    MessageRecycleBatch* returned;
+    int requests;
+    {
+        QNThreadLock lock(partition->msgRecycleMutex);
+        if (partition->msgReturnedBatches == NULL
+            && partition->msgDonationRequests == 0)
+        {
+            return;
+        }
+        returned = partition->msgReturnedBatches;
+        partition->msgReturnedBatches = NULL;
+        requests = MIN(partition->msgDonationRequests,
+                       MSG_RECYCLE_DONATE_MAX
+                       - partition->msgDonatedBatchesNum);
+        partition->msgDonationRequests = 0;
+    }
+
+    // View the partition free lists as one batch
+    MessageRecycleBatch lists;
+    lists.msgList = partition->msgFreeList;
+    lists.msgNum = partition->msgFreeListNum;
+    lists.payloadList = partition->msgPayloadFreeList;
+    lists.payloadNum = partition->msgPayloadFreeListNum;
+    lists.infoList = partition->msgInfoFreeList;
+    lists.infoNum = partition->msgInfoFreeListNum;
+    lists.next = NULL;
+
+    while (returned != NULL)
+    {
+        MessageRecycleBatch* batch = returned;
+        returned = returned->next;
+
+        MessageRecycleBatchMove(&lists, batch, INT_MAX);
+        delete batch;
+    }
+
+    // Donate to the workers that asked, then release anything above the
+    // high-water marks.
+    for (int i = 0; i < requests; i++)
+    {
+        MessageRecycleBatch* batch = new MessageRecycleBatch;
+        memset(batch, 0, sizeof(MessageRecycleBatch));
+        MessageRecycleBatchMove(batch, &lists, MSG_RECYCLE_BATCH_SIZE);
+
+        QNThreadLock lock(partition->msgRecycleMutex);
+        batch->next = partition->msgDonatedBatches;
+        partition->msgDonatedBatches = batch;
+        partition->msgDonatedBatchesNum++;
+    }
+
+    MessageRecycleBatch excess;
+    memset(&excess, 0, sizeof(MessageRecycleBatch));
+    if (lists.msgNum > partition->msgFreeListLimit.highWater)
+    {
+        int num = lists.msgNum - partition->msgFreeListLimit.highWater;
+        partition->msgFreeListLimit.numDiscards += num;
+        for (int i = 0; i < num; i++)
+        {
+            Message* msg = lists.msgList;
+            lists.msgList = msg->next;
+            msg->next = excess.msgList;
+            excess.msgList = msg;
+        }
+        lists.msgNum -= num;
+    }
+    if (lists.payloadNum > partition->msgPayloadFreeListLimit.highWater)
+    {
+        int num = lists.payloadNum
+                  - partition->msgPayloadFreeListLimit.highWater;
+        partition->msgPayloadFreeListLimit.numDiscards += num;
+        for (int i = 0; i < num; i++)
+        {
+            MessagePayloadListCell* cell = lists.payloadList;
+            lists.payloadList = cell->next;
+            cell->next = excess.payloadList;
+            excess.payloadList = cell;
+        }
+        lists.payloadNum -= num;
+    }
+    if (lists.infoNum > partition->msgInfoFreeListLimit.highWater)
+    {
+        int num = lists.infoNum - partition->msgInfoFreeListLimit.highWater;
+        partition->msgInfoFreeListLimit.numDiscards += num;
+        for (int i = 0; i < num; i++)
+        {
+            MessageInfoListCell* cell = lists.infoList;
+            lists.infoList = cell->next;
+            cell->next = excess.infoList;
+            excess.infoList = cell;
+        }
+        lists.infoNum -= num;
+    }
+    MessageRecycleBatchRelease(&excess);
+
+    partition->msgFreeList = lists.msgList;
+    partition->msgFreeListNum = lists.msgNum;
+    partition->msgPayloadFreeList = lists.payloadList;
+    partition->msgPayloadFreeListNum = lists.payloadNum;
+    partition->msgInfoFreeList = lists.infoList;
+    partition->msgInfoFreeListNum = lists.infoNum;
+}
+
+Message::Message() : m_radioId(-1), sharedPayload(NULL), sharedInfo(NULL)
 {
 #ifdef TRACK_UNFREED_MESSAGES
     assert(gMessageSet.find(this) == gMessageSet.end());
@@ -106,6 +612,8 @@ Message::Message(const Message& m)
     gMessageSet.insert(this);
 #endif
 
+    sharedPayload = NULL;
+    sharedInfo = NULL;
     *this = m;
 
     // Not set using the = operator
@@ -118,6 +626,7 @@ Message::Message(
     int  protocol,
     int  eventType,
     bool isMT)
+    : sharedPayload(NULL), sharedInfo(NULL)
 {
 #ifdef TRACK_UNFREED_MESSAGES
     assert(gMessageSet.find(this) == gMessageSet.end());
@@ -139,9 +648,30 @@ void MESSAGE_FreeContents(PartitionData *partition, Message *msg)
     int i;
     bool wasMT = (msg->mtWasMT == TRUE);
 
+    // Shared buffers are only released by the last duplicate holding them
+    BOOL freePayload = TRUE;
+    if (msg->sharedPayload != NULL)
+    {
+        freePayload = MessageSharedRefRelease(msg->sharedPayload);
+        msg->sharedPayload = NULL;
+    }
+
+    BOOL freeSharedInfo = TRUE;
+    if (msg->sharedInfo != NULL)
+    {
+        freeSharedInfo = MessageSharedRefRelease(msg->sharedInfo);
+        msg->sharedInfo = NULL;
+    }
+
     if (msg->payloadSize > 0)
     {
-        MESSAGE_PayloadFree(partition, msg->payload, msg->payloadSize, wasMT);
+        if (freePayload)
+        {
+            MESSAGE_PayloadFree(partition,
+                                msg->payload,
+                                msg->payloadSize,
+                                wasMT);
+        }
         msg->payload = 0;
         msg->payloadSize = 0;
     }
@@ -151,7 +681,10 @@ void MESSAGE_FreeContents(PartitionData *partition, Message *msg)
         MessageInfoHeader* hdr = &(msg->infoArray[i]);
         if (hdr->infoSize > 0)
         {
-            MESSAGE_InfoFieldFree(partition, hdr, wasMT);
+            if (freeSharedInfo || !MessageInfoHasOwnBuffer(hdr))
+            {
+                MESSAGE_InfoFieldFree(partition, hdr, wasMT);
+            }
             hdr->infoSize = 0;
             hdr->info = NULL;
             hdr->infoType = INFO_TYPE_UNDEFINED;
@@ -223,8 +756,8 @@ void Message::initialize(PartitionData* partition)
     sequenceNumber        = 0;
     originatingProtocol   = 0;
     numberOfHeaders       = 0;
-    memset(headerProtocols, 0, sizeof(int) * MAX_HEADERS);
-    memset(headerSizes, 0, sizeof(int) * MAX_HEADERS);
+    headerProtocols.clear();
+    headerSizes.clear();
     relayNodeAddr         = 0;
     originatingProtocol   = -1;
     packetCreationTime    = partition->theCurrentTime;
@@ -235,19 +768,18 @@ void Message::initialize(PartitionData* partition)
     timerManager          = NULL;
     isScheduledOnMainHeap = false;
     timerExpiresAt        = 0;
+    timerHeapIndex        = -1;
     hdrLength             = 0;
+    sharedPayload         = NULL;
+    sharedInfo            = NULL;
     m_flags = 0;
 
     MESSAGE_SetLayer(this, DEFAULT_LAYER, TRACE_ANY_PROTOCOL);
     MESSAGE_SetEvent(this, MSG_DEFAULT);
 }
 
-void Message::operator = (const Message &msg)
+void Message::copyFields(const Message &msg)
 {
-    // copied the contents of MESSAGE_Duplicate to create this.
-
-    unsigned int i;
-
     next                = NULL;
     // this is important.  m_partitionData is used for allocating
     // info, payload, etc. so must be the current partition, not
@@ -290,13 +822,43 @@ void Message::operator = (const Message &msg)
     timerManager        = NULL;   // timers not serialized
     isScheduledOnMainHeap = true; // timers not serialized
     timerExpiresAt      = 0;      // timers not serialized
+    timerHeapIndex      = -1;     // timers not serialized
     hdrLength           = msg.hdrLength;
 
     m_flags = 0;
 
     memcpy(smallInfoSpace, msg.smallInfoSpace, SMALL_INFO_SPACE_SIZE);
-    memcpy(headerProtocols, msg.headerProtocols, sizeof(int) * MAX_HEADERS);
-    memcpy(headerSizes, msg.headerSizes, sizeof(int) * MAX_HEADERS);
+    headerProtocols.copy(msg.headerProtocols);
+    headerSizes.copy(msg.headerSizes);
+}
+
+void Message::operator = (const Message &msg)
+{
+    // copied the contents of MESSAGE_Duplicate to create this.
+
+    unsigned int i;
+
+    // Drop any buffers this message was sharing with another duplicate.
+    // The payload pointer is overwritten below without being freed, as it
+    // always has been, so only the reference needs to be released.
+    if (sharedPayload != NULL)
+    {
+        if (MessageSharedRefRelease(sharedPayload) && payloadSize > 0)
+        {
+            MESSAGE_PayloadFree(m_partitionData, payload, payloadSize,
+                                mtWasMT);
+        }
+        sharedPayload = NULL;
+        payload = NULL;
+    }
+    BOOL freeSharedInfo = TRUE;
+    if (sharedInfo != NULL)
+    {
+        freeSharedInfo = MessageSharedRefRelease(sharedInfo);
+        sharedInfo = NULL;
+    }
+
+    copyFields(msg);
 
     if (payloadSize == 0) {
         payload = NULL;
@@ -322,7 +884,8 @@ void Message::operator = (const Message &msg)
         for (i = 0; i < infoArray.size(); i++)
         {
             MessageInfoHeader* hdr = &(infoArray[i]);
-            if (hdr->infoSize > 0)
+            if (hdr->infoSize > 0
+                && (freeSharedInfo || !MessageInfoHasOwnBuffer(hdr)))
             {
                 MESSAGE_InfoFieldFree(m_partitionData, hdr, mtWasMT == TRUE);
             }
@@ -532,18 +1095,38 @@ Message* MESSAGE_Alloc(PartitionData *partition,
     newMsg = new Message();
 #else
     // When called from a worker context, we can't use the partition
-    // data FreeList (it isn't locked)
-    if ((partition->msgFreeList == NULL) || (isMT))
+    // data FreeList (it isn't locked).  Use the thread's cache instead.
+    if (isMT)
     {
-        newMsg = new Message();
-        newMsg->infoArray.reserve(10);
+        MessageRecycleBatch* cache = MessageGetThreadCache(partition);
+        if (cache->msgList == NULL)
+        {
+            MessageThreadCacheRefill(partition, cache);
+        }
+        if (cache->msgList != NULL)
+        {
+            newMsg = cache->msgList;
+            cache->msgList = newMsg->next;
+            cache->msgNum--;
+        }
     }
     else
     {
-        newMsg = partition->msgFreeList;
-        partition->msgFreeList =
-            partition->msgFreeList->next;
-        (partition->msgFreeListNum)--;
+        MessageFreeListTrackAlloc(&partition->msgFreeListLimit,
+                                  partition->msgFreeListNum);
+        if (partition->msgFreeList != NULL)
+        {
+            newMsg = partition->msgFreeList;
+            partition->msgFreeList =
+                partition->msgFreeList->next;
+            (partition->msgFreeListNum)--;
+        }
+    }
+
+    if (newMsg == NULL)
+    {
+        newMsg = new Message();
+        newMsg->infoArray.reserve(10);
     }
 #endif
     assert(newMsg != NULL);
@@ -597,7 +1180,7 @@ char* MESSAGE_InfoFieldAlloc(PartitionData *partition, int infoSize, bool isMT)
     const bool recycle = true;
 #endif
 
-    bool useRecycled = (recycle && !isMT && partition != NULL);
+    bool useRecycled = (recycle && partition != NULL);
 
     if (infoSize > SMALL_INFO_SPACE_SIZE || !useRecycled)
     {
@@ -607,7 +1190,30 @@ char* MESSAGE_InfoFieldAlloc(PartitionData *partition, int infoSize, bool isMT)
     }
     else
     {
-        if ((partition->msgInfoFreeList == NULL) || ((isMT)) )
+        MessageRecycleBatch* cache = NULL;
+        if (isMT)
+        {
+            cache = MessageGetThreadCache(partition);
+            if (cache->infoList == NULL)
+            {
+                MessageThreadCacheRefill(partition, cache);
+            }
+            if (cache->infoList != NULL)
+            {
+                newInfo = (char*) &(cache->infoList->infoMemory[0]);
+                cache->infoList = cache->infoList->next;
+                cache->infoNum--;
+                memset(newInfo, 0, SMALL_INFO_SPACE_SIZE);
+                return newInfo;
+            }
+        }
+        else
+        {
+            MessageFreeListTrackAlloc(&partition->msgInfoFreeListLimit,
+                                      partition->msgInfoFreeListNum);
+        }
+
+        if ((partition->msgInfoFreeList == NULL) || (isMT))
         {
             MessageInfoListCell* NewCell = (MessageInfoListCell*)
                 MEM_malloc(sizeof(MessageInfoListCell));
@@ -661,11 +1267,24 @@ void MESSAGE_InfoFieldFree(
         MEM_free(hdrPtr->info);
     }
 #else
-    if ((partition != NULL &&
+    if (partition != NULL &&
         hdrPtr->infoType != INFO_TYPE_DEFAULT &&
         hdrPtr->infoSize <= SMALL_INFO_SPACE_SIZE &&
-        (wasMT == false) &&
-        partition->msgInfoFreeListNum < MSG_INFO_LIST_MAX))
+        wasMT)
+    {
+        MessageRecycleBatch* cache = MessageGetThreadCache(partition);
+        MessageInfoListCell* cellPtr =
+            (MessageInfoListCell*)hdrPtr->info;
+        cellPtr->next = cache->infoList;
+        cache->infoList = cellPtr;
+        cache->infoNum++;
+        MessageThreadCacheTrim(partition, cache);
+    }
+    else if ((partition != NULL &&
+        hdrPtr->infoType != INFO_TYPE_DEFAULT &&
+        hdrPtr->infoSize <= SMALL_INFO_SPACE_SIZE &&
+        partition->msgInfoFreeListNum
+            < partition->msgInfoFreeListLimit.highWater))
     {
         MessageInfoListCell* cellPtr =
             (MessageInfoListCell*)hdrPtr->info;
@@ -676,6 +1295,10 @@ void MESSAGE_InfoFieldFree(
     else if (hdrPtr->infoType != INFO_TYPE_DEFAULT ||
              hdrPtr->infoSize > SMALL_INFO_SPACE_SIZE)
     {
+        if (partition != NULL && hdrPtr->infoSize <= SMALL_INFO_SPACE_SIZE)
+        {
+            partition->msgInfoFreeListLimit.numDiscards++;
+        }
         MEM_free(hdrPtr->info);
     }
     else
@@ -750,6 +1373,8 @@ char* MESSAGE_AddInfo(PartitionData *partition,
 
     ERROR_Assert(infoSize != 0, "Cannot add empty info");
 
+    MessageUnshareInfo(partition, msg);
+
     if (infoType == INFO_TYPE_DEFAULT)
     {
         // First check if there is already a default type
@@ -911,6 +1536,8 @@ void MESSAGE_RemoveInfo(Node *node, Message *msg, unsigned short infoType)
     unsigned int i;
     MessageInfoHeader* hdrPtrInfo = NULL;
 
+    MessageUnshareInfo(node->partitionData, msg);
+
     // Remove the info field from the vector info Array.
     for (i = 0; i < msg->infoArray.size(); i ++)
     {
@@ -958,6 +1585,9 @@ void MESSAGE_RemoveInfo(Node *node,
 {
     MessageInfoHeader* hdrPtr = NULL;
     int i;
+
+    MessageUnshareInfo(node->partitionData, msg);
+
     int infoLowerLimit  =
         msg->infoBookKeeping.at(fragmentNumber).infoLowerLimit;
     int infoUpperLimit =
@@ -1010,6 +1640,8 @@ void MESSAGE_CopyInfo(Node *node, Message *dstMsg, Message *srcMsg)
     memset(&infoHdr, 0, sizeof(MessageInfoHeader));
     bool insertInfo = false;
 
+    MessageUnshareInfo(node->partitionData, dstMsg);
+
     for (i = 0; i < srcMsg->infoArray.size(); i++)
     {
         MessageInfoHeader* srcHdrPtr = &(srcMsg->infoArray[i]);
@@ -1117,6 +1749,9 @@ char* MESSAGE_AppendInfo(PartitionData *partitionData,
                          unsigned short infoType)
 {
     MessageInfoHeader infoHdr;
+
+    MessageUnshareInfo(partitionData, msg);
+
     if (infoType == INFO_TYPE_DEFAULT)
     {
         // Check if we already have a default info in the destination message
@@ -1186,6 +1821,9 @@ void MESSAGE_AppendInfo(Node *node, Message *dstMsg, Message *srcMsg)
     MessageInfoHeader infoHdr;
     MessageInfoHeader* hdrPtr = NULL;
     bool isDefaultInfo = false;
+
+    MessageUnshareInfo(node->partitionData, dstMsg);
+
     // copy the header fields
 
     // Check if we already have a default info in the destination message
@@ -1253,6 +1891,9 @@ void MESSAGE_AppendInfo(
     MessageInfoHeader* hdrPtr = NULL;
     MessageInfoHeader infoHdr;
     bool isDefaultInfo = false;
+
+    MessageUnshareInfo(node->partitionData, dstMsg);
+
     // copy the header fields
 
     // Check if we already have a default info in the destination message
@@ -1389,8 +2030,8 @@ void MESSAGE_PacketAlloc(PartitionData *partition,
     //application.  
     if (originatingProtocol != TRACE_UNDEFINED)
     {
-        msg->headerProtocols[msg->numberOfHeaders] = originatingProtocol;
-        msg->headerSizes[msg->numberOfHeaders] = packetSize;
+        msg->headerProtocols.set(msg->numberOfHeaders, originatingProtocol);
+        msg->headerSizes.set(msg->numberOfHeaders, packetSize);
         msg->numberOfHeaders++;
     }
 }
@@ -1417,6 +2058,8 @@ void MESSAGE_AddHeader(Node *node,
                        int hdrSize,
                        TraceProtocolType traceProtocol)
 {
+    MessageUnsharePayload(node->partitionData, msg);
+
     msg->packet -= hdrSize;
     msg->packetSize += hdrSize;
 
@@ -1424,8 +2067,8 @@ void MESSAGE_AddHeader(Node *node,
     {
         msg->actualPktSize += hdrSize;
     }
-    msg->headerProtocols[msg->numberOfHeaders] = traceProtocol;
-    msg->headerSizes[msg->numberOfHeaders] = hdrSize;
+    msg->headerProtocols.set(msg->numberOfHeaders, traceProtocol);
+    msg->headerSizes.set(msg->numberOfHeaders, hdrSize);
     msg->numberOfHeaders++;
 
     if (msg->packet < msg->payload) {
@@ -1513,6 +2156,8 @@ void MESSAGE_ExpandPacket(Node *node,
                           Message *msg,
                           int size)
 {
+    MessageUnsharePayload(node->partitionData, msg);
+
     msg->packet -= size;
     msg->packetSize += size;
 
@@ -1602,9 +2247,20 @@ void MESSAGE_Free(PartitionData *partition, Message *msg)
 
 #ifndef MESSAGE_NO_RECYCLE
     // Message recycling is enabled
-    if ((partition != NULL) &&
-        (wasMT == false) &&
-        (partition->msgFreeListNum < MSG_LIST_MAX))
+    if ((partition != NULL) && wasMT)
+    {
+        // Possibly on a worker thread: keep it in this thread's cache
+        MESSAGE_FreeContents(partition, msg);
+        msg->setFreed(true);
+
+        MessageRecycleBatch* cache = MessageGetThreadCache(partition);
+        msg->next = cache->msgList;
+        cache->msgList = msg;
+        cache->msgNum++;
+        MessageThreadCacheTrim(partition, cache);
+    }
+    else if ((partition != NULL) &&
+        (partition->msgFreeListNum < partition->msgFreeListLimit.highWater))
     {
         // Free contents and save to list
         MESSAGE_FreeContents(partition, msg);
@@ -1617,6 +2273,10 @@ void MESSAGE_Free(PartitionData *partition, Message *msg)
     else
     {
         // Delete message completely
+        if (partition != NULL)
+        {
+            partition->msgFreeListLimit.numDiscards++;
+        }
         delete msg;
     }
 #endif
@@ -1683,11 +2343,169 @@ Message* MESSAGE_Duplicate(
                                     isMT);
 
     assert(newMsg != NULL);
-    *newMsg = *msg;
+
+    if (!partition->msgCopyOnWrite || isMT || msg->mtWasMT)
+    {
+        *newMsg = *msg;
+        return newMsg;
+    }
+
+    // Copy-on-write: share the payload and the separately allocated info
+    // buffers with the original.  They are copied by MESSAGE_AddHeader,
+    // MESSAGE_ExpandPacket, the info field functions or
+    // MESSAGE_MakeWritable the first time either message modifies them.
+    unsigned int i;
+
+    newMsg->copyFields(*msg);
+
+    if (msg->payloadSize > 0)
+    {
+        if (msg->sharedPayload == NULL)
+        {
+            msg->sharedPayload = MessageSharedRefAlloc();
+        }
+        UTIL_AtomicIncrement(&msg->sharedPayload->refCount);
+        newMsg->sharedPayload = msg->sharedPayload;
+        newMsg->payload = msg->payload;
+        newMsg->packet = msg->packet;
+        partition->msgPayloadCopiesAvoided++;
+    }
+
+    newMsg->infoArray = msg->infoArray;
+    int numShared = 0;
+    for (i = 0; i < newMsg->infoArray.size(); i++)
+    {
+        MessageInfoHeader* hdrPtr = &(newMsg->infoArray[i]);
+        if (hdrPtr->infoSize == 0)
+        {
+            continue;
+        }
+        if (MessageInfoHasOwnBuffer(hdrPtr))
+        {
+            numShared++;
+        }
+        else
+        {
+            hdrPtr->info = (char*)&(newMsg->smallInfoSpace[0]);
+        }
+    }
+    if (numShared > 0)
+    {
+        if (msg->sharedInfo == NULL)
+        {
+            msg->sharedInfo = MessageSharedRefAlloc();
+        }
+        UTIL_AtomicIncrement(&msg->sharedInfo->refCount);
+        newMsg->sharedInfo = msg->sharedInfo;
+        partition->msgInfoCopiesAvoided += numShared;
+    }
+    newMsg->infoBookKeeping = msg->infoBookKeeping;
 
     return newMsg;
 }
 
+// /**
+// API       :: MESSAGE_MakeWritable
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Give the message a private copy of its payload and info
+//              fields if they are currently shared with other duplicates.
+// PARAMETERS ::
+// + node    :  Node*    : node which is going to modify the message
+// + msg     :  Message* : message to make writable
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_MakeWritable(Node *node, Message *msg)
+{
+    MESSAGE_MakeWritable(node->partitionData, msg);
+}
+
+// /**
+// API       :: MESSAGE_MakeWritable
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Give the message a private copy of its payload and info
+//              fields if they are currently shared with other duplicates.
+// PARAMETERS ::
+// + partition:  PartitionData* : partition which is going to modify the message
+// + msg     :  Message* : message to make writable
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_MakeWritable(PartitionData *partition, Message *msg)
+{
+    MessageUnsharePayload(partition, msg);
+    MessageUnshareInfo(partition, msg);
+}
+
+// /**
+// API       :: MESSAGE_ReturnWritablePacket
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Returns a pointer to the packet of the message after giving
+//              the message a private copy of its payload if it is shared
+//              with other duplicates.
+// PARAMETERS ::
+// + node    :  Node*    : node which is going to modify the packet
+// + msg     :  Message* : message whose packet is returned
+// RETURN    :: char* : Pointer to the writable packet
+// **/
+char* MESSAGE_ReturnWritablePacket(Node *node, Message *msg)
+{
+    MessageUnsharePayload(node->partitionData, msg);
+    return MESSAGE_ReturnPacket(msg);
+}
+
+// /**
+// API       :: MESSAGE_ReturnWritableInfo
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Returns a pointer to the "info" field with given info type
+//              after giving the message private copies of its info fields
+//              if they are shared with other duplicates.
+// PARAMETERS ::
+// + node    :  Node*    : node which is going to modify the info field
+// + msg     :  Message* : message for which "info" field
+//                         has to be returned
+// + infoType:  unsigned short : type of the "info" field to be returned.
+// RETURN    :: char* : Pointer to the writable "info" field with given
+//                      type.  NULL if not found.
+// **/
+char* MESSAGE_ReturnWritableInfo(Node *node,
+                                 Message *msg,
+                                 unsigned short infoType)
+{
+    MessageUnshareInfo(node->partitionData, msg);
+    return MESSAGE_ReturnInfo(msg, infoType);
+}
+
+// /**
+// API       :: MESSAGE_PrintCopyOnWriteStats
+// LAYER     :: ANY LAYER
+// PURPOSE   :: Print to the statistics file how many payload and info
+//              copies the copy-on-write duplicate path avoided and made
+//              on the partition of the node.
+// PARAMETERS ::
+// + node    :  Node*    : node printing the partition statistics
+// RETURN    :: void : NULL
+// **/
+void MESSAGE_PrintCopyOnWriteStats(Node *node)
+{
+    PartitionData* partition = node->partitionData;
+    char buf[MAX_STRING_LENGTH];
+
+    sprintf(buf, "Payload Copies Avoided = %" TYPES_64BITFMT "d",
+            partition->msgPayloadCopiesAvoided);
+    IO_PrintStat(node, "Kernel", "MessageCopyOnWrite", ANY_DEST, -1, buf);
+
+    sprintf(buf, "Payload Copies Made = %" TYPES_64BITFMT "d",
+            partition->msgPayloadCopiesMade);
+    IO_PrintStat(node, "Kernel", "MessageCopyOnWrite", ANY_DEST, -1, buf);
+
+    sprintf(buf, "Info Copies Avoided = %" TYPES_64BITFMT "d",
+            partition->msgInfoCopiesAvoided);
+    IO_PrintStat(node, "Kernel", "MessageCopyOnWrite", ANY_DEST, -1, buf);
+
+    sprintf(buf, "Info Copies Made = %" TYPES_64BITFMT "d",
+            partition->msgInfoCopiesMade);
+    IO_PrintStat(node, "Kernel", "MessageCopyOnWrite", ANY_DEST, -1, buf);
+}
+
 
 /*
  * FUNCTION     MESSAGE_PayloadAlloc
@@ -1727,6 +2545,28 @@ char* MESSAGE_PayloadAlloc(PartitionData *partition,
         memset(ptr, 0, payloadSize);
         return ptr;
 #else
+        if (isMT)
+        {
+            MessageRecycleBatch* cache = MessageGetThreadCache(partition);
+            if (cache->payloadList == NULL)
+            {
+                MessageThreadCacheRefill(partition, cache);
+            }
+            if (cache->payloadList != NULL)
+            {
+                char *payload = (char *)
+                    &(cache->payloadList->payloadMemory[0]);
+                cache->payloadList = cache->payloadList->next;
+                cache->payloadNum--;
+                return payload;
+            }
+        }
+        else
+        {
+            MessageFreeListTrackAlloc(&partition->msgPayloadFreeListLimit,
+                                      partition->msgPayloadFreeListNum);
+        }
+
         if ((partition->msgPayloadFreeList == NULL) || (isMT))
         {
             MessagePayloadListCell* NewCell = (MessagePayloadListCell*)
@@ -1783,8 +2623,20 @@ void MESSAGE_PayloadFree(PartitionData *partition,
 #else
     if ((partition != NULL) &&
         (payloadSize <= MAX_CACHED_PAYLOAD_SIZE) &&
-        (wasMT == false) &&
-        (partition->msgPayloadFreeListNum < MSG_PAYLOAD_LIST_MAX))
+        wasMT)
+    {
+        MessageRecycleBatch* cache = MessageGetThreadCache(partition);
+        MessagePayloadListCell* cellPtr =
+            (MessagePayloadListCell*)payload;
+        cellPtr->next = cache->payloadList;
+        cache->payloadList = cellPtr;
+        cache->payloadNum++;
+        MessageThreadCacheTrim(partition, cache);
+    }
+    else if ((partition != NULL) &&
+        (payloadSize <= MAX_CACHED_PAYLOAD_SIZE) &&
+        (partition->msgPayloadFreeListNum
+            < partition->msgPayloadFreeListLimit.highWater))
     {
         MessagePayloadListCell* cellPtr =
             (MessagePayloadListCell*)payload;
@@ -1794,6 +2646,10 @@ void MESSAGE_PayloadFree(PartitionData *partition,
     }
     else
     {
+        if (partition != NULL && payloadSize <= MAX_CACHED_PAYLOAD_SIZE)
+        {
+            partition->msgPayloadFreeListLimit.numDiscards++;
+        }
         MEM_free(payload);
     }
 #endif
@@ -1915,8 +2771,8 @@ void MESSAGE_FragmentPacket(
 
         for (i = 0; i < msg->numberOfHeaders; i ++)
         {
-            (*fragList)[0]->headerProtocols[i] = msg->headerProtocols[i];
-            (*fragList)[0]->headerSizes[i] = msg->headerSizes[i];
+            (*fragList)[0]->headerProtocols.set(i, msg->headerProtocols[i]);
+            (*fragList)[0]->headerSizes.set(i, msg->headerSizes[i]);
         }
 
         MESSAGE_Free(node, msg);
@@ -1983,8 +2839,8 @@ Message* MESSAGE_ReassemblePacket(
     msg->numberOfHeaders = fragList[0]->numberOfHeaders;
     for (i = 0; i < msg->numberOfHeaders; i ++)
     {
-        msg->headerProtocols[i] = fragList[0]->headerProtocols[i];
-        msg->headerSizes[i] = fragList[0]->headerSizes[i];
+        msg->headerProtocols.set(i, fragList[0]->headerProtocols[i]);
+        msg->headerSizes.set(i, fragList[0]->headerSizes[i]);
     }
 
     // reassemble the payload
@@ -2060,6 +2916,16 @@ void MESSAGE_Serialize(Node* node,
         buffer.append((char*)&bookKeep, sizeof(bookKeep));
     }
 
+    // The trace header arrays live outside the Message object, so the
+    // raw copy above only carries their pointers.  Append the values.
+    const Message* constMsg = msg;
+    for (int i = 0; i < msg->numberOfHeaders; i++)
+    {
+        int headerProtocol = constMsg->headerProtocols[i];
+        int headerSize = constMsg->headerSizes[i];
+        buffer.append((char*)&headerProtocol, sizeof(headerProtocol));
+        buffer.append((char*)&headerSize, sizeof(headerSize));
+    }
 }
 
 // FUNCTION   :: MESSAGE_Unserialize
@@ -2189,6 +3055,7 @@ Message* MESSAGE_Unserialize(PartitionData* partitionData,
         newMsg->timerManager        = NULL;   // timers not serialized
         newMsg->isScheduledOnMainHeap = true; // timers not serialized
         newMsg->timerExpiresAt      = 0;      // timers not serialized
+        newMsg->timerHeapIndex      = -1;     // timers not serialized
         newMsg->hdrLength           = tmpMsg->hdrLength;
 
         if (newMsg->isPacked)
@@ -2198,8 +3065,16 @@ Message* MESSAGE_Unserialize(PartitionData* partitionData,
 
         for (i = 0; i < newMsg->numberOfHeaders; i++)
         {
-            newMsg->headerProtocols[i] = tmpMsg->headerProtocols[i];
-            newMsg->headerSizes[i]     = tmpMsg->headerSizes[i];
+            int headerProtocol;
+            int headerSize;
+
+            memcpy(&headerProtocol, &buffer[bufIndex], sizeof(int));
+            bufIndex += sizeof(int);
+            memcpy(&headerSize, &buffer[bufIndex], sizeof(int));
+            bufIndex += sizeof(int);
+
+            newMsg->headerProtocols.set(i, headerProtocol);
+            newMsg->headerSizes.set(i, headerSize);
         }
     }
 
@@ -2822,9 +3697,9 @@ MESSAGE_FragmentPacket(
                 //copy headers
                 for (int j = 0; j < msg->numberOfHeaders; j++)
                 {
-                    fragList[i]->headerProtocols[j] =
-                                     msg->headerProtocols[j];
-                    fragList[i]->headerSizes[j] = msg->headerSizes[j];
+                    fragList[i]->headerProtocols.set(j,
+                                     msg->headerProtocols[j]);
+                    fragList[i]->headerSizes.set(j, msg->headerSizes[j]);
                 }
             }
         } //end for loop
@@ -2911,8 +3786,8 @@ MESSAGE_ReassemblePacket(
     //copy headers from the first fragment
     for (i = 0; i < fragList[0]->numberOfHeaders; i ++)
     {
-        msg->headerProtocols[i] = fragList[0]->headerProtocols[i];
-        msg->headerSizes[i] = fragList[0]->headerSizes[i];
+        msg->headerProtocols.set(i, fragList[0]->headerProtocols[i]);
+        msg->headerSizes.set(i, fragList[0]->headerSizes[i]);
     }
 
     // copy other simulation specific information from the first fragment
@@ -0,0 +1,309 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+//
+// Benchmark of the Message layout: bytes per in-flight event and
+// scheduler throughput of the current Message compared with the layout
+// it replaced, in which the trace arrays were part of every Message and
+// the fields read by the scheduler were spread over the object.
+//
+//   message_bench [in-flight events [events [packet percentage]]]
+//
+// Each layout is measured by keeping the given number of events
+// in-flight in a binary heap ordered by (eventTime, naturalOrder), as
+// the scheduler does, and repeatedly dispatching the earliest event and
+// scheduling it again.  Dispatching reads the layer, protocol and event
+// type of the event.  The given percentage of the events are packets,
+// which carry trace arrays; with the current layout their storage is
+// allocated outside the Message.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+#include "api.h"
+
+#define BENCH_DEFAULT_IN_FLIGHT   100000
+#define BENCH_DEFAULT_EVENTS      10000000
+#define BENCH_DEFAULT_PACKETS     20
+
+// Message as laid out before the hot fields were grouped and the trace
+// arrays moved out of the object
+class BaselineMessage
+{
+public:
+    virtual ~BaselineMessage() {}
+
+    UInt8 m_flags;
+    Message*  next;
+    PartitionData* m_partitionData;
+    short layerType;
+    short protocolType;
+    short instanceId;
+    short m_radioId;
+    short eventType;
+    unsigned int naturalOrder;
+    char error;
+    bool mtWasMT;
+    bool allowLoose;
+    NodeId nodeId;
+    clocktype eventTime;
+    clocktype eot;
+    int sourcePartitionId;
+    double smallInfoSpace[SMALL_INFO_SPACE_SIZE / sizeof(double)];
+    int packetSize;
+    char *packet;
+    char *payload;
+    int payloadSize;
+    int virtualPayloadSize;
+    clocktype packetCreationTime;
+    clocktype pktNetworkSendTime;
+    bool cancelled;
+    NodeAddress originatingNodeId;
+    int sequenceNumber;
+    int originatingProtocol;
+    int numberOfHeaders;
+    int headerProtocols[MAX_HEADERS];
+    int headerSizes[MAX_HEADERS];
+    NodeAddress relayNodeAddr;
+    std::vector<MessageInfoHeader> infoArray;
+    std::vector<MessageInfoBookKeeping> infoBookKeeping;
+    int subChannelIndex;
+    BOOL isPacked;
+    int actualPktSize;
+    bool isEmulationPacket;
+    TimerManager* timerManager;
+    bool isScheduledOnMainHeap;
+    clocktype timerExpiresAt;
+    int hdrLength;
+};
+
+// Where the fields used by the benchmark are in a layout
+struct BenchLayout
+{
+    const char* name;
+    int size;
+    int hotSize;            // bytes up to the first cold field, 0 if none
+    int eventTimeOffset;
+    int naturalOrderOffset;
+    int layerTypeOffset;
+    int protocolTypeOffset;
+    int eventTypeOffset;
+    int packetExtraSize;    // bytes allocated outside the object for a
+                            // packet
+};
+
+#define BENCH_OFFSET(type, field) \
+    ((int) ((char*) &((type*) probe)->field - probe))
+
+static BenchLayout BenchCurrentLayout()
+{
+    // The objects are never constructed, only their field addresses
+    // are taken
+    static double probeSpace[sizeof(Message) / sizeof(double) + 1];
+    char* probe = (char*) probeSpace;
+    BenchLayout layout;
+
+    layout.name = "Message";
+    layout.size = (int) sizeof(Message);
+    layout.hotSize = BENCH_OFFSET(Message, eot);
+    layout.eventTimeOffset = BENCH_OFFSET(Message, eventTime);
+    layout.naturalOrderOffset = BENCH_OFFSET(Message, naturalOrder);
+    layout.layerTypeOffset = BENCH_OFFSET(Message, layerType);
+    layout.protocolTypeOffset = BENCH_OFFSET(Message, protocolType);
+    layout.eventTypeOffset = BENCH_OFFSET(Message, eventType);
+    layout.packetExtraSize = 2 * MAX_HEADERS * sizeof(int);
+    return layout;
+}
+
+static BenchLayout BenchBaselineLayout()
+{
+    static double probeSpace[sizeof(BaselineMessage) / sizeof(double) + 1];
+    char* probe = (char*) probeSpace;
+    BenchLayout layout;
+
+    layout.name = "baseline Message";
+    layout.size = (int) sizeof(BaselineMessage);
+    layout.hotSize = 0;
+    layout.eventTimeOffset = BENCH_OFFSET(BaselineMessage, eventTime);
+    layout.naturalOrderOffset =
+        BENCH_OFFSET(BaselineMessage, naturalOrder);
+    layout.layerTypeOffset = BENCH_OFFSET(BaselineMessage, layerType);
+    layout.protocolTypeOffset = BENCH_OFFSET(BaselineMessage, protocolType);
+    layout.eventTypeOffset = BENCH_OFFSET(BaselineMessage, eventType);
+    layout.packetExtraSize = 0;
+    return layout;
+}
+
+static const BenchLayout* s_layout = NULL;
+
+static clocktype BenchEventTime(const char* event)
+{
+    return *(const clocktype*) (event + s_layout->eventTimeOffset);
+}
+
+static unsigned int BenchNaturalOrder(const char* event)
+{
+    return *(const unsigned int*) (event + s_layout->naturalOrderOffset);
+}
+
+// Heap order: the earliest event, then the lowest natural order, first
+static bool BenchLater(const char* a, const char* b)
+{
+    clocktype timeA = BenchEventTime(a);
+    clocktype timeB = BenchEventTime(b);
+
+    if (timeA != timeB)
+    {
+        return timeA > timeB;
+    }
+    return BenchNaturalOrder(a) > BenchNaturalOrder(b);
+}
+
+static UInt32 BenchRandom(UInt32* seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static void BenchRun(const BenchLayout& layout,
+                     int numInFlight,
+                     Int64 numEvents,
+                     int packetPercentage)
+{
+    std::vector<char*> heap;
+    std::vector<int*> traceArrays;
+    UInt32 seed = 1;
+    unsigned int naturalOrder = 0;
+    Int64 dispatchSum = 0;
+    int numPackets = 0;
+    int i;
+
+    s_layout = &layout;
+
+    // Events are allocated one by one, as the scheduler receives them
+    for (i = 0; i < numInFlight; i++)
+    {
+        char* event = new char[layout.size];
+        memset(event, 0, layout.size);
+
+        *(clocktype*) (event + layout.eventTimeOffset) =
+            BenchRandom(&seed) % (100 * MILLI_SECOND);
+        *(unsigned int*) (event + layout.naturalOrderOffset) =
+            naturalOrder++;
+        *(short*) (event + layout.layerTypeOffset) = (short) (i % 8);
+        *(short*) (event + layout.protocolTypeOffset) = (short) (i % 32);
+        *(short*) (event + layout.eventTypeOffset) = (short) (i % 64);
+
+        if ((int) (BenchRandom(&seed) % 100) < packetPercentage)
+        {
+            numPackets++;
+            if (layout.packetExtraSize > 0)
+            {
+                traceArrays.push_back(new int[2 * MAX_HEADERS]);
+            }
+        }
+        heap.push_back(event);
+    }
+    std::make_heap(heap.begin(), heap.end(), BenchLater);
+
+    clock_t start = clock();
+    for (Int64 n = 0; n < numEvents; n++)
+    {
+        std::pop_heap(heap.begin(), heap.end(), BenchLater);
+        char* event = heap.back();
+
+        dispatchSum += *(short*) (event + layout.layerTypeOffset)
+                       + *(short*) (event + layout.protocolTypeOffset)
+                       + *(short*) (event + layout.eventTypeOffset);
+
+        *(clocktype*) (event + layout.eventTimeOffset) +=
+            1 + BenchRandom(&seed) % (10 * MILLI_SECOND);
+        *(unsigned int*) (event + layout.naturalOrderOffset) =
+            naturalOrder++;
+        std::push_heap(heap.begin(), heap.end(), BenchLater);
+    }
+    double elapsed = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    double bytesPerEvent =
+        layout.size
+        + (double) numPackets * layout.packetExtraSize / numInFlight;
+
+    printf("%-18s %8d %8d %14.1f %14.0f   (%" TYPES_64BITFMT "d)\n",
+           layout.name,
+           layout.size,
+           layout.hotSize,
+           bytesPerEvent,
+           elapsed > 0.0 ? numEvents / elapsed : 0.0,
+           dispatchSum);
+
+    for (i = 0; i < (int) heap.size(); i++)
+    {
+        delete [] heap[i];
+    }
+    for (i = 0; i < (int) traceArrays.size(); i++)
+    {
+        delete [] traceArrays[i];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int numInFlight = BENCH_DEFAULT_IN_FLIGHT;
+    Int64 numEvents = BENCH_DEFAULT_EVENTS;
+    int packetPercentage = BENCH_DEFAULT_PACKETS;
+
+    if (argc > 1)
+    {
+        numInFlight = atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        numEvents = atoi(argv[2]);
+    }
+    if (argc > 3)
+    {
+        packetPercentage = atoi(argv[3]);
+    }
+    if (numInFlight <= 0 || numEvents <= 0
+        || packetPercentage < 0 || packetPercentage > 100)
+    {
+        fprintf(stderr,
+                "Usage: %s [in-flight events [events "
+                "[packet percentage]]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    BenchLayout baseline = BenchBaselineLayout();
+    BenchLayout current = BenchCurrentLayout();
+
+    printf("%d events in-flight, %" TYPES_64BITFMT "d dispatched, "
+           "%d%% packets\n",
+           numInFlight, numEvents, packetPercentage);
+    printf("%-18s %8s %8s %14s %14s\n",
+           "Layout", "sizeof", "hot", "bytes/event", "events/s");
+
+    BenchRun(baseline, numInFlight, numEvents, packetPercentage);
+    BenchRun(current, numInFlight, numEvents, packetPercentage);
+
+    return 0;
+}
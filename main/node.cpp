@@ -242,7 +242,7 @@ NODE_ProcessEvent(Node *node, Message *msg)
 
     if (msg->timerManager)
     {
-        msg->timerManager->scheduleNextTimer();
+        msg->timerManager->timerExpired(msg);
     }
 
     if (msg->cancelled)
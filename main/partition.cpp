@@ -49,6 +49,8 @@ using namespace std;
 
 #include "external_util.h"
 #include "scheduler.h"
+#include "sched_ladder.h"
+#include "app_stats_store.h"
 #include "WallClock.h"
 #include "stats_global.h"
 #include "context.h"
@@ -115,9 +117,6 @@ using namespace std;
 #endif
 
 
-//gss xd
-extern deque<APPStatsNew> g_APPStatsNew_deque;
-
 /* FUNCTION     PARTITION_PrintUsage
  * PURPOSE      Prints the command-line usage of the application.
  *
@@ -553,6 +552,9 @@ void PARTITION_GlobalInit(NodeInput* nodeInput,
                                        numberOfProcessors,
                                        experimentPrefix);
 
+    // Index the configuration before the partitions start reading it
+    IO_BuildNodeInputIndex(nodeInput);
+
 #if defined(ADDON_DB)
     extern DatabaseInterlock dbInterlock;
 
@@ -618,6 +620,7 @@ PartitionData* PARTITION_CreateEmptyPartition(
     partitionData->numChannels = 0;
     partitionData->numFixedChannels = 0;
     partitionData->propChannel = NULL;
+    partitionData->pathLossMatrix = NULL;
 
 #ifdef ADDON_NGCNMS
     partitionData->gridInfo = NULL;
@@ -643,9 +646,16 @@ PartitionData* PARTITION_CreateEmptyPartition(
     partitionData->msgInfoFreeList = NULL;
     partitionData->splayNodeFreeListNum = 0;
     partitionData->splayNodeFreeList = NULL;
+    MESSAGE_InitializeRecycling(partitionData);
+    partitionData->msgCopyOnWrite = FALSE;
+    partitionData->msgPayloadCopiesAvoided = 0;
+    partitionData->msgPayloadCopiesMade = 0;
+    partitionData->msgInfoCopiesAvoided = 0;
+    partitionData->msgInfoCopiesMade = 0;
     partitionData->eventSequence = 0;
     memset(&partitionData->heapSplayTree, 0, sizeof(HeapSplayTree));
     partitionData->heapStdlib = NULL;
+    partitionData->ladderQueue = NULL;
     memset(&partitionData->mobilityHeap, 0, sizeof(MobilityHeap));
     partitionData->looseEvsHeap = NULL;
     memset(&partitionData->genericEventTree, 0, sizeof(SimpleSplayTree));
@@ -659,6 +669,7 @@ PartitionData* PARTITION_CreateEmptyPartition(
     partitionData->statFd = NULL;
     partitionData->traceEnabled = FALSE;
     partitionData->traceFd = NULL;
+    partitionData->traceBinary = NULL;
     partitionData->activeNode = NULL;
     partitionData->realTimeLogEnabled = FALSE;
     partitionData->realTimeFd = NULL;
@@ -838,6 +849,25 @@ void PARTITION_InitializePartition(
     partitionData->nextInternalEvent        = CLOCKTYPE_MAX;
     partitionData->externalInterfaceHorizon = CLOCKTYPE_MAX;
 
+    // Share payloads and info fields between duplicated messages and
+    // copy them only when a layer modifies them.
+    IO_ReadString(
+        partitionData->partitionId,
+        ANY_ADDRESS,
+        nodeInput,
+        "MESSAGE-COPY-ON-WRITE",
+        &wasFound,
+        buf);
+
+    if (wasFound && strcmp(buf, "YES") == 0)
+    {
+        partitionData->msgCopyOnWrite = TRUE;
+    }
+    else
+    {
+        partitionData->msgCopyOnWrite = FALSE;
+    }
+
 #ifdef ADDON_NGCNMS
     IO_ReadString(
         partitionData->partitionId,
@@ -1068,10 +1098,7 @@ void PARTITION_InitializePartition(
 
     if (traceEnabled)
     {
-        sprintf(buf, ".TRACE.%d", partitionData->partitionId);
-        partitionData->traceFd = fopen(buf, "w");
-        ERROR_Assert(partitionData->traceFd != NULL,
-                     "Unable to create packet trace file.");
+        TRACE_OpenTraceFile(partitionData, nodeInput);
     }
 
 #ifdef ADDON_STATS_MANAGER
@@ -1321,6 +1348,25 @@ void PARTITION_InitializeNodes(PartitionData* partitionData) {
     // Initalize scheduler for this partition
     SCHED_Initalize(partitionData, nodeInput);
 
+    // Optionally replace the event queue with the ladder queue
+    {
+        BOOL wasFound;
+        char buf[MAX_STRING_LENGTH];
+
+        IO_ReadString(
+            partitionData->partitionId,
+            ANY_ADDRESS,
+            nodeInput,
+            "SCHEDULER-LADDER-QUEUE",
+            &wasFound,
+            buf);
+
+        if (wasFound && strcmp(buf, "YES") == 0)
+        {
+            SCHED_LADDER_Install(partitionData);
+        }
+    }
+
    partitionData->stats = new STAT_StatisticsList(partitionData);
     // Add partition (global) objects to the hierarchy
     std::string path;
@@ -1561,8 +1607,7 @@ void PARTITION_InitializeNodes(PartitionData* partitionData) {
     // Write the XMLtrace header data to trace file
     if (partitionData->traceFd && partitionData->partitionId == 0)
     {
-        TRACE_WriteXMLTraceHeader(nodeInput, partitionData->traceFd);
-
+        TRACE_WriteTraceHeader(partitionData, nodeInput);
     }
 
 //#endif
@@ -1842,7 +1887,11 @@ void PARTITION_InitializeNodes(PartitionData* partitionData) {
 #ifdef ADDON_STATS_MANAGER
     StatsManager_PostInitialization(partitionData);
 #endif
-    
+
+    if (partitionData->partitionId == 0)
+    {
+        IO_PrintNodeInputIndexStatistics();
+    }
 }
 
 // Class to sort node ids for finalizing nodes in order
@@ -1864,32 +1913,8 @@ public:
 void PARTITION_Finalize(PartitionData* partitionData)
 {
 	//gss xd
-	deque<APPStatsNew>::iterator it = g_APPStatsNew_deque.begin();
-	ofstream ofile;               //ļ
-	ofile.open("AppData.txt");     //Ϊļ
-	for (int i = 0; i < g_APPStatsNew_deque.size(); i++)
-	{
-		//APPStatsNew tmp = (*it);
-		char fchar[128] = { 0 };
-
-		sprintf(fchar, "%.4f", g_APPStatsNew_deque[i].AppThroughput);
-
-		ofile << g_APPStatsNew_deque[i].simTime << ','
-			<< g_APPStatsNew_deque[i].SrcId << ','
-			<< g_APPStatsNew_deque[i].DestId << ','
-			<< g_APPStatsNew_deque[i].Servicetype << ','
-			<< g_APPStatsNew_deque[i].AppDelay << ','
-			<< g_APPStatsNew_deque[i].AppJet << ','
-			<< fchar << ','
-			<< g_APPStatsNew_deque[i].MessageSent << ','
-			<< g_APPStatsNew_deque[i].MessageRcv << ','
-			<< g_APPStatsNew_deque[i].AppPacketLoss << ','
-			<< g_APPStatsNew_deque[i].dataSent
-			<< endl;   //дļ
-
-		it++;
-	}
-	ofile.close();
+	// Records were written to AppData.txt as they were added
+	g_APPStatsStore.Close();
     /* Insert the simulation end time in the stat file */
     if (partitionData->partitionId == 0)
     {
@@ -2002,16 +2027,27 @@ void PARTITION_Finalize(PartitionData* partitionData)
 
     // Finalize scheduler for this partition
     SCHED_Finalize(partitionData);
+    if (partitionData->ladderQueue != NULL)
+    {
+        SCHED_LADDER_Finalize(partitionData);
+    }
+
+    if (partitionData->pathLossMatrix != NULL)
+    {
+        PathlossMatrixPartitionFinalize(partitionData);
+    }
+
+    // Partition wide counters go with the lowest node of the partition
+    if (partitionData->msgCopyOnWrite && !nodes.empty())
+    {
+        MESSAGE_PrintCopyOnWriteStats(nodes.front());
+    }
 
     fclose(partitionData->statFd);
 
     if (partitionData->traceEnabled)
     {
-        if (partitionData->partitionId == (partitionData->numPartitions - 1))
-        {
-            TRACE_WriteXMLTraceTail(partitionData->traceFd);
-        }
-        fclose(partitionData->traceFd);
+        TRACE_CloseTraceFile(partitionData);
     }
 
 #ifdef ADDON_DB
@@ -2272,6 +2308,9 @@ PARTITION_ProcessSendMT (PartitionData * partitionData)
     //      unlock the list
     //      for message in localList
     //          MESSAGE_Send (message)
+    // Take back cells freed on worker threads and top up their caches
+    MESSAGE_ExchangeRecycleBatches(partitionData);
+
     if (partitionData->sendMTList->size () > 0)
     {
         std::list <Message *> *     localList;
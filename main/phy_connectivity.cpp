@@ -1,3 +1,10 @@
+#include <algorithm>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include "api.h"
 #include "partition.h"
 #include "node.h"
@@ -520,6 +527,29 @@ void PHY_CONN_ObtainNodesOnOtherPartitionPositions(
     // ALlocate new class
     partitionData->nodePositionData = new PHY_CONN_NodePositionData;
 
+    // Threads for the connectivity sample.  By default all cores are used
+    // when this is the only partition.
+    BOOL wasFound;
+    int numThreads;
+    IO_ReadInt(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "PHY-CONNECTIVITY-THREADS",
+        &wasFound,
+        &numThreads);
+    if (!wasFound)
+    {
+        numThreads = 1;
+#ifndef _WIN32
+        if (!partitionData->isRunningInParallel())
+        {
+            numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        }
+#endif
+    }
+    partitionData->nodePositionData->numThreads = MAX(numThreads, 1);
+
 
     // The EXTERNAL_ package can forward between partitions. To
     // accomplish this EXTERNAL uses partition communication.
@@ -3021,6 +3051,483 @@ void PHY_EstimateConnectivity(
 }
 
 
+// Node that listens to a channel, with its position
+struct PhyConnCandidate
+{
+    PHY_CONN_NodePositionData::ListenableSet::iterator info;
+    Node* node;
+    Coordinates position;
+};
+
+typedef std::pair<Int64, Int64> PhyConnGridCell;
+typedef std::map<PhyConnGridCell, vector<int> > PhyConnGrid;
+
+static
+PhyConnGridCell PHY_CONN_GridCell(const Coordinates& position,
+                                  double cellSize)
+{
+    return PhyConnGridCell(
+        (Int64)floor(position.cartesian.x / cellSize),
+        (Int64)floor(position.cartesian.y / cellSize));
+}
+
+// Collects the entries of the 3x3 cells around position, in ascending
+// order
+static
+void PHY_CONN_GridNeighbours(
+    const PhyConnGrid& grid,
+    const Coordinates& position,
+    double cellSize,
+    vector<int>& indices)
+{
+    indices.clear();
+
+    PhyConnGridCell center = PHY_CONN_GridCell(position, cellSize);
+    for (Int64 cx = center.first - 1; cx <= center.first + 1; cx++)
+    {
+        for (Int64 cy = center.second - 1; cy <= center.second + 1; cy++)
+        {
+            PhyConnGrid::const_iterator cell =
+                grid.find(PhyConnGridCell(cx, cy));
+            if (cell != grid.end())
+            {
+                indices.insert(indices.end(),
+                    cell->second.begin(), cell->second.end());
+            }
+        }
+    }
+
+    std::sort(indices.begin(), indices.end());
+}
+
+// /**
+// FUNCTION   :: PHY_CONN_ChannelRangeBound
+// PURPOSE    :: Distance beyond which no pair of nodes on the channel
+//               can be connected.  This is the propagation max distance
+//               if configured.  For free space and two ray, which never
+//               lose less than free space, it is also the distance at
+//               which the strongest transmitter drops below the
+//               propagation limit with the best antenna gains.  That
+//               bound is only used when the pathloss is deterministic,
+//               i.e. constant non-negative shadowing and omnidirectional
+//               antennas.
+// PARAMETERS ::
+// + partition    : PartitionData*         : Pointer to partition data
+// + channelIndex : int                    : Channel
+// + nodes        : const ListenableSet&   : Nodes on the channel
+// RETURN     :: double : Range in meters, or -1 if pairs at any
+//                        distance may connect
+// **/
+static
+double PHY_CONN_ChannelRangeBound(
+    PartitionData* partition,
+    int channelIndex,
+    const PHY_CONN_NodePositionData::ListenableSet& nodes)
+{
+    PropProfile* propProfile = partition->propChannel[channelIndex].profile;
+    double rangeBound = -1.0;
+
+    if (propProfile->propMaxDistance > 0.1)
+    {
+        rangeBound = propProfile->propMaxDistance;
+    }
+
+    if ((propProfile->pathlossModel != FREE_SPACE &&
+         propProfile->pathlossModel != TWO_RAY) ||
+        propProfile->shadowingModel != CONSTANT ||
+        propProfile->shadowingMean_dB < 0.0)
+    {
+        return rangeBound;
+    }
+
+    double maxTxPower_mW = 0.0;
+    double maxGain_dBi = 0.0;
+    PHY_CONN_NodePositionData::ListenableSet::const_iterator it;
+    for (it = nodes.begin(); it != nodes.end(); it++)
+    {
+        if (it->type != ANTENNA_OMNIDIRECTIONAL)
+        {
+            return rangeBound;
+        }
+        if (it == nodes.begin() || it->gain_dBi > maxGain_dBi)
+        {
+            maxGain_dBi = it->gain_dBi;
+        }
+        maxTxPower_mW = MAX(maxTxPower_mW, it->txPower_mW);
+    }
+
+    if (maxTxPower_mW <= 0.0)
+    {
+        return rangeBound;
+    }
+
+    double maxPathloss_dB = IN_DB(maxTxPower_mW) + 2.0 * maxGain_dBi
+                            - propProfile->propLimit_dB;
+    double sensitivityRange = propProfile->wavelength / (4.0 * PI)
+                              * pow(10.0, maxPathloss_dB / 20.0);
+
+    if (rangeBound < 0.0 || sensitivityRange < rangeBound)
+    {
+        rangeBound = sensitivityRange;
+    }
+
+    return rangeBound;
+}
+
+// Work items of a connectivity sample are run by PHY_CONN_RunWorkItems on
+// a small work stealing pool.  Items are the indices [0, numItems).  Each
+// worker starts on an even share and, when it runs out, takes the upper
+// half of the largest share left.  Items must be independent; results
+// are written per item and merged by the caller in item order.
+typedef void (*PhyConnWorkFunction)(void* context, int item);
+
+struct PhyConnWorkRange
+{
+    int next;
+    int end;
+};
+
+struct PhyConnWorkPool
+{
+    PhyConnWorkFunction function;
+    void* context;
+    vector<PhyConnWorkRange> ranges;
+    pthread_mutex_t mutex;
+};
+
+struct PhyConnWorker
+{
+    PhyConnWorkPool* pool;
+    int index;
+};
+
+static
+BOOL PHY_CONN_TakeWorkItem(PhyConnWorkPool* pool, int worker, int* item)
+{
+    pthread_mutex_lock(&pool->mutex);
+
+    PhyConnWorkRange* own = &pool->ranges[worker];
+    if (own->next >= own->end)
+    {
+        int victim = -1;
+        int mostLeft = 0;
+        for (size_t i = 0; i < pool->ranges.size(); i++)
+        {
+            int left = pool->ranges[i].end - pool->ranges[i].next;
+            if (left > mostLeft)
+            {
+                mostLeft = left;
+                victim = (int)i;
+            }
+        }
+
+        if (victim < 0)
+        {
+            pthread_mutex_unlock(&pool->mutex);
+            return FALSE;
+        }
+
+        PhyConnWorkRange* stolen = &pool->ranges[victim];
+        int split = stolen->end - (mostLeft + 1) / 2;
+        own->next = split;
+        own->end = stolen->end;
+        stolen->end = split;
+    }
+
+    *item = own->next;
+    own->next++;
+
+    pthread_mutex_unlock(&pool->mutex);
+    return TRUE;
+}
+
+static
+void* PHY_CONN_WorkerThread(void* arg)
+{
+    PhyConnWorker* worker = (PhyConnWorker*)arg;
+    int item;
+
+    while (PHY_CONN_TakeWorkItem(worker->pool, worker->index, &item))
+    {
+        worker->pool->function(worker->pool->context, item);
+    }
+
+    return NULL;
+}
+
+// /**
+// FUNCTION   :: PHY_CONN_RunWorkItems
+// PURPOSE    :: Run function on every item, on up to numThreads threads
+//               including the calling one.  Returns when all items are
+//               done.
+// PARAMETERS ::
+// + numThreads : int                 : Threads to use
+// + numItems   : int                 : Number of items
+// + function   : PhyConnWorkFunction : Function run per item
+// + context    : void*               : Passed to function
+// RETURN     :: void : NULL
+// **/
+static
+void PHY_CONN_RunWorkItems(
+    int numThreads,
+    int numItems,
+    PhyConnWorkFunction function,
+    void* context)
+{
+    numThreads = MIN(numThreads, numItems);
+    if (numThreads <= 1)
+    {
+        for (int i = 0; i < numItems; i++)
+        {
+            function(context, i);
+        }
+        return;
+    }
+
+    PhyConnWorkPool pool;
+    pool.function = function;
+    pool.context = context;
+    pool.ranges.resize(numThreads);
+    for (int i = 0; i < numThreads; i++)
+    {
+        pool.ranges[i].next = (int)((Int64)numItems * i / numThreads);
+        pool.ranges[i].end = (int)((Int64)numItems * (i + 1) / numThreads);
+    }
+    pthread_mutex_init(&pool.mutex, NULL);
+
+    vector<PhyConnWorker> workers(numThreads);
+    vector<pthread_t> threads(numThreads);
+    vector<BOOL> started(numThreads, FALSE);
+    for (int i = 0; i < numThreads; i++)
+    {
+        workers[i].pool = &pool;
+        workers[i].index = i;
+    }
+
+    // Worker 0 is this thread
+    for (int i = 1; i < numThreads; i++)
+    {
+        started[i] = pthread_create(&threads[i],
+                                    NULL,
+                                    PHY_CONN_WorkerThread,
+                                    &workers[i]) == 0;
+    }
+
+    // Shares of threads that could not be started are stolen
+    PHY_CONN_WorkerThread(&workers[0]);
+
+    for (int i = 1; i < numThreads; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    pthread_mutex_destroy(&pool.mutex);
+}
+
+// Pathloss from the transmitters near one receiving node
+struct PhyConnPathlossResult
+{
+    int txIndex;
+    int rxIndex;
+    double pathloss_dB;
+};
+
+struct PhyConnPathlossWork
+{
+    int channelIndex;
+    double wavelength;
+    int coordinateSystemType;
+    double rangeBound;
+    BOOL useGrid;
+
+    vector<PhyConnCandidate> txCandidates;
+    vector<PhyConnCandidate> rxCandidates;
+    PhyConnGrid txGrid;
+
+    // Item i is the receiving node with rx candidates
+    // [rxNodeStart[i], rxNodeStart[i + 1]), one per phy
+    vector<int> rxNodeStart;
+    vector<vector<PhyConnPathlossResult> > results;
+};
+
+// Computes the pathloss of one receiving node from every transmitter in
+// range.  The shadowing draws of a receiver come from its own PropData,
+// so they are made in the same order as in a serial run: transmitters
+// in set order, then the phys of the receiver.
+static
+void PHY_CONN_PathlossWorkItem(void* context, int item)
+{
+    PhyConnPathlossWork* work = (PhyConnPathlossWork*)context;
+    int rxFirst = work->rxNodeStart[item];
+    int rxLast = work->rxNodeStart[item + 1];
+    const PhyConnCandidate& rxNodeInfo = work->rxCandidates[rxFirst];
+
+    vector<int> txIndices;
+    if (work->useGrid)
+    {
+        PHY_CONN_GridNeighbours(work->txGrid, rxNodeInfo.position,
+            work->rangeBound, txIndices);
+    }
+    else
+    {
+        txIndices.resize(work->txCandidates.size());
+        for (size_t i = 0; i < txIndices.size(); i++)
+        {
+            txIndices[i] = (int)i;
+        }
+    }
+
+    vector<PhyConnPathlossResult>& results = work->results[item];
+
+    for (size_t i = 0; i < txIndices.size(); i++)
+    {
+        const PhyConnCandidate& tx = work->txCandidates[txIndices[i]];
+        if (tx.info->nodeId == rxNodeInfo.info->nodeId)
+        {
+            continue;
+        }
+
+        for (int r = rxFirst; r < rxLast; r++)
+        {
+            const PhyConnCandidate& rx = work->rxCandidates[r];
+
+            PropPathProfile profile;
+            profile.fromPosition = tx.position;
+            profile.toPosition = rx.position;
+
+            COORD_CalcDistanceAndAngle(
+              work->coordinateSystemType,
+              &(profile.fromPosition),
+              &(profile.toPosition),
+              &(profile.distance),
+              &(profile.txDOA),
+              &(profile.rxDOA));
+
+            if (work->rangeBound > 0.0 &&
+                profile.distance > work->rangeBound)
+            {
+                continue;
+            }
+
+            // estimate pathloss
+            double pathloss_dB = 0;
+
+            PROP_CalculatePathloss(
+                rx.node,
+                tx.node->nodeId,
+                rx.node->nodeId,
+                work->channelIndex,
+                work->wavelength,
+                tx.info->antennaHeight,
+                rx.info->antennaHeight,
+                &profile,
+                &pathloss_dB);
+
+            PhyConnPathlossResult result;
+            result.txIndex = txIndices[i];
+            result.rxIndex = r;
+            result.pathloss_dB = pathloss_dB;
+            results.push_back(result);
+        }
+    }
+}
+
+// Rx power of every adjacency of one local transmitting node
+struct PhyConnRxPowerTask
+{
+    Node* rxNode;
+    PHY_CONN_NodePositionData::AdjacencyList* adjacencies;
+};
+
+struct PhyConnRxPowerWork
+{
+    PHY_CONN_NodePositionData* nodePositionData;
+    PartitionData* partition;
+
+    // Item i is txNodes[i] with tasks [taskStart[i], taskStart[i + 1])
+    vector<Node*> txNodes;
+    vector<int> taskStart;
+    vector<PhyConnRxPowerTask> tasks;
+};
+
+// Items are split by transmitter because the steerable antenna gain
+// functions steer the transmitting antenna for a moment.
+static
+void PHY_CONN_RxPowerWorkItem(void* context, int item)
+{
+    PhyConnRxPowerWork* work = (PhyConnRxPowerWork*)context;
+    PHY_CONN_NodePositionData* nodePositionData = work->nodePositionData;
+    Node* txNode = work->txNodes[item];
+
+    for (int t = work->taskStart[item]; t < work->taskStart[item + 1]; t++)
+    {
+        Node* rxNode = work->tasks[t].rxNode;
+        PHY_CONN_NodePositionData::AdjacencyList::iterator adj;
+        for (adj = work->tasks[t].adjacencies->begin();
+            adj != work->tasks[t].adjacencies->end();
+            adj++)
+        {
+            // get sender's listenable info
+            PHY_CONN_NodePositionData::ListenableSet::iterator txInfo;
+            BOOL found = FALSE;
+            nodePositionData->GetChannelNodeInfo(
+                txNode->nodeId,
+                adj->first.senderIndex, adj->first.channelIndex,
+                &txInfo, &found);
+
+            ERROR_Assert(found, "Error in rx power calculation.");
+
+            PHY_CONN_NodePositionData::ListenableSet::iterator rxInfo;
+            nodePositionData->GetChannelNodeInfo(
+                adj->first.rcverId,
+                adj->first.rcverIndex,
+                adj->first.channelIndex,
+                &rxInfo, &found);
+
+            ERROR_Assert(found, "Error in rx power calculation.");
+
+            // Compute power for rx nodes
+            double rxPower_mw = 0;
+            double rxPower_mwWorst = 0;
+            PHY_ComputeRxPower(work->partition,
+                txNode,
+                rxNode,
+                adj->second.pathloss_dB,
+                &(*txInfo),
+                &(*rxInfo),
+                adj->first.channelIndex,
+                &rxPower_mw,
+                &rxPower_mwWorst);
+
+            if (PHY_CONNECTIVITY_DEBUG)
+            {
+                printf("rx power cal - p %d from node %d to node %d "
+                    "on channel %d rxPower_mw %e\n",
+                    work->partition->partitionId,
+                    txNode->nodeId, adj->first.rcverId,
+                    adj->first.channelIndex, rxPower_mw);
+            }
+
+            if (rxPower_mw > 1.0e300)
+            {
+                printf("infinity\n");
+            }
+
+            //if (rxPower_mw > 0)
+            {
+                // calculate rx power from txnode to rx node
+                adj->second.rxPower_mw = rxPower_mw;
+                adj->second.rxPower_mwWorst = rxPower_mwWorst;
+                adj->second.syncType = PHY_CONN_NodePositionData::RX_POWER_INFO;
+
+            }
+        }
+    }
+}
+
 void PHY_CONN_NodePositionData::HandleChannelPhyConnInsertion(
     Node* node,
     PartitionData* partition)
@@ -3036,6 +3543,10 @@ void PHY_CONN_NodePositionData::HandleChannelPhyConnInsertion(
 
     // Calculate pathloss from each tx node to each LOCAL rx node
     connectivity.clear();
+    adjacencyIndexValid = FALSE;
+
+    int coordinateSystemType = partition->terrainData->getCoordinateSystem();
+
     ListenableChannelNodeList::iterator channel_iter;
     for (channel_iter = listenableChannelNodeList.begin();
         channel_iter != listenableChannelNodeList.end();
@@ -3043,94 +3554,117 @@ void PHY_CONN_NodePositionData::HandleChannelPhyConnInsertion(
     {
         int channelIndex = channel_iter->first;
 
-        // local node information
-        ListenableSet::iterator tx_node_iter;
-        for (tx_node_iter = channel_iter->second.begin();
-            tx_node_iter != channel_iter->second.end();
-            tx_node_iter++)
+        PropChannel* propChannel =
+            &(partition->propChannel[channelIndex]);
+
+        PhyConnPathlossWork work;
+        work.channelIndex = channelIndex;
+        work.wavelength = propChannel->profile->wavelength;
+        work.coordinateSystemType = coordinateSystemType;
+
+        // Transmitters, and receivers on this partition, with their
+        // positions, in ListenableSet order
+        ListenableSet::iterator node_iter;
+        for (node_iter = channel_iter->second.begin();
+            node_iter != channel_iter->second.end();
+            node_iter++)
         {
-            // Get transmitting node only if on local partition
+            PhyConnCandidate candidate;
+            candidate.info = node_iter;
+
             // Only perform connectivity for tx node on local partition
-            Node* txNode = NULL;
+            candidate.node = NULL;
             PARTITION_ReturnNodePointer(
                     partition,
-                    &txNode,
-                    tx_node_iter->nodeId,
+                    &candidate.node,
+                    node_iter->nodeId,
                     TRUE);
-            ERROR_Assert(txNode, "Invalid transmitter");
+            ERROR_Assert(candidate.node, "Invalid transmitter");
+            PHY_CONN_GetNodePosition(
+                partition, candidate.node, &candidate.position);
+            work.txCandidates.push_back(candidate);
 
-            ListenableSet::iterator rx_node_iter;
-            for (rx_node_iter = channel_iter->second.begin();
-                rx_node_iter != channel_iter->second.end();
-                rx_node_iter++)
+            candidate.node = NULL;
+            PARTITION_ReturnNodePointer(
+                partition,
+                &candidate.node,
+                node_iter->nodeId,
+                FALSE);
+            if (!candidate.node)
             {
-                if (tx_node_iter->nodeId == rx_node_iter->nodeId)
-                {
-                    //printf("tx nodeId %d == rx nodeId %d \n",
-                    //    tx_node_iter->first, rx_node_iter->first);
-                    continue;
-                }
-
-                Node* rxNode = NULL;
-                PARTITION_ReturnNodePointer(
-                    partition,
-                    &rxNode,
-                    rx_node_iter->nodeId,
-                    FALSE);
-                if (!rxNode)
-                {
-                    continue;
-                }
-
-
-                // Compute pathloss for rx nodes
-
-                PropChannel* propChannel =
-                    &(partition->propChannel[channelIndex]);
-                double wavelength = propChannel->profile->wavelength;
+                continue;
+            }
 
-                PropPathProfile profile;
-                PHY_CONN_GetNodePosition(
-                    partition, txNode, &(profile.fromPosition));
-                PHY_CONN_GetNodePosition(
-                    partition, rxNode, &(profile.toPosition));
+            if (work.rxCandidates.empty() ||
+                work.rxCandidates.back().info->nodeId != node_iter->nodeId)
+            {
+                work.rxNodeStart.push_back((int)work.rxCandidates.size());
+            }
+            work.rxCandidates.push_back(candidate);
+        }
 
-                COORD_CalcDistanceAndAngle(
-                  partition->terrainData->getCoordinateSystem(),
-                  &(profile.fromPosition),
-                  &(profile.toPosition),
-                  &(profile.distance),
-                  &(profile.txDOA),
-                  &(profile.rxDOA));
+        if (work.rxCandidates.empty())
+        {
+            continue;
+        }
+        work.rxNodeStart.push_back((int)work.rxCandidates.size());
+
+        // Pairs farther apart than rangeBound cannot connect.  On a
+        // cartesian terrain the transmitters are binned into a grid of
+        // rangeBound sized cells so that only the 3x3 cells around a
+        // receiver have to be looked at.
+        work.rangeBound = PHY_CONN_ChannelRangeBound(
+            partition, channelIndex, channel_iter->second);
+        work.useGrid =
+            work.rangeBound > 0.0 && coordinateSystemType == CARTESIAN;
+
+        if (work.useGrid)
+        {
+            for (size_t i = 0; i < work.txCandidates.size(); i++)
+            {
+                work.txGrid[PHY_CONN_GridCell(
+                    work.txCandidates[i].position, work.rangeBound)].
+                    push_back((int)i);
+            }
+        }
 
-                // estimate pathloss
-                double pathloss_dB = 0;
+        // Only the analytical models are known to be safe to evaluate
+        // from several threads
+        PathlossModel pathlossModel = propChannel->profile->pathlossModel;
+        int numThreads = 1;
+        if (pathlossModel == FREE_SPACE ||
+            pathlossModel == TWO_RAY ||
+            pathlossModel == PL_MATRIX)
+        {
+            numThreads = this->numThreads;
+        }
 
-                PROP_CalculatePathloss(
-                    rxNode,
-                    txNode->nodeId,
-                    rxNode->nodeId,
-                    channelIndex,
-                    wavelength,
-                    tx_node_iter->antennaHeight,
-                    rx_node_iter->antennaHeight,
-                    &profile,
-                    &pathloss_dB);
+        int numRxNodes = (int)work.rxNodeStart.size() - 1;
+        work.results.resize(numRxNodes);
+        PHY_CONN_RunWorkItems(
+            numThreads, numRxNodes, PHY_CONN_PathlossWorkItem, &work);
 
+        // Add to receiver map
+        for (int item = 0; item < numRxNodes; item++)
+        {
+            for (size_t i = 0; i < work.results[item].size(); i++)
+            {
+                const PhyConnPathlossResult& result = work.results[item][i];
+                const PhyConnCandidate& tx =
+                    work.txCandidates[result.txIndex];
+                const PhyConnCandidate& rx =
+                    work.rxCandidates[result.rxIndex];
 
-                 // Add to receiver map
                 HandlePhyConnPathlossInsertion(
                     partition,
-                    txNode->nodeId,
-                    tx_node_iter->phyIndex,
-                    rxNode->nodeId,
-                    rx_node_iter->phyIndex,
+                    tx.node->nodeId,
+                    tx.info->phyIndex,
+                    rx.node->nodeId,
+                    rx.info->phyIndex,
                     channelIndex,
-                    pathloss_dB,
+                    result.pathloss_dB,
                     PHY_CONN_NodePositionData::WIRELESS,
                     PHY_CONN_NodePositionData::WIRELESS);
-
-
             }
         }
     }
@@ -3144,6 +3678,16 @@ void PHY_CONN_NodePositionData::HandleChannelPhyConnInsertion(
     // //
     // then compute rx power at each LOCAL tx node to each rx node
 
+    // Lookups in the pathloss matrix are read only from here on
+    if (partition->pathLossMatrix != NULL)
+    {
+        PathlossMatrixAdvance(partition, getSimTime(partition->firstNode));
+    }
+
+    PhyConnRxPowerWork rxPowerWork;
+    rxPowerWork.nodePositionData = this;
+    rxPowerWork.partition = partition;
+
     ConnectivityMap::iterator txConn;
     for (txConn = connectivity.begin();
             txConn != connectivity.end();
@@ -3161,6 +3705,9 @@ void PHY_CONN_NodePositionData::HandleChannelPhyConnInsertion(
             continue;
         }
 
+        rxPowerWork.txNodes.push_back(txNode);
+        rxPowerWork.taskStart.push_back((int)rxPowerWork.tasks.size());
+
         TxConnectivity::iterator rxConn;
         for (rxConn = txConn->second.begin();
             rxConn != txConn->second.end();
@@ -3177,73 +3724,20 @@ void PHY_CONN_NodePositionData::HandleChannelPhyConnInsertion(
 
             ERROR_Assert(rxNode, "Invalid receiver");
 
-            // Loop over possible adjacencies
-            AdjacencyList::iterator adj;
-            for (adj = rxConn->second.begin();
-                adj != rxConn->second.end();
-                adj++)
-            {
-
-
-                // get sender's listenable info
-                ListenableSet::iterator txInfo;
-                BOOL found = FALSE;
-                GetChannelNodeInfo(
-                    txConn->first,
-                    adj->first.senderIndex, adj->first.channelIndex,
-                    &txInfo, &found);
-
-                ERROR_Assert(found, "Error in rx power calculation.");
-
-                ListenableSet::iterator rxInfo;
-                GetChannelNodeInfo(
-                    adj->first.rcverId,
-                    adj->first.rcverIndex,
-                    adj->first.channelIndex,
-                    &rxInfo, &found);
-
-                ERROR_Assert(found, "Error in rx power calculation.");
-
-                // Compute power for rx nodes
-                double rxPower_mw = 0;
-                double rxPower_mwWorst = 0;
-                PHY_ComputeRxPower(partition,
-                    txNode,
-                    rxNode,
-                    adj->second.pathloss_dB,
-                    &(*txInfo),
-                    &(*rxInfo),
-                    adj->first.channelIndex,
-                    &rxPower_mw,
-                    &rxPower_mwWorst);
-
-                if (PHY_CONNECTIVITY_DEBUG)
-                {
-                    printf("rx power cal - p %d from node %d to node %d "
-                        "on channel %d rxPower_mw %e\n",
-                        partition->partitionId,
-                        txConn->first,adj->first.rcverId,
-                        adj->first.channelIndex, rxPower_mw);
-                }
-
-                if (rxPower_mw > 1.0e300)
-                {
-                    printf("infinity\n");
-                }
-
-                //if (rxPower_mw > 0)
-                {
-                    // calculate rx power from txnode to rx node
-                    adj->second.rxPower_mw = rxPower_mw;
-                    adj->second.rxPower_mwWorst = rxPower_mwWorst;
-                    adj->second.syncType = RX_POWER_INFO;
-
-                }
-
-            }
-
+            PhyConnRxPowerTask task;
+            task.rxNode = rxNode;
+            task.adjacencies = &rxConn->second;
+            rxPowerWork.tasks.push_back(task);
         }
     }
+    rxPowerWork.taskStart.push_back((int)rxPowerWork.tasks.size());
+
+    // Each item only writes the adjacencies of its own transmitter
+    PHY_CONN_RunWorkItems(
+        numThreads,
+        (int)rxPowerWork.txNodes.size(),
+        PHY_CONN_RxPowerWorkItem,
+        &rxPowerWork);
 
     connectivity.global_syncType = RX_POWER_INFO;
     connectivity.Summarize(partition);
@@ -3445,6 +3939,8 @@ void HandlePhyConnInsertion(Node* node,
     HandleSatComPhyConnInsertion(node, partition);
     Handle802_3PhyConnInsertion(node, partition);
 
+    partition->nodePositionData->BuildAdjacencyIndex();
+
 }
 
 
@@ -3465,25 +3961,133 @@ void HandlePhyConnInsertion(Node* node,
 
 //======================APIs
 
+void PHY_CONN_NodePositionData::BuildAdjacencyIndex()
+{
+    adjacencyTxIds.clear();
+    adjacencyRowStart.clear();
+    adjacencyEntries.clear();
+
+    size_t numEntries = 0;
+    ConnectivityMap::iterator txConn;
+    for (txConn = connectivity.begin();
+        txConn != connectivity.end();
+        ++txConn)
+    {
+        TxConnectivity::iterator rxConn;
+        for (rxConn = txConn->second.begin();
+            rxConn != txConn->second.end();
+            rxConn++)
+        {
+            numEntries += rxConn->second.size();
+        }
+    }
+
+    adjacencyTxIds.reserve(connectivity.size());
+    adjacencyRowStart.reserve(connectivity.size() + 1);
+    adjacencyEntries.reserve(numEntries);
+
+    // The maps are already sorted by sender, then AdjacencyNodeKey whose
+    // first field is the receiver, so the rows come out sorted.
+    for (txConn = connectivity.begin();
+        txConn != connectivity.end();
+        ++txConn)
+    {
+        adjacencyTxIds.push_back(txConn->first);
+        adjacencyRowStart.push_back((int)adjacencyEntries.size());
+
+        TxConnectivity::iterator rxConn;
+        for (rxConn = txConn->second.begin();
+            rxConn != txConn->second.end();
+            rxConn++)
+        {
+            adjacencyEntries.insert(adjacencyEntries.end(),
+                rxConn->second.begin(), rxConn->second.end());
+        }
+    }
+    adjacencyRowStart.push_back((int)adjacencyEntries.size());
+
+    adjacencyIndexValid = TRUE;
+}
+
+static
+bool PHY_CONN_EntryRcverLess(const PairAdjacencyKeyValue& entry,
+                             int rcverId)
+{
+    return entry.first.rcverId < rcverId;
+}
+
+static
+bool PHY_CONN_RcverEntryLess(int rcverId,
+                             const PairAdjacencyKeyValue& entry)
+{
+    return rcverId < entry.first.rcverId;
+}
+
+BOOL PHY_CONN_NodePositionData::FindAdjacencyRow(
+    NodeId txNodeId,
+    int* first,
+    int* last) const
+{
+    vector<NodeId>::const_iterator it =
+        std::lower_bound(adjacencyTxIds.begin(), adjacencyTxIds.end(),
+            txNodeId);
+    if (it == adjacencyTxIds.end() || *it != txNodeId)
+    {
+        return FALSE;
+    }
+
+    int row = (int)(it - adjacencyTxIds.begin());
+    *first = adjacencyRowStart[row];
+    *last = adjacencyRowStart[row + 1];
+    return TRUE;
+}
+
+BOOL PHY_CONN_NodePositionData::FindAdjacencyRange(
+    NodeId txNodeId,
+    NodeId rxNodeId,
+    int* first,
+    int* last) const
+{
+    int rowFirst;
+    int rowLast;
+    if (!FindAdjacencyRow(txNodeId, &rowFirst, &rowLast))
+    {
+        return FALSE;
+    }
+
+    vector<PairAdjacencyKeyValue>::const_iterator begin =
+        adjacencyEntries.begin() + rowFirst;
+    vector<PairAdjacencyKeyValue>::const_iterator end =
+        adjacencyEntries.begin() + rowLast;
+
+    begin = std::lower_bound(begin, end, rxNodeId, PHY_CONN_EntryRcverLess);
+    end = std::upper_bound(begin, end, rxNodeId, PHY_CONN_RcverEntryLess);
+    if (begin == end)
+    {
+        return FALSE;
+    }
+
+    *first = (int)(begin - adjacencyEntries.begin());
+    *last = (int)(end - adjacencyEntries.begin());
+    return TRUE;
+}
+
 BOOL PHY_CONN_ReturnPotPhyConnectivity(
     PartitionData *partition, int txNodeId, int rxNodeId)
 {
     PHY_CONN_NodePositionData *nodePositionData =
             partition->nodePositionData;
 
-    // Check for txNodeId
-    PHY_CONN_NodePositionData::ConnectivityMap::iterator it =
-        nodePositionData->connectivity.find(txNodeId);
-    if (it == nodePositionData->connectivity.end())
+    if (!nodePositionData->adjacencyIndexValid)
     {
         return FALSE;
     }
 
     // Check if txNodeId connected to rxNodeId
-    PHY_CONN_NodePositionData::TxConnectivity::iterator it2 =
-        it->second.find(rxNodeId);
-
-    return it2 != it->second.end();
+    int first;
+    int last;
+    return nodePositionData->FindAdjacencyRange(
+        txNodeId, rxNodeId, &first, &last);
 }
 
 BOOL PHY_CONN_ReturnPhyConnectivity(
@@ -3492,29 +4096,24 @@ BOOL PHY_CONN_ReturnPhyConnectivity(
     PHY_CONN_NodePositionData *nodePositionData =
             partition->nodePositionData;
 
-    // Check for txNodeId
-    PHY_CONN_NodePositionData::ConnectivityMap::iterator it =
-        nodePositionData->connectivity.find(txNodeId);
-    if (it == nodePositionData->connectivity.end())
+    if (!nodePositionData->adjacencyIndexValid)
     {
         return FALSE;
     }
 
     // Check if txNodeId connected to rxNodeId
-    PHY_CONN_NodePositionData::TxConnectivity::iterator it2 =
-        it->second.find(rxNodeId);
-    if (it2 == it->second.end())
+    int first;
+    int last;
+    if (!nodePositionData->FindAdjacencyRange(
+            txNodeId, rxNodeId, &first, &last))
     {
         return FALSE;
     }
 
     // Check if they are connected on some channel
-    PHY_CONN_NodePositionData::AdjacencyList::iterator it3;
-    for (it3 = it2->second.begin();
-        it3 != it2->second.end();
-        it3++)
+    for (int i = first; i < last; i++)
     {
-        if (it3->second.connected)
+        if (nodePositionData->adjacencyEntries[i].second.connected)
         {
             return TRUE;
         }
@@ -3533,30 +4132,23 @@ BOOL PHY_CONN_ReturnPhyConnectivity(PartitionData *partition,
 
     adjNodeStru.clear();
 
-    // First lookup sender
-    PHY_CONN_NodePositionData::ConnectivityMap::iterator it =
-        nodePositionData->connectivity.find(txNodeId);
-    if (it == nodePositionData->connectivity.end())
+    if (!nodePositionData->adjacencyIndexValid)
     {
         return FALSE;
     }
 
-    // Now iterate through every connected node
-    PHY_CONN_NodePositionData::TxConnectivity::iterator it2;
-    for (it2 = it->second.begin();
-        it2 != it->second.end();
-        it2++)
+    // First lookup sender
+    int first;
+    int last;
+    if (!nodePositionData->FindAdjacencyRow(txNodeId, &first, &last))
     {
-        PHY_CONN_NodePositionData::AdjacencyList::iterator it3;
-        for (it3 = it2->second.begin();
-            it3 != it2->second.end();
-            it3++)
-        {
-            adjNodeStru.push_back(*it3);
-        }
+        return FALSE;
     }
 
+    // The row holds every connected node
+    adjNodeStru.assign(
+        nodePositionData->adjacencyEntries.begin() + first,
+        nodePositionData->adjacencyEntries.begin() + last);
+
     return TRUE;
 }
-
-
@@ -26,6 +26,7 @@
 #include "qualnet_error.h"
 
 #include <map>
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -10091,6 +10092,16 @@ static ArbitraryDistribution* RANDOM_ReadDistributionData(
     for (i = 0; i < dist->numDistPoints; i++) {
         dist->values[i].probability /= sum;
     }
+
+    // Accumulate the probabilities the same way the distribution used to
+    // be walked on every draw, so that the drawn values do not change
+    double upper = 0.0;
+    dist->cumulativeProbabilities = (double*)
+        MEM_malloc(sizeof(double) * dist->numDistPoints);
+    for (i = 0; i < dist->numDistPoints; i++) {
+        upper = MIN(1.0, upper + dist->values[i].probability);
+        dist->cumulativeProbabilities[i] = upper;
+    }
     return dist;
 }
 
@@ -10308,6 +10319,7 @@ int RandomDistribution<T>::setDistribution(const char*          inputString,
         type = USER;
         userDefinedDistributionName = (char*) MEM_malloc(strlen(buf) + 1);
         strcpy(userDefinedDistributionName, buf);
+        userDistribution = NULL;
         return 1;
     }
 
@@ -10801,37 +10813,61 @@ T RandomDistribution<T>::getRandomNumber(RandomSeed newSeed)
 }
 
 template <class T>
-double RandomDistribution<T>::processUserDistribution(RandomSeed seed)
+void RandomDistribution<T>::getRandomNumbers(T* values, int count)
 {
-    //First search for the distribution in the data strcuture.
-    double                 randNum;
-    ArbitraryDistribution* arb;
-    string                 name = userDefinedDistributionName;
+    int i;
+
+    if (type == USER) {
+        ArbitraryDistribution* arb = findUserDistribution();
+
+        for (i = 0; i < count; i++) {
+            values[i] = (T) getNextNumber(arb, RANDOM_erand(randomSeed));
+        }
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        values[i] = getRandomNumber();
+    }
+}
 
-    arb = userDistributions[name];
+template <class T>
+ArbitraryDistribution* RandomDistribution<T>::findUserDistribution()
+{
+    if (userDistribution == NULL) {
+        std::map<string, ArbitraryDistribution*>::iterator it =
+            userDistributions.find(userDefinedDistributionName);
 
-    ERROR_Assert(arb != NULL, "User defined Arbitrary Distribution not found\n");
+        ERROR_Assert(it != userDistributions.end() && it->second != NULL,
+                     "User defined Arbitrary Distribution not found\n");
+        userDistribution = it->second;
+    }
+    return userDistribution;
+}
 
-    randNum = RANDOM_erand(seed);
+template <class T>
+double RandomDistribution<T>::processUserDistribution(RandomSeed seed)
+{
+    double randNum = RANDOM_erand(seed);
 
-    return getNextNumber(arb, randNum);
+    return getNextNumber(findUserDistribution(), randNum);
 }
 
 template <class T>
 double RandomDistribution<T>::getNextNumber(ArbitraryDistribution* data,
         double randNum)
 {
-    double upper = 0.0;
-
-    int i = 0;
-    while (upper <= randNum) {
-        upper = MIN(1.0, upper + data->values[i].probability);
-        if (upper > randNum) {
-            return data->values[i].value;
-        }
-        i++;
+    // First point whose cumulative probability is above randNum
+    double* end = data->cumulativeProbabilities + data->numDistPoints;
+    double* upper = std::upper_bound(data->cumulativeProbabilities,
+                                     end,
+                                     randNum);
+
+    if (upper == end) {
+        // randNum is 1.0 and the probabilities add up to exactly 1.0
+        return data->values[data->numDistPoints - 1].value;
     }
-    return 0.0; // not sure how this can happen
+    return data->values[upper - data->cumulativeProbabilities].value;
 }
 
 Int32 RANDOM_nrand(RandomSeed seed) {
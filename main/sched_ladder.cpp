@@ -0,0 +1,973 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+/*
+ * PURPOSE: Event (message) queue using a ladder queue
+ *          (Tang, Goh and Thng, "Ladder Queue: An O(1) Priority Queue
+ *          Structure for Large-Scale Discrete Event Simulation")
+ */
+
+#include <stdio.h>
+#include <algorithm>
+
+#include "api.h"
+#include "partition.h"
+#include "sched_ladder.h"
+
+// #define LADDER_DEBUG
+
+// Feed the splay tree scheduler the same calls and check that it pops
+// the same events in the same order
+// #define LADDER_CHECK_SPLAYTREE
+
+#ifdef LADDER_CHECK_SPLAYTREE
+#include "calendar.h"
+#include "sched_splaytree.h"
+#endif
+
+//------------------------------ Utilities ------------------------------
+
+// Event ordering: time, then naturalOrder (the order in which the events
+// were sent), then node index so that equal keys are still deterministic.
+static
+bool LadderCellLess(const LadderCell* a, const LadderCell* b)
+{
+    if (a->time != b->time)
+    {
+        return a->time < b->time;
+    }
+    if (a->naturalOrder != b->naturalOrder)
+    {
+        return a->naturalOrder < b->naturalOrder;
+    }
+    return a->node->nodeIndex < b->node->nodeIndex;
+}
+
+static
+LadderCell* LadderAllocCell(LadderQueue* lq)
+{
+    LadderCell* cell;
+
+    if (lq->cellFreeList != NULL)
+    {
+        cell = lq->cellFreeList;
+        lq->cellFreeList = cell->next;
+        lq->cellFreeListNum--;
+    }
+    else
+    {
+        cell = (LadderCell*) MEM_malloc(sizeof(LadderCell));
+    }
+    cell->next = NULL;
+    return cell;
+}
+
+static
+void LadderFreeCell(LadderQueue* lq, LadderCell* cell)
+{
+    if (lq->cellFreeListNum < LADDER_MAX_FREE_CELLS)
+    {
+        cell->next = lq->cellFreeList;
+        lq->cellFreeList = cell;
+        lq->cellFreeListNum++;
+    }
+    else
+    {
+        MEM_free(cell);
+    }
+}
+
+static
+BOOL LadderHasNode(const LadderQueue* lq, const Node* node)
+{
+    return node->nodeIndex < lq->nodes.size()
+           && lq->nodes[node->nodeIndex] == node;
+}
+
+// Lowest indexed node in the node queue, used when there are no events
+static
+Node* LadderFirstNode(const LadderQueue* lq)
+{
+    for (size_t i = 0; i < lq->nodes.size(); i++)
+    {
+        if (lq->nodes[i] != NULL)
+        {
+            return lq->nodes[i];
+        }
+    }
+    return NULL;
+}
+
+static
+LadderQueue* LadderGetQueue(const PartitionData* partitionData)
+{
+    ERROR_Assert(partitionData->ladderQueue != NULL,
+                 "Ladder queue is not initialized");
+    return partitionData->ladderQueue;
+}
+
+// If the cell's message was removed with SCHED_LADDER_DeleteMessage,
+// forget the deletion and return TRUE so that the caller drops the cell.
+static
+BOOL LadderTakeDeleted(LadderQueue* lq, const LadderCell* cell)
+{
+    if (lq->deleted.empty())
+    {
+        return FALSE;
+    }
+
+    std::set<LadderDeletedKey>::iterator it =
+        lq->deleted.find(LadderDeletedKey(cell->msg, cell->naturalOrder));
+    if (it == lq->deleted.end())
+    {
+        return FALSE;
+    }
+    lq->deleted.erase(it);
+    return TRUE;
+}
+
+// Drop the deleted events from a list of count cells that is being
+// spilled into a rung or into Bottom.  Returns the number of cells left.
+static
+int LadderDropDeleted(LadderQueue* lq, LadderCell** list, int count)
+{
+    LadderCell** link = list;
+
+    if (lq->deleted.empty())
+    {
+        return count;
+    }
+
+    while (*link != NULL)
+    {
+        LadderCell* cell = *link;
+
+        if (LadderTakeDeleted(lq, cell))
+        {
+            *link = cell->next;
+            LadderFreeCell(lq, cell);
+            lq->numEvents--;
+            count--;
+        }
+        else
+        {
+            link = &cell->next;
+        }
+    }
+    return count;
+}
+
+// Insert a cell into the sorted Bottom list
+static
+void LadderBottomInsert(LadderQueue* lq, LadderCell* cell)
+{
+    LadderCell** link = &lq->bottom;
+
+    while (*link != NULL && !LadderCellLess(cell, *link))
+    {
+        link = &(*link)->next;
+    }
+    cell->next = *link;
+    *link = cell;
+    lq->bottomCount++;
+}
+
+// Spread a list of cells over a new rung covering [rangeStart, rangeEnd).
+// The new rung becomes the finest rung.
+static
+void LadderSpawnRung(LadderQueue* lq,
+                     LadderCell* list,
+                     int count,
+                     clocktype rangeStart,
+                     clocktype rangeEnd)
+{
+    LadderRung* rung = &lq->rungs[lq->numRungs];
+    clocktype span = MAX(rangeEnd - rangeStart, (clocktype) 1);
+    clocktype width;
+    int i;
+
+    count = LadderDropDeleted(lq, &list, count);
+    width = span / MAX(count, 1);
+
+    if (width < 1)
+    {
+        width = 1;
+    }
+    if ((span + width - 1) / width > LADDER_MAX_BUCKETS)
+    {
+        width = (span + LADDER_MAX_BUCKETS - 1) / LADDER_MAX_BUCKETS;
+    }
+
+    rung->start = rangeStart;
+    rung->width = width;
+    rung->numBuckets = (int) ((span + width - 1) / width);
+    rung->current = 0;
+    rung->numEvents = 0;
+
+    if (rung->capacity < rung->numBuckets)
+    {
+        if (rung->buckets != NULL)
+        {
+            MEM_free(rung->buckets);
+            MEM_free(rung->bucketCount);
+        }
+        rung->capacity = rung->numBuckets;
+        rung->buckets = (LadderCell**)
+            MEM_malloc(sizeof(LadderCell*) * rung->capacity);
+        rung->bucketCount = (int*) MEM_malloc(sizeof(int) * rung->capacity);
+    }
+    for (i = 0; i < rung->numBuckets; i++)
+    {
+        rung->buckets[i] = NULL;
+        rung->bucketCount[i] = 0;
+    }
+
+    while (list != NULL)
+    {
+        LadderCell* cell = list;
+        int index = (int) ((cell->time - rung->start) / rung->width);
+
+        list = list->next;
+        ERROR_Assert(index >= 0 && index < rung->numBuckets,
+                     "Ladder queue event outside of the new rung");
+        cell->next = rung->buckets[index];
+        rung->buckets[index] = cell;
+        rung->bucketCount[index]++;
+        rung->numEvents++;
+    }
+
+    lq->numRungs++;
+    lq->numSpawns++;
+}
+
+// Turn Bottom into a rung when it has grown too long to be kept sorted.
+// All of Bottom lies before the current bucket of the finest rung (or
+// before Top when there are no rungs), so the new rung goes below it.
+static
+void LadderSpreadBottom(LadderQueue* lq)
+{
+    clocktype rangeEnd;
+
+    if (lq->numRungs > 0)
+    {
+        LadderRung* finest = &lq->rungs[lq->numRungs - 1];
+        rangeEnd = finest->start + finest->current * finest->width;
+    }
+    else
+    {
+        rangeEnd = lq->topStart;
+    }
+
+    LadderCell* list = lq->bottom;
+    LadderCell* last = list;
+    int count = lq->bottomCount;
+
+    while (last->next != NULL)
+    {
+        last = last->next;
+    }
+    if (last->time == list->time)
+    {
+        // All at the same time, a rung would not split them
+        return;
+    }
+
+    lq->bottom = NULL;
+    lq->bottomCount = 0;
+    LadderSpawnRung(lq, list, count, list->time, rangeEnd);
+}
+
+static
+void LadderInsertCell(LadderQueue* lq, LadderCell* cell)
+{
+    int i;
+
+    lq->numEvents++;
+    if (lq->numEvents > lq->hiWatermark)
+    {
+        lq->hiWatermark = lq->numEvents;
+    }
+
+    if (cell->time >= lq->topStart)
+    {
+        if (lq->topCount == 0 || cell->time < lq->topMin)
+        {
+            lq->topMin = cell->time;
+        }
+        if (lq->topCount == 0 || cell->time > lq->topMax)
+        {
+            lq->topMax = cell->time;
+        }
+        cell->next = lq->top;
+        lq->top = cell;
+        lq->topCount++;
+        return;
+    }
+
+    for (i = 0; i < lq->numRungs; i++)
+    {
+        LadderRung* rung = &lq->rungs[i];
+        clocktype currentStart = rung->start + rung->current * rung->width;
+
+        if (cell->time >= currentStart)
+        {
+            int index = (int) ((cell->time - rung->start) / rung->width);
+
+            cell->next = rung->buckets[index];
+            rung->buckets[index] = cell;
+            rung->bucketCount[index]++;
+            rung->numEvents++;
+            return;
+        }
+    }
+
+    LadderBottomInsert(lq, cell);
+    if (lq->bottomCount > LADDER_THRESHOLD
+        && lq->numRungs < LADDER_MAX_RUNGS)
+    {
+        LadderSpreadBottom(lq);
+    }
+}
+
+// Make sure Bottom holds the earliest events, if there are any.
+static
+BOOL LadderRefillBottom(LadderQueue* lq)
+{
+    while (lq->bottom == NULL)
+    {
+        if (lq->numRungs == 0)
+        {
+            if (lq->topCount == 0)
+            {
+                return FALSE;
+            }
+
+            LadderCell* list = lq->top;
+            int count = lq->topCount;
+            clocktype rangeStart = lq->topMin;
+            clocktype rangeEnd = lq->topMax + 1;
+
+            lq->top = NULL;
+            lq->topCount = 0;
+            LadderSpawnRung(lq, list, count, rangeStart, rangeEnd);
+            lq->topStart = lq->rungs[0].start
+                           + lq->rungs[0].numBuckets * lq->rungs[0].width;
+            continue;
+        }
+
+        LadderRung* rung = &lq->rungs[lq->numRungs - 1];
+        while (rung->current < rung->numBuckets
+               && rung->bucketCount[rung->current] == 0)
+        {
+            rung->current++;
+        }
+
+        if (rung->current == rung->numBuckets)
+        {
+            lq->numRungs--;
+            continue;
+        }
+
+        int index = rung->current;
+        LadderCell* list = rung->buckets[index];
+        int count = rung->bucketCount[index];
+        clocktype bucketStart = rung->start + index * rung->width;
+
+        rung->buckets[index] = NULL;
+        rung->bucketCount[index] = 0;
+        rung->numEvents -= count;
+        rung->current++;
+
+        if (count > LADDER_THRESHOLD
+            && rung->width > 1
+            && lq->numRungs < LADDER_MAX_RUNGS)
+        {
+            LadderSpawnRung(lq,
+                            list,
+                            count,
+                            bucketStart,
+                            bucketStart + rung->width);
+            continue;
+        }
+
+        // Sort the bucket into Bottom
+        count = LadderDropDeleted(lq, &list, count);
+        std::vector<LadderCell*> cells;
+        cells.reserve(count);
+        while (list != NULL)
+        {
+            cells.push_back(list);
+            list = list->next;
+        }
+        std::sort(cells.begin(), cells.end(), LadderCellLess);
+
+        for (int i = (int) cells.size() - 1; i >= 0; i--)
+        {
+            cells[i]->next = lq->bottom;
+            lq->bottom = cells[i];
+        }
+        lq->bottomCount = (int) cells.size();
+    }
+
+    return TRUE;
+}
+
+static
+void LadderRemoveBottomHead(LadderQueue* lq)
+{
+    LadderCell* cell = lq->bottom;
+
+    lq->bottom = cell->next;
+    lq->bottomCount--;
+    lq->numEvents--;
+}
+
+// Return the earliest event of the partition, dropping deleted events
+// and setting aside the events of nodes that left the node queue.
+static
+LadderCell* LadderPeekCell(LadderQueue* lq)
+{
+    while (LadderRefillBottom(lq))
+    {
+        LadderCell* cell = lq->bottom;
+
+        if (LadderTakeDeleted(lq, cell))
+        {
+            LadderRemoveBottomHead(lq);
+            LadderFreeCell(lq, cell);
+            continue;
+        }
+
+        if (!LadderHasNode(lq, cell->node))
+        {
+            LadderRemoveBottomHead(lq);
+            lq->parked[cell->node].push_back(cell);
+            continue;
+        }
+
+        return cell;
+    }
+
+    return NULL;
+}
+
+// Remember the cell at *link if it is an earlier event of the node than
+// the best one found so far.
+static
+void LadderConsiderCell(LadderQueue* lq,
+                        Node* node,
+                        LadderCell** link,
+                        int* listCount,
+                        int* rungCount,
+                        LadderCell*** best,
+                        int** bestListCount,
+                        int** bestRungCount)
+{
+    LadderCell* cell = *link;
+
+    if (cell->node != node
+        || (*best != NULL && !LadderCellLess(cell, **best)))
+    {
+        return;
+    }
+    if (!lq->deleted.empty()
+        && lq->deleted.find(LadderDeletedKey(cell->msg, cell->naturalOrder))
+           != lq->deleted.end())
+    {
+        return;
+    }
+
+    *best = link;
+    *bestListCount = listCount;
+    *bestRungCount = rungCount;
+}
+
+// Slow path: find the earliest event of a node that is not at the head
+// of the queue.  Returns the link pointing at the cell and the counters
+// to update when it is unlinked.
+static
+LadderCell** LadderFindNodeCell(LadderQueue* lq,
+                                Node* node,
+                                int** listCount,
+                                int** rungCount)
+{
+    LadderCell** best = NULL;
+    LadderCell** link;
+    int i;
+    int j;
+
+    lq->numSlowSearches++;
+    *listCount = NULL;
+    *rungCount = NULL;
+
+    // Bottom is sorted, so the first match there is the earliest event
+    for (link = &lq->bottom; *link != NULL && best == NULL;
+         link = &(*link)->next)
+    {
+        LadderConsiderCell(lq, node, link, &lq->bottomCount, NULL,
+                           &best, listCount, rungCount);
+    }
+
+    // Finer rungs hold earlier events, and buckets are in time order
+    for (i = lq->numRungs - 1; i >= 0 && best == NULL; i--)
+    {
+        LadderRung* rung = &lq->rungs[i];
+
+        for (j = rung->current; j < rung->numBuckets && best == NULL; j++)
+        {
+            for (link = &rung->buckets[j];
+                 *link != NULL;
+                 link = &(*link)->next)
+            {
+                LadderConsiderCell(lq, node, link,
+                                   &rung->bucketCount[j], &rung->numEvents,
+                                   &best, listCount, rungCount);
+            }
+        }
+    }
+
+    for (link = &lq->top; *link != NULL && best == NULL;
+         link = &(*link)->next)
+    {
+        LadderConsiderCell(lq, node, link, &lq->topCount, NULL,
+                           &best, listCount, rungCount);
+    }
+
+    return best;
+}
+
+//------------------------- Scheduler interface -------------------------
+
+void SCHED_LADDER_InsertMessage(
+    Node *node,
+    Message *msg,
+    clocktype delay)
+{
+    LadderQueue* lq = LadderGetQueue(node->partitionData);
+    LadderCell* cell = LadderAllocCell(lq);
+
+    cell->time = node->partitionData->theCurrentTime + delay;
+    cell->naturalOrder = msg->naturalOrder;
+    cell->msg = msg;
+    cell->node = node;
+
+#ifdef LADDER_DEBUG
+    printf("ladder: insert node %d event %d at %" TYPES_64BITFMT "d "
+           "order %u\n",
+           node->nodeId, msg->eventType, cell->time, cell->naturalOrder);
+#endif
+
+    LadderInsertCell(lq, cell);
+
+#ifdef LADDER_CHECK_SPLAYTREE
+    SCHED_SPLAYTREE_InsertMessage(node, msg, delay);
+#endif
+}
+
+
+#ifdef LADDER_CHECK_SPLAYTREE
+// Extract the event the splay tree scheduler has in place of the one the
+// ladder extracted, and stop if they differ.  The time is only compared
+// for the first event of the partition.
+static
+void LadderCheckSplayTree(PartitionData* partitionData,
+                          Node* node,
+                          Message* msg,
+                          clocktype time,
+                          BOOL isFirst)
+{
+    clocktype splayTime = SCHED_SPLAYTREE_NextEventTime(partitionData);
+    Message* splayMsg =
+        SCHED_SPLAYTREE_ExtractFirstMessage(partitionData, node);
+
+    if (splayMsg != msg || (isFirst && msg != NULL && splayTime != time))
+    {
+        char errStr[MAX_STRING_LENGTH];
+
+        sprintf(errStr,
+                "Ladder queue extracted time %" TYPES_64BITFMT "d order %u, "
+                "splay tree time %" TYPES_64BITFMT "d order %u",
+                msg == NULL ? (clocktype) -1 : time,
+                msg == NULL ? 0 : msg->naturalOrder,
+                splayMsg == NULL ? (clocktype) -1 : splayTime,
+                splayMsg == NULL ? 0 : splayMsg->naturalOrder);
+        ERROR_ReportError(errStr);
+    }
+}
+#endif
+
+
+Message* SCHED_LADDER_ExtractFirstMessage(
+    PartitionData *partitionData,
+    Node *node)
+{
+    LadderQueue* lq = LadderGetQueue(partitionData);
+    LadderCell* cell = LadderPeekCell(lq);
+    Message* msg;
+    BOOL isFirst = TRUE;
+
+    if (cell == NULL)
+    {
+#ifdef LADDER_CHECK_SPLAYTREE
+        LadderCheckSplayTree(partitionData, node, NULL, 0, TRUE);
+#endif
+        return NULL;
+    }
+
+    if (node == NULL || cell->node == node)
+    {
+        LadderRemoveBottomHead(lq);
+    }
+    else
+    {
+        int* listCount;
+        int* rungCount;
+        LadderCell** link = LadderFindNodeCell(lq,
+                                               node,
+                                               &listCount,
+                                               &rungCount);
+        if (link == NULL)
+        {
+#ifdef LADDER_CHECK_SPLAYTREE
+            LadderCheckSplayTree(partitionData, node, NULL, 0, FALSE);
+#endif
+            return NULL;
+        }
+
+        cell = *link;
+        *link = cell->next;
+        (*listCount)--;
+        if (rungCount != NULL)
+        {
+            (*rungCount)--;
+        }
+        lq->numEvents--;
+        isFirst = FALSE;
+    }
+
+    msg = cell->msg;
+
+#ifdef LADDER_CHECK_SPLAYTREE
+    LadderCheckSplayTree(partitionData, node, msg, cell->time, isFirst);
+#endif
+
+    LadderFreeCell(lq, cell);
+    return msg;
+}
+
+
+Message* SCHED_LADDER_PeekFirstMessage(
+    Node *node)
+{
+    LadderQueue* lq = LadderGetQueue(node->partitionData);
+    LadderCell* cell = LadderPeekCell(lq);
+
+    if (cell == NULL)
+    {
+        return NULL;
+    }
+    if (cell->node == node)
+    {
+        return cell->msg;
+    }
+
+    int* listCount;
+    int* rungCount;
+    LadderCell** link = LadderFindNodeCell(lq, node, &listCount, &rungCount);
+
+    return (link == NULL) ? NULL : (*link)->msg;
+}
+
+
+void SCHED_LADDER_DeleteMessage(
+    Node *node,
+    Message *msg)
+{
+    LadderQueue* lq = LadderGetQueue(node->partitionData);
+
+    // The cell is dropped when it reaches the head of the queue.  The key
+    // includes naturalOrder so that a recycled Message that is sent again
+    // before then is not dropped as well.
+    lq->deleted.insert(LadderDeletedKey(msg, msg->naturalOrder));
+
+#ifdef LADDER_CHECK_SPLAYTREE
+    SCHED_SPLAYTREE_DeleteMessage(node, msg);
+#endif
+}
+
+
+void SCHED_LADDER_InsertNode(
+    PartitionData *partitionData,
+    Node *node)
+{
+    LadderQueue* lq = LadderGetQueue(partitionData);
+    std::map<Node*, std::vector<LadderCell*> >::iterator it;
+
+    if (node->nodeIndex >= lq->nodes.size())
+    {
+        lq->nodes.resize(node->nodeIndex + 1, NULL);
+    }
+    if (lq->nodes[node->nodeIndex] == NULL)
+    {
+        lq->numNodes++;
+    }
+    lq->nodes[node->nodeIndex] = node;
+
+    it = lq->parked.find(node);
+    if (it != lq->parked.end())
+    {
+        std::vector<LadderCell*>& cells = it->second;
+
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            LadderInsertCell(lq, cells[i]);
+        }
+        lq->parked.erase(it);
+    }
+
+#ifdef LADDER_CHECK_SPLAYTREE
+    SCHED_SPLAYTREE_InsertNode(partitionData, node);
+#endif
+}
+
+
+Node* SCHED_LADDER_PeekNextNode(
+    PartitionData *partitionData)
+{
+    LadderQueue* lq = LadderGetQueue(partitionData);
+    LadderCell* cell = LadderPeekCell(lq);
+
+    if (cell != NULL)
+    {
+        return cell->node;
+    }
+    return LadderFirstNode(lq);
+}
+
+
+void SCHED_LADDER_DeleteNode(
+    PartitionData *partitionData,
+    Node *node)
+{
+    LadderQueue* lq = LadderGetQueue(partitionData);
+
+    // Pending events of the node are set aside when they reach the head
+    // of the queue and restored by SCHED_LADDER_InsertNode.
+    if (LadderHasNode(lq, node))
+    {
+        lq->nodes[node->nodeIndex] = NULL;
+        lq->numNodes--;
+    }
+
+#ifdef LADDER_CHECK_SPLAYTREE
+    SCHED_SPLAYTREE_DeleteNode(partitionData, node);
+#endif
+}
+
+
+Node* SCHED_LADDER_CurrentNode(
+    const PartitionData *partitionData)
+{
+    LadderQueue* lq = LadderGetQueue(partitionData);
+    LadderCell* cell = LadderPeekCell(lq);
+
+    if (cell != NULL)
+    {
+        return cell->node;
+    }
+    return LadderFirstNode(lq);
+}
+
+
+BOOL SCHED_LADDER_HasNodes(
+    const PartitionData *partitionData)
+{
+    LadderQueue* lq = LadderGetQueue(partitionData);
+
+    return (lq->numNodes > 0) ? TRUE : FALSE;
+}
+
+
+Message* SCHED_LADDER_NextEvent(
+    PartitionData *partitionData,
+    Node* node)
+{
+    if (node != NULL)
+    {
+        return SCHED_LADDER_PeekFirstMessage(node);
+    }
+
+    LadderCell* cell = LadderPeekCell(LadderGetQueue(partitionData));
+    return (cell == NULL) ? NULL : cell->msg;
+}
+
+
+clocktype SCHED_LADDER_NextEventTime(
+    const PartitionData *partitionData)
+{
+    LadderCell* cell = LadderPeekCell(LadderGetQueue(partitionData));
+
+    return (cell == NULL) ? CLOCKTYPE_MAX : cell->time;
+}
+
+
+void SCHED_LADDER_Initialize(
+    PartitionData *partitionData)
+{
+    LadderQueue* lq = new LadderQueue;
+    int i;
+
+    lq->top = NULL;
+    lq->topCount = 0;
+    lq->topMin = 0;
+    lq->topMax = 0;
+    lq->topStart = 0;
+
+    for (i = 0; i < LADDER_MAX_RUNGS; i++)
+    {
+        memset(&lq->rungs[i], 0, sizeof(LadderRung));
+    }
+    lq->numRungs = 0;
+
+    lq->bottom = NULL;
+    lq->bottomCount = 0;
+    lq->numEvents = 0;
+
+    lq->numNodes = 0;
+
+    lq->cellFreeListNum = 0;
+    lq->cellFreeList = NULL;
+
+    lq->isCollectingStats = (partitionData->schedulerInfo != NULL
+                             && partitionData->schedulerInfo->isCollectingStats);
+    lq->hiWatermark = 0;
+    lq->numSpawns = 0;
+    lq->numSlowSearches = 0;
+
+    partitionData->ladderQueue = lq;
+}
+
+
+static
+void LadderFreeList(LadderCell* list)
+{
+    while (list != NULL)
+    {
+        LadderCell* next = list->next;
+        MEM_free(list);
+        list = next;
+    }
+}
+
+void SCHED_LADDER_Finalize(
+    PartitionData *partitionData)
+{
+    LadderQueue* lq = partitionData->ladderQueue;
+    int i;
+    int j;
+
+    if (lq == NULL)
+    {
+        return;
+    }
+
+    if (lq->isCollectingStats)
+    {
+        printf("Partition %d ladder queue: high watermark %d, "
+               "rungs spawned %" TYPES_64BITFMT "d, "
+               "slow node searches %" TYPES_64BITFMT "d\n",
+               partitionData->partitionId,
+               lq->hiWatermark,
+               lq->numSpawns,
+               lq->numSlowSearches);
+    }
+
+    // Only the cells are owned by the queue, not the messages
+    LadderFreeList(lq->top);
+    LadderFreeList(lq->bottom);
+    for (i = 0; i < LADDER_MAX_RUNGS; i++)
+    {
+        LadderRung* rung = &lq->rungs[i];
+
+        if (rung->buckets == NULL)
+        {
+            continue;
+        }
+        if (i < lq->numRungs)
+        {
+            for (j = rung->current; j < rung->numBuckets; j++)
+            {
+                LadderFreeList(rung->buckets[j]);
+            }
+        }
+        MEM_free(rung->buckets);
+        MEM_free(rung->bucketCount);
+    }
+
+    std::map<Node*, std::vector<LadderCell*> >::iterator it;
+    for (it = lq->parked.begin(); it != lq->parked.end(); it++)
+    {
+        for (i = 0; i < (int) it->second.size(); i++)
+        {
+            MEM_free(it->second[i]);
+        }
+    }
+
+    LadderFreeList(lq->cellFreeList);
+
+    // Deletions of events that were still queued are of no further use
+    lq->deleted.clear();
+    lq->parked.clear();
+
+    delete lq;
+    partitionData->ladderQueue = NULL;
+}
+
+
+void SCHED_LADDER_Install(
+    PartitionData *partitionData)
+{
+    SchedulerInfo* schedulerInfo = partitionData->schedulerInfo;
+
+    ERROR_Assert(schedulerInfo != NULL,
+                 "SCHED_Initalize must be called before SCHED_LADDER_Install");
+
+#ifdef LADDER_CHECK_SPLAYTREE
+    // The splay tree is already set up if it was the configured queue
+    if (schedulerInfo->schedQueueType != SPLAYTREE_QUEUE)
+    {
+        SCHED_SPLAYTREE_Initialize(partitionData);
+    }
+#endif
+
+    schedulerInfo->schedQueueType      = LADDER_QUEUE;
+    schedulerInfo->InsertMessage       = SCHED_LADDER_InsertMessage;
+    schedulerInfo->ExtractFirstMessage = SCHED_LADDER_ExtractFirstMessage;
+    schedulerInfo->PeekFirstMessage    = SCHED_LADDER_PeekFirstMessage;
+    schedulerInfo->DeleteMessage       = SCHED_LADDER_DeleteMessage;
+    schedulerInfo->InsertNode          = SCHED_LADDER_InsertNode;
+    schedulerInfo->PeekNextNode        = SCHED_LADDER_PeekNextNode;
+    schedulerInfo->DeleteNode          = SCHED_LADDER_DeleteNode;
+    schedulerInfo->CurrentNode         = SCHED_LADDER_CurrentNode;
+    schedulerInfo->HasNodes            = SCHED_LADDER_HasNodes;
+    schedulerInfo->NextEvent           = SCHED_LADDER_NextEvent;
+    schedulerInfo->NextEventTime       = SCHED_LADDER_NextEventTime;
+    schedulerInfo->Initalize           = SCHED_LADDER_Initialize;
+    schedulerInfo->Finalize            = SCHED_LADDER_Finalize;
+
+    SCHED_LADDER_Initialize(partitionData);
+}
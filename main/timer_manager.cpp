@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <algorithm>
 
 #include "api.h"
 #include "timer_manager.h"
@@ -9,15 +10,151 @@ TimerManager::TimerManager(Node *node)
 {
     this->node = node;
     currentMessageScheduled = NULL;
-    localTimerHeap = 
-        new std::priority_queue<Message*, std::vector<Message *>, MessageCompare>;
+    localTimerHeap = new std::vector<Message*>;
     scheduledTimerStack = new std::stack<Message*>;
+    cancelledTimerHeap = new std::vector<Message*>;
+    numOnMainHeap = 0;
+    numCancelledOnMainHeap = 0;
 }
 
 TimerManager::~TimerManager()
 {
+    // Timers on the main heap are freed by the kernel when they expire,
+    // the ones still held here belong to the manager.
+    size_t i;
+    for (i = 0; i < localTimerHeap->size(); i++)
+    {
+        Message *msg = (*localTimerHeap)[i];
+        msg->timerHeapIndex = -1;
+        msg->timerManager = NULL;
+        MESSAGE_Free(node, msg);
+    }
+    for (i = 0; i < cancelledTimerHeap->size(); i++)
+    {
+        Message *msg = (*cancelledTimerHeap)[i];
+        msg->timerManager = NULL;
+        MESSAGE_Free(node, msg);
+    }
+
+    // Those still on the main heap must not call back into this manager
+    if (currentMessageScheduled != NULL)
+    {
+        currentMessageScheduled->timerManager = NULL;
+    }
+    while (!scheduledTimerStack->empty())
+    {
+        scheduledTimerStack->top()->timerManager = NULL;
+        scheduledTimerStack->pop();
+    }
     delete localTimerHeap;
     delete scheduledTimerStack;
+    delete cancelledTimerHeap;
+}
+
+void TimerManager::heapSet(int index, Message *msg)
+{
+    (*localTimerHeap)[index] = msg;
+    msg->timerHeapIndex = index;
+}
+
+void TimerManager::heapSiftUp(int index)
+{
+    Message *msg = (*localTimerHeap)[index];
+
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (!MessageCompare()((*localTimerHeap)[parent], msg))
+        {
+            break;
+        }
+        heapSet(index, (*localTimerHeap)[parent]);
+        index = parent;
+    }
+    heapSet(index, msg);
+}
+
+void TimerManager::heapSiftDown(int index)
+{
+    int size = (int)localTimerHeap->size();
+    Message *msg = (*localTimerHeap)[index];
+
+    while (true)
+    {
+        int child = 2 * index + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size &&
+            MessageCompare()((*localTimerHeap)[child],
+                             (*localTimerHeap)[child + 1]))
+        {
+            child++;
+        }
+        if (!MessageCompare()(msg, (*localTimerHeap)[child]))
+        {
+            break;
+        }
+        heapSet(index, (*localTimerHeap)[child]);
+        index = child;
+    }
+    heapSet(index, msg);
+}
+
+void TimerManager::heapPush(Message *msg)
+{
+    localTimerHeap->push_back(msg);
+    heapSiftUp((int)localTimerHeap->size() - 1);
+}
+
+void TimerManager::heapRemove(int index)
+{
+    Message *msg = (*localTimerHeap)[index];
+    Message *last = localTimerHeap->back();
+
+    localTimerHeap->pop_back();
+    msg->timerHeapIndex = -1;
+
+    if (last != msg)
+    {
+        heapSet(index, last);
+        heapSiftUp(index);
+        heapSiftDown(last->timerHeapIndex);
+    }
+}
+
+void TimerManager::sendTimer(Message *msg)
+{
+    msg->isScheduledOnMainHeap = TRUE;
+    numOnMainHeap++;
+    MESSAGE_Send(node, msg, msg->timerExpiresAt - getSimTime(node));
+}
+
+void TimerManager::holdCancelled(Message *msg)
+{
+    msg->cancelled = TRUE;
+    cancelledTimerHeap->push_back(msg);
+    std::push_heap(cancelledTimerHeap->begin(),
+                   cancelledTimerHeap->end(),
+                   MessageCompare());
+}
+
+void TimerManager::freeCancelled()
+{
+    clocktype now = getSimTime(node);
+
+    while (!cancelledTimerHeap->empty() &&
+           cancelledTimerHeap->front()->timerExpiresAt <= now)
+    {
+        Message *msg = cancelledTimerHeap->front();
+        std::pop_heap(cancelledTimerHeap->begin(),
+                      cancelledTimerHeap->end(),
+                      MessageCompare());
+        cancelledTimerHeap->pop_back();
+        msg->timerManager = NULL;
+        MESSAGE_Free(node, msg);
+    }
 }
 
 void TimerManager::schedule(Message *msg, clocktype delay)
@@ -25,16 +162,17 @@ void TimerManager::schedule(Message *msg, clocktype delay)
     msg->timerExpiresAt = getSimTime(node) + delay;
     msg->timerManager = this;
     msg->isScheduledOnMainHeap = FALSE;
+    msg->timerHeapIndex = -1;
 
-    /* If no message is scheduled on the main localTimerHeap, schedule this one. 
+    /* If no message is scheduled on the main localTimerHeap, schedule this one.
        Else check if this timer is earlier than the currently scheduled timer,
        in which case schedule this timer too.
        Otherwise, store the timer in local localTimerHeap */
-    
+
     if(currentMessageScheduled == NULL)
     {
         currentMessageScheduled = msg;
-        MESSAGE_Send(node, msg, delay);
+        sendTimer(msg);
 #ifdef TIMER_MANAGER_DEBUG
         printf("TIMER: <1> %d Scheduling timer for %lf at %lf\n",
                node->nodeId,
@@ -46,7 +184,7 @@ void TimerManager::schedule(Message *msg, clocktype delay)
     {
         scheduledTimerStack->push(currentMessageScheduled);
         currentMessageScheduled = msg;
-        MESSAGE_Send(node, msg, delay);
+        sendTimer(msg);
 #ifdef TIMER_MANAGER_DEBUG
         printf("TIMER: <2> %d Scheduling timer for %lf at %lf\n",
                node->nodeId,
@@ -56,19 +194,99 @@ void TimerManager::schedule(Message *msg, clocktype delay)
     }
     else
     {
-        localTimerHeap->push(msg);
+        heapPush(msg);
     }
 }
 
 void TimerManager::cancel(Message *msg)
 {
-    msg->cancelled = true;
+    if (msg->timerHeapIndex >= 0)
+    {
+        // Still held here: stop it from being scheduled, but keep the
+        // message until its expiry time as the caller may still use it
+        heapRemove(msg->timerHeapIndex);
+        holdCancelled(msg);
+        return;
+    }
+
+    if (!msg->isScheduledOnMainHeap ||
+        msg->timerHeapIndex == TIMER_MANAGER_CANCELLED_ON_MAIN_HEAP)
+    {
+        // Already cancelled
+        return;
+    }
+
+    // A timer cancelled with MESSAGE_CancelSelfMsg before is not counted,
+    // timerExpired() only uncounts the ones marked here.
+    if (!msg->cancelled)
+    {
+        msg->timerHeapIndex = TIMER_MANAGER_CANCELLED_ON_MAIN_HEAP;
+        numCancelledOnMainHeap++;
+    }
+    msg->cancelled = TRUE;
+}
+
+Message* TimerManager::reschedule(Message *msg, clocktype delay)
+{
+    clocktype expiresAt = getSimTime(node) + delay;
+
+    if (msg->timerHeapIndex >= 0)
+    {
+        // Re-key in place if it stays behind the timer on the main heap
+        if (currentMessageScheduled != NULL &&
+            expiresAt >= currentMessageScheduled->timerExpiresAt)
+        {
+            msg->timerExpiresAt = expiresAt;
+            heapSiftUp(msg->timerHeapIndex);
+            heapSiftDown(msg->timerHeapIndex);
+            return msg;
+        }
+
+        heapRemove(msg->timerHeapIndex);
+        schedule(msg, delay);
+        return msg;
+    }
+
+    // Already on the main heap, where it can't be moved
+    Message *newMsg = MESSAGE_Duplicate(node, msg);
+    cancel(msg);
+    newMsg->cancelled = FALSE;
+    schedule(newMsg, delay);
+    return newMsg;
+}
+
+void TimerManager::timerExpired(Message *msg)
+{
+    numOnMainHeap--;
+    if (msg->timerHeapIndex == TIMER_MANAGER_CANCELLED_ON_MAIN_HEAP)
+    {
+        numCancelledOnMainHeap--;
+        msg->timerHeapIndex = -1;
+    }
+    ERROR_Assert(numOnMainHeap >= 0 && numCancelledOnMainHeap >= 0,
+                 "TimerManager: timer counts out of step");
+
+    // The timer has left the manager; if the protocol sends the message
+    // again it is an ordinary event.
+    msg->timerManager = NULL;
+    freeCancelled();
+    scheduleNextTimer();
+}
+
+int TimerManager::getNumLiveTimers() const
+{
+    return (int)localTimerHeap->size() + numOnMainHeap
+           - numCancelledOnMainHeap;
+}
+
+int TimerManager::getNumDeadTimers() const
+{
+    return numCancelledOnMainHeap + (int)cancelledTimerHeap->size();
 }
 
 void TimerManager::scheduleNextTimer()
 {
     Message *msg;
-    clocktype delay;
 
     while(true)
     {
@@ -78,7 +296,7 @@ void TimerManager::scheduleNextTimer()
         }
 
         // Get the front element of the localTimerHeap
-        msg = localTimerHeap->top();
+        msg = localTimerHeap->front();
 
         if(!msg->cancelled)
         {
@@ -96,7 +314,7 @@ void TimerManager::scheduleNextTimer()
                 if(msg->timerExpiresAt > currentMessageScheduled->timerExpiresAt)
                 {
 #ifdef TIMER_MANAGER_DEBUG
-                    printf("TIMER: popping %lf\n", 
+                    printf("TIMER: popping %lf\n",
                            (double)currentMessageScheduled->timerExpiresAt/SECOND);
 #endif
                     scheduledTimerStack->pop();
@@ -105,15 +323,15 @@ void TimerManager::scheduleNextTimer()
             }
 
             currentMessageScheduled = msg;
-            delay = msg->timerExpiresAt - getSimTime(node);
-            MESSAGE_Send(node, msg, delay);
-            localTimerHeap->pop();
+            heapRemove(0);
+            sendTimer(msg);
             return;
         }
         else
         {
-            localTimerHeap->pop();
-            MESSAGE_Free(node, msg);
+            // Cancelled by setting the flag directly
+            heapRemove(0);
+            holdCancelled(msg);
         }
     }
 
@@ -21,53 +21,46 @@
 #include "api.h"
 #include "partition.h"
 #include "trace.h"
+#include "trace_binary.h"
 #include "product_info.h"
 
 // /**
-// FUNCTION      :: TRACE_WriteXMLTraceHeader
+// FUNCTION      :: TRACE_ReadTraceHeader
 // LAYER         ::
-// PURPOSE       :: Write trace header information to the trace file
+// PURPOSE       :: Read the contents of the trace header
 // PARAMETERS    ::
-// + nodeInput  : NodeInput*    : Pointer to NodeInput
-// + fp         : FILE*         : Pointer to FILE : Trace file pointer
+// + nodeInput  : NodeInput* : Pointer to NodeInput
+// + version    : char*      : product version, MAX_STRING_LENGTH long
+// + scenario   : char*      : experiment name, MAX_STRING_LENGTH long
+// + comments   : char*      : experiment comments, MAX_STRING_LENGTH long
 // RETURN        ::  void : NULL
 // **/
 
-void TRACE_WriteXMLTraceHeader(NodeInput* nodeInput, FILE* fp)
+static
+void TRACE_ReadTraceHeader(NodeInput* nodeInput,
+                           char* version,
+                           char* scenario,
+                           char* comments)
 {
-    char buf[MAX_STRING_LENGTH];
     BOOL retVal;
 
-    char traceBuf[TRACE_STRING_LENGTH];
-    memset(traceBuf, 0, sizeof(traceBuf));
-    sprintf(traceBuf, "<trace_file>\n\n");
-    strcat(traceBuf, "<head>\n");
-
-    strcat(traceBuf, "<version>");
-    strcat(traceBuf, Product::GetProductName());
-    strcat(traceBuf, Product::GetVersionString());
-    strcat(traceBuf, "</version>\n");
+    sprintf(version, "%s%s",
+            Product::GetProductName(),
+            Product::GetVersionString());
 
-    // print experiment name
     IO_ReadString(
         ANY_NODEID,
         ANY_ADDRESS,
         nodeInput,
         "EXPERIMENT-NAME",
         &retVal,
-        buf);
+        scenario);
     if (!retVal)
     {
         ERROR_ReportWarning("EXPERIMENT-NAME unavailable,"
         " assuming default\n");
-        strcpy(buf, "default");
+        strcpy(scenario, "default");
     }
-    strcat(traceBuf, "<scenario>");
-    strcat(traceBuf, buf);
-    strcat(traceBuf, "</scenario>\n");
-
-    // read and print experiment comments
-    strcat(traceBuf, "<comments>");
 
     IO_ReadString(
     ANY_NODEID,
@@ -75,23 +68,45 @@ void TRACE_WriteXMLTraceHeader(NodeInput* nodeInput, FILE* fp)
     nodeInput,
     "EXPERIMENT-COMMENT",
     &retVal,
-    buf);
+    comments);
 
     if (!retVal)
     {
         ERROR_ReportWarning("EXPERIMENT-COMMENT not available\n");
-        strcpy(buf, "Any user or system free-form comments");
+        strcpy(comments, "Any user or system free-form comments");
     }
 
-    if ((strlen(buf)) >= MAX_STRING_LENGTH) {
+    if ((strlen(comments)) >= MAX_STRING_LENGTH) {
         ERROR_ReportError("EXPERIMENT-COMMENT is too Big\n");
     }
+}
 
-    strcat(traceBuf, buf);
-    strcat(traceBuf, "</comments>\n");
+// /**
+// FUNCTION      :: TRACE_WriteXMLTraceHeader
+// LAYER         ::
+// PURPOSE       :: Write trace header information to the trace file
+// PARAMETERS    ::
+// + nodeInput  : NodeInput*    : Pointer to NodeInput
+// + fp         : FILE*         : Pointer to FILE : Trace file pointer
+// RETURN        ::  void : NULL
+// **/
 
-    strcat(traceBuf, "</head>\n\n<body>\n\n");
-    fprintf(fp, "%s", traceBuf);
+void TRACE_WriteXMLTraceHeader(NodeInput* nodeInput, FILE* fp)
+{
+    char version[MAX_STRING_LENGTH];
+    char scenario[MAX_STRING_LENGTH];
+    char comments[MAX_STRING_LENGTH];
+
+    TRACE_ReadTraceHeader(nodeInput, version, scenario, comments);
+
+    fprintf(fp,
+            "<trace_file>\n\n"
+            "<head>\n"
+            "<version>%s</version>\n"
+            "<scenario>%s</scenario>\n"
+            "<comments>%s</comments>\n"
+            "</head>\n\n<body>\n\n",
+            version, scenario, comments);
     fflush(fp);
 }
 
@@ -109,6 +124,171 @@ void TRACE_WriteXMLTraceTail(FILE* fp)
     fprintf(fp, "\n</body>\n\n</trace_file>");
 }
 
+// /**
+// FUNCTION      :: TRACE_OpenTraceFile
+// LAYER         ::
+// PURPOSE       :: Create the partition's trace file in the format given
+//                  by TRACE-FORMAT.
+// PARAMETERS    ::
+// + partitionData : PartitionData* : the partition
+// + nodeInput     : NodeInput*     : Pointer to NodeInput
+// RETURN        ::  void : NULL
+// **/
+
+void TRACE_OpenTraceFile(PartitionData* partitionData, NodeInput* nodeInput)
+{
+    char buf[MAX_STRING_LENGTH];
+    BOOL retVal;
+    TraceFormatType format = TRACE_XML;
+
+    IO_ReadString(
+        ANY_NODEID,
+        ANY_ADDRESS,
+        nodeInput,
+        "TRACE-FORMAT",
+        &retVal,
+        buf);
+
+    if (retVal)
+    {
+        if (strcmp(buf, "XML") == 0)
+        {
+            format = TRACE_XML;
+        }
+        else if (strcmp(buf, "BINARY") == 0)
+        {
+            format = TRACE_BINARY;
+        }
+        else
+        {
+            ERROR_ReportError("TRACE-FORMAT should be either XML or "
+                "BINARY\n");
+        }
+    }
+
+    sprintf(buf, ".TRACE.%d", partitionData->partitionId);
+    partitionData->traceFd = fopen(buf, format == TRACE_BINARY ? "wb" : "w");
+    ERROR_Assert(partitionData->traceFd != NULL,
+                 "Unable to create packet trace file.");
+
+    if (format == TRACE_BINARY)
+    {
+        int bufferSize = TRACE_BINARY_DEFAULT_BUFFER_SIZE;
+
+        IO_ReadInt(
+            ANY_NODEID,
+            ANY_ADDRESS,
+            nodeInput,
+            "TRACE-BINARY-BUFFER-SIZE",
+            &retVal,
+            &bufferSize);
+
+        if (retVal && bufferSize <= 0)
+        {
+            ERROR_ReportError("TRACE-BINARY-BUFFER-SIZE should be "
+                "positive\n");
+        }
+
+        partitionData->traceBinary =
+            new TraceBinaryWriter(partitionData->traceFd, bufferSize);
+    }
+}
+
+// /**
+// FUNCTION      :: TRACE_WriteTraceHeader
+// LAYER         ::
+// PURPOSE       :: Write trace header information to the partition's
+//                  trace file in its format
+// PARAMETERS    ::
+// + partitionData : PartitionData* : the partition
+// + nodeInput     : NodeInput*     : Pointer to NodeInput
+// RETURN        ::  void : NULL
+// **/
+
+void TRACE_WriteTraceHeader(PartitionData* partitionData,
+                            NodeInput* nodeInput)
+{
+    if (partitionData->traceBinary != NULL)
+    {
+        char version[MAX_STRING_LENGTH];
+        char scenario[MAX_STRING_LENGTH];
+        char comments[MAX_STRING_LENGTH];
+
+        TRACE_ReadTraceHeader(nodeInput, version, scenario, comments);
+        partitionData->traceBinary->writeHeader(version, scenario, comments);
+    }
+    else
+    {
+        TRACE_WriteXMLTraceHeader(nodeInput, partitionData->traceFd);
+    }
+}
+
+// /**
+// FUNCTION      :: TRACE_CloseTraceFile
+// LAYER         ::
+// PURPOSE       :: Write the remaining records and the trace tail, if
+//                  this is the last partition, and close the partition's
+//                  trace file
+// PARAMETERS    ::
+// + partitionData : PartitionData* : the partition
+// RETURN        ::  void : NULL
+// **/
+
+void TRACE_CloseTraceFile(PartitionData* partitionData)
+{
+    BOOL isLastPartition =
+        partitionData->partitionId == (partitionData->numPartitions - 1);
+
+    if (partitionData->traceBinary != NULL)
+    {
+        if (isLastPartition)
+        {
+            partitionData->traceBinary->writeTail();
+        }
+        partitionData->traceBinary->close();
+        delete partitionData->traceBinary;
+        partitionData->traceBinary = NULL;
+    }
+    else if (isLastPartition)
+    {
+        TRACE_WriteXMLTraceTail(partitionData->traceFd);
+    }
+
+    fclose(partitionData->traceFd);
+    partitionData->traceFd = NULL;
+}
+
+// /**
+// FUNCTION      :: TRACE_WriteProtocolMap
+// LAYER         ::
+// PURPOSE       :: Write the name of a protocol ID to the trace file
+// PARAMETERS    ::
+// + node         : Node* : Pointer to node, doing the packet trace
+// + protocol     : TraceProtocolType : protocol
+// + protocolName : const char* : name of protocol
+// RETURN        ::  void : NULL
+// **/
+
+static
+void TRACE_WriteProtocolMap(Node* node,
+                            TraceProtocolType protocol,
+                            const char* protocolName)
+{
+    PartitionData* partitionData = node->partitionData;
+
+    if (partitionData->traceBinary != NULL)
+    {
+        partitionData->traceBinary->writeProtocolMap(protocol, protocolName);
+    }
+    else
+    {
+        fprintf(partitionData->traceFd,
+                "<protocol_map>%d %s</protocol_map>\n",
+                protocol, protocolName);
+        fflush(partitionData->traceFd);
+    }
+}
+
 
 // /**
 // FUNCTION      :: TRACE_Initialize
@@ -130,6 +310,7 @@ void TRACE_Initialize(Node* node, const NodeInput* nodeInput)
 
     node->traceData = (TraceData *) MEM_malloc(sizeof(TraceData));
     memset(node->traceData->xmlBuf, 0, MAX_TRACE_LENGTH);
+    node->traceData->xmlBufLength = 0;
 
     // Set layer tracing to TRUE by default.
     for (i = 0; i < TRACE_ALL_LAYERS; i++)
@@ -390,15 +571,12 @@ void TRACE_EnableTraceXML(
     TracePrintXMLFn xmlPrintFn,
     BOOL writeMap)
 {
-    FILE* fp = node->partitionData->traceFd;
     node->traceData->traceList[protocol] = TRUE;
 
     node->traceData->xmlPrintFn[protocol] = xmlPrintFn;
     if (node->partitionData->traceEnabled && writeMap)
     {
-        fprintf(fp, "<protocol_map>%d %s</protocol_map>\n",
-            protocol, protocolName);
-        fflush(fp);
+        TRACE_WriteProtocolMap(node, protocol, protocolName);
     }
 }
 
@@ -422,14 +600,11 @@ void TRACE_EnableTraceXMLFun(
     TracePrintXMLFun xmlPrintFun,
     BOOL writeMap)
 {
-    FILE* fp = node->partitionData->traceFd;
     node->traceData->traceList[protocol] = TRUE;
     node->traceData->xmlPrintFun[protocol] = xmlPrintFun;
     if (node->partitionData->traceEnabled && writeMap)
     {
-        fprintf(fp, "<protocol_map>%d %s</protocol_map>\n",
-            protocol, protocolName);
-        fflush(fp);
+        TRACE_WriteProtocolMap(node, protocol, protocolName);
     }
 }
 //end
@@ -452,13 +627,124 @@ void TRACE_DisableTraceXML(
     const char* protocolName,
     BOOL writeMap)
 {
-    FILE* fp = node->partitionData->traceFd;
     node->traceData->traceList[protocol] = FALSE;
     if (node->partitionData->traceEnabled && writeMap)
     {
-        fprintf(fp, "<protocol_map>%d %s</protocol_map>\n",
-            protocol, protocolName);
-        fflush(fp);
+        TRACE_WriteProtocolMap(node, protocol, protocolName);
+    }
+}
+
+// /**
+// FUNCTION   :: TRACE_BeginRecord
+// LAYER      ::
+// PURPOSE    :: Start a trace record.  The record header holds the
+//               source node, message sequence number, simulation time,
+//               originating protocol, processing node ID, tracing
+//               protocol ID and the packet action.
+// PARAMETERS ::
+// + node       : Node* : Pointer to node, doing the packet trace
+// + message    : Message* : packet to print trace info from
+// + actionData : ActionData* : more details about the packet action
+// RETURN     ::  void : NULL
+// **/
+
+static
+void TRACE_BeginRecord(Node* node,
+                       Message* message,
+                       ActionData* actionData)
+{
+    PartitionData* partitionData = node->partitionData;
+    int numHeaders = message->numberOfHeaders;
+    const MessageTraceArray& headerProtocols = message->headerProtocols;
+    BOOL hasQueue = FALSE;
+
+    switch (actionData->actionType)
+    {
+        case SEND:
+        case RECV:
+        case DROP:
+            break;
+        case ENQUEUE:
+        case DEQUEUE:
+            hasQueue = TRUE;
+            break;
+        default:
+            ERROR_ReportError("TRACE_PrintTraceXML: Invalid actionType\n");
+    }
+
+    if (partitionData->traceBinary != NULL)
+    {
+        TraceBinaryRecordHeader header;
+
+        header.originatingNodeId = message->originatingNodeId;
+        header.sequenceNumber = message->sequenceNumber;
+        header.simTime = getSimTime(node);
+        header.originatingProtocol = message->originatingProtocol;
+        header.nodeId = node->nodeId;
+        header.traceProtocol = headerProtocols[numHeaders - 1];
+        header.actionType = (UInt16) actionData->actionType;
+        header.hasQueue = hasQueue;
+        header.actionComment = (UInt16) actionData->actionComment;
+        header.interfaceId = actionData->pktQueue.interfaceID;
+        header.queuePriority = actionData->pktQueue.queuePriority;
+
+        partitionData->traceBinary->beginRecord(header);
+        return;
+    }
+
+    char clockStr[MAX_STRING_LENGTH];
+    char actionStr[MAX_STRING_LENGTH];
+
+    TIME_PrintClockInSecond(getSimTime(node), clockStr);
+
+    if (hasQueue)
+    {
+        sprintf(actionStr, " <queue> %hu %hu</queue>",
+                actionData->pktQueue.interfaceID,
+                actionData->pktQueue.queuePriority);
+    }
+    else
+    {
+        sprintf(actionStr, " %hu", actionData->actionComment);
+    }
+
+    fprintf(partitionData->traceFd,
+            "\n<rec>\n"
+            "<rechdr> %hu %d %s %d %hu %d <action> %hu%s</action></rechdr>\n"
+            "<recbody>\n",
+            message->originatingNodeId,
+            message->sequenceNumber,
+            clockStr,
+            message->originatingProtocol,
+            node->nodeId,
+            headerProtocols[numHeaders - 1],
+            actionData->actionType,
+            actionStr);
+}
+
+// /**
+// FUNCTION   :: TRACE_WriteRecordText
+// LAYER      ::
+// PURPOSE    :: Write text to the body of the current trace record.
+// PARAMETERS ::
+// + node     : Node* : Pointer to node, doing the packet trace
+// + text     : const char* : text to write
+// + length   : int : length of the text
+// RETURN     ::  void : NULL
+// **/
+
+static
+void TRACE_WriteRecordText(Node* node, const char* text, int length)
+{
+    PartitionData* partitionData = node->partitionData;
+
+    if (partitionData->traceBinary != NULL)
+    {
+        partitionData->traceBinary->appendBody(text, length);
+    }
+    else
+    {
+        fwrite(text, 1, length, partitionData->traceFd);
     }
 }
 
@@ -475,14 +761,73 @@ void TRACE_DisableTraceXML(
 
 void TRACE_WriteToBufferXML(Node* node, char* buf)
 {
-    int length = (int)(strlen(node->traceData->xmlBuf) + strlen(buf));
-    if (length >= MAX_TRACE_LENGTH)
+    TraceData* traceData = node->traceData;
+    int length = (int) strlen(buf);
+
+    if (traceData->xmlBufLength + length >= MAX_TRACE_LENGTH)
     {
-        fprintf(node->partitionData->traceFd, "%s", node->traceData->xmlBuf);
-        memset(node->traceData->xmlBuf, 0, MAX_TRACE_LENGTH);
+        TRACE_WriteRecordText(node,
+                              traceData->xmlBuf,
+                              traceData->xmlBufLength);
+        traceData->xmlBuf[0] = '\0';
+        traceData->xmlBufLength = 0;
+
+        if (length >= MAX_TRACE_LENGTH)
+        {
+            TRACE_WriteRecordText(node, buf, length);
+            return;
+        }
     }
 
-    strcat(node->traceData->xmlBuf, buf);
+    memcpy(traceData->xmlBuf + traceData->xmlBufLength, buf, length + 1);
+    traceData->xmlBufLength += length;
+}
+
+// /**
+// FUNCTION   :: TRACE_WriteRecordBody
+// LAYER      ::
+// PURPOSE    :: Write the trace buffer of a node, filled by a protocol
+//               trace function, to the body of the current record and
+//               clear it.
+// PARAMETERS ::
+// + node     : Node* : Pointer to node, doing the packet trace
+// RETURN     ::  void : NULL
+// **/
+
+static
+void TRACE_WriteRecordBody(Node* node)
+{
+    TraceData* traceData = node->traceData;
+
+    TRACE_WriteRecordText(node, traceData->xmlBuf, traceData->xmlBufLength);
+    TRACE_WriteRecordText(node, "\n", 1);
+
+    traceData->xmlBuf[0] = '\0';
+    traceData->xmlBufLength = 0;
+}
+
+// /**
+// FUNCTION   :: TRACE_EndRecord
+// LAYER      ::
+// PURPOSE    :: End the current trace record.
+// PARAMETERS ::
+// + node     : Node* : Pointer to node, doing the packet trace
+// RETURN     ::  void : NULL
+// **/
+
+static
+void TRACE_EndRecord(Node* node)
+{
+    PartitionData* partitionData = node->partitionData;
+
+    if (partitionData->traceBinary != NULL)
+    {
+        partitionData->traceBinary->endRecord();
+    }
+    else
+    {
+        fputs("</recbody>\n</rec>\n", partitionData->traceFd);
+    }
 }
 
 // /**
@@ -505,64 +850,15 @@ void TRACE_PrintTraceXML(Node* node,
                          NetworkType netType)
 {
     int i;
-    char clockStr[MAX_STRING_LENGTH];
-    FILE* fp = node->partitionData->traceFd;
     int numHeaders = message->numberOfHeaders;
-    int* headerProtocols = message->headerProtocols;
+    const MessageTraceArray& headerProtocols = message->headerProtocols;
     BOOL* traceList = node->traceData->traceList;
-    char* xmlBuf = node->traceData->xmlBuf;
     TracePrintXMLFun* xmlPrintFun = node->traceData->xmlPrintFun;
     TracePrintXMLFn* xmlPrintFn = node->traceData->xmlPrintFn;
     TraceIncludedHeadersType traceIncludedHeaders =
         node->traceData->traceIncludedHeaders;
-    char hdrBuf[MAX_STRING_LENGTH];
-
-    TIME_PrintClockInSecond(getSimTime(node), clockStr);
-
-    // Start record element.
-    fprintf(fp, "\n<rec>\n");
-
-    char tmpBuf[MAX_STRING_LENGTH];
-    memset(tmpBuf, 0, sizeof(tmpBuf));
-
-    sprintf(tmpBuf, "%hu %d %s %d %hu %d",
-        message->originatingNodeId,
-        message->sequenceNumber,
-        clockStr,
-        message->originatingProtocol,
-        node->nodeId,
-        headerProtocols[numHeaders - 1]);
-
-    //  print packet action
-    strcat(tmpBuf, " <action>");
-    memset(hdrBuf, 0, sizeof(hdrBuf));
-    sprintf(hdrBuf, " %hu", actionData->actionType);
-    strcat(tmpBuf, hdrBuf);
-    memset(hdrBuf, 0, sizeof(hdrBuf));
-
-    switch (actionData->actionType)
-    {
-        case SEND:
-        case RECV:
-        case DROP:
-            sprintf(hdrBuf, " %hu", actionData->actionComment);
-            break;
-        case ENQUEUE:
-        case DEQUEUE:
-            sprintf(hdrBuf, " <queue> %hu %hu</queue>",
-                    actionData->pktQueue.interfaceID,
-                    actionData->pktQueue.queuePriority);
-            break;
-        default:
-            ERROR_ReportError("TRACE_PrintTraceXML: Invalid actionType\n");
-    }
-    strcat(tmpBuf, hdrBuf);
-    strcat(tmpBuf, "</action>");
-    fprintf(fp, "<rechdr> %s</rechdr>\n", tmpBuf);
-
 
-    // start rec body
-    fprintf(fp, "<recbody>\n");
+    TRACE_BeginRecord(node, message, actionData);
 
     if (traceList[headerProtocols[numHeaders - 1]] == TRUE
         && traceIncludedHeaders == TRACE_INCLUDED_NONE)
@@ -574,18 +870,12 @@ void TRACE_PrintTraceXML(Node* node,
         {
             xmlPrintFun[headerProtocols[numHeaders - 1]](node, message,netType);
 
-            fprintf(fp, "%s", xmlBuf);
-            fprintf(fp, "\n");
-
-            memset(xmlBuf, 0, MAX_TRACE_LENGTH);
+            TRACE_WriteRecordBody(node);
         }
         else if (xmlPrintFn[headerProtocols[numHeaders - 1]] != NULL)
         {
             xmlPrintFn[headerProtocols[numHeaders - 1]](node, message);
-            fprintf(fp, "%s", xmlBuf);
-            fprintf(fp, "\n");
-
-            memset(xmlBuf, 0, MAX_TRACE_LENGTH);
+            TRACE_WriteRecordBody(node);
         }
 
         else
@@ -642,20 +932,14 @@ void TRACE_PrintTraceXML(Node* node,
             {
               xmlPrintFun[headerProtocols[i]](node, message , netType);
 
-                fprintf(fp, "%s", xmlBuf);
-                fprintf(fp, "\n");
-
-                memset(xmlBuf, 0, MAX_TRACE_LENGTH);
+                TRACE_WriteRecordBody(node);
             }
             else if (xmlPrintFn[headerProtocols[i]] != NULL)
 
             {
                 xmlPrintFn[headerProtocols[i]](node, message);
 
-                fprintf(fp, "%s", xmlBuf);
-                fprintf(fp, "\n");
-
-                memset(xmlBuf, 0, MAX_TRACE_LENGTH);
+                TRACE_WriteRecordBody(node);
             }
             else
             {
@@ -665,8 +949,7 @@ void TRACE_PrintTraceXML(Node* node,
     } // if
 
     // end of record
-    fprintf(fp, "</recbody>\n</rec>\n");
-    fflush(fp);
+    TRACE_EndRecord(node);
 }
 
 // /**
@@ -687,70 +970,14 @@ void TRACE_PrintTraceXML(Node* node,
                          ActionData* actionData)
 {
     int i;
-    char clockStr[MAX_STRING_LENGTH];
-    FILE* fp = node->partitionData->traceFd;
     int numHeaders = message->numberOfHeaders;
-    int* headerProtocols = message->headerProtocols;
+    const MessageTraceArray& headerProtocols = message->headerProtocols;
     BOOL* traceList = node->traceData->traceList;
-    char* xmlBuf = node->traceData->xmlBuf;
     TracePrintXMLFn* xmlPrintFn = node->traceData->xmlPrintFn;
     TraceIncludedHeadersType traceIncludedHeaders =
         node->traceData->traceIncludedHeaders;
-    char hdrBuf[MAX_STRING_LENGTH];
-
-    TIME_PrintClockInSecond(getSimTime(node), clockStr);
-
-    // Start record element.
-    fprintf(fp, "\n<rec>\n");
-
-    // print record header
-    // <rechdr>
-    // Source Node, Message Sequence No., Simulation Time,
-    // Originating Protocol, Processing Node ID, Tracing Protocol ID
-    // <action> actionData </action>
-    // </rechdr>
-
-    char tmpBuf[MAX_STRING_LENGTH];
-    memset(tmpBuf, 0, sizeof(tmpBuf));
-
-    sprintf(tmpBuf, "%hu %d %s %d %hu %d",
-        message->originatingNodeId,
-        message->sequenceNumber,
-        clockStr,
-        message->originatingProtocol,
-        node->nodeId,
-        headerProtocols[numHeaders - 1]);
-
-    //  print packet action
-    strcat(tmpBuf, " <action>");
-    memset(hdrBuf, 0, sizeof(hdrBuf));
-    sprintf(hdrBuf, " %hu", actionData->actionType);
-    strcat(tmpBuf, hdrBuf);
-    memset(hdrBuf, 0, sizeof(hdrBuf));
-
-    switch (actionData->actionType)
-    {
-        case SEND:
-        case RECV:
-        case DROP:
-            sprintf(hdrBuf, " %hu", actionData->actionComment);
-            break;
-        case ENQUEUE:
-        case DEQUEUE:
-            sprintf(hdrBuf, " <queue> %hu %hu</queue>",
-                    actionData->pktQueue.interfaceID,
-                    actionData->pktQueue.queuePriority);
-            break;
-        default:
-            ERROR_ReportError("TRACE_PrintTraceXML: Invalid actionType\n");
-    }
-    strcat(tmpBuf, hdrBuf);
-    strcat(tmpBuf, "</action>");
-    fprintf(fp, "<rechdr> %s</rechdr>\n", tmpBuf);
-
 
-    // start rec body
-    fprintf(fp, "<recbody>\n");
+    TRACE_BeginRecord(node, message, actionData);
 
     if (traceList[headerProtocols[numHeaders - 1]] == TRUE
         && traceIncludedHeaders == TRACE_INCLUDED_NONE)
@@ -762,10 +989,7 @@ void TRACE_PrintTraceXML(Node* node,
         {
             xmlPrintFn[headerProtocols[numHeaders - 1]](node, message);
 
-            fprintf(fp, "%s", xmlBuf);
-            fprintf(fp, "\n");
-
-            memset(xmlBuf, 0, MAX_TRACE_LENGTH);
+            TRACE_WriteRecordBody(node);
         }
         else
         {
@@ -780,12 +1004,8 @@ void TRACE_PrintTraceXML(Node* node,
             xmlPrintFn[TRACE_GEN_FTP](node, message);
 
         }
-        fprintf(fp, "%s", xmlBuf);
-        fprintf(fp, "\n");
-
-        memset(xmlBuf, 0, MAX_TRACE_LENGTH);
-        fprintf(fp, "</recbody>\n</rec>\n");
-        fflush(fp);
+        TRACE_WriteRecordBody(node);
+        TRACE_EndRecord(node);
         return;
 
     }
@@ -836,10 +1056,7 @@ void TRACE_PrintTraceXML(Node* node,
             {
                 xmlPrintFn[headerProtocols[i]](node, message);
 
-                fprintf(fp, "%s", xmlBuf);
-                fprintf(fp, "\n");
-
-                memset(xmlBuf, 0, MAX_TRACE_LENGTH);
+                TRACE_WriteRecordBody(node);
             }
             else
             {
@@ -849,8 +1066,7 @@ void TRACE_PrintTraceXML(Node* node,
     } // if
 
     // end of record
-    fprintf(fp, "</recbody>\n</rec>\n");
-    fflush(fp);
+    TRACE_EndRecord(node);
 }
 
 // /**
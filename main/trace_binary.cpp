@@ -0,0 +1,264 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api.h"
+#include "trace_binary.h"
+
+static void TraceBinaryPutUInt8(std::vector<char>& out, UInt8 value)
+{
+    out.push_back((char) value);
+}
+
+static void TraceBinaryPutUInt16(std::vector<char>& out, UInt16 value)
+{
+    out.push_back((char) (value & 0xff));
+    out.push_back((char) (value >> 8));
+}
+
+static void TraceBinaryPutUInt32(std::vector<char>& out, UInt32 value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out.push_back((char) ((value >> (8 * i)) & 0xff));
+    }
+}
+
+static void TraceBinaryPutInt64(std::vector<char>& out, Int64 value)
+{
+    UInt64 bits = (UInt64) value;
+
+    for (int i = 0; i < 8; i++)
+    {
+        out.push_back((char) ((bits >> (8 * i)) & 0xff));
+    }
+}
+
+static void TraceBinaryPutString(std::vector<char>& out, const char* text)
+{
+    size_t length = strlen(text);
+
+    if (length > 0xffff)
+    {
+        length = 0xffff;
+    }
+    TraceBinaryPutUInt16(out, (UInt16) length);
+    out.insert(out.end(), text, text + length);
+}
+
+TraceBinaryWriter::TraceBinaryWriter(FILE* fp, int bufferSize)
+: fp_(fp), bufferSize_(bufferSize), active_(0), used_(0),
+  pending_(NULL), pendingLength_(0), stop_(FALSE), started_(FALSE)
+{
+    buffer_[0] = (char*) MEM_malloc(bufferSize_);
+    buffer_[1] = (char*) MEM_malloc(bufferSize_);
+
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_cond_init(&cond_, NULL);
+
+    ERROR_Assert(pthread_create(&thread_, NULL, TraceBinaryWriter::run,
+                                (void*) this) == 0,
+                 "Unable to start the packet trace writer thread.");
+    started_ = TRUE;
+}
+
+TraceBinaryWriter::~TraceBinaryWriter()
+{
+    close();
+
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&mutex_);
+
+    MEM_free(buffer_[0]);
+    MEM_free(buffer_[1]);
+}
+
+void* TraceBinaryWriter::run(void* data)
+{
+    TraceBinaryWriter* writer = (TraceBinaryWriter*) data;
+
+    pthread_mutex_lock(&writer->mutex_);
+    for (;;)
+    {
+        while (writer->pending_ == NULL && !writer->stop_)
+        {
+            pthread_cond_wait(&writer->cond_, &writer->mutex_);
+        }
+        if (writer->pending_ == NULL)
+        {
+            break;
+        }
+
+        char* buffer = writer->pending_;
+        int length = writer->pendingLength_;
+
+        pthread_mutex_unlock(&writer->mutex_);
+        fwrite(buffer, 1, length, writer->fp_);
+        pthread_mutex_lock(&writer->mutex_);
+
+        writer->pending_ = NULL;
+        pthread_cond_broadcast(&writer->cond_);
+    }
+    pthread_mutex_unlock(&writer->mutex_);
+
+    return NULL;
+}
+
+// Give the active buffer to the thread and continue with the other one,
+// once the thread is done with it
+void TraceBinaryWriter::handOver()
+{
+    pthread_mutex_lock(&mutex_);
+    while (pending_ != NULL)
+    {
+        pthread_cond_wait(&cond_, &mutex_);
+    }
+    pending_ = buffer_[active_];
+    pendingLength_ = used_;
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&mutex_);
+
+    active_ = 1 - active_;
+    used_ = 0;
+}
+
+void TraceBinaryWriter::put(const char* data, int length)
+{
+    while (length > 0)
+    {
+        int chunk = bufferSize_ - used_;
+
+        if (chunk > length)
+        {
+            chunk = length;
+        }
+        memcpy(buffer_[active_] + used_, data, chunk);
+        used_ += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (used_ == bufferSize_)
+        {
+            handOver();
+        }
+    }
+}
+
+void TraceBinaryWriter::beginRecordType(TraceBinaryRecordType type)
+{
+    record_.clear();
+    TraceBinaryPutUInt8(record_, (UInt8) type);
+
+    // Length, filled in by endRecordType
+    TraceBinaryPutUInt32(record_, 0);
+}
+
+void TraceBinaryWriter::endRecordType()
+{
+    UInt32 length = (UInt32) (record_.size() - 5);
+
+    for (int i = 0; i < 4; i++)
+    {
+        record_[1 + i] = (char) ((length >> (8 * i)) & 0xff);
+    }
+    put(&record_[0], (int) record_.size());
+}
+
+void TraceBinaryWriter::writeHeader(
+    const char* version,
+    const char* scenario,
+    const char* comments)
+{
+    beginRecordType(TRACE_BINARY_HEADER);
+    TraceBinaryPutUInt32(record_, TRACE_BINARY_MAGIC);
+    TraceBinaryPutUInt32(record_, TRACE_BINARY_VERSION);
+    TraceBinaryPutString(record_, version);
+    TraceBinaryPutString(record_, scenario);
+    TraceBinaryPutString(record_, comments);
+    endRecordType();
+}
+
+void TraceBinaryWriter::writeProtocolMap(
+    int protocol,
+    const char* protocolName)
+{
+    beginRecordType(TRACE_BINARY_PROTOCOL_MAP);
+    TraceBinaryPutUInt32(record_, (UInt32) protocol);
+    record_.insert(record_.end(),
+                   protocolName,
+                   protocolName + strlen(protocolName));
+    endRecordType();
+}
+
+void TraceBinaryWriter::beginRecord(const TraceBinaryRecordHeader& header)
+{
+    beginRecordType(TRACE_BINARY_RECORD);
+    TraceBinaryPutUInt32(record_, header.originatingNodeId);
+    TraceBinaryPutUInt32(record_, (UInt32) header.sequenceNumber);
+    TraceBinaryPutInt64(record_, header.simTime);
+    TraceBinaryPutUInt32(record_, (UInt32) header.originatingProtocol);
+    TraceBinaryPutUInt32(record_, header.nodeId);
+    TraceBinaryPutUInt32(record_, (UInt32) header.traceProtocol);
+    TraceBinaryPutUInt16(record_, header.actionType);
+    TraceBinaryPutUInt8(record_, header.hasQueue ? 1 : 0);
+    TraceBinaryPutUInt16(record_,
+                         header.hasQueue ? header.interfaceId
+                                         : header.actionComment);
+    TraceBinaryPutUInt8(record_, header.queuePriority);
+}
+
+void TraceBinaryWriter::appendBody(const char* text, int length)
+{
+    record_.insert(record_.end(), text, text + length);
+}
+
+void TraceBinaryWriter::endRecord()
+{
+    endRecordType();
+}
+
+void TraceBinaryWriter::writeTail()
+{
+    beginRecordType(TRACE_BINARY_TAIL);
+    endRecordType();
+}
+
+void TraceBinaryWriter::close()
+{
+    if (!started_)
+    {
+        return;
+    }
+
+    if (used_ > 0)
+    {
+        handOver();
+    }
+
+    pthread_mutex_lock(&mutex_);
+    stop_ = TRUE;
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&mutex_);
+
+    pthread_join(thread_, NULL);
+    started_ = FALSE;
+
+    fflush(fp_);
+}
@@ -0,0 +1,307 @@
+// Copyright (c) 2001-2009, Scalable Network Technologies, Inc.  All Rights Reserved.
+//                          6100 Center Drive
+//                          Suite 1250
+//                          Los Angeles, CA 90045
+//                          sales@scalable-networks.com
+//
+// This source code is licensed, not sold, and is subject to a written
+// license agreement.  Among other things, no portion of this source
+// code may be copied, transmitted, disclosed, displayed, distributed,
+// translated, used as the basis for a derivative work, or used, in
+// whole or in part, for any program or purpose other than its intended
+// use in compliance with the license agreement as part of the QualNet
+// software.  This source code and certain of the algorithms contained
+// within it are confidential trade secrets of Scalable Network
+// Technologies, Inc. and may not be used as the basis for any other
+// software, hardware, product or service.
+
+// Offline converter of binary packet traces (TRACE-FORMAT BINARY) to the
+// XML trace format.
+//
+//   trace_convert [-o <xml trace>] <binary trace>...
+//
+// The binary traces are converted in order, so either the trace of the
+// whole simulation or the traces of all partitions, in partition order,
+// are given.  The XML trace is written to the standard output if no
+// output file is given.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "trace_binary.h"
+
+static void Usage()
+{
+    fprintf(stderr,
+            "Usage: trace_convert [-o <xml trace>] <binary trace>...\n");
+    exit(1);
+}
+
+static void Fail(const char* fileName, const char* message)
+{
+    fprintf(stderr, "trace_convert: %s: %s\n", fileName, message);
+    exit(1);
+}
+
+// Reads the fields of a record
+class TraceRecordReader
+{
+public:
+    TraceRecordReader(const std::vector<char>& data)
+    : data_(data), pos_(0), ok_(true) {}
+
+    bool ok() const { return ok_; }
+
+    UInt32 getUInt(int size)
+    {
+        UInt32 value = 0;
+
+        if (!check(size))
+        {
+            return 0;
+        }
+        for (int i = 0; i < size; i++)
+        {
+            value |= ((UInt32) (UInt8) data_[pos_ + i]) << (8 * i);
+        }
+        pos_ += size;
+        return value;
+    }
+
+    Int64 getInt64()
+    {
+        UInt64 low = getUInt(4);
+        UInt64 high = getUInt(4);
+
+        return (Int64) (low | (high << 32));
+    }
+
+    std::string getString()
+    {
+        int length = (int) getUInt(2);
+
+        if (!check(length))
+        {
+            return std::string();
+        }
+        pos_ += length;
+        return std::string(&data_[pos_ - length], length);
+    }
+
+    std::string getRest()
+    {
+        std::string rest;
+
+        if (pos_ < data_.size())
+        {
+            rest.assign(&data_[pos_], data_.size() - pos_);
+        }
+        pos_ = data_.size();
+        return rest;
+    }
+
+private:
+    const std::vector<char>& data_;
+    size_t pos_;
+    bool ok_;
+
+    bool check(int size)
+    {
+        if (pos_ + size > data_.size())
+        {
+            ok_ = false;
+        }
+        return ok_;
+    }
+};
+
+// Same format as TIME_PrintClockInSecond
+static void PrintClockInSecond(Int64 clock, char* clockStr)
+{
+    sprintf(clockStr,
+            "%" TYPES_64BITFMT "d.%09" TYPES_64BITFMT "d",
+            clock / 1000000000,
+            clock % 1000000000);
+}
+
+static void ConvertRecord(
+    FILE* out,
+    const char* fileName,
+    int type,
+    const std::vector<char>& data)
+{
+    TraceRecordReader in(data);
+
+    switch (type)
+    {
+        case TRACE_BINARY_HEADER:
+        {
+            UInt32 magic = in.getUInt(4);
+            UInt32 version = in.getUInt(4);
+
+            if (magic != TRACE_BINARY_MAGIC)
+            {
+                Fail(fileName, "Not a binary packet trace");
+            }
+            if (version != TRACE_BINARY_VERSION)
+            {
+                Fail(fileName, "Unsupported binary packet trace version");
+            }
+
+            std::string productVersion = in.getString();
+            std::string scenario = in.getString();
+            std::string comments = in.getString();
+
+            fprintf(out,
+                    "<trace_file>\n\n"
+                    "<head>\n"
+                    "<version>%s</version>\n"
+                    "<scenario>%s</scenario>\n"
+                    "<comments>%s</comments>\n"
+                    "</head>\n\n<body>\n\n",
+                    productVersion.c_str(),
+                    scenario.c_str(),
+                    comments.c_str());
+            break;
+        }
+        case TRACE_BINARY_PROTOCOL_MAP:
+        {
+            Int32 protocol = (Int32) in.getUInt(4);
+            std::string name = in.getRest();
+
+            fprintf(out, "<protocol_map>%d %s</protocol_map>\n",
+                    protocol, name.c_str());
+            break;
+        }
+        case TRACE_BINARY_RECORD:
+        {
+            char clockStr[64];
+            char actionStr[64];
+            UInt32 originatingNodeId = in.getUInt(4);
+            Int32 sequenceNumber = (Int32) in.getUInt(4);
+            Int64 simTime = in.getInt64();
+            Int32 originatingProtocol = (Int32) in.getUInt(4);
+            UInt32 nodeId = in.getUInt(4);
+            Int32 traceProtocol = (Int32) in.getUInt(4);
+            UInt16 actionType = (UInt16) in.getUInt(2);
+            UInt8 hasQueue = (UInt8) in.getUInt(1);
+            UInt16 actionValue = (UInt16) in.getUInt(2);
+            UInt8 queuePriority = (UInt8) in.getUInt(1);
+            std::string body = in.getRest();
+
+            PrintClockInSecond(simTime, clockStr);
+            if (hasQueue)
+            {
+                sprintf(actionStr, " <queue> %hu %hu</queue>",
+                        actionValue, (UInt16) queuePriority);
+            }
+            else
+            {
+                sprintf(actionStr, " %hu", actionValue);
+            }
+
+            fprintf(out,
+                    "\n<rec>\n"
+                    "<rechdr> %hu %d %s %d %hu %d <action> %hu%s</action>"
+                    "</rechdr>\n"
+                    "<recbody>\n",
+                    (UInt16) originatingNodeId,
+                    sequenceNumber,
+                    clockStr,
+                    originatingProtocol,
+                    (UInt16) nodeId,
+                    traceProtocol,
+                    actionType,
+                    actionStr);
+            fwrite(body.data(), 1, body.size(), out);
+            fputs("</recbody>\n</rec>\n", out);
+            break;
+        }
+        case TRACE_BINARY_TAIL:
+            fprintf(out, "\n</body>\n\n</trace_file>");
+            break;
+        default:
+            Fail(fileName, "Unknown record type");
+    }
+
+    if (!in.ok())
+    {
+        Fail(fileName, "Corrupted record");
+    }
+}
+
+static void ConvertFile(FILE* out, const char* fileName)
+{
+    FILE* in = fopen(fileName, "rb");
+    std::vector<char> data;
+    unsigned char recordHeader[5];
+
+    if (in == NULL)
+    {
+        Fail(fileName, "Cannot open file");
+    }
+
+    for (;;)
+    {
+        size_t n = fread(recordHeader, 1, sizeof(recordHeader), in);
+
+        if (n == 0)
+        {
+            break;
+        }
+        if (n < sizeof(recordHeader))
+        {
+            Fail(fileName, "Truncated record");
+        }
+
+        UInt32 length = (UInt32) recordHeader[1]
+                        | ((UInt32) recordHeader[2] << 8)
+                        | ((UInt32) recordHeader[3] << 16)
+                        | ((UInt32) recordHeader[4] << 24);
+
+        data.resize(length);
+        if (length > 0 && fread(&data[0], 1, length, in) != length)
+        {
+            Fail(fileName, "Truncated record");
+        }
+
+        ConvertRecord(out, fileName, recordHeader[0], data);
+    }
+
+    fclose(in);
+}
+
+int
+main(int argc, char* argv[])
+{
+    FILE* out = stdout;
+    int first = 1;
+
+    if (argc >= 3 && strcmp(argv[1], "-o") == 0)
+    {
+        out = fopen(argv[2], "w");
+        if (out == NULL)
+        {
+            Fail(argv[2], "Cannot create file");
+        }
+        first = 3;
+    }
+    if (first >= argc)
+    {
+        Usage();
+    }
+
+    for (int i = first; i < argc; i++)
+    {
+        ConvertFile(out, argv[i]);
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}